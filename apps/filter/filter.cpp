@@ -17,6 +17,7 @@
  */
 
 #include <list>
+#include <vector>
 #include <iostream>
 
 #include <libxml/tree.h>
@@ -34,8 +35,12 @@
 #include <scene/VisualScene.hpp>
 #include <scene/collada/Importer.hpp>
 #include <scene/collada/Exporter.hpp>
-#ifdef SCENE_TINIA
+#include <scene/collada/Snapshot.hpp>
+#include <scene/runtime/Resolver.hpp>
+#include <scene/runtime/RenderList.hpp>
+#include <scene/runtime/WireFormat.hpp>
 #include <fstream>
+#ifdef SCENE_TINIA
 #include <scene/tinia/Bridge.hpp>
 #include <tinia/renderlist/XMLWriter.hpp>
 #endif
@@ -52,6 +57,9 @@ main( int argc, char** argv )
 
     std::string output_file;
     std::string output_renderlist;
+    std::string output_snapshot;
+    std::string output_wire;
+    bool wire_quantize = false;
     bool single_index = false;
     bool stats = false;
 
@@ -82,6 +90,23 @@ main( int argc, char** argv )
                 continue;
             }
         }
+        else if( param == "--export-wire" ) {
+            if( (i+1) < argc ) {
+                output_wire = argv[i+1];
+                i++;
+                continue;
+            }
+        }
+        else if( param == "--wire-quantize" ) {
+            wire_quantize = true;
+        }
+        else if( param == "--snapshot" ) {
+            if( (i+1) < argc ) {
+                output_snapshot = argv[i+1];
+                i++;
+                continue;
+            }
+        }
         else if( param == "--single-index" ) {
             single_index = true;
         }
@@ -162,6 +187,9 @@ main( int argc, char** argv )
             std::cerr << "  --loglevel level          Specify loglevel (trace, debug, info, warn, error, fatal)" << std::endl;
             std::cerr << "  --single-index            Convert multi-index geometry to single index." << std::endl;
             std::cerr << "  --export-renderlist file  Output renderlist" << std::endl;
+            std::cerr << "  --export-wire file        Output renderlist in binary wire format." << std::endl;
+            std::cerr << "  --wire-quantize           Quantize float buffers in wire format." << std::endl;
+            std::cerr << "  --snapshot file           Write binary snapshot of the database." << std::endl;
             std::cerr << "  --stats                   Display statistics of imported data." << std::endl;
             std::cerr << "  --[no-]-libs              Enable/disable export of all libraries." << std::endl;
             std::cerr << "  --[no-]-lib-geometry      Enable/disable export of geometries." << std::endl;
@@ -270,6 +298,38 @@ main( int argc, char** argv )
     }
 
 
+    if( !output_wire.empty() ) {
+        if( db.library<Scene::VisualScene>().size() == 0 ) {
+            std::cerr << "No visual scenes." << std::endl;
+        }
+        else {
+            std::ofstream out( output_wire, std::ios::binary );
+            if( !out.is_open() ) {
+                std::cerr << "Failed to open '" << output_wire << "' for writing." << std::endl;
+            }
+            else {
+                Scene::Runtime::Resolver resolver( db, Scene::PROFILE_GLSL );
+                Scene::Runtime::RenderList renderlist( resolver );
+                renderlist.build( db.library<Scene::VisualScene>().get(0)->id() );
+
+                Scene::Runtime::WireEncoder encoder( db, wire_quantize );
+                std::vector<unsigned char> frame;
+                encoder.encode( frame, renderlist, true );
+                out.write( reinterpret_cast<const char*>( frame.data() ), frame.size() );
+                if( stats ) {
+                    std::cout << "wire frame: " << encoder.lastRawSize() << " bytes, "
+                              << frame.size() << " bytes compressed" << std::endl;
+                }
+            }
+        }
+    }
+
+    if( !output_snapshot.empty() ) {
+        if( !Scene::Collada::writeSnapshot( db, output_snapshot ) ) {
+            std::cerr << "Failed to write snapshot '" << output_snapshot << "'." << std::endl;
+        }
+    }
+
     if( !output_file.empty() ) {
         Scene::Collada::Exporter exporter( db );
 
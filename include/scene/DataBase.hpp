@@ -125,10 +125,32 @@ public:
     const Library<T>&
     library() const;
 
+    /** Timestamp of the last time objects were deleted from any library.
+      *
+      * Caches keyed on object pointers, like the resolver and the transform
+      * cache, may be kept across structural changes as long as this hasn't
+      * moved forward, since none of the pointers can have been reused.
+      */
+    SeqPos&
+    objectsRemoved() { return m_objects_removed; }
+
+    const SeqPos&
+    objectsRemoved() const { return m_objects_removed; }
+
+    /** Set the number of changes kept in the journal of every library.
+      *
+      * Consumers that look at changes less often than the libraries fill up
+      * their journals fall back to examining every object, see
+      * Library::changesSince.
+      */
+    void
+    setJournalCapacity( size_t capacity );
+
 
 protected:
     const DataBase*                          m_fallback;
     Asset                                    m_asset;
+    SeqPos                                   m_objects_removed;   ///< Declared first, outlives the libraries.
     Library<Geometry>                        m_library_geometries;
     Library<Image>                           m_library_images;
     Library<Camera>                          m_library_cameras;
@@ -58,7 +58,10 @@ public:
 
     /** Flattens multi-index primitive sets to single index primitive sets.
       *
-      * \returns true If successful, false otherwise.
+      * \returns True if the geometry has no shared inputs afterwards, which
+      *          includes the case where it had none to begin with. False if
+      *          the inputs can't be flattened, in which case the geometry is
+      *          left as it was. Earlier versions returned false in all cases.
       */
     bool
     flatten();
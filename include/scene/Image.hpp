@@ -19,6 +19,7 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 #include "scene/Scene.hpp"
 #include <scene/SeqPos.hpp>
 
@@ -89,6 +90,23 @@ public:
     const void*
     get( size_t mip_level, size_t slice ) const;
 
+    /** Size in bytes of the texel data of all slices, zero if not set. */
+    size_t
+    dataSize() const;
+
+    /** Let the image refer to texel data it doesn't own, e.g. a mapped snapshot.
+      *
+      * The image keeps a reference to owner as long as it refers to data,
+      * and copies the data if it is later modified through set.
+      *
+      * \param[in] data   Texel data of all slices.
+      * \param[in] size   Size of data in bytes.
+      * \param[in] owner  Keeps the data alive.
+      * \returns False if the image is uninitialized or size doesn't match.
+      */
+    bool
+    reference( const void* data, size_t size, const std::shared_ptr<const void>& owner );
+
     ImageType
     type() const { return m_type; }
 
@@ -138,7 +156,13 @@ protected:
     setFormat( GLenum iformat, GLenum format, GLenum type );
 
 
-    std::vector<unsigned char> m_data;
+    std::vector<unsigned char>  m_data;
+    const unsigned char*        m_external_data;
+    std::shared_ptr<const void> m_external_owner;
+
+    /** Size in bytes of all slices of the current format. */
+    size_t
+    slicesSize() const;
 
 };
 
@@ -28,6 +28,14 @@
 
 namespace Scene {
 
+/** Kinds of changes recorded in a library journal. */
+enum ChangeKind {
+    CHANGE_ADDED,       ///< Object was added to the library.
+    CHANGE_REMOVED,     ///< Object was deleted, only its identity is known.
+    CHANGE_STRUCTURE,   ///< Object's structureChanged moved forward.
+    CHANGE_VALUE        ///< Object's valueChanged moved forward.
+};
+
 /** A generalized library of a particular type.
   *
   * COLLADA organizes assets into libraries, e.g., library_geometries,
@@ -36,6 +44,11 @@ namespace Scene {
   * this functionality is organized into a generalized library.
   *
   * A library is the owner of the objects.
+  *
+  * In addition, a library keeps a bounded journal of the objects that have
+  * been added, removed or changed, such that consumers can find out what has
+  * changed since they last looked in time proportional to the number of
+  * changes instead of scanning every object, see changesSince.
   */
 
 template<class T>
@@ -43,6 +56,14 @@ class Library : public StructureValueSequences
 {
     friend class DataBase;
 public:
+    /** An entry in the change journal. */
+    struct Change {
+        ChangeKind          m_kind;
+        Identifiable::Id    m_identity; ///< Identifiable::id() of the object.
+        T*                  m_object;   ///< NULL for removals.
+        SeqPos              m_pos;      ///< When the change was recorded.
+    };
+
     ~Library();
 
     T*
@@ -78,6 +99,40 @@ public:
     void
     clear();
 
+    /** Timestamp of the last time objects were deleted from this library. */
+    const SeqPos&
+    objectsRemoved() const { return m_objects_removed; }
+
+    using StructureValueSequences::moveForward;
+
+    /** Move timestamps forward to a changed object and journal the change.
+      *
+      * Objects of this library call this after touching their timestamps.
+      * Repeated calls for the same change are only journaled once, and
+      * changes reported by an object while it is deleted are not journaled.
+      */
+    void
+    moveForward( const T& object );
+
+    /** Get the changes recorded after a given timestamp.
+      *
+      * Changes are appended to changes, oldest first. An object may occur
+      * more than once.
+      *
+      * \returns False if changes after since have been dropped from the
+      *          journal, in which case the caller must examine every object.
+      */
+    bool
+    changesSince( std::vector<Change>& changes, const SeqPos& since ) const;
+
+    /** Maximum number of changes kept in the journal. */
+    size_t
+    journalCapacity() const { return m_journal_capacity; }
+
+    /** Set maximum number of changes kept in the journal, drops the journal. */
+    void
+    setJournalCapacity( size_t capacity );
+
     DataBase*
     dataBase();
 
@@ -93,12 +148,25 @@ protected:
     Asset                                    m_asset;
     std::vector<T*>                          m_objects;
     std::unordered_map<std::string,index_t>  m_map;
+    SeqPos                                   m_objects_removed;
+    std::vector<Change>                      m_journal;           ///< Ring buffer.
+    size_t                                   m_journal_capacity;
+    size_t                                   m_journal_next;      ///< Next slot to write.
+    SeqPos                                   m_journal_dropped;   ///< Most recent dropped change.
+    const T*                                 m_deleting;          ///< Object being deleted, if any.
 
     Library();
 
     void
     setDatabase( DataBase* database );
 
+    void
+    journal( ChangeKind kind, Identifiable::Id identity, T* object );
+
+    /** Forget all changes, changesSince fails for earlier timestamps. */
+    void
+    dropJournal();
+
     static const std::string                 m_autoid_prefix;
     static const std::string                 m_instance_name;
 
@@ -36,15 +36,53 @@ namespace Scene {
 void
 initLogger( int* argc, char** argv );
 
+/** \name Compile-time log levels
+ *
+ * Log statements below SCENE_LOG_LEVEL are removed by the preprocessor, so
+ * they cost nothing, not even evaluation of the message. Statements at or
+ * above are formatted only if the logger is enabled at runtime (log4cxx)
+ * or always (stderr).
+ *
+ * Unless given by the build, the level is TRACE for log4cxx debug builds,
+ * INFO for log4cxx release builds, DEBUG for stderr debug builds and WARN for
+ * stderr release builds.
+ *
+ * Loggers should be looked up once per site, i.e.
+ *
+ *     static const Logger log = getLogger( package + ".function" );
+ *
+ * since the lookup allocates and, with log4cxx, searches the hierarchy.
+ * @{
+ */
+#define SCENE_LOG_LEVEL_TRACE 0
+#define SCENE_LOG_LEVEL_DEBUG 1
+#define SCENE_LOG_LEVEL_INFO  2
+#define SCENE_LOG_LEVEL_WARN  3
+#define SCENE_LOG_LEVEL_ERROR 4
+#define SCENE_LOG_LEVEL_FATAL 5
+/** @} */
+
+#ifndef SCENE_LOG_LEVEL
+#if defined(SCENE_LOG4CXX) && defined(DEBUG)
+#define SCENE_LOG_LEVEL SCENE_LOG_LEVEL_TRACE
+#elif defined(SCENE_LOG4CXX)
+#define SCENE_LOG_LEVEL SCENE_LOG_LEVEL_INFO
+#elif defined(DEBUG)
+#define SCENE_LOG_LEVEL SCENE_LOG_LEVEL_DEBUG
+#else
+#define SCENE_LOG_LEVEL SCENE_LOG_LEVEL_WARN
+#endif
+#endif
+
 #if SCENE_LOG4CXX
 typedef log4cxx::LoggerPtr Logger;
 static inline Logger getLogger( const std::string name ) { return log4cxx::Logger::getLogger( name ); }
-#define SCENELOG_TRACE(a,b) LOG4CXX_TRACE(a,b)
-#define SCENELOG_INFO(a,b) LOG4CXX_INFO(a,b)
-#define SCENELOG_DEBUG(a,b) LOG4CXX_DEBUG(a,b)
-#define SCENELOG_WARN(a,b) LOG4CXX_WARN(a,b)
-#define SCENELOG_ERROR(a,b) LOG4CXX_ERROR(a,b)
-#define SCENELOG_FATAL(a,b) LOG4CXX_FATAL(a,b)
+#define SCENELOG_OUTPUT_TRACE(a,b) LOG4CXX_TRACE(a,b)
+#define SCENELOG_OUTPUT_DEBUG(a,b) LOG4CXX_DEBUG(a,b)
+#define SCENELOG_OUTPUT_INFO(a,b)  LOG4CXX_INFO(a,b)
+#define SCENELOG_OUTPUT_WARN(a,b)  LOG4CXX_WARN(a,b)
+#define SCENELOG_OUTPUT_ERROR(a,b) LOG4CXX_ERROR(a,b)
+#define SCENELOG_OUTPUT_FATAL(a,b) LOG4CXX_FATAL(a,b)
 #else
 typedef std::string Logger;
 inline Logger getLogger( const std::string& component ) { return component; }
@@ -57,19 +95,43 @@ inline Logger getLogger( const std::string& component ) { return component; }
         } \
         std::cerr << "    " << b << std::endl; \
 } while(0)
-#define SCENELOG_TRACE(a,b)
-#ifdef DEBUG
-#define SCENELOG_DEBUG(a,b) SCENELOG_OUTPUT("[D]",a,b)
-#define SCENELOG_INFO(a,b) SCENELOG_OUTPUT("[I]",a,b)
-#else
-#define SCENELOG_DEBUG(a,b)
-#define SCENELOG_INFO(a,b)
+#define SCENELOG_OUTPUT_TRACE(a,b) SCENELOG_OUTPUT("[T]",a,b)
+#define SCENELOG_OUTPUT_DEBUG(a,b) SCENELOG_OUTPUT("[D]",a,b)
+#define SCENELOG_OUTPUT_INFO(a,b)  SCENELOG_OUTPUT("[I]",a,b)
+#define SCENELOG_OUTPUT_WARN(a,b)  SCENELOG_OUTPUT("[W]",a,b)
+#define SCENELOG_OUTPUT_ERROR(a,b) SCENELOG_OUTPUT("[E]",a,b)
+#define SCENELOG_OUTPUT_FATAL(a,b) SCENELOG_OUTPUT("[F]",a,b)
 #endif
 
-#define SCENELOG_WARN(a,b)  SCENELOG_OUTPUT("[W]",a,b)
-#define SCENELOG_ERROR(a,b) SCENELOG_OUTPUT("[E]",a,b)
-#define SCENELOG_FATAL(a,b) SCENELOG_OUTPUT("[F]",a,b)
+#define SCENELOG_DISABLED(a,b) do { } while(0)
+
+#if SCENE_LOG_LEVEL <= SCENE_LOG_LEVEL_TRACE
+#define SCENELOG_TRACE(a,b) SCENELOG_OUTPUT_TRACE(a,b)
+#else
+#define SCENELOG_TRACE(a,b) SCENELOG_DISABLED(a,b)
+#endif
+#if SCENE_LOG_LEVEL <= SCENE_LOG_LEVEL_DEBUG
+#define SCENELOG_DEBUG(a,b) SCENELOG_OUTPUT_DEBUG(a,b)
+#else
+#define SCENELOG_DEBUG(a,b) SCENELOG_DISABLED(a,b)
+#endif
+#if SCENE_LOG_LEVEL <= SCENE_LOG_LEVEL_INFO
+#define SCENELOG_INFO(a,b) SCENELOG_OUTPUT_INFO(a,b)
+#else
+#define SCENELOG_INFO(a,b) SCENELOG_DISABLED(a,b)
+#endif
+#if SCENE_LOG_LEVEL <= SCENE_LOG_LEVEL_WARN
+#define SCENELOG_WARN(a,b) SCENELOG_OUTPUT_WARN(a,b)
+#else
+#define SCENELOG_WARN(a,b) SCENELOG_DISABLED(a,b)
+#endif
+#if SCENE_LOG_LEVEL <= SCENE_LOG_LEVEL_ERROR
+#define SCENELOG_ERROR(a,b) SCENELOG_OUTPUT_ERROR(a,b)
+#else
+#define SCENELOG_ERROR(a,b) SCENELOG_DISABLED(a,b)
 #endif
+// Fatal messages are never removed, SCENELOG_ASSERT relies on them.
+#define SCENELOG_FATAL(a,b) SCENELOG_OUTPUT_FATAL(a,b)
 
 #define SCENELOG_ASSERT(a,b) do { if(!(b)) { SCENELOG_FATAL(a, __FILE__ << '@' << __LINE__<< ": Assertion " << #b << " failed." ); abort(); } } while(0)
 
@@ -71,6 +71,24 @@ public:
     void
     clearAttributes();
 
+    /** Get the shader symbol of the per-instance transform attribute.
+      *
+      * \returns The symbol of a mat4 vertex attribute that receives the
+      * object-to-world matrix of each instance, or an empty string if the pass
+      * doesn't support instanced drawing.
+      */
+    const std::string&
+    instanceTransformSymbol() const { return m_instance_transform_symbol; }
+
+    /** Let a mat4 vertex attribute receive the per-instance object-to-world matrix.
+      *
+      * A pass with an instance transform attribute is always drawn instanced,
+      * which lets the runtime coalesce draws of the same primitives with
+      * identical state into a single draw call.
+      */
+    void
+    setInstanceTransformSymbol( const std::string& symbol );
+
 
     /** Returns the number of uniform bindings. */
     const size_t
@@ -232,6 +250,7 @@ protected:
         std::string                m_symbol;
     };
     std::vector<Attribute>         m_attributes;
+    std::string                    m_instance_transform_symbol;
     struct Uniform {
         std::string                m_symbol;
         std::string                m_reference;
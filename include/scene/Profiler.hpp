@@ -0,0 +1,208 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <thread>
+#include <boost/utility.hpp>
+
+namespace Scene {
+
+/** Process-wide collection of scoped timings and counters.
+ *
+ * Timings are recorded as individual events, so that they can be inspected
+ * as a timeline with chrome://tracing (or any viewer of the Chrome trace
+ * event format) as well as aggregated per name. Counters are named running
+ * sums, e.g. cache hits.
+ *
+ * Recording is off until enabled with setEnabled(), and when off a scoped
+ * timer costs a single relaxed atomic load. The instrumentation macros
+ * SCENE_PROFILE_SCOPE and SCENE_PROFILE_COUNT expand to nothing unless the
+ * library is built with SCENE_PROFILER.
+ *
+ * All methods are thread-safe.
+ */
+class Profiler : boost::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock   Clock;
+
+    /** A single timed scope. */
+    struct Event
+    {
+        const char*     m_name;     ///< Static string given to the timer.
+        unsigned int    m_thread;   ///< Small integer identifying the thread.
+        double          m_begin;    ///< Microseconds since the profiler was created.
+        double          m_duration; ///< Microseconds.
+    };
+
+    /** Timings aggregated per name. */
+    struct Timing
+    {
+        size_t          m_calls;
+        double          m_total;    ///< Microseconds.
+        double          m_max;      ///< Microseconds.
+    };
+
+    /** Named running sum, owned by the profiler. */
+    class Counter : boost::noncopyable
+    {
+    public:
+        Counter() : m_value( 0 ) {}
+
+        void
+        add( long long delta )
+        { m_value.fetch_add( delta, std::memory_order_relaxed ); }
+
+        long long
+        value() const
+        { return m_value.load( std::memory_order_relaxed ); }
+
+    protected:
+        friend class Profiler;
+        std::atomic<long long>  m_value;
+    };
+
+    static Profiler&
+    instance();
+
+    static void
+    setEnabled( bool enabled )
+    { m_enabled.store( enabled, std::memory_order_relaxed ); }
+
+    static bool
+    enabled()
+    { return m_enabled.load( std::memory_order_relaxed ); }
+
+    /** Max number of events kept, later events are dropped and counted. */
+    void
+    setEventLimit( size_t limit );
+
+    /** Record a timed scope, name must be a string with static storage. */
+    void
+    addEvent( const char* name, Clock::time_point begin, Clock::time_point end );
+
+    /** Get the counter with a given name, creating it if needed.
+     *
+     * The counter lives as long as the profiler, so call sites look it up
+     * once and keep the pointer.
+     */
+    Counter*
+    counter( const std::string& name );
+
+    /** Current value of a counter, 0 if it doesn't exist. */
+    long long
+    counterValue( const std::string& name ) const;
+
+    /** All counters and their current values. */
+    std::map<std::string,long long>
+    counters() const;
+
+    /** Copy of the recorded events. */
+    std::vector<Event>
+    events() const;
+
+    /** Recorded events aggregated by name. */
+    std::map<std::string,Timing>
+    timings() const;
+
+    /** Number of events dropped since the last clear due to the event limit. */
+    size_t
+    droppedEvents() const;
+
+    /** Discard events and reset all counters to zero. */
+    void
+    clear();
+
+    /** Write events and counters in Chrome trace event format (JSON). */
+    void
+    writeChromeTrace( std::ostream& out ) const;
+
+    /** Write Chrome trace to a file, returns false on failure. */
+    bool
+    writeChromeTrace( const std::string& path ) const;
+
+protected:
+    Profiler();
+
+    static std::atomic<bool>                        m_enabled;
+    mutable std::mutex                              m_mutex;
+    const Clock::time_point                         m_epoch;
+    size_t                                          m_event_limit;
+    size_t                                          m_dropped;
+    std::vector<Event>                              m_events;
+    std::map<std::thread::id,unsigned int>          m_threads;
+    std::map<std::string,std::unique_ptr<Counter> > m_counters;
+};
+
+/** Records the lifetime of a scope as a profiler event, if enabled. */
+class ProfileScope : boost::noncopyable
+{
+public:
+    explicit
+    ProfileScope( const char* name )
+        : m_name( Profiler::enabled() ? name : NULL )
+    {
+        if( m_name != NULL ) {
+            m_begin = Profiler::Clock::now();
+        }
+    }
+
+    ~ProfileScope()
+    {
+        if( m_name != NULL ) {
+            Profiler::instance().addEvent( m_name, m_begin, Profiler::Clock::now() );
+        }
+    }
+
+protected:
+    const char*                 m_name;
+    Profiler::Clock::time_point m_begin;
+};
+
+} // of namespace Scene
+
+#define SCENE_PROFILE_CONCAT_(a,b) a##b
+#define SCENE_PROFILE_CONCAT(a,b) SCENE_PROFILE_CONCAT_(a,b)
+
+#ifdef SCENE_PROFILER
+/** Time the rest of the enclosing scope, name must be a string literal. */
+#define SCENE_PROFILE_SCOPE(name) \
+    ::Scene::ProfileScope SCENE_PROFILE_CONCAT(scene_profile_scope_,__LINE__)( name )
+
+/** Add delta to a named counter if the profiler is enabled. */
+#define SCENE_PROFILE_COUNT(name,delta) \
+    do { \
+        static ::Scene::Profiler::Counter* scene_profile_counter = \
+            ::Scene::Profiler::instance().counter( name ); \
+        if( ::Scene::Profiler::enabled() ) { \
+            scene_profile_counter->add( delta ); \
+        } \
+    } while(0)
+#else
+#define SCENE_PROFILE_SCOPE(name)
+#define SCENE_PROFILE_COUNT(name,delta) do { } while(0)
+#endif
@@ -20,6 +20,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include "scene/Scene.hpp"
 #include <scene/SeqPos.hpp>
 
@@ -40,6 +41,35 @@ public:
     void
     contents( const std::vector<int>& data );
 
+    /** Resize the buffer to hold count floats, and return the storage so that
+      * it can be filled in place.
+      */
+    float*
+    floatContents( size_t count );
+
+    /** Resize the buffer to hold count ints, and return the storage so that
+      * it can be filled in place.
+      */
+    int*
+    intContents( size_t count );
+
+    /** Let the buffer refer to data it doesn't own, e.g. a mapped snapshot.
+      *
+      * The data is not copied. The buffer keeps a reference to owner as long
+      * as it refers to the data, and the next call to contents, floatContents or
+      * intContents returns the buffer to owning its data.
+      *
+      * \param[in] type   The element type of the data.
+      * \param[in] count  The number of elements.
+      * \param[in] data   The elements, must be valid as long as owner is.
+      * \param[in] owner  Keeps the data alive.
+      */
+    void
+    reference( ElementType                         type,
+               size_t                              count,
+               const void*                         data,
+               const std::shared_ptr<const void>&  owner );
+
 
     const std::string&
     id() const { return m_id; }
@@ -51,7 +81,7 @@ public:
     elementCount() const { return m_element_count; }
 
     const void*
-    voidData() const { return m_host_data.data(); }
+    voidData() const { return m_external_data != NULL ? m_external_data : m_host_data.data(); }
 
     const int*
     intData() const;
@@ -67,6 +97,8 @@ protected:
     size_t                      m_element_size;
     size_t                      m_element_count;
     std::vector<unsigned char>  m_host_data;
+    const unsigned char*        m_external_data;
+    std::shared_ptr<const void> m_external_owner;
 
     SourceBuffer( DataBase& db, const std::string& id );
 
@@ -45,6 +45,35 @@ public:
     bool
     parseMemory( const char* buffer );
 
+    /** Enable streaming import of files.
+      *
+      * In streaming mode, parse reads the file incrementally and only keeps
+      * the tree of a single top-level library item (e.g. one \<geometry\>)
+      * in memory at a time, instead of the tree of the whole document. The
+      * setting also applies to files included from the parsed file.
+      */
+    void
+    setStreaming( bool streaming ) { m_streaming = streaming; }
+
+    bool
+    streaming() const { return m_streaming; }
+
+    /** Enable parallel decoding of geometry and image payloads.
+      *
+      * In parallel mode, parseCollada first collects the number arrays of all
+      * \<geometry\> elements and the files referenced by all \<image\>
+      * elements, and parses and decodes these concurrently into staging
+      * buffers. The regular parse then consumes the staged results, so items
+      * are still added to the libraries by a single thread in document order,
+      * and the resulting database is identical to a serial import. The setting
+      * also applies to files included from the parsed file.
+      */
+    void
+    setParallel( bool parallel ) { m_parallel = parallel; }
+
+    bool
+    parallel() const { return m_parallel; }
+
     /** Parse a \<COLLADA\> node.
       *
       * Recognizes the following elements:
@@ -90,8 +119,25 @@ protected:
     };
 
 
+    /** An image file read and decoded ahead of time, see setParallel. */
+    struct StagedImage {
+        bool                        m_retrieved;
+        bool                        m_decoded;
+        GLenum                      m_iformat;
+        GLenum                      m_format;
+        GLenum                      m_type;
+        unsigned int                m_width;
+        unsigned int                m_height;
+        std::vector<unsigned char>  m_data;
+    };
+
     Scene::DataBase&          m_database;
     std::string               m_base_path;
+    bool                      m_streaming;
+    bool                      m_parallel;
+    std::unordered_map<xmlNodePtr,std::vector<float> >  m_staged_floats;
+    std::unordered_map<xmlNodePtr,std::vector<int> >    m_staged_ints;
+    std::unordered_map<xmlNodePtr,StagedImage>          m_staged_images;
     const std::string         m_namespace;
     static const std::string  m_vertex_semantics[ VERTEX_SEMANTIC_N ];
 
@@ -100,6 +146,48 @@ protected:
     const std::string
     resolvePath( const std::string path );
 
+    /** Parse a file using libxml2's xmlTextReader, see setStreaming. */
+    bool
+    parseStreaming( const std::string& path );
+
+    /** Parse a single streamed item by wrapping it in a minimal document.
+      *
+      * \param[in] collada  Shell of the \<COLLADA\> element (attributes only).
+      * \param[in] asset    Top-level \<asset\>, may be NULL.
+      * \param[in] library  Shell of the enclosing library element, or NULL if
+      *                     item is a direct child of \<COLLADA\>.
+      * \param[in] library_asset  The \<asset\> of the library, may be NULL.
+      * \param[in] item     The item to parse.
+      */
+    bool
+    parseStreamedItem( xmlNodePtr collada,
+                       xmlNodePtr asset,
+                       xmlNodePtr library,
+                       xmlNodePtr library_asset,
+                       xmlNodePtr item );
+
+    /** Parse geometry number arrays and decode images of a \<COLLADA\> node
+      * concurrently into the staging maps, see setParallel.
+      */
+    void
+    stageLibraries( xmlNodePtr collada_node );
+
+    /** Drop staged results that were not consumed by the parse. */
+    void
+    clearStaged();
+
+    /** Find the URL of an image's \<init_from\>.
+      *
+      * \param[in] quiet  Do not log unsupported constructs.
+      * \returns False if the image data is not given by reference.
+      */
+    bool
+    initFromURL( std::string& url, xmlNodePtr init_from_node, bool quiet );
+
+    /** Read and decode an image file, thread-safe. */
+    void
+    decodeImage( StagedImage& image, const std::string& url );
+
     /** Removes some uneccessary nodes from the tree, to simplify parsing. */
     void
     clean( xmlNodePtr xml_node );
@@ -195,6 +283,16 @@ protected:
     const std::string
     getBody( xmlNodePtr node );
 
+    /** Get the text body of a node, without copying it if possible.
+      *
+      * \param[out] copy  Set to a copy of the body if the body is split over
+      *                   several nodes, otherwise NULL. Must be released
+      *                   using xmlFree.
+      * \returns A pointer to the zero-terminated text body, never NULL.
+      */
+    static const char*
+    bodyText( xmlChar*& copy, xmlNodePtr node );
+
     bool
     parseBodyAsInts( std::vector<int>& result, xmlNodePtr node, size_t expected, size_t offset=0, size_t stride=1 );
 
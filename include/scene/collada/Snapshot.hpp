@@ -0,0 +1,64 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include "scene/Scene.hpp"
+
+namespace Scene {
+    namespace Collada {
+
+/** Write a binary snapshot of a database.
+ *
+ * A snapshot holds the contents of all libraries of a database, and is
+ * intended to be written once after import and post-processing (e.g.
+ * Geometry::flatten, Tools::updateBoundingBoxes, and
+ * Tools::generateShadersFromCommon), so that later runs can skip this work.
+ *
+ * The file starts with a versioned header, followed by the payloads of all
+ * source buffers and images (aligned for direct use from a memory mapping), a
+ * binary description of source buffers, images and geometries, and finally
+ * the remaining libraries as COLLADA text produced by Exporter.
+ *
+ * Snapshots are not portable between machines of different byte order.
+ *
+ * \param[in] database  The database to write.
+ * \param[in] path      The file to write.
+ * \returns True on success.
+ */
+bool
+writeSnapshot( const DataBase& database, const std::string& path );
+
+/** Load a snapshot written by writeSnapshot into a database.
+ *
+ * The file is memory mapped, and source buffers and images refer directly to
+ * their payloads in the mapping instead of holding a copy, see
+ * SourceBuffer::reference and Image::reference. The mapping is released when
+ * the last such item is deleted or given new contents.
+ *
+ * \param[in] database  The database to add the contents to.
+ * \param[in] path      The file to read.
+ * \returns True on success, false if the file could not be mapped, has the
+ *          wrong version or byte order, or is corrupt.
+ */
+bool
+readSnapshot( DataBase& database, const std::string& path );
+
+    } // of namespace Collada
+} // of namespace Scene
@@ -20,6 +20,8 @@
 
 #include <scene/runtime/RenderList.hpp>
 #include <scene/runtime/TransformCache.hpp>
+#include <scene/runtime/BoundingVolumeHierarchy.hpp>
+#include <scene/runtime/OcclusionCuller.hpp>
 #include <scene/glsl/GLSLRuntime.hpp>
 
 namespace Scene {
@@ -66,18 +68,175 @@ public:
     renderList() const
     { return m_renderlist; }
 
+    /** Access the transform cache, e.g. to enable incremental updates. */
+    TransformCache&
+    transformCache()
+    { return m_transform_cache; }
+
+    /** Counts of GL state switches with and without state sorting. */
+    struct SortStatistics
+    {
+        size_t  m_items;                ///< Number of drawable items.
+        size_t  m_segments;             ///< Number of ranges sorted independently.
+        size_t  m_program_switches;     ///< Program switches in traversal order.
+        size_t  m_program_switches_sorted;
+        size_t  m_vao_switches;         ///< VAO switches in traversal order.
+        size_t  m_vao_switches_sorted;
+        size_t  m_sampler_switches;     ///< Sampler set switches in traversal order.
+        size_t  m_sampler_switches_sorted;
+    };
+
+    /** Enable or disable state sorting of draw submission.
+      *
+      * When enabled, the items of the render list are reordered after a
+      * rebuild to minimize program, vertex array and sampler switches. Items
+      * are only moved within ranges that share framebuffer and view, and
+      * items whose result depend on submission order (blending, no depth test
+      * or no depth writes) act as barriers that are never moved. Multiple
+      * passes over the same primitives keep their relative order.
+      *
+      * Takes effect at the next rebuild of the render list. Default is off.
+      */
+    void
+    setStateSorting( bool enable );
+
+    bool
+    stateSorting() const
+    { return m_state_sorting; }
+
+    /** Enable or disable hierarchical frustum culling.
+      *
+      * When enabled, the world-space bounding boxes of the items are kept in
+      * a BoundingVolumeHierarchy that is refitted and traversed once per
+      * frame, instead of transforming and testing the bounding box of every
+      * item. The hierarchical test is conservative, but may keep a few more
+      * items than the per-item test since it uses world-space bounding
+      * boxes.
+      *
+      * Takes effect at the next rebuild of the render list. Default is on.
+      */
+    void
+    setHierarchicalCulling( bool enable );
+
+    bool
+    hierarchicalCulling() const
+    { return m_hierarchical_culling; }
+
+    /** Enable or disable software occlusion culling.
+      *
+      * When enabled, the items that survive frustum culling are tested
+      * against a low-resolution depth buffer of the largest items, which is
+      * rasterized on the CPU each frame, see OcclusionCuller. Requires
+      * hierarchical culling.
+      *
+      * Takes effect at the next rebuild of the render list. Default is off.
+      */
+    void
+    setOcclusionCulling( bool enable );
+
+    bool
+    occlusionCulling() const
+    { return m_occlusion_culling; }
+
+    /** Access the occlusion culler, e.g. to tune resolution and occluders. */
+    OcclusionCuller&
+    occlusionCuller()
+    { return m_occlusion; }
+
+    /** Number of items outside the frustum in the last render, only counted
+      * with hierarchical culling. */
+    size_t
+    frustumCulledItems() const
+    { return m_bvh.items() - m_bvh.visibleItems(); }
+
+    /** Number of items in the frustum but occluded in the last render. */
+    size_t
+    occlusionCulledItems() const
+    { return m_occlusion.items() != 0 ? m_occlusion.culledItems() : 0; }
+
+    /** Switch counts from the last sort, all zero if sorting is disabled. */
+    const SortStatistics&
+    sortStatistics() const
+    { return m_sort_statistics; }
+
+    /** Number of uniform values uploaded by the last render. */
+    size_t
+    uniformUploads() const
+    { return m_uniform_uploads; }
+
+    /** Number of uniform uploads skipped by the last render since the program
+      * already held the value, see GLSLShader::uniformChanged.
+      */
+    size_t
+    uniformUploadsSkipped() const
+    { return m_uniform_uploads_skipped; }
+
+    /** Number of draw calls issued by the last render. */
+    size_t
+    drawCalls() const
+    { return m_draw_calls; }
+
+    /** Number of shader program switches issued by the last render. */
+    size_t
+    programSwitches() const
+    { return m_program_switches; }
+
+    /** Number of vertex array binds issued by the last render. */
+    size_t
+    vertexArrayBinds() const
+    { return m_vertex_array_binds; }
+
+    /** Number of items not drawn by the last render, either culled or folded
+      * into an instanced draw.
+      */
+    size_t
+    skippedItems() const
+    { return m_skipped_items; }
+
 protected:
     struct GLSLItem
     {
+        /** Frustum test of the item, NULL if the item is never drawn. */
         const Value*                m_bbox_test;
+        /** Item in m_bvh if m_bbox_test is m_bvh_test. */
+        size_t                      m_cull_index;
         std::vector<const Value*>   m_uniform_values;
         GLSLFrameBuffer*            m_glsl_framebuffer;
         GLSLShader*                 m_glsl_pass;
         GLSLVertexArray*            m_glsl_inputs;
         GLSLSamplers*               m_glsl_samplers;
         GLSLBuffer*                 m_glsl_indices;
+        /** Object-to-world matrix if the pass is drawn instanced, else NULL. */
+        const Value*                m_instance_transform;
+        /** Number of items in submission order drawn as instances of this
+          * item, or 0 if this item is drawn by an earlier item. */
+        size_t                      m_instance_run;
+        GLsizei                     m_instance_first;   ///< Set by updateInstances.
+        GLsizei                     m_instance_count;   ///< Set by updateInstances.
     };
     std::vector<GLSLItem>           m_glsl_items;
+    /** When m_glsl_items were last set up. */
+    SeqPos                          m_items_updated;
+    /** Submission order of m_glsl_items, identity unless state sorting is on. */
+    std::vector<size_t>             m_glsl_order;
+    bool                            m_state_sorting;
+    bool                            m_hierarchical_culling;
+    BoundingVolumeHierarchy         m_bvh;
+    bool                            m_occlusion_culling;
+    /** Has the same items as m_bvh if occlusion culling is on, else none. */
+    OcclusionCuller                 m_occlusion;
+    /** Stand-in for m_bbox_test of items culled by m_bvh. */
+    Value                           m_bvh_test;
+    SortStatistics                  m_sort_statistics;
+    size_t                          m_uniform_uploads;
+    size_t                          m_uniform_uploads_skipped;
+    size_t                          m_draw_calls;
+    size_t                          m_program_switches;
+    size_t                          m_vertex_array_binds;
+    size_t                          m_skipped_items;
+    GLSLStreamBuffer                m_instance_stream;
+    StreamRing                      m_instance_ring;
+    bool                            m_instance_ring_active;
 
 
     GLSLRuntime&                   m_runtime;
@@ -122,6 +281,59 @@ protected:
     void
     majorUpdate();
 
+    /** Update after the render list has been patched.
+      *
+      * Only the new items are set up, the rest keep their GL objects and
+      * transform cache values. The culling structures, the submission order
+      * and the action list are rebuilt.
+      */
+    void
+    patchUpdate();
+
+    /** Get the GL objects and uniform values of an item.
+      *
+      * \returns False if the item cannot be drawn, its m_bbox_test is then
+      *          NULL.
+      */
+    bool
+    setupItem( GLSLItem& glsl_item, const RenderList::Item& item );
+
+    /** Rebuild m_bvh and m_occlusion from the items culled hierarchically. */
+    void
+    updateCulling();
+
+    /** Rebuild m_glsl_list from the operations of the render list. */
+    void
+    updateActionList();
+
+    /** True if an item that is drawn has passed frustum culling. */
+    bool
+    itemVisible( const GLSLItem& glsl_item ) const
+    {
+        if( glsl_item.m_bbox_test == &m_bvh_test ) {
+            return m_occlusion.items() != 0 ? m_occlusion.visible( glsl_item.m_cull_index )
+                                            : m_bvh.visible( glsl_item.m_cull_index );
+        }
+        return glsl_item.m_bbox_test->boolData()[0] == GL_TRUE;
+    }
+
+    /** Populate m_glsl_order from m_glsl_items, sorting if enabled. */
+    void
+    sortItems();
+
+    /** True if two items only differ in their local transform. */
+    bool
+    sameInstanceState( size_t a, size_t b ) const;
+
+    /** Find runs of items in submission order that only differ in transform
+      * and can be drawn by a single instanced draw. */
+    void
+    coalesceInstances();
+
+    /** Write the transforms of the visible instances into the instance ring. */
+    void
+    updateInstances();
+
 
     void
     calcuateTransforms( std::vector<Value>& runtime_semantics_value,
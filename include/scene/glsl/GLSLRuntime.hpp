@@ -24,6 +24,7 @@
 #include <scene/SeqPos.hpp>
 #include "scene/DataBase.hpp"
 #include "scene/runtime/Resolver.hpp"
+#include "scene/runtime/StreamRing.hpp"
 
 namespace Scene {
     namespace Runtime {
@@ -92,12 +93,37 @@ public:
     GLsizei
     attribElementSize( size_t ix ) const { return m_attributes[ix].m_element_size; }
 
+    /** Location of the per-instance transform attribute, or -1 if the
+      * program is not drawn instanced, see Pass::instanceTransformSymbol. */
+    GLint
+    instanceTransformLocation() const { return m_instance_transform_location; }
+
     GLint
     uniformLocation( size_t ix ) const { return m_uniforms[ix].m_location; }
 
     ValueType
     uniformType( size_t ix ) const { return m_uniforms[ix].m_type; }
 
+    /** Check a uniform value against the value last uploaded to the program.
+      *
+      * A program retains its uniform values across draws and frames, so a
+      * value equal to the one last uploaded to a location need not be sent
+      * again. Values are compared by contents, as many items refer to
+      * distinct Values holding the same data.
+      *
+      * \returns True if the value differs from the shadow copy, in which case
+      * the shadow copy is updated and the caller must upload the value.
+      */
+    bool
+    uniformChanged( size_t ix, const Value* value );
+
+    /** Forget the shadow copies, forcing all uniforms to be uploaded again.
+      *
+      * Must be called if uniforms of the program are set by other means.
+      */
+    void
+    invalidateUniformShadow();
+
     /** Returns the primitive type that the shader expects
       *
       * \returns GL_PATCHES if the shader contains a tessellation shader,
@@ -122,9 +148,15 @@ protected:
         GLint               m_components;
     };
     std::vector<Attribute>  m_attributes;
+    GLint                   m_instance_transform_location;
     struct Uniform {
         GLint               m_location;
         ValueType           m_type;
+        ValueType           m_shadow_type;  ///< VALUE_TYPE_N if shadow is invalid.
+        union {
+            float           m_floats[16];
+            int             m_ints[1];
+        }                   m_shadow;
     };
     std::vector<Uniform>    m_uniforms;
     GLenum     m_expected_input_primitive_type;
@@ -160,7 +192,7 @@ public:
     void
     pull( const std::vector<const GLSLBuffer*> sources,
           const GLSLShader*                    shader,
-          const std::vector<SetInputs::Item>&  items );
+          const ItemArray<SetInputs::Item>&    items );
 
 
 protected:
@@ -299,6 +331,46 @@ protected:
 };
 
 
+/** Buffer object for streaming per-frame data through a StreamRing.
+ *
+ * Uses a persistently and coherently mapped buffer with fences when
+ * ARB_buffer_storage is available. Otherwise, the data is written to host
+ * memory and uploaded with glBufferSubData when flushed, which the driver
+ * synchronises.
+ */
+class GLSLStreamBuffer : public StreamRingBackend, boost::noncopyable
+{
+public:
+    GLSLStreamBuffer( GLenum target = GL_ARRAY_BUFFER );
+
+    ~GLSLStreamBuffer();
+
+    GLuint
+    buffer() const { return m_buffer; }
+
+    unsigned char*
+    map( size_t bytes );
+
+    void
+    flush( size_t offset, size_t bytes );
+
+    void
+    fence( size_t region );
+
+    void
+    wait( size_t region );
+
+protected:
+    GLenum                      m_target;
+    GLuint                      m_buffer;
+    bool                        m_persistent;
+    std::vector<GLsync>         m_fences;
+    std::vector<unsigned char>  m_host;
+
+    void
+    release();
+};
+
 class GLSLRuntime
 {
 public:
@@ -352,7 +424,7 @@ public:
       * \returns True if no errors, false otherwise.
       */
     static bool
-    checkGL( Logger& log, const std::string& message = "" );
+    checkGL( const Logger& log, const std::string& message = "" );
 
 
 protected:
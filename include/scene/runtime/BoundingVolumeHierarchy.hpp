@@ -0,0 +1,175 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <scene/Scene.hpp>
+#include <scene/SeqPos.hpp>
+
+namespace Scene {
+    namespace Runtime {
+
+/** Bounding volume hierarchy used to frustum cull render items.
+  *
+  * Each item has an object-space bounding box, a world-from-object matrix and
+  * a clip-from-world matrix, all given as values that are usually owned by a
+  * TransformCache. Items with the same clip-from-world matrix share a view,
+  * and each view has a separate hierarchy over the world-space bounding boxes
+  * of its items.
+  *
+  * The hierarchies are built on the first update after items have been
+  * added. Later updates only recompute the bounds of items whose matrix or
+  * bounding box has changed and refit the nodes above them. A view is rebuilt
+  * from scratch if more than half of its items have changed.
+  *
+  * Culling tests the nodes against the six frustum planes of the view, so a
+  * subtree that is completely outside or completely inside the frustum is
+  * resolved by a single test. The result is conservative: an item is only
+  * culled if its world-space bounding box is outside one of the planes.
+  */
+class BoundingVolumeHierarchy
+{
+public:
+    BoundingVolumeHierarchy();
+
+    /** Remove all items. */
+    void
+    clear();
+
+    /** Add an item and return its index.
+      *
+      * \param[in] clip_from_world    Projection times eye-from-world matrix of
+      *                               the view, the item is never culled if NULL.
+      * \param[in] world_from_object  Placement of the item, NULL for identity.
+      * \param[in] bbox_min           Object-space bounding box min (float4),
+      *                               the item is never culled if NULL.
+      * \param[in] bbox_max           Object-space bounding box max (float4).
+      */
+    size_t
+    add( const Value*  clip_from_world,
+         const Value*  world_from_object,
+         const Value*  bbox_min,
+         const Value*  bbox_max );
+
+    /** Refit or rebuild the hierarchies and cull the items.
+      *
+      * Should be invoked once per frame after the values passed to add have
+      * been updated.
+      */
+    void
+    update();
+
+    /** Number of items. */
+    size_t
+    items() const { return m_items.size(); }
+
+    /** Returns true if an item intersects the frustum of its view. */
+    bool
+    visible( size_t item ) const { return m_visible[ item ] != 0; }
+
+    /** Number of visible items after the last update. */
+    size_t
+    visibleItems() const { return m_visible_items; }
+
+    /** Number of items whose bounds were recomputed by the last update. */
+    size_t
+    lastRefitCount() const { return m_last_refit_count; }
+
+    /** Number of node and item plane tests done by the last update. */
+    size_t
+    lastTestCount() const { return m_last_test_count; }
+
+protected:
+    struct Item
+    {
+        const Value*            m_world_from_object;
+        const Value*            m_bbox_min;
+        const Value*            m_bbox_max;
+        SeqPos                  m_seen;         ///< Most recent change of sources when bounds were computed.
+        uint32_t                m_leaf;         ///< Node that holds this item.
+        float                   m_center[3];    ///< World-space bounding box.
+        float                   m_extent[3];
+    };
+
+    /** Nodes are stored in preorder, the children of a node are adjacent. */
+    struct Node
+    {
+        float                   m_min[3];
+        float                   m_max[3];
+        uint32_t                m_parent;
+        uint32_t                m_child;        ///< First child, 0 if leaf.
+        uint32_t                m_begin;        ///< Items in m_order.
+        uint32_t                m_end;
+        bool                    m_dirty;
+    };
+
+    struct View
+    {
+        const Value*            m_clip_from_world;
+        std::vector<uint32_t>   m_order;        ///< Items, grouped by subtree.
+        std::vector<Node>       m_nodes;
+        bool                    m_built;
+        SeqPos                  m_culled;       ///< Most recent change of clip-from-world when culled.
+        /** Frustum planes as (x, y, z, w) and absolute normals, padded to
+          * eight planes to fill two SIMD registers. */
+        float                   m_planes[4][8];
+        float                   m_abs_normals[3][8];
+    };
+
+    std::vector<Item>           m_items;
+    std::vector<View>           m_views;
+    std::vector<uint32_t>       m_unbounded;    ///< Items that are never culled.
+    std::vector<unsigned char>  m_visible;
+    size_t                      m_visible_items;
+    size_t                      m_last_refit_count;
+    size_t                      m_last_test_count;
+
+    /** Recompute the world-space bounds of an item from its sources. */
+    void
+    computeBounds( Item& item );
+
+    void
+    build( View& view );
+
+    /** Build the subtree of a node over the items m_order[begin,end). */
+    void
+    buildNode( View& view, uint32_t index, uint32_t begin, uint32_t end );
+
+    void
+    refit( View& view );
+
+    /** Extract the frustum planes of a view from its clip-from-world matrix. */
+    void
+    extractPlanes( View& view );
+
+    void
+    cull( View& view );
+
+    /** Test a box against the planes of a view.
+      *
+      * \returns -1 if outside, 1 if inside, 0 if intersecting.
+      */
+    static int
+    classify( const View& view, const float* center, const float* extent );
+
+};
+
+    } // of namespace Runtime
+} // of namespace Scene
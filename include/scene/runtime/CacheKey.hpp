@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include "scene/Scene.hpp"
 
 namespace Scene {
@@ -73,7 +74,7 @@ public:
         return m_pointers[ ix ];
     }
 
-    const void*&
+    const void*
     operator[]( size_t ix ) const
     {
         return m_pointers[ ix ];
@@ -91,18 +92,25 @@ public:
     }
 
 
-    // Hash function
+    /** Hash function.
+     *
+     * Pointers have few significant bits (allocation alignment zeroes the low
+     * bits, and the high bits are usually equal), so each pointer is folded in
+     * with a multiply-xorshift step and the result is finalized using the
+     * MurmurHash3 64-bit mixer.
+     */
     size_t
-    hash( /*const CacheKey<N>& key*/ ) const
+    hash() const
     {
-        // Hash-function-hack
-        size_t hash = reinterpret_cast<size_t>( m_pointers[0] );
-        for( size_t i=1; i<N; i++) {
-            // multiply by 13?
-            // Note: key values can be zero on upper -> giving bad hash'es
-            hash ^= (hash <<13) ^ reinterpret_cast<size_t>( m_pointers[i] );
+        uint64_t h = 0x9e3779b97f4a7c15ull;
+        for( size_t i=0; i<N; i++) {
+            h = ( h ^ static_cast<uint64_t>( reinterpret_cast<uintptr_t>( m_pointers[i] ) ) ) * 0xff51afd7ed558ccdull;
+            h ^= h >> 32;
         }
-        return hash;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return static_cast<size_t>( h );
     }
 
     size_t
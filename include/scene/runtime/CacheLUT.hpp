@@ -19,96 +19,134 @@
 #pragma once
 
 #include <vector>
-#include <unordered_map>
+#include <algorithm>
 #include <scene/runtime/CacheKey.hpp>
 
 namespace Scene {
     namespace Runtime {
 
-#if 1
-
+/** Lookup table from pointer-tuples to indices.
+ *
+ * Flat open-addressing hash table with linear probing. Each slot holds the
+ * full hash, the key, and the value, so a probe usually touches a single
+ * cache line, and the full pointer tuple is only compared on a hash match.
+ * The table never shrinks; clear() keeps the storage so that the rebuild
+ * following a purge does not need to reallocate.
+ */
 template<size_t N>
 class CacheLUT
 {
 public:
     typedef CacheKey<N> Key;
 
+    CacheLUT()
+        : m_count( 0 )
+    {}
+
     void
     clear()
-    { m_map.clear(); }
+    {
+        if( m_count > 0 ) {
+            for( size_t i=0; i<m_slots.size(); i++ ) {
+                m_slots[i].m_value = none();
+            }
+            m_count = 0;
+        }
+    }
 
     static const size_t
     none()
     { return static_cast<size_t>( ~0ul ); }
 
+    /** Number of keys in the table. */
+    size_t
+    size() const
+    { return m_count; }
+
+    /** Associate key with value, replacing any existing value.
+     *
+     * \note The value none() is reserved to mark empty slots.
+     */
     void
     insert( const Key& key, const size_t value )
-    { m_map[ key ] = value; }
+    {
+        if( 4*(m_count+1) > 3*m_slots.size() ) {
+            grow();
+        }
+        const size_t h = key.hash();
+        const size_t mask = m_slots.size()-1;
+        for( size_t i = h & mask; ; i = (i+1) & mask ) {
+            Slot& slot = m_slots[i];
+            if( slot.m_value == none() ) {
+                slot.m_hash = h;
+                slot.m_key = key;
+                slot.m_value = value;
+                m_count++;
+                return;
+            }
+            else if( (slot.m_hash == h) && (slot.m_key == key) ) {
+                slot.m_value = value;
+                return;
+            }
+        }
+    }
 
     const size_t
-    find( const Key& key )
+    find( const Key& key ) const
     {
-        auto it = m_map.find( key );
-        if( it == m_map.end() ) {
+        if( m_count == 0 ) {
             return none();
         }
-        else {
-            return it->second;
+        const size_t h = key.hash();
+        const size_t mask = m_slots.size()-1;
+        for( size_t i = h & mask; ; i = (i+1) & mask ) {
+            const Slot& slot = m_slots[i];
+            if( slot.m_value == none() ) {
+                return none();
+            }
+            else if( (slot.m_hash == h) && (slot.m_key == key) ) {
+                return slot.m_value;
+            }
         }
     }
 
 
 protected:
-    std::unordered_map<CacheKey<N>,size_t>  m_map;
-
-};
-
-
-
-#else
-template<size_t N>
-class CacheLUT
-{
-public:
-    typedef CacheKey<N> Key;
+    struct Slot {
+        size_t      m_hash;
+        size_t      m_value;    ///< none() marks an empty slot.
+        Key         m_key;
+    };
+    std::vector<Slot>   m_slots;
+    size_t              m_count;
 
+    /** Double the capacity (minimum 16 slots) and reinsert all keys. */
     void
-    clear()
-    { m_items.clear(); }
+    grow()
+    {
+        std::vector<Slot> slots;
+        slots.swap( m_slots );
 
-    static const size_t
-    none()
-    { return static_cast<size_t>( ~0ul ); }
+        const size_t capacity = std::max( size_t(16), 2*slots.size() );
+        m_slots.resize( capacity );
+        for( size_t i=0; i<capacity; i++ ) {
+            m_slots[i].m_value = none();
+        }
 
-    size_t
-    find( const CacheKey<N>& key )
-    {
-        for( size_t i=0; i<m_items.size(); i++ ) {
-            if( m_items[i].m_key == key ) {
-                return m_items[i].m_value;
+        const size_t mask = capacity-1;
+        for( size_t j=0; j<slots.size(); j++ ) {
+            if( slots[j].m_value != none() ) {
+                size_t i = slots[j].m_hash & mask;
+                while( m_slots[i].m_value != none() ) {
+                    i = (i+1) & mask;
+                }
+                m_slots[i] = slots[j];
             }
         }
-        return none();
-    }
-
-    void
-    insert( const CacheKey<N>& key, const size_t value )
-    {
-        m_items.resize( m_items.size()+1);
-        m_items.back().m_key   = key;
-        m_items.back().m_value = value;
     }
 
-protected:
-    struct Item {
-        CacheKey<N>     m_key;
-        size_t          m_value;
-    };
-    std::vector<Item>   m_items;
 };
 
-#endif
-
 
     }
 }
@@ -0,0 +1,223 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <scene/Scene.hpp>
+
+namespace Scene {
+    namespace Runtime {
+        class BoundingVolumeHierarchy;
+
+/** Software occlusion culling of render items on the CPU.
+  *
+  * Items are registered with the same matrices as in BoundingVolumeHierarchy,
+  * along with the geometry and primitive set they draw. Each update, and for
+  * each view:
+  *
+  * - The bounding box of every candidate item, i.e. those that passed frustum
+  *   culling, is projected to a screen rectangle and a nearest depth.
+  * - The candidates with the largest screen rectangles are chosen as
+  *   occluders, if they draw indexed or non-indexed triangles with unshared
+  *   inputs, not too many triangles and no more triangles than their
+  *   rectangle has pixels.
+  * - The triangles of the occluders are rasterized into a low-resolution
+  *   depth buffer, split into horizontal bands that are rasterized in
+  *   parallel. Each triangle is written at its farthest depth, so the buffer
+  *   never claims more occlusion than the geometry provides.
+  * - A candidate is culled if its screen rectangle, grown by one pixel, is
+  *   entirely covered by nearer occluder depths.
+  *
+  * Items whose bounding box crosses the near plane, or that have no bounding
+  * box, are never culled.
+  */
+class OcclusionCuller
+{
+public:
+    OcclusionCuller( const DataBase& database );
+
+    /** Remove all items. */
+    void
+    clear();
+
+    /** Set the resolution of the depth buffer, the width is rounded up to a
+      * multiple of four. The default is 256x128. */
+    void
+    setResolution( unsigned int width, unsigned int height );
+
+    unsigned int
+    width() const { return m_width; }
+
+    unsigned int
+    height() const { return m_height; }
+
+    /** Set the max number of occluders per view, default is 32. */
+    void
+    setMaxOccluders( size_t occluders ) { m_max_occluders = occluders; }
+
+    /** Set the max number of triangles of an occluder, default is 4096. */
+    void
+    setMaxOccluderTriangles( size_t triangles ) { m_max_occluder_triangles = triangles; }
+
+    /** Set the number of threads used by update, including the calling
+      * thread. Only has an effect when Scene is built with SCENE_THREADS. The
+      * default is the number of hardware threads.
+      */
+    void
+    setThreads( size_t threads ) { m_threads = threads < 1 ? 1 : threads; }
+
+    size_t
+    threads() const { return m_threads; }
+
+    /** Add an item and return its index.
+      *
+      * \param[in] clip_from_world    Projection times eye-from-world matrix of
+      *                               the view, the item is never culled if NULL.
+      * \param[in] world_from_object  Placement of the item, NULL for identity.
+      * \param[in] geometry           The geometry of the item, provides the
+      *                               bounding box and occluder vertices.
+      * \param[in] primitives         The primitive set drawn by the item,
+      *                               provides occluder triangles.
+      */
+    size_t
+    add( const Value*       clip_from_world,
+         const Value*       world_from_object,
+         const Geometry*    geometry,
+         const Primitives*  primitives );
+
+    /** Rasterize occluders and test the items.
+      *
+      * \param[in] frustum  If not NULL, only items that are visible in the
+      *                     frustum are considered. The hierarchy must have
+      *                     the same items, added in the same order.
+      */
+    void
+    update( const BoundingVolumeHierarchy* frustum = NULL );
+
+    size_t
+    items() const { return m_items.size(); }
+
+    /** Returns true if an item passed frustum and occlusion culling. */
+    bool
+    visible( size_t item ) const { return m_visible[ item ] != 0; }
+
+    /** Number of visible items after the last update. */
+    size_t
+    visibleItems() const { return m_visible_items; }
+
+    /** Number of items culled by occlusion, not by the frustum, in the last
+      * update. */
+    size_t
+    culledItems() const { return m_culled_items; }
+
+    /** Number of occluders rasterized by the last update. */
+    size_t
+    lastOccluders() const { return m_last_occluders; }
+
+    /** Number of occluder triangles rasterized by the last update. */
+    size_t
+    lastTriangles() const { return m_last_triangles; }
+
+protected:
+    struct Item
+    {
+        const Value*            m_clip_from_world;
+        const Value*            m_world_from_object;
+        const Value*            m_bbox_min;         ///< NULL if no bounding box.
+        const Value*            m_bbox_max;
+        const Geometry*         m_geometry;
+        const Primitives*       m_primitives;
+        bool                    m_occluder;         ///< Has triangles that can be rasterized.
+    };
+
+    /** Items that share a clip-from-world matrix. */
+    struct View
+    {
+        const Value*            m_clip_from_world;
+        std::vector<uint32_t>   m_items;
+    };
+
+    /** Screen-space bounds of a candidate. */
+    struct Rect
+    {
+        uint32_t                m_item;
+        int                     m_x0, m_y0, m_x1, m_y1; ///< Inclusive pixel bounds.
+        float                   m_z;                ///< Nearest depth.
+        bool                    m_valid;            ///< In front of the near plane and on screen.
+    };
+
+    /** Screen-space triangle. */
+    struct Triangle
+    {
+        float                   m_x[3];
+        float                   m_y[3];
+        float                   m_z;                ///< Farthest depth.
+    };
+
+    const DataBase&             m_database;
+    unsigned int                m_width;
+    unsigned int                m_height;
+    size_t                      m_max_occluders;
+    size_t                      m_max_occluder_triangles;
+    size_t                      m_threads;
+    std::vector<Item>           m_items;
+    std::vector<View>           m_views;
+    std::vector<uint32_t>       m_unbounded;        ///< Items without a view.
+    std::vector<unsigned char>  m_visible;
+    size_t                      m_visible_items;
+    size_t                      m_culled_items;
+    size_t                      m_last_occluders;
+    size_t                      m_last_triangles;
+
+    // Per-view scratch, kept to avoid reallocation.
+    std::vector<float>          m_depth;
+    std::vector<Rect>           m_rects;
+    std::vector<Triangle>       m_triangles;
+
+    /** Returns true if an item draws triangles that can be rasterized. */
+    bool
+    occluderData( const Geometry*     geometry,
+                  const Primitives*   primitives ) const;
+
+    /** Project the bounding box of an item to the screen. */
+    void
+    project( Rect& rect, const float* clip_from_world ) const;
+
+    /** Append the screen-space triangles of an occluder to a list. */
+    void
+    occluderTriangles( std::vector<Triangle>&  triangles,
+                       const Item&             item,
+                       const float*            clip_from_world ) const;
+
+    /** Rasterize the triangles into the rows [y0,y1) of the depth buffer. */
+    void
+    rasterize( int y0, int y1 );
+
+    /** Returns true if any pixel of the rect is farther than its depth. */
+    bool
+    test( const Rect& rect ) const;
+
+    void
+    updateView( const View& view, const BoundingVolumeHierarchy* frustum );
+
+};
+
+    } // of namespace Runtime
+} // of namespace Scene
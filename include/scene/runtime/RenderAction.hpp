@@ -20,6 +20,10 @@
 
 #include <string>
 #include <list>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <boost/utility.hpp>
 #include "scene/Geometry.hpp"
 #include <scene/SeqPos.hpp>
 
@@ -29,6 +33,95 @@ namespace Scene {
 
     struct ResolvedParams;
 
+/** Bump allocator that owns the memory of render actions.
+  *
+  * Memory is handed out from large blocks. reset() rewinds to the first block
+  * in constant time, keeping the blocks for reuse, which invalidates
+  * everything allocated so far. Single allocations may be released, they are
+  * handed out again to allocations of the same size after recycle() has been
+  * called. No destructors are run, so only trivially destructible data should
+  * be placed here.
+  */
+class RenderActionArena : boost::noncopyable
+{
+public:
+    RenderActionArena();
+
+    /** Allocate bytes of memory with alignment suitable for any action. */
+    void*
+    allocate( size_t bytes );
+
+    template<typename T>
+    T*
+    allocateArray( size_t count )
+    { return count == 0 ? NULL : static_cast<T*>( allocate( sizeof(T)*count ) ); }
+
+    /** Release a single allocation of the given size.
+      *
+      * The memory stays valid until recycle is invoked, so that pointers to
+      * released objects are not confused with newly allocated ones.
+      */
+    void
+    release( const void* p, size_t bytes );
+
+    /** Make released memory available for new allocations. */
+    void
+    recycle();
+
+    /** Invalidate all allocations, keeping the blocks for reuse. */
+    void
+    reset();
+
+    /** Number of bytes handed out and not released since last reset. */
+    size_t
+    bytesInUse() const { return m_in_use; }
+
+    /** Number of bytes of memory held in blocks. */
+    size_t
+    bytesReserved() const;
+
+protected:
+    struct Block {
+        std::unique_ptr<unsigned char[]>  m_memory;
+        size_t                            m_size;
+    };
+    std::vector<Block>                              m_blocks;
+    size_t                                          m_current;
+    size_t                                          m_offset;
+    size_t                                          m_in_use;
+    std::vector< std::pair<size_t,void*> >          m_released;
+    std::unordered_map<size_t,std::vector<void*> >  m_free;     ///< Recycled memory by size.
+
+    static size_t
+    roundUp( size_t bytes ) { return (bytes + 15u) & ~static_cast<size_t>( 15u ); }
+};
+
+/** A fixed-size array of items, stored in the arena of the action. */
+template<typename Item>
+struct ItemArray
+{
+    Item*   m_data;
+    size_t  m_size;
+
+    size_t
+    size() const { return m_size; }
+
+    bool
+    empty() const { return m_size == 0; }
+
+    Item&
+    operator[]( size_t i ) { return m_data[i]; }
+
+    const Item&
+    operator[]( size_t i ) const { return m_data[i]; }
+
+    const Item*
+    begin() const { return m_data; }
+
+    const Item*
+    end() const { return m_data + m_size; }
+};
+
 
 struct SetViewCoordSys : public Identifiable
 {
@@ -67,7 +160,7 @@ struct SetInputs : public Identifiable
         int                        m_offset;
         int                        m_stride;
     };
-    std::vector<Item>              m_items;
+    ItemArray<Item>                m_items;
 };
 
 
@@ -88,7 +181,7 @@ struct SetRenderTargets : public Identifiable
         GLint          m_layer;
     };
     GLenum             m_clear_mask;
-    std::vector<Item>  m_items;
+    ItemArray<Item>    m_items;
 };
 
 
@@ -96,7 +189,7 @@ struct SetRenderTargets : public Identifiable
   *
   * This is a list of references to images, along with the sampler state needed.
   * In addition, a Value is given with the sampler unit as an int, which is
-  * used by setUniforms.
+  * used by setUniforms. These values are shared by all actions.
   */
 struct SetSamplers : public Identifiable
 {
@@ -108,9 +201,9 @@ struct SetSamplers : public Identifiable
         GLenum                     m_wrap_p;
         GLenum                     m_min_filter;
         GLenum                     m_mag_filter;
-        Value                      m_uniform_value;
+        const Value*               m_uniform_value;
     };
-    std::vector<Item>              m_items;
+    ItemArray<Item>                m_items;
 };
 
 /** Triggers rendering of a non-indexed primitive batch.
@@ -161,7 +254,7 @@ struct SetUniforms : public Identifiable
         RuntimeSemantic            m_semantic;
         const Value*               m_value;
     };
-    std::vector<Item>              m_items;
+    ItemArray<Item>                m_items;
 };
 
 /** Set pixel operation state. */
@@ -199,6 +292,14 @@ struct SetRaster : public Identifiable
     GLboolean   m_polygon_offset_fill;
 };
 
+/** A single operation of a render list.
+  *
+  * The variant in use is given by m_type, and only that member of the union is
+  * valid. The set view coordinate system variant is large and rarely used, so
+  * it is kept out of line. Actions are created in a RenderActionArena and are
+  * never deleted; the memory is reclaimed when the arena is reset, or when
+  * the action is released and the arena recycled.
+  */
 struct RenderAction
 {
     enum Type {
@@ -216,13 +317,13 @@ struct RenderAction
         ACTION_DRAW_INDEXED
     };
 
-    const Type         m_type;
-    const std::string  m_id;
+    const Type          m_type;
+    const char*         m_id;           ///< Key of the action, stored in the arena.
     unsigned int        m_serial_no;
     static unsigned int m_serial_no_counter;
-    SeqPos         m_timestamp;
-    //union {
-        SetViewCoordSys   m_set_view;
+    SeqPos              m_timestamp;
+    union {
+        SetViewCoordSys*  m_set_view;
         SetLocalCoordSys  m_set_local;
         SetPass           m_set_pass;
         Draw              m_draw;
@@ -230,90 +331,117 @@ struct RenderAction
         SetPixelOps       m_set_pixel_ops;
         SetRaster         m_set_rasterization;
         SetFBCtrl         m_set_fb_ctrl;
-    //};
-    // contains a constructor so it can't be in a union
-    SetUniforms       m_set_uniforms;
-    SetInputs         m_set_inputs;
-    SetSamplers       m_set_samplers;
-    SetRenderTargets  m_set_render_targets;
+        SetUniforms       m_set_uniforms;
+        SetInputs         m_set_inputs;
+        SetSamplers       m_set_samplers;
+        SetRenderTargets  m_set_render_targets;
+    };
 
-    RenderAction( const Type type, const std::string id );
+    ~RenderAction() {}
 
     static RenderAction*
-    createSetViewCoordSys( const Camera*                  camera,
+    createSetViewCoordSys( RenderActionArena&             arena,
+                           const Camera*                  camera,
                            const std::list<const Node*>&  camera_path,
                            const Light*                   (&lights)[SCENE_LIGHTS_MAX],
                            const Camera*                  (&light_projections)[SCENE_LIGHTS_MAX],
                            const std::list<const Node*>   (&light_paths)[SCENE_LIGHTS_MAX] );
 
     static RenderAction*
-    createSetLocalCoordSys( const std::list<const Node*>&  node_path );
+    createSetLocalCoordSys( RenderActionArena&             arena,
+                            const std::list<const Node*>&  node_path );
+
+    static RenderAction*
+    createSetLocalCoordSys( RenderActionArena&  arena,
+                            const Node* const*  node_path,
+                            size_t              node_path_length );
 
     static RenderAction*
-    createSetPass( const std::string&  id,
+    createSetPass( RenderActionArena&  arena,
+                   const std::string&  id,
                    const Pass*         pass );
 
     static RenderAction*
-    createSetInputs( const DataBase&     database,
+    createSetInputs( RenderActionArena&  arena,
+                     const DataBase&     database,
                      const std::string&  id,
                      const Pass*         pass,
                      const Geometry*     geometry,
                      const Primitives*   primitives );
 
     static RenderAction*
-    createDraw( const std::string&  id,
+    createDraw( RenderActionArena&  arena,
+                const std::string&  id,
                 const Geometry*     geometry,
                 const Primitives*   primitives,
                 const Pass*         pass );
 
     static RenderAction*
-    createDrawIndexed( const DataBase&     database,
+    createDrawIndexed( RenderActionArena&  arena,
+                       const DataBase&     database,
                        const std::string&  id,
                        const Geometry*     geometry,
                        const Primitives*   primitives,
                        const Pass*         pass );
 
     static RenderAction*
-    createSetRenderTarget( const DataBase&        database,
+    createSetRenderTarget( RenderActionArena&     arena,
+                           const DataBase&        database,
                            const std::string&     id,
                            const ResolvedParams*  params,
                            const Pass*            pass );
 
 
     static RenderAction*
-    createSetUniforms( const std::string&     id,
+    createSetUniforms( RenderActionArena&     arena,
+                       const std::string&     id,
                        const RenderAction*    set_samplers,
                        const ResolvedParams*  params,
                        const Pass*            pass );
 
     static RenderAction*
-    createSetSamplers( const DataBase&       database,
+    createSetSamplers( RenderActionArena&    arena,
+                       const DataBase&       database,
                        const std::string&    id,
                        const ResolvedParams* params,
                        const Pass*           pass );
 
     static RenderAction*
-    createSetPixelOps( const std::string&     id,
+    createSetPixelOps( RenderActionArena&     arena,
+                       const std::string&     id,
                        const ResolvedParams*  params,
                        const Pass*            pass );
 
     static RenderAction*
-    createSetFBCtrl( const std::string&     id,
+    createSetFBCtrl( RenderActionArena&     arena,
+                     const std::string&     id,
                      const ResolvedParams*  params,
                      const Pass*            pass );
 
     static RenderAction*
-    createSetRaster( const std::string&     id,
+    createSetRaster( RenderActionArena&     arena,
+                     const std::string&     id,
                      const ResolvedParams*  params,
                      const Pass*            pass );
 
+    /** Release the memory of an action and everything it holds in arena. */
+    static void
+    release( RenderActionArena& arena, const RenderAction* action );
+
     void
     debugDump() const;
 
 private:
-    // No-one should use this one.
-    RenderAction();
+    // Constructs the union member given by type.
+    RenderAction( const Type type, const char* id );
+
+    static RenderAction*
+    create( RenderActionArena& arena, const Type type, const std::string& id );
 
+    // No-one should use these.
+    RenderAction();
+    RenderAction( const RenderAction& );
+    RenderAction& operator=( const RenderAction& );
 
 };
 
@@ -20,6 +20,7 @@
 
 #include <list>
 #include <unordered_map>
+#include <unordered_set>
 #include <scene/SeqPos.hpp>
 #include "scene/Bind.hpp"
 #include "scene/Scene.hpp"
@@ -48,6 +49,11 @@ public:
         const RenderAction*               m_action_set_uniform;
         const RenderAction*               m_action_set_samplers;
         const RenderAction*               m_action_set_framebuffer;
+        const RenderAction*               m_action_set_local;
+        const RenderAction*               m_action_set_raster;
+        const RenderAction*               m_action_set_pixel_ops;
+        const RenderAction*               m_action_set_fb_ctrl;
+        const RenderAction*               m_action_draw;
 
         const SetRenderTargets*         m_set_render_targets;
         const SetPass*                  m_set_pass;
@@ -69,18 +75,62 @@ public:
     const Resolver&
     resolver() const { return m_resolver; }
 
+    /** Set the number of threads used to traverse the node hierarchy when
+      * the render list is rebuilt, including the calling thread.
+      *
+      * Default is the number of hardware threads if built with threads,
+      * otherwise one. The render list is the same regardless.
+      */
+    void
+    setThreads( size_t threads ) { m_threads = threads < 1 ? 1 : threads; }
+
+    size_t
+    threads() const { return m_threads; }
+
+
+    /** Returned by previousIndex for items that are new. */
+    static const size_t npos = ~static_cast<size_t>(0);
 
     /**  Build the render list if needed.
       *
       * Checks if the visual scene id match with the render list, and if so,
       * if the render list is as fresh as the database. If not, the render list
-      * is completely rebuilt.
+      * is patched, or, if the visual scene has changed or objects have been
+      * deleted from the database, completely rebuilt.
+      *
+      * A patch first tries to find the changed nodes in the journal of the
+      * node library, and only traverses their subtrees again, see
+      * patchFromJournal. Otherwise, the whole scene is traversed again, see
+      * patch.
       *
-      * \returns true If the render list has been rebuilt.
+      * \returns true If the render list has been rebuilt or patched.
       */
     bool
     build( const std::string& visual_scene );
 
+    /** True if the last change of the render list was a patch.
+      *
+      * A patch keeps the resolver's actions, including the local and view
+      * coordinate systems, so the items that are still in the list are
+      * identical to the items of the previous list. Users of the list can
+      * then keep whatever they have derived from these items, see
+      * previousIndex.
+      */
+    bool
+    patched() const { return m_patched; }
+
+    /** Number of items that the last change of the list got by traversing
+      * the scene, the rest were kept from the previous list.
+      */
+    size_t
+    traversedItems() const { return m_traversed_items; }
+
+    /** Index of an item in the list before the last change, or npos if the
+      * item is new. Items that are left out were removed.
+      */
+    size_t
+    previousIndex( size_t index ) const { return m_previous_index[ index ]; }
+
 
 
     /** Get the bounding box of the current visual scene.
@@ -154,22 +204,215 @@ protected:
 
     std::vector<Item>                   m_items;
 
+    /** Threads used by rebuild to traverse the node hierarchy. */
+    size_t                              m_threads;
+
+    /** The last change of the list was a patch. */
+    bool                                m_patched;
+    /** Per item, the index of the item in the previous list or npos. */
+    std::vector<size_t>                 m_previous_index;
+    /** Upper bound of actions allocated by patches since the last rebuild. */
+    size_t                              m_patch_actions;
+    /** View coordinate system of each render item, in traversal order. */
+    std::vector<const RenderAction*>    m_views;
+    /** The views of the previous list while patching, else empty. */
+    std::vector<const RenderAction*>    m_previous_views;
+
     /** Purge the current render list and build it from scratch, */
     void
     rebuild( );
 
+    /** Check if the render list can be patched.
+      *
+      * Patching requires that no objects have been deleted since the list
+      * was built, as the resolver and the users of the list key their caches
+      * on pointers. Since the actions of removed items are only released by a
+      * rebuild, the list is also rebuilt when patches have allocated more
+      * actions than the list has items.
+      */
+    bool
+    patchable() const;
+
+    /** Build the render list again without purging the resolver, and match
+      * the new items with the items of the previous list.
+      *
+      * Traverses the whole scene, used when the changes can't be found in
+      * the journals, see patchFromJournal.
+      */
+    void
+    patch();
+
+    /** Patch the render list from the changes journaled since it was built.
+      *
+      * The nodes with structural changes are looked up in the records of the
+      * traversals, and only their subtrees are traversed again. The items of
+      * the rest of the scene are kept as they are. Journaled changes to other
+      * objects must be such that they can't affect the kept items, and the
+      * views must be unchanged.
+      *
+      * \returns False if the changes couldn't be found in the journals or
+      *          can't be patched this way, and the list is left unchanged.
+      */
+    bool
+    patchFromJournal();
+
+    /** Traverse the visual scene and populate the operations and items.
+      *
+      * \returns False if the visual scene doesn't exist.
+      */
+    bool
+    populate();
+
+    /** Reset the current state used to elide operations. */
+    void
+    resetState();
+
+    /** Add the operations of an item that differ from the current state.
+      *
+      * Gives the same operations as addRenderItem did when the item was
+      * added, used to recreate the operations after a patch.
+      */
+    void
+    addItemOperations( const Item& item );
+
+    /** Add the operations that restore the default state. */
+    void
+    addRestoreStateOperations();
+
+    /** Find the previous indices of the items that have none yet among a
+      * range of the previous items, by comparing their actions.
+      *
+      * \returns The number of items found.
+      */
+    size_t
+    matchItems( const std::vector<Item>& previous, size_t begin, size_t end );
+
+    /** Append items of the previous list, with their previous indices. */
+    void
+    retainItems( const std::vector<Item>& previous, size_t begin, size_t end );
+
     /** Helper struct used when traversing the scene graph. */
     struct Context
     {
         const Camera*                    m_camera;
+        /** Instancing steps to the current node, excluding it. */
         const Node*                      m_node_path[SCENE_PATH_MAX];
+        size_t                           m_node_path_length;
         LayerMask                        m_layer_mask;
-
-        std::list<const Node*>           m_camera_path_;
-        std::list<const Node*>           m_node_path_;
         const Node*                      m_current_node;
+        /** The current node is reached through an instance_node. */
+        bool                             m_instanced;
+    };
+
+    /** A render item found when traversing the scene graph. */
+    struct Instance
+    {
+        /** Node path of the local coordinate system, including the node. */
+        const Node*                      m_node_path[SCENE_PATH_MAX];
+        size_t                           m_node_path_length;
+        const Material*                  m_material;
+        const Pass*                      m_pass;
+        const CommonShadingModel*        m_common;
+        const Geometry*                  m_geometry;
+        const Primitives*                m_primitives;
+    };
+
+    /** The items of the subtree of a node, see Traversal. */
+    struct Record
+    {
+        const Node*                      m_node;
+        /** The range of items, or instances while traversing. */
+        size_t                           m_begin;
+        size_t                           m_end;
+        /** Index of the last record of the subtree. */
+        size_t                           m_last;
+    };
+
+    /** What was found when traversing a part of the scene graph. */
+    struct Found
+    {
+        std::vector<Instance>            m_instances;
+        /** Records of the nodes not reached through an instance_node. */
+        std::vector<Record>              m_records;
+        /** Nodes reached through an instance_node. */
+        std::vector<const Node*>         m_instanced_nodes;
+        /** Some object was not found. */
+        bool                             m_unresolved;
+    };
+
+    /** A part of the scene graph that can be traversed independently.
+      *
+      * Either the subtree of the current node, or, if recurse is false, only
+      * the geometry instanced by the current node.
+      */
+    struct Task
+    {
+        Context                          m_context;
+        bool                             m_recurse;
+        /** Records of split nodes that begin with this task, outermost first. */
+        std::vector<const Node*>         m_open;
+        /** Number of records of split nodes that end with this task. */
+        size_t                           m_close;
+    };
+
+    /** A traversal of the node hierarchy of the visual scene.
+      *
+      * The records of the nodes are in traversal order, with the subtree of
+      * a node following the node, such that a patch can traverse the subtree
+      * of a changed node again and keep the items of the rest.
+      */
+    struct Traversal
+    {
+        /** Index of the view, see m_views. */
+        size_t                           m_view;
+        /** Context of the children of the root. */
+        Context                          m_context;
+        const Material*                  m_rt_material;
+        const Pass*                      m_rt_pass;
+        bool                             m_use_rt_as_material;
+        /** The range of items. */
+        size_t                           m_begin;
+        size_t                           m_end;
+        std::vector<Record>              m_records;
     };
 
+    /** The render item of each view, in traversal order. */
+    std::vector<const Render*>          m_renders;
+    /** Index of the first item of each view. */
+    std::vector<size_t>                 m_view_items;
+    /** Root node of the visual scene, if any. */
+    const Node*                         m_root;
+    /** Traversals of the node hierarchy, in the order of the items. */
+    std::vector<Traversal>              m_traversals;
+    /** Nodes reached through an instance_node, which aren't recorded. */
+    std::unordered_set<const Node*>     m_instanced_nodes;
+    /** Some object was not found, and may be found if it is added. */
+    bool                                m_unresolved;
+    /** Items the last change got by traversing the scene. */
+    size_t                              m_traversed_items;
+
+    /** Add the items, records and instanced nodes found in a part of a
+      * traversal.
+      */
+    void
+    addFound( Traversal& traversal, const Found& found );
+
+    /** Patch the items of a traversal, see patchFromJournal.
+      *
+      * \param[in] tops     The children of the root, with the index of their
+      *                     record or npos if they are new.
+      * \param[in] changed  Nodes with structural changes.
+      * \param[in] found    What was found when traversing the changed nodes,
+      *                     in order, w is the next to use.
+      */
+    void
+    patchTraversal( Traversal&                                          traversal,
+                    const std::vector<Item>&                            previous,
+                    const std::vector< std::pair<const Node*,size_t> >& tops,
+                    const std::unordered_set<const Node*>&              changed,
+                    const std::vector<Found>&                           found,
+                    size_t&                                             w );
+
     /** Add the required operations on the render list to render an item.
       *
       * Gets the actions from the resolver and checks if they are different
@@ -177,7 +420,8 @@ protected:
       * list and current actions are updated.
       */
     void
-    addRenderItem( const Context&            context,
+    addRenderItem( const Node* const*        node_path,
+                   size_t                    node_path_length,
                    const Material*           render_target_material,
                    const Pass*               render_target_pass,
                    const Material*           material,
@@ -220,28 +464,63 @@ protected:
                          const Pass*&        pass,
                          const std::string&  material_id,
                          const std::string&  override_tech = "",
-                         const std::string&  override_pass = "" );
+                         const std::string&  override_pass = "" ) const;
 
     void
     processNodeTransforms( const Node* parent,
                            const Node* current );
 
-    /** Recursively process a scene graph node.
+    /** Check if the current node of a context is to be processed.
       *
-      * First, if the list of layers in the context is non-empty, it is checked
+      * If the list of layers in the context is non-empty, it is checked
       * if this node is member of any of those layers. If not, the recusion
       * is terminated. Otherwise, the node and all sub-nodes are included,
       * regardless of which layers the children belongs to. I.e. a the property
       * of belonging to a layer is inheritated down the node hierarchy.
+      */
+    bool
+    includeNode( const Context& context ) const;
+
+    /** Create the context of one of the current node's instance_nodes.
+      *
+      * The instanced node is added to found.
       *
-      * If the node has any instance_node items, these nodes are recursed into.
+      * \returns False if the node is not found or the node path would be
+      *          longer than SCENE_PATH_MAX.
+      */
+    bool
+    instanceContext( Found&          found,
+                     Context&        recurse_context,
+                     const Context&  context,
+                     size_t          index ) const;
+
+    /** Split a task into the tasks of the node's instance_nodes and children,
+      * and a task for the node's own geometry, in traversal order.
+      *
+      * The record of the node begins with the first and ends with the last
+      * of these tasks.
+      *
+      * \returns False if the task's node is not included or there is nothing
+      *          to split, in which case no tasks are added.
+      */
+    bool
+    splitTask( std::vector<Task>& tasks, Found& found, const Task& task ) const;
+
+    /** Recursively process a scene graph node.
+      *
+      * If the node is included, see includeNode, and has any instance_node
+      * items, these nodes are recursed into.
       *
       * If the node has any children, these nodes are recursed into.
       *
       * If the node has any instance_geometry items, the geometry is instanced
       * using this node's transforms.
       *
+      * Only reads the database and resolver, so several subtrees can be
+      * processed at once.
       *
+      * \param[out] found                  The render items found, and the
+      *                                    records of the nodes, are appended.
       * \param[in] context                 The context to use and to copy for
       *                                    further recursions.
       * \param[in] render_target_material  Passed to instanceGeometry.
@@ -249,14 +528,16 @@ protected:
       * \param[in] override_material       Passed to instanceGeometry.
       */
     void
-    processNode( Context&         parent_context,
-                 const Material*  render_target_material,
-                 const Pass*      render_target_pass,
-                 bool             override_material );
+    processNode( Found&                  found,
+                 const Context&          context,
+                 const Material*         render_target_material,
+                 const Pass*             render_target_pass,
+                 bool                    override_material ) const;
 
 
     /** Instantiate geometry in a given node context.
       *
+      * \param[out] found                  The render items are appended.
       * \param[in] node                    The node that instantiated the geometry.
       * \param[in] context                 The context in which the node was
       *                                    processed (due to instancing of nodes,
@@ -275,11 +556,12 @@ protected:
       *                                    Used when traversing instance_material.
       */
     void
-    instanceGeometry( const Node*               node,
+    instanceGeometry( Found&                    found,
+                      const Node*               node,
                       const Context&            context,
                       const Material*           render_target_material,
                       const Pass*               render_target_pass,
-                      bool                      override_material );
+                      bool                      override_material ) const;
 
     /** Invoked when render's material id is non-empty (instance_material pipeline).
       *
@@ -304,6 +586,13 @@ protected:
                                  const std::vector<std::string>&  layers,
                                  const Material*                  material,
                                  const Pass*                      pass );
+    /** Process the node hierarchy of a visual scene.
+      *
+      * The hierarchy is split into tasks that are traversed in parallel,
+      * each into its own list of render items. The lists are then added to
+      * the render list in traversal order, so the result doesn't depend on
+      * the number of threads. The traversal is recorded in m_traversals.
+      */
     void
     traverseVisualSceneNodeHierarchy( const VisualScene*             visual_scene,
                                       Context&                       parent_context,
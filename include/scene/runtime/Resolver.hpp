@@ -89,9 +89,29 @@ namespace Scene {
 
         ~Resolver();
 
+        /** Release the per-frame actions (view and local coordinate systems).
+          *
+          * These are allocated from a separate arena that is rewound in
+          * constant time, so the actions must not be used afterwards. Also
+          * recycles the memory of cached actions that have gone stale.
+          */
         void
         purge();
 
+        /** Reuse the memory of cached actions that have gone stale.
+          *
+          * Stale actions are released when they are replaced, but their
+          * memory is only reused after this has been invoked, so it must not
+          * be invoked while anything refers to actions replaced since the
+          * previous invocation.
+          */
+        void
+        recycle();
+
+        /** The arena holding the cached actions. */
+        const RenderActionArena&
+        arena() const { return m_arena; }
+
 
         /** Clears all cached data.
           *
@@ -125,6 +145,15 @@ namespace Scene {
         const LayerMask
         layerMask( const Node* node );
 
+        /** Get the layer mask of a node without touching the caches.
+          *
+          * Layers that haven't got a bit yet are left out, they cannot match
+          * the layer mask of any render item. Unlike layerMask, this may be
+          * called from several threads at once.
+          */
+        const LayerMask
+        assignedLayerMask( const Node* node ) const;
+
         const RenderAction*
         setViewCoordSys( const Node*    visual_scene_node,
                          const Render*  render );
@@ -132,6 +161,14 @@ namespace Scene {
         const RenderAction*
         setLocalCoordSys( const std::list<const Node*>&  node_path );
 
+        /** Get the local coordinate system of a node path.
+          *
+          * Equal paths share the same action until purge is invoked.
+          */
+        const RenderAction*
+        setLocalCoordSys( const Node* const*  node_path,
+                          size_t              node_path_length );
+
         const NodePath*
         nodePath( VisualScene* visual_scene, Node* instancer, Node* node );
 
@@ -232,16 +269,19 @@ namespace Scene {
         RenderAction*                                    m_def_fb_ctrl;
         NodePath::Map                                    m_nodepath_cache;
 
-        std::unordered_map<std::string,RenderAction*>    m_set_framebuffer_cache;
-        std::unordered_map<std::string,RenderAction*>    m_set_raster_cache;
-        std::unordered_map<std::string,RenderAction*>    m_set_pixel_ops_cache;
-        std::unordered_map<std::string,RenderAction*>    m_set_fb_ctrl_cache;
-        std::unordered_map<std::string,RenderAction*>    m_set_pass_cache;
-        std::unordered_map<std::string,RenderAction*>    m_set_inputs_cache;
-        std::unordered_map<std::string,RenderAction*>    m_set_uniforms_cache;
-        std::unordered_map<std::string,RenderAction*>    m_set_samplers_cache;
-        std::unordered_map<std::string,RenderAction*>    m_draw_cache;
-        std::unordered_map<std::string,ResolvedParams*>  m_resolved_params_cache;
+        // The caches are keyed on the objects the actions are deduced from,
+        // so that lookups don't have to build key strings.
+        std::unordered_map<CacheKey<2>,RenderAction*>    m_set_framebuffer_cache;    // pass, material
+        std::unordered_map<CacheKey<1>,RenderAction*>    m_set_raster_cache;         // pass
+        std::unordered_map<CacheKey<1>,RenderAction*>    m_set_pixel_ops_cache;      // pass
+        std::unordered_map<CacheKey<1>,RenderAction*>    m_set_fb_ctrl_cache;        // pass
+        std::unordered_map<CacheKey<1>,RenderAction*>    m_set_pass_cache;           // pass
+        std::unordered_map<CacheKey<2>,RenderAction*>    m_set_inputs_cache;         // pass, primitives
+        std::unordered_map<CacheKey<2>,RenderAction*>    m_set_uniforms_cache;       // pass, material
+        std::unordered_map<CacheKey<2>,RenderAction*>    m_set_samplers_cache;       // pass, material
+        std::unordered_map<CacheKey<2>,RenderAction*>    m_draw_cache;               // primitives, pass
+        std::unordered_map<CacheKey<2>,ResolvedParams*>  m_resolved_params_cache;    // pass, material
+        std::unordered_map<CacheKey<SCENE_PATH_MAX>,const RenderAction*> m_set_local_cache;  // node path, reset by purge
 
         struct CachedLayerMask
         {
@@ -253,9 +293,10 @@ namespace Scene {
         std::unordered_map<CacheKey<1>, CachedLayerMask> m_layer_mask_render;
         std::unordered_map<CacheKey<1>, CachedLayerMask> m_layer_mask_node;
 
-
-        std::list<RenderAction*>                         m_views;
-        std::list<RenderAction*>                         m_set_local;
+        /** Holds the cached actions, stale actions are left here until clear. */
+        RenderActionArena                                m_arena;
+        /** Holds the per-frame actions, reset by purge. */
+        RenderActionArena                                m_frame_arena;
 
     };
 
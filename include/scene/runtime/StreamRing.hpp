@@ -0,0 +1,133 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <boost/utility.hpp>
+
+namespace Scene {
+    namespace Runtime {
+
+/** Storage and synchronisation of a buffer used by a StreamRing.
+ *
+ * The GL implementation is a persistently mapped buffer object with one fence
+ * per region, see GLSLStreamBuffer. Keeping this interface free of GL lets
+ * the ring logic be exercised without a GL context.
+ */
+class StreamRingBackend
+{
+public:
+    virtual
+    ~StreamRingBackend();
+
+    /** Allocate a buffer of the given size and map it for writing.
+     *
+     * Any previously mapped buffer is released first.
+     *
+     * \returns Pointer to the mapped memory, or NULL on failure.
+     */
+    virtual unsigned char*
+    map( size_t bytes ) = 0;
+
+    /** Make writes to [offset, offset+bytes) visible to the GPU. */
+    virtual void
+    flush( size_t offset, size_t bytes ) = 0;
+
+    /** Insert a fence that signals when the GPU is done with a region. */
+    virtual void
+    fence( size_t region ) = 0;
+
+    /** Block until the fence of a region has signalled, no-op if unfenced. */
+    virtual void
+    wait( size_t region ) = 0;
+};
+
+
+/** Ring of equally sized regions of a mapped buffer for per-frame data.
+ *
+ * Each frame writes into the next region while the GPU may still read the
+ * regions written by the previous frames, with a fence per region to
+ * guarantee that a region is not overwritten before the GPU is done with it.
+ * With three regions, the CPU can run two frames ahead without stalling.
+ *
+ * Usage per frame is begin(), a sequence of allocate() and writes through
+ * pointer(), commit() before issuing the commands that read the data, and
+ * end() after them.
+ */
+class StreamRing : boost::noncopyable
+{
+public:
+    StreamRing( StreamRingBackend& backend, size_t regions = 3 );
+
+    static const size_t
+    none()
+    { return static_cast<size_t>( ~0ul ); }
+
+    /** Start writing the next region, with room for at least bytes.
+     *
+     * If the regions are too small, all regions are waited for and the buffer
+     * is reallocated, otherwise only the fence of the next region is waited
+     * for.
+     *
+     * \returns False if the buffer couldn't be mapped.
+     */
+    bool
+    begin( size_t bytes );
+
+    /** Reserve bytes in the current region.
+     *
+     * \returns Offset from start of buffer, or none() if the region is full.
+     */
+    size_t
+    allocate( size_t bytes, size_t alignment = 16 );
+
+    /** Pointer to mapped memory at an offset returned by allocate(). */
+    unsigned char*
+    pointer( size_t offset )
+    { return m_base + offset; }
+
+    /** Make the data written to the current region visible to the GPU. */
+    void
+    commit();
+
+    /** Fence the current region, after the commands that read it. */
+    void
+    end();
+
+    /** The region currently or last written. */
+    size_t
+    region() const
+    { return m_region; }
+
+    size_t
+    regionSize() const
+    { return m_region_size; }
+
+protected:
+    StreamRingBackend&  m_backend;
+    const size_t        m_regions;
+    size_t              m_region_size;
+    size_t              m_region;
+    size_t              m_used;
+    unsigned char*      m_base;
+};
+
+    } // of namespace Runtime
+} // of namespace Scene
@@ -0,0 +1,125 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ *
+ * This file is part of Scene.
+ *
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#ifdef SCENE_USE_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+#include <boost/utility.hpp>
+
+namespace Scene {
+    namespace Runtime {
+
+/** A pool of persistent worker threads.
+ *
+ * A job is a number of independent tasks, identified by their index. The
+ * calling thread and up to a given number of workers claim the tasks in index
+ * order through an atomic counter, until all are claimed. Workers are created
+ * when a job first asks for them and then sleep between jobs, so a job costs
+ * a wake-up instead of creating and joining threads.
+ *
+ * One job runs at a time. A job started while another is running, e.g. from
+ * one of its tasks or from another thread, is run serially by the caller.
+ *
+ * Without SCENE_USE_THREADS, every job is run serially.
+ */
+class ThreadPool : public boost::noncopyable
+{
+public:
+    ThreadPool();
+
+    ~ThreadPool();
+
+    /** The pool shared by the library. */
+    static ThreadPool&
+    shared();
+
+    /** The number of hardware threads, at least one, or one if built without threads. */
+    static size_t
+    hardwareThreads();
+
+    /** Number of workers created so far. */
+    size_t
+    workers() const;
+
+    /** Invoke f( i ) for every i in [0,n), and return when all are done.
+     *
+     * \param threads  The maximum number of threads used, including the
+     *                 calling thread.
+     */
+    template<typename Func>
+    void
+    parallelFor( size_t n, size_t threads, Func f )
+    {
+        run( n, threads, &invoke<Func>, &f );
+    }
+
+protected:
+    typedef void (*Task)( void* data, size_t i );
+
+    template<typename Func>
+    static void
+    invoke( void* data, size_t i )
+    {
+        (*static_cast<Func*>( data ))( i );
+    }
+
+    void
+    run( size_t n, size_t threads, Task task, void* data );
+
+#ifdef SCENE_USE_THREADS
+    std::vector<std::thread>    m_workers;
+    /** Held by the thread running the current job. */
+    std::mutex                  m_job_mutex;
+    std::mutex                  m_mutex;
+    std::condition_variable     m_worker_cond;
+    std::condition_variable     m_done_cond;
+    unsigned int                m_generation;   ///< Guarded by m_mutex.
+    bool                        m_die;          ///< Guarded by m_mutex.
+    bool                        m_open;         ///< Workers may join, guarded by m_mutex.
+    size_t                      m_helpers;      ///< Workers that may still join, guarded by m_mutex.
+    size_t                      m_active;       ///< Workers in the job, guarded by m_mutex.
+    Task                        m_task;
+    void*                       m_data;
+    size_t                      m_n;
+    std::atomic<size_t>         m_next;
+
+    void
+    work();
+
+    void
+    worker();
+#endif
+};
+
+/** Invoke f( i ) for every i in [0,n) on the shared thread pool. */
+template<typename Func>
+void
+parallelFor( size_t n, size_t threads, Func f )
+{
+    ThreadPool::shared().parallelFor( n, threads, f );
+}
+
+    } // of namespace Runtime
+} // of namespace Scene
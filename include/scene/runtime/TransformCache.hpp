@@ -19,12 +19,11 @@
 #pragma once
 
 #ifdef SCENE_USE_THREADS
-#include <list>
-#include <thread>
-#include <mutex>
+#include <atomic>
+#include <memory>
 #endif
 
-//#include <condition_variable>
+#include <vector>
 #include <unordered_map>
 #include "scene/Scene.hpp"
 #include "scene/Value.hpp"
@@ -80,6 +79,43 @@ public:
     update( unsigned int m_default_fbo_width,
             unsigned int m_default_fbo_height );
 
+    /** Enable or disable incremental updates.
+      *
+      * In incremental mode, update tracks the nodes, cameras and values that
+      * the cache entries are derived from, and only recomputes the entries
+      * that are downstream of a source that has changed since the previous
+      * update. The dependency graph is rebuilt whenever entries have been
+      * added or the cache has been purged. After a purge, all entries are
+      * recomputed, otherwise only the added entries and the entries affected
+      * by changes, so that a render list that is patched instead of rebuilt
+      * only pays for what it added.
+      */
+    void
+    setIncrementalUpdate( bool incremental );
+
+    /** Returns true if update only recomputes entries affected by changes. */
+    bool
+    incrementalUpdate() const { return m_incremental; }
+
+    /** Returns the number of cache entries recomputed by the last update. */
+    size_t
+    lastUpdateCount() const { return m_last_update_count; }
+
+    /** Set the number of worker threads used by update.
+      *
+      * The calling thread also takes part in the update, so zero workers
+      * gives a serial update. The workers are taken from the shared thread
+      * pool, see ThreadPool. Only has an effect when Scene is built with
+      * SCENE_USE_THREADS and the cache is created with use_threadpool set.
+      * The default is one less than the number of hardware threads.
+      */
+    void
+    setWorkerThreads( size_t threads );
+
+    /** Returns the number of worker threads used by update. */
+    size_t
+    workerThreads() const { return m_worker_threads; }
+
     /** Checks if the bounding box of a geometry intersects the current view frustum.
       *
       * \returns A value of type VALUE_TYPE_BOOL.
@@ -182,33 +218,46 @@ protected:
 
     const DataBase&                                                           m_database;
     const bool                                              m_use_threadpool;
+    size_t                                                  m_worker_threads;
     SeqPos                                                                 m_last_purge;
     bool m_has_dumped;
+    bool                                                    m_incremental;
+    size_t                                                  m_last_update_count;
 
 #ifdef SCENE_USE_THREADS
-    struct ThreadPool {
-        enum PoolState {
-            THROTTLE,
-            COMPUTE_PASS1,
-            COMPUTE_BRANCH_TRANSFORM,
-            COMPUTE_PATH_TRANSFORM,
-            COMPUTE_PASS5,
-            DIE
-        };
-        std::list<std::thread>                              m_workers;
-        std::mutex                                          m_mutex;
-        std::condition_variable                             m_worker_cond;
-        std::condition_variable                             m_master_cond;
-        volatile PoolState                                  m_state;
-        volatile size_t                                     m_iteration_next;
-        volatile size_t                                     m_iteration_done;
-        volatile size_t                                     m_iteration_total;
-
-        static void worker( TransformCache* that );
-    }                                                       m_thread_pool;
+    /** Task schedule used by update.
+     *
+     * The items of each pass are split into chunks, and the chunks are ordered
+     * pass by pass. The chunks are run as tasks on the shared thread pool,
+     * which claims them in order. Before a chunk is computed, it waits only
+     * for the chunks of earlier passes that produce its source values, so
+     * there is no barrier between passes.
+     */
+    struct Schedule {
+        unsigned int                                        m_epoch;
+
+        // Rebuilt when the cache structure changes.
+        SeqPos                                              m_built;
+        size_t                                              m_sizes[4];
+        std::vector<unsigned char>                          m_chunk_pass;
+        std::vector<size_t>                                 m_chunk_begin;
+        std::vector<size_t>                                 m_chunk_end;
+        std::vector<size_t>                                 m_dep_offsets;
+        std::vector<size_t>                                 m_deps;
+        std::unique_ptr< std::atomic<unsigned int>[] >      m_chunk_done;
+    }                                                       m_schedule;
 
     void
     threadedUpdate( );
+
+    bool
+    threadedStale() const;
+
+    void
+    threadedBuild();
+
+    void
+    threadedCompute( const size_t chunk, const unsigned int epoch );
 #endif
     Value                                                                     m_bias_matrix; // Converts clip space to light space
     Value                                                                     m_default_fbo_size;
@@ -244,6 +293,38 @@ protected:
     };
 
 
+    /** Allocates values consecutively in large blocks.
+      *
+      * The values of each pass are allocated from a separate arena, so that a
+      * pass streams through contiguous memory, and purge releases the values
+      * in bulk. Pointers are stable until clear is invoked.
+      */
+    class ValueArena
+    {
+    public:
+        Value*
+        allocate( const Value& value )
+        {
+            if( m_blocks.empty() || (m_blocks.back().size() == m_blocks.back().capacity()) ) {
+                m_blocks.push_back( std::vector<Value>() );
+                m_blocks.back().reserve( 1024 );
+            }
+            m_blocks.back().push_back( value );
+            return &m_blocks.back().back();
+        }
+
+        void
+        clear()
+        { m_blocks.clear(); }
+
+    protected:
+        std::vector< std::vector<Value> >       m_blocks;
+    };
+    ValueArena                                  m_pass1_storage;
+    ValueArena                                  m_branch_storage;
+    ValueArena                                  m_path_storage;
+    ValueArena                                  m_pass4_storage;
+
     // Pass 1: Deduce values from scene, transforms, and projections
     std::vector< CacheItem<1> >                 m_pass1_values;
     CacheLUT<2>                                 m_deduced_values_lut;
@@ -284,6 +365,55 @@ protected:
     //std::unordered_map<CacheKey<2>, size_t >                m_matrix_prod_3x3_transpose_cache;
     //std::unordered_map<CacheKey<3>, size_t >                m_bbox_check_cache;
 
+    // Incremental update: Entries are identified by a global index, where
+    // the entries of m_pass1_values come first, then m_branch_transform,
+    // m_path_transform, and m_pass4_values. An entry only depends on entries
+    // of earlier passes, so processing the passes in order is sufficient.
+    enum {
+        INCREMENTAL_PASSES = 4
+    };
+    struct IncrementalSource
+    {
+        const SeqPos*       m_changed;              ///< Timestamp of source node, camera or value.
+        SeqPos              m_seen;                 ///< Timestamp when entries were last computed.
+    };
+    SeqPos                                      m_incremental_built;
+    size_t                                      m_incremental_sizes[ INCREMENTAL_PASSES ];
+    std::vector<IncrementalSource>              m_incremental_sources;
+    std::vector<size_t>                         m_incremental_source_offsets;    ///< Source -> first entry in m_incremental_source_entries.
+    std::vector<size_t>                         m_incremental_source_entries;
+    std::vector<size_t>                         m_incremental_entry_offsets;     ///< Entry -> first entry in m_incremental_entry_dependents.
+    std::vector<size_t>                         m_incremental_entry_dependents;
+    std::vector<unsigned char>                  m_incremental_dirty;
+    std::vector<size_t>                         m_incremental_worklist[ INCREMENTAL_PASSES ];
+
+    /** Rebuild the source and entry dependency graph used by incremental updates.
+      *
+      * \param appended  Entries have only been added since the last build.
+      *                  The added entries are put on the worklists, and the
+      *                  sources keep the timestamps they were last seen with.
+      */
+    void
+    incrementalBuild( bool appended );
+
+    /** Recompute only the entries affected by changed sources. */
+    void
+    updateIncremental();
+
+    /** Flag an entry as dirty and put it on the worklist of its pass. */
+    void
+    incrementalMark( size_t entry );
+
+    /** Returns true if entries have been added or purged since the last build. */
+    bool
+    incrementalStale() const;
+
+    static void
+    computePass1( CacheItem<1>& item );
+
+    static void
+    computePass4( CacheItem<SCENE_PATH_MAX>& item );
+
 
     const Value*
     matrixProductUpper3x3Transpose( const Value* A, const Value* B );
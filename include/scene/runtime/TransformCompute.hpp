@@ -28,6 +28,45 @@ class TransformCompute
 {
 public:
 
+    /** Implementations of the 4x4 matrix product kernel. */
+    enum Kernel {
+        KERNEL_SCALAR,
+        KERNEL_SSE,
+        KERNEL_AVX2,
+        KERNEL_AVX512,
+        KERNEL_N
+    };
+
+    /** Returns the kernel currently used for matrix products.
+     *
+     * The fastest kernel supported by the CPU is selected at startup.
+     */
+    static Kernel
+    kernel();
+
+    /** Returns true if the CPU supports a particular kernel. */
+    static bool
+    kernelSupported( Kernel kernel );
+
+    /** Override the kernel used for matrix products.
+     *
+     * \returns False if the kernel is not supported by the CPU, in which case
+     *          the current kernel is kept.
+     */
+    static bool
+    setKernel( Kernel kernel );
+
+    /** Returns a human-readable name of a kernel. */
+    static const char*
+    kernelName( Kernel kernel );
+
+    /** Column-major 4x4 matrix product, dst = a*b, using the current kernel.
+     *
+     * Neither pointers needs to be aligned, and dst may alias a.
+     */
+    static void
+    multiply4x4( float* dst, const float* a, const float* b );
+
     static void
     cosine( Value* dst, const Value* src );
 
@@ -83,6 +122,46 @@ public:
     static void
     multiplyMatrices( Value* dst, const unsigned int N, const Value** src );
 
+    /** Multiply a batch of independent matrix sequences.
+     *
+     * Equivalent to invoking multiplyMatrices on each item, where the item type
+     * provides the members m_value, m_N, and m_source_values. The items with
+     * changed sources are gathered into groups of batch_lanes, and each group
+     * is multiplied at once by the current kernel, one item per SIMD lane.
+     * No item may use the result of another item in the batch.
+     */
+    template<typename Item>
+    static void
+    multiplyMatricesBatch( Item* items, const size_t count )
+    {
+        Value* dst[ batch_lanes ];
+        unsigned int N[ batch_lanes ];
+        const Value* const* src[ batch_lanes ];
+        unsigned int lanes = 0;
+        for( size_t i=0; i<count; i++ ) {
+            if( i+1 < count ) {
+                const Item& next = items[i+1];
+                for( unsigned int k=0; k<next.m_N; k++ ) {
+                    prefetch( next.m_source_values[k] );
+                }
+            }
+            Item& item = items[i];
+            if( !sourcesChanged( item.m_value, item.m_N, item.m_source_values ) ) {
+                continue;
+            }
+            dst[lanes] = item.m_value;
+            N[lanes] = static_cast<unsigned int>( item.m_N );
+            src[lanes] = item.m_source_values;
+            if( ++lanes == batch_lanes ) {
+                multiplyMatricesLanes( lanes, dst, N, src );
+                lanes = 0;
+            }
+        }
+        if( lanes > 0 ) {
+            multiplyMatricesLanes( lanes, dst, N, src );
+        }
+    }
+
 
     /** Check if bounding box is inside frustum.
      *
@@ -104,6 +183,40 @@ public:
     static void
     boundingBoxTest( Value* dst, const unsigned int N, const Value** src );
 
+protected:
+
+    /** Max number of matrix sequences multiplied at once by multiplyMatricesLanes. */
+    static const unsigned int batch_lanes = 8;
+
+    /** Move the timestamp of dst forward to the newest of its sources.
+     *
+     * \returns True if dst must be recomputed, i.e., a source is newer and
+     *          N > 0.
+     */
+    static bool
+    sourcesChanged( Value* dst, const size_t N, const Value* const* src );
+
+    /** Multiply up to batch_lanes matrix sequences using the current kernel.
+     *
+     * Sequence l is the product of src[l][0], ..., src[l][N[l]-1], which is
+     * stored in dst[l]. All N[l] must be positive. Timestamps are not updated.
+     */
+    static void
+    multiplyMatricesLanes( const unsigned int  lanes,
+                           Value* const*       dst,
+                           const unsigned int* N,
+                           const Value* const* const* src );
+
+    /** Hint that the payload and timestamp of a value will be read soon. */
+    static void
+    prefetch( const Value* value )
+    {
+#ifdef __GNUC__
+        __builtin_prefetch( value );
+        __builtin_prefetch( reinterpret_cast<const char*>( value ) + 64 );
+#endif
+    }
+
 
 };
 
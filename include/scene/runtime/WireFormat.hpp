@@ -0,0 +1,303 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <boost/utility.hpp>
+#include "scene/Scene.hpp"
+#include "scene/SeqPos.hpp"
+#include "scene/runtime/CacheKey.hpp"
+#include "scene/runtime/RenderList.hpp"
+#include "scene/runtime/TransformCache.hpp"
+
+namespace Scene {
+    namespace Runtime {
+
+/** Binary render list wire format for remote clients.
+ *
+ * A frame starts with a versioned header, followed by a sequence of chunks,
+ * optionally compressed with an LZ4-style block compressor:
+ *
+ * - Buffers and shaders are identified by a hash of their contents. Each is
+ *   sent once, and is referenced by hash afterwards. Float buffers may be
+ *   quantized to 16 bits per element. When a new draw order is sent, both
+ *   sides forget the buffers and shaders it doesn't refer to, so they are
+ *   sent again if they are needed later.
+ * - The draw order, which refers to buffers and shaders by hash and to view
+ *   coordinate systems, local coordinate systems and uniform sets by index,
+ *   is only sent when the render list has been rebuilt.
+ * - Coordinate system matrices are sent when they differ from what was last
+ *   sent, and uniform sets when any of their values have changed.
+ *
+ * The format is not portable between machines of different byte order.
+ */
+namespace Wire {
+
+    enum ChunkType {
+        CHUNK_BUFFER = 1,   ///< Buffer contents, keyed by hash.
+        CHUNK_SHADER,       ///< Shader sources, keyed by hash.
+        CHUNK_DRAW_ORDER,   ///< Render items, replaces the previous draw order.
+        CHUNK_VIEW,         ///< Matrices of a view coordinate system.
+        CHUNK_LOCAL,        ///< Matrices of a local coordinate system.
+        CHUNK_UNIFORMS      ///< Contents of a uniform set.
+    };
+
+    enum BufferEncoding {
+        BUFFER_INT32 = 0,
+        BUFFER_FLOAT32,
+        BUFFER_FLOAT_Q16    ///< Floats quantized to 16 bits over [min,max].
+    };
+
+    /** Hash used to identify buffer and shader contents. */
+    uint64_t
+    hash( const void* data, size_t bytes, uint64_t seed = 14695981039346656037ull );
+
+    /** Compress bytes with an LZ4-style block compressor, appending to out. */
+    void
+    compress( std::vector<unsigned char>& out, const unsigned char* in, size_t size );
+
+    /** Decompress a block produced by compress.
+     *
+     * \returns False if the block is corrupt or doesn't expand to size bytes.
+     */
+    bool
+    decompress( unsigned char* out, size_t size, const unsigned char* in, size_t in_size );
+
+} // of namespace Wire
+
+
+/** Encodes a render list into wire format frames for one client.
+ *
+ * The encoder remembers what it has sent, so each frame only holds what the
+ * client doesn't already have. Use reset when the client (re)connects.
+ */
+class WireEncoder : boost::noncopyable
+{
+public:
+    /**
+     * \param database  The database that the render lists are built from.
+     * \param quantize  Send float buffers quantized to 16 bits.
+     * \param compress  Compress frames.
+     */
+    WireEncoder( const DataBase&  database,
+                 bool             quantize = false,
+                 bool             compress = true );
+
+    /** Forget what has been sent, the next frame is complete. */
+    void
+    reset();
+
+    /** Encode the changes since the previous frame.
+     *
+     * \param[out] frame       The encoded frame.
+     * \param[in]  renderlist  The render list to send.
+     * \param[in]  rebuilt     The render list has been rebuilt since the
+     *                         previous frame.
+     */
+    void
+    encode( std::vector<unsigned char>&  frame,
+            const RenderList&            renderlist,
+            bool                         rebuilt );
+
+    /** Size of the last frame before compression. */
+    size_t
+    lastRawSize() const { return m_last_raw_size; }
+
+    /** Number of buffers sent in the last frame. */
+    size_t
+    lastBuffers() const { return m_last_buffers; }
+
+    /** Number of coordinate systems sent in the last frame. */
+    size_t
+    lastCoordSys() const { return m_last_coordsys; }
+
+protected:
+    struct ViewState {
+        const SetViewCoordSys*  m_view;
+        const Value*            m_sources[4];
+        float                   m_sent[4][16];
+    };
+    struct LocalState {
+        const SetLocalCoordSys* m_local;
+        const Value*            m_sources[2];
+        float                   m_sent[2][16];
+    };
+
+    const DataBase&                             m_database;
+    TransformCache                              m_transform_cache;
+    bool                                        m_quantize;
+    bool                                        m_compress;
+    bool                                        m_complete;
+    SeqPos                                      m_last_encode;
+    std::unordered_set<uint64_t>                m_sent_hashes;
+    std::unordered_map<CacheKey<1>,uint64_t>    m_hashes;
+    std::vector<const SourceBuffer*>            m_buffers;
+    std::vector<const Pass*>                    m_shaders;
+    std::vector<ViewState>                      m_views;
+    std::vector<LocalState>                     m_locals;
+    std::vector<const SetUniforms*>             m_uniforms;
+    std::unordered_map<CacheKey<1>,uint32_t>    m_indices;
+    std::vector<unsigned char>                  m_payload;
+    size_t                                      m_last_raw_size;
+    size_t                                      m_last_buffers;
+    size_t                                      m_last_coordsys;
+
+    /** Find buffers, shaders, coordinate systems and uniform sets. */
+    void
+    collect( const RenderList& renderlist );
+
+    uint64_t
+    bufferHash( const SourceBuffer* buffer );
+
+    uint64_t
+    shaderHash( const Pass* pass );
+
+    void
+    encodeBuffer( const SourceBuffer* buffer, uint64_t hash );
+
+    void
+    encodeShader( const Pass* pass, uint64_t hash );
+
+    void
+    encodeDrawOrder( const RenderList& renderlist );
+
+    void
+    encodeUniforms( uint32_t index, const SetUniforms* set_uniforms );
+
+};
+
+
+/** Client-side state assembled from wire format frames. */
+class WireDecoder : boost::noncopyable
+{
+public:
+    struct Buffer {
+        ElementType                 m_type;
+        size_t                      m_count;
+        std::vector<unsigned char>  m_data;
+
+        const float*
+        floatData() const { return reinterpret_cast<const float*>( m_data.data() ); }
+
+        const int*
+        intData() const { return reinterpret_cast<const int*>( m_data.data() ); }
+    };
+
+    struct Shader {
+        std::string                 m_sources[ STAGE_N ];
+    };
+
+    struct Input {
+        std::string                 m_symbol;
+        uint64_t                    m_buffer;
+        int                         m_components;
+        int                         m_offset;
+        int                         m_stride;
+    };
+
+    struct Item {
+        uint32_t                    m_view;
+        uint32_t                    m_local;
+        uint32_t                    m_uniforms;
+        uint64_t                    m_shader;
+        std::vector<Input>          m_inputs;
+        GLenum                      m_mode;
+        int                         m_first;    ///< First vertex or index.
+        int                         m_count;
+        bool                        m_indexed;
+        uint64_t                    m_index_buffer;
+        GLenum                      m_index_type;
+    };
+
+    /** Matrices of a view coordinate system. */
+    struct View {
+        float                       m_projection[16];
+        float                       m_projection_inverse[16];
+        float                       m_eye_from_world[16];
+        float                       m_world_from_eye[16];
+    };
+
+    /** Matrices of a local coordinate system. */
+    struct Local {
+        float                       m_world_from_object[16];
+        float                       m_object_from_world[16];
+    };
+
+    struct Uniform {
+        std::string                 m_symbol;
+        RuntimeSemantic             m_semantic; ///< RUNTIME_SEMANTIC_N if value.
+        ValueType                   m_type;
+        std::vector<uint32_t>       m_data;     ///< Ints or floats.
+    };
+
+    /** Apply a frame to the state.
+     *
+     * \returns False if the frame is corrupt, in which case the state is
+     *          undefined until the encoder has been reset.
+     */
+    bool
+    decode( const unsigned char* frame, size_t size );
+
+    /** Get a buffer by hash, NULL if it hasn't been received. */
+    const Buffer*
+    buffer( uint64_t hash ) const;
+
+    /** Get a shader by hash, NULL if it hasn't been received. */
+    const Shader*
+    shader( uint64_t hash ) const;
+
+    size_t
+    buffers() const { return m_buffers.size(); }
+
+    size_t
+    items() const { return m_items.size(); }
+
+    const Item&
+    item( size_t index ) const { return m_items[index]; }
+
+    const View&
+    view( size_t index ) const { return m_views[index]; }
+
+    const Local&
+    local( size_t index ) const { return m_locals[index]; }
+
+    const std::vector<Uniform>&
+    uniforms( size_t index ) const { return m_uniforms[index]; }
+
+protected:
+    std::unordered_map<uint64_t,Buffer>     m_buffers;
+    std::unordered_map<uint64_t,Shader>     m_shaders;
+    std::vector<Item>                       m_items;
+    std::vector<View>                       m_views;
+    std::vector<Local>                      m_locals;
+    std::vector< std::vector<Uniform> >     m_uniforms;
+    std::vector<unsigned char>              m_payload;
+
+    /** Drop buffers and shaders that the draw order doesn't refer to. */
+    void
+    evict();
+};
+
+
+    } // of namespace Runtime
+} // of namespace Scene
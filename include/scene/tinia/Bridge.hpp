@@ -18,7 +18,13 @@
 
 #pragma once
 
+#include <vector>
+#include <unordered_map>
 #include <tinia/renderlist/DataBase.hpp>
+#include <tinia/renderlist/SetViewCoordSys.hpp>
+#include <tinia/renderlist/SetLocalCoordSys.hpp>
+#include <tinia/renderlist/SetLight.hpp>
+#include <tinia/renderlist/SetUniforms.hpp>
 #include <scene/DataBase.hpp>
 #include <scene/SeqPos.hpp>
 #include <scene/runtime/Resolver.hpp>
@@ -28,10 +34,31 @@
 namespace Scene {
     namespace Tinia {
 
-/** Holds cached items for exporter render lists. */
+/** Holds cached items for exporter render lists.
+ *
+ * The bridge keeps track of what it has sent. When the render list is
+ * rebuilt, the client-side actions and draw order are rebuilt as well. When
+ * it is patched, the draw order is rebuilt, but only the actions of new
+ * items are sent.
+ * Otherwise, a push only re-sends the buffers and shaders that have changed
+ * since the previous push, the coordinate systems whose matrices differ from
+ * what was last sent, and the uniform sets with changed values. Changed
+ * buffers, shaders and lights are found from the library change journals,
+ * see Library::changesSince.
+ */
 class Bridge
 {
 public:
+    /** What the last push sent to the render list database. */
+    struct PushStatistics
+    {
+        bool    m_draw_order;   ///< Draw order was rebuilt.
+        size_t  m_buffers;
+        size_t  m_shaders;
+        size_t  m_coordsys;     ///< View, local and light coordinate systems.
+        size_t  m_uniforms;     ///< Uniform sets.
+    };
+
     Bridge( const DataBase&     database,
                 ProfileType         profile,
                 const std::string&  platform = "" );
@@ -47,16 +74,102 @@ public:
     const tinia::renderlist::DataBase&
     renderListDataBase() const;
 
+    const PushStatistics&
+    pushStatistics() const { return m_push_statistics; }
+
 protected:
+    /** A client-side coordinate system and the matrices last sent to it. */
+    template<typename Action, size_t N>
+    struct MatrixSync
+    {
+        Action*         m_action;
+        const Value*    m_sources[N];
+        float           m_sent[N][16];
+    };
+
+    typedef MatrixSync<tinia::renderlist::SetViewCoordSys,4>    ViewSync;
+    typedef MatrixSync<tinia::renderlist::SetLocalCoordSys,2>   LocalSync;
+
+    struct LightSync : public MatrixSync<tinia::renderlist::SetLight,2>
+    {
+        const Light*    m_light;
+        bool            m_pending;      ///< Light has not been sent yet.
+    };
+
+    struct UniformSync
+    {
+        tinia::renderlist::SetUniforms*     m_action;
+        const Runtime::SetUniforms*         m_set_uniforms;
+        bool                                m_pending;  ///< Values have not been sent yet.
+    };
+
     const DataBase&             m_database;
     Runtime::Resolver                    m_resolver;
     tinia::renderlist::DataBase m_renderlist_db;
     Runtime::RenderList                  m_renderlist;
     Runtime::TransformCache              m_transform_cache;
     SeqPos                      m_last_update;
+    PushStatistics              m_push_statistics;
+
+    typedef std::unordered_multimap<Identifiable::Id,size_t> IndexMap;
+
+    // Render list contents, collected when the render list is rebuilt.
+    std::vector<const SourceBuffer*>    m_buffers;
+    std::vector<const Pass*>            m_shaders;
+    IndexMap                            m_buffer_index;     ///< Source buffer id to index in m_buffers.
+    IndexMap                            m_shader_index;     ///< Effect id to indices in m_shaders.
+    IndexMap                            m_light_index;      ///< Light id to indices in m_light_syncs.
+    std::vector<const Image*>           m_images;
+    std::vector<ViewSync>               m_view_syncs;
+    std::vector<LocalSync>              m_local_syncs;
+    std::vector<LightSync>              m_light_syncs;
+    std::vector<UniformSync>            m_uniform_syncs;
+
+    /** Push changes to the render list database.
+     *
+     * \param rebuilt  The render list has been rebuilt or patched since the
+     *                 last push.
+     */
+    void
+    push( bool rebuilt );
+
+    /** Collect the buffers, shaders and images the render list uses, and
+     * register the matrices it needs with the transform cache.
+     */
+    void
+    collect();
+
+    /** Recreate client-side actions and the draw order from the render list.
+     *
+     * If the render list was patched, the coordinate systems, lights and
+     * uniform sets that were synced before keep what was last sent.
+     */
+    void
+    rebuildDrawOrder();
+
+    /** Copy the current source matrices into sent, returns true if any of
+     * them differed.
+     */
+    template<typename Sync>
+    static bool
+    matricesChanged( Sync& sync );
+
+    void
+    pushUniforms( const UniformSync& sync );
 
     void
-    push();
+    pushLight( const LightSync& sync );
+
+    /** Find what has changed since the last push from the library journals.
+     *
+     * Sets the entries of buffers, shaders and lights that correspond to
+     * changed objects. Returns false if a journal has dropped changes since
+     * the last push, in which case all must be examined.
+     */
+    bool
+    journaledChanges( std::vector<char>& buffers,
+                      std::vector<char>& shaders,
+                      std::vector<char>& lights ) const;
 
 };
 
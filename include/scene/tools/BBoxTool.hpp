@@ -44,6 +44,19 @@ updateBoundingBox( Geometry* geometry );
 void
 updateBoundingBoxes( DataBase& database );
 
+/** Update the bounding boxes of geometries changed since a given timestamp.
+ *
+ * Uses the change journals of the database to only visit geometries that have
+ * been added or changed since the bounding boxes were last updated. If any
+ * source buffer has changed, or the journals have overflowed, all geometries
+ * are visited as with updateBoundingBoxes.
+ *
+ * \param database  The database with the geometries to update.
+ * \param updated   Timestamp of the previous update, touched on return.
+ */
+void
+updateBoundingBoxes( DataBase& database, SeqPos& updated );
+
 
 /** Determine the axis-aligned bounding box for a visual scene.
  *
@@ -0,0 +1,78 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace Scene {
+    namespace Tools {
+
+/** Parse a whitespace-separated list of floats.
+ *
+ * Decimal numbers are parsed by a fast path that produces the same result as
+ * strtof; anything else (e.g. inf, nan, hexadecimal or very long mantissas) is
+ * passed on to strtof. Large inputs are split across several threads when
+ * Scene is built with thread support.
+ *
+ * \param[out] dst    Destination of at least count floats.
+ * \param[in]  count  The number of floats to parse.
+ * \param[in]  begin  Start of text.
+ * \param[in]  end    End of text.
+ * \returns The number of floats parsed, less than count if the text ended
+ *          prematurely or contained something that is not a number.
+ */
+size_t
+parseFloats( float* dst, const size_t count, const char* begin, const char* end );
+
+/** Parse a whitespace-separated list of ints.
+ *
+ * Accepts the same syntax as strtol with base 0 (i.e., leading 0x denotes a
+ * hexadecimal number and leading 0 an octal number).
+ *
+ * \param[out] dst     Destination of at least count ints.
+ * \param[in]  count   The number of ints to store.
+ * \param[in]  begin   Start of text.
+ * \param[in]  end     End of text.
+ * \param[in]  offset  Number of ints to skip before the first stored int.
+ * \param[in]  stride  Store every stride'th int.
+ * \returns The number of ints stored, less than count if the text ended
+ *          before all ints (including the stride of the last) were read.
+ */
+size_t
+parseInts( int* dst, const size_t count, const char* begin, const char* end,
+           const size_t offset=0, const size_t stride=1 );
+
+/** Count the whitespace-separated tokens in a text. */
+size_t
+countTokens( const char* begin, const char* end );
+
+/** Parse a single float at p, skipping leading whitespace.
+ *
+ * \returns False if no number could be parsed, otherwise p is advanced past
+ *          the number.
+ */
+bool
+parseFloat( float& result, const char*& p, const char* end );
+
+/** Parse a single int at p, skipping leading whitespace, see parseFloat. */
+bool
+parseInt( int& result, const char*& p, const char* end );
+
+    } // of namespace Tools
+} // of namespace Scene
@@ -59,7 +59,7 @@ float
 Camera::near() const
 {
     if( (m_type != CAMERA_PERSPECTIVE) && (m_type != CAMERA_ORTHOGONAL) ) {
-        Logger log = getLogger( package + ".near" );
+        static const Logger log = getLogger( package + ".near" );
         SCENELOG_ERROR( log, "Camera isn't perspective nor orthogonal." );
     }
     return m_near;
@@ -69,7 +69,7 @@ float
 Camera::far() const
 {
     if( (m_type != CAMERA_PERSPECTIVE) && (m_type != CAMERA_ORTHOGONAL) ) {
-        Logger log = getLogger( package + ".far" );
+        static const Logger log = getLogger( package + ".far" );
         SCENELOG_ERROR( log, "Camera isn't perspective nor orthogonal." );
     }
     return m_far;
@@ -79,7 +79,7 @@ float
 Camera::magX() const
 {
     if( m_type != CAMERA_ORTHOGONAL ) {
-        Logger log = getLogger( package + ".magX" );
+        static const Logger log = getLogger( package + ".magX" );
         SCENELOG_ERROR( log, "Camera does not have an orthogonal projection." );
     }
     return m_scale_x;
@@ -89,7 +89,7 @@ float
 Camera::magY() const
 {
     if( m_type != CAMERA_ORTHOGONAL ) {
-        Logger log = getLogger( package + ".magY" );
+        static const Logger log = getLogger( package + ".magY" );
         SCENELOG_ERROR( log, "Camera does not have an orthogonal projection." );
     }
     return m_scale_y;
@@ -99,7 +99,7 @@ float
 Camera::fovX() const
 {
     if( m_type != CAMERA_PERSPECTIVE ) {
-        Logger log = getLogger( package + ".fovX" );
+        static const Logger log = getLogger( package + ".fovX" );
         SCENELOG_ERROR( log, "Camera does not have a perspective projection." );
     }
     return m_scale_x;
@@ -109,7 +109,7 @@ float
 Camera::fovY() const
 {
     if( m_type != CAMERA_PERSPECTIVE ) {
-        Logger log = getLogger( package + ".fovY" );
+        static const Logger log = getLogger( package + ".fovY" );
         SCENELOG_ERROR( log, "Camera does not have a perspective projection." );
     }
     return m_scale_y;
@@ -173,7 +173,7 @@ Camera::setCustomMatrix( const Value& matrix )
         m_library_cameras->dataBase()->moveForward( *this );
     }
     else {
-        Logger log = getLogger( package + ".setCustomMatrix" );
+        static const Logger log = getLogger( package + ".setCustomMatrix" );
         SCENELOG_ERROR( log, "Value is not of type float4x4." );
     }
 }
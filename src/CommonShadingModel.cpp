@@ -83,7 +83,7 @@ CommonShadingModel::clearComponentValue( const ShadingModelComponentType comp )
 void
 CommonShadingModel::setComponentValue( const ShadingModelComponentType comp, const Value& value )
 {
-    Logger log = getLogger( package + ".setComponentValue" );
+    static const Logger log = getLogger( package + ".setComponentValue" );
     switch( comp ) {
     case SHADING_COMP_EMISSION:
     case SHADING_COMP_DIFFUSE:
@@ -141,7 +141,7 @@ CommonShadingModel::setComponentParameterReference( const ShadingModelComponentT
 void
 CommonShadingModel::setComponentImageReference( const ShadingModelComponentType comp, const std::string& reference )
 {
-    Logger log = getLogger( package + ".setComponentImageReference" );
+    static const Logger log = getLogger( package + ".setComponentImageReference" );
     switch( comp ) {
     case SHADING_COMP_EMISSION:
     case SHADING_COMP_AMBIENT:
@@ -187,7 +187,7 @@ CommonShadingModel::componentValue( const ShadingModelComponentType comp ) const
         return m_components[comp].m_value;
     }
     else {
-        Logger log = getLogger( package + ".componentValue" );
+        static const Logger log = getLogger( package + ".componentValue" );
         SCENELOG_ERROR( log, "No value defined for component " << comp );
         return NULL;
     }
@@ -207,7 +207,7 @@ CommonShadingModel::componentParameterReference( const ShadingModelComponentType
     }
     else {
         static const std::string empty = "";
-        Logger log = getLogger( package + ".componentParameterReference" );
+        static const Logger log = getLogger( package + ".componentParameterReference" );
         SCENELOG_ERROR( log, "No parameter reference defined for component " << comp );
         return empty;
     }
@@ -227,7 +227,7 @@ CommonShadingModel::componentImageReference( const ShadingModelComponentType com
     }
     else {
         static const std::string empty = "";
-        Logger log = getLogger( package + ".componentImageReference" );
+        static const Logger log = getLogger( package + ".componentImageReference" );
         SCENELOG_ERROR( log, "No image reference defined for component " << comp );
         return empty;
     }
@@ -92,6 +92,20 @@ DataBase::clear()
     touchStructureChanged();
 }
 
+void
+DataBase::setJournalCapacity( size_t capacity )
+{
+    m_library_geometries.setJournalCapacity( capacity );
+    m_library_images.setJournalCapacity( capacity );
+    m_library_cameras.setJournalCapacity( capacity );
+    m_library_lights.setJournalCapacity( capacity );
+    m_library_effects.setJournalCapacity( capacity );
+    m_library_materials.setJournalCapacity( capacity );
+    m_library_nodes.setJournalCapacity( capacity );
+    m_library_source_buffers.setJournalCapacity( capacity );
+    m_library_visual_scenes.setJournalCapacity( capacity );
+}
+
 
 } // of namespace Scene
 
@@ -78,7 +78,7 @@ Effect::~Effect( )
 const Parameter*
 Effect::parameter( const size_t index ) const
 {
-    Logger log = getLogger( "Scene.Effect.parameter" );
+    static const Logger log = getLogger( "Scene.Effect.parameter" );
 
     SCENELOG_TRACE( log, m_id << ": " << m_parameters[index]->value()->debugString() );
 
@@ -90,7 +90,7 @@ Effect::parameter( const size_t index ) const
 void
 Effect::addParameter( const Parameter& p )
 {
-    Logger log = getLogger( "Scene.Effect.addParameter" );
+    static const Logger log = getLogger( "Scene.Effect.addParameter" );
     if( !p.sid().empty() ) {
         for( auto it=m_parameters.begin(); it!=m_parameters.end(); ++it ) {
             if( (*it)->sid() == p.sid() ) {
@@ -123,7 +123,7 @@ Effect::key() const
 Profile*
 Effect::createProfile( ProfileType type )
 {
-    Logger log = getLogger( "Scene.Effect.createProfile" );
+    static const Logger log = getLogger( "Scene.Effect.createProfile" );
     if( profile( type ) != NULL ) {
         SCENELOG_ERROR( log, "Profile "
                         << std::hex << type << std::dec <<
@@ -17,18 +17,21 @@
  */
 
 #include <iostream>
-#include <sstream>
 #include <stdexcept>
-#include <map>
 #include <unordered_map>
 #include <algorithm>
+#include <array>
+#include <memory>
+#include <cstdint>
 #include <boost/lexical_cast.hpp>
 #include "scene/Geometry.hpp"
 #include "scene/Primitives.hpp"
 #include "scene/SourceBuffer.hpp"
 #include "scene/DataBase.hpp"
 #include "scene/Utils.hpp"
+#include "scene/runtime/ThreadPool.hpp"
 #include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
 
 namespace Scene {
     using std::string;
@@ -85,48 +88,145 @@ Geometry::hasSharedInputs() const
     return retval;
 }
 
-bool
-Geometry::flatten()
+namespace {
+
+/** Open-addressing map from index tuples to vertex indices.
+ *
+ * Tuples are numbered in the order they are first inserted, and are kept
+ * packed back to back so that the vertex data can be gathered from them.
+ */
+class TupleMap
 {
-    Logger log = getLogger( package + "." + m_id + ".flatten" );
-    if( !hasSharedInputs() ) {
-        SCENELOG_WARN( log, "No need to flatten a geometry without shared inputs." );
-        return true;
+public:
+    TupleMap( unsigned int width, size_t expected )
+        : m_width( width ),
+          m_count( 0 )
+    {
+        size_t capacity = 64;
+        while( capacity < 2*expected ) {
+            capacity *= 2;
+        }
+        m_slots.resize( capacity, Slot::empty() );
+        m_tuples.reserve( width*expected );
     }
 
-    struct Tuple {
-        unsigned int    m_tuple[ VERTEX_SEMANTIC_N ];
-        bool operator<(const Tuple& b) const {
-            for( unsigned int i=0; i<VERTEX_SEMANTIC_N; i++ ) {
-                if( m_tuple[i] < b.m_tuple[i] ) {
-                    return true;
-                }
-                else if( m_tuple[i] > b.m_tuple[i] ) {
-                    return false;
+    /** Returns the index of a tuple, adding it if it is new. */
+    unsigned int
+    insert( const unsigned int* tuple )
+    {
+        const uint32_t h = hash( tuple );
+        const size_t mask = m_slots.size()-1;
+        for( size_t i=h & mask; ; i=(i+1) & mask ) {
+            Slot& slot = m_slots[i];
+            if( slot.m_index == ~0u ) {
+                slot.m_hash = h;
+                slot.m_index = static_cast<unsigned int>( m_count );
+                m_tuples.insert( m_tuples.end(), tuple, tuple + m_width );
+                if( 2*(++m_count) > m_slots.size() ) {
+                    grow();
                 }
+                return static_cast<unsigned int>( m_count-1 );
+            }
+            if( (slot.m_hash == h) &&
+                std::equal( tuple, tuple + m_width, m_tuples.data() + m_width*slot.m_index ) )
+            {
+                return slot.m_index;
             }
-            return false;
         }
+    }
+
+    size_t
+    size() const { return m_count; }
 
+    /** The tuple with a given index. */
+    const unsigned int*
+    tuple( size_t index ) const { return m_tuples.data() + m_width*index; }
+
+protected:
+    struct Slot {
+        uint32_t        m_hash;
+        unsigned int    m_index;
+
+        static Slot
+        empty() { Slot s; s.m_hash = 0; s.m_index = ~0u; return s; }
     };
 
+    unsigned int                m_width;
+    size_t                      m_count;
+    std::vector<Slot>           m_slots;
+    std::vector<unsigned int>   m_tuples;
+
+    uint32_t
+    hash( const unsigned int* tuple ) const
+    {
+        uint64_t h = 0x9e3779b97f4a7c15ull;
+        for( unsigned int i=0; i<m_width; i++ ) {
+            h = (h ^ tuple[i]) * 0xff51afd7ed558ccdull;
+            h ^= h >> 32;
+        }
+        return static_cast<uint32_t>( h );
+    }
+
+    void
+    grow()
+    {
+        std::vector<Slot> slots( 2*m_slots.size(), Slot::empty() );
+        const size_t mask = slots.size()-1;
+        for( size_t k=0; k<m_slots.size(); k++ ) {
+            if( m_slots[k].m_index != ~0u ) {
+                size_t i = m_slots[k].m_hash & mask;
+                while( slots[i].m_index != ~0u ) {
+                    i = (i+1) & mask;
+                }
+                slots[i] = m_slots[k];
+            }
+        }
+        m_slots.swap( slots );
+    }
+};
+
+// Index tuples per chunk that is deduplicated on its own.
+const size_t flatten_chunk_size = 1u<<18;
+
+} // of anonymous namespace
+
+bool
+Geometry::flatten()
+{
+    static const Logger log = getLogger( package + ".flatten" );
+    SCENE_PROFILE_SCOPE( "Geometry::flatten" );
+    if( !hasSharedInputs() ) {
+        SCENELOG_WARN( log, "'" << m_id << "': No need to flatten a geometry without shared inputs." );
+        return true;
+    }
 
-//    VertexInput inputs[ VERTEX_SEMANTIC_N ] = m_vertex_inputs;
     VertexInput inputs[ VERTEX_SEMANTIC_N ];
     for (int i = 0; i < VERTEX_SEMANTIC_N; ++i) {
         inputs[i] = m_vertex_inputs[i];
     }
 
-    std::map< Tuple, unsigned int> remap;
-
-    std::vector< int > indices;
-    std::vector< unsigned int > offsets;
+    // A run of index tuples from one primitive set, deduplicated on its own
+    // and then merged into the geometry-wide set of tuples.
+    struct Chunk {
+        const int*                  m_indices;      // First index tuple, NULL if non-indexed.
+        unsigned int                m_first;        // First vertex within primitive set.
+        unsigned int                m_count;
+        size_t                      m_output;       // Position in the flattened indices.
+        const unsigned int*         m_tuple_offsets;
+        unsigned int                m_tuple_size;
+        std::vector<unsigned int>   m_local;        // Local tuple index per vertex.
+        std::vector<unsigned int>   m_remap;        // Local to global tuple index.
+        std::unique_ptr<TupleMap>   m_map;
+    };
 
-    for( auto it=m_primitive_sets.begin(); it!=m_primitive_sets.end(); ++it ) {
+    std::vector< std::array<unsigned int,VERTEX_SEMANTIC_N> > set_tuple_offsets( m_primitive_sets.size() );
+    std::vector< size_t > offsets;
+    size_t total = 0;
 
-        SCENELOG_DEBUG( log, "Processing primitive " );
+    for( size_t s=0; s<m_primitive_sets.size(); s++ ) {
+        const Primitives* ps = m_primitive_sets[s];
 
-        unsigned int tuple_offsets[ VERTEX_SEMANTIC_N ];
+        unsigned int* tuple_offsets = set_tuple_offsets[s].data();
         for( unsigned int i=0; i<VERTEX_SEMANTIC_N; i++ ) {
             tuple_offsets[i] = ~0u;
         }
@@ -136,12 +236,12 @@ Geometry::flatten()
         // grap the tuple offset from VERTEX_POSITION (which is an alias for
         // semantic=VERTEX within a shared input).
         unsigned int vertex_tuple_offset = 0;
-        if( (*it)->hasSharedInputs() ) {
-            if( (*it)->sharedInputEnabled(VERTEX_POSITION) ) {
-                vertex_tuple_offset = (*it)->sharedInputTupleOffset( VERTEX_POSITION );
+        if( ps->hasSharedInputs() ) {
+            if( ps->sharedInputEnabled(VERTEX_POSITION) ) {
+                vertex_tuple_offset = ps->sharedInputTupleOffset( VERTEX_POSITION );
             }
             else {
-                SCENELOG_WARN( log, "Input semantic VERTEX is required for shared inputs, giving up." );
+                SCENELOG_WARN( log, "'" << m_id << "': Input semantic VERTEX is required for shared inputs, giving up." );
                 return false;
             }
         }
@@ -156,92 +256,120 @@ Geometry::flatten()
         // update the tuple indices.
         for( unsigned int i=1; i<VERTEX_SEMANTIC_N; i++ ) {
             VertexSemantic sem = (VertexSemantic)i;
-            if( (*it)->sharedInputEnabled(sem) ) {
+            if( ps->sharedInputEnabled(sem) ) {
                 if( inputs[i].m_enabled ) {
-                    if( (inputs[i].m_source_buffer_id != (*it)->sharedInputSourceBuffer(sem) ) ||
-                        (inputs[i].m_components       != (*it)->sharedInputComponents(sem)   ) ||
-                        (inputs[i].m_count            != (*it)->sharedInputCount(sem)        ) ||
-                        (inputs[i].m_stride           != (*it)->sharedInputStride(sem)       ) ||
-                        (inputs[i].m_offset           != (*it)->sharedInputOffset(sem)       ) )
+                    if( (inputs[i].m_source_buffer_id != ps->sharedInputSourceBuffer(sem) ) ||
+                        (inputs[i].m_components       != ps->sharedInputComponents(sem)   ) ||
+                        (inputs[i].m_count            != ps->sharedInputCount(sem)        ) ||
+                        (inputs[i].m_stride           != ps->sharedInputStride(sem)       ) ||
+                        (inputs[i].m_offset           != ps->sharedInputOffset(sem)       ) )
                     {
-                        SCENELOG_ERROR( log, "Mismatch in shared input source definitions, giving up." );
+                        SCENELOG_ERROR( log, "'" << m_id << "': Mismatch in shared input source definitions, giving up." );
                         return false;
                     }
                 }
                 else {
                     inputs[i].m_enabled          = true;
-                    inputs[i].m_source_buffer_id = (*it)->sharedInputSourceBuffer(sem);
-                    inputs[i].m_components       = (*it)->sharedInputComponents(sem);
-                    inputs[i].m_count            = (*it)->sharedInputCount(sem);
-                    inputs[i].m_stride           = (*it)->sharedInputStride(sem);
-                    inputs[i].m_offset           = (*it)->sharedInputOffset(sem);
+                    inputs[i].m_source_buffer_id = ps->sharedInputSourceBuffer(sem);
+                    inputs[i].m_components       = ps->sharedInputComponents(sem);
+                    inputs[i].m_count            = ps->sharedInputCount(sem);
+                    inputs[i].m_stride           = ps->sharedInputStride(sem);
+                    inputs[i].m_offset           = ps->sharedInputOffset(sem);
                 }
-                tuple_offsets[ i ] = (*it)->sharedInputTupleOffset( sem );
+                tuple_offsets[ i ] = ps->sharedInputTupleOffset( sem );
             }
         }
-        for( unsigned int i=0; i<VERTEX_SEMANTIC_N; i++ ) {
-            if( tuple_offsets[i] != ~0u ) {
-                SCENELOG_DEBUG( log, "sem=" << i << ", offset=" << tuple_offsets[i] );
-            }
-        }
-
+        offsets.push_back( total );
+        total += ps->vertexCount();
+    }
+    offsets.push_back( total );
 
-        // Extract indicies
-        offsets.push_back( indices.size() );
-        if( (*it)->isIndexed() ) {
-            SourceBuffer* index_buf = m_db.library<SourceBuffer>().get( (*it)->indexBufferId() );
-            const int* ix = index_buf->intData();
+    // Only semantics that are enabled by some primitive set take part in the
+    // tuples, the remaining entries would be ~0u for all vertices.
+    unsigned int active[ VERTEX_SEMANTIC_N ];
+    unsigned int width = 0;
+    for( unsigned int i=0; i<VERTEX_SEMANTIC_N; i++ ) {
+        if( inputs[i].m_enabled ) {
+            active[ width++ ] = i;
+        }
+    }
+    if( width == 0 ) {
+        SCENELOG_ERROR( log, "'" << m_id << "': No source data, giving up" );
+        return false;
+    }
 
-            for( unsigned int p=0; p<(*it)->vertexCount(); p++ ) {
+    // Split the primitive sets into chunks.
+    std::vector<Chunk> chunks;
+    for( size_t s=0; s<m_primitive_sets.size(); s++ ) {
+        const Primitives* ps = m_primitive_sets[s];
+        const int* ix = NULL;
+        if( ps->isIndexed() ) {
+            const SourceBuffer* index_buf = m_db.library<SourceBuffer>().get( ps->indexBufferId() );
+            if( index_buf == NULL ) {
+                SCENELOG_ERROR( log, "'" << m_id << "': Unable to resolve index buffer, giving up." );
+                return false;
+            }
+            ix = index_buf->intData() + ps->indexOffset();
+        }
+        for( size_t first=0; first<ps->vertexCount(); first+=flatten_chunk_size ) {
+            chunks.push_back( Chunk() );
+            Chunk& chunk = chunks.back();
+            chunk.m_indices = ix;
+            chunk.m_first = static_cast<unsigned int>( first );
+            chunk.m_count = static_cast<unsigned int>( std::min( flatten_chunk_size, ps->vertexCount() - first ) );
+            chunk.m_output = offsets[s] + first;
+            chunk.m_tuple_offsets = set_tuple_offsets[s].data();
+            chunk.m_tuple_size = ps->sharedInputTupleSize();
+        }
+    }
 
-                Tuple t;
-                for( unsigned int i=0; i<VERTEX_SEMANTIC_N; i++ ) {
-                    if( tuple_offsets[ i ] == ~0u ) {
-                        t.m_tuple[i] = ~0u;
-                    }
-                    else {
-                        t.m_tuple[i] = ix[ (*it)->indexOffset() +
-                                           (*it)->sharedInputTupleSize()*p +
-                                           tuple_offsets[ i ] ];
-                    }
+    const size_t threads = total >= flatten_chunk_size ? Runtime::ThreadPool::hardwareThreads() : 1;
+
+    // Deduplicate each chunk on its own, numbering tuples in the order they
+    // first occur.
+    Runtime::parallelFor( chunks.size(), threads, [&]( size_t c ) {
+        Chunk& chunk = chunks[c];
+        chunk.m_map.reset( new TupleMap( width, chunk.m_count/2 ) );
+        chunk.m_local.resize( chunk.m_count );
+        unsigned int t[ VERTEX_SEMANTIC_N ];
+        for( unsigned int p=0; p<chunk.m_count; p++ ) {
+            const unsigned int v = chunk.m_first + p;
+            for( unsigned int k=0; k<width; k++ ) {
+                const unsigned int o = chunk.m_tuple_offsets[ active[k] ];
+                if( o == ~0u ) {
+                    t[k] = ~0u;
                 }
-
-                unsigned int ix;
-                auto it = remap.find( t );
-                if( it == remap.end() ) {
-                    ix = remap.size();
-                    remap[ t ] = ix;
+                else if( chunk.m_indices != NULL ) {
+                    t[k] = chunk.m_indices[ chunk.m_tuple_size*v + o ];
                 }
                 else {
-                    ix = it->second;
+                    t[k] = v;
                 }
-                indices.push_back( ix );
             }
+            chunk.m_local[p] = chunk.m_map->insert( t );
         }
-        // Create indices for non-indexed shapes
-        else {
-            for( unsigned int p=0; p<(*it)->vertexCount(); p++ ) {
-                Tuple t;
-                for( unsigned int i=0; i<VERTEX_SEMANTIC_N; i++ ) {
-                    t.m_tuple[i] = ( tuple_offsets[i] == ~0u ? ~0u : p);
-                }
-                unsigned int ix;
-                auto it = remap.find( t );
-                if( it == remap.end() ) {
-                    ix = remap.size();
-                    remap[ t ] = ix;
-                }
-                else {
-                    ix = it->second;
-                }
-                indices.push_back( ix );
+    } );
 
-            }
+    // Merge the chunks in order, which numbers the tuples in the order they
+    // first occur in the geometry, and reuses tuples across primitive sets.
+    size_t local_tuples = 0;
+    for( size_t c=0; c<chunks.size(); c++ ) {
+        local_tuples += chunks[c].m_map->size();
+    }
+    const bool single = chunks.size() == 1;
+    TupleMap remap( width, single ? 0 : local_tuples );
+    for( size_t c=0; c<chunks.size(); c++ ) {
+        Chunk& chunk = chunks[c];
+        chunk.m_remap.resize( chunk.m_map->size() );
+        for( size_t l=0; l<chunk.m_remap.size(); l++ ) {
+            chunk.m_remap[l] = single ? l : remap.insert( chunk.m_map->tuple( l ) );
+        }
+        if( !single ) {
+            chunk.m_map.reset();
         }
     }
-    offsets.push_back( indices.size() );
-
-
+    const TupleMap& tuples = single ? *chunks[0].m_map : remap;
+    const size_t vertices = tuples.size();
 
     // Create buffer
     unsigned int interleaved_offsets[ VERTEX_SEMANTIC_N +1 ];
@@ -252,7 +380,7 @@ Geometry::flatten()
             interleaved_offsets[i+1] = interleaved_offsets[i] + inputs[i].m_components;
             const SourceBuffer* sb = m_db.library<SourceBuffer>().get( inputs[i].m_source_buffer_id );
             if( sb == NULL ) {
-                SCENELOG_ERROR( log, "Unable to resolve source buffer, giving up." );
+                SCENELOG_ERROR( log, "'" << m_id << "': Unable to resolve source buffer, giving up." );
                 return false;
             }
             interleaved_sources[i] = sb->floatData();
@@ -261,84 +389,75 @@ Geometry::flatten()
             interleaved_offsets[i+1] = interleaved_offsets[i];
             interleaved_sources[i] = NULL;
         }
-        SCENELOG_DEBUG( log, "interleaved offset " << i << "=" << interleaved_offsets[i] );
+        SCENELOG_DEBUG( log, "'" << m_id << "': interleaved offset " << i << "=" << interleaved_offsets[i] );
     }
     unsigned int interleaved_stride = interleaved_offsets[ VERTEX_SEMANTIC_N ];
     if( interleaved_stride == 0 ) {
-        SCENELOG_ERROR( log, "No source data, giving up" );
+        SCENELOG_ERROR( log, "'" << m_id << "': No source data, giving up" );
         return false;
     }
-
-    std::vector<float> interleaved( interleaved_stride*remap.size() );
-    for( auto it=remap.begin(); it!=remap.end(); ++it ) {
-#if 0
-        SCENELOG_TRACE( log, "map " <<
-                        it->second << " = { " <<
-                        it->first.m_tuple[0] << ", " <<
-                        it->first.m_tuple[1] << ", " <<
-                        it->first.m_tuple[2] << ", " <<
-                        it->first.m_tuple[3] << ", " <<
-                        it->first.m_tuple[4] << ", " <<
-                        it->first.m_tuple[5] << ", " <<
-                        it->first.m_tuple[6] << ", " <<
-                        it->first.m_tuple[7] << "} " );
-        float* dst = interleaved.data() + it->second*interleaved_stride;
-#endif
-        for( unsigned int i=0; i<VERTEX_SEMANTIC_N; i++ ) {
-            if( it->first.m_tuple[i] == ~0u ) {
-                // ignore
-            }
-            else {
-                std::copy_n( interleaved_sources[i] +
-                             inputs[i].m_offset +
-                             inputs[i].m_stride*it->first.m_tuple[i],
-                             inputs[i].m_components,
-                             interleaved.begin() +
-                             it->second*interleaved_stride +
-                             interleaved_offsets[i] );
-
-            }
-
-        }
-        std::stringstream o;
-        for( unsigned int i=0; i<interleaved_stride; i++ ) {
-            if( i!=0 ) {
-                o << ", ";
-            }
-            o << interleaved[ it->second*interleaved_stride + i ];
-        }
-        SCENELOG_TRACE( log, "data: " << o.str() );
-    }
-
-    SCENELOG_DEBUG( log, "Interleaved attribute tuple is of size " << interleaved_offsets[ VERTEX_SEMANTIC_N ] );
+    SCENELOG_DEBUG( log, "'" << m_id << "': Interleaved attribute tuple is of size " << interleaved_stride );
 
     SourceBuffer* interleaved_buffer = m_db.library<SourceBuffer>().add( m_id + "_attributes_float_interleaved" );
     if( interleaved_buffer == NULL ) {
-        SCENELOG_ERROR( log, "Failed to create interleaved attribute buffer, giving up." );
+        SCENELOG_ERROR( log, "'" << m_id << "': Failed to create interleaved attribute buffer, giving up." );
         return false;
     }
     SourceBuffer* index_buffer = m_db.library<SourceBuffer>().add( m_id + "_flat_indices" );
     if( index_buffer == NULL ) {
-        SCENELOG_ERROR( log, "Failed to create buffer for flattened indices, giving up" );
+        SCENELOG_ERROR( log, "'" << m_id << "': Failed to create buffer for flattened indices, giving up" );
         return false;
     }
 
-    interleaved_buffer->contents( interleaved );
+    // Gather the vertex attributes and write the indices directly into the
+    // new buffers.
+    float* interleaved = interleaved_buffer->floatContents( interleaved_stride*vertices );
+    const size_t vertex_chunks = (vertices + flatten_chunk_size - 1)/flatten_chunk_size;
+    Runtime::parallelFor( vertex_chunks, threads, [&]( size_t c ) {
+        const size_t end = std::min( vertices, (c+1)*flatten_chunk_size );
+        for( size_t v=c*flatten_chunk_size; v<end; v++ ) {
+            const unsigned int* t = tuples.tuple( v );
+            float* dst = interleaved + interleaved_stride*v;
+            for( unsigned int k=0; k<width; k++ ) {
+                const unsigned int i = active[k];
+                if( t[k] == ~0u ) {
+                    std::fill_n( dst + interleaved_offsets[i], inputs[i].m_components, 0.f );
+                }
+                else {
+                    std::copy_n( interleaved_sources[i] +
+                                 inputs[i].m_offset +
+                                 inputs[i].m_stride*t[k],
+                                 inputs[i].m_components,
+                                 dst + interleaved_offsets[i] );
+                }
+            }
+        }
+    } );
+
+    int* indices = index_buffer->intContents( total );
+    Runtime::parallelFor( chunks.size(), threads, [&]( size_t c ) {
+        const Chunk& chunk = chunks[c];
+        int* dst = indices + chunk.m_output;
+        for( unsigned int p=0; p<chunk.m_count; p++ ) {
+            dst[p] = static_cast<int>( chunk.m_remap[ chunk.m_local[p] ] );
+        }
+    } );
+    SCENE_PROFILE_COUNT( "Geometry.flatten.vertices", vertices );
+
     unsharedInputClearAll();
     for( unsigned int i=0; i<VERTEX_SEMANTIC_N; i++ ) {
         if( inputs[i].m_enabled ) {
             setVertexSource( (VertexSemantic)i,
                              interleaved_buffer->id(),
                              interleaved_offsets[i+1]-interleaved_offsets[i],
-                             remap.size(),
+                             vertices,
                              interleaved_stride,
                              interleaved_offsets[i] );
         }
     }
 
-    index_buffer->contents( indices );
-    SCENELOG_DEBUG( log, "offsets.size=" << offsets.size() );
-    SCENELOG_DEBUG( log, "m_primitive_sets.size=" << m_primitive_sets.size() );
+    SCENELOG_DEBUG( log, "'" << m_id << "': offsets.size=" << offsets.size() );
+    SCENELOG_DEBUG( log, "'" << m_id << "': m_primitive_sets.size=" << m_primitive_sets.size() );
 
     for( size_t i=0; i<m_primitive_sets.size(); i++ ) {
         Primitives* p = m_primitive_sets[i];
@@ -350,7 +469,7 @@ Geometry::flatten()
                offsets[i] );
     }
 
-    return false;
+    return true;
 }
 
 const SeqPos&
@@ -474,7 +593,7 @@ Geometry::removePrimitiveSet( const Primitives* set )
                          m_primitive_sets.end(),
                          set );
     if( it == m_primitive_sets.end() ) {
-        Logger log = getLogger( package + ".removePrimitiveSet" );
+        static const Logger log = getLogger( package + ".removePrimitiveSet" );
         SCENELOG_ERROR( log, "Cannot find primitive set to remove" );
     }
     else {
@@ -30,13 +30,15 @@ namespace Scene
 Image::Image( DataBase& database, const std::string& id )
 : m_database( database ),
   m_id( id ),
-  m_type( IMAGE_N )
+  m_type( IMAGE_N ),
+  m_external_data( NULL )
 {}
 
 Image::Image( Library<Image>* library_images, const std::string& id )
     : m_database( *library_images->dataBase() ),
       m_id( id ),
-      m_type( IMAGE_N )
+      m_type( IMAGE_N ),
+      m_external_data( NULL )
 {
     static unsigned char dummy_image_2d[16*16*4];
     static bool first = true;
@@ -59,7 +61,7 @@ Image::Image( Library<Image>* library_images, const std::string& id )
 bool
 Image::setFormat( GLenum iformat, GLenum format, GLenum type )
 {
-    Logger log = getLogger( "Scene.Image.setFormat" );
+    static const Logger log = getLogger( "Scene.Image.setFormat" );
 
     m_iformat = iformat;
     m_format = format;
@@ -108,7 +110,7 @@ Image::initCube( GLenum iformat,
                  size_t mips,
                  bool   auto_generate )
 {
-    Logger log = getLogger( "Scene.Image.initCube" );
+    static const Logger log = getLogger( "Scene.Image.initCube" );
     if( !setFormat( iformat, format, type ) ) {
         return false;
     }
@@ -122,6 +124,8 @@ Image::initCube( GLenum iformat,
     m_depth = width;
     m_type = IMAGE_CUBE;
     m_data.clear();
+    m_external_data = NULL;
+    m_external_owner.reset();
 
     return true;
 }
@@ -139,7 +143,7 @@ Image::init2D( GLenum iformat,
                size_t mips,
                bool   auto_generate  )
 {
-    Logger log = getLogger( "Scene.Image.init2D" );
+    static const Logger log = getLogger( "Scene.Image.init2D" );
     if( !setFormat( iformat, format, type ) ) {
         return false;
     }
@@ -157,6 +161,8 @@ Image::init2D( GLenum iformat,
     m_depth = 1;
     m_type = IMAGE_2D;
     m_data.clear();
+    m_external_data = NULL;
+    m_external_owner.reset();
     return true;
 }
 
@@ -170,7 +176,7 @@ Image::init2DRelative( GLenum iformat,
                size_t mips,
                bool   auto_generate )
 {
-    Logger log = getLogger( "Scene.Image.init2D" );
+    static const Logger log = getLogger( "Scene.Image.init2D" );
 
     SCENELOG_FATAL( log, "Unimplemented code path!" );
     return false;
@@ -187,7 +193,7 @@ Image::init3D( GLenum iformat,
                size_t mips,
                bool   auto_generate )
 {
-    Logger log = getLogger( "Scene.Image.initCube" );
+    static const Logger log = getLogger( "Scene.Image.initCube" );
     if( !setFormat( iformat, format, type ) ) {
         return false;
     }
@@ -208,6 +214,8 @@ Image::init3D( GLenum iformat,
     m_depth = depth;
     m_type = IMAGE_3D;
     m_data.clear();
+    m_external_data = NULL;
+    m_external_owner.reset();
     return true;
 }
 
@@ -231,9 +239,9 @@ Image::texelsInSlice()
 const void*
 Image::get( size_t mip_level, size_t slice ) const
 {
-    Logger log = getLogger( "Scene.Image.get" );
+    static const Logger log = getLogger( "Scene.Image.get" );
 
-    if( m_data.empty() ) {
+    if( m_data.empty() && m_external_data == NULL ) {
         return NULL;
     }
 
@@ -269,13 +277,57 @@ Image::get( size_t mip_level, size_t slice ) const
 
     size_t slice_mem_size = m_width*m_height*m_channels*m_element_size;
 
+    if( m_external_data != NULL ) {
+        return m_external_data + slice*slice_mem_size;
+    }
     return &m_data[ slice*slice_mem_size ];
 }
 
+size_t
+Image::slicesSize() const
+{
+    const size_t slice_mem_size = m_width*m_height*m_channels*m_element_size;
+    switch( m_type ) {
+    case IMAGE_2D:
+        return slice_mem_size;
+    case IMAGE_3D:
+        return m_depth*slice_mem_size;
+    case IMAGE_CUBE:
+        return 6*slice_mem_size;
+    case IMAGE_N:
+        break;
+    }
+    return 0;
+}
+
+size_t
+Image::dataSize() const
+{
+    if( m_data.empty() && m_external_data == NULL ) {
+        return 0;
+    }
+    return slicesSize();
+}
+
+bool
+Image::reference( const void* data, size_t size, const std::shared_ptr<const void>& owner )
+{
+    if( (m_type == IMAGE_N) || (size != slicesSize()) ) {
+        static const Logger log = getLogger( "Scene.Image.reference" );
+        SCENELOG_ERROR( log, "Size mismatch." );
+        return false;
+    }
+    m_data.clear();
+    m_data.shrink_to_fit();
+    m_external_data = reinterpret_cast<const unsigned char*>( data );
+    m_external_owner = owner;
+    return true;
+}
+
 bool
 Image::set( size_t mip_level, size_t slice, const void* data )
 {
-    Logger log = getLogger( "Scene.Image.set" );
+    static const Logger log = getLogger( "Scene.Image.set" );
 
     if( mip_level != 0 ) {
         SCENELOG_FATAL( log, "Getting of non-zero mip-levels not yet supported." );
@@ -284,6 +336,13 @@ Image::set( size_t mip_level, size_t slice, const void* data )
 
     size_t slice_mem_size = m_width*m_height*m_channels*m_element_size;
 
+    // Take a private copy of referenced data before modifying it.
+    if( m_external_data != NULL ) {
+        m_data.assign( m_external_data, m_external_data + slicesSize() );
+        m_external_data = NULL;
+        m_external_owner.reset();
+    }
+
     // Sanity checks
     switch( m_type ) {
     case IMAGE_2D:
@@ -38,7 +38,7 @@ InstanceGeometry::InstanceGeometry( const std::string geometry_url )
 void
 InstanceGeometry::addMaterialBinding( const std::string& symbol, const std::string& target_id )
 {
-    Logger log = getLogger( "Scene.InstanceGeometry.addMaterialBinding" );
+    static const Logger log = getLogger( "Scene.InstanceGeometry.addMaterialBinding" );
 
     if( symbol.empty() ) {
         SCENELOG_ERROR( log, "Empty symbol, ignoring." );
@@ -95,7 +95,7 @@ InstanceGeometry::addMaterialBindingBind( const std::string& symbol, const Bind&
         it->second.m_bind.push_back( bind );
     }
     else {
-        Logger log = getLogger( "Scene.InstanceGeometry.addMaterialBindingBind" );
+        static const Logger log = getLogger( "Scene.InstanceGeometry.addMaterialBindingBind" );
         SCENELOG_ERROR( log, "Unknown symbol '" << symbol << "', ignoring bind" );
     }
 }
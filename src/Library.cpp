@@ -32,10 +32,14 @@
 
 namespace Scene {
 
+    static const size_t default_journal_capacity = 1024u;
 
 template<class T>
 Library<T>::Library()
-    : m_database( NULL )
+    : m_database( NULL ),
+      m_journal_capacity( default_journal_capacity ),
+      m_journal_next( 0u ),
+      m_deleting( NULL )
 {
 }
 
@@ -60,11 +64,16 @@ Library<T>::clear()
     Logger log = getLogger( m_instance_name + ".clear" );
     SCENELOG_DEBUG( log, "Deleting all contents." );
     for( auto it=m_objects.begin(); it!=m_objects.end(); ++it ) {
+        m_deleting = *it;
         delete *it;
     }
+    m_deleting = NULL;
     m_objects.clear();
     m_map.clear();
+    dropJournal();
 
+    m_objects_removed.touch();
+    m_database->objectsRemoved().moveForward( m_objects_removed );
     touchStructureChanged();
     m_database->moveForward( *this );
 }
@@ -93,12 +102,12 @@ template<class T>
 T*
 Library<T>::get( const std::string& id, bool clone_from_fallback )
 {
-    Logger log = getLogger( m_instance_name + ".get" );
     auto it = m_map.find( id );
     if( it != m_map.end() ) {
         return m_objects[ it->second ];
     }
     else if( clone_from_fallback ) {
+        Logger log = getLogger( m_instance_name + ".get" );
         if( m_database == NULL ) {
             SCENELOG_FATAL( log, "m_database == NULL" );
         }
@@ -153,6 +162,7 @@ Library<T>::add( const std::string& id )
             m_map[ id ] = m_objects.size();
         }
         m_objects.push_back( new T( this, id ) );
+        journal( CHANGE_ADDED, m_objects.back()->Identifiable::id(), m_objects.back() );
         touchStructureChanged();
         m_database->moveForward( *this );
         return m_objects.back();
@@ -241,13 +251,104 @@ Library<T>::remove( T* pointer )
         }
     }
 
-    // Remove object
+    // Changes the destructor reports are not journaled, see moveForward.
+    journal( CHANGE_REMOVED, pointer->Identifiable::id(), NULL );
+    m_deleting = pointer;
     delete pointer;
+    m_deleting = NULL;
 
+    m_objects_removed.touch();
+    m_database->objectsRemoved().moveForward( m_objects_removed );
     touchStructureChanged();
     m_database->moveForward( *this );
 }
 
+template<class T>
+void
+Library<T>::moveForward( const T& object )
+{
+    StructureValueSequences::moveForward( object );
+    if( &object == m_deleting ) {
+        return;
+    }
+
+    const bool value = !object.structureChanged().asRecentAs( object.valueChanged() );
+    const ChangeKind kind = value ? CHANGE_VALUE : CHANGE_STRUCTURE;
+    if( !m_journal.empty() ) {
+        // Objects often notify several times for one change, skip if the
+        // most recent entry already covers this change.
+        const Change& last = m_journal[ (m_journal_next + m_journal.size() - 1) % m_journal.size() ];
+        if( (last.m_identity == object.Identifiable::id()) && (last.m_kind == kind) &&
+            last.m_pos.asRecentAs( value ? object.valueChanged() : object.structureChanged() ) )
+        {
+            return;
+        }
+    }
+    // The library owns the object, so handing out a mutable pointer is ok.
+    journal( kind, object.Identifiable::id(), const_cast<T*>( &object ) );
+}
+
+template<class T>
+void
+Library<T>::journal( ChangeKind kind, Identifiable::Id identity, T* object )
+{
+    if( m_journal_capacity == 0 ) {
+        m_journal_dropped.touch();
+        return;
+    }
+    Change change;
+    change.m_kind = kind;
+    change.m_identity = identity;
+    change.m_object = object;
+    change.m_pos.touch();
+    if( m_journal.size() < m_journal_capacity ) {
+        m_journal.push_back( change );
+        m_journal_next = m_journal.size() % m_journal_capacity;
+    }
+    else {
+        m_journal_dropped = m_journal[ m_journal_next ].m_pos;
+        m_journal[ m_journal_next ] = change;
+        m_journal_next = (m_journal_next + 1) % m_journal_capacity;
+    }
+}
+
+template<class T>
+void
+Library<T>::dropJournal()
+{
+    m_journal.clear();
+    m_journal_next = 0u;
+    m_journal_dropped.touch();
+}
+
+template<class T>
+bool
+Library<T>::changesSince( std::vector<Change>& changes, const SeqPos& since ) const
+{
+    if( !since.asRecentAs( m_journal_dropped ) ) {
+        return false;
+    }
+
+    // Entries are ordered by timestamp, walk backwards from the most recent.
+    const size_t N = m_journal.size();
+    size_t n = 0;
+    while( (n < N) && !since.asRecentAs( m_journal[ (m_journal_next + N - 1 - n) % N ].m_pos ) ) {
+        n++;
+    }
+    for( size_t i=0; i<n; i++ ) {
+        changes.push_back( m_journal[ (m_journal_next + N - n + i) % N ] );
+    }
+    return true;
+}
+
+template<class T>
+void
+Library<T>::setJournalCapacity( size_t capacity )
+{
+    m_journal_capacity = capacity;
+    dropJournal();
+}
+
 template<class T>
 const std::string
 Library<T>::generateId() const
@@ -79,7 +79,7 @@ const Value*
 Light::color() const
 {
     if( m_type == LIGHT_NONE ) {
-        Logger log = getLogger( package + ".color" );
+        static const Logger log = getLogger( package + ".color" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have color property." );
     }
     return &m_color;
@@ -89,7 +89,7 @@ void
 Light::setColor( float red, float green, float blue )
 {
     if( m_type == LIGHT_NONE ) {
-        Logger log = getLogger( package + ".color" );
+        static const Logger log = getLogger( package + ".color" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the color property." );
     }
     m_color = Value::createFloat3( red, green, blue );
@@ -102,7 +102,7 @@ const Value*
 Light::constantAttenuation() const
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".constantAttenuation" );
+        static const Logger log = getLogger( package + ".constantAttenuation" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the constant attenuation property." );
     }
     return &m_constant_attenuation;
@@ -112,7 +112,7 @@ void
 Light::setConstantAttenuation( float constant_attenuation )
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".setConstantAttenuation" );
+        static const Logger log = getLogger( package + ".setConstantAttenuation" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the constant attenuation property." );
     }
     m_constant_attenuation = Value::createFloat( constant_attenuation );
@@ -125,7 +125,7 @@ const std::string&
 Light::constantAttenuationSid() const
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".constantAttenuationSid" );
+        static const Logger log = getLogger( package + ".constantAttenuationSid" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the constant attenuation property." );
     }
     return m_constant_attenuation_sid;
@@ -135,7 +135,7 @@ void
 Light::setConstantAttenuationSid( const std::string& sid )
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".setConstantAttenuationSid" );
+        static const Logger log = getLogger( package + ".setConstantAttenuationSid" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the constant attenuation property." );
     }
     m_constant_attenuation_sid = sid;
@@ -149,7 +149,7 @@ const Value*
 Light::linearAttenuation() const
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".linearAttenuation" );
+        static const Logger log = getLogger( package + ".linearAttenuation" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the linear attenuation property." );
     }
     return &m_linear_attenuation;
@@ -159,7 +159,7 @@ void
 Light::setLinearAttenuation( float linear_attenuation )
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".setLinearAttenuation" );
+        static const Logger log = getLogger( package + ".setLinearAttenuation" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the linear attenuation property." );
     }
     m_linear_attenuation = Value::createFloat( linear_attenuation );
@@ -173,7 +173,7 @@ const std::string&
 Light::linearAttenuationSid() const
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".linearAttenuationSid" );
+        static const Logger log = getLogger( package + ".linearAttenuationSid" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the linear attenuation property." );
     }
     return m_linear_attenuation_sid;
@@ -183,7 +183,7 @@ void
 Light::setLinearAttenuationSid( const std::string& sid )
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".setLinearAttenuationSid" );
+        static const Logger log = getLogger( package + ".setLinearAttenuationSid" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the linear attenuation property." );
     }
     m_linear_attenuation_sid = sid;
@@ -197,7 +197,7 @@ const Value*
 Light::quadraticAttenuation() const
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".quadraticAttenuation" );
+        static const Logger log = getLogger( package + ".quadraticAttenuation" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the quadratic attenuation property." );
     }
     return &m_quadratic_attenuation;
@@ -207,7 +207,7 @@ void
 Light::setQuadraticAttenuation( float linear_attenuation )
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".setQuadraticAttenuation" );
+        static const Logger log = getLogger( package + ".setQuadraticAttenuation" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the quadratic attenuation property." );
     }
     m_quadratic_attenuation = Value::createFloat( linear_attenuation );
@@ -220,7 +220,7 @@ const std::string&
 Light::quadraticAttenuationSid() const
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".quadraticAttenuationSid" );
+        static const Logger log = getLogger( package + ".quadraticAttenuationSid" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the quadratic attenuation property." );
     }
     return m_quadratic_attenuation_sid;
@@ -230,7 +230,7 @@ void
 Light::setQuadraticAttenuationSid( const std::string& sid )
 {
     if( m_type != LIGHT_POINT && m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".setQuadraticAttenuationSid" );
+        static const Logger log = getLogger( package + ".setQuadraticAttenuationSid" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the quadratic attenuation property." );
     }
     m_quadratic_attenuation_sid = sid;
@@ -243,7 +243,7 @@ const Value*
 Light::falloffAngle() const
 {
     if( m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".falloffAngle" );
+        static const Logger log = getLogger( package + ".falloffAngle" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the falloff angle property." );
     }
     return &m_falloff_angle;
@@ -253,7 +253,7 @@ void
 Light::setFalloffAngle( float angle )
 {
     if( m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".setFalloffAngle" );
+        static const Logger log = getLogger( package + ".setFalloffAngle" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the falloff angle property." );
     }
     m_falloff_angle = Value::createFloat( angle );
@@ -266,7 +266,7 @@ const std::string&
 Light::falloffAngleSid( ) const
 {
     if( m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".falloffAngleSid" );
+        static const Logger log = getLogger( package + ".falloffAngleSid" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the falloff angle property." );
     }
     return m_falloff_angle_sid;
@@ -276,7 +276,7 @@ void
 Light::setFalloffAngleSid( const std::string& sid )
 {
     if( m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".setFalloffAngleSid" );
+        static const Logger log = getLogger( package + ".setFalloffAngleSid" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the falloff angle property." );
     }
     m_falloff_angle_sid = sid;
@@ -289,7 +289,7 @@ const Value*
 Light::falloffExponent() const
 {
     if( m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".falloffExponent" );
+        static const Logger log = getLogger( package + ".falloffExponent" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the falloff exponent property." );
     }
     return &m_falloff_exponent;
@@ -299,7 +299,7 @@ void
 Light::setFalloffExponent( float exponent )
 {
     if( m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".setFalloffExponent" );
+        static const Logger log = getLogger( package + ".setFalloffExponent" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the falloff exponent property." );
     }
     m_falloff_exponent = Value::createFloat( exponent );
@@ -312,7 +312,7 @@ const std::string&
 Light::falloffExponentSid() const
 {
     if( m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".falloffExponentSid" );
+        static const Logger log = getLogger( package + ".falloffExponentSid" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the falloff exponent property." );
     }
     return m_falloff_exponent_sid;
@@ -322,7 +322,7 @@ void
 Light::setFalloffExponentSid( const std::string& sid )
 {
     if( m_type != LIGHT_SPOT ) {
-        Logger log = getLogger( package + ".setFalloffExponentSid" );
+        static const Logger log = getLogger( package + ".setFalloffExponentSid" );
         SCENELOG_WARN( log, "Light id='" << m_id << "'does not have the falloff exponent property." );
     }
     m_falloff_exponent_sid = sid;
@@ -65,6 +65,7 @@ Material::setEffectId( const std::string& effect_id )
 {
     m_effect_id = effect_id;
     touchStructureChanged();
+    m_db.library<Material>().moveForward( *this );
     m_db.touchStructureChanged();
 }
 
@@ -105,7 +106,7 @@ const std::string
 Material::techniqueHint( const ProfileType   profile,
                          const std::string&  platform ) const
 {
-    Logger log = getLogger( package + ".techniqueHint" );
+    static const Logger log = getLogger( package + ".techniqueHint" );
 
 
     // search for exact match
@@ -140,7 +141,7 @@ Material::addTechniqueHint( const ProfileType   profile,
                             const std::string&  platform,
                             const std::string&  ref )
 {
-    Logger log = getLogger( "Scene.Material.addTechniqueHint" );
+    static const Logger log = getLogger( "Scene.Material.addTechniqueHint" );
     if( ref.empty() ) {
         SCENELOG_ERROR( log, "Techinque hint with empty reference, ignoring." );
         return;
@@ -158,7 +159,7 @@ Material::addTechniqueHint( const ProfileType   profile,
 void
 Material::setParam(const std::string &reference, const Value &value)
 {
-    Logger log = getLogger( "Scene.Material.setParam" );
+    static const Logger log = getLogger( "Scene.Material.setParam" );
     if( !value.defined() ) {
         SCENELOG_ERROR( log, "Value is undefined!" );
         return;
@@ -174,6 +175,7 @@ Material::setParam(const std::string &reference, const Value &value)
                 // If it is a sampler, we need to redo the render list
                 *p->m_value = value;
                 touchStructureChanged();
+                m_db.library<Material>().moveForward( *this );
                 m_db.touchStructureChanged();
             }
             else {
@@ -181,6 +183,7 @@ Material::setParam(const std::string &reference, const Value &value)
                 // from the pointer.
                 *p->m_value = value;
                 touchValueChanged();
+                m_db.library<Material>().moveForward( *this );
             }
             return;
         }
@@ -194,6 +197,7 @@ Material::setParam(const std::string &reference, const Value &value)
                     ", val=" << value.debugString() );
 
     touchStructureChanged();
+    m_db.library<Material>().moveForward( *this );
     m_db.touchStructureChanged();
 }
 
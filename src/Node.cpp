@@ -85,6 +85,9 @@ Node::setParent( Node* parent )
                 break;
             }
         }
+        m_parent->touchStructureChanged();
+        m_parent->m_library_nodes->moveForward( *m_parent );
+        m_parent->m_library_nodes->dataBase()->moveForward( *m_parent );
         m_parent = NULL;
     }
 
@@ -93,7 +96,15 @@ Node::setParent( Node* parent )
     if( parent != NULL ) {
         m_parent = parent;
         m_parent->m_children.push_back( this );
+        m_parent->touchStructureChanged();
+        m_parent->m_library_nodes->moveForward( *m_parent );
+        m_parent->m_library_nodes->dataBase()->moveForward( *m_parent );
     }
+
+    // Both parents have changed children, and this node has changed place.
+    touchStructureChanged();
+    m_library_nodes->moveForward( *this );
+    m_library_nodes->dataBase()->moveForward( *this );
     return true;
 }
 
@@ -156,7 +167,7 @@ Node::transformAdd( const std::string& sid )
     if( !sid.empty() ) {
         size_t ix = transformIndexBySid(sid);
         if( ix != ~0u ) {
-            Logger log = getLogger( package + ".transformAdd" );
+            static const Logger log = getLogger( package + ".transformAdd" );
             SCENELOG_WARN( log, "SID '" << sid << "' is already present in node, returing existing." );
             return ix;
         }
@@ -186,7 +197,7 @@ Node::transformSetTranslate( size_t ix, float x, float y, float z )
         m_library_nodes->dataBase()->moveForward( *this );
     }
     else {
-        Logger log = getLogger( package + ".transformSetTranslate" );
+        static const Logger log = getLogger( package + ".transformSetTranslate" );
         SCENELOG_ERROR( log, "Illegal transform index " << ix );
     }
 }
@@ -205,7 +216,7 @@ Node::transformSetRotate( size_t ix,
         m_library_nodes->dataBase()->moveForward( *this );
     }
     else {
-        Logger log = getLogger( package + ".transformSetRotate" );
+        static const Logger log = getLogger( package + ".transformSetRotate" );
         SCENELOG_ERROR( log, "Illegal transform index " << ix );
     }
 }
@@ -213,7 +224,7 @@ Node::transformSetRotate( size_t ix,
 void
 Node::transformSetMatrix( size_t ix, const Value& matrix )
 {
-    Logger log = getLogger( package + ".transformSetRotate" );
+    static const Logger log = getLogger( package + ".transformSetRotate" );
     if( matrix.type() != VALUE_TYPE_FLOAT4X4 ) {
         SCENELOG_ERROR( log, "argument is not of type float4x4." );
     }
@@ -245,7 +256,7 @@ Node::transformSetScale( size_t ix, float x, float y, float z )
         m_library_nodes->dataBase()->moveForward( *this );
     }
     else {
-        Logger log = getLogger( package + ".transformSetScale" );
+        static const Logger log = getLogger( package + ".transformSetScale" );
         SCENELOG_ERROR( log, "Illegal transform index " << ix );
     }
 }
@@ -268,7 +279,7 @@ Node::transformSetLookAt( size_t ix,
         m_library_nodes->dataBase()->moveForward( *this );
     }
     else {
-        Logger log = getLogger( package + ".transformSetLookAt" );
+        static const Logger log = getLogger( package + ".transformSetLookAt" );
         SCENELOG_ERROR( log, "Illegal transform index " << ix );
     }
 }
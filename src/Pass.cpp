@@ -59,7 +59,7 @@ Pass::setPrimitiveOverride( PrimitiveType  source_type,
                             unsigned int   count_num,
                             unsigned int   count_den )
 {
-    Logger log = getLogger( "Scene.Pass.setPrimitiveOverride" );
+    static const Logger log = getLogger( "Scene.Pass.setPrimitiveOverride" );
     if( source_type >= PRIMITIVE_N ) {
         SCENELOG_ERROR( log, "Illegal source primitive type." );
         return;
@@ -73,7 +73,7 @@ Pass::setPrimitiveOverride( PrimitiveType  source_type,
 const bool
 Pass::primitiveOverride( PrimitiveType source_type ) const
 {
-    Logger log = getLogger( "Scene.Pass.primitiveOverride" );
+    static const Logger log = getLogger( "Scene.Pass.primitiveOverride" );
     if( source_type >= PRIMITIVE_N ) {
         SCENELOG_ERROR( log, "Illegal source primitive type." );
         return false;
@@ -84,7 +84,7 @@ Pass::primitiveOverride( PrimitiveType source_type ) const
 const PrimitiveType
 Pass::primitiveOverrideType( PrimitiveType source_type ) const
 {
-    Logger log = getLogger( "Scene.Pass.primitiveOverrideType" );
+    static const Logger log = getLogger( "Scene.Pass.primitiveOverrideType" );
     if( source_type >= PRIMITIVE_N ) {
         SCENELOG_ERROR( log, "Illegal source primitive type." );
         return PRIMITIVE_N;
@@ -95,7 +95,7 @@ Pass::primitiveOverrideType( PrimitiveType source_type ) const
 const unsigned int
 Pass::primitiveOverrideVertices( PrimitiveType source_type ) const
 {
-    Logger log = getLogger( "Scene.Pass.primitiveOverrideVertices" );
+    static const Logger log = getLogger( "Scene.Pass.primitiveOverrideVertices" );
     if( source_type >= PRIMITIVE_N ) {
         SCENELOG_ERROR( log, "Illegal source primitive type." );
         return 0;
@@ -106,7 +106,7 @@ Pass::primitiveOverrideVertices( PrimitiveType source_type ) const
 const unsigned int
 Pass::primitiveOverrideCountNum( PrimitiveType source_type ) const
 {
-    Logger log = getLogger( "Scene.Pass.primitiveOverrideCountNum" );
+    static const Logger log = getLogger( "Scene.Pass.primitiveOverrideCountNum" );
     if( source_type >= PRIMITIVE_N ) {
         SCENELOG_ERROR( log, "Illegal source primitive type." );
         return 0;
@@ -117,7 +117,7 @@ Pass::primitiveOverrideCountNum( PrimitiveType source_type ) const
 const unsigned int
 Pass::primitiveOverrideCountDen( PrimitiveType source_type ) const
 {
-    Logger log = getLogger( "Scene.Pass.primitiveOverrideCountDen" );
+    static const Logger log = getLogger( "Scene.Pass.primitiveOverrideCountDen" );
     if( source_type >= PRIMITIVE_N ) {
         SCENELOG_ERROR( log, "Illegal source primitive type." );
         return 0;
@@ -149,7 +149,7 @@ Pass::setShaderSource( const ShaderStage stage, const std::string& source )
     m_technique->moveForward( *this );
     m_profile->moveForward( *this );
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
@@ -183,7 +183,20 @@ Pass::setAttribute( const VertexSemantic semantic, const std::string& symbol )
     m_technique->moveForward( *this );
     m_profile->moveForward( *this );
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
+    m_db.moveForward( *this );
+}
+
+void
+Pass::setInstanceTransformSymbol( const std::string& symbol )
+{
+    m_instance_transform_symbol = symbol;
+
+    touchStructureChanged();
+    m_technique->moveForward( *this );
+    m_profile->moveForward( *this );
+    m_effect->moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
@@ -196,7 +209,7 @@ Pass::clearAttributes()
     m_technique->moveForward( *this );
     m_profile->moveForward( *this );
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
@@ -252,7 +265,7 @@ Pass::setUniform( const std::string& symbol, const std::string param_ref )
     m_technique->moveForward( *this );
     m_profile->moveForward( *this );
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
@@ -280,7 +293,7 @@ Pass::setUniform( const std::string& symbol, const Value& value )
     m_technique->moveForward( *this );
     m_profile->moveForward( *this );
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
@@ -298,7 +311,7 @@ Pass::clearUniforms()
     m_technique->moveForward( *this );
     m_profile->moveForward( *this );
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
@@ -331,7 +344,7 @@ Pass::addState( const StateType  type,
     m_technique->moveForward( *this );
     m_profile->moveForward( *this );
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
@@ -372,7 +385,7 @@ Pass::clearStates()
     m_technique->moveForward( *this );
     m_profile->moveForward( *this );
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
@@ -386,7 +399,7 @@ Pass::addRenderTarget( RenderTarget        target,
                        size_t              slice,
                        size_t              mip )
 {
-    Logger log = getLogger( "Scene.Pass.addRenderTarget" );
+    static const Logger log = getLogger( "Scene.Pass.addRenderTarget" );
     if( image_ref.empty() && param_ref.empty() ) {
         SCENELOG_ERROR( log, "Neither image or param ref is set, ignoring." );
         return;
@@ -418,7 +431,7 @@ Pass::addRenderTarget( RenderTarget        target,
     m_technique->moveForward( *this );
     m_profile->moveForward( *this );
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
@@ -427,7 +440,7 @@ Pass::setRenderTargetClear( RenderTarget target,
                             size_t       index,
                             bool         clear )
 {
-    Logger log = getLogger( "Scene.Pass.setRenderTargetClear" );
+    static const Logger log = getLogger( "Scene.Pass.setRenderTargetClear" );
     for( size_t i=0; i<m_render_targets.size(); i++ ) {
         if( (m_render_targets[i].m_target == target ) &&
             (m_render_targets[i].m_index == index ) )
@@ -437,7 +450,7 @@ Pass::setRenderTargetClear( RenderTarget target,
             m_technique->moveForward( *this );
             m_profile->moveForward( *this );
             m_effect->moveForward( *this );
-            m_db.library<Effect>().moveForward( *this );
+            m_db.library<Effect>().moveForward( *m_effect );
             m_db.moveForward( *this );
             return;
         }
@@ -453,7 +466,7 @@ Pass::setDraw( Draw draw )
     m_technique->moveForward( *this );
     m_profile->moveForward( *this );
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
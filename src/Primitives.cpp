@@ -127,7 +127,7 @@ Primitives::setSharedVertexSource( const unsigned int   index_offset,
 const std::string
 Primitives::key() const
 {
-    Logger log = getLogger( "Scene.Primitives.key" );
+    static const Logger log = getLogger( "Scene.Primitives.key" );
 
     if( m_geometry == NULL ) {
         SCENELOG_FATAL( log, "invoked on primitives that are not associated a geoemtry!" );
@@ -78,7 +78,7 @@ Profile::key() const
 Technique*
 Profile::createTechnique( const std::string sid )
 {
-    Logger log = getLogger( "Scene.Profile.createTechnique" );
+    static const Logger log = getLogger( "Scene.Profile.createTechnique" );
     if( sid.empty() ) {
         SCENELOG_ERROR( log, "non-empty sid required." );
         return NULL;
@@ -114,7 +114,7 @@ Profile::deleteTechnique( const std::string& sid )
 const Technique*
 Profile::technique( const std::string& sid ) const
 {
-    Logger log = getLogger( "Scene.Profile.technique" );
+    static const Logger log = getLogger( "Scene.Profile.technique" );
 
     if( m_techniques.empty() ) {
         SCENELOG_ERROR( log, "No techniques specified for profile '"<< m_id << '\'' );
@@ -139,7 +139,7 @@ Profile::technique( const std::string& sid ) const
 Technique*
 Profile::technique( const std::string& sid )
 {
-    Logger log = getLogger( "Scene.Profile.technique" );
+    static const Logger log = getLogger( "Scene.Profile.technique" );
 
     if( m_techniques.empty() ) {
         SCENELOG_ERROR( log, "No techniques specified for profile '"<< m_id << '\'' );
@@ -164,7 +164,7 @@ Profile::technique( const std::string& sid )
 void
 Profile::addParameter( const Parameter& p )
 {
-    Logger log = getLogger( "Scene.Profile.addParameter" );
+    static const Logger log = getLogger( "Scene.Profile.addParameter" );
     m_parameters.push_back( new Parameter(p) );
 
     SCENELOG_DEBUG( log, "Adding parameter " <<
@@ -174,7 +174,7 @@ Profile::addParameter( const Parameter& p )
 
     touchStructureChanged();
     m_effect->moveForward( *this );
-    m_db.library<Effect>().moveForward( *this );
+    m_db.library<Effect>().moveForward( *m_effect );
     m_db.moveForward( *this );
 }
 
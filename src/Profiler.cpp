@@ -0,0 +1,216 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <algorithm>
+#include "scene/Profiler.hpp"
+#include "scene/Log.hpp"
+
+namespace Scene {
+    using std::string;
+
+static const string package = "Scene.Profiler";
+
+namespace {
+
+void
+writeJSONString( std::ostream& out, const string& str )
+{
+    out << '"';
+    for( size_t i=0; i<str.size(); i++ ) {
+        const char c = str[i];
+        if( c == '"' || c == '\\' ) {
+            out << '\\' << c;
+        }
+        else if( static_cast<unsigned char>( c ) < 0x20 ) {
+            out << ' ';
+        }
+        else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+} // of anonymous namespace
+
+std::atomic<bool> Profiler::m_enabled( false );
+
+Profiler&
+Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : m_epoch( Clock::now() ),
+      m_event_limit( 1u<<20 ),
+      m_dropped( 0 )
+{
+}
+
+void
+Profiler::setEventLimit( size_t limit )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_event_limit = limit;
+}
+
+void
+Profiler::addEvent( const char* name, Clock::time_point begin, Clock::time_point end )
+{
+    typedef std::chrono::duration<double,std::micro> Micro;
+
+    Event event;
+    event.m_name = name;
+    event.m_begin = Micro( begin - m_epoch ).count();
+    event.m_duration = Micro( end - begin ).count();
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if( m_events.size() >= m_event_limit ) {
+        m_dropped++;
+        return;
+    }
+    auto it = m_threads.find( std::this_thread::get_id() );
+    if( it == m_threads.end() ) {
+        const unsigned int index = static_cast<unsigned int>( m_threads.size() );
+        it = m_threads.insert( std::make_pair( std::this_thread::get_id(), index ) ).first;
+    }
+    event.m_thread = it->second;
+    m_events.push_back( event );
+}
+
+Profiler::Counter*
+Profiler::counter( const string& name )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    std::unique_ptr<Counter>& counter = m_counters[ name ];
+    if( !counter ) {
+        counter.reset( new Counter );
+    }
+    return counter.get();
+}
+
+long long
+Profiler::counterValue( const string& name ) const
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    auto it = m_counters.find( name );
+    return it != m_counters.end() ? it->second->value() : 0;
+}
+
+std::map<string,long long>
+Profiler::counters() const
+{
+    std::map<string,long long> values;
+    std::unique_lock<std::mutex> lock( m_mutex );
+    for( auto it=m_counters.begin(); it!=m_counters.end(); ++it ) {
+        values[ it->first ] = it->second->value();
+    }
+    return values;
+}
+
+std::vector<Profiler::Event>
+Profiler::events() const
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_events;
+}
+
+std::map<string,Profiler::Timing>
+Profiler::timings() const
+{
+    std::map<string,Timing> timings;
+    std::unique_lock<std::mutex> lock( m_mutex );
+    for( auto it=m_events.begin(); it!=m_events.end(); ++it ) {
+        auto jt = timings.find( it->m_name );
+        if( jt == timings.end() ) {
+            Timing timing;
+            timing.m_calls = 0;
+            timing.m_total = 0.0;
+            timing.m_max = 0.0;
+            jt = timings.insert( std::make_pair( string( it->m_name ), timing ) ).first;
+        }
+        jt->second.m_calls++;
+        jt->second.m_total += it->m_duration;
+        jt->second.m_max = std::max( jt->second.m_max, it->m_duration );
+    }
+    return timings;
+}
+
+size_t
+Profiler::droppedEvents() const
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_dropped;
+}
+
+void
+Profiler::clear()
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    m_events.clear();
+    m_dropped = 0;
+    for( auto it=m_counters.begin(); it!=m_counters.end(); ++it ) {
+        it->second->m_value.store( 0, std::memory_order_relaxed );
+    }
+}
+
+void
+Profiler::writeChromeTrace( std::ostream& out ) const
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    double end = 0.0;
+    out << "{\"traceEvents\":[";
+    for( size_t i=0; i<m_events.size(); i++ ) {
+        const Event& e = m_events[i];
+        out << (i==0 ? "\n" : ",\n") << "{\"name\":";
+        writeJSONString( out, e.m_name );
+        out << ",\"cat\":\"scene\",\"ph\":\"X\",\"pid\":0"
+            << ",\"tid\":" << e.m_thread
+            << ",\"ts\":" << e.m_begin
+            << ",\"dur\":" << e.m_duration << "}";
+        end = std::max( end, e.m_begin + e.m_duration );
+    }
+    // Counters as a single sample at the end of the trace.
+    for( auto it=m_counters.begin(); it!=m_counters.end(); ++it ) {
+        out << (m_events.empty() && it==m_counters.begin() ? "\n" : ",\n") << "{\"name\":";
+        writeJSONString( out, it->first );
+        out << ",\"cat\":\"scene\",\"ph\":\"C\",\"pid\":0,\"tid\":0"
+            << ",\"ts\":" << end
+            << ",\"args\":{\"value\":" << it->second->value() << "}}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << m_dropped << "}}\n";
+}
+
+bool
+Profiler::writeChromeTrace( const string& path ) const
+{
+    static const Logger log = getLogger( package + ".writeChromeTrace" );
+    std::ofstream out( path.c_str() );
+    if( !out ) {
+        SCENELOG_ERROR( log, "Failed to open '" << path << "' for writing." );
+        return false;
+    }
+    writeChromeTrace( out );
+    return out.good();
+}
+
+} // of namespace Scene
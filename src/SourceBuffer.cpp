@@ -34,7 +34,8 @@ SourceBuffer::SourceBuffer( DataBase& db, const std::string& id )
 : m_db( db ),
   m_id( id ),
   m_element_size( 0u ),
-  m_element_count( 0u )
+  m_element_count( 0u ),
+  m_external_data( NULL )
 {
 
 }
@@ -43,7 +44,8 @@ SourceBuffer::SourceBuffer( Library<SourceBuffer>* library_source_buffers, const
     : m_db( *library_source_buffers->dataBase() ),
       m_id( id ),
       m_element_size( 0u ),
-      m_element_count( 0u )
+      m_element_count( 0u ),
+      m_external_data( NULL )
 {
 }
 
@@ -51,22 +53,22 @@ const int*
 SourceBuffer::intData() const
 {
     if( m_element_type != ELEMENT_INT ) {
-        Logger log = getLogger( "Scene.SourceBuffer.intData" );
+        static const Logger log = getLogger( "Scene.SourceBuffer.intData" );
         SCENELOG_FATAL( log, "Wrong element type." );
         return NULL;
     }
-    return reinterpret_cast<const int*>( &m_host_data[0] );
+    return reinterpret_cast<const int*>( voidData() );
 }
 
 const float*
 SourceBuffer::floatData() const
 {
     if( m_element_type != ELEMENT_FLOAT ) {
-        Logger log = getLogger( "Scene.SourceBuffer.floatData" );
+        static const Logger log = getLogger( "Scene.SourceBuffer.floatData" );
         SCENELOG_FATAL( log, "Wrong element type." );
         return NULL;
     }
-    return reinterpret_cast<const float*>( &m_host_data[0] );
+    return reinterpret_cast<const float*>( voidData() );
 }
 
 
@@ -79,14 +81,16 @@ SourceBuffer::contents( const std::vector<int>& data )
     m_element_size = sizeof(int);
     m_element_count = data.size();
     m_host_data.resize( m_element_size*m_element_count );
+    m_external_data = NULL;
+    m_external_owner.reset();
     memcpy( m_host_data.data(), data.data(), m_host_data.size() );
 
-    structureChanged();
+    touchStructureChanged();
     m_db.library<SourceBuffer>().moveForward( *this );
     m_db.moveForward( *this );
 
 
-    Logger log = getLogger( "Scene.SourceBuffer.contents" );
+    static const Logger log = getLogger( "Scene.SourceBuffer.contents" );
     SCENELOG_TRACE( log,
                     "id=" << m_id <<
                     ", etyp=" << m_element_type <<
@@ -104,13 +108,15 @@ SourceBuffer::contents( const std::vector<float>& data )
     m_element_size = sizeof(float);
     m_element_count = data.size();
     m_host_data.resize( m_element_size*m_element_count );
+    m_external_data = NULL;
+    m_external_owner.reset();
     memcpy( &m_host_data[0], &data[0], m_host_data.size() );
 
-    structureChanged();
+    touchStructureChanged();
     m_db.library<SourceBuffer>().moveForward( *this );
     m_db.moveForward( *this );
 
-    Logger log = getLogger( "Scene.SourceBuffer.contents" );
+    static const Logger log = getLogger( "Scene.SourceBuffer.contents" );
     SCENELOG_TRACE( log,
                     "id=" << m_id <<
                     ", etyp=" << m_element_type <<
@@ -120,6 +126,56 @@ SourceBuffer::contents( const std::vector<float>& data )
 
 }
 
+float*
+SourceBuffer::floatContents( size_t count )
+{
+    m_element_type = ELEMENT_FLOAT;
+    m_element_size = sizeof(float);
+    m_element_count = count;
+    m_host_data.resize( m_element_size*m_element_count );
+    m_external_data = NULL;
+    m_external_owner.reset();
+
+    touchStructureChanged();
+    m_db.library<SourceBuffer>().moveForward( *this );
+    m_db.moveForward( *this );
+    return reinterpret_cast<float*>( m_host_data.data() );
+}
+
+int*
+SourceBuffer::intContents( size_t count )
+{
+    m_element_type = ELEMENT_INT;
+    m_element_size = sizeof(int);
+    m_element_count = count;
+    m_host_data.resize( m_element_size*m_element_count );
+    m_external_data = NULL;
+    m_external_owner.reset();
+
+    touchStructureChanged();
+    m_db.library<SourceBuffer>().moveForward( *this );
+    m_db.moveForward( *this );
+    return reinterpret_cast<int*>( m_host_data.data() );
+}
+
+void
+SourceBuffer::reference( ElementType                         type,
+                         size_t                              count,
+                         const void*                         data,
+                         const std::shared_ptr<const void>&  owner )
+{
+    m_element_type = type;
+    m_element_size = type == ELEMENT_INT ? sizeof(int) : sizeof(float);
+    m_element_count = count;
+    m_host_data.clear();
+    m_host_data.shrink_to_fit();
+    m_external_data = reinterpret_cast<const unsigned char*>( data );
+    m_external_owner = owner;
+
+    touchStructureChanged();
+    m_db.library<SourceBuffer>().moveForward( *this );
+    m_db.moveForward( *this );
+}
 
 } // of namespace Scene
 
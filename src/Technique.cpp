@@ -53,7 +53,7 @@ Technique::~Technique()
 CommonShadingModel*
 Technique::createCommonShadingModel(const ShadingModelType model)
 {
-    Logger log = getLogger( package + ".createCommonShadingModel" );
+    static const Logger log = getLogger( package + ".createCommonShadingModel" );
     if( m_common_shading_model != NULL ) {
         SCENELOG_ERROR( log, "Technique already has a shading model" );
         return NULL;
@@ -73,7 +73,7 @@ Technique::createCommonShadingModel(const ShadingModelType model)
 Pass*
 Technique::createPass( const std::string& sid )
 {
-    Logger log = getLogger( "Scene.Technique.createPass" );
+    static const Logger log = getLogger( "Scene.Technique.createPass" );
 
     if( !sid.empty() ) {
         for(size_t i=0; i<m_passes.size(); i++) {
@@ -108,7 +108,7 @@ Technique::key() const
 const Pass*
 Technique::pass( const std::string& sid ) const
 {
-    Logger log = getLogger( "Scene.Technique.pass" );
+    static const Logger log = getLogger( "Scene.Technique.pass" );
     if( sid.empty() ) {
         SCENELOG_FATAL( log, "Cannot find a particular pass based on an empty sid." );
         return NULL;
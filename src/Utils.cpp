@@ -152,7 +152,7 @@ runtimeSemantic( const RuntimeSemantic semantic )
         return runtime_semantic_names[ semantic ];
     }
     else {
-        Logger log = getLogger( package + ".runtimeSemantic" );
+        static const Logger log = getLogger( package + ".runtimeSemantic" );
         SCENELOG_FATAL( log, "Illegal runtime semantic 0x" << std::hex << semantic << std::dec );
         return runtime_semantic_names[ RUNTIME_SEMANTIC_N ];
     }
@@ -176,7 +176,7 @@ runtimeSemantic( const std::string& semantic_string )
         return it->second;
     }
     else {
-        Logger log = getLogger( package + ".runtimeSemantic" );
+        static const Logger log = getLogger( package + ".runtimeSemantic" );
         SCENELOG_WARN( log, "Illegal runtime semantic name '" << semantic_string << "'." );
         return RUNTIME_SEMANTIC_N;
     }
@@ -614,7 +614,7 @@ enumString( GLenum e )
 GLenum
 parseGLenum(const std::string &text)
 {
-    Logger log = getLogger( "Scene.Util.parseGLenum" );
+    static const Logger log = getLogger( "Scene.Util.parseGLenum" );
 
     const string prefix = "Scene::Utils::GL::parseGLenum: ";
 
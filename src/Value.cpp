@@ -49,7 +49,7 @@ Value::Value( const Value& value )
 void
 Value::set( const ValueType type )
 {
-    Logger log = getLogger( "Scene.Value.set" );
+    static const Logger log = getLogger( "Scene.Value.set" );
     m_type = type;
     m_value_changed.touch();
 
@@ -344,7 +344,7 @@ Value::bools( size_t count ) const
 bool
 Value::setBools( const std::string& source, const size_t count )
 {
-    Logger log = getLogger( "Scene.Value.setBool" );
+    static const Logger log = getLogger( "Scene.Value.setBool" );
 
     m_value_changed.touch();
     size_t p=0;
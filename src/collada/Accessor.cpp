@@ -35,7 +35,7 @@ bool
 Importer::parseAccessor( Scene::Geometry::VertexInput&  input,
                         xmlNodePtr                     accessor_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseAccessor" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseAccessor" );
 
 #ifdef DEBUG
     if( !xmlStrEqual( accessor_node->name, BAD_CAST "accessor" ) )  {
@@ -33,7 +33,7 @@ Importer::parseAsset( Importer::Context& context,
                       Asset&      asset,
                       xmlNodePtr  asset_node )
 {
-        Logger log = getLogger( "Scene.XML.Builder.parseAsset" );
+        static const Logger log = getLogger( "Scene.XML.Builder.parseAsset" );
 
         xmlNodePtr n = asset_node->children;
         if( n!= NULL && xmlStrEqual( n->name, BAD_CAST "contributor" ) ) {
@@ -122,7 +122,7 @@ Importer::parseAsset( Asset&      asset,
                       xmlNodePtr  asset_node,
                       float*      scope_unit )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseAsset" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseAsset" );
 
     xmlNodePtr n = asset_node->children;
     if( n!= NULL && xmlStrEqual( n->name, BAD_CAST "contributor" ) ) {
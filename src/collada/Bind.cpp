@@ -32,7 +32,7 @@ bool
 Importer::parseBind( Bind&       bind,
                      xmlNodePtr  bind_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseBind" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseBind" );
 
     string semantic = attribute( bind_node, "semantic" );
     if( semantic == "MODELVIEW_MATRIX" ) {
@@ -35,7 +35,7 @@ bool
 Importer::parseBindMaterial( InstanceGeometry*  instgeo,
                             xmlNodePtr               bind_material_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseBindMaterial" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseBindMaterial" );
     if(!assertNode( bind_material_node, "bind_material" ) ) {
         return false;
     }
@@ -31,7 +31,7 @@ bool
 Importer::parseCamera( const Asset&  asset_parent,
                        xmlNodePtr    camera_node )
 {
-    Logger log = getLogger( "Scene.XML.parseCamera" );
+    static const Logger log = getLogger( "Scene.XML.parseCamera" );
     if( !assertNode( camera_node, "camera" ) ) {
         return false;
     }
@@ -269,7 +269,7 @@ Exporter::createCamera( Context& context, const Camera* camera ) const
 
     }
     else if( camera->cameraType() == CAMERA_CUSTOM_MATRIX ) {
-        Logger log = getLogger( "Scene.XML.Exporter.createCamera" );
+        static const Logger log = getLogger( "Scene.XML.Exporter.createCamera" );
         SCENELOG_ERROR( log, "COLLADA doesn't support cameras with custom projection matrices" );
     }
     return cam_node;
@@ -20,6 +20,7 @@
 #include <vector>
 #include <stdexcept>
 #include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
 #include "scene/DataBase.hpp"
 #include "scene/collada/Importer.hpp"
 #include "scene/collada/Exporter.hpp"
@@ -39,7 +40,8 @@ namespace Scene {
 bool
 Importer::parseCollada( xmlNodePtr collada_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseCollada" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseCollada" );
+    SCENE_PROFILE_SCOPE( "Importer::parseCollada" );
 
     Context context;
     context.m_up_axis = Context::Y_UP;
@@ -74,6 +76,10 @@ Importer::parseCollada( xmlNodePtr collada_node )
         context.m_version = Context::VERSION_1_4_X;
     }
 
+    if( m_parallel ) {
+        stageLibraries( collada_node );
+    }
+
     xmlNodePtr n = collada_node->children;
 
 
@@ -203,6 +209,8 @@ Importer::parseCollada( xmlNodePtr collada_node )
                 for( ; o != NULL; o = o->next ) {
                     if( checkNode( o, "include" ) ) {
                         Importer importer( m_database );
+                        importer.setStreaming( m_streaming );
+                        importer.setParallel( m_parallel );
                         success = success && importer.parse( resolvePath( attribute( o, "file" ) ) );
                     }
                 }
@@ -217,6 +225,7 @@ Importer::parseCollada( xmlNodePtr collada_node )
     }
 
     m_database.setAsset( collada_asset );
+    clearStaged();
 
 #ifdef USE_POSIX
     setlocale( LC_CTYPE, loc_ctype );
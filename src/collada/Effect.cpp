@@ -32,7 +32,7 @@ bool
 Importer::parseEffect( const Asset&  asset_parent,
                        xmlNodePtr    effect_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseEffect" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseEffect" );
     if(!assertNode( effect_node, "effect" ) ) {
         return false;
     }
@@ -50,7 +50,7 @@ parseCubeMapFace( const std::string& value )
         return 5;
     }
     else {
-        Logger log = getLogger( "Scene.XML.Import.parseCubeMapFace" );
+        static const Logger log = getLogger( "Scene.XML.Import.parseCubeMapFace" );
         SCENELOG_ERROR( log, "Unknown face '" << value << "'.");
         return 0;
     }
@@ -61,7 +61,7 @@ bool
 Importer::parseEvaluate( Pass*       pass,
                          xmlNodePtr  evaluate_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseEvaluate" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseEvaluate" );
 
     if(!assertNode( evaluate_node, "evaluate" ) ) {
         return false;
@@ -43,7 +43,7 @@ Exporter::create(  bool lib_geometry,
                    bool lib_visual_scene,
                    int profile_mask)
 {
-    Logger log = getLogger( "Scene.XML.Builder.create" );
+    static const Logger log = getLogger( "Scene.XML.Builder.create" );
 
     Context context;
     context.m_lib_geometry     = lib_geometry;
@@ -67,7 +67,7 @@ void
 Exporter::setBody( xmlNodePtr node, const float* values, size_t count ) const
 {
     if( values == NULL ) {
-        Logger log = getLogger( "Scene.XML.Builder.setBody" );
+        static const Logger log = getLogger( "Scene.XML.Builder.setBody" );
         SCENELOG_FATAL( log, "Got null pointer to floats." );
         return;
     }
@@ -151,7 +151,7 @@ void
 Exporter::setBody( xmlNodePtr node, const int* values, size_t count ) const
 {
     if( values == NULL ) {
-        Logger log = getLogger( "Scene.XML.Builder.setBody" );
+        static const Logger log = getLogger( "Scene.XML.Builder.setBody" );
         SCENELOG_FATAL( log, "Got null pointer to ints." );
         return;
     }
@@ -16,13 +16,12 @@
  * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <cstdlib>
 #include <cstring>
-#include <cerrno>
 #include <boost/lexical_cast.hpp>
 #include "scene/Log.hpp"
 #include "scene/DataBase.hpp"
 #include "scene/SourceBuffer.hpp"
+#include "scene/tools/NumberParser.hpp"
 #include "scene/collada/Importer.hpp"
 #include "scene/collada/Exporter.hpp"
 
@@ -38,12 +37,9 @@ bool
 Importer::parseFloatArray( Scene::SourceBuffer* source_buffer,
                           xmlNodePtr          float_array_node )
 {
-    Logger log = getLogger( ipackage + ".parseFloatArray");
+    static const Logger log = getLogger( ipackage + ".parseFloatArray" );
 
     size_t count = 0;
-    std::vector<float> data;
-    const char* a = NULL;
-    xmlChar* p = NULL;
     string count_str;
 
 #ifdef DEBUG
@@ -60,38 +56,31 @@ Importer::parseFloatArray( Scene::SourceBuffer* source_buffer,
     }
     count = boost::lexical_cast<size_t>( count_str );
 
-    data.resize( count );
-
-    p = xmlNodeGetContent( float_array_node );
-    if( p == NULL ) {
-        SCENELOG_ERROR( log, "XML node has no content." );
-        return false;
-    }
-
-    a = reinterpret_cast<const char*>( p );
-    for(size_t i=0; i<count; i++) {
-        char *b = NULL;
-        errno = 0;
-#ifdef _WIN32
-        //MSVC 10 does not support strtof yet (c++0x feature)
-        data[i] = static_cast<float>(strtod( a, &b ));
-#else
-        data[i] = strtof( a, &b );
-#endif
-        if( errno != 0 ) {
-            int myerrno = errno;
-            SCENELOG_ERROR( log, "strtoX: " << strerror( myerrno ) );
+    // Use the result of stageLibraries if present.
+    auto it = m_staged_floats.find( float_array_node );
+    if( it != m_staged_floats.end() ) {
+        const bool staged = it->second.size() == count;
+        if( staged ) {
+            std::memcpy( source_buffer->floatContents( count ), it->second.data(), sizeof(float)*count );
         }
-
-        if( a == b ) {
-            SCENELOG_ERROR( log, "Premature end of data" );
-            return false;
+        m_staged_floats.erase( it );
+        if( staged ) {
+            return true;
         }
-        a = b;
     }
-    xmlFree( p );
 
-    source_buffer->contents( data );
+    // Parse directly into the buffer storage.
+    xmlChar* copy = NULL;
+    const char* a = bodyText( copy, float_array_node );
+    float* data = source_buffer->floatContents( count );
+    const size_t parsed = Tools::parseFloats( data, count, a, a + strlen( a ) );
+    if( copy != NULL ) {
+        xmlFree( copy );
+    }
+    if( parsed != count ) {
+        SCENELOG_ERROR( log, "Premature end of data" );
+        return false;
+    }
     return true;
 }
 
@@ -99,7 +88,7 @@ xmlNodePtr
 Exporter::createFloatArray( Context& context,
                           const Scene::SourceBuffer* source_buffer ) const
 {
-    Logger log = getLogger( "Scene.XML.Builder.createFloatBuffer" );
+    static const Logger log = getLogger( "Scene.XML.Builder.createFloatBuffer" );
 
     const string id_str = source_buffer->id();
     const string count_str = lexical_cast<string>( source_buffer->elementCount() );
@@ -31,7 +31,7 @@ bool
 Importer::parseGeometry( Scene::Geometry*  geometry,
                         xmlNodePtr        geometry_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseGeometry" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseGeometry" );
     if( !assertNode( geometry_node, "geometry" ) ) {
         return false;
     }
@@ -56,7 +56,7 @@ protected:
         LibPNGUserReadWrapper* me = reinterpret_cast<LibPNGUserReadWrapper*>( png_get_io_ptr( png_ptr ) );
 
         if( me->m_offset + length >= me->m_content.size() ) {
-            Logger log = getLogger( "Scene.XML.Import.LibPNGUserReadWrapper" );
+            static const Logger log = getLogger( "Scene.XML.Import.LibPNGUserReadWrapper" );
             SCENELOG_WARN( log, "Reading outside file contents" <<
                             ", offset=" << me->m_offset <<
                             ", length=" << length <<
@@ -84,7 +84,7 @@ readPNG( GLenum& iformat,
          vector<unsigned char>& data,
          const std::vector<char>& content )
 {
-    Logger log = getLogger( "Scene.XML.Import.readPNG" );
+    static const Logger log = getLogger( "Scene.XML.Import.readPNG" );
 
     png_structp png_ptr = png_create_read_struct( PNG_LIBPNG_VER_STRING, NULL, NULL, NULL );
     if( png_ptr == NULL ) {
@@ -222,7 +222,7 @@ Importer::parseFormat( GLenum&  iformat,
                        GLenum&  type,
                        xmlNodePtr format_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseFormat" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseFormat" );
 
     xmlNodePtr n = format_node->children;
 
@@ -352,7 +352,7 @@ Importer::parseFormat( GLenum&  iformat,
 bool
 Importer::parseSize( size_t* width, size_t* height, size_t* depth, xmlNodePtr n )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseImage.parseSize" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseImage.parseSize" );
 
     if( width != NULL ) {
         int t = atoi( attribute( n, "width" ).c_str() );
@@ -386,7 +386,7 @@ Importer::parseSize( size_t* width, size_t* height, size_t* depth, xmlNodePtr n
 bool
 Importer::parseArray( size_t& array_length, xmlNodePtr array_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseImage.parseArray" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseImage.parseArray" );
 
     const string length_str = attribute( array_node, "length" );
     if( length_str.empty() ) {
@@ -406,7 +406,7 @@ Importer::parseArray( size_t& array_length, xmlNodePtr array_node )
 bool
 Importer::parseMips( size_t& mips, bool& auto_generate, xmlNodePtr mips_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseMips" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseMips" );
 
     const string mips_str = attribute( mips_node, "levels" );
     if( mips_str.empty() ) {
@@ -433,7 +433,7 @@ Importer::parseMips( size_t& mips, bool& auto_generate, xmlNodePtr mips_node )
 bool
 Importer::parseInitFrom( Image* image, xmlNodePtr init_from_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseInitFrom" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseInitFrom" );
 
     size_t array_index;
     const string array_index_str = attribute( init_from_node, "array_index" );
@@ -591,12 +591,60 @@ Importer::parseInitFrom( Image* image, xmlNodePtr init_from_node )
 
 
 
+bool
+Importer::initFromURL( std::string& url, xmlNodePtr init_from_node, bool quiet )
+{
+    static const Logger log = getLogger( "Scene.XML.Importer.initFromURL" );
+
+    xmlNodePtr m = init_from_node->children;
+    if( m == NULL ) {
+        return false;
+    }
+    if( checkNode( m->children, "ref" ) ) {
+        url = getBody( m->children );
+    }
+    else if( checkNode( m->children, "hex" ) ) {
+        if( !quiet ) {
+            SCENELOG_ERROR( log, "init_from/hex not implemented");
+        }
+        return false;
+    }
+    else {
+        std::string body = getBody( m );
+        if( !body.empty() ) {
+            if( !quiet ) {
+                SCENELOG_WARN( log, "COLLADA 1.4-ism: no init_from/(ref|hex) child, assuming body is ref" );
+            }
+            url = body;
+        }
+    }
+    return true;
+}
+
+void
+Importer::decodeImage( StagedImage& image, const std::string& url )
+{
+    vector<char> contents;
+    image.m_retrieved = retrieveBinaryFile( contents, url );
+    image.m_decoded = false;
+    if( image.m_retrieved && url.length() > 4 && url.substr(url.length()-4) == ".png" ) {
+        image.m_decoded = readPNG( image.m_iformat,
+                                   image.m_format,
+                                   image.m_type,
+                                   image.m_width,
+                                   image.m_height,
+                                   image.m_data,
+                                   contents );
+    }
+}
+
+
 bool
 Importer::parseImage2( Context      context,
                        const Asset& asset_parent,
                        xmlNodePtr image_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseImage" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseImage" );
     if( !assertNode( image_node, "image" ) ) {
         return false;
     }
@@ -1078,7 +1126,7 @@ Importer::parseImage( Context      context,
     
     
     
-    Logger log = getLogger( "Scene.XML.Importer.parseImage" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseImage" );
     if( !assertNode( image_node, "image" ) ) {
         return false;
     }
@@ -1123,43 +1171,36 @@ Importer::parseImage( Context      context,
         bool auto_generate = parseBool( attribute( m, "mips_generate"), true );
 
         std::string URL;
-        if( checkNode( m->children, "ref" ) ) {
-            URL = getBody( m->children );
-        }
-        else if( checkNode( m->children, "hex" ) ) {
-            SCENELOG_ERROR( log, "init_from/hex not implemented");
+        if( !initFromURL( URL, n, false ) ) {
             return false;
         }
+
+        // read file, or pick up the result of stageLibraries
+        StagedImage staged;
+        auto it = m_staged_images.find( n );
+        if( it != m_staged_images.end() ) {
+            staged = std::move( it->second );
+            m_staged_images.erase( it );
+        }
         else {
-            std::string body = getBody( m );
-            if( !body.empty() ) {
-                SCENELOG_WARN( log, "COLLADA 1.4-ism: no init_from/(ref|hex) child, assuming body is ref" );
-                URL = body;
-            }
+            decodeImage( staged, URL );
         }
-
-        // read file
-        vector<char> contents;
-        if( !retrieveBinaryFile( contents, URL ) ) {
+        if( !staged.m_retrieved ) {
             SCENELOG_ERROR( log, "Failed to get '" << URL << '\'' );
             return false;
         }
 
         if( URL.length() > 4 && URL.substr(URL.length()-4) == ".png" ) {
-            GLenum iformat, format, type;
-            unsigned int width, height;
-
-            std::vector<unsigned char> data;
-            if(readPNG( iformat, format, type, width, height, data, contents )) {
-                image->init2D( iformat,
-                               format,
-                               type,
-                               (size_t)width,
-                               (size_t)height,
+            if( staged.m_decoded ) {
+                image->init2D( staged.m_iformat,
+                               staged.m_format,
+                               staged.m_type,
+                               (size_t)staged.m_width,
+                               (size_t)staged.m_height,
                                1,
                                auto_generate ? 0 : 1,
                                auto_generate );
-                image->set( 0, 0, &data[0] );
+                image->set( 0, 0, &staged.m_data[0] );
             }
             else {
                 SCENELOG_ERROR( log, "Failed to parse PNG  '" << URL << '\'' );
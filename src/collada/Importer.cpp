@@ -19,8 +19,11 @@
 #include <fstream>
 #include <cstring>
 #include <boost/lexical_cast.hpp>
+#include <libxml/xmlreader.h>
 #include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
 #include "scene/DataBase.hpp"
+#include "scene/tools/NumberParser.hpp"
 #include "scene/collada/Importer.hpp"
 #include "scene/collada/Exporter.hpp"
 
@@ -34,7 +37,9 @@ namespace Scene {
 
 Importer::Importer( Scene::DataBase& database, const std::string base_path )
 : m_database( database ),
-  m_base_path( base_path )
+  m_base_path( base_path ),
+  m_streaming( false ),
+  m_parallel( false )
 {
 }
 
@@ -131,7 +136,7 @@ Importer::strEq( const xmlChar* str1, const std::string& str2)
 const std::string
 Importer::resolvePath( const std::string url )
 {
-    Logger log = getLogger( "Scene.XML.Importer.resolvePath" );
+    static const Logger log = getLogger( "Scene.XML.Importer.resolvePath" );
     std::string protocol;
     std::string resource;
     size_t ix = url.find( "://" );
@@ -170,7 +175,7 @@ Importer::resolvePath( const std::string url )
 bool
 Importer::retrieveTextFile( std::string& result, const std::string& url )
 {
-    Logger log = getLogger( "Scene.XML.Importer.retrieveTextFile" );
+    static const Logger log = getLogger( "Scene.XML.Importer.retrieveTextFile" );
     std::string path = resolvePath( url );
     if( path.empty() ) {
         return false;
@@ -190,7 +195,7 @@ Importer::retrieveTextFile( std::string& result, const std::string& url )
 bool
 Importer::retrieveBinaryFile( std::vector<char>& result, const std::string& url )
 {
-    Logger log = getLogger( "Scene.XML.Importer.retrieveBinaryFile" );
+    static const Logger log = getLogger( "Scene.XML.Importer.retrieveBinaryFile" );
     std::string path = resolvePath( url );
     if( path.empty() ) {
         return false;
@@ -222,96 +227,79 @@ Importer::getBody( xmlNodePtr node )
 }
 
 
+const char*
+Importer::bodyText( xmlChar*& copy, xmlNodePtr node )
+{
+    copy = NULL;
+    xmlNodePtr c = node->children;
+    if( c == NULL ) {
+        return "";
+    }
+    if( (c->next == NULL) &&
+        ( (c->type == XML_TEXT_NODE) || (c->type == XML_CDATA_SECTION_NODE) ) &&
+        (c->content != NULL) )
+    {
+        return reinterpret_cast<const char*>( c->content );
+    }
+    copy = xmlNodeGetContent( node );
+    return copy != NULL ? reinterpret_cast<const char*>( copy ) : "";
+}
+
 bool
 Importer::parseBodyAsFloats( std::vector<float>& result, xmlNodePtr node, size_t expected )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseBodyAsFloats" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseBodyAsFloats" );
     if( expected == 0 ) {
         return true;
     }
 
-    xmlChar* p = xmlNodeGetContent( node );
-    if( p == NULL ) {
-        SCENELOG_ERROR( log, "No node contents." );
-        return false;
-    }
+    xmlChar* copy = NULL;
+    const char* a = bodyText( copy, node );
 
     result.resize( expected );
-    const char* a = reinterpret_cast<const char*>( p );
-    for(size_t i=0; i<expected; i++) {
-        char *b = NULL;
-#ifdef _WIN32
-        //MSVC 10 does not support strtof yet (c++0x feature)
-        result[i] = static_cast<float>(strtod( a, &b ));
-#else
-        result[i] = strtof( a, &b );
-#endif
-        if( a == b ) {
-            SCENELOG_ERROR( log, "Premature end of content." );
-            xmlFree( p );
-            return false;
-        }
-        a = b;
+    bool success = Tools::parseFloats( result.data(), expected, a, a + strlen( a ) ) == expected;
+    if( !success ) {
+        SCENELOG_ERROR( log, "Premature end of content." );
     }
-
-    xmlFree( p );
-    return true;
+    if( copy != NULL ) {
+        xmlFree( copy );
+    }
+    return success;
 }
 
 bool
 Importer::parseBodyAsInts( std::vector<int>& result, xmlNodePtr node, size_t expected, size_t offset, size_t stride )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseBodyAsInts" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseBodyAsInts" );
     if( expected == 0 ) {
         return true;
     }
 
-    xmlChar* p = xmlNodeGetContent( node );
-    if( p == NULL ) {
-        SCENELOG_ERROR( log, "No node contents." );
-        return false;
-    }
-
-    result.resize( expected );
-
-    const char* a = reinterpret_cast<const char*>( p );
-
-    // dummy variable to avoid getting warn_unused_result warnings
-    int ignored_value;
-
-    // eat offset
-    bool success = true;
-    for(size_t i=0; i<offset && success; i++) {
-        char* b = NULL;
-        ignored_value = strtol( a, &b, 0 );
-        if( a == b ) {
-            success = false;
+    // Use the result of stageLibraries if present.
+    auto it = m_staged_ints.find( node );
+    if( it != m_staged_ints.end() ) {
+        const bool staged = (offset == 0) && (stride == 1) && (it->second.size() >= expected);
+        if( staged ) {
+            it->second.resize( expected );
+            result.swap( it->second );
         }
-        a = b;
-    }
-
-    for(size_t i=0; i<expected && success; i++) {
-        char* b = NULL;
-        result[i] = strtol( a, &b, 0 );
-        if( a == b ) {
-            success = false;
-        }
-        a = b;
-
-        // eat rest of stride
-        for(size_t k=1; k<stride && success; k++) {
-            char* b = NULL;
-            ignored_value = strtol( a, &b, 0 );
-            if( a == b ) {
-                success = false;
-            }
-            a = b;
+        m_staged_ints.erase( it );
+        if( staged ) {
+            return true;
         }
     }
+
+    xmlChar* copy = NULL;
+    const char* a = bodyText( copy, node );
+
+    result.resize( expected );
+    bool success = Tools::parseInts( result.data(), expected, a, a + strlen( a ), offset, stride ) == expected;
     if(!success) {
         SCENELOG_ERROR( log, "Premature end of node contents" );
     }
-    xmlFree( p );
+    if( copy != NULL ) {
+        xmlFree( copy );
+    }
     return success;
 }
 
@@ -328,7 +316,7 @@ Importer::parseBool( const std::string value, bool default_value )
         return false;
     }
     else {
-        Logger log = getLogger( "Scene.XML.Importer.parseBool" );
+        static const Logger log = getLogger( "Scene.XML.Importer.parseBool" );
         SCENELOG_ERROR( log, "Failed to parse bool '" << value << "'." );
         return default_value;
     }
@@ -351,7 +339,7 @@ Importer::assertNode( xmlNodePtr node, const std::string& name )
         return true;
     }
     else {
-        Logger log = getLogger( "Scene.XML.Builder.assertNode" );
+        static const Logger log = getLogger( "Scene.XML.Builder.assertNode" );
         SCENELOG_FATAL( log, "Expected '" << name << "', got '" <<
                        reinterpret_cast<const char*>( node->name) << "'." );
         return false;
@@ -361,7 +349,7 @@ Importer::assertNode( xmlNodePtr node, const std::string& name )
 bool
 Importer::assertChild( xmlNodePtr parent, xmlNodePtr child, const std::string& name )
 {
-    Logger log = getLogger( "Scene.XML.Importer.assertChild" );
+    static const Logger log = getLogger( "Scene.XML.Importer.assertChild" );
     if( child == NULL ) {
         SCENELOG_ERROR( log, "Premature end of <"<<
                         reinterpret_cast<const char*>( parent->name ) <<
@@ -383,7 +371,7 @@ Importer::assertChild( xmlNodePtr parent, xmlNodePtr child, const std::string& n
 void
 Importer::skipNode( xmlNodePtr parent, xmlNodePtr& n, const std::string& name )
 {
-    Logger log = getLogger( "Scene.XML.Importer.skipNodes" );
+    static const Logger log = getLogger( "Scene.XML.Importer.skipNodes" );
 
     if( n!=NULL && xmlStrEqual( n->name, BAD_CAST name.c_str() ) ) {
         SCENELOG_DEBUG( log, "In <" <<
@@ -400,7 +388,7 @@ Importer::skipNode( xmlNodePtr parent, xmlNodePtr& n, const std::string& name )
 void
 Importer::skipNodes( xmlNodePtr parent, xmlNodePtr& n, const std::string& name )
 {
-    Logger log = getLogger( "Scene.XML.Importer.skipNodes" );
+    static const Logger log = getLogger( "Scene.XML.Importer.skipNodes" );
 
     while( n!=NULL && xmlStrEqual( n->name, BAD_CAST name.c_str() ) ) {
         SCENELOG_DEBUG( log, "In <" <<
@@ -460,7 +448,7 @@ Importer::nagAboutRemainingNodes( Logger log, xmlNodePtr& n )
 void
 Importer::clean( xmlNodePtr xml_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.clean" );
+    static const Logger log = getLogger( "Scene.XML.Importer.clean" );
     if( xml_node == NULL ) {
         SCENELOG_ERROR( log, "xml_node==NULL" );
         return;
@@ -504,7 +492,8 @@ Importer::clean( xmlNodePtr xml_node )
 bool
 Importer::parseMemory( const char* buffer )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseBuffer" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseBuffer" );
+    SCENE_PROFILE_SCOPE( "Importer::parseMemory" );
 
     xmlDocPtr doc = xmlReadMemory( buffer, strlen( buffer), NULL, NULL, XML_PARSE_NOBLANKS | XML_PARSE_HUGE );
     if( doc == NULL ) {
@@ -524,21 +513,37 @@ Importer::parseMemory( const char* buffer )
 bool
 Importer::parse( const std::string &url )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parse" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parse" );
+    SCENE_PROFILE_SCOPE( "Importer::parse" );
 
     std::string path = resolvePath( url );
     SCENELOG_INFO( log, "Processing '" << path << "'." );
-    xmlDocPtr doc = xmlReadFile( path.c_str(), NULL, XML_PARSE_NOBLANKS | XML_PARSE_HUGE  );
+#ifdef _WIN32
+    const int sep = '\\';
+#else
+    const int sep = '/';
+#endif
+    if( m_streaming ) {
+        std::string outer = m_base_path;
+        size_t ix = path.find_last_of( sep );
+        if( ix != std::string::npos ) {
+            m_base_path = path.substr( 0, ix );
+        }
+        bool success = parseStreaming( path );
+        m_base_path = outer;
+        return success;
+    }
+
+    xmlDocPtr doc = NULL;
+    {
+        SCENE_PROFILE_SCOPE( "Importer::parse xml" );
+        doc = xmlReadFile( path.c_str(), NULL, XML_PARSE_NOBLANKS | XML_PARSE_HUGE  );
+    }
     if( doc == NULL ) {
         SCENELOG_ERROR( log, "libxml failed to parse '" << url << "'." );
         return false;
     }
     else {
-#ifdef _WIN32
-        const int sep = '\\';
-#else
-        const int sep = '/';
-#endif
         std::string outer = m_base_path;
         size_t ix = path.find_last_of( sep );
         if( ix != std::string::npos ) {
@@ -553,6 +558,167 @@ Importer::parse( const std::string &url )
     }
 }
 
+// Creates a childless copy of the reader's current element.
+static xmlNodePtr
+readerShell( xmlTextReaderPtr reader )
+{
+    xmlNodePtr shell = xmlNewNode( NULL, xmlTextReaderConstName( reader ) );
+    while( xmlTextReaderMoveToNextAttribute( reader ) == 1 ) {
+        xmlNewProp( shell,
+                    xmlTextReaderConstName( reader ),
+                    xmlTextReaderConstValue( reader ) );
+    }
+    xmlTextReaderMoveToElement( reader );
+    return shell;
+}
+
+bool
+Importer::parseStreamedItem( xmlNodePtr collada,
+                             xmlNodePtr asset,
+                             xmlNodePtr library,
+                             xmlNodePtr library_asset,
+                             xmlNodePtr item )
+{
+    xmlDocPtr doc = xmlNewDoc( BAD_CAST "1.0" );
+    xmlNodePtr root = xmlDocCopyNode( collada, doc, 2 );
+    xmlDocSetRootElement( doc, root );
+    if( asset != NULL ) {
+        xmlAddChild( root, xmlDocCopyNode( asset, doc, 1 ) );
+    }
+    xmlNodePtr parent = root;
+    if( library != NULL ) {
+        parent = xmlAddChild( root, xmlDocCopyNode( library, doc, 2 ) );
+        if( library_asset != NULL ) {
+            xmlAddChild( parent, xmlDocCopyNode( library_asset, doc, 1 ) );
+        }
+    }
+    if( item != NULL ) {
+        xmlAddChild( parent, xmlDocCopyNode( item, doc, 1 ) );
+    }
+    clean( root );
+    bool success = parseCollada( root );
+    xmlFreeDoc( doc );
+    return success;
+}
+
+bool
+Importer::parseStreaming( const std::string& path )
+{
+    static const Logger log = getLogger( "Scene.XML.Importer.parseStreaming" );
+    SCENE_PROFILE_SCOPE( "Importer::parseStreaming" );
+
+    xmlTextReaderPtr reader = xmlReaderForFile( path.c_str(), NULL, XML_PARSE_NOBLANKS | XML_PARSE_HUGE );
+    if( reader == NULL ) {
+        SCENELOG_ERROR( log, "libxml failed to open '" << path << "'." );
+        return false;
+    }
+
+    // Locate the root element.
+    int ret = xmlTextReaderRead( reader );
+    while( (ret == 1) && (xmlTextReaderNodeType( reader ) != XML_READER_TYPE_ELEMENT ) ) {
+        ret = xmlTextReaderRead( reader );
+    }
+    if( ret != 1 ) {
+        SCENELOG_ERROR( log, "libxml failed to parse '" << path << "'." );
+        xmlFreeTextReader( reader );
+        return false;
+    }
+
+    bool success = true;
+    xmlNodePtr collada = readerShell( reader );
+    xmlNodePtr asset = NULL;
+    bool items = false;
+
+    ret = xmlTextReaderIsEmptyElement( reader ) ? 0 : xmlTextReaderRead( reader );
+    while( (ret == 1) && (xmlTextReaderDepth( reader ) >= 1) ) {
+        if( (xmlTextReaderNodeType( reader ) != XML_READER_TYPE_ELEMENT) ||
+            (xmlTextReaderDepth( reader ) != 1 ) )
+        {
+            ret = xmlTextReaderRead( reader );
+            continue;
+        }
+        const std::string name = reinterpret_cast<const char*>( xmlTextReaderConstName( reader ) );
+
+        if( name == "asset" ) {
+            xmlNodePtr n = xmlTextReaderExpand( reader );
+            if( n != NULL ) {
+                if( asset != NULL ) {
+                    xmlFreeNode( asset );
+                }
+                asset = xmlCopyNode( n, 1 );
+            }
+            ret = xmlTextReaderNext( reader );
+        }
+        else if( name.compare( 0, 8, "library_" ) == 0 ) {
+            // Parse each child of the library separately, so that only the
+            // tree of one child is kept in memory.
+            xmlNodePtr library = readerShell( reader );
+            xmlNodePtr library_asset = NULL;
+            if( xmlTextReaderIsEmptyElement( reader ) ) {
+                success = parseStreamedItem( collada, asset, library, NULL, NULL ) && success;
+                ret = xmlTextReaderRead( reader );
+            }
+            else {
+                ret = xmlTextReaderRead( reader );
+                while( (ret == 1) && (xmlTextReaderDepth( reader ) >= 2) ) {
+                    if( (xmlTextReaderNodeType( reader ) != XML_READER_TYPE_ELEMENT) ||
+                        (xmlTextReaderDepth( reader ) != 2 ) )
+                    {
+                        ret = xmlTextReaderRead( reader );
+                        continue;
+                    }
+                    xmlNodePtr n = xmlTextReaderExpand( reader );
+                    if( n == NULL ) {
+                        ret = -1;
+                        break;
+                    }
+                    if( xmlStrEqual( n->name, BAD_CAST "asset" ) ) {
+                        if( library_asset != NULL ) {
+                            xmlFreeNode( library_asset );
+                        }
+                        library_asset = xmlCopyNode( n, 1 );
+                    }
+                    else {
+                        success = parseStreamedItem( collada, asset, library, library_asset, n ) && success;
+                    }
+                    ret = xmlTextReaderNext( reader );
+                }
+            }
+            if( library_asset != NULL ) {
+                xmlFreeNode( library_asset );
+            }
+            xmlFreeNode( library );
+            items = true;
+        }
+        else {
+            // <scene>, <extra>, and unknown elements.
+            xmlNodePtr n = xmlTextReaderExpand( reader );
+            if( n == NULL ) {
+                ret = -1;
+                break;
+            }
+            success = parseStreamedItem( collada, asset, NULL, NULL, n ) && success;
+            ret = xmlTextReaderNext( reader );
+            items = true;
+        }
+    }
+    if( ret < 0 ) {
+        SCENELOG_ERROR( log, "libxml failed to parse '" << path << "'." );
+        success = false;
+    }
+    else if( !items ) {
+        // Document without libraries, still parse the asset.
+        success = parseStreamedItem( collada, asset, NULL, NULL, NULL ) && success;
+    }
+
+    if( asset != NULL ) {
+        xmlFreeNode( asset );
+    }
+    xmlFreeNode( collada );
+    xmlFreeTextReader( reader );
+    return success;
+}
+
 
     } // of namespace Scene
 } // of namespace Scene
@@ -40,7 +40,7 @@ Importer::parseInputShared( Primitives& prim_set,
                            const unordered_map<string,Geometry::VertexInput>& inputs,
                            xmlNodePtr input_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseInputShared" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseInputShared" );
     if(!assertNode( input_node, "input" ) ) {
         return false;
     }
@@ -31,7 +31,7 @@ bool
 Importer::parseInstanceEffect( Material* material,
                                xmlNodePtr instance_effect_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseInstanceEffect" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseInstanceEffect" );
     if( !assertNode( instance_effect_node, "instance_effect" ) ) {
         return false;
     }
@@ -126,7 +126,7 @@ xmlNodePtr
 Exporter::createInstanceEffect( Context&  context,
                                 const Scene::Material*    material ) const
 {
-    Logger log = getLogger( "Scene.XML.Exporter.createInstanceEffect" );
+    static const Logger log = getLogger( "Scene.XML.Exporter.createInstanceEffect" );
 
     xmlNodePtr ie_node = newNode( NULL, "instance_effect" );
     addProperty( ie_node, "url", "#"+material->effectId() );
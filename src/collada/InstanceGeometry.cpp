@@ -34,7 +34,7 @@ bool
 Importer::parseInstanceGeometry( Node* node, xmlNodePtr instance_geometry_node )
 {
 
-    Logger log = getLogger( "Scene.XML.Importer.parseInstanceGeometry");
+    static const Logger log = getLogger( "Scene.XML.Importer.parseInstanceGeometry" );
     if( !assertNode( instance_geometry_node, "instance_geometry" ) ) {
         return false;
     }
@@ -17,6 +17,7 @@
  */
 
 #include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
 #include "scene/DataBase.hpp"
 #include "scene/collada/Importer.hpp"
 #include "scene/collada/Exporter.hpp"
@@ -29,7 +30,8 @@ bool
 Importer::parseLibraryCameras( const Asset& asset_parent,
                                xmlNodePtr lib_cameras_node )
 {
-    Logger log = getLogger( "Scene.XML.parseLibraryCameras" );
+    static const Logger log = getLogger( "Scene.XML.parseLibraryCameras" );
+    SCENE_PROFILE_SCOPE( "Importer::parseLibraryCameras" );
     if( !assertNode( lib_cameras_node, "library_cameras" ) ) {
         return false;
     }
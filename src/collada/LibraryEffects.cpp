@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
 #include "scene/DataBase.hpp"
 #include "scene/Effect.hpp"
 #include "scene/collada/Importer.hpp"
@@ -33,7 +34,8 @@ namespace Scene {
 bool
 Importer::parseLibraryEffects( xmlNodePtr library_effects_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseLibraryEffects" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseLibraryEffects" );
+    SCENE_PROFILE_SCOPE( "Importer::parseLibraryEffects" );
 
 #ifdef DEBUG
     if( !xmlStrEqual( library_effects_node->name, BAD_CAST "library_effects" ) ) {
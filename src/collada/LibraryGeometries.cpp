@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
 #include "scene/DataBase.hpp"
 #include "scene/Geometry.hpp"
 #include "scene/collada/Importer.hpp"
@@ -33,7 +34,8 @@ namespace Scene {
 bool
 Importer::parseLibraryGeometries( xmlNodePtr library_geometries_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseLibraryGeometries" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseLibraryGeometries" );
+    SCENE_PROFILE_SCOPE( "Importer::parseLibraryGeometries" );
     if( !assertNode( library_geometries_node, "library_geometries" ) ) {
         return false;
     }
@@ -17,6 +17,7 @@
  */
 
 #include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
 #include "scene/DataBase.hpp"
 #include "scene/collada/Importer.hpp"
 #include "scene/collada/Exporter.hpp"
@@ -30,7 +31,8 @@ Importer::parseLibraryImages( Context      context,
                               const Asset& asset_parent,
                               xmlNodePtr lib_images_node )
 {
-    Logger log = getLogger( "Scene.XML.parseLibraryImages" );
+    static const Logger log = getLogger( "Scene.XML.parseLibraryImages" );
+    SCENE_PROFILE_SCOPE( "Importer::parseLibraryImages" );
     if( !assertNode( lib_images_node, "library_images" ) ) {
         return false;
     }
@@ -17,6 +17,7 @@
  */
 
 #include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
 #include "scene/DataBase.hpp"
 #include "scene/Library.hpp"
 #include "scene/Light.hpp"
@@ -31,7 +32,8 @@ namespace Scene {
 bool
 Importer::parseLibraryLights( const Asset& parent_asset, xmlNodePtr library_lights_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseLibraryLights" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseLibraryLights" );
+    SCENE_PROFILE_SCOPE( "Importer::parseLibraryLights" );
     if( !assertNode( library_lights_node, "library_lights" ) ) {
         return false;
     }
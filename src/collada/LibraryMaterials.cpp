@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
 #include "scene/DataBase.hpp"
 #include "scene/Material.hpp"
 #include "scene/collada/Importer.hpp"
@@ -33,7 +34,8 @@ namespace Scene {
 bool
 Importer::parseLibraryMaterials( xmlNodePtr library_materials_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseLibraryMaterials" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseLibraryMaterials" );
+    SCENE_PROFILE_SCOPE( "Importer::parseLibraryMaterials" );
 #ifdef DEBUG
     if( !xmlStrEqual( library_materials_node->name, BAD_CAST "library_materials" ) )  {
         SCENELOG_FATAL( log, "Node is not <library_materials>" );
@@ -19,6 +19,7 @@
 #include "scene/DataBase.hpp"
 #include "scene/Node.hpp"
 #include "scene/VisualScene.hpp"
+#include "scene/Profiler.hpp"
 #include "scene/collada/Importer.hpp"
 #include "scene/collada/Exporter.hpp"
 
@@ -36,7 +37,8 @@ Importer::parseLibraryNodes( Context        context,
                              const Asset&   asset_parent,
                              xmlNodePtr     lib_nodes_node )
 {
-    Logger log = getLogger( ipackage + ".parseLibraryNodes" );
+    static const Logger log = getLogger( ipackage + ".parseLibraryNodes" );
+    SCENE_PROFILE_SCOPE( "Importer::parseLibraryNodes" );
     if(!assertNode( lib_nodes_node, "library_nodes" ) ) {
         return false;
     }
@@ -18,6 +18,7 @@
 
 #include <unordered_map>
 #include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
 #include "scene/Asset.hpp"
 #include "scene/DataBase.hpp"
 #include "scene/Geometry.hpp"
@@ -35,7 +36,8 @@ Importer::parseLibraryVisualScenes( Context         context,
                                     const Asset&    asset_parent,
                                     xmlNodePtr      lib_vis_scene_node )
 {
-    Logger log = getLogger( "Scene.XML.parseLibraryVisualScenes" );
+    static const Logger log = getLogger( "Scene.XML.parseLibraryVisualScenes" );
+    SCENE_PROFILE_SCOPE( "Importer::parseLibraryVisualScenes" );
 
     if(!assertNode( lib_vis_scene_node, "library_visual_scenes" ) ) {
         return false;
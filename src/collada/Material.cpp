@@ -31,7 +31,7 @@ bool
 Importer::parseMaterial( const Asset&  asset_parent,
                          xmlNodePtr    material_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseMaterial" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseMaterial" );
     if( !assertNode( material_node, "material" ) ) {
         return false;
     }
@@ -77,7 +77,7 @@ bool
 Importer::parseMesh( Scene::Geometry*  geometry,
                     xmlNodePtr        mesh_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseMesh" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseMesh" );
     assertNode( mesh_node, "mesh" );
 
     SCENELOG_INFO( log, "Parsing <mesh>, geometry.id='"<< geometry->id() <<"'." );
@@ -346,7 +346,7 @@ xmlNodePtr
 Exporter::createMesh( Context& context,
                      const Scene::Geometry* geometry ) const
 {
-    Logger log = getLogger( "Scene.XML.Exporter.createMesh" );
+    static const Logger log = getLogger( "Scene.XML.Exporter.createMesh" );
     if( geometry == NULL ) {
         return NULL;
     }
@@ -31,7 +31,7 @@ namespace Scene {
 bool
 Importer::parseSemantic( RuntimeSemantic& semantic, xmlNodePtr semantic_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseSemantic" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseSemantic" );
     if(!assertNode( semantic_node, "semantic" ) ) {
         return false;
     }
@@ -46,7 +46,7 @@ Importer::parseNewParam( Parameter&          parameter,
                          xmlNodePtr          newparam_node,
                          const ValueContext  context )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseNewParam" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseNewParam" );
     if(!assertNode( newparam_node, "newparam" ) ) {
         return false;
     }
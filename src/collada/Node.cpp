@@ -42,7 +42,7 @@ Importer::parseNode( Node*           parent_node,
                      const Asset&    parent_asset,
                      xmlNodePtr      node_node )
 {
-    Logger log = getLogger( "Scene.XML.parseNode" );
+    static const Logger log = getLogger( "Scene.XML.parseNode" );
     if( !assertNode( node_node, "node" ) ) {
         return false;
     }
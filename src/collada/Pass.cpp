@@ -38,7 +38,7 @@ Importer::parsePass( Technique* technique,
                      const std::unordered_map<std::string,std::string>& code_blocks,
                      xmlNodePtr pass_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parsePass" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parsePass" );
 
 
     const string sid = attribute( pass_node, "sid" );
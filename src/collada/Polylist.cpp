@@ -39,7 +39,7 @@ Builder::parseInputShared( Geometry::PrimitiveSet& prim_set,
                            const unordered_map<string,Geometry::VertexInput>& inputs,
                            xmlNodePtr input_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseInputShared" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseInputShared" );
     if(!assertNode( input_node, "input" ) ) {
         return false;
     }
@@ -78,7 +78,7 @@ Importer::parsePolylist( Geometry*                    geometry,
                         const std::unordered_map<std::string,Geometry::VertexInput>& inputs,
                         xmlNodePtr                      polylist_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parsePolylist" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parsePolylist" );
     if(!assertNode( polylist_node, "polylist" ) ) {
         return false;
     }
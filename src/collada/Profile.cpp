@@ -37,7 +37,7 @@ bool
 Importer::parseProfile( Effect*     effect,
                         xmlNodePtr  profile_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseProfile" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseProfile" );
 
     Profile* profile = NULL;
     if( xmlStrEqual( profile_node->name, BAD_CAST "profile_BRIDGE" ) ) {
@@ -275,7 +275,7 @@ Profile::parseProfileNode( xmlNodePtr profile_node )
 void
 Profile::addProfileNode( xmlNodePtr effect_node )
 {
-    Logger log = getLogger( "Scene.Profile.addProfileNode" );
+    static const Logger log = getLogger( "Scene.Profile.addProfileNode" );
 
 
     string profile_tag;
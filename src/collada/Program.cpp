@@ -33,7 +33,7 @@ Importer::parseProgram( Pass*                                pass,
                         const unordered_map<string,string>&  code_blocks,
                         xmlNodePtr                           program_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseProgram" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseProgram" );
     if(!assertNode( program_node, "program" ) ) {
         return false;
     }
@@ -105,6 +105,11 @@ Importer::parseProgram( Pass*                                pass,
         }
         if( n->children != NULL && xmlStrEqual( n->children->name, BAD_CAST "semantic" ) ) {
             const string semantic_str = getBody( n->children );
+            if( semantic_str == "INSTANCE_WORLD_FROM_OBJECT" ) {
+                // Not a geometry input, fed per instance by the runtime.
+                pass->setInstanceTransformSymbol( symbol );
+                continue;
+            }
             VertexSemantic semantic = VERTEX_SEMANTIC_N;
             for(size_t i=0; i<VERTEX_SEMANTIC_N; i++) {
                 if( m_vertex_semantics[i] == semantic_str ) {
@@ -208,6 +213,11 @@ Exporter::createProgram( Context& context, const Pass* pass ) const
         addProperty( ba_node, "symbol", pass->attributeSymbol(i) );
         newChild( ba_node, NULL, "semantic", m_vertex_semantics[ pass->attributeSemantic(i) ] );
     }
+    if( !pass->instanceTransformSymbol().empty() ) {
+        xmlNodePtr ba_node = newChild( prg_node, NULL, "bind_attribute" );
+        addProperty( ba_node, "symbol", pass->instanceTransformSymbol() );
+        newChild( ba_node, NULL, "semantic", "INSTANCE_WORLD_FROM_OBJECT" );
+    }
 
 
     for( size_t i=0; i<pass->uniforms(); i++ ) {
@@ -41,7 +41,7 @@ Importer::parseSimplePrimitives( Geometry*                    geometry,
                        const std::unordered_map<std::string,Geometry::VertexInput>& inputs,
                        xmlNodePtr                      primitives_node )
 {
-    Logger log = getLogger( ipackage + ".parseSimplePrimitives" );
+    static const Logger log = getLogger( ipackage + ".parseSimplePrimitives" );
 
     PrimitiveType prim_type;
     unsigned int prim_vtx_count = 0;
@@ -0,0 +1,585 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <libxml/tree.h>
+#ifdef USE_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "scene/Log.hpp"
+#include "scene/DataBase.hpp"
+#include "scene/Geometry.hpp"
+#include "scene/Image.hpp"
+#include "scene/SourceBuffer.hpp"
+#include "scene/collada/Importer.hpp"
+#include "scene/collada/Exporter.hpp"
+#include "scene/collada/Snapshot.hpp"
+
+namespace Scene {
+    namespace Collada {
+        using std::string;
+        using std::vector;
+
+static const string package = "Scene.Collada";
+
+static const char     snapshot_magic[8]   = { 'S', 'C', 'E', 'N', 'E', 'S', 'N', 'P' };
+static const uint32_t snapshot_version    = 1u;
+static const uint32_t snapshot_byte_order = 0x01020304u;
+static const uint64_t snapshot_alignment  = 64u;
+
+struct SnapshotHeader
+{
+    char      m_magic[8];
+    uint32_t  m_version;
+    uint32_t  m_byte_order;     ///< snapshot_byte_order as written.
+    uint64_t  m_file_size;
+    uint64_t  m_tables_offset;  ///< Binary description of buffers, images and geometries.
+    uint64_t  m_tables_size;
+    uint64_t  m_collada_offset; ///< Zero-terminated COLLADA text of remaining libraries.
+    uint64_t  m_collada_size;   ///< Including the terminating zero.
+};
+
+/** Serializes the binary tables of a snapshot. */
+class TableWriter
+{
+public:
+    void
+    u8( uint8_t v ) { m_bytes.push_back( static_cast<char>( v ) ); }
+
+    void
+    u32( uint32_t v ) { m_bytes.append( reinterpret_cast<const char*>( &v ), sizeof(v) ); }
+
+    void
+    u64( uint64_t v ) { m_bytes.append( reinterpret_cast<const char*>( &v ), sizeof(v) ); }
+
+    void
+    f32( float v ) { m_bytes.append( reinterpret_cast<const char*>( &v ), sizeof(v) ); }
+
+    void
+    str( const string& v ) { u32( v.size() ); m_bytes.append( v ); }
+
+    const string&
+    bytes() const { return m_bytes; }
+
+protected:
+    string  m_bytes;
+};
+
+/** Bounds-checked reading of the binary tables of a snapshot.
+ *
+ * Once a read fails, all subsequent reads fail, so it suffices to check ok()
+ * at the end of a record.
+ */
+class TableReader
+{
+public:
+    TableReader( const char* begin, const char* end )
+        : m_p( begin ), m_end( end ), m_ok( true )
+    {}
+
+    bool
+    ok() const { return m_ok; }
+
+    uint8_t
+    u8() { uint8_t v = 0; read( &v, sizeof(v) ); return v; }
+
+    uint32_t
+    u32() { uint32_t v = 0; read( &v, sizeof(v) ); return v; }
+
+    uint64_t
+    u64() { uint64_t v = 0; read( &v, sizeof(v) ); return v; }
+
+    float
+    f32() { float v = 0.f; read( &v, sizeof(v) ); return v; }
+
+    const string
+    str()
+    {
+        const size_t n = u32();
+        if( !m_ok || static_cast<size_t>( m_end - m_p ) < n ) {
+            m_ok = false;
+            return string();
+        }
+        string v( m_p, n );
+        m_p += n;
+        return v;
+    }
+
+protected:
+    const char*  m_p;
+    const char*  m_end;
+    bool         m_ok;
+
+    void
+    read( void* dst, size_t n )
+    {
+        if( !m_ok || static_cast<size_t>( m_end - m_p ) < n ) {
+            m_ok = false;
+            return;
+        }
+        std::memcpy( dst, m_p, n );
+        m_p += n;
+    }
+};
+
+static bool
+writePayload( uint64_t& offset, std::ofstream& file, const void* data, size_t bytes )
+{
+    static const char zeros[ snapshot_alignment ] = { 0 };
+    const uint64_t pos = static_cast<uint64_t>( file.tellp() );
+    const uint64_t pad = (snapshot_alignment - (pos % snapshot_alignment)) % snapshot_alignment;
+    file.write( zeros, pad );
+    offset = pos + pad;
+    if( bytes > 0 ) {
+        file.write( reinterpret_cast<const char*>( data ), bytes );
+    }
+    return file.good();
+}
+
+static void
+writeVertexInput( TableWriter& tables, const Geometry::VertexInput& input )
+{
+    tables.u8( input.m_enabled ? 1u : 0u );
+    if( input.m_enabled ) {
+        tables.str( input.m_source_buffer_id );
+        tables.u32( input.m_components );
+        tables.u32( input.m_count );
+        tables.u32( input.m_offset );
+        tables.u32( input.m_stride );
+    }
+}
+
+static void
+writeGeometry( TableWriter& tables, const Geometry* geometry )
+{
+    tables.str( geometry->id() );
+    tables.str( geometry->asset().created() );
+    tables.str( geometry->asset().modified() );
+    for( unsigned int s=0; s<VERTEX_SEMANTIC_N; s++ ) {
+        writeVertexInput( tables, geometry->vertexInput( static_cast<VertexSemantic>( s ) ) );
+    }
+
+    const Value* bbmin;
+    const Value* bbmax;
+    const bool bbox = geometry->boundingBox( bbmin, bbmax )
+                   && ( bbmin->type() == VALUE_TYPE_FLOAT4 )
+                   && ( bbmax->type() == VALUE_TYPE_FLOAT4 );
+    tables.u8( bbox ? 1u : 0u );
+    if( bbox ) {
+        for( unsigned int i=0; i<4; i++ ) {
+            tables.f32( bbmin->floatData()[i] );
+        }
+        for( unsigned int i=0; i<4; i++ ) {
+            tables.f32( bbmax->floatData()[i] );
+        }
+    }
+
+    tables.u32( geometry->primitiveSets() );
+    for( size_t i=0; i<geometry->primitiveSets(); i++ ) {
+        const Primitives* p = geometry->primitives( i );
+        const unsigned int vpp = p->verticesPerPrimitive();
+        tables.u32( p->primitiveType() );
+        tables.u32( vpp > 0 ? p->vertexCount()/vpp : 0u );
+        tables.u32( vpp );
+        tables.str( p->materialSymbol() );
+        tables.str( p->indexBufferId() );
+        tables.u64( p->indexOffset() );
+        tables.u8( p->hasSharedInputs() ? 1u : 0u );
+        if( p->hasSharedInputs() ) {
+            for( unsigned int s=0; s<VERTEX_SEMANTIC_N; s++ ) {
+                const VertexSemantic semantic = static_cast<VertexSemantic>( s );
+                tables.u8( p->sharedInputEnabled( semantic ) ? 1u : 0u );
+                if( p->sharedInputEnabled( semantic ) ) {
+                    tables.u32( p->sharedInputTupleOffset( semantic ) );
+                    tables.str( p->sharedInputSourceBuffer( semantic ) );
+                    tables.u32( p->sharedInputComponents( semantic ) );
+                    tables.u32( p->sharedInputCount( semantic ) );
+                    tables.u32( p->sharedInputOffset( semantic ) );
+                    tables.u32( p->sharedInputStride( semantic ) );
+                }
+            }
+        }
+    }
+}
+
+bool
+writeSnapshot( const DataBase& database, const std::string& path )
+{
+    static const Logger log = getLogger( package + ".writeSnapshot" );
+
+    std::ofstream file( path.c_str(), std::ios::binary | std::ios::trunc );
+    if( !file ) {
+        SCENELOG_ERROR( log, "Unable to open '" << path << "' for writing." );
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memset( &header, 0, sizeof(header) );
+    file.write( reinterpret_cast<const char*>( &header ), sizeof(header) );
+
+    // Payloads are written directly to the file, the tables record where.
+    TableWriter tables;
+    const Library<SourceBuffer>& buffers = database.library<SourceBuffer>();
+    tables.u32( buffers.size() );
+    for( size_t i=0; i<buffers.size(); i++ ) {
+        const SourceBuffer* buffer = buffers.get( i );
+        const size_t element_size = buffer->elementType() == ELEMENT_INT ? sizeof(int) : sizeof(float);
+        uint64_t offset;
+        if( !writePayload( offset, file, buffer->voidData(), element_size*buffer->elementCount() ) ) {
+            SCENELOG_ERROR( log, "Failed to write source buffer '" << buffer->id() << "'." );
+            return false;
+        }
+        tables.str( buffer->id() );
+        tables.u32( buffer->elementType() );
+        tables.u64( buffer->elementCount() );
+        tables.u64( offset );
+    }
+
+    const Library<Image>& images = database.library<Image>();
+    tables.u32( images.size() );
+    for( size_t i=0; i<images.size(); i++ ) {
+        const Image* image = images.get( i );
+        const size_t bytes = image->dataSize();
+        uint64_t offset;
+        if( !writePayload( offset, file, image->get( 0, 0 ), bytes ) ) {
+            SCENELOG_ERROR( log, "Failed to write image '" << image->id() << "'." );
+            return false;
+        }
+        tables.str( image->id() );
+        tables.u32( image->type() );
+        tables.u32( image->suggestedInternalFormat() );
+        tables.u32( image->format() );
+        tables.u32( image->elementType() );
+        tables.u64( image->width() );
+        tables.u64( image->height() );
+        tables.u64( image->depth() );
+        tables.u64( offset );
+        tables.u64( bytes );
+    }
+
+    const Library<Geometry>& geometries = database.library<Geometry>();
+    tables.u32( geometries.size() );
+    for( size_t i=0; i<geometries.size(); i++ ) {
+        writeGeometry( tables, geometries.get( i ) );
+    }
+
+    if( !writePayload( header.m_tables_offset, file, tables.bytes().data(), tables.bytes().size() ) ) {
+        SCENELOG_ERROR( log, "Failed to write tables." );
+        return false;
+    }
+    header.m_tables_size = tables.bytes().size();
+
+    // The remaining libraries are stored as COLLADA.
+    Exporter exporter( database );
+    xmlDocPtr doc = xmlNewDoc( BAD_CAST "1.0" );
+    xmlDocSetRootElement( doc, exporter.create( false ) );
+    xmlChar* text = NULL;
+    int text_size = 0;
+    xmlDocDumpMemory( doc, &text, &text_size );
+    xmlFreeDoc( doc );
+    if( text == NULL ) {
+        SCENELOG_ERROR( log, "Failed to serialize libraries." );
+        return false;
+    }
+    const bool text_ok = writePayload( header.m_collada_offset, file, text, text_size + 1u );
+    xmlFree( text );
+    if( !text_ok ) {
+        SCENELOG_ERROR( log, "Failed to write libraries." );
+        return false;
+    }
+    header.m_collada_size = text_size + 1u;
+
+    std::memcpy( header.m_magic, snapshot_magic, sizeof(snapshot_magic) );
+    header.m_version = snapshot_version;
+    header.m_byte_order = snapshot_byte_order;
+    header.m_file_size = static_cast<uint64_t>( file.tellp() );
+    file.seekp( 0 );
+    file.write( reinterpret_cast<const char*>( &header ), sizeof(header) );
+    if( !file.good() ) {
+        SCENELOG_ERROR( log, "Failed to write header." );
+        return false;
+    }
+    return true;
+}
+
+/** Maps a file read-only, the mapping is released with the last reference. */
+static std::shared_ptr<const void>
+mapFile( size_t& size, const std::string& path )
+{
+    static const Logger log = getLogger( package + ".mapFile" );
+#ifdef USE_POSIX
+    int fd = open( path.c_str(), O_RDONLY );
+    if( fd < 0 ) {
+        SCENELOG_ERROR( log, "Unable to open '" << path << "'." );
+        return std::shared_ptr<const void>();
+    }
+    struct stat st;
+    if( (fstat( fd, &st ) != 0) || (st.st_size <= 0) ) {
+        SCENELOG_ERROR( log, "Unable to stat '" << path << "'." );
+        close( fd );
+        return std::shared_ptr<const void>();
+    }
+    size = static_cast<size_t>( st.st_size );
+    void* base = mmap( NULL, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if( base == MAP_FAILED ) {
+        SCENELOG_ERROR( log, "Unable to map '" << path << "'." );
+        return std::shared_ptr<const void>();
+    }
+    const size_t length = size;
+    return std::shared_ptr<const void>( base, [length]( const void* p ) { munmap( const_cast<void*>( p ), length ); } );
+#else
+    // No mmap, read the file into a single block that is shared the same way.
+    std::ifstream file( path.c_str(), std::ios::binary | std::ios::ate );
+    if( !file ) {
+        SCENELOG_ERROR( log, "Unable to open '" << path << "'." );
+        return std::shared_ptr<const void>();
+    }
+    size = static_cast<size_t>( file.tellg() );
+    std::shared_ptr<char> block( new char[ size ], std::default_delete<char[]>() );
+    file.seekg( 0 );
+    file.read( block.get(), size );
+    if( !file ) {
+        SCENELOG_ERROR( log, "Unable to read '" << path << "'." );
+        return std::shared_ptr<const void>();
+    }
+    return block;
+#endif
+}
+
+static bool
+validRange( uint64_t offset, uint64_t bytes, size_t size )
+{
+    return (offset <= size) && (bytes <= size - offset) && ((offset % snapshot_alignment) == 0u);
+}
+
+static bool
+readGeometry( DataBase& database, TableReader& tables )
+{
+    static const Logger log = getLogger( package + ".readGeometry" );
+
+    const string id = tables.str();
+    const string created = tables.str();
+    const string modified = tables.str();
+    if( !tables.ok() ) {
+        return false;
+    }
+    Geometry* geometry = database.library<Geometry>().add( id );
+    if( geometry == NULL ) {
+        SCENELOG_ERROR( log, "Failed to create geometry '" << id << "'." );
+        return false;
+    }
+    geometry->asset().setCreated( created );
+    geometry->asset().setModified( modified );
+
+    for( unsigned int s=0; s<VERTEX_SEMANTIC_N; s++ ) {
+        if( tables.u8() ) {
+            const string source = tables.str();
+            const unsigned int components = tables.u32();
+            const unsigned int count = tables.u32();
+            const unsigned int offset = tables.u32();
+            const unsigned int stride = tables.u32();
+            geometry->setVertexSource( static_cast<VertexSemantic>( s ), source, components, count, stride, offset );
+        }
+    }
+    if( tables.u8() ) {
+        float b[8];
+        for( unsigned int i=0; i<8; i++ ) {
+            b[i] = tables.f32();
+        }
+        geometry->setBoundingBox( Value::createFloat4( b[0], b[1], b[2], b[3] ),
+                                  Value::createFloat4( b[4], b[5], b[6], b[7] ) );
+    }
+
+    const uint32_t sets = tables.u32();
+    for( uint32_t i=0; (i<sets) && tables.ok(); i++ ) {
+        const PrimitiveType type = static_cast<PrimitiveType>( tables.u32() );
+        const unsigned int primitive_count = tables.u32();
+        const unsigned int vertices_per_primitive = tables.u32();
+        const string material_symbol = tables.str();
+        const string index_buffer_id = tables.str();
+        const uint64_t index_offset = tables.u64();
+        if( !tables.ok() || (type >= PRIMITIVE_N) ) {
+            return false;
+        }
+        Primitives* p = geometry->addPrimitiveSet();
+        if( index_buffer_id.empty() ) {
+            p->set( type, primitive_count, vertices_per_primitive );
+        }
+        else {
+            p->set( type, primitive_count, vertices_per_primitive, index_buffer_id, index_offset );
+        }
+        p->setMaterialSymbol( material_symbol );
+        if( tables.u8() ) {
+            for( unsigned int s=0; s<VERTEX_SEMANTIC_N; s++ ) {
+                if( tables.u8() ) {
+                    const unsigned int tuple_offset = tables.u32();
+                    const string source = tables.str();
+                    const unsigned int components = tables.u32();
+                    const unsigned int count = tables.u32();
+                    const unsigned int offset = tables.u32();
+                    const unsigned int stride = tables.u32();
+                    p->setSharedVertexSource( tuple_offset,
+                                              static_cast<VertexSemantic>( s ),
+                                              source,
+                                              components,
+                                              count,
+                                              stride,
+                                              offset );
+                }
+            }
+        }
+    }
+    return tables.ok();
+}
+
+bool
+readSnapshot( DataBase& database, const std::string& path )
+{
+    static const Logger log = getLogger( package + ".readSnapshot" );
+
+    size_t size = 0;
+    std::shared_ptr<const void> mapping = mapFile( size, path );
+    if( !mapping ) {
+        return false;
+    }
+    const char* base = reinterpret_cast<const char*>( mapping.get() );
+
+    SnapshotHeader header;
+    if( size < sizeof(header) ) {
+        SCENELOG_ERROR( log, "'" << path << "' is not a snapshot." );
+        return false;
+    }
+    std::memcpy( &header, base, sizeof(header) );
+    if( std::memcmp( header.m_magic, snapshot_magic, sizeof(snapshot_magic) ) != 0 ) {
+        SCENELOG_ERROR( log, "'" << path << "' is not a snapshot." );
+        return false;
+    }
+    if( header.m_version != snapshot_version ) {
+        SCENELOG_ERROR( log, "'" << path << "' has unsupported version " << header.m_version << "." );
+        return false;
+    }
+    if( header.m_byte_order != snapshot_byte_order ) {
+        SCENELOG_ERROR( log, "'" << path << "' was written with a different byte order." );
+        return false;
+    }
+    if( (header.m_file_size != size)
+        || !validRange( header.m_tables_offset, header.m_tables_size, size )
+        || !validRange( header.m_collada_offset, header.m_collada_size, size )
+        || (header.m_collada_size == 0)
+        || (base[ header.m_collada_offset + header.m_collada_size - 1 ] != '\0' ) )
+    {
+        SCENELOG_ERROR( log, "'" << path << "' is truncated or corrupt." );
+        return false;
+    }
+
+    TableReader tables( base + header.m_tables_offset,
+                        base + header.m_tables_offset + header.m_tables_size );
+
+    const uint32_t buffers = tables.u32();
+    for( uint32_t i=0; (i<buffers) && tables.ok(); i++ ) {
+        const string id = tables.str();
+        const ElementType type = tables.u32() == ELEMENT_INT ? ELEMENT_INT : ELEMENT_FLOAT;
+        const uint64_t count = tables.u64();
+        const uint64_t offset = tables.u64();
+        const size_t element_size = type == ELEMENT_INT ? sizeof(int) : sizeof(float);
+        if( !tables.ok() || (count > size/element_size) || !validRange( offset, count*element_size, size ) ) {
+            SCENELOG_ERROR( log, "Corrupt source buffer entry in '" << path << "'." );
+            return false;
+        }
+        SourceBuffer* buffer = database.library<SourceBuffer>().add( id );
+        if( buffer == NULL ) {
+            SCENELOG_ERROR( log, "Failed to create source buffer '" << id << "'." );
+            return false;
+        }
+        buffer->reference( type, count, base + offset, mapping );
+    }
+
+    const uint32_t images = tables.u32();
+    for( uint32_t i=0; (i<images) && tables.ok(); i++ ) {
+        const string id = tables.str();
+        const uint32_t type = tables.u32();
+        const GLenum iformat = tables.u32();
+        const GLenum format = tables.u32();
+        const GLenum element_type = tables.u32();
+        const uint64_t width = tables.u64();
+        const uint64_t height = tables.u64();
+        const uint64_t depth = tables.u64();
+        const uint64_t offset = tables.u64();
+        const uint64_t bytes = tables.u64();
+        if( !tables.ok() || !validRange( offset, bytes, size ) ) {
+            SCENELOG_ERROR( log, "Corrupt image entry in '" << path << "'." );
+            return false;
+        }
+        Image* image = database.library<Image>().add( id );
+        if( image == NULL ) {
+            SCENELOG_ERROR( log, "Failed to create image '" << id << "'." );
+            return false;
+        }
+        bool initialized = false;
+        switch( type ) {
+        case IMAGE_2D:
+            initialized = image->init2D( iformat, format, element_type, width, height, 1, 0, true );
+            break;
+        case IMAGE_3D:
+            initialized = image->init3D( iformat, format, element_type, width, height, depth, 1, 0, true );
+            break;
+        case IMAGE_CUBE:
+            initialized = image->initCube( iformat, format, element_type, width, 1, 0, true );
+            break;
+        default:
+            break;
+        }
+        if( !initialized ) {
+            SCENELOG_ERROR( log, "Failed to initialize image '" << id << "'." );
+            return false;
+        }
+        if( (bytes > 0) && !image->reference( base + offset, bytes, mapping ) ) {
+            SCENELOG_ERROR( log, "Image '" << id << "' has unexpected size." );
+            return false;
+        }
+    }
+
+    const uint32_t geometries = tables.u32();
+    for( uint32_t i=0; (i<geometries) && tables.ok(); i++ ) {
+        if( !readGeometry( database, tables ) ) {
+            SCENELOG_ERROR( log, "Corrupt geometry entry in '" << path << "'." );
+            return false;
+        }
+    }
+    if( !tables.ok() ) {
+        SCENELOG_ERROR( log, "Truncated tables in '" << path << "'." );
+        return false;
+    }
+
+    Importer importer( database );
+    if( !importer.parseMemory( base + header.m_collada_offset ) ) {
+        SCENELOG_ERROR( log, "Failed to parse libraries of '" << path << "'." );
+        return false;
+    }
+    return true;
+}
+
+    } // of namespace Collada
+} // of namespace Scene
@@ -37,7 +37,7 @@ bool
 Importer::parseSource( Scene::Geometry::VertexInput&  input,
                       xmlNodePtr                     source_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseSource" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseSource" );
 
     if(!assertNode( source_node, "source" ) ) {
             return false;
@@ -172,7 +172,7 @@ Exporter::createSource( Context&            context,
                         const unsigned int  offset,
                         const unsigned int  stride  ) const
 {
-    Logger log = getLogger( "Scene.XML.Exporter.createSource" );
+    static const Logger log = getLogger( "Scene.XML.Exporter.createSource" );
 
     const std::string src_id = sourceId( source_buffer_id,
                                          count,
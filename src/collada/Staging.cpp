@@ -0,0 +1,153 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "scene/Log.hpp"
+#include "scene/Profiler.hpp"
+#include "scene/runtime/ThreadPool.hpp"
+#include "scene/tools/NumberParser.hpp"
+#include "scene/collada/Importer.hpp"
+
+namespace Scene {
+    namespace Collada {
+        using std::string;
+        using std::vector;
+
+// Collects the number arrays of a geometry subtree in document order.
+static void
+collectArrays( vector<xmlNodePtr>& float_arrays,
+               vector<xmlNodePtr>& int_arrays,
+               xmlNodePtr          node )
+{
+    for( xmlNodePtr n = node->children; n != NULL; n = n->next ) {
+        if( n->type != XML_ELEMENT_NODE ) {
+            continue;
+        }
+        if( xmlStrEqual( n->name, BAD_CAST "float_array" ) ) {
+            float_arrays.push_back( n );
+        }
+        else if( xmlStrEqual( n->name, BAD_CAST "p" ) || xmlStrEqual( n->name, BAD_CAST "vcount" ) ) {
+            int_arrays.push_back( n );
+        }
+        else {
+            collectArrays( float_arrays, int_arrays, n );
+        }
+    }
+}
+
+void
+Importer::stageLibraries( xmlNodePtr collada_node )
+{
+    static const Logger log = getLogger( "Scene.XML.Importer.stageLibraries" );
+    SCENE_PROFILE_SCOPE( "Importer::stageLibraries" );
+
+    vector<xmlNodePtr> float_arrays;
+    vector<xmlNodePtr> int_arrays;
+    vector< std::pair<xmlNodePtr,string> > images;
+    for( xmlNodePtr l = collada_node->children; l != NULL; l = l->next ) {
+        if( checkNode( l, "library_geometries" ) ) {
+            for( xmlNodePtr g = l->children; g != NULL; g = g->next ) {
+                if( checkNode( g, "geometry" ) ) {
+                    collectArrays( float_arrays, int_arrays, g );
+                }
+            }
+        }
+        else if( checkNode( l, "library_images" ) ) {
+            for( xmlNodePtr i = l->children; i != NULL; i = i->next ) {
+                if( !checkNode( i, "image" ) ) {
+                    continue;
+                }
+                for( xmlNodePtr n = i->children; n != NULL; n = n->next ) {
+                    string url;
+                    if( checkNode( n, "init_from" ) && initFromURL( url, n, true ) ) {
+                        images.push_back( std::make_pair( n, url ) );
+                    }
+                }
+            }
+        }
+    }
+
+    // Create all staging entries up front, the workers only fill them in.
+    const size_t jobs = float_arrays.size() + int_arrays.size() + images.size();
+    if( jobs == 0 ) {
+        return;
+    }
+    vector< vector<float>* > float_dst( float_arrays.size() );
+    for( size_t i=0; i<float_arrays.size(); i++ ) {
+        float_dst[i] = &m_staged_floats[ float_arrays[i] ];
+    }
+    vector< vector<int>* > int_dst( int_arrays.size() );
+    for( size_t i=0; i<int_arrays.size(); i++ ) {
+        int_dst[i] = &m_staged_ints[ int_arrays[i] ];
+    }
+    vector< StagedImage* > image_dst( images.size() );
+    for( size_t i=0; i<images.size(); i++ ) {
+        image_dst[i] = &m_staged_images[ images[i].first ];
+    }
+
+    // Images are listed first, as decoding a file is the largest job.
+    auto run = [&]( size_t job ) {
+        if( job < images.size() ) {
+            decodeImage( *image_dst[job], images[job].second );
+            return;
+        }
+        job -= images.size();
+
+        xmlChar* copy = NULL;
+        if( job < float_arrays.size() ) {
+            const string count_str = attribute( float_arrays[job], "count" );
+            const size_t count = strtoul( count_str.c_str(), NULL, 10 );
+            const char* a = bodyText( copy, float_arrays[job] );
+            vector<float>& dst = *float_dst[job];
+            dst.resize( count );
+            if( Tools::parseFloats( dst.data(), count, a, a + strlen( a ) ) != count ) {
+                dst.clear();    // let parseFloatArray report the error
+            }
+        }
+        else {
+            job -= float_arrays.size();
+            const char* a = bodyText( copy, int_arrays[job] );
+            const char* e = a + strlen( a );
+            vector<int>& dst = *int_dst[job];
+            dst.resize( Tools::countTokens( a, e ) );
+            dst.resize( Tools::parseInts( dst.data(), dst.size(), a, e ) );
+        }
+        if( copy != NULL ) {
+            xmlFree( copy );
+        }
+    };
+
+    const size_t threads = std::min( Runtime::ThreadPool::hardwareThreads(), jobs );
+    Runtime::parallelFor( jobs, threads, run );
+    SCENELOG_DEBUG( log, "Staged " << float_arrays.size() << " float arrays, "
+                    << int_arrays.size() << " index arrays and "
+                    << images.size() << " images using " << threads << " threads." );
+}
+
+void
+Importer::clearStaged()
+{
+    m_staged_floats.clear();
+    m_staged_ints.clear();
+    m_staged_images.clear();
+}
+
+    } // of namespace Collada
+} // of namespace Scene
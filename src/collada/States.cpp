@@ -37,7 +37,7 @@ bool
 Importer::parseStates( Pass* pass,
                        xmlNodePtr  states_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseStates" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseStates" );
     if(!assertNode( states_node, "states" ) ) {
         return false;
     }
@@ -39,7 +39,7 @@ Importer::parseTechnique( Profile* profile,
                           const unordered_map<string,string>& code_blocks,
                           xmlNodePtr technique_node )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseTechnique" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseTechnique" );
     if(!assertNode( technique_node, "technique" ) ) {
         return false;
     }
@@ -42,7 +42,7 @@ Importer::parseTriangles( Geometry*                    geometry,
                          const std::unordered_map<std::string,Geometry::VertexInput>& inputs,
                          xmlNodePtr                      triangles_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseTriangles" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseTriangles" );
     if(!assertNode( triangles_node, "triangles" ) ) {
         return false;
     }
@@ -130,7 +130,7 @@ xmlNodePtr
 Exporter::createTriangles( Context& context,
                            const Primitives& ps ) const
 {
-    Logger log = getLogger( "Scene.Builder.createTriangles" );
+    static const Logger log = getLogger( "Scene.Builder.createTriangles" );
 
     xmlNodePtr triangle_node = xmlNewNode( NULL, BAD_CAST "triangles" );
 
@@ -30,7 +30,7 @@ namespace Scene {
 bool
 Importer::parseWrapMode( GLenum& mode, xmlNodePtr n )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseWrapMode" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseWrapMode" );
 
     bool success = true;
 
@@ -68,7 +68,7 @@ Importer::parseFilterMode( GLenum& mode,
                            bool accept_linear,
                            bool accept_anisotropic )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseFilterMode" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseFilterMode" );
     bool success = true;
     xmlChar* p = xmlNodeGetContent( n );
 
@@ -168,7 +168,7 @@ Importer::parseValue( Scene::Value*       value,
                       xmlNodePtr          value_node,
                       const ValueContext  context )
 {
-    Logger log = getLogger( "Scene.XML.Importer.parseValue" );
+    static const Logger log = getLogger( "Scene.XML.Importer.parseValue" );
 
 
     ValueType type = VALUE_TYPE_N;
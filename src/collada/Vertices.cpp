@@ -36,7 +36,7 @@ Importer::parseVertices( Geometry*  geo,
                         const unordered_map<std::string,Geometry::VertexInput>& inputs,
                         xmlNodePtr vertices_node )
 {
-    Logger log = getLogger( "Scene.XML.Builder.parseVertices" );
+    static const Logger log = getLogger( "Scene.XML.Builder.parseVertices" );
     if( !assertNode( vertices_node, "vertices" ) ) {
         return false;
     }
@@ -34,7 +34,7 @@ Importer::parseVisualScene( Context context,
                             const Asset& asset_parent,
                             xmlNodePtr visual_scene_node )
 {
-    Logger log = getLogger( "Scene.XML.parseVisualScene" );
+    static const Logger log = getLogger( "Scene.XML.parseVisualScene" );
     if(!assertNode( visual_scene_node, "visual_scene" ) ) {
         return false;
     }
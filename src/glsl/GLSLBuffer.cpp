@@ -30,7 +30,7 @@ GLSLBuffer::GLSLBuffer()
 
 GLSLBuffer::~GLSLBuffer()
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLBuffer.~GLSLBuffer" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLBuffer.~GLSLBuffer" );
 
     if( m_buffer != 0 ) {
         glDeleteBuffers( 1, &m_buffer );
@@ -42,7 +42,7 @@ GLSLBuffer::~GLSLBuffer()
 void
 GLSLBuffer::pull(const SourceBuffer *buffer)
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLBuffer.pull" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLBuffer.pull" );
 
     if( m_buffer == 0 ) {
         glGenBuffers( 1, &m_buffer );
@@ -48,7 +48,7 @@ bool
 GLSLFrameBuffer::pull( const std::vector<GLSLTexture*>& textures,
                        const SetRenderTargets&          set_fb )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLFrameBuffer.pull" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLFrameBuffer.pull" );
 
     release();
     glGenFramebuffers( 1, &m_fbo );
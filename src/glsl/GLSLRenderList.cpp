@@ -18,7 +18,10 @@
 
 #include <algorithm>
 #include <cstring>
+#include <map>
+#include <unordered_map>
 #include <scene/Log.hpp>
+#include <scene/Profiler.hpp>
 #include <scene/Camera.hpp>
 #include <scene/Image.hpp>
 #include <scene/SourceBuffer.hpp>
@@ -34,7 +37,21 @@ namespace Scene {
 static const string package = "Scene.Runtime.GLSLRenderList";
 
 GLSLRenderList::GLSLRenderList( GLSLRuntime& runtime )
-    : m_runtime( runtime ),
+    : m_state_sorting( false ),
+      m_hierarchical_culling( true ),
+      m_occlusion_culling( false ),
+      m_occlusion( runtime.resolver().database() ),
+      m_bvh_test( Value::createBool( GL_TRUE ) ),
+      m_uniform_uploads( 0 ),
+      m_uniform_uploads_skipped( 0 ),
+      m_draw_calls( 0 ),
+      m_program_switches( 0 ),
+      m_vertex_array_binds( 0 ),
+      m_skipped_items( 0 ),
+      m_instance_stream( GL_ARRAY_BUFFER ),
+      m_instance_ring( m_instance_stream ),
+      m_instance_ring_active( false ),
+      m_runtime( runtime ),
       m_renderlist( m_runtime.resolver() ),
       m_transform_cache( m_runtime.resolver().database(), true ),
       m_default_framebuffer(0),
@@ -44,6 +61,7 @@ GLSLRenderList::GLSLRenderList( GLSLRuntime& runtime )
       m_default_viewport_h(1),
       m_valid( false )
 {
+    memset( &m_sort_statistics, 0, sizeof(SortStatistics) );
 }
 
 void
@@ -59,9 +77,15 @@ GLSLRenderList::setDefaultOutput( GLuint framebuffer, size_t x, size_t y, size_t
 bool
 GLSLRenderList::build( const std::string& visual_scene )
 {
+    SCENE_PROFILE_SCOPE( "GLSLRenderList::build" );
 
     if( m_renderlist.build( visual_scene ) ) {
-        majorUpdate();
+        if( m_renderlist.patched() ) {
+            patchUpdate();
+        }
+        else {
+            majorUpdate();
+        }
     }
     else {
         minorUpdate();
@@ -72,7 +96,7 @@ GLSLRenderList::build( const std::string& visual_scene )
 void
 GLSLRenderList::clear()
 {
-    Logger log = getLogger( package + ".clear" );
+    static const Logger log = getLogger( package + ".clear" );
     SCENELOG_DEBUG( log, "Invoked." );
     for( auto it=m_glsl_list.begin(); it!=m_glsl_list.end(); ++it ) {
         if( it->m_type == GLSLRenderAction::GLSL_ACTION_SET_UNIFORMS ) {
@@ -81,14 +105,36 @@ GLSLRenderList::clear()
     }
 
     m_glsl_list.clear();
+    m_glsl_items.clear();
+    m_glsl_order.clear();
+    m_bvh.clear();
+    m_occlusion.clear();
     m_renderlist.clear();
     m_valid = false;
 }
 
+void
+GLSLRenderList::setStateSorting( bool enable )
+{
+    m_state_sorting = enable;
+}
+
+void
+GLSLRenderList::setHierarchicalCulling( bool enable )
+{
+    m_hierarchical_culling = enable;
+}
+
+void
+GLSLRenderList::setOcclusionCulling( bool enable )
+{
+    m_occlusion_culling = enable;
+}
+
 void
 GLSLRenderList::minorUpdate()
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLRenderList.minorUpdate" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLRenderList.minorUpdate" );
 
     if( !m_valid ) {
         return;
@@ -113,150 +159,261 @@ GLSLRenderList::minorUpdate()
 void
 GLSLRenderList::majorUpdate()
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLRenderList.majorUpdate" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLRenderList.majorUpdate" );
+    SCENE_PROFILE_SCOPE( "GLSLRenderList::majorUpdate" );
     SCENELOG_DEBUG( log, "Rebuilding GL assets." );
 
     m_transform_cache.purge();
 
     glEnable( GL_TEXTURE_CUBE_MAP_SEAMLESS );
 #ifdef SCENE_RL_CHUNKS
-
     m_glsl_items.clear();
     m_glsl_items.resize( m_renderlist.items() );
     for( size_t i=0; i<m_renderlist.items(); i++ ) {
-        const RenderList::Item& item = m_renderlist.item(i);
-        GLSLItem& glsl_item = m_glsl_items[i];
-        glsl_item.m_bbox_test = NULL;
+        setupItem( m_glsl_items[i], m_renderlist.item(i) );
+    }
+    updateCulling();
+    sortItems();
+    coalesceInstances();
+    m_items_updated.touch();
+#endif
+    updateActionList();
+}
+
+void
+GLSLRenderList::patchUpdate()
+{
+    static const Logger log = getLogger( "Scene.Runtime.GLSLRenderList.patchUpdate" );
+    SCENE_PROFILE_SCOPE( "GLSLRenderList::patchUpdate" );
 
-        // --- framebuffer
-        if( item.m_action_set_framebuffer->m_set_render_targets.m_items.empty() ) {
-            // Default FBO
-            glsl_item.m_glsl_framebuffer = NULL;
-            SCENELOG_DEBUG( log, "  viewport=[" << m_default_viewport_x << ", " << m_default_viewport_y << ", " << m_default_viewport_w << ", " << m_default_viewport_h );
-            SCENELOG_DEBUG( log, "  fbo = 0" );
+#ifdef SCENE_RL_CHUNKS
+    // Items that were in the previous list keep their GL objects and their
+    // values in the transform cache, which is not purged, unless the uniform
+    // locations may have changed with the pass.
+    std::vector<GLSLItem> previous;
+    previous.swap( m_glsl_items );
+    m_glsl_items.resize( m_renderlist.items() );
+    size_t added = 0;
+    for( size_t i=0; i<m_renderlist.items(); i++ ) {
+        const size_t p = m_renderlist.previousIndex( i );
+        if( (p < previous.size()) &&
+            (previous[p].m_bbox_test != NULL) &&
+            m_items_updated.asRecentAs( m_renderlist.item(i).m_set_pass->m_pass->structureChanged() ) )
+        {
+            m_glsl_items[i] = std::move( previous[p] );
         }
         else {
-            glsl_item.m_glsl_framebuffer = m_runtime.frameBuffer( item.m_action_set_framebuffer );
-            if( glsl_item.m_glsl_framebuffer == NULL ) {
-                SCENELOG_ERROR( log, "Set framebuffer failed." );
-                continue;
-            }
-            SCENELOG_DEBUG( log, "  viewport=[0, 0, " <<  m_glsl_list[i].m_set_framebuffer->width() << ", " <<  m_glsl_list[i].m_set_framebuffer->height() );
-            SCENELOG_DEBUG( log, "   fbo = " << m_glsl_list[i].m_set_framebuffer->fbo() );
+            setupItem( m_glsl_items[i], m_renderlist.item(i) );
+            added++;
         }
+    }
+    SCENELOG_DEBUG( log, "Set up " << added << " of " << m_glsl_items.size() << " items." );
+    updateCulling();
+    sortItems();
+    coalesceInstances();
+    m_items_updated.touch();
+#endif
+    updateActionList();
+}
 
-        // --- transforms
+bool
+GLSLRenderList::setupItem( GLSLItem& glsl_item, const RenderList::Item& item )
+{
+    static const Logger log = getLogger( package + ".setupItem" );
+
+    glsl_item.m_bbox_test = NULL;
+    glsl_item.m_cull_index = 0;
+    glsl_item.m_instance_transform = NULL;
+    glsl_item.m_instance_run = 1;
+
+    // --- framebuffer
+    if( item.m_action_set_framebuffer->m_set_render_targets.m_items.empty() ) {
+        // Default FBO
+        glsl_item.m_glsl_framebuffer = NULL;
+        SCENELOG_DEBUG( log, "  viewport=[" << m_default_viewport_x << ", " << m_default_viewport_y << ", " << m_default_viewport_w << ", " << m_default_viewport_h );
+        SCENELOG_DEBUG( log, "  fbo = 0" );
+    }
+    else {
+        glsl_item.m_glsl_framebuffer = m_runtime.frameBuffer( item.m_action_set_framebuffer );
+        if( glsl_item.m_glsl_framebuffer == NULL ) {
+            SCENELOG_ERROR( log, "Set framebuffer failed." );
+            return false;
+        }
+        SCENELOG_DEBUG( log, "  viewport=[0, 0, " <<  glsl_item.m_glsl_framebuffer->width() << ", " <<  glsl_item.m_glsl_framebuffer->height() );
+        SCENELOG_DEBUG( log, "   fbo = " << glsl_item.m_glsl_framebuffer->fbo() );
+    }
 
+    // --- transforms
 
-        // --- shader
-        SCENELOG_ASSERT( log, item.m_action_set_pass->m_type == RenderAction::ACTION_SET_PASS );
-        glsl_item.m_glsl_pass = m_runtime.shader( item.m_action_set_pass->m_set_pass.m_pass );
-        if( glsl_item.m_glsl_pass == NULL ) {
-            SCENELOG_ERROR( log, "Set pass failed." );
-            continue;
+
+    // --- shader
+    SCENELOG_ASSERT( log, item.m_action_set_pass->m_type == RenderAction::ACTION_SET_PASS );
+    glsl_item.m_glsl_pass = m_runtime.shader( item.m_action_set_pass->m_set_pass.m_pass );
+    if( glsl_item.m_glsl_pass == NULL ) {
+        SCENELOG_ERROR( log, "Set pass failed." );
+        return false;
+    }
+    SCENELOG_ASSERT( log, item.m_action_set_input->m_type == RenderAction::ACTION_SET_INPUTS );
+    glsl_item.m_glsl_inputs = m_runtime.vbo( item.m_action_set_input );
+    if( glsl_item.m_glsl_inputs == NULL ) {
+        SCENELOG_ERROR( log, "Set inputs failed" );
+        return false;
+    }
+
+    if( item.m_action_set_samplers != NULL ) {
+        SCENELOG_ASSERT( log, item.m_action_set_samplers->m_type == RenderAction::ACTION_SET_SAMPLERS );
+        glsl_item.m_glsl_samplers = m_runtime.samplers( item.m_action_set_samplers );
+        if( glsl_item.m_glsl_samplers == NULL ) {
+            SCENELOG_ERROR( log, "Set samplers failed." );
+            return false;
         }
-        SCENELOG_ASSERT( log, item.m_action_set_input->m_type == RenderAction::ACTION_SET_INPUTS );
-        glsl_item.m_glsl_inputs = m_runtime.vbo( item.m_action_set_input );
-        if( glsl_item.m_glsl_inputs == NULL ) {
-            SCENELOG_ERROR( log, "Set inputs failed" );
-            continue;
+        for( size_t k=0; k<item.m_action_set_samplers->m_set_samplers.m_items.size(); k++ ) {
+            SCENELOG_DEBUG( log, "  set samper unit " << k
+                            << ": img='" << item.m_action_set_samplers->m_set_samplers.m_items[k].m_image->id()
+                            << "', tex=" << glsl_item.m_glsl_samplers->textureName(k)
+                            << ", sampler=" << glsl_item.m_glsl_samplers->sampler(k) );
         }
+    }
 
-        if( item.m_action_set_samplers != NULL ) {
-            SCENELOG_ASSERT( log, item.m_action_set_samplers->m_type == RenderAction::ACTION_SET_SAMPLERS );
-            glsl_item.m_glsl_samplers = m_runtime.samplers( item.m_action_set_samplers );
-            if( glsl_item.m_glsl_samplers == NULL ) {
-                SCENELOG_ERROR( log, "Set samplers failed." );
-                continue;
+    SCENELOG_ASSERT( log, item.m_action_set_uniform->m_type == RenderAction::ACTION_SET_UNIFORMS );
+    glsl_item.m_uniform_values.resize( item.m_action_set_uniform->m_set_uniforms.m_items.size() );
+    for( size_t k=0; k<glsl_item.m_uniform_values.size(); k++ ) {
+        const Value* value = NULL;
+        if( 0 <= glsl_item.m_glsl_pass->uniformLocation(k) ) {
+            const RuntimeSemantic semantic = item.m_action_set_uniform->m_set_uniforms.m_items[k].m_semantic;
+            if( semantic == RUNTIME_SEMANTIC_N ) {
+                // Pull value from database
+                value = item.m_action_set_uniform->m_set_uniforms.m_items[k].m_value;
             }
-            for( size_t k=0; k<item.m_action_set_samplers->m_set_samplers.m_items.size(); k++ ) {
-                SCENELOG_DEBUG( log, "  set samper unit " << k
-                                << ": img='" << item.m_action_set_samplers->m_set_samplers.m_items[k].m_image->id()
-                                << "', tex=" << glsl_item.m_glsl_samplers->textureName(k)
-                                << ", sampler=" << glsl_item.m_glsl_samplers->sampler(k) );
-            }
-        }
-
-        SCENELOG_ASSERT( log, item.m_action_set_uniform->m_type == RenderAction::ACTION_SET_UNIFORMS );
-        glsl_item.m_uniform_values.resize( item.m_action_set_uniform->m_set_uniforms.m_items.size() );
-        for( size_t k=0; k<glsl_item.m_uniform_values.size(); k++ ) {
-            const Value* value = NULL;
-            if( 0 <= glsl_item.m_glsl_pass->uniformLocation(k) ) {
-                const RuntimeSemantic semantic = item.m_action_set_uniform->m_set_uniforms.m_items[k].m_semantic;
-                if( semantic == RUNTIME_SEMANTIC_N ) {
-                    // Pull value from database
-                    value = item.m_action_set_uniform->m_set_uniforms.m_items[k].m_value;
-                }
-                else {
-                    // Pull value from transform cache
-                    value = m_transform_cache.runtimeSemantic( semantic,
-                                                               &item.m_action_set_framebuffer->m_set_render_targets,
-                                                               item.m_set_view_coordsys,
-                                                               item.m_set_local_coordsys );
+            else {
+                // Pull value from transform cache
+                value = m_transform_cache.runtimeSemantic( semantic,
+                                                           &item.m_action_set_framebuffer->m_set_render_targets,
+                                                           item.m_set_view_coordsys,
+                                                           item.m_set_local_coordsys );
 
 
-                }
-                if( value->type() != glsl_item.m_glsl_pass->uniformType(k) ) {
-                    SCENELOG_WARN( log, "uniform " << k
-                                   << ": mismatch, expected type " << glsl_item.m_glsl_pass->uniformType( k )
-                                   << ", got " << value->type() );
+            }
+            if( value->type() != glsl_item.m_glsl_pass->uniformType(k) ) {
+                SCENELOG_WARN( log, "uniform " << k
+                               << ": mismatch, expected type " << glsl_item.m_glsl_pass->uniformType( k )
+                               << ", got " << value->type() );
 
-                }
             }
-            glsl_item.m_uniform_values[k] = value;
         }
+        glsl_item.m_uniform_values[k] = value;
+    }
 
-        const Geometry* geometry = NULL;
-        if( item.m_draw != NULL ) {
-            GLenum draw_mode = item.m_draw->m_mode;
-            GLenum pass_mode = glsl_item.m_glsl_pass->expectedInputPrimitiveType();
-            if( pass_mode != GL_ALWAYS ) {
-                if( draw_mode != pass_mode ) {
-                    SCENELOG_ERROR( log,
-                                   "Shader expects primitive type 0x" << std::hex << pass_mode << std::dec <<
-                                   " but draw command provides primitives of type 0x" << std::hex << draw_mode << std::dec );
-                    continue;
-                }
+    const Geometry* geometry = NULL;
+    if( item.m_draw != NULL ) {
+        GLenum draw_mode = item.m_draw->m_mode;
+        GLenum pass_mode = glsl_item.m_glsl_pass->expectedInputPrimitiveType();
+        if( pass_mode != GL_ALWAYS ) {
+            if( draw_mode != pass_mode ) {
+                SCENELOG_ERROR( log,
+                               "Shader expects primitive type 0x" << std::hex << pass_mode << std::dec <<
+                               " but draw command provides primitives of type 0x" << std::hex << draw_mode << std::dec );
+                return false;
             }
-            glsl_item.m_glsl_indices = NULL;
-            geometry = item.m_draw->m_geometry;
         }
-        else if( item.m_draw_indexed != NULL ) {
-            GLenum draw_mode = item.m_draw_indexed->m_mode;
-            GLenum pass_mode = glsl_item.m_glsl_pass->expectedInputPrimitiveType();
-            if( pass_mode != GL_ALWAYS ) {
-                if( draw_mode != pass_mode ) {
-                    SCENELOG_ERROR( log,
-                                   "Shader expects primitive type 0x" << std::hex << pass_mode << std::dec <<
-                                   " but draw command provides primitives of type 0x" << std::hex << draw_mode << std::dec );
-                    continue;
-                }
-            }
-            glsl_item.m_glsl_indices = m_runtime.buffer( item.m_draw_indexed->m_index_buffer );
-            if( glsl_item.m_glsl_indices == NULL ) {
-                SCENELOG_ERROR( log, "Failed to retrieve draw indices." );
-                continue;
+        glsl_item.m_glsl_indices = NULL;
+        geometry = item.m_draw->m_geometry;
+    }
+    else if( item.m_draw_indexed != NULL ) {
+        GLenum draw_mode = item.m_draw_indexed->m_mode;
+        GLenum pass_mode = glsl_item.m_glsl_pass->expectedInputPrimitiveType();
+        if( pass_mode != GL_ALWAYS ) {
+            if( draw_mode != pass_mode ) {
+                SCENELOG_ERROR( log,
+                               "Shader expects primitive type 0x" << std::hex << pass_mode << std::dec <<
+                               " but draw command provides primitives of type 0x" << std::hex << draw_mode << std::dec );
+                return false;
             }
-            geometry = item.m_draw_indexed->m_geometry;
         }
-        else {
-            SCENELOG_FATAL( log, "neither draw nor draw_indexed, shouldn't happen" );
-            continue;
+        glsl_item.m_glsl_indices = m_runtime.buffer( item.m_draw_indexed->m_index_buffer );
+        if( glsl_item.m_glsl_indices == NULL ) {
+            SCENELOG_ERROR( log, "Failed to retrieve draw indices." );
+            return false;
         }
+        geometry = item.m_draw_indexed->m_geometry;
+    }
+    else {
+        SCENELOG_FATAL( log, "neither draw nor draw_indexed, shouldn't happen" );
+        return false;
+    }
+
+    if( 0 <= glsl_item.m_glsl_pass->instanceTransformLocation() ) {
+        glsl_item.m_instance_transform = m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_OBJECT,
+                                                                            &item.m_action_set_framebuffer->m_set_render_targets,
+                                                                            item.m_set_view_coordsys,
+                                                                            item.m_set_local_coordsys );
+    }
 
-        // everything worked out, add conditional on this item
+    // everything worked out, add conditional on this item
+    if( m_hierarchical_culling ) {
+        glsl_item.m_bbox_test = &m_bvh_test;    // added to m_bvh by updateCulling
+    }
+    else {
         glsl_item.m_bbox_test = m_transform_cache.checkBoundingBox( item.m_set_view_coordsys,
                                                                     item.m_set_local_coordsys,
                                                                     geometry );
+    }
+    return true;
+}
 
+void
+GLSLRenderList::updateCulling()
+{
+    m_bvh.clear();
+    m_occlusion.clear();
+    for( size_t i=0; i<m_glsl_items.size(); i++ ) {
+        GLSLItem& glsl_item = m_glsl_items[i];
+        if( glsl_item.m_bbox_test != &m_bvh_test ) {
+            continue;
+        }
+        const RenderList::Item& item = m_renderlist.item(i);
+        const Geometry* geometry = item.m_draw != NULL ? item.m_draw->m_geometry : item.m_draw_indexed->m_geometry;
+        const Value* bbox_min = NULL;
+        const Value* bbox_max = NULL;
+        if( !geometry->boundingBox( bbox_min, bbox_max ) ) {
+            bbox_min = NULL;
+            bbox_max = NULL;
+        }
+        const SetViewCoordSys* view = item.m_set_view_coordsys;
+        const Value* projection = m_transform_cache.cameraProjectionMatrix( view->m_camera );
+        const Value* clip_from_world = NULL;
+        if( projection != NULL ) {
+            clip_from_world = m_transform_cache.matrixComposition( projection,
+                                                                   m_transform_cache.pathTransformInverseMatrix( view->m_camera_path ) );
+        }
+        const Value* world_from_object = m_transform_cache.pathTransformMatrix( item.m_set_local_coordsys->m_node_path );
+        glsl_item.m_cull_index = m_bvh.add( clip_from_world, world_from_object, bbox_min, bbox_max );
+        if( m_occlusion_culling ) {
+            m_occlusion.add( clip_from_world,
+                             world_from_object,
+                             geometry,
+                             item.m_draw != NULL ? item.m_draw->m_primitives : item.m_draw_indexed->m_primitives );
+        }
     }
-#endif
+}
+
+void
+GLSLRenderList::updateActionList()
+{
+    static const Logger log = getLogger( "Scene.Runtime.GLSLRenderList.updateActionList" );
 
     const SetRenderTargets* current_fbo = NULL;
     const SetViewCoordSys*  current_view_coordsys = NULL;
     const SetLocalCoordSys* current_local_coordsys = NULL;
     const GLSLShader*       current_pass = NULL;
 
+    for( auto it=m_glsl_list.begin(); it!=m_glsl_list.end(); ++it ) {
+        if( it->m_type == GLSLRenderAction::GLSL_ACTION_SET_UNIFORMS ) {
+            delete[] (it->m_set_uniforms.m_values);
+        }
+    }
+    m_glsl_list.clear();
+
     m_valid = true;
     m_glsl_list.resize( m_renderlist.size() );
     SCENELOG_DEBUG( log, "BEGIN" );
@@ -270,7 +427,7 @@ GLSLRenderList::majorUpdate()
         switch( action->m_type ) {
         case RenderAction::ACTION_SET_VIEW_COORDSYS:
             SCENELOG_DEBUG( log, "SET_VIEW" );
-            current_view_coordsys = &action->m_set_view;
+            current_view_coordsys = action->m_set_view;
             break;
 
         case RenderAction::ACTION_SET_LOCAL_COORDSYS:
@@ -399,9 +556,13 @@ GLSLRenderList::majorUpdate()
                     return;
                 }
             }
+#ifdef SCENE_RL_CHUNKS
+            m_glsl_list[i].m_draw.m_bbox_check = NULL;     // culled through m_glsl_items.
+#else
             m_glsl_list[i].m_draw.m_bbox_check = m_transform_cache.checkBoundingBox( current_view_coordsys,
                                                                                      current_local_coordsys,
                                                                                      action->m_draw.m_geometry );
+#endif
             break;
         case RenderAction::ACTION_DRAW_INDEXED:
             SCENELOG_DEBUG( log, "DRAW_INDEXED" );
@@ -414,10 +575,14 @@ GLSLRenderList::majorUpdate()
                     return;
                 }
             }
+#ifdef SCENE_RL_CHUNKS
+            m_glsl_list[i].m_draw_indexed.m_bbox_check = NULL;
+#else
             m_glsl_list[i].m_draw_indexed.m_bbox_check =
                     m_transform_cache.checkBoundingBox( current_view_coordsys,
                                                         current_local_coordsys,
                                                         action->m_draw_indexed.m_geometry );
+#endif
             m_glsl_list[i].m_draw_indexed.m_indices = m_runtime.buffer( action->m_draw_indexed.m_index_buffer );
             if( m_glsl_list[i].m_draw_indexed.m_indices == NULL ) {
                 SCENELOG_ERROR( log, "OpenGL failed, invalidating list." );
@@ -430,11 +595,302 @@ GLSLRenderList::majorUpdate()
     SCENELOG_DEBUG( log, "END" );
 }
 
+namespace {
+
+/** Dense ranks of state objects, in order of first appearance. */
+class StateRanks
+{
+public:
+    StateRanks( unsigned int bits )
+        : m_max( (1u<<bits)-1u )
+    {}
+
+    unsigned int
+    operator()( const void* state )
+    {
+        auto it = m_ranks.find( state );
+        if( it != m_ranks.end() ) {
+            return it->second;
+        }
+        // Running out of ranks makes sorting less effective, but not wrong.
+        unsigned int rank = std::min( static_cast<unsigned int>( m_ranks.size() ), m_max );
+        m_ranks[ state ] = rank;
+        return rank;
+    }
+
+protected:
+    const unsigned int                          m_max;
+    std::unordered_map<const void*,unsigned int> m_ranks;
+};
+
+} // of anonymous namespace
+
+void
+GLSLRenderList::sortItems()
+{
+    static const Logger log = getLogger( package + ".sortItems" );
+
+    const size_t N = m_glsl_items.size();
+    m_glsl_order.resize( N );
+    for( size_t i=0; i<N; i++ ) {
+        m_glsl_order[i] = i;
+    }
+    memset( &m_sort_statistics, 0, sizeof(SortStatistics) );
+    if( !m_state_sorting ) {
+        return;
+    }
+
+    // Sort key, most significant first: the pass ordinal, i.e. how many times
+    // the same primitives have been drawn earlier in the segment (so that
+    // multi-pass techniques stay in pass order), then program, vertex array
+    // and sampler set. The eye-space depth is not known until render time,
+    // so ties are resolved by stable sorting, which keeps traversal order.
+    StateRanks program_ranks( 16 );
+    StateRanks inputs_ranks( 24 );
+    StateRanks samplers_ranks( 16 );
+    std::vector<unsigned long long> keys( N, 0ull );
+    std::map< std::pair<const void*,const void*>, unsigned int > pass_ordinals;
+
+    size_t segment_begin = 0;
+    const RenderList::Item* segment_item = NULL;    // first item of open segment.
+    const GLSLItem* segment_glsl_item = NULL;
+    auto closeSegment = [&]( size_t end ) {
+        if( segment_item != NULL ) {
+            std::stable_sort( m_glsl_order.begin() + segment_begin,
+                              m_glsl_order.begin() + end,
+                              [&keys]( size_t a, size_t b ) { return keys[a] < keys[b]; } );
+            m_sort_statistics.m_segments++;
+        }
+        segment_item = NULL;
+        segment_glsl_item = NULL;
+        pass_ordinals.clear();
+    };
+
+    for( size_t i=0; i<N; i++ ) {
+        const GLSLItem* glsl_item = &m_glsl_items[i];
+        if( glsl_item->m_bbox_test == NULL ) {
+            continue;   // never drawn, position is irrelevant.
+        }
+        const RenderList::Item* item = &m_renderlist.item(i);
+
+        // Items whose result depend on what is drawn before are not moved.
+        if( (item->m_set_pixel_ops->m_blend == GL_TRUE) ||
+            (item->m_set_pixel_ops->m_depth_test != GL_TRUE) ||
+            (item->m_set_fb_ctrl->m_depth_writemask != GL_TRUE) )
+        {
+            closeSegment( i );
+            m_sort_statistics.m_segments++;
+            continue;
+        }
+        if( (segment_item == NULL) ||
+            (segment_glsl_item->m_glsl_framebuffer != glsl_item->m_glsl_framebuffer) ||
+            (segment_item->m_set_view_coordsys != item->m_set_view_coordsys) )
+        {
+            closeSegment( i );
+            segment_begin = i;
+            segment_item = item;
+            segment_glsl_item = glsl_item;
+        }
+
+        const void* primitives = item->m_draw != NULL
+                               ? static_cast<const void*>( item->m_draw->m_primitives )
+                               : static_cast<const void*>( item->m_draw_indexed->m_primitives );
+        unsigned int& pass_ordinal = pass_ordinals[ std::make_pair( primitives,
+                                                                    static_cast<const void*>( item->m_set_local_coordsys ) ) ];
+        keys[i] = (static_cast<unsigned long long>( std::min( pass_ordinal, 255u ) ) << 56u)
+                | (static_cast<unsigned long long>( program_ranks( glsl_item->m_glsl_pass ) ) << 40u)
+                | (static_cast<unsigned long long>( inputs_ranks( glsl_item->m_glsl_inputs ) ) << 16u)
+                | (static_cast<unsigned long long>( samplers_ranks( item->m_action_set_samplers ) ) );
+        pass_ordinal++;
+    }
+    closeSegment( N );
+
+    // Count the state switches saved, as seen by render().
+    const GLSLItem* prev_glsl_item = NULL;
+    const GLSLItem* prev_sorted_glsl_item = NULL;
+    const RenderList::Item* prev_item = NULL;
+    const RenderList::Item* prev_sorted_item = NULL;
+    for( size_t n=0; n<N; n++ ) {
+        const GLSLItem* glsl_item = &m_glsl_items[n];
+        if( glsl_item->m_bbox_test != NULL ) {
+            const RenderList::Item* item = &m_renderlist.item(n);
+            m_sort_statistics.m_items++;
+            if( prev_glsl_item == NULL || prev_glsl_item->m_glsl_pass != glsl_item->m_glsl_pass ) {
+                m_sort_statistics.m_program_switches++;
+            }
+            if( prev_glsl_item == NULL || prev_glsl_item->m_glsl_inputs != glsl_item->m_glsl_inputs ) {
+                m_sort_statistics.m_vao_switches++;
+            }
+            if( prev_item == NULL || prev_item->m_action_set_samplers != item->m_action_set_samplers ) {
+                m_sort_statistics.m_sampler_switches++;
+            }
+            prev_glsl_item = glsl_item;
+            prev_item = item;
+        }
+        const GLSLItem* sorted_glsl_item = &m_glsl_items[ m_glsl_order[n] ];
+        if( sorted_glsl_item->m_bbox_test != NULL ) {
+            const RenderList::Item* sorted_item = &m_renderlist.item( m_glsl_order[n] );
+            if( prev_sorted_glsl_item == NULL || prev_sorted_glsl_item->m_glsl_pass != sorted_glsl_item->m_glsl_pass ) {
+                m_sort_statistics.m_program_switches_sorted++;
+            }
+            if( prev_sorted_glsl_item == NULL || prev_sorted_glsl_item->m_glsl_inputs != sorted_glsl_item->m_glsl_inputs ) {
+                m_sort_statistics.m_vao_switches_sorted++;
+            }
+            if( prev_sorted_item == NULL || prev_sorted_item->m_action_set_samplers != sorted_item->m_action_set_samplers ) {
+                m_sort_statistics.m_sampler_switches_sorted++;
+            }
+            prev_sorted_glsl_item = sorted_glsl_item;
+            prev_sorted_item = sorted_item;
+        }
+    }
+    SCENELOG_DEBUG( log, "Sorted " << m_sort_statistics.m_items << " items in "
+                    << m_sort_statistics.m_segments << " segments, saved "
+                    << (m_sort_statistics.m_program_switches - m_sort_statistics.m_program_switches_sorted) << " program switches, "
+                    << (m_sort_statistics.m_vao_switches - m_sort_statistics.m_vao_switches_sorted) << " VAO switches and "
+                    << (m_sort_statistics.m_sampler_switches - m_sort_statistics.m_sampler_switches_sorted) << " sampler switches." );
+}
+
+bool
+GLSLRenderList::sameInstanceState( size_t a, size_t b ) const
+{
+    const GLSLItem& glsl_a = m_glsl_items[a];
+    const GLSLItem& glsl_b = m_glsl_items[b];
+    if( (glsl_a.m_glsl_framebuffer != glsl_b.m_glsl_framebuffer) ||
+        (glsl_a.m_glsl_pass != glsl_b.m_glsl_pass) ||
+        (glsl_a.m_glsl_inputs != glsl_b.m_glsl_inputs) ||
+        (glsl_a.m_glsl_indices != glsl_b.m_glsl_indices) ||
+        (glsl_a.m_uniform_values != glsl_b.m_uniform_values ) )
+    {
+        return false;
+    }
+    const RenderList::Item& item_a = m_renderlist.item(a);
+    const RenderList::Item& item_b = m_renderlist.item(b);
+    if( (item_a.m_action_set_samplers != item_b.m_action_set_samplers) ||
+        (item_a.m_set_view_coordsys != item_b.m_set_view_coordsys) ||
+        (item_a.m_set_raster != item_b.m_set_raster) ||
+        (item_a.m_set_pixel_ops != item_b.m_set_pixel_ops) ||
+        (item_a.m_set_fb_ctrl != item_b.m_set_fb_ctrl) )
+    {
+        return false;
+    }
+    if( (item_a.m_draw != NULL) && (item_b.m_draw != NULL) ) {
+        return (item_a.m_draw->m_mode == item_b.m_draw->m_mode) &&
+               (item_a.m_draw->m_vertices == item_b.m_draw->m_vertices) &&
+               (item_a.m_draw->m_first == item_b.m_draw->m_first) &&
+               (item_a.m_draw->m_count == item_b.m_draw->m_count);
+    }
+    if( (item_a.m_draw_indexed != NULL) && (item_b.m_draw_indexed != NULL) ) {
+        return (item_a.m_draw_indexed->m_mode == item_b.m_draw_indexed->m_mode) &&
+               (item_a.m_draw_indexed->m_vertices == item_b.m_draw_indexed->m_vertices) &&
+               (item_a.m_draw_indexed->m_type == item_b.m_draw_indexed->m_type) &&
+               (item_a.m_draw_indexed->m_offset == item_b.m_draw_indexed->m_offset) &&
+               (item_a.m_draw_indexed->m_count == item_b.m_draw_indexed->m_count);
+    }
+    return false;
+}
+
+void
+GLSLRenderList::coalesceInstances()
+{
+    static const Logger log = getLogger( package + ".coalesceInstances" );
+
+    const size_t N = m_glsl_order.size();
+    size_t head = N;    // submission position of first item in current run.
+    size_t instanced = 0;
+    size_t runs = 0;
+    for( size_t n=0; n<N; n++ ) {
+        GLSLItem& glsl_item = m_glsl_items[ m_glsl_order[n] ];
+        if( glsl_item.m_bbox_test == NULL ) {
+            continue;   // never drawn, doesn't break a run.
+        }
+        if( glsl_item.m_instance_transform == NULL ) {
+            head = N;
+            continue;
+        }
+        instanced++;
+        if( (head < N) && sameInstanceState( m_glsl_order[head], m_glsl_order[n] ) ) {
+            m_glsl_items[ m_glsl_order[head] ].m_instance_run = n - head + 1;
+            glsl_item.m_instance_run = 0;
+        }
+        else {
+            head = n;
+            glsl_item.m_instance_run = 1;
+            runs++;
+        }
+    }
+    if( instanced != 0 ) {
+        SCENELOG_DEBUG( log, "Coalesced " << instanced << " instanced items into " << runs << " draws." );
+    }
+}
+
+void
+GLSLRenderList::updateInstances()
+{
+    static const Logger log = getLogger( package + ".updateInstances" );
+    const size_t stride = 16*sizeof(float);
+
+    // Count the visible instances of each run.
+    size_t total = 0;
+    for( size_t n=0; n<m_glsl_order.size(); n++ ) {
+        GLSLItem& head = m_glsl_items[ m_glsl_order[n] ];
+        if( (head.m_bbox_test == NULL) ||
+            (head.m_instance_transform == NULL) ||
+            (head.m_instance_run == 0) )
+        {
+            continue;
+        }
+        head.m_instance_count = 0;
+        for( size_t r=0; r<head.m_instance_run; r++ ) {
+            const GLSLItem& instance = m_glsl_items[ m_glsl_order[n+r] ];
+            if( (instance.m_bbox_test != NULL) && itemVisible( instance ) ) {
+                head.m_instance_count++;
+            }
+        }
+        total += head.m_instance_count;
+    }
+    m_instance_ring_active = false;
+    if( total == 0 ) {
+        return;
+    }
+    if( !m_instance_ring.begin( stride*total ) ) {
+        SCENELOG_ERROR( log, "Failed to map instance buffer." );
+        for( size_t n=0; n<m_glsl_items.size(); n++ ) {
+            m_glsl_items[n].m_instance_count = 0;
+        }
+        return;
+    }
+    m_instance_ring_active = true;
+
+    // Write the matrices straight into the mapped region, one pass.
+    const size_t offset = m_instance_ring.allocate( stride*total, stride );
+    float* dst = reinterpret_cast<float*>( m_instance_ring.pointer( offset ) );
+    GLsizei first = static_cast<GLsizei>( offset/stride );
+    for( size_t n=0; n<m_glsl_order.size(); n++ ) {
+        GLSLItem& head = m_glsl_items[ m_glsl_order[n] ];
+        if( (head.m_bbox_test == NULL) ||
+            (head.m_instance_transform == NULL) ||
+            (head.m_instance_run == 0) )
+        {
+            continue;
+        }
+        head.m_instance_first = first;
+        first += head.m_instance_count;
+        for( size_t r=0; r<head.m_instance_run; r++ ) {
+            const GLSLItem& instance = m_glsl_items[ m_glsl_order[n+r] ];
+            if( (instance.m_bbox_test != NULL) && itemVisible( instance ) ) {
+                memcpy( dst, instance.m_instance_transform->floatData(), stride );
+                dst += 16;
+            }
+        }
+    }
+    m_instance_ring.commit();
+}
 
 void
 GLSLRenderList::render( )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLRendererList.render" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLRendererList.render" );
+    SCENE_PROFILE_SCOPE( "GLSLRenderList::render" );
     size_t max_texture_unit = 0;
     if( !GLSLRuntime::checkGL( log ) ) {
         SCENELOG_ERROR( log, "Entered render function with pending GL errors, ignoring." );
@@ -443,6 +899,11 @@ GLSLRenderList::render( )
                               m_default_viewport_h );
 
 #ifdef SCENE_RL_CHUNKS
+    m_bvh.update();
+    if( m_occlusion.items() != 0 ) {
+        m_occlusion.update( &m_bvh );
+    }
+
     RenderList::Item dummy;
     GLSLItem glsl_dummy;
     memset( &dummy, 0, sizeof(RenderList::Item) );
@@ -451,12 +912,31 @@ GLSLRenderList::render( )
     const RenderList::Item* prev_item = &dummy;
     const GLSLItem* prev_glsl_item = &glsl_dummy;
 
+    updateInstances();
+
     size_t skipped = 0;
+    m_uniform_uploads = 0;
+    m_uniform_uploads_skipped = 0;
+    m_draw_calls = 0;
+    m_program_switches = 0;
+    m_vertex_array_binds = 0;
     glBindFramebuffer( GL_FRAMEBUFFER, m_default_framebuffer );
     glViewport( m_default_viewport_x, m_default_viewport_y, m_default_viewport_w, m_default_viewport_h );
-    for( size_t i=0; i<m_glsl_items.size(); i++ ) {
+    for( size_t n=0; n<m_glsl_order.size(); n++ ) {
+        const size_t i = m_glsl_order[n];
         const GLSLItem* glsl_item = &m_glsl_items[i];
-        if( (glsl_item->m_bbox_test == NULL) || (glsl_item->m_bbox_test->boolData()[0] != GL_TRUE ) ) {
+        if( glsl_item->m_bbox_test == NULL ) {
+            skipped ++;
+            continue;
+        }
+        if( glsl_item->m_instance_transform != NULL ) {
+            // Instanced, drawn by the first item of the run if any is visible.
+            if( (glsl_item->m_instance_run == 0) || (glsl_item->m_instance_count == 0) ) {
+                skipped++;
+                continue;
+            }
+        }
+        else if( !itemVisible( *glsl_item ) ) {
             skipped ++;
             continue;
         }
@@ -537,10 +1017,24 @@ GLSLRenderList::render( )
 
         if( prev_glsl_item->m_glsl_pass != glsl_item->m_glsl_pass ) {
             glUseProgram( glsl_item->m_glsl_pass->program() );                  // use shader program
+            m_program_switches++;
         }
 
         if( prev_glsl_item->m_glsl_inputs != glsl_item->m_glsl_inputs ) {
             glBindVertexArray( glsl_item->m_glsl_inputs->vertexArray() );       // bind vertex array object
+            m_vertex_array_binds++;
+        }
+
+        if( glsl_item->m_instance_transform != NULL ) {                         // per-instance transform
+            const GLint location = glsl_item->m_glsl_pass->instanceTransformLocation();
+            glBindBuffer( GL_ARRAY_BUFFER, m_instance_stream.buffer() );
+            for( GLint c=0; c<4; c++ ) {    // a mat4 attribute occupies one location per column
+                glEnableVertexAttribArray( location + c );
+                glVertexAttribPointer( location + c, 4, GL_FLOAT, GL_FALSE, 16*sizeof(GLfloat),
+                                       reinterpret_cast<GLvoid*>( sizeof(GLfloat)*( 16*glsl_item->m_instance_first + 4*c ) ) );
+                glVertexAttribDivisor( location + c, 1 );
+            }
+            glBindBuffer( GL_ARRAY_BUFFER, 0 );
         }
 
 
@@ -564,6 +1058,11 @@ GLSLRenderList::render( )
             for( size_t k=0; k<glsl_item->m_uniform_values.size(); k++ ) {
                 const Value* value = glsl_item->m_uniform_values[k];
                 if( value != NULL ) {
+                    if( !glsl_item->m_glsl_pass->uniformChanged( k, value ) ) {
+                        m_uniform_uploads_skipped++;
+                        continue;
+                    }
+                    m_uniform_uploads++;
                     GLint loc = glsl_item->m_glsl_pass->uniformLocation(k);
                     switch( value->type() ) {
                     case VALUE_TYPE_INT:
@@ -613,19 +1112,38 @@ GLSLRenderList::render( )
             if( item->m_draw->m_mode == GL_PATCHES ) {
                 glPatchParameteri( GL_PATCH_VERTICES, item->m_draw->m_vertices );
             }
-            glDrawArrays( item->m_draw->m_mode, item->m_draw->m_first, item->m_draw->m_count );
+            if( glsl_item->m_instance_transform != NULL ) {
+                glDrawArraysInstanced( item->m_draw->m_mode,
+                                       item->m_draw->m_first,
+                                       item->m_draw->m_count,
+                                       glsl_item->m_instance_count );
+            }
+            else {
+                glDrawArrays( item->m_draw->m_mode, item->m_draw->m_first, item->m_draw->m_count );
+            }
+            m_draw_calls++;
         }
         if( item->m_draw_indexed != NULL ) {
             if( item->m_draw_indexed->m_mode == GL_PATCHES ) {
                 glPatchParameteri( GL_PATCH_VERTICES, item->m_draw_indexed->m_vertices );
             }
             glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, glsl_item->m_glsl_indices->buffer() );
-            glDrawElements( item->m_draw_indexed->m_mode,
-                            item->m_draw_indexed->m_count,
-                            item->m_draw_indexed->m_type,
-                            //                            GL_UNSIGNED_INT, //m_glsl_list[i].m_draw_indexed->elementType(),
-                            item->m_draw_indexed->m_offset );
+            if( glsl_item->m_instance_transform != NULL ) {
+                glDrawElementsInstanced( item->m_draw_indexed->m_mode,
+                                         item->m_draw_indexed->m_count,
+                                         item->m_draw_indexed->m_type,
+                                         item->m_draw_indexed->m_offset,
+                                         glsl_item->m_instance_count );
+            }
+            else {
+                glDrawElements( item->m_draw_indexed->m_mode,
+                                item->m_draw_indexed->m_count,
+                                item->m_draw_indexed->m_type,
+                                //                            GL_UNSIGNED_INT, //m_glsl_list[i].m_draw_indexed->elementType(),
+                                item->m_draw_indexed->m_offset );
+            }
             glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+            m_draw_calls++;
         }
 
 
@@ -651,6 +1169,16 @@ GLSLRenderList::render( )
 */
 
     }
+    if( m_instance_ring_active ) {
+        m_instance_ring.end();
+    }
+    m_skipped_items = skipped;
+    SCENE_PROFILE_COUNT( "GLSLRenderList.draws", m_draw_calls );
+    SCENE_PROFILE_COUNT( "GLSLRenderList.programSwitches", m_program_switches );
+    SCENE_PROFILE_COUNT( "GLSLRenderList.vertexArrayBinds", m_vertex_array_binds );
+    SCENE_PROFILE_COUNT( "GLSLRenderList.skipped", skipped );
+    SCENE_PROFILE_COUNT( "GLSLRenderList.uniformUploads", m_uniform_uploads );
+    SCENE_PROFILE_COUNT( "GLSLRenderList.uniformUploadsSkipped", m_uniform_uploads_skipped );
     if( skipped != 0 ) {
 //        SCENELOG_ERROR( log, "skipped " << (int)((100.f*skipped)/m_glsl_items.size()) << "% items." );
     }
@@ -28,7 +28,7 @@ namespace Scene {
         using std::for_each;
 
 bool
-GLSLRuntime::checkGL( Logger& log, const string& message )
+GLSLRuntime::checkGL( const Logger& log, const string& message )
 {
     GLenum error = glGetError();
     if( error == GL_NO_ERROR ) {
@@ -118,7 +118,7 @@ GLSLRuntime::setReferenceSize( size_t w, size_t h )
 GLSLFrameBuffer*
 GLSLRuntime::frameBuffer( const RenderAction* set_fb)
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLRuntime.frameBuffer" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLRuntime.frameBuffer" );
     SCENELOG_DEBUG( log, "==============" );
 
     std::vector<GLSLTexture*> textures( set_fb->m_set_render_targets.m_items.size() );
@@ -163,7 +163,7 @@ GLSLRuntime::frameBuffer( const RenderAction* set_fb)
 GLSLBuffer*
 GLSLRuntime::buffer( const SourceBuffer* buffer )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLRuntime.buffer" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLRuntime.buffer" );
     if( buffer == NULL ) {
         SCENELOG_FATAL( log, "buffer==NULL @" << __LINE__ );
         return NULL;
@@ -188,7 +188,7 @@ GLSLRuntime::buffer( const SourceBuffer* buffer )
 GLSLTexture*
 GLSLRuntime::texture( const Image* image )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLRuntime.texture" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLRuntime.texture" );
     const string key = image->key();
     auto it = m_texture_cache.find( key );
     if( it != m_texture_cache.end() ) {
@@ -229,7 +229,7 @@ GLSLRuntime::shader( const Pass* pass )
 GLSLVertexArray*
 GLSLRuntime::vbo( const RenderAction* set_inputs )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLRuntime.vbo" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLRuntime.vbo" );
 
     if( set_inputs->m_type != RenderAction::ACTION_SET_INPUTS ) {
         SCENELOG_FATAL( log, "action is not of SET_INPUT type." );
@@ -283,7 +283,7 @@ GLSLRuntime::vbo( const RenderAction* set_inputs )
 GLSLSamplers*
 GLSLRuntime::samplers( const RenderAction* set_samplers )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLRuntime.samplers" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLRuntime.samplers" );
     if( set_samplers->m_type != RenderAction::ACTION_SET_SAMPLERS ) {
         SCENELOG_FATAL( log, "action is not of SET_SAMPLERS type." );
         return NULL;
@@ -46,7 +46,7 @@ void
 GLSLSamplers::pull( const std::vector<GLSLTexture*>& textures,
                     const SetSamplers&               setsamplers )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLSamplers.pull" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLSamplers.pull" );
     release();
 
     if( textures.size() != setsamplers.m_items.size() ) {
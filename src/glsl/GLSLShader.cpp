@@ -16,6 +16,7 @@
  * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include <scene/Log.hpp>
 #include <scene/Pass.hpp>
 #include <scene/glsl/GLSLRuntime.hpp>
@@ -32,7 +33,8 @@ GLSLShader::GLSLShader()
       m_shader_geometry(0),
       m_shader_tess_ctrl(0),
       m_shader_tess_eval(0),
-      m_shader_fragment(0)
+      m_shader_fragment(0),
+      m_instance_transform_location( -1 )
 {
 }
 
@@ -72,10 +74,67 @@ GLSLShader::release()
 
 }
 
+bool
+GLSLShader::uniformChanged( size_t ix, const Value* value )
+{
+    Uniform& uniform = m_uniforms[ix];
+    size_t bytes;
+    const void* data;
+    switch( value->type() ) {
+    case VALUE_TYPE_INT:
+        bytes = sizeof(int);
+        data = value->intData();
+        break;
+    case VALUE_TYPE_FLOAT:
+        bytes = sizeof(float);
+        data = value->floatData();
+        break;
+    case VALUE_TYPE_FLOAT2:
+        bytes = 2*sizeof(float);
+        data = value->floatData();
+        break;
+    case VALUE_TYPE_FLOAT3:
+        bytes = 3*sizeof(float);
+        data = value->floatData();
+        break;
+    case VALUE_TYPE_FLOAT4:
+        bytes = 4*sizeof(float);
+        data = value->floatData();
+        break;
+    case VALUE_TYPE_FLOAT3X3:
+        bytes = 9*sizeof(float);
+        data = value->floatData();
+        break;
+    case VALUE_TYPE_FLOAT4X4:
+        bytes = 16*sizeof(float);
+        data = value->floatData();
+        break;
+    default:
+        // Not a value we upload as a plain uniform, don't shadow.
+        return true;
+    }
+    if( (uniform.m_shadow_type == value->type() ) &&
+        (memcmp( &uniform.m_shadow, data, bytes ) == 0 ) )
+    {
+        return false;
+    }
+    uniform.m_shadow_type = value->type();
+    memcpy( &uniform.m_shadow, data, bytes );
+    return true;
+}
+
+void
+GLSLShader::invalidateUniformShadow()
+{
+    for( size_t i=0; i<m_uniforms.size(); i++ ) {
+        m_uniforms[i].m_shadow_type = VALUE_TYPE_N;
+    }
+}
+
 bool
 GLSLShader::pull( const Pass* pass )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLShader.pull" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLShader.pull" );
     release();
 
     bool has_tessellation_shader = false;
@@ -180,7 +239,7 @@ GLSLShader::pull( const Pass* pass )
 void
 GLSLShader::retrieveAttributeInfo( const Pass* pass )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLShader.retrieveAttributeInfo" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLShader.retrieveAttributeInfo" );
 //    const Program* program = pass->program();
 
     GLint active_attribs;
@@ -255,13 +314,43 @@ GLSLShader::retrieveAttributeInfo( const Pass* pass )
                         ", element_type=" << m_attributes[i].m_element_type <<
                         ", components=" << m_attributes[i].m_components );
     }
+
+    m_instance_transform_location = -1;
+    if( !pass->instanceTransformSymbol().empty() ) {
+        GLint location = glGetAttribLocation( m_program,
+                                              pass->instanceTransformSymbol().c_str() );
+        for( GLint k=0; k<active_attribs; k++) {
+            GLint gl_size;
+            GLenum gl_type;
+            GLchar gl_name[256];
+            glGetActiveAttrib( m_program,
+                               k,
+                               sizeof(gl_name),
+                               NULL,
+                               &gl_size,
+                               &gl_type,
+                               gl_name );
+            if( pass->instanceTransformSymbol() == gl_name ) {
+                if( gl_type == GL_FLOAT_MAT4 ) {
+                    m_instance_transform_location = location;
+                }
+                else {
+                    SCENELOG_ERROR( log, "instance transform attribute " << gl_name <<
+                                    " is not a mat4, ignoring." );
+                }
+                break;
+            }
+        }
+        SCENELOG_DEBUG( log, "instance transform " << pass->instanceTransformSymbol() <<
+                        ", location=" << m_instance_transform_location );
+    }
 }
 
 
 void
 GLSLShader::retrieveUniformInfo( const Pass* pass )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLShader.retrieveUniformInfo" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLShader.retrieveUniformInfo" );
 
     GLint active_uniforms;
     glGetProgramiv( m_program, GL_ACTIVE_UNIFORMS, &active_uniforms );
@@ -270,6 +359,7 @@ GLSLShader::retrieveUniformInfo( const Pass* pass )
 
     m_uniforms.resize( pass->uniforms() );
     for( size_t i=0; i<m_uniforms.size(); i++) {
+        m_uniforms[i].m_shadow_type = VALUE_TYPE_N;
         m_uniforms[i].m_location = glGetUniformLocation( m_program, pass->uniformSymbol(i).c_str() );
         if( m_uniforms[i].m_location < 0 ) {
              m_uniforms[i].m_type = VALUE_TYPE_N;
@@ -416,7 +506,7 @@ GLSLShader::retrieveUniformInfo( const Pass* pass )
 bool
 GLSLShader::compileShader( GLuint shader, const std::string& source )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLShader.compileShader" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLShader.compileShader" );
 
     const GLchar* src = source.c_str();
     glShaderSource( shader, 1, &src, NULL );
@@ -447,7 +537,7 @@ GLSLShader::compileShader( GLuint shader, const std::string& source )
 bool
 GLSLShader::linkProgram()
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLShader.linkProgram" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLShader.linkProgram" );
 
     glLinkProgram( m_program );
 
@@ -0,0 +1,128 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <scene/Log.hpp>
+#include <scene/glsl/GLSLRuntime.hpp>
+
+namespace Scene {
+    namespace Runtime {
+
+GLSLStreamBuffer::GLSLStreamBuffer( GLenum target )
+    : m_target( target ),
+      m_buffer( 0 ),
+      m_persistent( false )
+{
+}
+
+GLSLStreamBuffer::~GLSLStreamBuffer()
+{
+    release();
+}
+
+void
+GLSLStreamBuffer::release()
+{
+    for( size_t i=0; i<m_fences.size(); i++ ) {
+        wait( i );
+    }
+    if( m_buffer != 0 ) {
+        if( m_persistent ) {
+            glBindBuffer( m_target, m_buffer );
+            glUnmapBuffer( m_target );
+            glBindBuffer( m_target, 0 );
+        }
+        glDeleteBuffers( 1, &m_buffer );
+        m_buffer = 0;
+    }
+    m_host.clear();
+}
+
+unsigned char*
+GLSLStreamBuffer::map( size_t bytes )
+{
+    static const Logger log = getLogger( "Scene.Runtime.GLSLStreamBuffer.map" );
+    release();
+
+    unsigned char* ptr = NULL;
+    glGenBuffers( 1, &m_buffer );
+    glBindBuffer( m_target, m_buffer );
+    m_persistent = GLEW_ARB_buffer_storage;
+    if( m_persistent ) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage( m_target, bytes, NULL, flags );
+        ptr = reinterpret_cast<unsigned char*>( glMapBufferRange( m_target, 0, bytes, flags ) );
+    }
+    else {
+        glBufferData( m_target, bytes, NULL, GL_STREAM_DRAW );
+        m_host.resize( bytes );
+        ptr = m_host.data();
+    }
+    glBindBuffer( m_target, 0 );
+    if( !GLSLRuntime::checkGL( log ) ) {
+        return NULL;
+    }
+    SCENELOG_DEBUG( log, "buffer=" << m_buffer << ", bytes=" << bytes << ", persistent=" << m_persistent );
+    return ptr;
+}
+
+void
+GLSLStreamBuffer::flush( size_t offset, size_t bytes )
+{
+    if( !m_persistent ) {
+        glBindBuffer( m_target, m_buffer );
+        glBufferSubData( m_target, offset, bytes, m_host.data() + offset );
+        glBindBuffer( m_target, 0 );
+    }
+    // Coherent mapping, writes are visible to commands issued after this.
+}
+
+void
+GLSLStreamBuffer::fence( size_t region )
+{
+    if( !m_persistent ) {
+        return; // glBufferSubData is synchronised by the driver.
+    }
+    if( m_fences.size() <= region ) {
+        m_fences.resize( region+1, 0 );
+    }
+    if( m_fences[region] != 0 ) {
+        glDeleteSync( m_fences[region] );
+    }
+    m_fences[region] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+void
+GLSLStreamBuffer::wait( size_t region )
+{
+    if( (m_fences.size() <= region) || (m_fences[region] == 0) ) {
+        return;
+    }
+    while( 1 ) {
+        GLenum status = glClientWaitSync( m_fences[region],
+                                          GL_SYNC_FLUSH_COMMANDS_BIT,
+                                          1000000 /* 1 ms */ );
+        if( status != GL_TIMEOUT_EXPIRED ) {
+            break;
+        }
+    }
+    glDeleteSync( m_fences[region] );
+    m_fences[region] = 0;
+}
+
+    } // of namespace Runtime
+} // of namespace Scene
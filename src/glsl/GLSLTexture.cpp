@@ -62,7 +62,7 @@ GLSLTexture::doBuildMipMap()
 void
 GLSLTexture::pull(const Image *image)
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLTexture.pull" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLTexture.pull" );
 
     if( m_texture == 0 ) {
         glGenTextures( 1, &m_texture );
@@ -36,7 +36,7 @@ GLSLVertexArray::~GLSLVertexArray()
 void
 GLSLVertexArray::release()
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLVertexArray.release" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLVertexArray.release" );
     if( m_vertex_array != 0 ) {
         SCENELOG_DEBUG( log, "Released vertex array " << m_vertex_array );
         glDeleteVertexArrays( 1, &m_vertex_array );
@@ -47,9 +47,9 @@ GLSLVertexArray::release()
 void
 GLSLVertexArray::pull( const std::vector<const GLSLBuffer*> sources,
                        const GLSLShader*                    shader,
-                       const std::vector<SetInputs::Item>&  items )
+                       const ItemArray<SetInputs::Item>&    items )
 {
-    Logger log = getLogger( "Scene.Runtime.GLSLVertexArray.pull" );
+    static const Logger log = getLogger( "Scene.Runtime.GLSLVertexArray.pull" );
 
     release();
     glGenVertexArrays( 1, &m_vertex_array );
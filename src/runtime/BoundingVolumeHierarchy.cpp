@@ -0,0 +1,404 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#include <scene/Log.hpp>
+#include <scene/Value.hpp>
+#include <scene/Profiler.hpp>
+#include <scene/runtime/BoundingVolumeHierarchy.hpp>
+
+namespace Scene {
+    namespace Runtime {
+
+static const std::string package = "Scene.Runtime.BoundingVolumeHierarchy";
+
+namespace {
+
+/** Max number of items in a leaf. */
+const uint32_t leaf_size = 4;
+
+} // of anonymous namespace
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+    : m_visible_items( 0 ),
+      m_last_refit_count( 0 ),
+      m_last_test_count( 0 )
+{
+}
+
+void
+BoundingVolumeHierarchy::clear()
+{
+    m_items.clear();
+    m_views.clear();
+    m_unbounded.clear();
+    m_visible.clear();
+    m_visible_items = 0;
+}
+
+size_t
+BoundingVolumeHierarchy::add( const Value*  clip_from_world,
+                              const Value*  world_from_object,
+                              const Value*  bbox_min,
+                              const Value*  bbox_max )
+{
+    const uint32_t index = static_cast<uint32_t>( m_items.size() );
+    Item item;
+    item.m_world_from_object = world_from_object;
+    item.m_bbox_min = bbox_min;
+    item.m_bbox_max = bbox_max;
+    item.m_leaf = 0;
+    m_items.push_back( item );
+    m_visible.push_back( 1 );
+
+    if( (clip_from_world == NULL) || (bbox_min == NULL) || (bbox_max == NULL) ) {
+        m_unbounded.push_back( index );
+        return index;
+    }
+
+    // Render lists rarely have more than a handful of views.
+    size_t v = 0;
+    while( (v < m_views.size()) && (m_views[v].m_clip_from_world != clip_from_world) ) {
+        v++;
+    }
+    if( v == m_views.size() ) {
+        m_views.resize( v+1 );
+        m_views[v].m_clip_from_world = clip_from_world;
+    }
+    m_views[v].m_order.push_back( index );
+    m_views[v].m_built = false;
+    return index;
+}
+
+void
+BoundingVolumeHierarchy::computeBounds( Item& item )
+{
+    const float* bmin = item.m_bbox_min->floatData();
+    const float* bmax = item.m_bbox_max->floatData();
+    float c[3], e[3];
+    for( unsigned int k=0; k<3; k++ ) {
+        c[k] = 0.5f*( bmin[k] + bmax[k] );
+        e[k] = 0.5f*( bmax[k] - bmin[k] );
+    }
+    if( item.m_world_from_object == NULL ) {
+        for( unsigned int k=0; k<3; k++ ) {
+            item.m_center[k] = c[k];
+            item.m_extent[k] = e[k];
+        }
+        return;
+    }
+    // Transform the center, and let the extent be the sum of the absolute
+    // values of the transformed half-axes (column-major matrix).
+    const float* M = item.m_world_from_object->floatData();
+    for( unsigned int r=0; r<3; r++ ) {
+        item.m_center[r] = M[r]*c[0] + M[4+r]*c[1] + M[8+r]*c[2] + M[12+r];
+        item.m_extent[r] = std::fabs( M[r] )*e[0] + std::fabs( M[4+r] )*e[1] + std::fabs( M[8+r] )*e[2];
+    }
+}
+
+void
+BoundingVolumeHierarchy::build( View& view )
+{
+    view.m_nodes.clear();
+    view.m_nodes.reserve( 2*(view.m_order.size()/leaf_size) + 1 );
+    view.m_nodes.resize( 1 );
+    view.m_nodes[0].m_parent = 0;
+    buildNode( view, 0, 0, static_cast<uint32_t>( view.m_order.size() ) );
+    view.m_built = true;
+}
+
+void
+BoundingVolumeHierarchy::buildNode( View& view, uint32_t index, uint32_t begin, uint32_t end )
+{
+    float lo[3], hi[3];     // bounds of the item centers.
+    {
+        Node& node = view.m_nodes[index];
+        node.m_begin = begin;
+        node.m_end = end;
+        node.m_child = 0;
+        node.m_dirty = false;
+        for( unsigned int k=0; k<3; k++ ) {
+            node.m_min[k] = lo[k] = std::numeric_limits<float>::max();
+            node.m_max[k] = hi[k] = -std::numeric_limits<float>::max();
+        }
+        for( uint32_t i=begin; i<end; i++ ) {
+            const Item& item = m_items[ view.m_order[i] ];
+            for( unsigned int k=0; k<3; k++ ) {
+                node.m_min[k] = std::min( node.m_min[k], item.m_center[k] - item.m_extent[k] );
+                node.m_max[k] = std::max( node.m_max[k], item.m_center[k] + item.m_extent[k] );
+                lo[k] = std::min( lo[k], item.m_center[k] );
+                hi[k] = std::max( hi[k], item.m_center[k] );
+            }
+        }
+    }
+    if( end - begin <= leaf_size ) {
+        for( uint32_t i=begin; i<end; i++ ) {
+            m_items[ view.m_order[i] ].m_leaf = index;
+        }
+        return;
+    }
+
+    // Median split along the axis where the centers are most spread.
+    unsigned int axis = 0;
+    for( unsigned int k=1; k<3; k++ ) {
+        if( hi[k]-lo[k] > hi[axis]-lo[axis] ) {
+            axis = k;
+        }
+    }
+    const uint32_t mid = begin + (end-begin)/2;
+    std::nth_element( view.m_order.begin() + begin,
+                      view.m_order.begin() + mid,
+                      view.m_order.begin() + end,
+                      [this,axis]( uint32_t a, uint32_t b ) {
+                          return m_items[a].m_center[axis] < m_items[b].m_center[axis];
+                      } );
+
+    const uint32_t child = static_cast<uint32_t>( view.m_nodes.size() );
+    view.m_nodes.resize( child + 2 );
+    view.m_nodes[index].m_child = child;
+    view.m_nodes[child].m_parent = index;
+    view.m_nodes[child+1].m_parent = index;
+    buildNode( view, child, begin, mid );
+    buildNode( view, child+1, mid, end );
+}
+
+void
+BoundingVolumeHierarchy::refit( View& view )
+{
+    // Children are stored after their parent, so a reverse sweep visits
+    // children first.
+    for( size_t n=view.m_nodes.size(); n>0; n-- ) {
+        Node& node = view.m_nodes[n-1];
+        if( !node.m_dirty ) {
+            continue;
+        }
+        node.m_dirty = false;
+        if( node.m_child != 0 ) {
+            const Node& a = view.m_nodes[ node.m_child ];
+            const Node& b = view.m_nodes[ node.m_child+1 ];
+            for( unsigned int k=0; k<3; k++ ) {
+                node.m_min[k] = std::min( a.m_min[k], b.m_min[k] );
+                node.m_max[k] = std::max( a.m_max[k], b.m_max[k] );
+            }
+        }
+        else {
+            for( unsigned int k=0; k<3; k++ ) {
+                node.m_min[k] = std::numeric_limits<float>::max();
+                node.m_max[k] = -std::numeric_limits<float>::max();
+            }
+            for( uint32_t i=node.m_begin; i<node.m_end; i++ ) {
+                const Item& item = m_items[ view.m_order[i] ];
+                for( unsigned int k=0; k<3; k++ ) {
+                    node.m_min[k] = std::min( node.m_min[k], item.m_center[k] - item.m_extent[k] );
+                    node.m_max[k] = std::max( node.m_max[k], item.m_center[k] + item.m_extent[k] );
+                }
+            }
+        }
+    }
+}
+
+void
+BoundingVolumeHierarchy::extractPlanes( View& view )
+{
+    // A point is inside if -w <= x,y,z <= w in clip space, i.e. the planes
+    // are row 3 plus or minus rows 0, 1 and 2 of the (column-major) matrix.
+    const float* M = view.m_clip_from_world->floatData();
+    for( unsigned int p=0; p<6; p++ ) {
+        const unsigned int row = p/2;
+        const float sign = (p%2) == 0 ? 1.f : -1.f;
+        for( unsigned int k=0; k<4; k++ ) {
+            view.m_planes[k][p] = M[4*k+3] + sign*M[4*k+row];
+        }
+    }
+    for( unsigned int p=6; p<8; p++ ) {     // padding, always inside.
+        view.m_planes[0][p] = 0.f;
+        view.m_planes[1][p] = 0.f;
+        view.m_planes[2][p] = 0.f;
+        view.m_planes[3][p] = 1.f;
+    }
+    for( unsigned int k=0; k<3; k++ ) {
+        for( unsigned int p=0; p<8; p++ ) {
+            view.m_abs_normals[k][p] = std::fabs( view.m_planes[k][p] );
+        }
+    }
+}
+
+int
+BoundingVolumeHierarchy::classify( const View& view, const float* center, const float* extent )
+{
+    // For each plane, d is the signed distance of the center (scaled by the
+    // length of the normal) and r the projected radius of the box.
+#ifdef __SSE__
+    const __m128 cx = _mm_set1_ps( center[0] );
+    const __m128 cy = _mm_set1_ps( center[1] );
+    const __m128 cz = _mm_set1_ps( center[2] );
+    const __m128 ex = _mm_set1_ps( extent[0] );
+    const __m128 ey = _mm_set1_ps( extent[1] );
+    const __m128 ez = _mm_set1_ps( extent[2] );
+    int outside = 0;
+    int partial = 0;
+    for( unsigned int h=0; h<8; h+=4 ) {
+        __m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( view.m_planes[0] + h ), cx ),
+                                           _mm_mul_ps( _mm_loadu_ps( view.m_planes[1] + h ), cy ) ),
+                               _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( view.m_planes[2] + h ), cz ),
+                                           _mm_loadu_ps( view.m_planes[3] + h ) ) );
+        __m128 r = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( view.m_abs_normals[0] + h ), ex ),
+                                           _mm_mul_ps( _mm_loadu_ps( view.m_abs_normals[1] + h ), ey ) ),
+                               _mm_mul_ps( _mm_loadu_ps( view.m_abs_normals[2] + h ), ez ) );
+        outside |= _mm_movemask_ps( _mm_cmplt_ps( _mm_add_ps( d, r ), _mm_setzero_ps() ) );
+        partial |= _mm_movemask_ps( _mm_cmplt_ps( _mm_sub_ps( d, r ), _mm_setzero_ps() ) );
+    }
+#else
+    bool outside = false;
+    bool partial = false;
+    for( unsigned int p=0; p<6; p++ ) {
+        const float d = view.m_planes[0][p]*center[0] +
+                        view.m_planes[1][p]*center[1] +
+                        view.m_planes[2][p]*center[2] +
+                        view.m_planes[3][p];
+        const float r = view.m_abs_normals[0][p]*extent[0] +
+                        view.m_abs_normals[1][p]*extent[1] +
+                        view.m_abs_normals[2][p]*extent[2];
+        outside = outside || (d + r < 0.f);
+        partial = partial || (d - r < 0.f);
+    }
+#endif
+    if( outside ) {
+        return -1;
+    }
+    return partial ? 0 : 1;
+}
+
+void
+BoundingVolumeHierarchy::cull( View& view )
+{
+    std::vector<uint32_t> stack;
+    stack.reserve( 64 );
+    if( !view.m_nodes.empty() ) {
+        stack.push_back( 0 );
+    }
+    while( !stack.empty() ) {
+        const Node& node = view.m_nodes[ stack.back() ];
+        stack.pop_back();
+
+        float center[3], extent[3];
+        for( unsigned int k=0; k<3; k++ ) {
+            center[k] = 0.5f*( node.m_max[k] + node.m_min[k] );
+            extent[k] = 0.5f*( node.m_max[k] - node.m_min[k] );
+        }
+        const int c = classify( view, center, extent );
+        m_last_test_count++;
+        if( c != 0 ) {
+            // The whole subtree is either outside or inside.
+            for( uint32_t i=node.m_begin; i<node.m_end; i++ ) {
+                m_visible[ view.m_order[i] ] = c > 0 ? 1 : 0;
+            }
+        }
+        else if( node.m_child != 0 ) {
+            stack.push_back( node.m_child + 1 );
+            stack.push_back( node.m_child );
+        }
+        else {
+            for( uint32_t i=node.m_begin; i<node.m_end; i++ ) {
+                const Item& item = m_items[ view.m_order[i] ];
+                m_visible[ view.m_order[i] ] = classify( view, item.m_center, item.m_extent ) >= 0 ? 1 : 0;
+                m_last_test_count++;
+            }
+        }
+    }
+}
+
+void
+BoundingVolumeHierarchy::update()
+{
+    SCENE_PROFILE_SCOPE( "BoundingVolumeHierarchy::update" );
+    m_last_refit_count = 0;
+    m_last_test_count = 0;
+    for( size_t v=0; v<m_views.size(); v++ ) {
+        View& view = m_views[v];
+        bool changed = false;
+        if( !view.m_built ) {
+            for( size_t i=0; i<view.m_order.size(); i++ ) {
+                Item& item = m_items[ view.m_order[i] ];
+                if( item.m_world_from_object != NULL ) {
+                    item.m_seen.moveForward( item.m_world_from_object->valueChanged() );
+                }
+                item.m_seen.moveForward( item.m_bbox_min->valueChanged() );
+                item.m_seen.moveForward( item.m_bbox_max->valueChanged() );
+                computeBounds( item );
+            }
+            build( view );
+            m_last_refit_count += view.m_order.size();
+            changed = true;
+        }
+        else {
+            size_t refitted = 0;
+            for( size_t i=0; i<view.m_order.size(); i++ ) {
+                Item& item = m_items[ view.m_order[i] ];
+                bool moved = false;
+                if( item.m_world_from_object != NULL ) {
+                    moved = item.m_seen.moveForward( item.m_world_from_object->valueChanged() );
+                }
+                moved = item.m_seen.moveForward( item.m_bbox_min->valueChanged() ) || moved;
+                moved = item.m_seen.moveForward( item.m_bbox_max->valueChanged() ) || moved;
+                if( !moved ) {
+                    continue;
+                }
+                computeBounds( item );
+                refitted++;
+                uint32_t n = item.m_leaf;
+                while( !view.m_nodes[n].m_dirty ) {
+                    view.m_nodes[n].m_dirty = true;
+                    if( n == 0 ) {
+                        break;
+                    }
+                    n = view.m_nodes[n].m_parent;
+                }
+            }
+            if( 2*refitted > view.m_order.size() ) {
+                build( view );  // refitting would degrade the hierarchy.
+            }
+            else if( refitted > 0 ) {
+                refit( view );
+            }
+            m_last_refit_count += refitted;
+            changed = refitted > 0;
+        }
+
+        // Culling is only redone when the items or the view have changed.
+        if( view.m_culled.moveForward( view.m_clip_from_world->valueChanged() ) || changed ) {
+            extractPlanes( view );
+            cull( view );
+        }
+    }
+
+    m_visible_items = 0;
+    for( size_t i=0; i<m_visible.size(); i++ ) {
+        m_visible_items += m_visible[i];
+    }
+    SCENE_PROFILE_COUNT( "BoundingVolumeHierarchy.update.refit", m_last_refit_count );
+    SCENE_PROFILE_COUNT( "BoundingVolumeHierarchy.update.tests", m_last_test_count );
+}
+
+    } // of namespace Runtime
+} // of namespace Scene
@@ -0,0 +1,562 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#include <scene/Log.hpp>
+#include <scene/Value.hpp>
+#include <scene/DataBase.hpp>
+#include <scene/Geometry.hpp>
+#include <scene/Primitives.hpp>
+#include <scene/SourceBuffer.hpp>
+#include <scene/Profiler.hpp>
+#include <scene/runtime/BoundingVolumeHierarchy.hpp>
+#include <scene/runtime/OcclusionCuller.hpp>
+#include <scene/runtime/ThreadPool.hpp>
+#include <scene/runtime/TransformCompute.hpp>
+
+namespace Scene {
+    namespace Runtime {
+
+static const std::string package = "Scene.Runtime.OcclusionCuller";
+
+namespace {
+
+/** Below this amount of work, threads cost more than they save. */
+const size_t parallel_threshold = 1024;
+
+/** Candidates per parallel task. */
+const size_t rect_chunk_size = 256;
+
+/** Depth buffer rows per parallel task. */
+const int band_rows = 8;
+
+/** Clip-space w below which a point is considered behind the eye. */
+const float near_w = 1e-5f;
+
+/** Object-to-clip matrix of an item. */
+void
+clipFromObject( float* M, const float* clip_from_world, const Value* world_from_object )
+{
+    if( world_from_object == NULL ) {
+        std::copy_n( clip_from_world, 16, M );
+    }
+    else {
+        TransformCompute::multiply4x4( M, clip_from_world, world_from_object->floatData() );
+    }
+}
+
+} // of anonymous namespace
+
+
+OcclusionCuller::OcclusionCuller( const DataBase& database )
+    : m_database( database ),
+      m_width( 256 ),
+      m_height( 128 ),
+      m_max_occluders( 32 ),
+      m_max_occluder_triangles( 4096 ),
+      m_threads( 1 ),
+      m_visible_items( 0 ),
+      m_culled_items( 0 ),
+      m_last_occluders( 0 ),
+      m_last_triangles( 0 )
+{
+#ifdef SCENE_USE_THREADS
+    m_threads = ThreadPool::hardwareThreads();
+#endif
+}
+
+void
+OcclusionCuller::clear()
+{
+    m_items.clear();
+    m_views.clear();
+    m_unbounded.clear();
+    m_visible.clear();
+    m_visible_items = 0;
+    m_culled_items = 0;
+}
+
+void
+OcclusionCuller::setResolution( unsigned int width, unsigned int height )
+{
+    m_width = std::max( 4u, (width + 3u) & ~3u );
+    m_height = std::max( 1u, height );
+}
+
+size_t
+OcclusionCuller::add( const Value*       clip_from_world,
+                      const Value*       world_from_object,
+                      const Geometry*    geometry,
+                      const Primitives*  primitives )
+{
+    const uint32_t index = static_cast<uint32_t>( m_items.size() );
+    Item item;
+    item.m_clip_from_world = clip_from_world;
+    item.m_world_from_object = world_from_object;
+    item.m_bbox_min = NULL;
+    item.m_bbox_max = NULL;
+    if( (geometry == NULL) || !geometry->boundingBox( item.m_bbox_min, item.m_bbox_max ) ) {
+        item.m_bbox_min = NULL;
+        item.m_bbox_max = NULL;
+    }
+    item.m_geometry = geometry;
+    item.m_primitives = primitives;
+    item.m_occluder = occluderData( geometry, primitives );
+    m_items.push_back( item );
+    m_visible.push_back( 1 );
+
+    if( clip_from_world == NULL ) {
+        m_unbounded.push_back( index );
+        return index;
+    }
+    size_t v = 0;
+    while( (v < m_views.size()) && (m_views[v].m_clip_from_world != clip_from_world) ) {
+        v++;
+    }
+    if( v == m_views.size() ) {
+        m_views.resize( v+1 );
+        m_views[v].m_clip_from_world = clip_from_world;
+    }
+    m_views[v].m_items.push_back( index );
+    return index;
+}
+
+bool
+OcclusionCuller::occluderData( const Geometry*     geometry,
+                               const Primitives*   primitives ) const
+{
+    if( (geometry == NULL) || (primitives == NULL) ) {
+        return false;
+    }
+    if( (primitives->primitiveType() != PRIMITIVE_TRIANGLES) || primitives->hasSharedInputs() ) {
+        return false;
+    }
+    const Geometry::VertexInput& input = geometry->vertexInput( VERTEX_POSITION );
+    if( !input.m_enabled || (input.m_components < 2) ) {
+        return false;
+    }
+    const SourceBuffer* positions = m_database.library<SourceBuffer>().get( input.m_source_buffer_id );
+    if( (positions == NULL) || (positions->elementType() != ELEMENT_FLOAT) ) {
+        return false;
+    }
+    if( primitives->isIndexed() ) {
+        const SourceBuffer* indices = m_database.library<SourceBuffer>().get( primitives->indexBufferId() );
+        if( (indices == NULL) || (indices->elementType() != ELEMENT_INT) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+OcclusionCuller::project( Rect& rect, const float* clip_from_world ) const
+{
+    const Item& item = m_items[ rect.m_item ];
+    float M[16];
+    clipFromObject( M, clip_from_world, item.m_world_from_object );
+
+    const float* bmin = item.m_bbox_min->floatData();
+    const float* bmax = item.m_bbox_max->floatData();
+    rect.m_valid = false;
+    float x0, y0, x1, y1;
+#ifdef __SSE__
+    // Corners are the transformed min corner plus transformed edges.
+    const __m128 c0 = _mm_loadu_ps( M + 0 );
+    const __m128 c1 = _mm_loadu_ps( M + 4 );
+    const __m128 c2 = _mm_loadu_ps( M + 8 );
+    const __m128 base = _mm_add_ps( _mm_add_ps( _mm_mul_ps( c0, _mm_set1_ps( bmin[0] ) ),
+                                                _mm_mul_ps( c1, _mm_set1_ps( bmin[1] ) ) ),
+                                    _mm_add_ps( _mm_mul_ps( c2, _mm_set1_ps( bmin[2] ) ),
+                                                _mm_loadu_ps( M + 12 ) ) );
+    const __m128 ex = _mm_mul_ps( c0, _mm_set1_ps( bmax[0] - bmin[0] ) );
+    const __m128 ey = _mm_mul_ps( c1, _mm_set1_ps( bmax[1] - bmin[1] ) );
+    const __m128 ez = _mm_mul_ps( c2, _mm_set1_ps( bmax[2] - bmin[2] ) );
+    __m128 h[8];
+    h[0] = base;
+    h[1] = _mm_add_ps( base, ex );
+    h[2] = _mm_add_ps( base, ey );
+    h[3] = _mm_add_ps( h[1], ey );
+    h[4] = _mm_add_ps( base, ez );
+    h[5] = _mm_add_ps( h[1], ez );
+    h[6] = _mm_add_ps( h[2], ez );
+    h[7] = _mm_add_ps( h[3], ez );
+    __m128 w_min = h[0];
+    for( unsigned int c=1; c<8; c++ ) {
+        w_min = _mm_min_ps( w_min, h[c] );
+    }
+    if( _mm_cvtss_f32( _mm_shuffle_ps( w_min, w_min, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) < near_w ) {
+        return;     // crosses the near plane.
+    }
+    __m128 lo = _mm_set1_ps( std::numeric_limits<float>::max() );
+    __m128 hi = _mm_set1_ps( -std::numeric_limits<float>::max() );
+    for( unsigned int c=0; c<8; c++ ) {
+        const __m128 q = _mm_div_ps( h[c], _mm_shuffle_ps( h[c], h[c], _MM_SHUFFLE( 3, 3, 3, 3 ) ) );
+        lo = _mm_min_ps( lo, q );
+        hi = _mm_max_ps( hi, q );
+    }
+    float l[4], u[4];
+    _mm_storeu_ps( l, lo );
+    _mm_storeu_ps( u, hi );
+    x0 = l[0];
+    y0 = l[1];
+    rect.m_z = l[2];
+    x1 = u[0];
+    y1 = u[1];
+#else
+    x0 = std::numeric_limits<float>::max();
+    y0 = std::numeric_limits<float>::max();
+    x1 = -std::numeric_limits<float>::max();
+    y1 = -std::numeric_limits<float>::max();
+    rect.m_z = std::numeric_limits<float>::max();
+    for( unsigned int c=0; c<8; c++ ) {
+        const float p[3] = { (c&1) ? bmax[0] : bmin[0],
+                             (c&2) ? bmax[1] : bmin[1],
+                             (c&4) ? bmax[2] : bmin[2] };
+        float h[4];
+        for( unsigned int i=0; i<4; i++ ) {
+            h[i] = M[i]*p[0] + M[4+i]*p[1] + M[8+i]*p[2] + M[12+i];
+        }
+        if( h[3] < near_w ) {
+            return;     // crosses the near plane.
+        }
+        const float s = 1.f/h[3];
+        x0 = std::min( x0, h[0]*s );
+        x1 = std::max( x1, h[0]*s );
+        y0 = std::min( y0, h[1]*s );
+        y1 = std::max( y1, h[1]*s );
+        rect.m_z = std::min( rect.m_z, h[2]*s );
+    }
+#endif
+    // To pixels, grown by one pixel.
+    const float sx = 0.5f*m_width;
+    const float sy = 0.5f*m_height;
+    rect.m_x0 = static_cast<int>( std::floor( (x0 + 1.f)*sx ) ) - 1;
+    rect.m_x1 = static_cast<int>( std::floor( (x1 + 1.f)*sx ) ) + 1;
+    rect.m_y0 = static_cast<int>( std::floor( (y0 + 1.f)*sy ) ) - 1;
+    rect.m_y1 = static_cast<int>( std::floor( (y1 + 1.f)*sy ) ) + 1;
+    if( (rect.m_x1 < 0) || (rect.m_x0 >= int( m_width )) ||
+        (rect.m_y1 < 0) || (rect.m_y0 >= int( m_height )) )
+    {
+        return;         // off-screen, left to frustum culling.
+    }
+    rect.m_x0 = std::max( 0, rect.m_x0 );
+    rect.m_y0 = std::max( 0, rect.m_y0 );
+    rect.m_x1 = std::min( int( m_width ) - 1, rect.m_x1 );
+    rect.m_y1 = std::min( int( m_height ) - 1, rect.m_y1 );
+    rect.m_valid = true;
+}
+
+void
+OcclusionCuller::occluderTriangles( std::vector<Triangle>&  triangles,
+                                    const Item&             item,
+                                    const float*            clip_from_world ) const
+{
+    const Geometry::VertexInput& input = item.m_geometry->vertexInput( VERTEX_POSITION );
+    const SourceBuffer* position_buffer = m_database.library<SourceBuffer>().get( input.m_source_buffer_id );
+    if( position_buffer == NULL ) {
+        return;
+    }
+    const float* positions = position_buffer->floatData() + input.m_offset;
+    const size_t stride = input.m_stride == 0 ? input.m_components : input.m_stride;
+    const size_t count = item.m_primitives->vertexCount();
+
+    const int* indices = NULL;
+    if( item.m_primitives->isIndexed() ) {
+        const SourceBuffer* index_buffer = m_database.library<SourceBuffer>().get( item.m_primitives->indexBufferId() );
+        if( (index_buffer == NULL) ||
+            (index_buffer->elementCount() < item.m_primitives->indexOffset() + count) )
+        {
+            return;
+        }
+        indices = index_buffer->intData() + item.m_primitives->indexOffset();
+    }
+    if( (input.m_count == 0) ||
+        (input.m_offset + stride*(input.m_count-1) + input.m_components > position_buffer->elementCount()) )
+    {
+        return;
+    }
+
+    float M[16];
+    clipFromObject( M, clip_from_world, item.m_world_from_object );
+    const float sx = 0.5f*m_width;
+    const float sy = 0.5f*m_height;
+    for( size_t t=0; t+3<=count; t+=3 ) {
+        Triangle triangle;
+        triangle.m_z = -std::numeric_limits<float>::max();
+        bool valid = true;
+        for( unsigned int k=0; (k<3) && valid; k++ ) {
+            const size_t v = indices != NULL ? static_cast<size_t>( indices[t+k] ) : t+k;
+            if( v >= input.m_count ) {
+                valid = false;
+                break;
+            }
+            const float* p = positions + stride*v;
+            const float z = input.m_components > 2 ? p[2] : 0.f;
+            float h[4];
+            for( unsigned int i=0; i<4; i++ ) {
+                h[i] = M[i]*p[0] + M[4+i]*p[1] + M[8+i]*z + M[12+i];
+            }
+            if( h[3] < near_w ) {
+                valid = false;  // no clipping, just skip the triangle.
+                break;
+            }
+            const float s = 1.f/h[3];
+            triangle.m_x[k] = (h[0]*s + 1.f)*sx;
+            triangle.m_y[k] = (h[1]*s + 1.f)*sy;
+            triangle.m_z = std::max( triangle.m_z, h[2]*s );
+        }
+        if( valid ) {
+            triangles.push_back( triangle );
+        }
+    }
+}
+
+void
+OcclusionCuller::rasterize( int y0, int y1 )
+{
+    const int W = static_cast<int>( m_width );
+    for( size_t t=0; t<m_triangles.size(); t++ ) {
+        const Triangle& tri = m_triangles[t];
+        float x[3] = { tri.m_x[0], tri.m_x[1], tri.m_x[2] };
+        float y[3] = { tri.m_y[0], tri.m_y[1], tri.m_y[2] };
+
+        // Pixels whose centers may be covered.
+        const int px0 = std::max( 0, static_cast<int>( std::ceil( std::min( x[0], std::min( x[1], x[2] ) ) - 0.5f ) ) );
+        const int px1 = std::min( W-1, static_cast<int>( std::floor( std::max( x[0], std::max( x[1], x[2] ) ) - 0.5f ) ) );
+        const int py0 = std::max( y0, static_cast<int>( std::ceil( std::min( y[0], std::min( y[1], y[2] ) ) - 0.5f ) ) );
+        const int py1 = std::min( y1-1, static_cast<int>( std::floor( std::max( y[0], std::max( y[1], y[2] ) ) - 0.5f ) ) );
+        if( (px0 > px1) || (py0 > py1) ) {
+            continue;
+        }
+
+        // Edge functions, oriented so that the inside is positive.
+        float area = (x[1]-x[0])*(y[2]-y[0]) - (y[1]-y[0])*(x[2]-x[0]);
+        if( area == 0.f ) {
+            continue;
+        }
+        if( area < 0.f ) {
+            std::swap( x[1], x[2] );
+            std::swap( y[1], y[2] );
+        }
+        float dx[3], dy[3], e[3];
+        for( unsigned int k=0; k<3; k++ ) {
+            const unsigned int a = k;
+            const unsigned int b = (k+1)%3;
+            dx[k] = -(y[b]-y[a]);           // change per pixel in x.
+            dy[k] = x[b]-x[a];              // change per pixel in y.
+            const float cx = (px0 & ~3) + 0.5f;
+            const float cy = py0 + 0.5f;
+            e[k] = (x[b]-x[a])*(cy-y[a]) - (y[b]-y[a])*(cx-x[a]);
+        }
+
+        for( int py=py0; py<=py1; py++ ) {
+            float* row = m_depth.data() + static_cast<size_t>( py )*m_width;
+#ifdef __SSE__
+            const __m128 lane = _mm_set_ps( 3.f, 2.f, 1.f, 0.f );
+            __m128 e0 = _mm_add_ps( _mm_set1_ps( e[0] ), _mm_mul_ps( lane, _mm_set1_ps( dx[0] ) ) );
+            __m128 e1 = _mm_add_ps( _mm_set1_ps( e[1] ), _mm_mul_ps( lane, _mm_set1_ps( dx[1] ) ) );
+            __m128 e2 = _mm_add_ps( _mm_set1_ps( e[2] ), _mm_mul_ps( lane, _mm_set1_ps( dx[2] ) ) );
+            const __m128 s0 = _mm_set1_ps( 4.f*dx[0] );
+            const __m128 s1 = _mm_set1_ps( 4.f*dx[1] );
+            const __m128 s2 = _mm_set1_ps( 4.f*dx[2] );
+            const __m128 z = _mm_set1_ps( tri.m_z );
+            const __m128 zero = _mm_setzero_ps();
+            for( int px=(px0 & ~3); px<=px1; px+=4 ) {
+                const __m128 inside = _mm_and_ps( _mm_cmpge_ps( e0, zero ),
+                                                  _mm_and_ps( _mm_cmpge_ps( e1, zero ),
+                                                              _mm_cmpge_ps( e2, zero ) ) );
+                if( _mm_movemask_ps( inside ) != 0 ) {
+                    const __m128 depth = _mm_loadu_ps( row + px );
+                    _mm_storeu_ps( row + px, _mm_or_ps( _mm_and_ps( inside, _mm_min_ps( depth, z ) ),
+                                                        _mm_andnot_ps( inside, depth ) ) );
+                }
+                e0 = _mm_add_ps( e0, s0 );
+                e1 = _mm_add_ps( e1, s1 );
+                e2 = _mm_add_ps( e2, s2 );
+            }
+#else
+            float f[3] = { e[0], e[1], e[2] };
+            for( int px=(px0 & ~3); px<=px1; px++ ) {
+                if( (f[0] >= 0.f) && (f[1] >= 0.f) && (f[2] >= 0.f) ) {
+                    row[px] = std::min( row[px], tri.m_z );
+                }
+                f[0] += dx[0];
+                f[1] += dx[1];
+                f[2] += dx[2];
+            }
+#endif
+            e[0] += dy[0];
+            e[1] += dy[1];
+            e[2] += dy[2];
+        }
+    }
+}
+
+bool
+OcclusionCuller::test( const Rect& rect ) const
+{
+    for( int y=rect.m_y0; y<=rect.m_y1; y++ ) {
+        const float* row = m_depth.data() + static_cast<size_t>( y )*m_width;
+        int x = rect.m_x0;
+#ifdef __SSE__
+        const __m128 z = _mm_set1_ps( rect.m_z );
+        for( ; x+3<=rect.m_x1; x+=4 ) {
+            if( _mm_movemask_ps( _mm_cmpge_ps( _mm_loadu_ps( row + x ), z ) ) != 0 ) {
+                return true;
+            }
+        }
+#endif
+        for( ; x<=rect.m_x1; x++ ) {
+            if( row[x] >= rect.m_z ) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void
+OcclusionCuller::updateView( const View& view, const BoundingVolumeHierarchy* frustum )
+{
+    const float* clip_from_world = view.m_clip_from_world->floatData();
+
+    // Candidates are the items that survived frustum culling.
+    m_rects.clear();
+    for( size_t i=0; i<view.m_items.size(); i++ ) {
+        const uint32_t index = view.m_items[i];
+        const Item& item = m_items[ index ];
+        m_visible[ index ] = (frustum == NULL) || frustum->visible( index ) ? 1 : 0;
+        if( (m_visible[ index ] != 0) && (item.m_bbox_min != NULL) ) {
+            Rect rect;
+            rect.m_item = index;
+            m_rects.push_back( rect );
+        }
+    }
+    if( m_rects.empty() ) {
+        return;
+    }
+    // Every stage is run on the shared pool, but only when it has enough work.
+    ThreadPool& pool = ThreadPool::shared();
+    const size_t rect_threads = m_rects.size() >= parallel_threshold ? m_threads : 1;
+    pool.parallelFor( (m_rects.size() + rect_chunk_size - 1)/rect_chunk_size, rect_threads, [&]( size_t c ) {
+        const size_t end = std::min( m_rects.size(), (c+1)*rect_chunk_size );
+        for( size_t r=c*rect_chunk_size; r<end; r++ ) {
+            project( m_rects[r], clip_from_world );
+        }
+    } );
+
+    // Pick the occluders that cover the most pixels, skipping those whose
+    // triangles are on average smaller than a pixel.
+    auto area = []( const Rect* r ) { return (r->m_x1 - r->m_x0 + 1)*(r->m_y1 - r->m_y0 + 1); };
+    std::vector<const Rect*> occluders;
+    for( size_t r=0; r<m_rects.size(); r++ ) {
+        const Rect& rect = m_rects[r];
+        const Item& item = m_items[ rect.m_item ];
+        const size_t triangles = item.m_primitives != NULL ? item.m_primitives->vertexCount()/3 : 0;
+        if( rect.m_valid && item.m_occluder &&
+            (triangles <= m_max_occluder_triangles) &&
+            (triangles <= static_cast<size_t>( area( &rect ) )) )
+        {
+            occluders.push_back( &rect );
+        }
+    }
+    const size_t K = std::min( m_max_occluders, occluders.size() );
+    std::partial_sort( occluders.begin(), occluders.begin() + K, occluders.end(),
+                       [&area]( const Rect* a, const Rect* b ) { return area( a ) > area( b ); } );
+    occluders.resize( K );
+    if( occluders.empty() ) {
+        return;
+    }
+
+    size_t occluder_work = 0;
+    for( size_t k=0; k<K; k++ ) {
+        occluder_work += m_items[ occluders[k]->m_item ].m_primitives->vertexCount()/3;
+    }
+    std::vector< std::vector<Triangle> > occluder_triangles( K );
+    const size_t occluder_threads = occluder_work >= parallel_threshold ? m_threads : 1;
+    pool.parallelFor( K, occluder_threads, [&]( size_t k ) {
+        occluderTriangles( occluder_triangles[k], m_items[ occluders[k]->m_item ], clip_from_world );
+    } );
+    m_triangles.clear();
+    for( size_t k=0; k<K; k++ ) {
+        m_triangles.insert( m_triangles.end(), occluder_triangles[k].begin(), occluder_triangles[k].end() );
+    }
+    m_last_occluders += K;
+    m_last_triangles += m_triangles.size();
+    if( m_triangles.empty() ) {
+        return;
+    }
+
+    // Rasterize in bands of rows, no two tasks write the same pixel.
+    m_depth.assign( static_cast<size_t>( m_width )*m_height, std::numeric_limits<float>::max() );
+    const int bands = (static_cast<int>( m_height ) + band_rows - 1)/band_rows;
+    const size_t raster_threads = m_triangles.size() >= parallel_threshold ? m_threads : 1;
+    pool.parallelFor( bands, raster_threads, [&]( size_t b ) {
+        rasterize( static_cast<int>( b )*band_rows,
+                   std::min( static_cast<int>( m_height ), static_cast<int>( b+1 )*band_rows ) );
+    } );
+
+    pool.parallelFor( (m_rects.size() + rect_chunk_size - 1)/rect_chunk_size, rect_threads, [&]( size_t c ) {
+        const size_t end = std::min( m_rects.size(), (c+1)*rect_chunk_size );
+        for( size_t r=c*rect_chunk_size; r<end; r++ ) {
+            if( m_rects[r].m_valid && !test( m_rects[r] ) ) {
+                m_visible[ m_rects[r].m_item ] = 0;
+            }
+        }
+    } );
+    for( size_t r=0; r<m_rects.size(); r++ ) {
+        m_culled_items += m_visible[ m_rects[r].m_item ] == 0 ? 1 : 0;
+    }
+}
+
+void
+OcclusionCuller::update( const BoundingVolumeHierarchy* frustum )
+{
+    SCENE_PROFILE_SCOPE( "OcclusionCuller::update" );
+    static const Logger log = getLogger( package + ".update" );
+    if( (frustum != NULL) && (frustum->items() != m_items.size()) ) {
+        SCENELOG_ERROR( log, "Frustum culling has " << frustum->items() << " items, expected " << m_items.size() << "." );
+        frustum = NULL;
+    }
+
+    m_culled_items = 0;
+    m_last_occluders = 0;
+    m_last_triangles = 0;
+    for( size_t i=0; i<m_unbounded.size(); i++ ) {
+        const uint32_t index = m_unbounded[i];
+        m_visible[ index ] = (frustum == NULL) || frustum->visible( index ) ? 1 : 0;
+    }
+    for( size_t v=0; v<m_views.size(); v++ ) {
+        updateView( m_views[v], frustum );
+    }
+
+    m_visible_items = 0;
+    for( size_t i=0; i<m_visible.size(); i++ ) {
+        m_visible_items += m_visible[i];
+    }
+    SCENE_PROFILE_COUNT( "OcclusionCuller.update.culled", m_culled_items );
+    SCENE_PROFILE_COUNT( "OcclusionCuller.update.triangles", m_last_triangles );
+}
+
+    } // of namespace Runtime
+} // of namespace Scene
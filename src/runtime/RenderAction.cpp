@@ -16,7 +16,9 @@
  * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-
+#include <new>
+#include <cstring>
+#include <algorithm>
 #include "scene/Log.hpp"
 #include "scene/SourceBuffer.hpp"
 #include "scene/DataBase.hpp"
@@ -35,79 +37,272 @@ unsigned int RenderAction::m_serial_no_counter = 0;
 
 static const string package = "Scene.Runtime.RenderAction";
 
-RenderAction::RenderAction( const Type type, const std::string id )
+RenderActionArena::RenderActionArena()
+    : m_current( 0 ),
+      m_offset( 0 ),
+      m_in_use( 0 )
+{
+}
+
+void*
+RenderActionArena::allocate( size_t bytes )
+{
+    // Keep every allocation 16-byte aligned, blocks come from new[] which
+    // gives at least that.
+    static const size_t block_size = 64*1024;
+    bytes = roundUp( bytes );
+
+    auto f = m_free.find( bytes );
+    if( (f != m_free.end()) && !f->second.empty() ) {
+        void* p = f->second.back();
+        f->second.pop_back();
+        m_in_use += bytes;
+        return p;
+    }
+
+    while( (m_current < m_blocks.size()) && (m_blocks[m_current].m_size < m_offset + bytes) ) {
+        m_current++;
+        m_offset = 0;
+    }
+    if( m_current == m_blocks.size() ) {
+        Block block;
+        block.m_size = std::max( block_size, bytes );
+        block.m_memory.reset( new unsigned char[ block.m_size ] );
+        m_blocks.push_back( std::move( block ) );
+        m_offset = 0;
+    }
+    void* p = m_blocks[m_current].m_memory.get() + m_offset;
+    m_offset += bytes;
+    m_in_use += bytes;
+    return p;
+}
+
+void
+RenderActionArena::release( const void* p, size_t bytes )
+{
+    if( (p == NULL) || (bytes == 0) ) {
+        return;
+    }
+    bytes = roundUp( bytes );
+    m_released.push_back( std::make_pair( bytes, const_cast<void*>( p ) ) );
+    m_in_use -= bytes;
+}
+
+void
+RenderActionArena::recycle()
+{
+    for( auto it=m_released.begin(); it!=m_released.end(); ++it ) {
+        m_free[ it->first ].push_back( it->second );
+    }
+    m_released.clear();
+}
+
+void
+RenderActionArena::reset()
+{
+    m_current = 0;
+    m_offset = 0;
+    m_in_use = 0;
+    m_released.clear();
+    m_free.clear();
+}
+
+size_t
+RenderActionArena::bytesReserved() const
+{
+    size_t bytes = 0;
+    for( auto it=m_blocks.begin(); it!=m_blocks.end(); ++it ) {
+        bytes += it->m_size;
+    }
+    return bytes;
+}
+
+// Sampler unit values referenced by SetSamplers, shared between all actions
+// so that the actions don't own any values themselves.
+static const Value*
+samplerUnitValue( size_t unit )
+{
+    static const size_t units = 32;
+    static const std::vector<Value> values = []() {
+        std::vector<Value> v;
+        for( size_t i=0; i<units; i++ ) {
+            v.push_back( Value::createInt( static_cast<int>( i ) ) );
+        }
+        return v;
+    }();
+    return unit < units ? &values[unit] : NULL;
+}
+
+RenderAction::RenderAction( const Type type, const char* id )
     : m_type( type ),
       m_id( id ),
       m_serial_no( m_serial_no_counter++ )
 {
     m_timestamp.touch();
+    switch( m_type ) {
+    case ACTION_SET_VIEW_COORDSYS:
+        m_set_view = NULL;
+        break;
+    case ACTION_SET_LOCAL_COORDSYS:
+        new (&m_set_local) SetLocalCoordSys();
+        break;
+    case ACTION_SET_PASS:
+        new (&m_set_pass) SetPass();
+        break;
+    case ACTION_SET_INPUTS:
+        new (&m_set_inputs) SetInputs();
+        break;
+    case ACTION_SET_FRAMEBUFFER:
+        new (&m_set_render_targets) SetRenderTargets();
+        break;
+    case ACTION_SET_UNIFORMS:
+        new (&m_set_uniforms) SetUniforms();
+        break;
+    case ACTION_SET_SAMPLERS:
+        new (&m_set_samplers) SetSamplers();
+        break;
+    case ACTION_SET_FB_CTRL:
+        new (&m_set_fb_ctrl) SetFBCtrl();
+        break;
+    case ACTION_SET_PIXEL_OPS:
+        new (&m_set_pixel_ops) SetPixelOps();
+        break;
+    case ACTION_SET_RASTER:
+        new (&m_set_rasterization) SetRaster();
+        break;
+    case ACTION_DRAW:
+        new (&m_draw) Draw();
+        break;
+    case ACTION_DRAW_INDEXED:
+        new (&m_draw_indexed) DrawIndexed();
+        break;
+    }
 }
 
 RenderAction*
-RenderAction::createSetLocalCoordSys( const std::list<const Node*>&  node_path )
+RenderAction::create( RenderActionArena& arena, const Type type, const std::string& id )
 {
-    RenderAction* action = new RenderAction( RenderAction::ACTION_SET_LOCAL_COORDSYS, "" );
+    const char* key = "";
+    if( !id.empty() ) {
+        char* copy = arena.allocateArray<char>( id.size() + 1 );
+        std::copy( id.begin(), id.end(), copy );
+        copy[ id.size() ] = '\0';
+        key = copy;
+    }
+    return new ( arena.allocate( sizeof(RenderAction) ) ) RenderAction( type, key );
+}
 
-    size_t i=0;
-    for( auto it=node_path.begin(); it!=node_path.end(); ++it ) {
-        if( i < SCENE_PATH_MAX ) {
-            action->m_set_local.m_node_path[ i++ ] = *it;
-        }
-        else {
-            Logger log = getLogger( package + ".createSetLocalCoordSys" );
-            SCENELOG_ERROR( log, "Node path larger than SCENE_PATH_MAX." );
-            break;
-        }
+void
+RenderAction::release( RenderActionArena& arena, const RenderAction* action )
+{
+    if( action == NULL ) {
+        return;
+    }
+    if( action->m_id[0] != '\0' ) {
+        arena.release( action->m_id, std::strlen( action->m_id ) + 1 );
+    }
+    switch( action->m_type ) {
+    case ACTION_SET_VIEW_COORDSYS:
+        arena.release( action->m_set_view, sizeof(SetViewCoordSys) );
+        break;
+    case ACTION_SET_INPUTS:
+        arena.release( action->m_set_inputs.m_items.m_data,
+                       sizeof(SetInputs::Item)*action->m_set_inputs.m_items.size() );
+        break;
+    case ACTION_SET_FRAMEBUFFER:
+        arena.release( action->m_set_render_targets.m_items.m_data,
+                       sizeof(SetRenderTargets::Item)*action->m_set_render_targets.m_items.size() );
+        break;
+    case ACTION_SET_UNIFORMS:
+        arena.release( action->m_set_uniforms.m_items.m_data,
+                       sizeof(SetUniforms::Item)*action->m_set_uniforms.m_items.size() );
+        break;
+    case ACTION_SET_SAMPLERS:
+        arena.release( action->m_set_samplers.m_items.m_data,
+                       sizeof(SetSamplers::Item)*action->m_set_samplers.m_items.size() );
+        break;
+    default:
+        break;
     }
-    for( ; i< SCENE_PATH_MAX; i++ ) {
-        action->m_set_local.m_node_path[ i ] = NULL;
+    arena.release( action, sizeof(RenderAction) );
+}
+
+RenderAction*
+RenderAction::createSetLocalCoordSys( RenderActionArena&             arena,
+                                      const std::list<const Node*>&  node_path )
+{
+    const Node* path[ SCENE_PATH_MAX+1 ];
+    size_t length = 0;
+    for( auto it=node_path.begin(); (it!=node_path.end()) && (length <= SCENE_PATH_MAX); ++it ) {
+        path[ length++ ] = *it;
     }
+    return createSetLocalCoordSys( arena, path, length );
+}
+
+RenderAction*
+RenderAction::createSetLocalCoordSys( RenderActionArena&  arena,
+                                      const Node* const*  node_path,
+                                      size_t              node_path_length )
+{
+    RenderAction* action = create( arena, RenderAction::ACTION_SET_LOCAL_COORDSYS, "" );
+
+    if( node_path_length > SCENE_PATH_MAX ) {
+        static const Logger log = getLogger( package + ".createSetLocalCoordSys" );
+        SCENELOG_ERROR( log, "Node path larger than SCENE_PATH_MAX." );
+        node_path_length = SCENE_PATH_MAX;
+    }
+    std::copy_n( node_path, node_path_length, action->m_set_local.m_node_path );
+    std::fill( action->m_set_local.m_node_path + node_path_length,
+               action->m_set_local.m_node_path + SCENE_PATH_MAX,
+               static_cast<const Node*>( NULL ) );
 
     return action;
 }
 
 
 RenderAction*
-RenderAction::createSetViewCoordSys( const Camera*                  camera,
+RenderAction::createSetViewCoordSys( RenderActionArena&             arena,
+                                     const Camera*                  camera,
                                      const std::list<const Node*>&  camera_path,
                                      const Light*                   (&lights)[SCENE_LIGHTS_MAX],
                                      const Camera*                  (&light_projections)[SCENE_LIGHTS_MAX],
                                      const std::list<const Node*>   (&light_paths)[SCENE_LIGHTS_MAX] )
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.createSetView" );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.createSetView" );
 
 
-    RenderAction* action = new RenderAction( RenderAction::ACTION_SET_VIEW_COORDSYS, "" );
+    RenderAction* action = create( arena, RenderAction::ACTION_SET_VIEW_COORDSYS, "" );
+    action->m_set_view = new ( arena.allocate( sizeof(SetViewCoordSys) ) ) SetViewCoordSys();
 
-    action->m_set_view.m_camera = camera;
+    action->m_set_view->m_camera = camera;
     size_t i=0;
     for(auto it=camera_path.begin(); it!=camera_path.end(); ++it ) {
         if( i < SCENE_PATH_MAX ) {
-            action->m_set_view.m_camera_path[i++] = *it;
+            action->m_set_view->m_camera_path[i++] = *it;
         }
         else {
             SCENELOG_ERROR( log, "Camera node path larger than SCENE_PATH_MAX" );
         }
     }
     for( ; i<SCENE_PATH_MAX; i++ ) {
-        action->m_set_view.m_camera_path[i] = NULL;
+        action->m_set_view->m_camera_path[i] = NULL;
     }
 
     for( size_t j=0; j<SCENE_LIGHTS_MAX; j++ ) {
-        action->m_set_view.m_lights[j] = lights[j];
-        action->m_set_view.m_light_projections[j] = light_projections[j];
+        action->m_set_view->m_lights[j] = lights[j];
+        action->m_set_view->m_light_projections[j] = light_projections[j];
 
         size_t i=0;
         for(auto it=light_paths[j].begin(); it!=light_paths[j].end(); ++it ) {
             if( i < SCENE_PATH_MAX ) {
-                action->m_set_view.m_light_paths[j][i++] = *it;
+                action->m_set_view->m_light_paths[j][i++] = *it;
             }
             else {
                 SCENELOG_ERROR( log, "Light " << j << " node path larger than SCENE_PATH_MAX" );
             }
         }
         for( ; i<SCENE_PATH_MAX; i++ ) {
-            action->m_set_view.m_light_paths[j][i] = NULL;
+            action->m_set_view->m_light_paths[j][i] = NULL;
         }
     }
 
@@ -115,14 +310,15 @@ RenderAction::createSetViewCoordSys( const Camera*                  camera,
 }
 
 RenderAction*
-RenderAction::createDraw( const std::string&    id,
+RenderAction::createDraw( RenderActionArena&    arena,
+                          const std::string&    id,
                           const Geometry*       geometry,
                           const Primitives*     primitives,
                           const Pass*           pass )
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.createDraw" );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.createDraw" );
 
-    RenderAction* action = new RenderAction( RenderAction::ACTION_DRAW, id );
+    RenderAction* action = create( arena, RenderAction::ACTION_DRAW, id );
     action->m_draw.m_geometry = geometry;
     action->m_draw.m_primitives = primitives;
 
@@ -155,7 +351,6 @@ RenderAction::createDraw( const std::string&    id,
         break;
     case PRIMITIVE_N:
         SCENELOG_ERROR( log, "Illegal primitive encountered." );
-        delete action;
         return NULL;
     }
     action->m_draw.m_first    = 0;
@@ -169,13 +364,14 @@ RenderAction::createDraw( const std::string&    id,
 }
 
 RenderAction*
-RenderAction::createDrawIndexed( const DataBase&     database,
+RenderAction::createDrawIndexed( RenderActionArena&  arena,
+                                 const DataBase&     database,
                                  const std::string&  id,
                                  const Geometry*     geometry,
                                  const Primitives*   primitives,
                                  const Pass*         pass )
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.createDrawIndexd" );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.createDrawIndexd" );
 
     const SourceBuffer* index_buffer = database.library<SourceBuffer>().get( primitives->indexBufferId() );
     if( index_buffer == NULL ) {
@@ -183,7 +379,7 @@ RenderAction::createDrawIndexed( const DataBase&     database,
         return NULL;
     }
 
-    RenderAction* action = new RenderAction( RenderAction::ACTION_DRAW_INDEXED, id );
+    RenderAction* action = create( arena, RenderAction::ACTION_DRAW_INDEXED, id );
     action->m_draw_indexed.m_index_buffer = index_buffer;
     action->m_draw_indexed.m_geometry = geometry;
     action->m_draw_indexed.m_primitives = primitives;
@@ -192,7 +388,6 @@ RenderAction::createDrawIndexed( const DataBase&     database,
     switch( index_buffer->elementType() ) {
     case ELEMENT_FLOAT:
         SCENELOG_ERROR( log, "Unsupported index element type float." );
-        delete action;
         return NULL;
     case ELEMENT_INT:
         action->m_draw_indexed.m_type = GL_UNSIGNED_INT;
@@ -228,7 +423,6 @@ RenderAction::createDrawIndexed( const DataBase&     database,
         break;
     case PRIMITIVE_N:
         SCENELOG_ERROR( log, "Illegal primitive encountered." );
-        delete action;
         return NULL;
     }
     action->m_draw_indexed.m_offset   = reinterpret_cast<GLvoid*>( size*primitives->indexOffset() );
@@ -241,27 +435,30 @@ RenderAction::createDrawIndexed( const DataBase&     database,
     return action;
 }
 RenderAction*
-RenderAction::createSetPass( const std::string&  id,
+RenderAction::createSetPass( RenderActionArena&  arena,
+                             const std::string&  id,
                              const Pass*         pass )
 {
-    RenderAction* action = new RenderAction( RenderAction::ACTION_SET_PASS, id );
+    RenderAction* action = create( arena, RenderAction::ACTION_SET_PASS, id );
     action->m_set_pass.m_pass = pass;
     return action;
 }
 
 RenderAction*
-RenderAction::createSetInputs( const DataBase&                database,
+RenderAction::createSetInputs( RenderActionArena&             arena,
+                               const DataBase&                database,
                                const std::string&             id,
                                const Pass*                    pass,
                                const Geometry*                geometry,
                                const Primitives*  primitives )
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.createSetInputs" );
-    RenderAction* action = new RenderAction( ACTION_SET_INPUTS, id );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.createSetInputs" );
+    RenderAction* action = create( arena, ACTION_SET_INPUTS, id );
 
     action->m_set_inputs.m_pass = pass;
     action->m_set_inputs.m_primitives = primitives;
-    action->m_set_inputs.m_items.resize( pass->attributes() );
+    action->m_set_inputs.m_items.m_size = pass->attributes();
+    action->m_set_inputs.m_items.m_data = arena.allocateArray<SetInputs::Item>( pass->attributes() );
     for(size_t i=0; i<action->m_set_inputs.m_items.size(); i++) {
         const VertexSemantic semantic = pass->attributeSemantic( i );
         const Geometry::VertexInput& input = geometry->vertexInput( semantic );
@@ -285,19 +482,18 @@ RenderAction::createSetInputs( const DataBase&                database,
 }
 
 RenderAction*
-RenderAction::createSetSamplers( const DataBase&        database,
+RenderAction::createSetSamplers( RenderActionArena&     arena,
+                                 const DataBase&        database,
                                  const std::string&     id,
                                  const ResolvedParams*  params,
                                  const Pass*            passt )
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.createSetSamplers" );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.createSetSamplers" );
     SCENELOG_TRACE( log, "params=" << params );
 
-    RenderAction* action = new RenderAction( RenderAction::ACTION_SET_SAMPLERS, id );
-
     const Pass* pass = params->m_pass;
 
-    action->m_set_samplers.m_pass = pass;
+    std::vector<SetSamplers::Item> items;
 
 
     for( size_t i=0; i<pass->uniforms(); i++ ) {
@@ -317,7 +513,6 @@ RenderAction::createSetSamplers( const DataBase&        database,
         }
         if( value == NULL ) {
             SCENELOG_ERROR( log, "No value given for uniform symbol '" << pass->uniformSymbol(i) << "' " );
-            delete action;
             return NULL;
         }
 
@@ -347,40 +542,46 @@ RenderAction::createSetSamplers( const DataBase&        database,
             {
                 SCENELOG_ERROR( log, "Image and sampler types unsupported." );
             }
+            else if( samplerUnitValue( items.size() ) == NULL ) {
+                SCENELOG_ERROR( log, "Too many samplers, ignoring '" << image_id << '\'' );
+            }
             else {
-                size_t sampler = action->m_set_samplers.m_items.size();
-                action->m_set_samplers.m_items.resize( sampler + 1 );
-                action->m_set_samplers.m_items.back().m_image = image;
-                action->m_set_samplers.m_items.back().m_wrap_s = value->samplerWrapS();
-                action->m_set_samplers.m_items.back().m_wrap_t = value->samplerWrapT();
-                action->m_set_samplers.m_items.back().m_wrap_p = value->samplerWrapP();
-                action->m_set_samplers.m_items.back().m_min_filter = value->samplerMinFilter();
-                action->m_set_samplers.m_items.back().m_mag_filter = value->samplerMagFilter();
-                action->m_set_samplers.m_items.back().m_uniform_value = Value::createInt( sampler );
+                SetSamplers::Item item;
+                item.m_image = image;
+                item.m_wrap_s = value->samplerWrapS();
+                item.m_wrap_t = value->samplerWrapT();
+                item.m_wrap_p = value->samplerWrapP();
+                item.m_min_filter = value->samplerMinFilter();
+                item.m_mag_filter = value->samplerMagFilter();
+                item.m_uniform_value = samplerUnitValue( items.size() );
+                items.push_back( item );
             }
         }
     }
 
-    if( action->m_set_samplers.m_items.empty() ) {
-        delete action;
+    if( items.empty() ) {
         return NULL;
     }
-    else {
-        return action;
-    }
+    RenderAction* action = create( arena, RenderAction::ACTION_SET_SAMPLERS, id );
+    action->m_set_samplers.m_pass = pass;
+    action->m_set_samplers.m_items.m_size = items.size();
+    action->m_set_samplers.m_items.m_data = arena.allocateArray<SetSamplers::Item>( items.size() );
+    std::copy( items.begin(), items.end(), action->m_set_samplers.m_items.m_data );
+    return action;
 }
 
 RenderAction*
-RenderAction::createSetRenderTarget( const DataBase&        database,
+RenderAction::createSetRenderTarget( RenderActionArena&     arena,
+                                     const DataBase&        database,
                                      const std::string&     id,
                                      const ResolvedParams*  params,
                                      const Pass*            pass )
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.createSetRenderTarget" );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.createSetRenderTarget" );
 
 
     if( params == NULL || pass == NULL ) {
-        RenderAction* action = new RenderAction( ACTION_SET_FRAMEBUFFER, id );
+        RenderAction* action = create( arena, ACTION_SET_FRAMEBUFFER, id );
         return action;
     }
 
@@ -472,8 +673,10 @@ RenderAction::createSetRenderTarget( const DataBase&        database,
         }
     }
 
-    RenderAction* action = new RenderAction( ACTION_SET_FRAMEBUFFER, id );
-    action->m_set_render_targets.m_items.swap( items );
+    RenderAction* action = create( arena, ACTION_SET_FRAMEBUFFER, id );
+    action->m_set_render_targets.m_items.m_size = items.size();
+    action->m_set_render_targets.m_items.m_data = arena.allocateArray<SetRenderTargets::Item>( items.size() );
+    std::copy( items.begin(), items.end(), action->m_set_render_targets.m_items.m_data );
     action->m_set_render_targets.m_clear_mask = GL_COLOR_BUFFER_BIT;
     return action;
 }
@@ -481,15 +684,17 @@ RenderAction::createSetRenderTarget( const DataBase&        database,
 
 
 RenderAction*
-RenderAction::createSetUniforms( const std::string&                id,
+RenderAction::createSetUniforms( RenderActionArena&                arena,
+                                 const std::string&                id,
                                  const RenderAction*               set_samplers,
                                  const ResolvedParams*             params,
                                  const Pass*                       pass )
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.createSetUniforms" );
-    RenderAction* action = new RenderAction( RenderAction::ACTION_SET_UNIFORMS, id );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.createSetUniforms" );
+    RenderAction* action = create( arena, RenderAction::ACTION_SET_UNIFORMS, id );
     action->m_set_uniforms.m_pass = pass;
-    action->m_set_uniforms.m_items.resize( pass->uniforms() );
+    action->m_set_uniforms.m_items.m_size = pass->uniforms();
+    action->m_set_uniforms.m_items.m_data = arena.allocateArray<SetUniforms::Item>( pass->uniforms() );
 
 
     // Run through the uniforms of the pass program. They can either have a
@@ -516,7 +721,6 @@ RenderAction::createSetUniforms( const std::string&                id,
 
         if( value == NULL ) {
             SCENELOG_ERROR( log, "No value given for uniform symbol '" << pass->uniformSymbol(i) << "' " );
-            delete action;
             return NULL;
         }
 
@@ -553,7 +757,7 @@ RenderAction::createSetUniforms( const std::string&                id,
                     const Image* image = set_samplers->m_set_samplers.m_items[k].m_image;
                     if( value->samplerInstanceImage() == image->id() ) {
 
-                        value = &set_samplers->m_set_samplers.m_items[k].m_uniform_value;
+                        value = set_samplers->m_set_samplers.m_items[k].m_uniform_value;
 
 
                         break;
@@ -573,12 +777,13 @@ RenderAction::createSetUniforms( const std::string&                id,
 
 
 RenderAction*
-RenderAction::createSetFBCtrl( const std::string&     id,
+RenderAction::createSetFBCtrl( RenderActionArena&     arena,
+                               const std::string&     id,
                                const ResolvedParams*  params,
                                const Pass*            pass )
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.createSetFBCtrl" );
-    RenderAction* action = new RenderAction( ACTION_SET_FB_CTRL, id );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.createSetFBCtrl" );
+    RenderAction* action = create( arena, ACTION_SET_FB_CTRL, id );
 
     action->m_set_fb_ctrl.m_color_writemask[0] = GL_TRUE;
     action->m_set_fb_ctrl.m_color_writemask[1] = GL_TRUE;
@@ -622,7 +827,6 @@ RenderAction::createSetFBCtrl( const std::string&     id,
         }
 
         if( !touched ) {
-            delete action;
             action = NULL;
         }
     }
@@ -630,12 +834,13 @@ RenderAction::createSetFBCtrl( const std::string&     id,
 }
 
 RenderAction*
-RenderAction::createSetRaster( const std::string&     id,
+RenderAction::createSetRaster( RenderActionArena&     arena,
+                               const std::string&     id,
                                const ResolvedParams*  params,
                                const Pass*            pass )
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.createSetRaster" );
-    RenderAction* action = new RenderAction( ACTION_SET_RASTER, id );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.createSetRaster" );
+    RenderAction* action = create( arena, ACTION_SET_RASTER, id );
 
     action->m_set_rasterization.m_point_size = 1.f;
     action->m_set_rasterization.m_cull_face = GL_FALSE;
@@ -744,7 +949,6 @@ RenderAction::createSetRaster( const std::string&     id,
         }
 
         if( !touched ) {
-            delete action;
             action = NULL;
         }
     }
@@ -753,13 +957,14 @@ RenderAction::createSetRaster( const std::string&     id,
 
 
 RenderAction*
-RenderAction::createSetPixelOps( const std::string&     id,
+RenderAction::createSetPixelOps( RenderActionArena&     arena,
+                                 const std::string&     id,
                                  const ResolvedParams*  params,
                                  const Pass*            pass )
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.createSetPixelOps" );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.createSetPixelOps" );
 
-    RenderAction* action = new RenderAction( ACTION_SET_PIXEL_OPS, id );
+    RenderAction* action = create( arena, ACTION_SET_PIXEL_OPS, id );
 
     action->m_set_pixel_ops.m_depth_test = GL_FALSE;
     action->m_set_pixel_ops.m_depth_func = GL_LESS;
@@ -823,7 +1028,6 @@ RenderAction::createSetPixelOps( const std::string&     id,
             }
         }
         if( !touched ) {
-            delete action;
             action = NULL;
         }
     }
@@ -835,7 +1039,7 @@ RenderAction::createSetPixelOps( const std::string&     id,
 void
 RenderAction::debugDump() const
 {
-    Logger log = getLogger( "Scene.Runtime.RenderAction.debugDump" );
+    static const Logger log = getLogger( "Scene.Runtime.RenderAction.debugDump" );
 
     switch( m_type ) {
     case ACTION_SET_VIEW_COORDSYS:
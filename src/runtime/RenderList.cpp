@@ -26,10 +26,13 @@
 #include "scene/VisualScene.hpp"
 #include "scene/Geometry.hpp"
 #include "scene/Material.hpp"
+#include "scene/Effect.hpp"
 #include "scene/InstanceGeometry.hpp"
 #include "scene/SourceBuffer.hpp"
 #include "scene/runtime/RenderList.hpp"
+#include "scene/runtime/ThreadPool.hpp"
 #include "scene/runtime/TransformCache.hpp"
+#include "scene/Profiler.hpp"
 
 namespace Scene {
     namespace Runtime {
@@ -43,11 +46,107 @@ namespace Scene {
 
 static const string package = "Scene.Runtime.RenderList";
 
+namespace {
+
+/** Split the node hierarchy until there are this many tasks per thread. */
+const size_t tasks_per_thread = 8;
+
+/** Max number of hierarchy levels to split. */
+const unsigned int max_split_levels = 8;
+
+/** True if two view coordinate systems refer to the same camera and lights. */
+bool
+sameView( const SetViewCoordSys* a, const SetViewCoordSys* b )
+{
+    if( a->m_camera != b->m_camera ) {
+        return false;
+    }
+    if( !std::equal( a->m_camera_path, a->m_camera_path + SCENE_PATH_MAX, b->m_camera_path ) ) {
+        return false;
+    }
+    for( size_t j=0; j<SCENE_LIGHTS_MAX; j++ ) {
+        if( (a->m_lights[j] != b->m_lights[j]) ||
+            (a->m_light_projections[j] != b->m_light_projections[j]) ||
+            !std::equal( a->m_light_paths[j], a->m_light_paths[j] + SCENE_PATH_MAX, b->m_light_paths[j] ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** The actions of an item, items with equal keys are identical. */
+CacheKey<12>
+itemKey( const RenderList::Item& item )
+{
+    CacheKey<12> key;
+    key[0] = item.m_action_set_framebuffer;
+    key[1] = item.m_action_set_pass;
+    key[2] = item.m_action_set_input;
+    key[3] = item.m_action_set_uniform;
+    key[4] = item.m_action_set_samplers;
+    key[5] = item.m_set_raster;
+    key[6] = item.m_set_pixel_ops;
+    key[7] = item.m_set_fb_ctrl;
+    key[8] = item.m_set_local_coordsys;
+    key[9] = item.m_set_view_coordsys;
+    key[10] = item.m_draw;
+    key[11] = item.m_draw_indexed;
+    return key;
+}
+
+/** True if the changes of a library since a render list was built can't
+  * affect the items of the list.
+  *
+  * Items only refer to objects that existed when they were added, unless an
+  * object wasn't found and is added later. So changes to objects added since
+  * are harmless, and so are changes to the contents of other objects if the
+  * items refer to them by pointer and contents is true.
+  */
+template<class T>
+bool
+harmlessChanges( const Library<T>& library, const SeqPos& since, bool unresolved, bool contents )
+{
+    std::vector<typename Library<T>::Change> changes;
+    if( !library.changesSince( changes, since ) ) {
+        return false;
+    }
+    std::unordered_set<Identifiable::Id> added;
+    for( auto it=changes.begin(); it!=changes.end(); ++it ) {
+        if( it->m_kind == CHANGE_ADDED ) {
+            added.insert( it->m_identity );
+        }
+    }
+    if( unresolved && !added.empty() ) {
+        return false;
+    }
+    for( auto it=changes.begin(); it!=changes.end(); ++it ) {
+        if( (it->m_kind == CHANGE_REMOVED) ||
+            ((it->m_kind == CHANGE_STRUCTURE) && !contents && (added.count( it->m_identity ) == 0)) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // of anonymous namespace
+
+const size_t RenderList::npos;
 
 RenderList::RenderList( Resolver& resolver )
-    : m_resolver( resolver )
+    : m_resolver( resolver ),
+      m_threads( 1 ),
+      m_patched( false ),
+      m_patch_actions( 0 ),
+      m_root( NULL ),
+      m_unresolved( false ),
+      m_traversed_items( 0 )
 {
     m_list_created.invalidate();
+#ifdef SCENE_USE_THREADS
+    m_threads = ThreadPool::hardwareThreads();
+#endif
 }
 
 
@@ -55,17 +154,27 @@ bool
 RenderList::build( const std::string& visual_scene_id )
 {
     //Logger log = getLogger( package + ".build" );
+    SCENE_PROFILE_SCOPE( "RenderList::build" );
 
     bool rebuilt = false;
 
-    if( (visual_scene_id != m_visual_scene) ||
-        !m_list_created.asRecentAs( m_resolver.database().structureChanged() ) )
-    {
+    if( visual_scene_id != m_visual_scene ) {
     //if( visual_scene_id != m_visual_scene || m_resolver.database().asset().majorChanges( m_list_created ) ) {
         m_visual_scene = visual_scene_id;
         rebuild();
         rebuilt = true;
     }
+    else if( !m_list_created.asRecentAs( m_resolver.database().structureChanged() ) ) {
+        if( patchable() ) {
+            if( !patchFromJournal() ) {
+                patch();
+            }
+        }
+        else {
+            rebuild();
+        }
+        rebuilt = true;
+    }
 
     return rebuilt;
 }
@@ -73,9 +182,19 @@ RenderList::build( const std::string& visual_scene_id )
 void
 RenderList::clear()
 {
-    Logger log = getLogger( package + ".clear" );
+    static const Logger log = getLogger( package + ".clear" );
     SCENELOG_DEBUG( log, "invoked" );
     m_operations.clear();
+    m_items.clear();
+    m_previous_index.clear();
+    m_views.clear();
+    m_renders.clear();
+    m_view_items.clear();
+    m_traversals.clear();
+    m_instanced_nodes.clear();
+    m_root = NULL;
+    m_unresolved = false;
+    m_traversed_items = 0;
     SCENELOG_DEBUG( log, m_list_created.debugString() );
     m_list_created.invalidate();
     SCENELOG_DEBUG( log, m_list_created.debugString() );
@@ -87,7 +206,7 @@ bool
 RenderList::boundingBox( Value& min, Value& max )
 {
 
-    Logger log = getLogger( package + ".boundingBox" );
+    static const Logger log = getLogger( package + ".boundingBox" );
 
     struct Instance {
         const Geometry* m_geometry;
@@ -171,26 +290,377 @@ RenderList::boundingBox( Value& min, Value& max )
 void
 RenderList::rebuild( )
 {
-    Logger log = getLogger( package + ".rebuild" );
+    static const Logger log = getLogger( package + ".rebuild" );
+    SCENE_PROFILE_SCOPE( "RenderList::rebuild" );
 
     SCENELOG_DEBUG( log, "Rebuilding," );
 
     m_resolver.purge();
-    m_operations.clear();
-    m_items.clear();
+    m_views.clear();
+    m_previous_views.clear();
+    m_patch_actions = 0;
+    m_patched = false;
+
+    const bool populated = populate();
+    m_previous_index.assign( m_items.size(), npos );
+    if( !populated ) {
+        return;
+    }
+    m_list_created.touch();
+    dumpRenderList();
+    SCENE_PROFILE_COUNT( "RenderList.rebuilds", 1 );
+    SCENE_PROFILE_COUNT( "RenderList.items", m_items.size() );
 
+    SCENELOG_DEBUG( log, "# items in render list = " << m_operations.size() );
+}
 
-    m_set_framebuffer_current = NULL;
-    m_set_pass_current = NULL;
-    m_set_input_current = NULL;
-    m_set_uniform_current = NULL;
-    m_set_samplers_current = NULL;
-    m_set_local_current = NULL;
-    m_set_raster_current = NULL;
-    m_set_pixel_ops_current = NULL;
-    m_set_fb_ctrl_current = NULL;
-    m_set_transforms_current = NULL;
+bool
+RenderList::patchable() const
+{
+    if( m_items.empty() || (m_items.size() < m_patch_actions) ) {
+        return false;
+    }
+    return m_list_created.asRecentAs( m_resolver.database().objectsRemoved() );
+}
+
+void
+RenderList::patch()
+{
+    static const Logger log = getLogger( package + ".patch" );
+    SCENE_PROFILE_SCOPE( "RenderList::patch" );
+
+    std::vector<Item> previous;
+    previous.swap( m_items );
+    m_previous_views.swap( m_views );
+    m_views.clear();
+
+    const bool populated = populate();
+    m_previous_views.clear();
+    if( !populated ) {
+        m_patched = false;
+        m_previous_index.clear();
+        return;
+    }
+
+    m_previous_index.clear();
+    const size_t retained = matchItems( previous, 0, previous.size() );
+    // Local coordinate systems of new items and the new views are left in
+    // the resolver until the next rebuild.
+    m_patch_actions += (m_items.size() - retained) + m_views.size();
+
+    // The previous items are no longer compared against, so the memory of
+    // actions replaced during this patch may be reused.
+    m_resolver.recycle();
+
+    m_patched = true;
+    m_list_created.touch();
+    dumpRenderList();
+    SCENE_PROFILE_COUNT( "RenderList.patches", 1 );
+    SCENE_PROFILE_COUNT( "RenderList.items", m_items.size() );
+
+    SCENELOG_DEBUG( log, "Patched, retained " << retained << " of " << previous.size() <<
+                    " items, added " << (m_items.size() - retained) << "." );
+}
+
+size_t
+RenderList::matchItems( const std::vector<Item>& previous, size_t begin, size_t end )
+{
+    // Chain the previous items with equal keys in order, so that duplicates
+    // are matched in order.
+    std::unordered_map< CacheKey<12>, size_t > first;
+    std::vector<size_t> next( end - begin, npos );
+    for( size_t i=end; i>begin; i-- ) {
+        auto r = first.insert( make_pair( itemKey( previous[i-1] ), i-1 ) );
+        if( !r.second ) {
+            next[i-1-begin] = r.first->second;
+            r.first->second = i-1;
+        }
+    }
+    size_t retained = 0;
+    for( size_t i=m_previous_index.size(); i<m_items.size(); i++ ) {
+        size_t p = npos;
+        auto it = first.find( itemKey( m_items[i] ) );
+        if( (it != first.end()) && (it->second != npos) ) {
+            p = it->second;
+            it->second = next[ it->second - begin ];
+            retained++;
+        }
+        m_previous_index.push_back( p );
+    }
+    return retained;
+}
+
+bool
+RenderList::patchFromJournal()
+{
+    static const Logger log = getLogger( package + ".patchFromJournal" );
+    SCENE_PROFILE_SCOPE( "RenderList::patchFromJournal" );
+
+    const DataBase& database = m_resolver.database();
+
+    // Cameras and lights are only referred to by the views, which are
+    // checked below.
+    if( !harmlessChanges( database.library<VisualScene>(), m_list_created, true, false ) ||
+        !harmlessChanges( database.library<Geometry>(), m_list_created, m_unresolved, false ) ||
+        !harmlessChanges( database.library<Material>(), m_list_created, m_unresolved, false ) ||
+        !harmlessChanges( database.library<Effect>(), m_list_created, m_unresolved, false ) ||
+        !harmlessChanges( database.library<SourceBuffer>(), m_list_created, m_unresolved, true ) )
+    {
+        SCENELOG_DEBUG( log, "Changes to other objects than nodes." );
+        return false;
+    }
+
+    std::vector<Library<Node>::Change> changes;
+    if( !database.library<Node>().changesSince( changes, m_list_created ) ) {
+        SCENELOG_DEBUG( log, "Node changes have been dropped from the journal." );
+        return false;
+    }
+    std::unordered_set<const Node*> changed;
+    for( auto it=changes.begin(); it!=changes.end(); ++it ) {
+        if( (it->m_kind == CHANGE_ADDED) && m_unresolved ) {
+            return false;
+        }
+        else if( it->m_kind == CHANGE_STRUCTURE ) {
+            changed.insert( it->m_object );
+        }
+    }
+    // Nodes reached through instance_nodes are not recorded, and neither is
+    // the context the nodes below them are traversed in.
+    for( auto it=changed.begin(); it!=changed.end(); ++it ) {
+        for( const Node* n=*it; n!=NULL; n=n->parent() ) {
+            if( m_instanced_nodes.count( n ) > 0 ) {
+                SCENELOG_DEBUG( log, "Instanced node " << n->debugString() << " has changed." );
+                return false;
+            }
+        }
+    }
+
+    // The items refer to the views, which must be unchanged.
+    for( size_t v=0; v<m_views.size(); v++ ) {
+        const RenderAction* view = m_resolver.setViewCoordSys( m_root, m_renders[v] );
+        m_patch_actions++;
+        if( !sameView( view->m_set_view, m_views[v]->m_set_view ) ) {
+            SCENELOG_DEBUG( log, "View " << v << " has changed." );
+            return false;
+        }
+    }
+
+    // Find the subtrees to traverse again, which are the outermost records
+    // of changed nodes, and the new children of the root if it has changed.
+    std::vector< std::vector< pair<const Node*,size_t> > > tops( m_traversals.size() );
+    std::vector< pair<size_t,const Node*> > work;
+    for( size_t t=0; t<m_traversals.size(); t++ ) {
+        const std::vector<Record>& records = m_traversals[t].m_records;
+        for( size_t i=0; i<records.size(); i=records[i].m_last+1 ) {
+            tops[t].push_back( make_pair( records[i].m_node, i ) );
+        }
+        if( (m_root != NULL) && (changed.count( m_root ) > 0) ) {
+            unordered_map<const Node*,size_t> previous_tops( tops[t].begin(), tops[t].end() );
+            tops[t].clear();
+            for( size_t c=0; c<m_root->children(); c++ ) {
+                auto it = previous_tops.find( m_root->child(c) );
+                tops[t].push_back( make_pair( m_root->child(c), it == previous_tops.end() ? npos : it->second ) );
+            }
+        }
+        for( auto it=tops[t].begin(); it!=tops[t].end(); ++it ) {
+            if( it->second == npos ) {
+                work.push_back( make_pair( t, it->first ) );
+                continue;
+            }
+            for( size_t i=it->second; i<=records[it->second].m_last; ) {
+                if( changed.count( records[i].m_node ) > 0 ) {
+                    work.push_back( make_pair( t, records[i].m_node ) );
+                    i = records[i].m_last + 1;
+                }
+                else {
+                    i++;
+                }
+            }
+        }
+    }
+
+    std::vector<Found> found( work.size() );
+    parallelFor( work.size(), m_threads, [&]( size_t w ) {
+        const Traversal& traversal = m_traversals[ work[w].first ];
+        Context context = traversal.m_context;
+        context.m_current_node = work[w].second;
+        found[w].m_unresolved = false;
+        processNode( found[w],
+                     context,
+                     traversal.m_rt_material,
+                     traversal.m_rt_pass,
+                     traversal.m_use_rt_as_material );
+    } );
+
+    // Splice the items of the subtrees into the kept items. Items between
+    // the traversals are from full-screen passes.
+    std::vector<Item> previous;
+    previous.swap( m_items );
+    std::vector<size_t> previous_view_items;
+    previous_view_items.swap( m_view_items );
+    m_previous_index.clear();
+    m_traversed_items = 0;
+    size_t cursor = 0;
+    size_t w = 0;
+    size_t t = 0;
+    for( size_t v=0; v<m_views.size(); v++ ) {
+        const size_t view_end = (v+1 < m_views.size()) ? previous_view_items[v+1] : previous.size();
+        m_view_items.push_back( m_items.size() );
+        m_set_transforms_current = m_views[v];
+        for( ; (t < m_traversals.size()) && (m_traversals[t].m_view == v); t++ ) {
+            retainItems( previous, cursor, m_traversals[t].m_begin );
+            cursor = m_traversals[t].m_end;
+            patchTraversal( m_traversals[t], previous, tops[t], changed, found, w );
+        }
+        retainItems( previous, cursor, view_end );
+        cursor = view_end;
+    }
+    m_previous_index.resize( m_items.size(), npos );
+
+    resetState();
+    for( size_t v=0; v<m_views.size(); v++ ) {
+        const size_t view_end = (v+1 < m_views.size()) ? m_view_items[v+1] : m_items.size();
+        m_operations.push_back( m_views[v] );
+        for( size_t i=m_view_items[v]; i<view_end; i++ ) {
+            addItemOperations( m_items[i] );
+        }
+    }
+    addRestoreStateOperations();
+
+    // Local coordinate systems of new items are left in the resolver until
+    // the next rebuild.
+    m_patch_actions += m_traversed_items;
+
+    m_patched = true;
+    m_list_created.touch();
+    dumpRenderList();
+    SCENE_PROFILE_COUNT( "RenderList.journalPatches", 1 );
+    SCENE_PROFILE_COUNT( "RenderList.items", m_items.size() );
+
+    SCENELOG_DEBUG( log, "Patched, traversed " << work.size() << " subtrees with " <<
+                    m_traversed_items << " of " << m_items.size() << " items." );
+    return true;
+}
+
+void
+RenderList::patchTraversal( Traversal&                                          traversal,
+                            const std::vector<Item>&                            previous,
+                            const std::vector< std::pair<const Node*,size_t> >& tops,
+                            const std::unordered_set<const Node*>&              changed,
+                            const std::vector<Found>&                           found,
+                            size_t&                                             w )
+{
+    std::vector<Record> records;
+    records.swap( traversal.m_records );
+    traversal.m_begin = m_items.size();
+
+    for( auto it=tops.begin(); it!=tops.end(); ++it ) {
+        if( it->second == npos ) {
+            addFound( traversal, found[ w++ ] );
+            continue;
+        }
+
+        // Kept records in the subtree, as indices of the new and old record,
+        // which are completed when the rest of their subtree is copied.
+        std::vector< pair<size_t,size_t> > open;
+        size_t cursor = records[ it->second ].m_begin;
+        auto close = [&]() {
+            const Record& old = records[ open.back().second ];
+            retainItems( previous, cursor, old.m_end );
+            cursor = old.m_end;
+            Record& kept = traversal.m_records[ open.back().first ];
+            kept.m_end = m_items.size();
+            kept.m_last = traversal.m_records.size() - 1;
+            open.pop_back();
+        };
+
+        for( size_t i=it->second; i<=records[ it->second ].m_last; ) {
+            while( !open.empty() && (records[ open.back().second ].m_last < i) ) {
+                close();
+            }
+            const Record& record = records[i];
+            retainItems( previous, cursor, record.m_begin );
+            cursor = record.m_begin;
+            if( changed.count( record.m_node ) > 0 ) {
+                m_previous_index.resize( m_items.size(), npos );
+                addFound( traversal, found[ w++ ] );
+                matchItems( previous, record.m_begin, record.m_end );
+                cursor = record.m_end;
+                i = record.m_last + 1;
+            }
+            else {
+                open.push_back( make_pair( traversal.m_records.size(), i ) );
+                traversal.m_records.push_back( record );
+                traversal.m_records.back().m_begin = m_items.size();
+                i++;
+            }
+        }
+        while( !open.empty() ) {
+            close();
+        }
+    }
+    traversal.m_end = m_items.size();
+}
+
+void
+RenderList::retainItems( const std::vector<Item>& previous, size_t begin, size_t end )
+{
+    m_previous_index.resize( m_items.size(), npos );
+    for( size_t i=begin; i<end; i++ ) {
+        m_items.push_back( previous[i] );
+        m_previous_index.push_back( i );
+    }
+}
 
+void
+RenderList::addFound( Traversal& traversal, const Found& found )
+{
+    m_unresolved = m_unresolved || found.m_unresolved;
+    m_instanced_nodes.insert( found.m_instanced_nodes.begin(), found.m_instanced_nodes.end() );
+
+    // Not every instance gives an item, so map the instance ranges of the
+    // records to item ranges.
+    std::vector<size_t> first_item( found.m_instances.size() + 1 );
+    for( size_t i=0; i<found.m_instances.size(); i++ ) {
+        const Instance& instance = found.m_instances[i];
+        first_item[i] = m_items.size();
+        addRenderItem( instance.m_node_path,
+                       instance.m_node_path_length,
+                       traversal.m_rt_material,
+                       traversal.m_rt_pass,
+                       instance.m_material,
+                       instance.m_pass,
+                       instance.m_common,
+                       instance.m_geometry,
+                       instance.m_primitives );
+    }
+    first_item.back() = m_items.size();
+    m_traversed_items += first_item.back() - first_item.front();
+
+    const size_t offset = traversal.m_records.size();
+    for( auto it=found.m_records.begin(); it!=found.m_records.end(); ++it ) {
+        Record record = *it;
+        record.m_begin = first_item[ it->m_begin ];
+        record.m_end = first_item[ it->m_end ];
+        record.m_last += offset;
+        traversal.m_records.push_back( record );
+    }
+}
+
+bool
+RenderList::populate()
+{
+    static const Logger log = getLogger( package + ".populate" );
+
+    m_items.clear();
+    m_renders.clear();
+    m_view_items.clear();
+    m_traversals.clear();
+    m_instanced_nodes.clear();
+    m_root = NULL;
+    m_unresolved = false;
+    m_traversed_items = 0;
+    resetState();
 
     const VisualScene* visual_scene = NULL;
 
@@ -203,11 +673,13 @@ RenderList::rebuild( )
 
     if( visual_scene == NULL ) {
         SCENELOG_ERROR( log, "Failed to retrieve visual scene '" << m_visual_scene << "'." );
-        return;
+        return false;
     }
 
     SCENELOG_DEBUG( log, "Processing visual scene '" << visual_scene->id() << "'." );
-
+    if( !visual_scene->nodesId().empty() ) {
+        m_root = m_resolver.database().library<Node>().get( visual_scene->nodesId() );
+    }
 
     size_t evaluate_scenes = visual_scene->evaluateScenes();
     for(size_t i=0; i<evaluate_scenes; i++ ) {
@@ -224,7 +696,30 @@ RenderList::rebuild( )
         }
     }
 
-    // Restore state
+    addRestoreStateOperations();
+    m_traversed_items = m_items.size();
+    return true;
+}
+
+void
+RenderList::resetState()
+{
+    m_operations.clear();
+    m_set_framebuffer_current = NULL;
+    m_set_pass_current = NULL;
+    m_set_input_current = NULL;
+    m_set_uniform_current = NULL;
+    m_set_samplers_current = NULL;
+    m_set_local_current = NULL;
+    m_set_raster_current = NULL;
+    m_set_pixel_ops_current = NULL;
+    m_set_fb_ctrl_current = NULL;
+    m_set_transforms_current = NULL;
+}
+
+void
+RenderList::addRestoreStateOperations()
+{
     if( !m_operations.empty() ) {
         std::vector<Bind> bind;
         const RenderAction* def_framebuffer = m_resolver.setRenderTarget( bind, NULL, NULL );
@@ -244,11 +739,46 @@ RenderList::rebuild( )
             m_operations.push_back( def_fb_ctrl );
         }
     }
+}
 
-    m_list_created.touch();
-    dumpRenderList();
-
-    SCENELOG_DEBUG( log, "# items in render list = " << m_operations.size() );
+void
+RenderList::addItemOperations( const Item& item )
+{
+    if( m_set_framebuffer_current != item.m_action_set_framebuffer ) {
+        m_set_framebuffer_current = item.m_action_set_framebuffer;
+        m_operations.push_back( m_set_framebuffer_current );
+    }
+    if( m_set_raster_current != item.m_action_set_raster ) {
+        m_set_raster_current = item.m_action_set_raster;
+        m_operations.push_back( m_set_raster_current );
+    }
+    if( m_set_pixel_ops_current != item.m_action_set_pixel_ops ) {
+        m_set_pixel_ops_current = item.m_action_set_pixel_ops;
+        m_operations.push_back( m_set_pixel_ops_current );
+    }
+    if( m_set_fb_ctrl_current != item.m_action_set_fb_ctrl ) {
+        m_set_fb_ctrl_current = item.m_action_set_fb_ctrl;
+        m_operations.push_back( m_set_fb_ctrl_current );
+    }
+    if( m_set_local_current != item.m_action_set_local ) {
+        m_set_local_current = item.m_action_set_local;
+        m_operations.push_back( m_set_local_current );
+    }
+    if( m_set_pass_current != item.m_action_set_pass ) {
+        m_set_pass_current = item.m_action_set_pass;
+        m_operations.push_back( m_set_pass_current );
+    }
+    if( (m_set_samplers_current != item.m_action_set_samplers) && (item.m_action_set_samplers != NULL) ) {
+        m_set_samplers_current = item.m_action_set_samplers;
+        m_operations.push_back( m_set_samplers_current );
+    }
+    m_set_uniform_current = item.m_action_set_uniform;
+    m_operations.push_back( m_set_uniform_current );
+    if( m_set_input_current != item.m_action_set_input ) {
+        m_set_input_current = item.m_action_set_input;
+        m_operations.push_back( m_set_input_current );
+    }
+    m_operations.push_back( item.m_action_draw );
 }
 
 void
@@ -260,7 +790,8 @@ RenderList::dumpRenderList() const
 }
 
 void
-RenderList::addRenderItem( const Context&              context,
+RenderList::addRenderItem( const Node* const*          node_path,
+                           size_t                      node_path_length,
                            const Material*             render_target_material,
                            const Pass*                 render_target_pass,
                            const Material*             material,
@@ -272,7 +803,7 @@ RenderList::addRenderItem( const Context&              context,
 
     std::vector<Bind> dummy_bind;
 
-    Logger log = getLogger( package + ".addRenderItem" );
+    static const Logger log = getLogger( package + ".addRenderItem" );
     if( material == NULL ) {
         SCENELOG_ERROR( log, "material==NULL" );
         return;
@@ -295,6 +826,7 @@ RenderList::addRenderItem( const Context&              context,
                                                         render_target_pass );
         if( set_framebuffer == NULL ) {
             SCENELOG_ERROR( log, "Failed to resolve render target, skipping batch." );
+            m_unresolved = true;
             return;
         }
     }
@@ -329,11 +861,7 @@ RenderList::addRenderItem( const Context&              context,
 
     // --- set transforms ------------------------------------------------------
 
-    std::list<const Node*> node_path = context.m_node_path_;
-    if( context.m_current_node != NULL ) {
-        node_path.push_back( context.m_current_node );
-    }
-    const RenderAction* set_local_coordsys = m_resolver.setLocalCoordSys( node_path );
+    const RenderAction* set_local_coordsys = m_resolver.setLocalCoordSys( node_path, node_path_length );
     if( m_set_local_current != set_local_coordsys ) {
         m_operations.push_back( set_local_coordsys );
         m_set_local_current = set_local_coordsys;
@@ -341,8 +869,8 @@ RenderList::addRenderItem( const Context&              context,
 
 #ifdef DEBUG
     std::string nodepath_str;
-    for(auto it=node_path.begin(); it!=node_path.end(); ++it ) {
-        nodepath_str += "/" + (*it)->debugString();
+    for( size_t i=0; i<node_path_length; i++ ) {
+        nodepath_str += "/" + node_path[i]->debugString();
     }
     nodepath_str += ":" + geometry->id();
     SCENELOG_DEBUG( log, "Instancing " << nodepath_str );
@@ -367,6 +895,7 @@ RenderList::addRenderItem( const Context&              context,
                                                                       pass );
     if( resolved_params == NULL ) {
         SCENELOG_ERROR( log, "Failed to resolve params" );
+        m_unresolved = true;
         return;
     }
 
@@ -392,6 +921,7 @@ RenderList::addRenderItem( const Context&              context,
     const RenderAction* set_inputs = m_resolver.setInputs( pass, geometry, primitives );
     if( set_inputs == NULL ) {
         SCENELOG_ERROR( log, "Failed to resolve inputs, skipping batch." );
+        m_unresolved = true;
         return;
     }
     if( m_set_input_current != set_inputs ) {
@@ -413,6 +943,11 @@ RenderList::addRenderItem( const Context&              context,
     item.m_action_set_input       = set_inputs;
     item.m_action_set_uniform     = set_uniforms;
     item.m_action_set_samplers    = set_samplers;
+    item.m_action_set_local       = set_local_coordsys;
+    item.m_action_set_raster      = set_raster;
+    item.m_action_set_pixel_ops   = set_pixel_ops;
+    item.m_action_set_fb_ctrl     = set_fb_ctrl;
+    item.m_action_draw            = draw;
 
     item.m_set_render_targets   = &set_framebuffer->m_set_render_targets;
     item.m_set_pass             = &set_pass->m_set_pass;
@@ -420,7 +955,7 @@ RenderList::addRenderItem( const Context&              context,
     item.m_set_uniforms         = &set_uniforms->m_set_uniforms;
     item.m_set_samplers         = &set_samplers->m_set_samplers;
     item.m_set_local_coordsys   = &set_local_coordsys->m_set_local;
-    item.m_set_view_coordsys    = &m_set_transforms_current->m_set_view;
+    item.m_set_view_coordsys    = m_set_transforms_current->m_set_view;
     item.m_set_raster           = &set_raster->m_set_rasterization;
     item.m_set_pixel_ops        = &set_pixel_ops->m_set_pixel_ops;
     item.m_set_fb_ctrl          = &set_fb_ctrl->m_set_fb_ctrl;
@@ -449,9 +984,9 @@ RenderList::getMaterialChildren( const Material*&    material,
                                  const Pass*&        pass,
                                  const std::string&  material_id,
                                  const std::string&  override_tech,
-                                 const std::string&  override_pass )
+                                 const std::string&  override_pass ) const
 {
-    Logger log = getLogger( package + ".getMaterialChildren" );
+    static const Logger log = getLogger( package + ".getMaterialChildren" );
 
 
     material = m_resolver.database().library<Material>().get( material_id );
@@ -513,106 +1048,165 @@ RenderList::getMaterialChildren( const Material*&    material,
 }
 
 
-void
-RenderList::processNode( Context&         context,
-                         const Material*  render_target_material,
-                         const Pass*      render_target_pass,
-                         bool             override_material )
+bool
+RenderList::includeNode( const Context& context ) const
 {
-    Logger log = getLogger( package + ".processRenderNodeList" );
-
-    SCENELOG_INFO( log, "Processing " << context.m_current_node->debugString() );
+    static const Logger log = getLogger( package + ".includeNode" );
 
     // Check layer spec. If list of layers to include is empty, render all
     // layers. Otherwise, we check if the node is contained.
+    const Node* node = context.m_current_node;
+    if( (m_resolver.profile() & node->profileMask() ) == 0u ) {
+        return false;
+    }
+    if( (context.m_layer_mask == 0u) || (node->layers() == 0) ) {
+        return true;
+    }
+    const LayerMask node_layer_mask = m_resolver.assignedLayerMask( node );
+    if( (context.m_layer_mask & node_layer_mask) != 0 ) {
+        SCENELOG_DEBUG( log, "Got a specific match on node " << node->debugString() <<
+                        ", render_layer_mask=" << context.m_layer_mask <<
+                        ", node_layer_mask=" << node_layer_mask <<
+                        ", all children will be processed." );
+        return true;
+    }
+    SCENELOG_DEBUG( log, "No match on node " << node->debugString() <<
+                    ", render_layer_mask=" << context.m_layer_mask <<
+                    ", node_layer_mask=" << node_layer_mask <<
+                    ", skipping this sub-tree." );
+    return false;
+}
 
-    LayerMask new_layer_mask = context.m_layer_mask;
-    LayerMask node_layer_mask = m_resolver.layerMask( context.m_current_node );
-
-    bool include_node;
-    if( (m_resolver.profile() & context.m_current_node->profileMask() ) != 0u ) {
-        if( context.m_layer_mask == 0u ) {
-            include_node = true;
-        }
-        else {
-            if( node_layer_mask == 0u ) {
-                include_node = true;
-            }
-            else {
-                include_node = (context.m_layer_mask & node_layer_mask) != 0;
-                if( include_node ) {
-                    // We got a match, clear the layer mask for further recursion
-                    //new_layer_mask = 0u;
-                    SCENELOG_DEBUG( log, "Got a specific match on node " << context.m_current_node->debugString() <<
-                                    ", render_layer_mask=" << context.m_layer_mask <<
-                                    ", node_layer_mask=" << node_layer_mask <<
-                                    ", all children will be processed." );
+bool
+RenderList::instanceContext( Found&          found,
+                             Context&        recurse_context,
+                             const Context&  context,
+                             size_t          index ) const
+{
+    static const Logger log = getLogger( package + ".instanceContext" );
 
-                }
-                else {
-                    SCENELOG_DEBUG( log, "No match on node " << context.m_current_node->debugString() <<
-                                    ", render_layer_mask=" << context.m_layer_mask <<
-                                    ", node_layer_mask=" << node_layer_mask <<
-                                    ", skipping this sub-tree." );
-                }
-            }
-        }
+    const string& id = context.m_current_node->instanceNode( index );
+    const Node* n = m_resolver.database().library<Node>().get( id );
+    if( n == NULL ) {
+        SCENELOG_ERROR( log, "Unable to find node " << id );
+        found.m_unresolved = true;
+        return false;
     }
-    else {
-        include_node = false;
+    found.m_instanced_nodes.push_back( n );
+    // Room for the instancer, the instancee and a node below it.
+    if( context.m_node_path_length + 3 > SCENE_PATH_MAX ) {
+        SCENELOG_ERROR( log, "Instancing " << n->debugString() << " exceeds SCENE_PATH_MAX, skipping." );
+        return false;
     }
+    SCENELOG_DEBUG( log, "Instancing " << n->debugString() );
+
+    recurse_context = context;
+    recurse_context.m_current_node = n;
+    recurse_context.m_instanced = true;
+    recurse_context.m_node_path[ recurse_context.m_node_path_length++ ] = context.m_current_node;  // Instancer
+    recurse_context.m_node_path[ recurse_context.m_node_path_length++ ] = n;                       // Instancee
+    return true;
+}
 
-    if(!include_node) {
-        return;
+bool
+RenderList::splitTask( std::vector<Task>& tasks, Found& found, const Task& task ) const
+{
+    const Context& context = task.m_context;
+    if( !includeNode( context ) ) {
+        return false;
     }
-
-    // Instance node
+    const size_t first = tasks.size();
+    Task subtask;
+    subtask.m_recurse = true;
+    subtask.m_close = 0;
     for( size_t j=0; j<context.m_current_node->instanceNodes(); j++ ) {
-        const string& id = context.m_current_node->instanceNode(j);
-        const Node* n = m_resolver.database().library<Node>().get( id );
-        if( n == NULL ) {
-            SCENELOG_ERROR( log, "Unable to find node " << id );
-        }
-        else {
-
-
-            Context recurse_context = context;
-            recurse_context.m_current_node = n;
-
-            recurse_context.m_node_path_.push_back( context.m_current_node );          // Instancer
-            recurse_context.m_node_path_.push_back( recurse_context.m_current_node );  // Instancee
-            recurse_context.m_layer_mask = new_layer_mask;
-
-            SCENELOG_DEBUG( log, "Instancing " << n->debugString() );
-            processNode( recurse_context,
-                        render_target_material,
-                        render_target_pass,
-                        override_material );
+        if( instanceContext( found, subtask.m_context, context, j ) ) {
+            tasks.push_back( subtask );
         }
     }
-
-    // Recurse into children
+    subtask.m_context = context;
     for( size_t i=0; i<context.m_current_node->children(); i++ ) {
+        subtask.m_context.m_current_node = context.m_current_node->child(i);
+        tasks.push_back( subtask );
+    }
+    if( context.m_current_node->geometryInstances() > 0 ) {
+        subtask.m_context = context;
+        subtask.m_recurse = false;
+        tasks.push_back( subtask );
+    }
+    if( tasks.size() == first ) {
+        return false;
+    }
+    tasks[first].m_open = task.m_open;
+    tasks.back().m_close = task.m_close;
+    if( !context.m_instanced ) {
+        tasks[first].m_open.push_back( context.m_current_node );
+        tasks.back().m_close++;
+    }
+    return true;
+}
 
-        Context recurse_context = context;
-        recurse_context.m_current_node = context.m_current_node->child(i);
-        recurse_context.m_layer_mask = new_layer_mask;
+void
+RenderList::processNode( Found&                  found,
+                         const Context&          context,
+                         const Material*         render_target_material,
+                         const Pass*             render_target_pass,
+                         bool                    override_material ) const
+{
+    static const Logger log = getLogger( package + ".processRenderNodeList" );
+
+    SCENELOG_INFO( log, "Processing " << context.m_current_node->debugString() );
 
-        processNode( recurse_context,
-                     render_target_material,
-                     render_target_pass,
-                     override_material );
+    // Record the node, also if it isn't included, as that may change.
+    const size_t record = found.m_records.size();
+    if( !context.m_instanced ) {
+        Record r;
+        r.m_node = context.m_current_node;
+        r.m_begin = found.m_instances.size();
+        found.m_records.push_back( r );
     }
 
-    // Instance geometry
-    if( include_node && context.m_current_node->geometryInstances() > 0 ) {
-        SCENELOG_DEBUG( log, "Instancing geometry of node " << context.m_current_node->debugString() );
+    if( includeNode( context ) ) {
+
+        // Instance node
+        Context recurse_context;
+        for( size_t j=0; j<context.m_current_node->instanceNodes(); j++ ) {
+            if( instanceContext( found, recurse_context, context, j ) ) {
+                processNode( found,
+                             recurse_context,
+                             render_target_material,
+                             render_target_pass,
+                             override_material );
+            }
+        }
 
-        instanceGeometry( context.m_current_node,
-                         context,
+        // Recurse into children
+        recurse_context = context;
+        for( size_t i=0; i<context.m_current_node->children(); i++ ) {
+            recurse_context.m_current_node = context.m_current_node->child(i);
+            processNode( found,
+                         recurse_context,
                          render_target_material,
                          render_target_pass,
                          override_material );
+        }
+
+        // Instance geometry
+        if( context.m_current_node->geometryInstances() > 0 ) {
+            SCENELOG_DEBUG( log, "Instancing geometry of node " << context.m_current_node->debugString() );
+
+            instanceGeometry( found,
+                              context.m_current_node,
+                              context,
+                              render_target_material,
+                              render_target_pass,
+                              override_material );
+        }
+    }
+
+    if( !context.m_instanced ) {
+        found.m_records[ record ].m_end = found.m_instances.size();
+        found.m_records[ record ].m_last = found.m_records.size() - 1;
     }
 }
 
@@ -620,16 +1214,32 @@ RenderList::processNode( Context&         context,
 
 
 void
-RenderList::instanceGeometry( const Node*                node,
+RenderList::instanceGeometry( Found&                     found,
+                              const Node*                node,
                               const Context&             context,
                               const Material*            render_target_material,
                               const Pass*                render_target_pass,
-                              bool                       override_material )
+                              bool                       override_material ) const
 {
-    Logger log = getLogger( package + ".instanceGeometry" );
+    static const Logger log = getLogger( package + ".instanceGeometry" );
 
     SCENELOG_INFO( log, "Instancing geometry of node " << node->debugString() );
 
+    Instance instance;
+    std::copy_n( context.m_node_path, context.m_node_path_length, instance.m_node_path );
+    instance.m_node_path_length = context.m_node_path_length;
+    instance.m_node_path[ instance.m_node_path_length++ ] = node;
+    auto add = [&]( const Material* material, const Pass* pass, const CommonShadingModel* common,
+                    const Geometry* geometry, const Primitives* primitives )
+    {
+        instance.m_material = material;
+        instance.m_pass = pass;
+        instance.m_common = common;
+        instance.m_geometry = geometry;
+        instance.m_primitives = primitives;
+        found.m_instances.push_back( instance );
+    };
+
 
     for(size_t i=0; i<node->geometryInstances(); i++) {
         const InstanceGeometry* instance = node->geometryInstance( i );
@@ -637,6 +1247,7 @@ RenderList::instanceGeometry( const Node*                node,
         const Geometry* geometry = m_resolver.database().library<Geometry>().get( instance->geometryId() );
         if( geometry == NULL ) {
             SCENELOG_ERROR( log, "Failed to retrieve geometry '" << instance->geometryId() << "'." );
+            found.m_unresolved = true;
         }
         else {
 
@@ -668,6 +1279,7 @@ RenderList::instanceGeometry( const Node*                node,
                     bool success = true;
                     if( !getMaterialChildren( material, effect, profile, technique, pass, target_id ) ) {
                         SCENELOG_WARN( log, "Missing children, using default material." );
+                        found.m_unresolved = true;
                         if(!getMaterialChildren( material, effect, profile, technique, pass, "phong"  ) ) {
                             SCENELOG_FATAL( log, "Unable to use default material." );
                             success = false;
@@ -675,36 +1287,27 @@ RenderList::instanceGeometry( const Node*                node,
                     }
                     if( success ) {
                         if( technique->profile()->type() == PROFILE_COMMON ) {
-                            addRenderItem( context,
-                                           render_target_material,
-                                           render_target_pass,
-                                           material,
-                                           NULL,
-                                           technique->commonShadingModel(),
-                                           geometry,
-                                           primitives );
+                            add( material,
+                                 NULL,
+                                 technique->commonShadingModel(),
+                                 geometry,
+                                 primitives );
 
                         }
                         else if( override_material ) {
-                            addRenderItem( context,
-                                           render_target_material,
-                                           render_target_pass,
-                                           render_target_material,
-                                           render_target_pass,
-                                           NULL,
-                                           geometry,
-                                           primitives );
+                            add( render_target_material,
+                                 render_target_pass,
+                                 NULL,
+                                 geometry,
+                                 primitives );
                         }
                         else {
                             for(size_t k=0; k<technique->passes(); k++) {
-                                addRenderItem( context,
-                                               render_target_material,
-                                               render_target_pass,
-                                               material,
-                                               technique->pass(k),
-                                               NULL,
-                                               geometry,
-                                               primitives );
+                                add( material,
+                                     technique->pass(k),
+                                     NULL,
+                                     geometry,
+                                     primitives );
                             }
                         }
                     }
@@ -721,23 +1324,99 @@ RenderList::traverseVisualSceneNodeHierarchy( const VisualScene*             vis
                                               const Pass*                    rt_pass,
                                               bool                           use_rt_as_material )
 {
+    SCENE_PROFILE_SCOPE( "RenderList::traverseVisualSceneNodeHierarchy" );
 
     const Node* visual_scene_node = m_resolver.database().library<Node>().get( visual_scene->nodesId() );
-    if( visual_scene_node != NULL ) {
-        context.m_node_path_.push_back( visual_scene_node );
+    if( visual_scene_node == NULL ) {
+        m_unresolved = m_unresolved || !visual_scene->nodesId().empty();
+        return;
+    }
 
-        for(size_t i=0; i<visual_scene_node->children(); i++ ) {
+    Traversal traversal;
+    traversal.m_view = m_views.size() - 1;
+    traversal.m_context = context;
+    traversal.m_context.m_node_path[ traversal.m_context.m_node_path_length++ ] = visual_scene_node;
+    traversal.m_rt_material = rt_material;
+    traversal.m_rt_pass = rt_pass;
+    traversal.m_use_rt_as_material = use_rt_as_material;
+    traversal.m_begin = m_items.size();
+
+    std::vector<Task> tasks;
+    Task task;
+    task.m_context = traversal.m_context;
+    task.m_recurse = true;
+    task.m_close = 0;
+    for(size_t i=0; i<visual_scene_node->children(); i++ ) {
+        task.m_context.m_current_node = visual_scene_node->child(i);
+        tasks.push_back( task );
+    }
 
-            context.m_current_node = visual_scene_node->child(i);
-            processNode( context,
+    // Split subtrees a level at a time until there is enough work to
+    // balance the threads. The order of the tasks is the traversal order.
+    Found split_found;
+    split_found.m_unresolved = false;
+    if( m_threads > 1 ) {
+        std::vector<Task> split;
+        for( unsigned int level=0; (level<max_split_levels) && (tasks.size() < tasks_per_thread*m_threads); level++ ) {
+            bool recursive = false;
+            split.clear();
+            for( size_t t=0; t<tasks.size(); t++ ) {
+                if( tasks[t].m_recurse && splitTask( split, split_found, tasks[t] ) ) {
+                    recursive = true;
+                }
+                else {
+                    split.push_back( tasks[t] );
+                }
+            }
+            tasks.swap( split );
+            if( !recursive ) {
+                break;
+            }
+        }
+    }
+    addFound( traversal, split_found );
+
+    std::vector<Found> found( tasks.size() );
+    parallelFor( tasks.size(), m_threads, [&]( size_t t ) {
+        found[t].m_unresolved = false;
+        if( tasks[t].m_recurse ) {
+            processNode( found[t],
+                         tasks[t].m_context,
                          rt_material,
                          rt_pass,
                          use_rt_as_material );
-
         }
-
-        context.m_node_path_.pop_back();
+        else {
+            instanceGeometry( found[t],
+                              tasks[t].m_context.m_current_node,
+                              tasks[t].m_context,
+                              rt_material,
+                              rt_pass,
+                              use_rt_as_material );
+        }
+    } );
+
+    // The resolver caches aren't thread-safe, add the items serially. The
+    // records of split nodes span the items of their tasks.
+    std::vector<size_t> open;
+    for( size_t t=0; t<tasks.size(); t++ ) {
+        for( auto it=tasks[t].m_open.begin(); it!=tasks[t].m_open.end(); ++it ) {
+            Record record;
+            record.m_node = *it;
+            record.m_begin = m_items.size();
+            open.push_back( traversal.m_records.size() );
+            traversal.m_records.push_back( record );
+        }
+        addFound( traversal, found[t] );
+        for( size_t k=0; k<tasks[t].m_close; k++ ) {
+            Record& record = traversal.m_records[ open.back() ];
+            record.m_end = m_items.size();
+            record.m_last = traversal.m_records.size() - 1;
+            open.pop_back();
+        }
     }
+    traversal.m_end = m_items.size();
+    m_traversals.push_back( std::move( traversal ) );
 }
 
 
@@ -748,7 +1427,7 @@ RenderList::processInstanceMaterialPass( const VisualScene*               visual
                                          const Material*                  material,
                                          const Pass*                      pass )
 {
-    Logger log = getLogger( package + ".processInstanceMaterialPass" );
+    static const Logger log = getLogger( package + ".processInstanceMaterialPass" );
 
 
     const Node* visual_scene_node = NULL;
@@ -780,6 +1459,7 @@ RenderList::processInstanceMaterialPass( const VisualScene*               visual
         const Geometry* geometry = m_resolver.database().library<Geometry>().get( "builtin.full_screen_quad" );
         if( geometry == NULL ) {
             SCENELOG_FATAL( log, "Cannot find full-screen quad geometry!" );
+            m_unresolved = true;
             return;
         }
         if( geometry->primitiveSets() < 1 ) {
@@ -788,7 +1468,8 @@ RenderList::processInstanceMaterialPass( const VisualScene*               visual
         }
 
         const Primitives* primitives = geometry->primitives(0);
-        addRenderItem( context,
+        addRenderItem( context.m_node_path,
+                       context.m_node_path_length,
                        material,
                        pass,
                        material,
@@ -810,7 +1491,7 @@ void
 RenderList::processRender( const VisualScene*          visual_scene,
                            const Render*  render )
 {
-    Logger log = getLogger( package + ".processRender" );
+    static const Logger log = getLogger( package + ".processRender" );
 
 
     SCENELOG_DEBUG( log,
@@ -823,12 +1504,26 @@ RenderList::processRender( const VisualScene*          visual_scene,
         visual_scene_node = m_resolver.database().library<Node>().get( visual_scene->nodesId() );
     }
 
+    // When patching, keep the previous view if it is unchanged.
     m_set_transforms_current = m_resolver.setViewCoordSys( visual_scene_node, render );
+    const size_t view_index = m_views.size();
+    if( (view_index < m_previous_views.size()) &&
+        sameView( m_previous_views[ view_index ]->m_set_view, m_set_transforms_current->m_set_view ) )
+    {
+        m_set_transforms_current = m_previous_views[ view_index ];
+    }
+    m_views.push_back( m_set_transforms_current );
+    m_renders.push_back( render );
+    m_view_items.push_back( m_items.size() );
     m_operations.push_back( m_set_transforms_current );
 
     // Get the camera to use
     Context context;
+    context.m_camera = NULL;
+    context.m_node_path_length = 0;
     context.m_layer_mask = m_resolver.layerMask( render );
+    context.m_instanced = false;
+    std::list<const Node*> camera_path;
 
     if( visual_scene_node != NULL ) {
         if( !render->cameraNodeId().empty() ) {
@@ -840,15 +1535,15 @@ RenderList::processRender( const VisualScene*          visual_scene,
                 if( camera_node->instanceCameras() > 0 ) {
                     context.m_camera = m_resolver.database().library<Camera>().get( camera_node->instanceCameraURL(0) );
                 }
-                if( m_resolver.findNodePath( context.m_camera_path_, visual_scene_node, camera_node ) ) {
+                if( m_resolver.findNodePath( camera_path, visual_scene_node, camera_node ) ) {
                 }
             }
         }
     }
 
     context.m_camera = NULL;
-    if( !context.m_camera_path_.empty() ) {
-        const Node* camera_node = context.m_camera_path_.back();
+    if( !camera_path.empty() ) {
+        const Node* camera_node = camera_path.back();
         if( camera_node->instanceCameras() == 0 ) {
             SCENELOG_WARN( log, "No camera instanced in camera node." );
         }
@@ -893,6 +1588,7 @@ RenderList::processRender( const VisualScene*          visual_scene,
             SCENELOG_ERROR( log, "Unable to find material - technique chain" <<
                             ", override_tech='" << render->instanceMaterialTechniqueOverrideSid() << '\'' <<
                             ", override_pass='" << render->instanceMaterialTechniqueOverridePassSid() << '\'' );
+            m_unresolved = true;
             return;
         }
 
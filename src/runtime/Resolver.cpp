@@ -29,6 +29,7 @@
 #include "scene/Material.hpp"
 #include "scene/runtime/Resolver.hpp"
 #include "scene/runtime/RenderAction.hpp"
+#include "scene/Profiler.hpp"
 
 namespace Scene {
     namespace Runtime {
@@ -55,7 +56,7 @@ Resolver::layerMask( const std::string& layer )
     LayerMask mask = 1u<<bit;
     m_layer_masks[ layer ] = mask;
 
-    Logger log = getLogger( package + "layerMask" );
+    static const Logger log = getLogger( package + "layerMask" );
     SCENELOG_TRACE( log, "Layer '"<< layer << "' has layer mask 0x" << std::hex << mask << std::dec );
     return mask;
 }
@@ -79,7 +80,7 @@ Resolver::layerMask( const Render* render )
     }
     m_layer_mask_render[ key ] = cached_mask;
 
-    Logger log = getLogger( package + "layerMask" );
+    static const Logger log = getLogger( package + "layerMask" );
     SCENELOG_TRACE( log, "Render item " << render << " (sid='"<< render->sid() << "') has layer mask 0x" << std::hex << cached_mask.m_mask << std::dec );
 
     return cached_mask.m_mask;
@@ -105,12 +106,25 @@ Resolver::layerMask( const Node* node )
     }
     m_layer_mask_node[ key ] = cached_mask;
 
-    Logger log = getLogger( package + "layerMask" );
+    static const Logger log = getLogger( package + "layerMask" );
     SCENELOG_TRACE( log, "Node " << node->debugString() << " has layer mask 0x" << std::hex << cached_mask.m_mask << std::dec );
 
     return cached_mask.m_mask;
 }
 
+const LayerMask
+Resolver::assignedLayerMask( const Node* node ) const
+{
+    LayerMask mask = 0u;
+    for( size_t i=0; i<node->layers(); i++ ) {
+        auto it = m_layer_masks.find( node->layer(i) );
+        if( it != m_layer_masks.end() ) {
+            mask |= it->second;
+        }
+    }
+    return mask;
+}
+
 
 const RenderAction*
 Resolver::setViewCoordSys( const Node*    visual_scene_node,
@@ -157,21 +171,40 @@ Resolver::setViewCoordSys( const Node*    visual_scene_node,
         }
     }
 
-    RenderAction* action = RenderAction::createSetViewCoordSys( camera,
-                                                        camera_path,
-                                                        lights,
-                                                        light_projections,
-                                                        light_paths );
-    m_views.push_back( action );
-    return action;
+    return RenderAction::createSetViewCoordSys( m_frame_arena,
+                                                camera,
+                                                camera_path,
+                                                lights,
+                                                light_projections,
+                                                light_paths );
 }
 
 
 const RenderAction*
 Resolver::setLocalCoordSys( const std::list<const Node*>&  node_path )
 {
-    RenderAction* action = RenderAction::createSetLocalCoordSys( node_path );
-    m_set_local.push_back( action );
+    const Node* path[ SCENE_PATH_MAX+1 ];
+    size_t length = 0;
+    for( auto it=node_path.begin(); (it!=node_path.end()) && (length <= SCENE_PATH_MAX); ++it ) {
+        path[ length++ ] = *it;
+    }
+    return setLocalCoordSys( path, length );
+}
+
+const RenderAction*
+Resolver::setLocalCoordSys( const Node* const*  node_path,
+                            size_t              node_path_length )
+{
+    CacheKey<SCENE_PATH_MAX> key;
+    for( size_t i=0; i<SCENE_PATH_MAX; i++ ) {
+        key[i] = i < node_path_length ? node_path[i] : NULL;
+    }
+    auto it = m_set_local_cache.find( key );
+    if( it != m_set_local_cache.end() ) {
+        return it->second;
+    }
+    const RenderAction* action = RenderAction::createSetLocalCoordSys( m_frame_arena, node_path, node_path_length );
+    m_set_local_cache[ key ] = action;
     return action;
 }
 
@@ -216,103 +249,35 @@ Resolver::Resolver( const Scene::DataBase& database, ProfileType profile, const
 void
 Resolver::clear()
 {
-
-
-    // Note: The cached items that also has a default value (state objects), may
-    // have the default be represented multiple times inside the cache. Thus,
-    // we must be a bit careful so that is deleted only once.
-    for(auto it=m_set_framebuffer_cache.begin(); it!=m_set_framebuffer_cache.end(); ++it ) {
-        if( it->second != m_def_framebuffer ) {
-            delete it->second;
-        }
-    }
+    // The actions themselves live in the arenas, and may be represented
+    // multiple times in the caches, e.g. the default state objects.
     m_set_framebuffer_cache.clear();
-    if( m_def_framebuffer != NULL ) {
-        delete m_def_framebuffer;
-        m_def_framebuffer = NULL;
-    }
-
-
-    for(auto it=m_set_raster_cache.begin(); it!=m_set_raster_cache.end(); ++it ) {
-        if( it->second != m_def_raster ) {
-            delete it->second;
-        }
-    }
     m_set_raster_cache.clear();
-    if( m_def_raster != NULL ) {
-        delete m_def_raster;
-        m_def_raster = NULL;
-    }
-
-    for(auto it=m_set_pixel_ops_cache.begin(); it!=m_set_pixel_ops_cache.end(); ++it) {
-        if( it->second != m_def_pixel_ops ) {
-            delete it->second;
-        }
-    }
     m_set_pixel_ops_cache.clear();
-    if( m_def_pixel_ops != NULL ) {
-        delete m_def_pixel_ops;
-        m_def_pixel_ops = NULL;
-    }
-
-
-    for( auto it=m_set_fb_ctrl_cache.begin(); it!=m_set_fb_ctrl_cache.end(); ++it ) {
-        if( it->second != m_def_fb_ctrl ) {
-            delete it->second;
-        }
-    }
     m_set_fb_ctrl_cache.clear();
-    if( m_def_fb_ctrl != NULL ) {
-        delete m_def_fb_ctrl;
-        m_def_fb_ctrl = NULL;
-    }
-
-    // The rest should be unique
-
-    for_each( m_nodepath_cache.begin(),
-              m_nodepath_cache.end(),
-             []( std::pair<const NodePath::Id,NodePath*> a){ delete a.second; } );
-    m_nodepath_cache.clear();
-
-
-    for_each( m_set_pass_cache.begin(),
-              m_set_pass_cache.end(),
-             []( std::pair<const string,RenderAction*> a){ delete a.second; } );
     m_set_pass_cache.clear();
-
-    for_each( m_set_inputs_cache.begin(),
-              m_set_inputs_cache.end(),
-             []( std::pair<const string,RenderAction*> a){ delete a.second; } );
     m_set_inputs_cache.clear();
-
-    for_each( m_set_uniforms_cache.begin(),
-              m_set_uniforms_cache.end(),
-             []( std::pair<const string,RenderAction*> a){ delete a.second; } );
     m_set_uniforms_cache.clear();
-
-    for_each( m_set_samplers_cache.begin(),
-              m_set_samplers_cache.end(),
-             []( std::pair<const string,RenderAction*> a){ delete a.second; } );
     m_set_samplers_cache.clear();
-
-    for_each( m_draw_cache.begin(),
-              m_draw_cache.end(),
-             []( std::pair<const string,RenderAction*> a){ delete a.second; } );
     m_draw_cache.clear();
+    m_def_framebuffer = NULL;
+    m_def_raster = NULL;
+    m_def_pixel_ops = NULL;
+    m_def_fb_ctrl = NULL;
+    m_arena.reset();
+    m_frame_arena.reset();
+    m_set_local_cache.clear();
+
+    for_each( m_nodepath_cache.begin(),
+              m_nodepath_cache.end(),
+             []( std::pair<const NodePath::Id,NodePath*> a){ delete a.second; } );
+    m_nodepath_cache.clear();
 
     for_each( m_resolved_params_cache.begin(),
               m_resolved_params_cache.end(),
-             []( std::pair<const string,ResolvedParams*> a){ delete a.second; } );
+             []( std::pair<const CacheKey<2>,ResolvedParams*> a){ delete a.second; } );
     m_resolved_params_cache.clear();
 
-
-
-    for_each( m_views.begin(), m_views.end(), [](RenderAction* a){ delete a; } );
-    m_views.clear();
-
-    for_each( m_set_local.begin(), m_set_local.end(), [](RenderAction* a){ delete a; } );
-    m_set_local.clear();
-
     m_layer_masks.clear();
     m_layer_mask_render.clear();
     m_layer_mask_node.clear();
@@ -321,11 +286,15 @@ Resolver::clear()
 void
 Resolver::purge()
 {
-    for_each( m_views.begin(), m_views.end(), [](RenderAction* a){ delete a; } );
-    m_views.clear();
+    m_frame_arena.reset();
+    m_set_local_cache.clear();
+    recycle();
+}
 
-    for_each( m_set_local.begin(), m_set_local.end(), [](RenderAction* a){ delete a; } );
-    m_set_local.clear();
+void
+Resolver::recycle()
+{
+    m_arena.recycle();
 }
 
 Resolver::~Resolver()
@@ -339,7 +308,7 @@ Resolver::findNodePath( std::list<const Node*>&  path,
                         const Node*              source_node,
                         const Node*              target_node )
 {
-    Logger log = getLogger( package + ".findNodePath" );
+    static const Logger log = getLogger( package + ".findNodePath" );
 
 
     path.clear();
@@ -360,7 +329,7 @@ Resolver::findNodePathRecurse( std::list<const Node*>&  path,
                                const Node*              current_node,
                                const Node*              target_node )
 {
-    Logger log = getLogger( package + ".findNodePathRecurse" );
+    static const Logger log = getLogger( package + ".findNodePathRecurse" );
 
     SCENELOG_ASSERT( log, path.size() % 2 == 1 );
 
@@ -399,23 +368,25 @@ Resolver::setRaster( const Pass* pass )
 {
     if( pass == NULL ) {
         if( m_def_raster == NULL ) {
-            m_def_raster = RenderAction::createSetRaster( "default", NULL, NULL );
+            m_def_raster = RenderAction::createSetRaster( m_arena, "default", NULL, NULL );
         }
         return m_def_raster;
     }
-    const string id = pass->key();
-    auto it = m_set_raster_cache.find( id );
+    const CacheKey<1> key( pass );
+    auto it = m_set_raster_cache.find( key );
     if( it != m_set_raster_cache.end() ) {
+        SCENE_PROFILE_COUNT( "Resolver.setRaster.hit", 1 );
         return it->second;
     }
-    RenderAction* action = RenderAction::createSetRaster( id, NULL, pass );
+    RenderAction* action = RenderAction::createSetRaster( m_arena, pass->key(), NULL, pass );
     if( action == NULL ) {
         if( m_def_raster == NULL ) {
-            m_def_raster = RenderAction::createSetRaster( "default", NULL, NULL );
+            m_def_raster = RenderAction::createSetRaster( m_arena, "default", NULL, NULL );
         }
         action = m_def_raster;
     }
-    m_set_raster_cache[ id ] = action;
+    SCENE_PROFILE_COUNT( "Resolver.setRaster.miss", 1 );
+    m_set_raster_cache[ key ] = action;
     return action;
 }
 
@@ -424,11 +395,11 @@ Resolver::setRenderTarget( const std::vector<Bind>&  bind,
                            const Material*           material,
                            const Pass*               pass )
 {
-    Logger log = getLogger( package + ".setRenderTarget" );
+    static const Logger log = getLogger( package + ".setRenderTarget" );
 
     if( material == NULL || pass == NULL ) {
         if( m_def_framebuffer == NULL ) {
-            m_def_framebuffer = RenderAction::createSetRenderTarget( m_database, "default", NULL, NULL );
+            m_def_framebuffer = RenderAction::createSetRenderTarget( m_arena, m_database, "default", NULL, NULL );
         }
         return m_def_framebuffer;
     }
@@ -438,26 +409,28 @@ Resolver::setRenderTarget( const std::vector<Bind>&  bind,
         SCENELOG_FATAL( log, "params==NULL @" << __LINE__ );
         return NULL;
     }
-    const string id = params->m_id;
+    const CacheKey<2> key( pass, material );
 
-    auto it = m_set_framebuffer_cache.find( id );
+    auto it = m_set_framebuffer_cache.find( key );
     if( it != m_set_framebuffer_cache.end() ) {
+        SCENE_PROFILE_COUNT( "Resolver.setRenderTarget.hit", 1 );
         return it->second;
     }
 
-    RenderAction* action = RenderAction::createSetRenderTarget( m_database,
-                                                                id,
+    RenderAction* action = RenderAction::createSetRenderTarget( m_arena,
+                                                                m_database,
+                                                                params->m_id,
                                                                 params,
                                                                 pass );
     if( action != NULL && action->m_set_render_targets.m_items.empty() ) {
-        delete action;
         if( m_def_framebuffer == NULL ) {
-            m_def_framebuffer = RenderAction::createSetRenderTarget( m_database, "default", NULL, NULL );
+            m_def_framebuffer = RenderAction::createSetRenderTarget( m_arena, m_database, "default", NULL, NULL );
         }
         action = m_def_framebuffer;
     }
 
-    m_set_framebuffer_cache[ id ] = action;
+    SCENE_PROFILE_COUNT( "Resolver.setRenderTarget.miss", 1 );
+    m_set_framebuffer_cache[ key ] = action;
     return action;
 }
 
@@ -467,25 +440,27 @@ Resolver::setPixelOps( const Pass* pass )
 {
     if( pass == NULL ) {
         if( m_def_pixel_ops == NULL ) {
-            m_def_pixel_ops = RenderAction::createSetPixelOps( "default", NULL, NULL );
+            m_def_pixel_ops = RenderAction::createSetPixelOps( m_arena, "default", NULL, NULL );
         }
         return m_def_pixel_ops;
     }
-    const string id = pass->key();
-    auto it = m_set_pixel_ops_cache.find( id );
+    const CacheKey<1> key( pass );
+    auto it = m_set_pixel_ops_cache.find( key );
     if( it != m_set_pixel_ops_cache.end() ) {
+        SCENE_PROFILE_COUNT( "Resolver.setPixelOps.hit", 1 );
         return it->second;
     }
-    RenderAction* action = RenderAction::createSetPixelOps( id, NULL, pass );
+    RenderAction* action = RenderAction::createSetPixelOps( m_arena, pass->key(), NULL, pass );
     if( action == NULL ) {
         // No changes from default
         if( m_def_pixel_ops == NULL ) {
             std::vector<Bind> bind;
-            m_def_pixel_ops = RenderAction::createSetPixelOps( "default", NULL, NULL );
+            m_def_pixel_ops = RenderAction::createSetPixelOps( m_arena, "default", NULL, NULL );
         }
         action = m_def_pixel_ops;
     }
-    m_set_pixel_ops_cache[ id ] = action;
+    SCENE_PROFILE_COUNT( "Resolver.setPixelOps.miss", 1 );
+    m_set_pixel_ops_cache[ key ] = action;
     return action;
 }
 
@@ -495,46 +470,51 @@ Resolver::setFBCtrl( const Pass* pass )
     if( pass == NULL ) {
         if( m_def_fb_ctrl == NULL ) {
             std::vector<Bind> bind;
-            m_def_fb_ctrl = RenderAction::createSetFBCtrl( "default", NULL, NULL );
+            m_def_fb_ctrl = RenderAction::createSetFBCtrl( m_arena, "default", NULL, NULL );
         }
         return m_def_fb_ctrl;
     }
-    const string id = pass->key();
-    auto it = m_set_fb_ctrl_cache.find( id );
+    const CacheKey<1> key( pass );
+    auto it = m_set_fb_ctrl_cache.find( key );
     if( it != m_set_fb_ctrl_cache.end() ) {
+        SCENE_PROFILE_COUNT( "Resolver.setFBCtrl.hit", 1 );
         return it->second;
     }
-    RenderAction* action = RenderAction::createSetFBCtrl( id, NULL, pass );
+    RenderAction* action = RenderAction::createSetFBCtrl( m_arena, pass->key(), NULL, pass );
     if( action == NULL ) {
         if( m_def_fb_ctrl == NULL ) {
             std::vector<Bind> bind;
-            m_def_fb_ctrl = RenderAction::createSetFBCtrl( "default", NULL, NULL );
+            m_def_fb_ctrl = RenderAction::createSetFBCtrl( m_arena, "default", NULL, NULL );
         }
         action = m_def_fb_ctrl;
     }
-    m_set_fb_ctrl_cache[ id ] = action;
+    SCENE_PROFILE_COUNT( "Resolver.setFBCtrl.miss", 1 );
+    m_set_fb_ctrl_cache[ key ] = action;
     return action;
 }
 
 const RenderAction*
 Resolver::setPass( const Pass* pass )
 {
-    Logger log = getLogger( package + ".setPass" );
+    static const Logger log = getLogger( package + ".setPass" );
 
-    const string id = pass->key();
+    const CacheKey<1> key( pass );
 
-    auto it = m_set_pass_cache.find( id );
+    auto it = m_set_pass_cache.find( key );
     if( it != m_set_pass_cache.end() ) {
         if( 1 ) {
+            SCENE_PROFILE_COUNT( "Resolver.setPass.hit", 1 );
             return it->second;
         }
-        delete it->second;
+        RenderAction::release( m_arena, it->second );
         m_set_pass_cache.erase( it );
     }
 
+    const string id = pass->key();
     SCENELOG_TRACE( log, "Creating id=" <<id );
-    RenderAction* action = RenderAction::createSetPass( id, pass );
-    m_set_pass_cache[ action->m_id ] = action;
+    RenderAction* action = RenderAction::createSetPass( m_arena, id, pass );
+    SCENE_PROFILE_COUNT( "Resolver.setPass.miss", 1 );
+    m_set_pass_cache[ key ] = action;
     return action;
 }
 
@@ -543,23 +523,26 @@ Resolver::setInputs( const Pass*      pass,
                            const Geometry*  geometry,
                            const Primitives*  primitives )
 {
-    Logger log = getLogger( package + ".resolveInputs" );
+    static const Logger log = getLogger( package + ".resolveInputs" );
 
-    const string id = pass->key() + "@" + primitives->key();
+    const CacheKey<2> key( pass, primitives );
 
-    auto it = m_set_inputs_cache.find( id );
+    auto it = m_set_inputs_cache.find( key );
     if( it != m_set_inputs_cache.end() ) {
         // Todo: check timestamps
         if( 1 ) {
+            SCENE_PROFILE_COUNT( "Resolver.setInputs.hit", 1 );
             return it->second;
         }
 
-        delete it->second;
+        RenderAction::release( m_arena, it->second );
         m_set_inputs_cache.erase( it );
     }
 
+    const string id = pass->key() + "@" + primitives->key();
     SCENELOG_TRACE( log, "Creating id=" << id );
-    RenderAction* action = RenderAction::createSetInputs( m_database,
+    RenderAction* action = RenderAction::createSetInputs( m_arena,
+                                                          m_database,
                                                           id,
                                                           pass,
                                                           geometry,
@@ -568,7 +551,8 @@ Resolver::setInputs( const Pass*      pass,
         SCENELOG_FATAL( log, "action==NULL @" << __LINE__ );
         return NULL;
     }
-    m_set_inputs_cache[ action->m_id ] = action;
+    SCENE_PROFILE_COUNT( "Resolver.setInputs.miss", 1 );
+    m_set_inputs_cache[ key ] = action;
     return action;
 }
 
@@ -578,7 +562,7 @@ Resolver::resolveParams( const std::vector<Bind>&  bind,
                          const Material*  material,
                          const Pass*      pass )
 {
-    Logger log = getLogger( package + ".resolveParams" );
+    static const Logger log = getLogger( package + ".resolveParams" );
 
     if( !bind.empty() ) {
         SCENELOG_WARN( log, "non-empty bind currently ignored..." );
@@ -588,9 +572,9 @@ Resolver::resolveParams( const std::vector<Bind>&  bind,
     const Profile* profile = technique->profile();
     const Effect* effect = profile->effect();
 
-    const string id = pass->key() + "@" + material->id();
+    const CacheKey<2> key( pass, material );
 
-    auto it = m_resolved_params_cache.find( id );
+    auto it = m_resolved_params_cache.find( key );
     if( it != m_resolved_params_cache.end() ) {
         // Make sure that pointers are the same
         if( (material  == it->second->m_material) &&
@@ -612,6 +596,7 @@ Resolver::resolveParams( const std::vector<Bind>&  bind,
             //{
                 // We can use the cached version
                 SCENELOG_TRACE( log, "Found existing, timestamp=" << it->second->m_timestamp.debugString() );
+                SCENE_PROFILE_COUNT( "Resolver.resolveParams.hit", 1 );
                 return it->second;
             }
             else {
@@ -628,6 +613,7 @@ Resolver::resolveParams( const std::vector<Bind>&  bind,
         m_resolved_params_cache.erase( it );
     }
 
+    const string id = pass->key() + "@" + material->id();
     ResolvedParams* params = new ResolvedParams;
     params->m_id = id;
     params->m_timestamp.touch();
@@ -692,7 +678,8 @@ Resolver::resolveParams( const std::vector<Bind>&  bind,
         }
     }
 
-    m_resolved_params_cache[ params->m_id ] = params;
+    SCENE_PROFILE_COUNT( "Resolver.resolveParams.miss", 1 );
+    m_resolved_params_cache[ key ] = params;
 
     SCENELOG_TRACE( log, "Created new, timestamp=" << params->m_timestamp.debugString() );
 
@@ -705,29 +692,32 @@ Resolver::setSamplers( const ResolvedParams* params )
     if( params == NULL ) {
         return NULL;
     }
-    Logger log = getLogger( package + ".setSamplers" );
-    const string id = params->m_id;
+    static const Logger log = getLogger( package + ".setSamplers" );
+    const CacheKey<2> key( params->m_pass, params->m_material );
     //SCENELOG_DEBUG( log, params->m_timestamp.string() );
 
-    auto it = m_set_samplers_cache.find( id );
+    auto it = m_set_samplers_cache.find( key );
     if( it != m_set_samplers_cache.end() ) {
         if( it->second->m_timestamp.asRecentAs( params->m_timestamp ) ) {
         //if( it->second->m_timestamp.asFreshAs( params->m_timestamp ) ) {
+            SCENE_PROFILE_COUNT( "Resolver.setSamplers.hit", 1 );
             return it->second;
         }
         SCENELOG_TRACE( log,
                        "params_timestamp=" << params->m_timestamp.debugString() <<
                        ", set_samplers_timestamp=" << it->second->m_timestamp.debugString() );
-        delete it->second;
-        m_set_uniforms_cache.erase( it );
+        RenderAction::release( m_arena, it->second );
+        m_set_samplers_cache.erase( it );
     }
 
-    RenderAction* action = RenderAction::createSetSamplers( m_database,
-                                                            id,
+    RenderAction* action = RenderAction::createSetSamplers( m_arena,
+                                                            m_database,
+                                                            params->m_id,
                                                             params,
                                                             params->m_pass );
     if( action != NULL ) {
-        m_set_samplers_cache[ id ] = action;
+        SCENE_PROFILE_COUNT( "Resolver.setSamplers.miss", 1 );
+        m_set_samplers_cache[ key ] = action;
     }
     return action;
 }
@@ -739,7 +729,7 @@ Resolver::setUniforms( const RenderAction*               set_samplers,
                        const Material*                   material,
                        const Pass*                       pass )
 {
-    Logger log = getLogger( package + ".setUniforms" );
+    static const Logger log = getLogger( package + ".setUniforms" );
 
     if( !bind.empty() ) {
         SCENELOG_WARN( log, "Non-empty bind-list, ignored!" );
@@ -751,24 +741,27 @@ Resolver::setUniforms( const RenderAction*               set_samplers,
         return NULL;
     }
 
-    const string id = params->m_id;
+    const CacheKey<2> key( pass, material );
 
-    auto it = m_set_uniforms_cache.find( id );
+    auto it = m_set_uniforms_cache.find( key );
     if( it != m_set_uniforms_cache.end() ) {
         if( it->second->m_timestamp.asRecentAs( params->m_timestamp ) ) {
+            SCENE_PROFILE_COUNT( "Resolver.setUniforms.hit", 1 );
             return it->second;
         }
-        SCENELOG_DEBUG( log, "Cached version out of date (id='" << id << "')" );
-        delete it->second;
+        SCENELOG_DEBUG( log, "Cached version out of date (id='" << params->m_id << "')" );
+        RenderAction::release( m_arena, it->second );
         m_set_uniforms_cache.erase( it );
     }
 
-    SCENELOG_TRACE( log, "Creating id=" <<id );
-    RenderAction* action = RenderAction::createSetUniforms( id,
+    SCENELOG_TRACE( log, "Creating id=" << params->m_id );
+    RenderAction* action = RenderAction::createSetUniforms( m_arena,
+                                                            params->m_id,
                                                             set_samplers,
                                                             params,
                                                             pass );
-    m_set_uniforms_cache[ action->m_id ] = action;
+    SCENE_PROFILE_COUNT( "Resolver.setUniforms.miss", 1 );
+    m_set_uniforms_cache[ key ] = action;
     return action;
 }
 
@@ -781,28 +774,31 @@ Resolver::draw( const Geometry*    geometry,
         return NULL;
     }
 
-    const string id = primitives->key() + pass->key();
+    const CacheKey<2> key( primitives, pass );
 
-    auto it = m_draw_cache.find( id );
+    auto it = m_draw_cache.find( key );
     if( it != m_draw_cache.end() ) {
         RenderAction* cached = it->second;
         if( cached->m_timestamp.asRecentAs( geometry->structureChanged() ) ) {
 //        if( !geometry->asset().majorChanges( cached->m_timestamp ) ) {
 //        if( cached->m_timestamp.asFreshAs( geometry->asset(). timeStamp() ) ) {
+            SCENE_PROFILE_COUNT( "Resolver.draw.hit", 1 );
             return cached;
         }
-        delete cached;
+        RenderAction::release( m_arena, it->second );
         m_draw_cache.erase( it );
     }
 
+    const string id = primitives->key() + pass->key();
     RenderAction* action;
     if( primitives->indexBufferId().empty() ) {
-        action = RenderAction::createDraw( id, geometry, primitives, pass );
+        action = RenderAction::createDraw( m_arena, id, geometry, primitives, pass );
     }
     else {
-        action = RenderAction::createDrawIndexed( m_database, id, geometry, primitives, pass );
+        action = RenderAction::createDrawIndexed( m_arena, m_database, id, geometry, primitives, pass );
     }
-    m_draw_cache[ action->m_id ] = action;
+    SCENE_PROFILE_COUNT( "Resolver.draw.miss", 1 );
+    m_draw_cache[ key ] = action;
     return action;
 }
 
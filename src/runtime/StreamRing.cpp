@@ -0,0 +1,100 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <scene/Log.hpp>
+#include <scene/runtime/StreamRing.hpp>
+
+namespace Scene {
+    namespace Runtime {
+
+static const std::string package = "Scene.Runtime.StreamRing";
+
+StreamRingBackend::~StreamRingBackend()
+{
+}
+
+StreamRing::StreamRing( StreamRingBackend& backend, size_t regions )
+    : m_backend( backend ),
+      m_regions( std::max( regions, static_cast<size_t>( 1u ) ) ),
+      m_region_size( 0 ),
+      m_region( 0 ),
+      m_used( 0 ),
+      m_base( NULL )
+{
+}
+
+bool
+StreamRing::begin( size_t bytes )
+{
+    m_used = 0;
+    if( (m_base != NULL) && (bytes <= m_region_size) ) {
+        m_region = (m_region + 1) % m_regions;
+        m_backend.wait( m_region );
+        return true;
+    }
+
+    static const Logger log = getLogger( package + ".begin" );
+    for( size_t i=0; i<m_regions; i++ ) {
+        m_backend.wait( i );
+    }
+    // Grow geometrically and keep regions aligned to 256 bytes, which
+    // satisfies any alignment passed to allocate in practice.
+    size_t size = std::max( bytes, 2*m_region_size );
+    size = (size + 255u) & ~static_cast<size_t>( 255u );
+    m_base = m_backend.map( m_regions*size );
+    if( m_base == NULL ) {
+        SCENELOG_ERROR( log, "Failed to map " << (m_regions*size) << " bytes." );
+        m_region_size = 0;
+        return false;
+    }
+    SCENELOG_DEBUG( log, "Mapped " << m_regions << " regions of " << size << " bytes." );
+    m_region_size = size;
+    m_region = 0;
+    return true;
+}
+
+size_t
+StreamRing::allocate( size_t bytes, size_t alignment )
+{
+    const size_t offset = ((m_used + alignment - 1u)/alignment)*alignment;
+    if( (m_base == NULL) || (m_region_size < offset + bytes) ) {
+        return none();
+    }
+    m_used = offset + bytes;
+    return m_region*m_region_size + offset;
+}
+
+void
+StreamRing::commit()
+{
+    if( (m_base != NULL) && (m_used > 0) ) {
+        m_backend.flush( m_region*m_region_size, m_used );
+    }
+}
+
+void
+StreamRing::end()
+{
+    if( m_base != NULL ) {
+        m_backend.fence( m_region );
+    }
+}
+
+    } // of namespace Runtime
+} // of namespace Scene
@@ -0,0 +1,187 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ *
+ * This file is part of Scene.
+ *
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <thread>
+#include <scene/Log.hpp>
+#include <scene/runtime/ThreadPool.hpp>
+
+namespace Scene {
+    namespace Runtime {
+
+static const std::string package = "Scene.Runtime.ThreadPool";
+
+ThreadPool&
+ThreadPool::shared()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+size_t
+ThreadPool::hardwareThreads()
+{
+#ifdef SCENE_USE_THREADS
+    return std::max( 1u, std::thread::hardware_concurrency() );
+#else
+    return 1;
+#endif
+}
+
+#ifdef SCENE_USE_THREADS
+
+ThreadPool::ThreadPool()
+    : m_generation( 0 ),
+      m_die( false ),
+      m_open( false ),
+      m_helpers( 0 ),
+      m_active( 0 ),
+      m_task( NULL ),
+      m_data( NULL ),
+      m_n( 0 ),
+      m_next( 0 )
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_die = true;
+        m_worker_cond.notify_all();
+    }
+    for( auto it=m_workers.begin(); it!=m_workers.end(); ++it ) {
+        it->join();
+    }
+}
+
+size_t
+ThreadPool::workers() const
+{
+    return m_workers.size();
+}
+
+void
+ThreadPool::run( size_t n, size_t threads, Task task, void* data )
+{
+    threads = std::min( threads, n );
+    std::unique_lock<std::mutex> job( m_job_mutex, std::defer_lock );
+    if( (threads <= 1) || !job.try_lock() ) {
+        for( size_t i=0; i<n; i++ ) {
+            task( data, i );
+        }
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        if( m_workers.size() < threads-1 ) {
+            static const Logger log = getLogger( package + ".run" );
+            SCENELOG_DEBUG( log, "Growing pool from " << m_workers.size() << " to " << (threads-1) << " workers." );
+            while( m_workers.size() < threads-1 ) {
+                m_workers.push_back( std::thread( &ThreadPool::worker, this ) );
+            }
+        }
+        m_task = task;
+        m_data = data;
+        m_n = n;
+        m_next = 0;
+        m_helpers = threads-1;
+        m_open = true;
+        m_generation++;
+        m_worker_cond.notify_all();
+    }
+    work();
+    {
+        // All tasks are claimed, wait for the workers that claimed some.
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_open = false;
+        while( m_active > 0 ) {
+            m_done_cond.wait( lock );
+        }
+    }
+}
+
+void
+ThreadPool::work()
+{
+    while( 1 ) {
+        const size_t i = m_next.fetch_add( 1 );
+        if( i >= m_n ) {
+            break;
+        }
+        m_task( m_data, i );
+    }
+}
+
+void
+ThreadPool::worker()
+{
+    unsigned int generation = 0;
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while( 1 ) {
+        while( !m_die && (m_generation == generation) ) {
+            m_worker_cond.wait( lock );
+        }
+        if( m_die ) {
+            break;
+        }
+        generation = m_generation;
+        if( !m_open || (m_helpers == 0) ) {
+            continue;
+        }
+        m_helpers--;
+        m_active++;
+        lock.unlock();
+        work();
+        lock.lock();
+        m_active--;
+        if( m_active == 0 ) {
+            m_done_cond.notify_all();
+        }
+    }
+}
+
+#else
+
+ThreadPool::ThreadPool()
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+}
+
+size_t
+ThreadPool::workers() const
+{
+    return 0;
+}
+
+void
+ThreadPool::run( size_t n, size_t threads, Task task, void* data )
+{
+    for( size_t i=0; i<n; i++ ) {
+        task( data, i );
+    }
+}
+
+#endif
+
+    } // of namespace Runtime
+} // of namespace Scene
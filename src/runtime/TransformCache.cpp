@@ -17,15 +17,13 @@
  */
 
 #define _USE_MATH_DEFINES
-#ifdef SCENE_USE_THREADS
-#include <atomic>
-#endif
 
 #include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <string>
+#include <thread>
 #include <algorithm>
 #include "scene/Log.hpp"
 #include "scene/Camera.hpp"
@@ -35,6 +33,8 @@
 #include <scene/Utils.hpp>
 #include "scene/runtime/TransformCache.hpp"
 #include <scene/runtime/TransformCompute.hpp>
+#include <scene/runtime/ThreadPool.hpp>
+#include <scene/Profiler.hpp>
 
 
 namespace Scene {
@@ -49,8 +49,12 @@ static const string package = "Scene.Runtime.TransformCache";
 TransformCache::TransformCache(const DataBase &database, const bool use_threadpool)
     : m_database( database ),
       m_use_threadpool( use_threadpool ),
-      m_has_dumped( false )
+      m_worker_threads( 0 ),
+      m_has_dumped( false ),
+      m_incremental( false ),
+      m_last_update_count( 0 )
 {
+    std::fill_n( m_incremental_sizes, static_cast<size_t>( INCREMENTAL_PASSES ), 0u );
     m_bias_matrix = Value::createFloat4x4( 0.5f, 0.0f, 0.0f, 0.0f,
                                            0.0f, 0.5f, 0.0f, 0.0f,
                                            0.0f, 0.0f, 0.5f, 0.0f,
@@ -59,197 +63,301 @@ TransformCache::TransformCache(const DataBase &database, const bool use_threadpo
 
     m_default_fbo_size = Value::createFloat2( 1.f, 1.f );
 #ifdef SCENE_USE_THREADS
+    m_schedule.m_epoch = 0;
+    std::fill_n( m_schedule.m_sizes, 4, 0u );
     if( m_use_threadpool ) {
-        m_thread_pool.m_state = ThreadPool::THROTTLE;
-        for(size_t i=0; i<4; i++ ) {
-            m_thread_pool.m_workers.push_back( std::thread( ThreadPool::worker, this ) );
-        }
-        Logger log = getLogger( package + "TransformCache" );
-        SCENELOG_DEBUG( log, "Created threadpool with " << m_thread_pool.m_workers.size() << " threads" );
+        m_worker_threads = ThreadPool::hardwareThreads() - 1;
     }
 #endif
 }
 
 TransformCache::~TransformCache()
+{
+    purge();
+}
+
+void
+TransformCache::setWorkerThreads( size_t threads )
 {
 #ifdef SCENE_USE_THREADS
     if( m_use_threadpool ) {
-        std::unique_lock<std::mutex> lock( m_thread_pool.m_mutex );
-        m_thread_pool.m_state = ThreadPool::DIE;
-        m_thread_pool.m_worker_cond.notify_all();
-        lock.unlock();
-        for(auto it=m_thread_pool.m_workers.begin(); it!=m_thread_pool.m_workers.end(); ++it ) {
-            it->join();
-        }
-        Logger log = getLogger( package + "~TransformCache" );
-        SCENELOG_DEBUG( log, "Joined " << m_thread_pool.m_workers.size() << " threads in threadpool" );
+        m_worker_threads = threads;
     }
 #endif
-    purge();
 }
 
 #ifdef SCENE_USE_THREADS
+bool
+TransformCache::threadedStale() const
+{
+    return !m_schedule.m_built.asRecentAs( m_last_purge )
+            || m_schedule.m_chunk_begin.empty()
+            || m_schedule.m_sizes[0] != m_pass1_values.size()
+            || m_schedule.m_sizes[1] != m_branch_transform.size()
+            || m_schedule.m_sizes[2] != m_path_transform.size()
+            || m_schedule.m_sizes[3] != m_pass4_values.size();
+}
+
 void
-TransformCache::ThreadPool::worker( TransformCache* that )
+TransformCache::threadedBuild()
 {
-    while(1) {
-        std::unique_lock<std::mutex> lock( that->m_thread_pool.m_mutex );
-        while( that->m_thread_pool.m_state == ThreadPool::THROTTLE ) {
-            that->m_thread_pool.m_worker_cond.wait( lock );
+    static const Logger log = getLogger( package + ".threadedBuild" );
+    Schedule& schedule = m_schedule;
+    const size_t chunk_size = 64;
+
+    schedule.m_sizes[0] = m_pass1_values.size();
+    schedule.m_sizes[1] = m_branch_transform.size();
+    schedule.m_sizes[2] = m_path_transform.size();
+    schedule.m_sizes[3] = m_pass4_values.size();
+
+    schedule.m_chunk_pass.clear();
+    schedule.m_chunk_begin.clear();
+    schedule.m_chunk_end.clear();
+    size_t first_chunk[ 4 ];
+    for( unsigned char p=0; p<4; p++ ) {
+        first_chunk[p] = schedule.m_chunk_begin.size();
+        for( size_t b=0; b<schedule.m_sizes[p]; b+=chunk_size ) {
+            schedule.m_chunk_pass.push_back( p );
+            schedule.m_chunk_begin.push_back( b );
+            schedule.m_chunk_end.push_back( std::min( b+chunk_size, schedule.m_sizes[p] ) );
         }
-        if( that->m_thread_pool.m_state == ThreadPool::DIE ) {
-            break;
-        }
-        else if( that->m_thread_pool.m_iteration_next < that->m_thread_pool.m_iteration_total ) {
-            size_t i = that->m_thread_pool.m_iteration_next;
-            size_t n = std::min( (size_t)100u,
-                                 that->m_thread_pool.m_iteration_total - i );
-            that->m_thread_pool.m_iteration_next += n;
-            PoolState s = that->m_thread_pool.m_state;
-            lock.unlock();
-
-            switch( s ) {
-            case COMPUTE_PASS1:
-                for( size_t k=0; k<n; k++ ) {
-                    TransformCache::CacheItem<1>& item = that->m_pass1_values[i+k];
-                    switch( item.m_action ) {
-                    case PASS1_DEDUCE_COSINE_OF_RADIAN_ANGLE:
-                        TransformCompute::cosine( item.m_value, item.m_source_values[0] );
-                        break;
-                    case PASS1_DEDUCE_RECIPROCAL_VEC2:
-                        TransformCompute::reciprocal( item.m_value, item.m_source_values[0] );
-                        break;
-                    case PASS1_COMPUTE_CAMERA_PROJECTION:
-                        TransformCompute::projection( item.m_value, item.m_source_camera );
-                        break;
-                    case PASS1_COMPUTE_CAMERA_PROJECTION_INVERSE:
-                        TransformCompute::projectionInverse( item.m_value, item.m_source_camera );
-                        break;
-                    case PASS1_COMPUTE_NODE_TRANSFORM:
-                        TransformCompute::nodeTransform( item.m_value, item.m_source_node );
-                        break;
-                    case PASS1_COMPUTE_NODE_TRANSFORM_INVERSE:
-                        TransformCompute::nodeInverseTransform( item.m_value, item.m_source_node );
-                        break;
-                    default:
-                        break;
-                    }
+    }
+    const size_t chunks = schedule.m_chunk_begin.size();
+
+    // Map from values produced by the cache to the chunk that computes them.
+    std::unordered_map<const Value*, size_t> produced;
+    produced.reserve( schedule.m_sizes[0] + schedule.m_sizes[1] + schedule.m_sizes[2] + schedule.m_sizes[3] );
+    for( size_t i=0; i<m_pass1_values.size(); i++ ) {
+        produced[ m_pass1_values[i].m_value ] = first_chunk[0] + i/chunk_size;
+    }
+    for( size_t i=0; i<m_branch_transform.size(); i++ ) {
+        produced[ m_branch_transform[i].m_value ] = first_chunk[1] + i/chunk_size;
+    }
+    for( size_t i=0; i<m_path_transform.size(); i++ ) {
+        produced[ m_path_transform[i].m_value ] = first_chunk[2] + i/chunk_size;
+    }
+
+    // Only dependencies on earlier chunks are recorded; chunks are claimed in
+    // order, which guarantees progress. Dependencies within a chunk are
+    // satisfied by computing the chunk in order.
+    schedule.m_dep_offsets.assign( 1, 0 );
+    schedule.m_deps.clear();
+    std::vector<size_t> deps;
+    for( size_t c=0; c<chunks; c++ ) {
+        deps.clear();
+        auto addValue = [&]( const Value* value ) {
+            if( value != NULL ) {
+                auto it = produced.find( value );
+                if( (it != produced.end()) && (it->second < c) ) {
+                    deps.push_back( it->second );
                 }
-                break;
-            case COMPUTE_BRANCH_TRANSFORM:
-                for( size_t k=0; k<n; k++ ) {
-                    TransformCache::CacheItem<SCENE_PATH_MAX>& item = that->m_branch_transform[i+k];
-                    TransformCompute::multiplyMatrices( item.m_value, item.m_N, item.m_source_values );
+            }
+        };
+        for( size_t i=schedule.m_chunk_begin[c]; i<schedule.m_chunk_end[c]; i++ ) {
+            switch( schedule.m_chunk_pass[c] ) {
+            case 0:
+                if( (m_pass1_values[i].m_action == PASS1_DEDUCE_COSINE_OF_RADIAN_ANGLE) ||
+                    (m_pass1_values[i].m_action == PASS1_DEDUCE_RECIPROCAL_VEC2) )
+                {
+                    addValue( m_pass1_values[i].m_source_values[0] );
                 }
                 break;
-            case COMPUTE_PATH_TRANSFORM:
-                for( size_t k=0; k<n; k++ ) {
-                    TransformCache::CacheItem<SCENE_PATH_MAX>& item = that->m_path_transform[i+k];
-                    TransformCompute::multiplyMatrices( item.m_value, item.m_N, item.m_source_values );
+            case 1:
+                for( size_t k=0; k<m_branch_transform[i].m_N; k++ ) {
+                    addValue( m_branch_transform[i].m_source_values[k] );
                 }
                 break;
-            case COMPUTE_PASS5:
-                for( size_t k=0; k<n; k++ ) {
-                    TransformCache::CacheItem<SCENE_PATH_MAX>& item = that->m_pass4_values[i+k];
-                    switch( item.m_action )
-                    {
-                    case PASS5_PRODUCT_UPPER3X3_TRANSPOSE:
-                        TransformCompute::transposedUpper3x3( item.m_value, item.m_N, item.m_source_values );
-                        break;
-                    case PASS5_SUBSET_POSTMULTIPLY_ORIGIN:
-                        TransformCompute::transformOrigin(  item.m_value, item.m_N, item.m_source_values );
-                        break;
-                    case PASS5_SUBSET_PREMULTIPLY_Z:
-                        TransformCompute::transformZAxis( item.m_value, item.m_N, item.m_source_values );
-                        break;
-                    case PASS5_CHECK_BBOX_IN_FRUSTUM:
-                        TransformCompute::boundingBoxTest( item.m_value, item.m_N, item.m_source_values );
-                        break;
-                    case MULTIPLY_MATRICES:
-                        TransformCompute::multiplyMatrices( item.m_value, item.m_N, item.m_source_values );
-                        break;
-                    default:
-                        break;
-                    }
+            case 2:
+                for( size_t k=0; k<m_path_transform[i].m_N; k++ ) {
+                    addValue( m_path_transform[i].m_source_values[k] );
                 }
                 break;
-            default:
+            case 3:
+                for( size_t k=0; k<m_pass4_values[i].m_N; k++ ) {
+                    addValue( m_pass4_values[i].m_source_values[k] );
+                }
                 break;
             }
+        }
+        std::sort( deps.begin(), deps.end() );
+        deps.erase( std::unique( deps.begin(), deps.end() ), deps.end() );
+        schedule.m_deps.insert( schedule.m_deps.end(), deps.begin(), deps.end() );
+        schedule.m_dep_offsets.push_back( schedule.m_deps.size() );
+    }
 
-            lock.lock();
-            that->m_thread_pool.m_iteration_done += n;
-            if( that->m_thread_pool.m_iteration_done >= that->m_thread_pool.m_iteration_total ) {
-
-                // Am I the last thread to finish this pass?
-                that->m_thread_pool.m_iteration_next = 0;
-                that->m_thread_pool.m_iteration_done = 0;
-                switch( that->m_thread_pool.m_state ) {
-                case COMPUTE_PASS1:
-                    that->m_thread_pool.m_state = COMPUTE_BRANCH_TRANSFORM;
-                    that->m_thread_pool.m_iteration_total = that->m_branch_transform.size();
-                    that->m_thread_pool.m_worker_cond.notify_all();
-                    break;
-
-                case COMPUTE_BRANCH_TRANSFORM:
-                    that->m_thread_pool.m_state = COMPUTE_PATH_TRANSFORM;
-                    that->m_thread_pool.m_iteration_total = that->m_path_transform.size();
-                    that->m_thread_pool.m_worker_cond.notify_all();
-                    break;
-
-                case COMPUTE_PATH_TRANSFORM:
-                    that->m_thread_pool.m_state = COMPUTE_PASS5;
-                    that->m_thread_pool.m_iteration_total = that->m_pass4_values.size();
-                    that->m_thread_pool.m_worker_cond.notify_all();
-                    break;
-                case COMPUTE_PASS5:
-                    that->m_thread_pool.m_state = THROTTLE;
-                    that->m_thread_pool.m_iteration_total = 0;
-                default:
-                    that->m_thread_pool.m_master_cond.notify_one();
-                }
-            }
+    schedule.m_chunk_done.reset( new std::atomic<unsigned int>[ chunks ] );
+    for( size_t c=0; c<chunks; c++ ) {
+        schedule.m_chunk_done[c] = 0u;
+    }
+    schedule.m_epoch = 0;
+    schedule.m_built.touch();
+
+    SCENELOG_DEBUG( log, "Built schedule of " << chunks << " chunks with "
+                    << schedule.m_deps.size() << " dependencies." );
+}
+
+void
+TransformCache::threadedCompute( const size_t chunk, const unsigned int epoch )
+{
+    Schedule& schedule = m_schedule;
+    for( size_t d=schedule.m_dep_offsets[chunk]; d<schedule.m_dep_offsets[chunk+1]; d++ ) {
+        const size_t dep = schedule.m_deps[d];
+        while( schedule.m_chunk_done[dep].load( std::memory_order_acquire ) != epoch ) {
+            std::this_thread::yield();
         }
     }
+    const size_t b = schedule.m_chunk_begin[ chunk ];
+    const size_t e = schedule.m_chunk_end[ chunk ];
+    switch( schedule.m_chunk_pass[ chunk ] ) {
+    case 0:
+        for( size_t i=b; i<e; i++ ) {
+            computePass1( m_pass1_values[i] );
+        }
+        break;
+    case 1:
+        TransformCompute::multiplyMatricesBatch( &m_branch_transform[b], e-b );
+        break;
+    case 2:
+        TransformCompute::multiplyMatricesBatch( &m_path_transform[b], e-b );
+        break;
+    case 3:
+        for( size_t i=b; i<e; i++ ) {
+            computePass4( m_pass4_values[i] );
+        }
+        break;
+    }
 }
 
 void
 TransformCache::threadedUpdate()
 {
-    {
-        // Set up a compute pass
-        std::unique_lock<std::mutex> lock( m_thread_pool.m_mutex );
-        m_thread_pool.m_state = ThreadPool::COMPUTE_PASS1;
-        m_thread_pool.m_iteration_next = 0;
-        m_thread_pool.m_iteration_total = m_pass1_values.size();
-        m_thread_pool.m_iteration_done = 0;
-        // Trigger workers in thread pool to start.
-        m_thread_pool.m_worker_cond.notify_all();
-        // wait for workers in thread pool to finish.
-        while( m_thread_pool.m_state != ThreadPool::THROTTLE ) {
-            m_thread_pool.m_master_cond.wait( lock );
+    SCENE_PROFILE_SCOPE( "TransformCache::threadedUpdate" );
+    Schedule& schedule = m_schedule;
+    if( threadedStale() ) {
+        threadedBuild();
+    }
+    unsigned int epoch = ++schedule.m_epoch;
+    if( epoch == 0 ) {  // wrapped, reset completion stamps
+        for( size_t c=0; c<schedule.m_chunk_begin.size(); c++ ) {
+            schedule.m_chunk_done[c] = 0u;
         }
+        epoch = ++schedule.m_epoch;
+    }
+    // The pool claims chunks in order, so the chunks a chunk waits for have
+    // been claimed by threads that are computing them.
+    ThreadPool::shared().parallelFor( schedule.m_chunk_begin.size(), m_worker_threads+1, [&]( size_t c ) {
+        threadedCompute( c, epoch );
+        schedule.m_chunk_done[c].store( epoch, std::memory_order_release );
+    } );
+}
+#endif
 
+void
+TransformCache::computePass1( CacheItem<1>& item )
+{
+    switch( item.m_action ) {
+    case PASS1_DEDUCE_COSINE_OF_RADIAN_ANGLE:
+        TransformCompute::cosine( item.m_value, item.m_source_values[0] );
+        break;
+    case PASS1_DEDUCE_RECIPROCAL_VEC2:
+        TransformCompute::reciprocal( item.m_value, item.m_source_values[0] );
+        break;
+    case PASS1_COMPUTE_CAMERA_PROJECTION:
+        TransformCompute::projection( item.m_value, item.m_source_camera );
+        break;
+    case PASS1_COMPUTE_CAMERA_PROJECTION_INVERSE:
+        TransformCompute::projectionInverse( item.m_value, item.m_source_camera );
+        break;
+    case PASS1_COMPUTE_NODE_TRANSFORM:
+        TransformCompute::nodeTransform( item.m_value, item.m_source_node );
+        break;
+    case PASS1_COMPUTE_NODE_TRANSFORM_INVERSE:
+        TransformCompute::nodeInverseTransform( item.m_value, item.m_source_node );
+        break;
+    default:
+        break;
+    }
+}
+
+void
+TransformCache::computePass4( CacheItem<SCENE_PATH_MAX>& item )
+{
+    switch( item.m_action )
+    {
+    case PASS5_PRODUCT_UPPER3X3_TRANSPOSE:
+        TransformCompute::transposedUpper3x3( item.m_value, item.m_N, item.m_source_values );
+        break;
+    case PASS5_SUBSET_POSTMULTIPLY_ORIGIN:
+        TransformCompute::transformOrigin(  item.m_value, item.m_N, item.m_source_values );
+        break;
+    case PASS5_SUBSET_PREMULTIPLY_Z:
+        TransformCompute::transformZAxis( item.m_value, item.m_N, item.m_source_values );
+        break;
+    case PASS5_CHECK_BBOX_IN_FRUSTUM:
+        TransformCompute::boundingBoxTest( item.m_value, item.m_N, item.m_source_values );
+        break;
+    case MULTIPLY_MATRICES:
+        TransformCompute::multiplyMatrices( item.m_value, item.m_N, item.m_source_values );
+        break;
+    default:
+        break;
+    }
+}
+
+void
+TransformCache::setIncrementalUpdate( bool incremental )
+{
+    if( m_incremental != incremental ) {
+        m_incremental = incremental;
+        m_incremental_source_offsets.clear();   // force rebuild when enabled again
     }
 }
-#endif
 
 void
 TransformCache::update( unsigned int m_default_fbo_width,
                         unsigned int m_default_fbo_height )
 {
+    SCENE_PROFILE_SCOPE( "TransformCache::update" );
+    // Only touch the default FBO size if it has changed, so that entries
+    // derived from it are not recomputed every frame.
+    const float* fbo_size = m_default_fbo_size.floatData();
+    if( (fbo_size[0] != m_default_fbo_width) || (fbo_size[1] != m_default_fbo_height ) ) {
+        m_default_fbo_size = Value::createFloat2( m_default_fbo_width,
+                                                  m_default_fbo_height );
+    }
+
+    if( m_incremental ) {
+        if( !incrementalStale() ) {
+            updateIncremental();
+            SCENE_PROFILE_COUNT( "TransformCache.update.entries", m_last_update_count );
+            return;
+        }
+        // Entries are only added between purges.
+        const bool appended = !m_incremental_source_offsets.empty()
+                              && m_incremental_built.asRecentAs( m_last_purge );
+        incrementalBuild( appended );
+        if( appended ) {
+            updateIncremental();
+            SCENE_PROFILE_COUNT( "TransformCache.update.entries", m_last_update_count );
+            return;
+        }
+    }
 
-    m_default_fbo_size = Value::createFloat2( m_default_fbo_width,
-                                              m_default_fbo_height );
+    m_last_update_count = m_pass1_values.size()
+                        + m_branch_transform.size()
+                        + m_path_transform.size()
+                        + m_pass4_values.size();
+    SCENE_PROFILE_COUNT( "TransformCache.update.entries", m_last_update_count );
 #ifdef SCENE_USE_THREADS
-    if( m_use_threadpool ) {
+    // Small caches are cheaper to update serially than to hand out to the pool.
+    if( m_use_threadpool && (m_worker_threads > 0) && (m_last_update_count >= 1024) ) {
 
         if( !m_has_dumped ) {
-            Logger log = getLogger( package + ".update" );
-            SCENELOG_ERROR( log, "pass 1 = " << m_pass1_values.size() << " items" );
-            SCENELOG_ERROR( log, "pass 2 = " << m_branch_transform.size() << " items" );
-            SCENELOG_ERROR( log, "pass 3 = " << m_path_transform.size() << " items" );
-            SCENELOG_ERROR( log, "pass 4 = " << m_pass4_values.size() << " items" );
+            static const Logger log = getLogger( package + ".update" );
+            SCENELOG_DEBUG( log, "pass 1 = " << m_pass1_values.size() << " items" );
+            SCENELOG_DEBUG( log, "pass 2 = " << m_branch_transform.size() << " items" );
+            SCENELOG_DEBUG( log, "pass 3 = " << m_path_transform.size() << " items" );
+            SCENELOG_DEBUG( log, "pass 4 = " << m_pass4_values.size() << " items" );
             m_has_dumped = true;
         }
 
@@ -258,77 +366,290 @@ TransformCache::update( unsigned int m_default_fbo_width,
     }
 #endif
 
-    for( auto it=m_pass1_values.begin(); it!=m_pass1_values.end(); ++it ) {
-        TransformCache::CacheItem<1>& item = *it;
+    {
+        SCENE_PROFILE_SCOPE( "TransformCache::update pass 1" );
+        for( auto it=m_pass1_values.begin(); it!=m_pass1_values.end(); ++it ) {
+            computePass1( *it );
+        }
+    }
+    if( !m_branch_transform.empty() ) {
+        SCENE_PROFILE_SCOPE( "TransformCache::update pass 2" );
+        TransformCompute::multiplyMatricesBatch( &m_branch_transform[0], m_branch_transform.size() );
+    }
+    if( !m_path_transform.empty() ) {
+        SCENE_PROFILE_SCOPE( "TransformCache::update pass 3" );
+        TransformCompute::multiplyMatricesBatch( &m_path_transform[0], m_path_transform.size() );
+    }
+    {
+        SCENE_PROFILE_SCOPE( "TransformCache::update pass 4" );
+        for( auto it=m_pass4_values.begin(); it!=m_pass4_values.end(); ++it ) {
+            computePass4( *it );
+        }
+    }
+}
+
+bool
+TransformCache::incrementalStale() const
+{
+    return m_incremental_source_offsets.empty()
+            || !m_incremental_built.asRecentAs( m_last_purge )
+            || m_incremental_sizes[0] != m_pass1_values.size()
+            || m_incremental_sizes[1] != m_branch_transform.size()
+            || m_incremental_sizes[2] != m_path_transform.size()
+            || m_incremental_sizes[3] != m_pass4_values.size();
+}
+
+void
+TransformCache::incrementalBuild( bool appended )
+{
+    static const Logger log = getLogger( package + ".incrementalBuild" );
+
+    size_t previous_sizes[ INCREMENTAL_PASSES ];
+    std::copy_n( m_incremental_sizes, INCREMENTAL_PASSES, previous_sizes );
+    std::unordered_map<const SeqPos*, SeqPos> previous_seen;
+    if( appended ) {
+        for( auto it=m_incremental_sources.begin(); it!=m_incremental_sources.end(); ++it ) {
+            previous_seen[ it->m_changed ] = it->m_seen;
+        }
+    }
+
+    m_incremental_sizes[0] = m_pass1_values.size();
+    m_incremental_sizes[1] = m_branch_transform.size();
+    m_incremental_sizes[2] = m_path_transform.size();
+    m_incremental_sizes[3] = m_pass4_values.size();
+    size_t offsets[ INCREMENTAL_PASSES+1 ];
+    offsets[0] = 0;
+    for( size_t p=0; p<INCREMENTAL_PASSES; p++ ) {
+        offsets[p+1] = offsets[p] + m_incremental_sizes[p];
+    }
+    const size_t entries = offsets[ INCREMENTAL_PASSES ];
+
+    // Map from values produced by the cache to entry index.
+    std::unordered_map<const Value*, size_t> produced;
+    produced.reserve( entries );
+    for( size_t i=0; i<m_pass1_values.size(); i++ ) {
+        produced[ m_pass1_values[i].m_value ] = offsets[0] + i;
+    }
+    for( size_t i=0; i<m_branch_transform.size(); i++ ) {
+        produced[ m_branch_transform[i].m_value ] = offsets[1] + i;
+    }
+    for( size_t i=0; i<m_path_transform.size(); i++ ) {
+        produced[ m_path_transform[i].m_value ] = offsets[2] + i;
+    }
+    for( size_t i=0; i<m_pass4_values.size(); i++ ) {
+        produced[ m_pass4_values[i].m_value ] = offsets[3] + i;
+    }
+
+    // Collect (source, entry) and (entry, dependent) edges.
+    std::unordered_map<const SeqPos*, size_t> source_index;
+    std::vector< std::pair<size_t,size_t> > source_edges;
+    std::vector< std::pair<size_t,size_t> > entry_edges;
+    m_incremental_sources.clear();
+
+    auto addSource = [&]( const SeqPos* changed, size_t entry ) {
+        auto it = source_index.find( changed );
+        size_t s;
+        if( it == source_index.end() ) {
+            s = m_incremental_sources.size();
+            source_index[ changed ] = s;
+            IncrementalSource source;
+            source.m_changed = changed;
+            source.m_seen = *changed;
+            auto jt = previous_seen.find( changed );
+            if( jt != previous_seen.end() ) {
+                source.m_seen = jt->second;
+            }
+            m_incremental_sources.push_back( source );
+        }
+        else {
+            s = it->second;
+        }
+        source_edges.push_back( std::make_pair( s, entry ) );
+    };
+    auto addValue = [&]( const Value* value, size_t entry ) {
+        if( value == NULL ) {
+            return;
+        }
+        auto it = produced.find( value );
+        if( it == produced.end() ) {
+            addSource( &value->valueChanged(), entry );
+        }
+        else {
+            if( entry <= it->second ) {
+                SCENELOG_ERROR( log, "Entry " << entry << " depends on later entry " << it->second );
+            }
+            entry_edges.push_back( std::make_pair( it->second, entry ) );
+        }
+    };
+
+    for( size_t i=0; i<m_pass1_values.size(); i++ ) {
+        const CacheItem<1>& item = m_pass1_values[i];
         switch( item.m_action ) {
         case PASS1_DEDUCE_COSINE_OF_RADIAN_ANGLE:
-            TransformCompute::cosine( item.m_value, item.m_source_values[0] );
-            break;
         case PASS1_DEDUCE_RECIPROCAL_VEC2:
-            TransformCompute::reciprocal( item.m_value, item.m_source_values[0] );
+            addValue( item.m_source_values[0], offsets[0] + i );
             break;
         case PASS1_COMPUTE_CAMERA_PROJECTION:
-            TransformCompute::projection( item.m_value, item.m_source_camera );
-            break;
         case PASS1_COMPUTE_CAMERA_PROJECTION_INVERSE:
-            TransformCompute::projectionInverse( item.m_value, item.m_source_camera );
+            if( item.m_source_camera != NULL ) {
+                addSource( &item.m_source_camera->valueChanged(), offsets[0] + i );
+            }
             break;
         case PASS1_COMPUTE_NODE_TRANSFORM:
-            TransformCompute::nodeTransform( item.m_value, item.m_source_node );
-            break;
         case PASS1_COMPUTE_NODE_TRANSFORM_INVERSE:
-            TransformCompute::nodeInverseTransform( item.m_value, item.m_source_node );
+            if( item.m_source_node != NULL ) {
+                addSource( &item.m_source_node->valueChanged(), offsets[0] + i );
+            }
             break;
         default:
             break;
         }
     }
-    for( auto it=m_branch_transform.begin(); it!=m_branch_transform.end(); ++it ) {
-        TransformCache::CacheItem<SCENE_PATH_MAX>& item = *it;
-        TransformCompute::multiplyMatrices( item.m_value, item.m_N, item.m_source_values );
+    for( size_t i=0; i<m_branch_transform.size(); i++ ) {
+        const CacheItem<SCENE_PATH_MAX>& item = m_branch_transform[i];
+        for( size_t k=0; k<item.m_N; k++ ) {
+            addValue( item.m_source_values[k], offsets[1] + i );
+        }
     }
-    for( auto it=m_path_transform.begin(); it!=m_path_transform.end(); ++it ) {
-        TransformCache::CacheItem<SCENE_PATH_MAX>& item = *it;
-        TransformCompute::multiplyMatrices( item.m_value, item.m_N, item.m_source_values );
+    for( size_t i=0; i<m_path_transform.size(); i++ ) {
+        const CacheItem<SCENE_PATH_MAX>& item = m_path_transform[i];
+        for( size_t k=0; k<item.m_N; k++ ) {
+            addValue( item.m_source_values[k], offsets[2] + i );
+        }
     }
-    for( auto it=m_pass4_values.begin(); it!=m_pass4_values.end(); ++it ) {
-        TransformCache::CacheItem<SCENE_PATH_MAX>& item = *it;
-        switch( item.m_action )
-        {
-        case PASS5_PRODUCT_UPPER3X3_TRANSPOSE:
-            TransformCompute::transposedUpper3x3( item.m_value, item.m_N, item.m_source_values );
-            break;
-        case PASS5_SUBSET_POSTMULTIPLY_ORIGIN:
-            TransformCompute::transformOrigin(  item.m_value, item.m_N, item.m_source_values );
-            break;
-        case PASS5_SUBSET_PREMULTIPLY_Z:
-            TransformCompute::transformZAxis( item.m_value, item.m_N, item.m_source_values );
-            break;
-        case PASS5_CHECK_BBOX_IN_FRUSTUM:
-            TransformCompute::boundingBoxTest( item.m_value, item.m_N, item.m_source_values );
-            break;
-        case MULTIPLY_MATRICES:
-            TransformCompute::multiplyMatrices( item.m_value, item.m_N, item.m_source_values );
-            break;
-        default:
-            break;
+    for( size_t i=0; i<m_pass4_values.size(); i++ ) {
+        const CacheItem<SCENE_PATH_MAX>& item = m_pass4_values[i];
+        for( size_t k=0; k<item.m_N; k++ ) {
+            addValue( item.m_source_values[k], offsets[3] + i );
+        }
+    }
+
+    // Pack edges into compressed adjacency lists.
+    const size_t sources = m_incremental_sources.size();
+    m_incremental_source_offsets.assign( sources+1, 0 );
+    for( auto it=source_edges.begin(); it!=source_edges.end(); ++it ) {
+        m_incremental_source_offsets[ it->first + 1 ]++;
+    }
+    for( size_t s=0; s<sources; s++ ) {
+        m_incremental_source_offsets[s+1] += m_incremental_source_offsets[s];
+    }
+    m_incremental_source_entries.resize( source_edges.size() );
+    {
+        std::vector<size_t> fill( m_incremental_source_offsets.begin(),
+                                  m_incremental_source_offsets.end()-1 );
+        for( auto it=source_edges.begin(); it!=source_edges.end(); ++it ) {
+            m_incremental_source_entries[ fill[ it->first ]++ ] = it->second;
+        }
+    }
+
+    m_incremental_entry_offsets.assign( entries+1, 0 );
+    for( auto it=entry_edges.begin(); it!=entry_edges.end(); ++it ) {
+        m_incremental_entry_offsets[ it->first + 1 ]++;
+    }
+    for( size_t e=0; e<entries; e++ ) {
+        m_incremental_entry_offsets[e+1] += m_incremental_entry_offsets[e];
+    }
+    m_incremental_entry_dependents.resize( entry_edges.size() );
+    {
+        std::vector<size_t> fill( m_incremental_entry_offsets.begin(),
+                                  m_incremental_entry_offsets.end()-1 );
+        for( auto it=entry_edges.begin(); it!=entry_edges.end(); ++it ) {
+            m_incremental_entry_dependents[ fill[ it->first ]++ ] = it->second;
+        }
+    }
+
+    m_incremental_dirty.assign( entries, 0 );
+    for( size_t p=0; p<INCREMENTAL_PASSES; p++ ) {
+        m_incremental_worklist[p].clear();
+    }
+    if( appended ) {
+        for( size_t p=0; p<INCREMENTAL_PASSES; p++ ) {
+            for( size_t e=offsets[p] + previous_sizes[p]; e<offsets[p+1]; e++ ) {
+                incrementalMark( e );
+            }
+        }
+    }
+    m_incremental_built.touch();
+
+    SCENELOG_DEBUG( log, "Built dependency graph of " << entries << " entries, "
+                    << sources << " sources, "
+                    << source_edges.size() + entry_edges.size() << " edges." );
+}
+
+void
+TransformCache::incrementalMark( size_t entry )
+{
+    if( m_incremental_dirty[ entry ] == 0 ) {
+        m_incremental_dirty[ entry ] = 1;
+        size_t pass = 0;
+        size_t offset = m_incremental_sizes[0];
+        while( offset <= entry ) {
+            offset += m_incremental_sizes[ ++pass ];
+        }
+        m_incremental_worklist[ pass ].push_back( entry );
+    }
+}
+
+void
+TransformCache::updateIncremental()
+{
+    // Find sources that have moved forward since last update.
+    for( size_t s=0; s<m_incremental_sources.size(); s++ ) {
+        IncrementalSource& source = m_incremental_sources[s];
+        if( source.m_seen.moveForward( *source.m_changed ) ) {
+            for( size_t k=m_incremental_source_offsets[s]; k<m_incremental_source_offsets[s+1]; k++ ) {
+                incrementalMark( m_incremental_source_entries[k] );
+            }
+        }
+    }
+
+    // Process passes in order, flagging dependents as we go.
+    m_last_update_count = 0;
+    size_t offset = 0;
+    for( size_t p=0; p<INCREMENTAL_PASSES; p++ ) {
+        std::vector<size_t>& worklist = m_incremental_worklist[p];
+        std::sort( worklist.begin(), worklist.end() );
+        for( auto it=worklist.begin(); it!=worklist.end(); ++it ) {
+            const size_t e = *it;
+            const size_t i = e - offset;
+            switch( p ) {
+            case 0:
+                computePass1( m_pass1_values[i] );
+                break;
+            case 1:
+                TransformCompute::multiplyMatrices( m_branch_transform[i].m_value,
+                                                    m_branch_transform[i].m_N,
+                                                    m_branch_transform[i].m_source_values );
+                break;
+            case 2:
+                TransformCompute::multiplyMatrices( m_path_transform[i].m_value,
+                                                    m_path_transform[i].m_N,
+                                                    m_path_transform[i].m_source_values );
+                break;
+            case 3:
+                computePass4( m_pass4_values[i] );
+                break;
+            }
+            m_incremental_dirty[e] = 0;
+            for( size_t k=m_incremental_entry_offsets[e]; k<m_incremental_entry_offsets[e+1]; k++ ) {
+                incrementalMark( m_incremental_entry_dependents[k] );
+            }
         }
+        m_last_update_count += worklist.size();
+        worklist.clear();
+        offset += m_incremental_sizes[p];
     }
 }
 
 void
 TransformCache::purge()
 {
-    Logger log = getLogger( package + ".purge" );
+    SCENE_PROFILE_SCOPE( "TransformCache::purge" );
+    static const Logger log = getLogger( package + ".purge" );
     SCENELOG_DEBUG( log, "Purging contents." );
 
-    for( auto it=m_pass1_values.begin(); it!=m_pass1_values.end(); ++it ) {
-#ifdef SCENE_CHECK_TYPES
-        it->m_value->undefine();
-#endif
-        delete it->m_value;
-    }
     m_pass1_values.clear();
+    m_pass1_storage.clear();
     m_deduced_values_lut.clear();
     m_camera_projection_lut.clear();
     m_camera_inverse_projection_lut.clear();
@@ -340,38 +661,23 @@ TransformCache::purge()
     //m_node_transform_cache.clear();
     //m_node_transform_inverse_cache.clear();
 
-    for( auto it=m_branch_transform.begin(); it!=m_branch_transform.end(); ++it ) {
-#ifdef SCENE_CHECK_TYPES
-        it->m_value->undefine();
-#endif
-        delete it->m_value;
-    }
     m_branch_transform.clear();
+    m_branch_storage.clear();
     m_branch_transform_lut.clear();
     m_branch_inverse_transform_lut.clear();
     //m_branch_transform_cache.clear();
     //m_branch_transform_inverse_cache.clear();
 
-    for( auto it=m_path_transform.begin(); it!=m_path_transform.end(); ++it ) {
-#ifdef SCENE_CHECK_TYPES
-        it->m_value->undefine();
-#endif
-        delete it->m_value;
-    }
     m_path_transform.clear();
+    m_path_storage.clear();
     m_path_transform_lut.clear();
     m_path_inverse_transform_lut.clear();
     //m_path_transform_cache.clear();
     //m_path_transform_inverse_cache.clear();
 
 
-    for( auto it=m_pass4_values.begin(); it!=m_pass4_values.end(); ++it ) {
-#ifdef SCENE_CHECK_TYPES
-        it->m_value->undefine();
-#endif
-        delete it->m_value;
-    }
     m_pass4_values.clear();
+    m_pass4_storage.clear();
     m_matrix_composition_lut.clear();
     m_transform_origin_lut.clear();
     m_premultiply_z_lut.clear();
@@ -405,7 +711,7 @@ TransformCache::cosineOfRadianAngle( const Value* source )
     }
     else {
         CacheItem<1> item;
-        item.m_value = new Value( Value::createFloat(0.f) );
+        item.m_value = m_pass1_storage.allocate( Value::createFloat(0.f) );
         item.m_value->valueChanged().invalidate();
         item.m_action = PASS1_DEDUCE_COSINE_OF_RADIAN_ANGLE;
         item.m_source_values[0] = source;
@@ -441,7 +747,7 @@ TransformCache::reciprocalOfVec2( const Value* source )
     }
     else {
         CacheItem<1> item;
-        item.m_value = new Value( Value::createFloat2(0.f, 0.f) );
+        item.m_value = m_pass1_storage.allocate( Value::createFloat2(0.f, 0.f) );
         item.m_value->valueChanged().invalidate();
         item.m_action = PASS1_DEDUCE_RECIPROCAL_VEC2;
         item.m_source_values[0] = source;
@@ -478,10 +784,10 @@ TransformCache::cameraProjectionMatrix( const Camera* camera )
     }
     else {
         CacheItem<1> item;
-        item.m_value = new Value( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
-                                                         0.f, 1.f, 0.f, 0.f,
-                                                         0.f, 0.f, 1.f, 0.f,
-                                                         0.f, 0.f, 0.f, 1.f ) );
+        item.m_value = m_pass1_storage.allocate( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
+                                                                        0.f, 1.f, 0.f, 0.f,
+                                                                        0.f, 0.f, 1.f, 0.f,
+                                                                        0.f, 0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
         item.m_action = PASS1_COMPUTE_CAMERA_PROJECTION;
         item.m_source_camera = camera;
@@ -521,10 +827,10 @@ TransformCache::cameraProjectionMatrixInverse( const Camera* camera )
     }
     else {
         CacheItem<1> item;
-        item.m_value = new Value( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
-                                                         0.f, 1.f, 0.f, 0.f,
-                                                         0.f, 0.f, 1.f, 0.f,
-                                                         0.f, 0.f, 0.f, 1.f ) );
+        item.m_value = m_pass1_storage.allocate( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
+                                                                        0.f, 1.f, 0.f, 0.f,
+                                                                        0.f, 0.f, 1.f, 0.f,
+                                                                        0.f, 0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
         item.m_action = PASS1_COMPUTE_CAMERA_PROJECTION_INVERSE;
         item.m_source_camera = camera;
@@ -561,7 +867,7 @@ TransformCache::nodeTransformMatrix( const Node* node )
 {
 #ifdef DEBUG
     // Check that node is valid
-    Logger log = getLogger( package + ".nodeTransformMatrix" );
+    static const Logger log = getLogger( package + ".nodeTransformMatrix" );
     for( size_t i=0; i<node->transforms(); i++ ) {
         const TransformType type = node->transformType(i);
         switch( type ) {
@@ -589,10 +895,10 @@ TransformCache::nodeTransformMatrix( const Node* node )
     }
     else {
         CacheItem<1> item;
-        item.m_value = new Value( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
-                                                         0.f, 1.f, 0.f, 0.f,
-                                                         0.f, 0.f, 1.f, 0.f,
-                                                         0.f, 0.f, 0.f, 1.f ) );
+        item.m_value = m_pass1_storage.allocate( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
+                                                                        0.f, 1.f, 0.f, 0.f,
+                                                                        0.f, 0.f, 1.f, 0.f,
+                                                                        0.f, 0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
         item.m_action = PASS1_COMPUTE_NODE_TRANSFORM;
         item.m_source_node = node;
@@ -633,10 +939,10 @@ TransformCache::nodeTransformInverseMatrix( const Node* node )
     }
     else {
         CacheItem<1> item;
-        item.m_value = new Value( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
-                                                         0.f, 1.f, 0.f, 0.f,
-                                                         0.f, 0.f, 1.f, 0.f,
-                                                         0.f, 0.f, 0.f, 1.f ) );
+        item.m_value = m_pass1_storage.allocate( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
+                                                                        0.f, 1.f, 0.f, 0.f,
+                                                                        0.f, 0.f, 1.f, 0.f,
+                                                                        0.f, 0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
         item.m_action = PASS1_COMPUTE_NODE_TRANSFORM_INVERSE;
         item.m_source_node = node;
@@ -677,10 +983,10 @@ TransformCache::branchTransformMatrix( const Node* root, const Node* leaf )
     else {
 
         CacheItem<SCENE_PATH_MAX> item;
-        item.m_value = new Value( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
-                                                         0.f, 1.f, 0.f, 0.f,
-                                                         0.f, 0.f, 1.f, 0.f,
-                                                         0.f, 0.f, 0.f, 1.f ) );
+        item.m_value = m_branch_storage.allocate( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
+                                                                         0.f, 1.f, 0.f, 0.f,
+                                                                         0.f, 0.f, 1.f, 0.f,
+                                                                         0.f, 0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
 
         // Branches are inclusive, and the root should never be NULL. We can
@@ -690,7 +996,7 @@ TransformCache::branchTransformMatrix( const Node* root, const Node* leaf )
         const Value* path[ SCENE_PATH_MAX ];
         while( leaf != root ) {
             if( SCENE_PATH_MAX <= N ) {
-                Logger log = getLogger( package + ".branchTransformMatrix" );
+                static const Logger log = getLogger( package + ".branchTransformMatrix" );
                 SCENELOG_FATAL( log, "Branch length is " << N << ", and is larger than SCENE_PATH_MAX" );
                 break;
             }
@@ -730,7 +1036,7 @@ TransformCache::branchTransformMatrix( const Node* root, const Node* leaf )
         const Value* path[ SCENE_PATH_MAX ];
         while( leaf != root ) {
             if( SCENE_PATH_MAX <= N ) {
-                Logger log = getLogger( package + ".branchTransformMatrix" );
+                static const Logger log = getLogger( package + ".branchTransformMatrix" );
                 SCENELOG_FATAL( log, "Branch length is " << N << ", and is larger than SCENE_PATH_MAX" );
                 break;
             }
@@ -763,10 +1069,10 @@ TransformCache::branchTransformInverseMatrix( const Node* root, const Node* leaf
     }
     else {
         CacheItem<SCENE_PATH_MAX> item;
-        item.m_value = new Value( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
-                                                         0.f, 1.f, 0.f, 0.f,
-                                                         0.f, 0.f, 1.f, 0.f,
-                                                         0.f, 0.f, 0.f, 1.f ) );
+        item.m_value = m_branch_storage.allocate( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
+                                                                         0.f, 1.f, 0.f, 0.f,
+                                                                         0.f, 0.f, 1.f, 0.f,
+                                                                         0.f, 0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
 
         // Branches are inclusive, and the root should never be NULL. We can
@@ -779,7 +1085,7 @@ TransformCache::branchTransformInverseMatrix( const Node* root, const Node* leaf
         size_t i=0;
         while( leaf != root ) {
             if( SCENE_PATH_MAX <= i ) {
-                Logger log = getLogger( package + ".branchTransformInverseMatrix" );
+                static const Logger log = getLogger( package + ".branchTransformInverseMatrix" );
                 SCENELOG_FATAL( log, "Branch length is " << i << ", and is larger than SCENE_PATH_MAX" );
                 break;
             }
@@ -815,7 +1121,7 @@ TransformCache::branchTransformInverseMatrix( const Node* root, const Node* leaf
         size_t i=0;
         while( leaf != root ) {
             if( SCENE_PATH_MAX <= i ) {
-                Logger log = getLogger( package + ".branchTransformInverseMatrix" );
+                static const Logger log = getLogger( package + ".branchTransformInverseMatrix" );
                 SCENELOG_FATAL( log, "Branch length is " << i << ", and is larger than SCENE_PATH_MAX" );
                 break;
             }
@@ -853,10 +1159,10 @@ TransformCache::pathTransformMatrix( const Node* const (&path)[SCENE_PATH_MAX] )
             item.m_source_values[i] = branchTransformMatrix( path[2*i+0],
                                                              path[2*i+1] );
         }
-        item.m_value = new Value( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
-                                                         0.f, 1.f, 0.f, 0.f,
-                                                         0.f, 0.f, 1.f, 0.f,
-                                                         0.f, 0.f, 0.f, 1.f ) );
+        item.m_value = m_path_storage.allocate( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
+                                                                       0.f, 1.f, 0.f, 0.f,
+                                                                       0.f, 0.f, 1.f, 0.f,
+                                                                       0.f, 0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
         item.m_N = i;
         m_path_transform_lut.insert( key, m_path_transform.size() );
@@ -921,10 +1227,10 @@ TransformCache::pathTransformInverseMatrix( const Node* const (&path)[SCENE_PATH
                                                                         path[2*i+1] );
 
         }
-        item.m_value = new Value( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
-                                                         0.f, 1.f, 0.f, 0.f,
-                                                         0.f, 0.f, 1.f, 0.f,
-                                                         0.f, 0.f, 0.f, 1.f ) );
+        item.m_value = m_path_storage.allocate( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
+                                                                       0.f, 1.f, 0.f, 0.f,
+                                                                       0.f, 0.f, 1.f, 0.f,
+                                                                       0.f, 0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
         item.m_N = N;
         m_path_inverse_transform_lut.insert( key,  m_path_transform.size() );
@@ -982,10 +1288,10 @@ TransformCache::matrixComposition( const Value* M0, const Value* M1, const Value
     else {
         CacheItem<SCENE_PATH_MAX> item;
         item.m_action = MULTIPLY_MATRICES;
-        item.m_value = new Value( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
-                                                         0.f, 1.f, 0.f, 0.f,
-                                                         0.f, 0.f, 1.f, 0.f,
-                                                         0.f, 0.f, 0.f, 1.f ) );
+        item.m_value = m_pass4_storage.allocate( Value::createFloat4x4( 1.f, 0.f, 0.f, 0.f,
+                                                                        0.f, 1.f, 0.f, 0.f,
+                                                                        0.f, 0.f, 1.f, 0.f,
+                                                                        0.f, 0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
 
         unsigned int N = 0;
@@ -1047,9 +1353,9 @@ TransformCache::matrixProductUpper3x3Transpose( const Value* A, const Value* B )
     else {
         CacheItem<SCENE_PATH_MAX> item;
         item.m_action = PASS5_PRODUCT_UPPER3X3_TRANSPOSE;
-        item.m_value = new Value( Value::createFloat3x3( 1.f, 0.f, 0.f,
-                                                         0.f, 1.f, 0.f,
-                                                         0.f, 0.f, 1.f ) );
+        item.m_value = m_pass4_storage.allocate( Value::createFloat3x3( 1.f, 0.f, 0.f,
+                                                                        0.f, 1.f, 0.f,
+                                                                        0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
         unsigned int N=0;
         item.m_source_values[N] = A;
@@ -1100,7 +1406,7 @@ TransformCache::matrixSubsetPostmultiplyOrigin( const Value* A, const Value* B )
     else {
         CacheItem<SCENE_PATH_MAX> item;
         item.m_action = PASS5_SUBSET_POSTMULTIPLY_ORIGIN;
-        item.m_value = new Value( Value::createFloat3( 0.f, 0.f, 0.f ) );
+        item.m_value = m_pass4_storage.allocate( Value::createFloat3( 0.f, 0.f, 0.f ) );
         item.m_value->valueChanged().invalidate();
         unsigned int N=0;
         item.m_source_values[N] = A;
@@ -1148,7 +1454,7 @@ TransformCache::matrixSubsetPremultiplyZ( const Value* A, const Value* B  )
     else {
         CacheItem<SCENE_PATH_MAX> item;
         item.m_action = PASS5_SUBSET_PREMULTIPLY_Z;
-        item.m_value = new Value( Value::createFloat3( 0.f, 0.f, 1.f ) );
+        item.m_value = m_pass4_storage.allocate( Value::createFloat3( 0.f, 0.f, 1.f ) );
         item.m_value->valueChanged().invalidate();
         unsigned int N=0;
         item.m_source_values[N] = A;
@@ -1192,7 +1498,7 @@ TransformCache::checkBoundingBox( const SetViewCoordSys*   view_coords,
                                   const SetLocalCoordSys*  local_coords,
                                   const Geometry*          geometry )
 {
-    Logger log = getLogger( package + ".checkBoundingBox" );
+    static const Logger log = getLogger( package + ".checkBoundingBox" );
     SCENELOG_ASSERT( log, view_coords != NULL );
     SCENELOG_ASSERT( log, local_coords != NULL );
     SCENELOG_ASSERT( log, geometry != NULL );
@@ -1204,7 +1510,7 @@ TransformCache::checkBoundingBox( const SetViewCoordSys*   view_coords,
     }
     else {
         CacheItem<SCENE_PATH_MAX> item;
-        item.m_value = new Value( Value::createBool( GL_TRUE ) );
+        item.m_value = m_pass4_storage.allocate( Value::createBool( GL_TRUE ) );
         item.m_value->valueChanged().invalidate();
         item.m_action = PASS5_CHECK_BBOX_IN_FRUSTUM;
         if( geometry->boundingBox( item.m_source_values[0],
@@ -1262,7 +1568,7 @@ TransformCache::runtimeSemantic( RuntimeSemantic          semantic,
                                  const SetViewCoordSys*   view_coords,
                                  const SetLocalCoordSys*  local_coords )
 {
-    Logger log = getLogger( package + ".runtimeSemantic" );
+    static const Logger log = getLogger( package + ".runtimeSemantic" );
 
     const Value* t;
 
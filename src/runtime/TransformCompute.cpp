@@ -21,7 +21,12 @@
 #include <tmmintrin.h>
 #include <smmintrin.h>
 #endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCENE_X86_KERNELS
+#include <immintrin.h>
+#endif
 
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 #include <glm/glm.hpp>
@@ -103,6 +108,396 @@ static const std::string toString( const __m128& val )
 
 //#endif
 
+// --- 4x4 matrix product kernels ----------------------------------------------
+//
+// All kernels calculate the column-major product dst = a*b, i.e., column j of
+// dst is the combination of the columns of a weighted by column j of b. Both
+// a and b are completely read before dst is written, so dst may alias a.
+
+static void
+multiply4x4Scalar( float* dst, const float* a, const float* b )
+{
+    float t[16];
+    for( unsigned int j=0; j<4; j++ ) {
+        for( unsigned int i=0; i<4; i++ ) {
+            t[4*j+i] = a[i]*b[4*j+0] + a[4+i]*b[4*j+1] + a[8+i]*b[4*j+2] + a[12+i]*b[4*j+3];
+        }
+    }
+    std::copy_n( t, 16, dst );
+}
+
+#ifdef SCENE_X86_KERNELS
+__attribute__((target("sse2")))
+static void
+multiply4x4SSE( float* dst, const float* a, const float* b )
+{
+    const __m128 a0 = _mm_loadu_ps( a + 0 );
+    const __m128 a1 = _mm_loadu_ps( a + 4 );
+    const __m128 a2 = _mm_loadu_ps( a + 8 );
+    const __m128 a3 = _mm_loadu_ps( a + 12 );
+    __m128 c[4];
+    for( unsigned int j=0; j<4; j++ ) {
+        __m128 t =           _mm_mul_ps( a0, _mm_set1_ps( b[4*j+0] ) );
+        t = _mm_add_ps( t, _mm_mul_ps( a1, _mm_set1_ps( b[4*j+1] ) ) );
+        t = _mm_add_ps( t, _mm_mul_ps( a2, _mm_set1_ps( b[4*j+2] ) ) );
+        c[j] = _mm_add_ps( t, _mm_mul_ps( a3, _mm_set1_ps( b[4*j+3] ) ) );
+    }
+    _mm_storeu_ps( dst + 0,  c[0] );
+    _mm_storeu_ps( dst + 4,  c[1] );
+    _mm_storeu_ps( dst + 8,  c[2] );
+    _mm_storeu_ps( dst + 12, c[3] );
+}
+
+// Two columns of the result per 256-bit register.
+__attribute__((target("avx2,fma")))
+static void
+multiply4x4AVX2( float* dst, const float* a, const float* b )
+{
+    const __m256 a0 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( a + 0 ) );
+    const __m256 a1 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( a + 4 ) );
+    const __m256 a2 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( a + 8 ) );
+    const __m256 a3 = _mm256_broadcast_ps( reinterpret_cast<const __m128*>( a + 12 ) );
+    const __m256 b01 = _mm256_loadu_ps( b + 0 );
+    const __m256 b23 = _mm256_loadu_ps( b + 8 );
+    __m256 c01 =         _mm256_mul_ps( a0, _mm256_permute_ps( b01, 0x00 ) );
+    c01 = _mm256_fmadd_ps( a1, _mm256_permute_ps( b01, 0x55 ), c01 );
+    c01 = _mm256_fmadd_ps( a2, _mm256_permute_ps( b01, 0xaa ), c01 );
+    c01 = _mm256_fmadd_ps( a3, _mm256_permute_ps( b01, 0xff ), c01 );
+    __m256 c23 =         _mm256_mul_ps( a0, _mm256_permute_ps( b23, 0x00 ) );
+    c23 = _mm256_fmadd_ps( a1, _mm256_permute_ps( b23, 0x55 ), c23 );
+    c23 = _mm256_fmadd_ps( a2, _mm256_permute_ps( b23, 0xaa ), c23 );
+    c23 = _mm256_fmadd_ps( a3, _mm256_permute_ps( b23, 0xff ), c23 );
+    _mm256_storeu_ps( dst + 0, c01 );
+    _mm256_storeu_ps( dst + 8, c23 );
+}
+
+// The whole result in one 512-bit register. Some GCC versions flag the
+// undefined pass-through operand inside the intrinsics as uninitialized.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+__attribute__((target("avx512f")))
+static void
+multiply4x4AVX512( float* dst, const float* a, const float* b )
+{
+    const __m512 A = _mm512_loadu_ps( a );
+    const __m512 B = _mm512_loadu_ps( b );
+    __m512 c =         _mm512_mul_ps( _mm512_shuffle_f32x4( A, A, 0x00 ), _mm512_shuffle_ps( B, B, 0x00 ) );
+    c = _mm512_fmadd_ps( _mm512_shuffle_f32x4( A, A, 0x55 ), _mm512_shuffle_ps( B, B, 0x55 ), c );
+    c = _mm512_fmadd_ps( _mm512_shuffle_f32x4( A, A, 0xaa ), _mm512_shuffle_ps( B, B, 0xaa ), c );
+    c = _mm512_fmadd_ps( _mm512_shuffle_f32x4( A, A, 0xff ), _mm512_shuffle_ps( B, B, 0xff ), c );
+    _mm512_storeu_ps( dst, c );
+}
+#pragma GCC diagnostic pop
+#endif
+
+typedef void (*Multiply4x4Func)( float* dst, const float* a, const float* b );
+
+static Multiply4x4Func
+kernelFunc( TransformCompute::Kernel kernel )
+{
+    switch( kernel ) {
+#ifdef SCENE_X86_KERNELS
+    case TransformCompute::KERNEL_SSE:
+        return multiply4x4SSE;
+    case TransformCompute::KERNEL_AVX2:
+        return multiply4x4AVX2;
+    case TransformCompute::KERNEL_AVX512:
+        return multiply4x4AVX512;
+#endif
+    default:
+        return multiply4x4Scalar;
+    }
+}
+
+// --- Batched 4x4 matrix product kernels --------------------------------------
+//
+// These multiply several independent matrix sequences at once, one sequence
+// per SIMD lane. The matrices are kept in structure-of-arrays form, where
+// register e holds element e of the matrix of every lane, so a product is 64
+// multiply-adds across lanes without any shuffles. Each step transposes the
+// next matrix of every sequence into this form. Sequences that have ended and
+// unused lanes are padded with the identity. The arithmetic is done in the same
+// order as the single product kernel of the same instruction set, so results
+// are identical to multiplying each sequence on its own.
+
+typedef void (*MultiplyLanesFunc)( const unsigned int          lanes,
+                                   float* const*               dst,
+                                   const unsigned int*         N,
+                                   const Value* const* const*  src );
+
+static const float identity4x4[16] = {
+    1.f, 0.f, 0.f, 0.f,
+    0.f, 1.f, 0.f, 0.f,
+    0.f, 0.f, 1.f, 0.f,
+    0.f, 0.f, 0.f, 1.f
+};
+
+/** Matrix k of the sequence in lane l, identity if there is none. */
+static inline const float*
+laneMatrix( const unsigned int          lanes,
+            const unsigned int*         N,
+            const Value* const* const*  src,
+            const unsigned int          l,
+            const unsigned int          k )
+{
+    return (l < lanes) && (k < N[l]) ? src[l][k]->floatData() : identity4x4;
+}
+
+static unsigned int
+laneSteps( const unsigned int lanes, const unsigned int* N )
+{
+    unsigned int steps = 0;
+    for( unsigned int l=0; l<lanes; l++ ) {
+        steps = std::max( steps, N[l] );
+    }
+    return steps;
+}
+
+static void
+multiplyLanesScalar( const unsigned int          lanes,
+                     float* const*               dst,
+                     const unsigned int*         N,
+                     const Value* const* const*  src )
+{
+    for( unsigned int l=0; l<lanes; l++ ) {
+        float* d = dst[l];
+        std::copy_n( src[l][0]->floatData(), 16, d );
+        for( unsigned int k=1; k<N[l]; k++ ) {
+            multiply4x4Scalar( d, d, src[l][k]->floatData() );
+        }
+    }
+}
+
+#ifdef SCENE_X86_KERNELS
+// Four lanes per 128-bit register.
+__attribute__((target("sse2")))
+static void
+gatherLanesSSE( __m128* m,
+                const unsigned int          lanes,
+                const unsigned int*         N,
+                const Value* const* const*  src,
+                const unsigned int          k )
+{
+    for( unsigned int j=0; j<4; j++ ) {
+        __m128 r0 = _mm_loadu_ps( laneMatrix( lanes, N, src, 0, k ) + 4*j );
+        __m128 r1 = _mm_loadu_ps( laneMatrix( lanes, N, src, 1, k ) + 4*j );
+        __m128 r2 = _mm_loadu_ps( laneMatrix( lanes, N, src, 2, k ) + 4*j );
+        __m128 r3 = _mm_loadu_ps( laneMatrix( lanes, N, src, 3, k ) + 4*j );
+        _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+        m[4*j+0] = r0;
+        m[4*j+1] = r1;
+        m[4*j+2] = r2;
+        m[4*j+3] = r3;
+    }
+}
+
+__attribute__((target("sse2")))
+static void
+multiplyLanesSSE4( const unsigned int          lanes,
+                   float* const*               dst,
+                   const unsigned int*         N,
+                   const Value* const* const*  src )
+{
+    __m128 a[16];
+    __m128 b[16];
+    gatherLanesSSE( a, lanes, N, src, 0 );
+    const unsigned int steps = laneSteps( lanes, N );
+    for( unsigned int k=1; k<steps; k++ ) {
+        gatherLanesSSE( b, lanes, N, src, k );
+        __m128 c[16];
+        for( unsigned int j=0; j<4; j++ ) {
+            for( unsigned int i=0; i<4; i++ ) {
+                __m128 t =           _mm_mul_ps( a[i],    b[4*j+0] );
+                t = _mm_add_ps( t, _mm_mul_ps( a[4+i],  b[4*j+1] ) );
+                t = _mm_add_ps( t, _mm_mul_ps( a[8+i],  b[4*j+2] ) );
+                c[4*j+i] = _mm_add_ps( t, _mm_mul_ps( a[12+i], b[4*j+3] ) );
+            }
+        }
+        std::copy_n( c, 16, a );
+    }
+    for( unsigned int j=0; j<4; j++ ) {
+        __m128 r[4] = { a[4*j+0], a[4*j+1], a[4*j+2], a[4*j+3] };
+        _MM_TRANSPOSE4_PS( r[0], r[1], r[2], r[3] );
+        for( unsigned int l=0; l<lanes; l++ ) {
+            _mm_storeu_ps( dst[l] + 4*j, r[l] );
+        }
+    }
+}
+
+static void
+multiplyLanesSSE( const unsigned int          lanes,
+                  float* const*               dst,
+                  const unsigned int*         N,
+                  const Value* const* const*  src )
+{
+    for( unsigned int first=0; first<lanes; first+=4 ) {
+        multiplyLanesSSE4( std::min( 4u, lanes-first ), dst+first, N+first, src+first );
+    }
+}
+
+// Eight lanes per 256-bit register, also used by the AVX-512 kernel.
+__attribute__((target("avx2,fma")))
+static void
+gatherLanesAVX2( __m256* m,
+                 const unsigned int          lanes,
+                 const unsigned int*         N,
+                 const Value* const* const*  src,
+                 const unsigned int          k )
+{
+    for( unsigned int j=0; j<4; j++ ) {
+        __m128 r[8];
+        for( unsigned int l=0; l<8; l++ ) {
+            r[l] = _mm_loadu_ps( laneMatrix( lanes, N, src, l, k ) + 4*j );
+        }
+        _MM_TRANSPOSE4_PS( r[0], r[1], r[2], r[3] );
+        _MM_TRANSPOSE4_PS( r[4], r[5], r[6], r[7] );
+        for( unsigned int i=0; i<4; i++ ) {
+            m[4*j+i] = _mm256_insertf128_ps( _mm256_castps128_ps256( r[i] ), r[4+i], 1 );
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void
+multiplyLanesAVX2( const unsigned int          lanes,
+                   float* const*               dst,
+                   const unsigned int*         N,
+                   const Value* const* const*  src )
+{
+    __m256 a[16];
+    __m256 b[16];
+    gatherLanesAVX2( a, lanes, N, src, 0 );
+    const unsigned int steps = laneSteps( lanes, N );
+    for( unsigned int k=1; k<steps; k++ ) {
+        gatherLanesAVX2( b, lanes, N, src, k );
+        __m256 c[16];
+        for( unsigned int j=0; j<4; j++ ) {
+            for( unsigned int i=0; i<4; i++ ) {
+                __m256 t =         _mm256_mul_ps( a[i],    b[4*j+0] );
+                t = _mm256_fmadd_ps( a[4+i],  b[4*j+1], t );
+                t = _mm256_fmadd_ps( a[8+i],  b[4*j+2], t );
+                c[4*j+i] = _mm256_fmadd_ps( a[12+i], b[4*j+3], t );
+            }
+        }
+        std::copy_n( c, 16, a );
+    }
+    for( unsigned int j=0; j<4; j++ ) {
+        __m128 r[8];
+        for( unsigned int i=0; i<4; i++ ) {
+            r[i] = _mm256_castps256_ps128( a[4*j+i] );
+            r[4+i] = _mm256_extractf128_ps( a[4*j+i], 1 );
+        }
+        _MM_TRANSPOSE4_PS( r[0], r[1], r[2], r[3] );
+        _MM_TRANSPOSE4_PS( r[4], r[5], r[6], r[7] );
+        for( unsigned int l=0; l<lanes; l++ ) {
+            _mm_storeu_ps( dst[l] + 4*j, r[l] );
+        }
+    }
+}
+#endif
+
+static MultiplyLanesFunc
+lanesFunc( TransformCompute::Kernel kernel )
+{
+    switch( kernel ) {
+#ifdef SCENE_X86_KERNELS
+    case TransformCompute::KERNEL_SSE:
+        return multiplyLanesSSE;
+    case TransformCompute::KERNEL_AVX2:
+    case TransformCompute::KERNEL_AVX512:
+        return multiplyLanesAVX2;
+#endif
+    default:
+        return multiplyLanesScalar;
+    }
+}
+
+static TransformCompute::Kernel
+bestKernel()
+{
+    for( int k=TransformCompute::KERNEL_N-1; k>0; k-- ) {
+        if( TransformCompute::kernelSupported( static_cast<TransformCompute::Kernel>( k ) ) ) {
+            return static_cast<TransformCompute::Kernel>( k );
+        }
+    }
+    return TransformCompute::KERNEL_SCALAR;
+}
+
+static TransformCompute::Kernel current_kernel = bestKernel();
+static Multiply4x4Func          current_kernel_func = kernelFunc( current_kernel );
+static MultiplyLanesFunc        current_lanes_func = lanesFunc( current_kernel );
+
+TransformCompute::Kernel
+TransformCompute::kernel()
+{
+    return current_kernel;
+}
+
+bool
+TransformCompute::kernelSupported( Kernel kernel )
+{
+#ifdef SCENE_X86_KERNELS
+    __builtin_cpu_init();   // we might be invoked during static initialization
+#endif
+    switch( kernel ) {
+    case KERNEL_SCALAR:
+        return true;
+#ifdef SCENE_X86_KERNELS
+    case KERNEL_SSE:
+        return __builtin_cpu_supports( "sse2" );
+    case KERNEL_AVX2:
+        return __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" );
+    case KERNEL_AVX512:
+        return __builtin_cpu_supports( "avx512f" );
+#endif
+    default:
+        return false;
+    }
+}
+
+bool
+TransformCompute::setKernel( Kernel kernel )
+{
+    if( !kernelSupported( kernel ) ) {
+        return false;
+    }
+    current_kernel = kernel;
+    current_kernel_func = kernelFunc( kernel );
+    current_lanes_func = lanesFunc( kernel );
+    return true;
+}
+
+const char*
+TransformCompute::kernelName( Kernel kernel )
+{
+    switch( kernel ) {
+    case KERNEL_SCALAR: return "scalar";
+    case KERNEL_SSE:    return "sse";
+    case KERNEL_AVX2:   return "avx2";
+    case KERNEL_AVX512: return "avx512";
+    default:            return "unknown";
+    }
+}
+
+void
+TransformCompute::multiply4x4( float* dst, const float* a, const float* b )
+{
+    current_kernel_func( dst, a, b );
+}
+
+void
+TransformCompute::multiplyMatricesLanes( const unsigned int  lanes,
+                                         Value* const*       dst,
+                                         const unsigned int* N,
+                                         const Value* const* const* src )
+{
+    float* d[ batch_lanes ];
+    for( unsigned int l=0; l<lanes; l++ ) {
+        d[l] = dst[l]->m_payload.m_floats;
+    }
+    current_lanes_func( lanes, d, N, src );
+}
+
 void
 TransformCompute::cosine( Value* dst, const Value* src )
 {
@@ -450,58 +845,33 @@ TransformCompute::transposedUpper3x3( Value* dst, const unsigned int N, const Va
 }
 
 
-void
-TransformCompute::multiplyMatrices( Value* dst, const unsigned int N, const Value** src )
+bool
+TransformCompute::sourcesChanged( Value* dst, const size_t N, const Value* const* src )
 {
     bool modified = false;
-    for( unsigned int i=0 ; i<N; i++ ) {
+    for( size_t i=0 ; i<N; i++ ) {
         bool m = dst->valueChanged().moveForward( src[i]->valueChanged() );
         modified = modified | m;
     }
-    if( !modified || (N<1) ) {
-        return;
-    }
+    return modified && (N > 0);
+}
 
-#ifdef __SSE4_2__
-    __m128 Ar0 = _mm_load_ps( src[0]->floatData() + 0 );
-    __m128 Ar1 = _mm_load_ps( src[0]->floatData() + 4 );
-    __m128 Ar2 = _mm_load_ps( src[0]->floatData() + 8 );
-    __m128 Ar3 = _mm_load_ps( src[0]->floatData() + 12 );
-    if( N > 1 ) {
-        _MM_TRANSPOSE4_PS( Ar0, Ar1, Ar2, Ar3 );
-        for( unsigned int i=1; i<N; i++ ) {
-            _MM_MUL4TX4_PS( Ar0, Ar1, Ar2, Ar3, src[i]->floatData() );
-        }
-        _MM_TRANSPOSE4_PS(  Ar0, Ar1, Ar2, Ar3  );
+void
+TransformCompute::multiplyMatrices( Value* dst, const unsigned int N, const Value** src )
+{
+    if( !sourcesChanged( dst, N, src ) ) {
+        return;
     }
-    _mm_store_ps( dst->m_payload.m_floats +  0, Ar0 );   // _mm_stream_ps?
-    _mm_store_ps( dst->m_payload.m_floats +  4, Ar1 );
-    _mm_store_ps( dst->m_payload.m_floats +  8, Ar2 );
-    _mm_store_ps( dst->m_payload.m_floats + 12, Ar3 );
-#else
+    float* d = dst->m_payload.m_floats;
     if( N == 1 ) {
-        std::copy_n( src[0]->m_payload.m_floats, 16, dst->m_payload.m_floats );
+        std::copy_n( src[0]->floatData(), 16, d );
     }
     else {
-        const float* p = src[0]->floatData();
-        float M[16] = {                                                         // load first matrix transposed
-            p[0], p[4], p[8], p[12],
-            p[1], p[5], p[9], p[13],
-            p[2], p[6], p[10], p[14],
-            p[3], p[7], p[11], p[15]
-        };
-        for( unsigned int i=1; i<N; i++ ) {
-            _MUL4TX4_PS( M, src[i]->floatData() );
+        current_kernel_func( d, src[0]->floatData(), src[1]->floatData() );
+        for( unsigned int i=2; i<N; i++ ) {
+            current_kernel_func( d, d, src[i]->floatData() );
         }
-        const float Mt[16] = {                                                  // transpose result
-            M[0], M[4], M[8], M[12],
-            M[1], M[5], M[9], M[13],
-            M[2], M[6], M[10], M[14],
-            M[3], M[7], M[11], M[15]
-        };
-        std::copy_n( Mt, 16, dst->m_payload.m_floats );                         // store
     }
-#endif
 }
 
 
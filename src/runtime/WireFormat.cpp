@@ -0,0 +1,959 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+#include <scene/Log.hpp>
+#include <scene/Pass.hpp>
+#include <scene/Value.hpp>
+#include <scene/SourceBuffer.hpp>
+#include <scene/Profiler.hpp>
+#include <scene/runtime/WireFormat.hpp>
+
+namespace Scene {
+    namespace Runtime {
+
+static const std::string package = "Scene.Runtime.WireFormat";
+
+namespace {
+
+const uint32_t  wire_magic      = 0x574c5253u;  // "SRLW"
+const uint16_t  wire_version    = 1u;
+const uint16_t  flag_compressed = 1u;
+
+struct FrameHeader
+{
+    uint32_t    m_magic;
+    uint16_t    m_version;
+    uint16_t    m_flags;
+    uint32_t    m_raw_size;
+    uint32_t    m_payload_size;
+};
+
+// Minimum match length and hash table size of the block compressor.
+const size_t    lz_min_match        = 4u;
+const unsigned  lz_hash_bits        = 14u;
+const size_t    lz_max_offset       = 0xffffu;
+// No input byte of a block expands to more than 255 output bytes.
+const size_t    lz_max_expansion    = 255u;
+
+class Writer
+{
+public:
+    Writer( std::vector<unsigned char>& out ) : m_out( out ) {}
+
+    template<typename T>
+    void
+    put( const T value )
+    { bytes( &value, sizeof(T) ); }
+
+    void
+    bytes( const void* data, size_t size )
+    {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>( data );
+        m_out.insert( m_out.end(), p, p + size );
+    }
+
+    void
+    string( const std::string& s )
+    {
+        put<uint32_t>( static_cast<uint32_t>( s.size() ) );
+        bytes( s.data(), s.size() );
+    }
+
+    /** Start a chunk, returns the position of its length field. */
+    size_t
+    beginChunk( Wire::ChunkType type )
+    {
+        put<uint8_t>( static_cast<uint8_t>( type ) );
+        const size_t at = m_out.size();
+        put<uint32_t>( 0u );
+        return at;
+    }
+
+    void
+    endChunk( size_t at )
+    {
+        const uint32_t length = static_cast<uint32_t>( m_out.size() - at - sizeof(uint32_t) );
+        memcpy( &m_out[at], &length, sizeof(uint32_t) );
+    }
+
+protected:
+    std::vector<unsigned char>&  m_out;
+};
+
+/** Bounds-checked reader, sticks to failure once it has run out of data. */
+class Reader
+{
+public:
+    Reader( const unsigned char* begin, size_t size )
+        : m_p( begin ), m_end( begin + size ), m_ok( true )
+    {}
+
+    template<typename T>
+    T
+    get()
+    {
+        T value = T();
+        bytes( &value, sizeof(T) );
+        return value;
+    }
+
+    bool
+    bytes( void* data, size_t size )
+    {
+        if( !m_ok || (left() < size) ) {
+            m_ok = false;
+            return false;
+        }
+        memcpy( data, m_p, size );
+        m_p += size;
+        return true;
+    }
+
+    std::string
+    string()
+    {
+        const uint32_t size = get<uint32_t>();
+        if( !m_ok || (left() < size) ) {
+            m_ok = false;
+            return std::string();
+        }
+        std::string s( reinterpret_cast<const char*>( m_p ), size );
+        m_p += size;
+        return s;
+    }
+
+    /** Split off the next size bytes into a reader of its own. */
+    Reader
+    sub( size_t size )
+    {
+        if( !m_ok || (left() < size) ) {
+            m_ok = false;
+            return Reader( m_p, 0 );
+        }
+        Reader r( m_p, size );
+        m_p += size;
+        return r;
+    }
+
+    void
+    fail() { m_ok = false; }
+
+    size_t
+    left() const { return m_end - m_p; }
+
+    bool
+    ok() const { return m_ok; }
+
+protected:
+    const unsigned char*  m_p;
+    const unsigned char*  m_end;
+    bool                  m_ok;
+};
+
+void
+putLength( std::vector<unsigned char>& out, size_t length )
+{
+    while( length >= 255u ) {
+        out.push_back( 255u );
+        length -= 255u;
+    }
+    out.push_back( static_cast<unsigned char>( length ) );
+}
+
+void
+putSequence( std::vector<unsigned char>&  out,
+             const unsigned char*         literals,
+             size_t                       literal_count,
+             size_t                       offset,
+             size_t                       match )
+{
+    const size_t m = match - lz_min_match;
+    out.push_back( static_cast<unsigned char>( (std::min( literal_count, size_t(15u) )<<4u) |
+                                               (match == 0 ? 0u : std::min( m, size_t(15u) )) ) );
+    if( literal_count >= 15u ) {
+        putLength( out, literal_count - 15u );
+    }
+    out.insert( out.end(), literals, literals + literal_count );
+    if( match != 0 ) {
+        out.push_back( static_cast<unsigned char>( offset & 0xffu ) );
+        out.push_back( static_cast<unsigned char>( offset >> 8u ) );
+        if( m >= 15u ) {
+            putLength( out, m - 15u );
+        }
+    }
+}
+
+bool
+getLength( const unsigned char*& p, const unsigned char* end, size_t& length )
+{
+    unsigned char b;
+    do {
+        if( p == end ) {
+            return false;
+        }
+        b = *p++;
+        length += b;
+    } while( b == 255u );
+    return true;
+}
+
+// Number of 32-bit words in the payload of a uniform value.
+size_t
+valueWords( const Value* value )
+{
+    switch( value->type() ) {
+    case VALUE_TYPE_INT:
+    case VALUE_TYPE_BOOL:
+    case VALUE_TYPE_FLOAT:
+    case VALUE_TYPE_SAMPLER1D:
+    case VALUE_TYPE_SAMPLER2D:
+    case VALUE_TYPE_SAMPLER3D:
+    case VALUE_TYPE_SAMPLERCUBE:
+    case VALUE_TYPE_SAMPLERDEPTH:   return 1u;
+    case VALUE_TYPE_FLOAT2:         return 2u;
+    case VALUE_TYPE_FLOAT3:         return 3u;
+    case VALUE_TYPE_FLOAT4:         return 4u;
+    case VALUE_TYPE_FLOAT3X3:       return 9u;
+    case VALUE_TYPE_FLOAT4X4:       return 16u;
+    default:                        return 0u;
+    }
+}
+
+// Compare the source matrices to what was sent, and copy them if different.
+template<size_t N>
+bool
+syncMatrices( float (&sent)[N][16], const Value* const (&sources)[N] )
+{
+    bool changed = false;
+    for( size_t i=0; i<N; i++ ) {
+        const float* m = sources[i]->floatData();
+        if( memcmp( sent[i], m, sizeof(sent[i]) ) != 0 ) {
+            memcpy( sent[i], m, sizeof(sent[i]) );
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+} // of anonymous namespace
+
+uint64_t
+Wire::hash( const void* data, size_t bytes, uint64_t seed )
+{
+    // FNV-1a, 64 bits.
+    const unsigned char* p = reinterpret_cast<const unsigned char*>( data );
+    uint64_t h = seed;
+    for( size_t i=0; i<bytes; i++ ) {
+        h = (h ^ p[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+void
+Wire::compress( std::vector<unsigned char>& out, const unsigned char* in, size_t size )
+{
+    const uint32_t none = ~0u;
+    std::vector<uint32_t> table( 1u<<lz_hash_bits, none );
+
+    size_t anchor = 0;
+    size_t i = 0;
+    while( i + lz_min_match <= size ) {
+        uint32_t sequence;
+        memcpy( &sequence, in + i, sizeof(uint32_t) );
+        const uint32_t h = (sequence * 2654435761u) >> (32u - lz_hash_bits);
+        const uint32_t candidate = table[h];
+        table[h] = static_cast<uint32_t>( i );
+
+        if( (candidate != none) &&
+            (i - candidate <= lz_max_offset) &&
+            (memcmp( in + candidate, in + i, lz_min_match ) == 0 ) )
+        {
+            size_t match = lz_min_match;
+            while( (i + match < size) && (in[candidate + match] == in[i + match]) ) {
+                match++;
+            }
+            putSequence( out, in + anchor, i - anchor, i - candidate, match );
+            i += match;
+            anchor = i;
+        }
+        else {
+            i++;
+        }
+    }
+    // The last sequence holds only literals, and is recognized by the end of
+    // the block.
+    putSequence( out, in + anchor, size - anchor, 0, 0 );
+}
+
+bool
+Wire::decompress( unsigned char* out, size_t size, const unsigned char* in, size_t in_size )
+{
+    const unsigned char* ip = in;
+    const unsigned char* iend = in + in_size;
+    unsigned char* op = out;
+    unsigned char* oend = out + size;
+
+    while( ip < iend ) {
+        const unsigned char token = *ip++;
+
+        size_t literals = token >> 4u;
+        if( (literals == 15u) && !getLength( ip, iend, literals ) ) {
+            return false;
+        }
+        if( (size_t)(iend - ip) < literals || (size_t)(oend - op) < literals ) {
+            return false;
+        }
+        memcpy( op, ip, literals );
+        ip += literals;
+        op += literals;
+        if( ip == iend ) {
+            break;
+        }
+
+        if( iend - ip < 2 ) {
+            return false;
+        }
+        const size_t offset = ip[0] | (ip[1]<<8u);
+        ip += 2;
+        size_t match = token & 0xfu;
+        if( (match == 15u) && !getLength( ip, iend, match ) ) {
+            return false;
+        }
+        match += lz_min_match;
+        if( (offset == 0) || (offset > (size_t)(op - out)) || ((size_t)(oend - op) < match) ) {
+            return false;
+        }
+        // Matches may overlap the output, so copy byte by byte.
+        const unsigned char* src = op - offset;
+        for( size_t k=0; k<match; k++ ) {
+            op[k] = src[k];
+        }
+        op += match;
+    }
+    return op == oend;
+}
+
+
+WireEncoder::WireEncoder( const DataBase&  database,
+                          bool             quantize,
+                          bool             compress )
+    : m_database( database ),
+      m_transform_cache( database ),
+      m_quantize( quantize ),
+      m_compress( compress ),
+      m_complete( true ),
+      m_last_raw_size( 0 ),
+      m_last_buffers( 0 ),
+      m_last_coordsys( 0 )
+{
+}
+
+void
+WireEncoder::reset()
+{
+    m_complete = true;
+    m_sent_hashes.clear();
+    m_last_encode.invalidate();
+}
+
+void
+WireEncoder::encode( std::vector<unsigned char>&  frame,
+                     const RenderList&            renderlist,
+                     bool                         rebuilt )
+{
+    SCENE_PROFILE_SCOPE( "WireEncoder::encode" );
+
+    rebuilt = rebuilt || m_complete;
+    m_payload.clear();
+    m_last_buffers = 0;
+    m_last_coordsys = 0;
+
+    if( rebuilt ) {
+        collect( renderlist );
+    }
+    m_transform_cache.update( 1, 1 );
+
+    Writer w( m_payload );
+
+    // --- buffers and shaders that the client doesn't have
+    std::unordered_set<uint64_t> referenced;
+    for( size_t i=0; i<m_buffers.size(); i++ ) {
+        const uint64_t h = bufferHash( m_buffers[i] );
+        if( m_sent_hashes.insert( h ).second ) {
+            encodeBuffer( m_buffers[i], h );
+            m_last_buffers++;
+        }
+        referenced.insert( h );
+    }
+    for( size_t i=0; i<m_shaders.size(); i++ ) {
+        const uint64_t h = shaderHash( m_shaders[i] );
+        if( m_sent_hashes.insert( h ).second ) {
+            encodeShader( m_shaders[i], h );
+        }
+        referenced.insert( h );
+    }
+
+    if( rebuilt ) {
+        encodeDrawOrder( renderlist );
+        // The client drops what the new draw order doesn't refer to.
+        m_sent_hashes.swap( referenced );
+    }
+
+    // --- matrices that differ from what was last sent
+    for( size_t i=0; i<m_views.size(); i++ ) {
+        ViewState& v = m_views[i];
+        if( syncMatrices( v.m_sent, v.m_sources ) ) {
+            const size_t at = w.beginChunk( Wire::CHUNK_VIEW );
+            w.put<uint32_t>( static_cast<uint32_t>( i ) );
+            w.bytes( v.m_sent, sizeof(v.m_sent) );
+            w.endChunk( at );
+            m_last_coordsys++;
+        }
+    }
+    for( size_t i=0; i<m_locals.size(); i++ ) {
+        LocalState& l = m_locals[i];
+        if( syncMatrices( l.m_sent, l.m_sources ) ) {
+            const size_t at = w.beginChunk( Wire::CHUNK_LOCAL );
+            w.put<uint32_t>( static_cast<uint32_t>( i ) );
+            w.bytes( l.m_sent, sizeof(l.m_sent) );
+            w.endChunk( at );
+            m_last_coordsys++;
+        }
+    }
+
+    // --- uniform sets with values that have changed
+    for( size_t i=0; i<m_uniforms.size(); i++ ) {
+        const SetUniforms* su = m_uniforms[i];
+        bool changed = rebuilt;
+        for( size_t j=0; !changed && (j<su->m_items.size()); j++ ) {
+            const SetUniforms::Item& m = su->m_items[j];
+            changed = (m.m_semantic == RUNTIME_SEMANTIC_N) && !m_last_encode.asRecentAs( m.m_value->valueChanged() );
+        }
+        if( changed ) {
+            encodeUniforms( static_cast<uint32_t>( i ), su );
+        }
+    }
+
+    m_last_encode.touch();
+    m_complete = false;
+    m_last_raw_size = m_payload.size();
+
+    // --- frame
+    FrameHeader header;
+    header.m_magic = wire_magic;
+    header.m_version = wire_version;
+    header.m_flags = 0;
+    header.m_raw_size = static_cast<uint32_t>( m_payload.size() );
+
+    frame.resize( sizeof(FrameHeader) );
+    if( m_compress ) {
+        Wire::compress( frame, m_payload.data(), m_payload.size() );
+        if( frame.size() - sizeof(FrameHeader) < m_payload.size() ) {
+            header.m_flags |= flag_compressed;
+        }
+        else {
+            frame.resize( sizeof(FrameHeader) );
+        }
+    }
+    if( (header.m_flags & flag_compressed) == 0 ) {
+        frame.insert( frame.end(), m_payload.begin(), m_payload.end() );
+    }
+    header.m_payload_size = static_cast<uint32_t>( frame.size() - sizeof(FrameHeader) );
+    memcpy( frame.data(), &header, sizeof(FrameHeader) );
+
+    SCENE_PROFILE_COUNT( "WireEncoder.raw_bytes", m_payload.size() );
+    SCENE_PROFILE_COUNT( "WireEncoder.frame_bytes", frame.size() );
+}
+
+void
+WireEncoder::collect( const RenderList& renderlist )
+{
+    m_transform_cache.purge();
+    m_hashes.clear();
+    m_indices.clear();
+    m_buffers.clear();
+    m_shaders.clear();
+    m_views.clear();
+    m_locals.clear();
+    m_uniforms.clear();
+
+    // All the objects are distinct, so one set of keys covers all kinds.
+    std::unordered_map< CacheKey<1>, bool > seen;
+    for( size_t i=0; i<renderlist.items(); i++ ) {
+        const RenderList::Item& item = renderlist.item(i);
+
+        for( size_t k=0; k<item.m_set_inputs->m_items.size(); k++ ) {
+            const SourceBuffer* buf = item.m_set_inputs->m_items[k].m_source;
+            if( seen.insert( std::make_pair( CacheKey<1>( buf ), true ) ).second ) {
+                m_buffers.push_back( buf );
+            }
+        }
+        if( item.m_draw_indexed != NULL ) {
+            const SourceBuffer* buf = item.m_draw_indexed->m_index_buffer;
+            if( seen.insert( std::make_pair( CacheKey<1>( buf ), true ) ).second ) {
+                m_buffers.push_back( buf );
+            }
+        }
+        const Pass* pass = item.m_set_pass->m_pass;
+        if( seen.insert( std::make_pair( CacheKey<1>( pass ), true ) ).second ) {
+            m_shaders.push_back( pass );
+        }
+
+        const SetViewCoordSys* view = item.m_set_view_coordsys;
+        if( m_indices.insert( std::make_pair( CacheKey<1>( view ), m_views.size() ) ).second ) {
+            ViewState v;
+            v.m_view = view;
+            v.m_sources[0] = m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_MATRIX, NULL, view, NULL );
+            v.m_sources[1] = m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_INVERSE_MATRIX, NULL, view, NULL );
+            v.m_sources[2] = m_transform_cache.runtimeSemantic( RUNTIME_EYE_FROM_WORLD, NULL, view, NULL );
+            v.m_sources[3] = m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_EYE, NULL, view, NULL );
+            std::fill( &v.m_sent[0][0], &v.m_sent[0][0] + 4*16, std::numeric_limits<float>::quiet_NaN() );
+            m_views.push_back( v );
+        }
+        const SetLocalCoordSys* local = item.m_set_local_coordsys;
+        if( m_indices.insert( std::make_pair( CacheKey<1>( local ), m_locals.size() ) ).second ) {
+            LocalState l;
+            l.m_local = local;
+            l.m_sources[0] = m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_OBJECT, NULL, NULL, local );
+            l.m_sources[1] = m_transform_cache.runtimeSemantic( RUNTIME_OBJECT_FROM_WORLD, NULL, NULL, local );
+            std::fill( &l.m_sent[0][0], &l.m_sent[0][0] + 2*16, std::numeric_limits<float>::quiet_NaN() );
+            m_locals.push_back( l );
+        }
+        const SetUniforms* uniforms = item.m_set_uniforms;
+        if( m_indices.insert( std::make_pair( CacheKey<1>( uniforms ), m_uniforms.size() ) ).second ) {
+            m_uniforms.push_back( uniforms );
+        }
+    }
+}
+
+uint64_t
+WireEncoder::bufferHash( const SourceBuffer* buffer )
+{
+    auto it = m_hashes.find( CacheKey<1>( buffer ) );
+    if( (it != m_hashes.end()) && m_last_encode.asRecentAs( buffer->valueChanged() ) ) {
+        return it->second;
+    }
+    const uint32_t type = buffer->elementType();
+    uint64_t h = Wire::hash( &type, sizeof(type) );
+    h = Wire::hash( buffer->voidData(), 4*buffer->elementCount(), h );
+    m_hashes[ CacheKey<1>( buffer ) ] = h;
+    return h;
+}
+
+uint64_t
+WireEncoder::shaderHash( const Pass* pass )
+{
+    auto it = m_hashes.find( CacheKey<1>( pass ) );
+    if( (it != m_hashes.end()) && m_last_encode.asRecentAs( pass->valueChanged() ) ) {
+        return it->second;
+    }
+    // Distinct from buffer hashes, since the two share the sent set.
+    const uint32_t tag = ~0u;
+    uint64_t h = Wire::hash( &tag, sizeof(tag) );
+    for( int s=0; s<STAGE_N; s++ ) {
+        const std::string source = pass->shaderSource( (ShaderStage)s );
+        const uint64_t length = source.size();
+        h = Wire::hash( &length, sizeof(length), h );
+        h = Wire::hash( source.data(), source.size(), h );
+    }
+    m_hashes[ CacheKey<1>( pass ) ] = h;
+    return h;
+}
+
+void
+WireEncoder::encodeBuffer( const SourceBuffer* buffer, uint64_t hash )
+{
+    Writer w( m_payload );
+    const size_t at = w.beginChunk( Wire::CHUNK_BUFFER );
+    w.put<uint64_t>( hash );
+
+    const size_t count = buffer->elementCount();
+    if( buffer->elementType() == ELEMENT_INT ) {
+        w.put<uint8_t>( Wire::BUFFER_INT32 );
+        w.put<uint32_t>( static_cast<uint32_t>( count ) );
+        w.bytes( buffer->intData(), sizeof(int)*count );
+    }
+    else if( !m_quantize || (count == 0) ) {
+        w.put<uint8_t>( Wire::BUFFER_FLOAT32 );
+        w.put<uint32_t>( static_cast<uint32_t>( count ) );
+        w.bytes( buffer->floatData(), sizeof(float)*count );
+    }
+    else {
+        const float* data = buffer->floatData();
+        const float min = *std::min_element( data, data + count );
+        const float max = *std::max_element( data, data + count );
+        const float scale = max > min ? 65535.f/(max-min) : 0.f;
+        w.put<uint8_t>( Wire::BUFFER_FLOAT_Q16 );
+        w.put<uint32_t>( static_cast<uint32_t>( count ) );
+        w.put<float>( min );
+        w.put<float>( max );
+        const size_t offset = m_payload.size();
+        m_payload.resize( offset + sizeof(uint16_t)*count );
+        uint16_t* q = reinterpret_cast<uint16_t*>( &m_payload[offset] );
+        for( size_t i=0; i<count; i++ ) {
+            q[i] = static_cast<uint16_t>( std::floor( (data[i]-min)*scale + 0.5f ) );
+        }
+    }
+    w.endChunk( at );
+}
+
+void
+WireEncoder::encodeShader( const Pass* pass, uint64_t hash )
+{
+    Writer w( m_payload );
+    const size_t at = w.beginChunk( Wire::CHUNK_SHADER );
+    w.put<uint64_t>( hash );
+    for( int s=0; s<STAGE_N; s++ ) {
+        w.string( pass->shaderSource( (ShaderStage)s ) );
+    }
+    w.endChunk( at );
+}
+
+void
+WireEncoder::encodeDrawOrder( const RenderList& renderlist )
+{
+    Writer w( m_payload );
+    const size_t at = w.beginChunk( Wire::CHUNK_DRAW_ORDER );
+    w.put<uint32_t>( static_cast<uint32_t>( m_views.size() ) );
+    w.put<uint32_t>( static_cast<uint32_t>( m_locals.size() ) );
+    w.put<uint32_t>( static_cast<uint32_t>( m_uniforms.size() ) );
+    w.put<uint32_t>( static_cast<uint32_t>( renderlist.items() ) );
+    for( size_t i=0; i<renderlist.items(); i++ ) {
+        const RenderList::Item& item = renderlist.item(i);
+        w.put<uint32_t>( m_indices[ CacheKey<1>( item.m_set_view_coordsys ) ] );
+        w.put<uint32_t>( m_indices[ CacheKey<1>( item.m_set_local_coordsys ) ] );
+        w.put<uint32_t>( m_indices[ CacheKey<1>( item.m_set_uniforms ) ] );
+        w.put<uint64_t>( shaderHash( item.m_set_pass->m_pass ) );
+
+        const SetInputs* inputs = item.m_set_inputs;
+        w.put<uint32_t>( static_cast<uint32_t>( inputs->m_items.size() ) );
+        for( size_t k=0; k<inputs->m_items.size(); k++ ) {
+            w.string( inputs->m_pass->attributeSymbol( k ) );
+            w.put<uint64_t>( bufferHash( inputs->m_items[k].m_source ) );
+            w.put<int32_t>( inputs->m_items[k].m_components );
+            w.put<int32_t>( inputs->m_items[k].m_offset );
+            w.put<int32_t>( inputs->m_items[k].m_stride );
+        }
+
+        if( item.m_draw_indexed != NULL ) {
+            const DrawIndexed* d = item.m_draw_indexed;
+            size_t first = 0;
+            switch( d->m_type ) {
+            case GL_UNSIGNED_BYTE:  first = (size_t)d->m_offset/sizeof(GLubyte); break;
+            case GL_UNSIGNED_SHORT: first = (size_t)d->m_offset/sizeof(GLushort); break;
+            case GL_UNSIGNED_INT:   first = (size_t)d->m_offset/sizeof(GLuint); break;
+            }
+            w.put<uint8_t>( 1u );
+            w.put<uint32_t>( d->m_mode );
+            w.put<int32_t>( static_cast<int32_t>( first ) );
+            w.put<int32_t>( d->m_count );
+            w.put<uint64_t>( bufferHash( d->m_index_buffer ) );
+            w.put<uint32_t>( d->m_type );
+        }
+        else {
+            const bool draw = item.m_draw != NULL;
+            w.put<uint8_t>( 0u );
+            w.put<uint32_t>( draw ? item.m_draw->m_mode : GL_POINTS );
+            w.put<int32_t>( draw ? item.m_draw->m_first : 0 );
+            w.put<int32_t>( draw ? item.m_draw->m_count : 0 );
+        }
+    }
+    w.endChunk( at );
+}
+
+void
+WireEncoder::encodeUniforms( uint32_t index, const SetUniforms* set_uniforms )
+{
+    Writer w( m_payload );
+    const size_t at = w.beginChunk( Wire::CHUNK_UNIFORMS );
+    w.put<uint32_t>( index );
+    w.put<uint32_t>( static_cast<uint32_t>( set_uniforms->m_items.size() ) );
+    for( size_t j=0; j<set_uniforms->m_items.size(); j++ ) {
+        const SetUniforms::Item& m = set_uniforms->m_items[j];
+        w.string( set_uniforms->m_pass->uniformSymbol( j ) );
+        w.put<uint32_t>( m.m_semantic );
+        if( m.m_semantic == RUNTIME_SEMANTIC_N ) {
+            const size_t words = valueWords( m.m_value );
+            w.put<uint32_t>( m.m_value->type() );
+            w.put<uint32_t>( static_cast<uint32_t>( words ) );
+            if( m.m_value->type() == VALUE_TYPE_BOOL ) {
+                w.put<int32_t>( m.m_value->boolData()[0] ? 1 : 0 );
+            }
+            else if( (m.m_value->type() >= VALUE_TYPE_FLOAT) && (m.m_value->type() <= VALUE_TYPE_FLOAT4X4) ) {
+                w.bytes( m.m_value->floatData(), sizeof(float)*words );
+            }
+            else {
+                w.bytes( m.m_value->intData(), sizeof(int)*words );
+            }
+        }
+    }
+    w.endChunk( at );
+}
+
+
+bool
+WireDecoder::decode( const unsigned char* frame, size_t size )
+{
+    static const Logger log = getLogger( package + ".WireDecoder.decode" );
+
+    FrameHeader header;
+    if( size < sizeof(FrameHeader) ) {
+        SCENELOG_ERROR( log, "Frame is truncated." );
+        return false;
+    }
+    memcpy( &header, frame, sizeof(FrameHeader) );
+    if( (header.m_magic != wire_magic) || (header.m_version != wire_version) ) {
+        SCENELOG_ERROR( log, "Wrong magic or version." );
+        return false;
+    }
+    if( size - sizeof(FrameHeader) != header.m_payload_size ) {
+        SCENELOG_ERROR( log, "Frame is truncated." );
+        return false;
+    }
+    const unsigned char* payload = frame + sizeof(FrameHeader);
+    if( header.m_flags & flag_compressed ) {
+        if( header.m_raw_size > lz_max_expansion*size_t(header.m_payload_size) ) {
+            SCENELOG_ERROR( log, "Compressed payload can't expand to " << header.m_raw_size << " bytes." );
+            return false;
+        }
+        m_payload.resize( header.m_raw_size );
+        if( !Wire::decompress( m_payload.data(), m_payload.size(), payload, header.m_payload_size ) ) {
+            SCENELOG_ERROR( log, "Corrupt compressed payload." );
+            return false;
+        }
+        payload = m_payload.data();
+    }
+    else if( header.m_raw_size != header.m_payload_size ) {
+        SCENELOG_ERROR( log, "Payload size mismatch." );
+        return false;
+    }
+
+    Reader frame_reader( payload, header.m_raw_size );
+    while( frame_reader.ok() && (frame_reader.left() > 0) ) {
+        const uint8_t type = frame_reader.get<uint8_t>();
+        const uint32_t length = frame_reader.get<uint32_t>();
+        Reader r = frame_reader.sub( length );
+        if( !frame_reader.ok() ) {
+            break;
+        }
+
+        switch( type ) {
+        case Wire::CHUNK_BUFFER:
+        {
+            const uint64_t h = r.get<uint64_t>();
+            const uint8_t encoding = r.get<uint8_t>();
+            const uint32_t count = r.get<uint32_t>();
+            if( !r.ok() || (r.left() < sizeof(uint16_t)*size_t(count)) ) {
+                r.fail();
+                break;
+            }
+            Buffer& b = m_buffers[h];
+            b.m_count = count;
+            b.m_data.resize( 4*size_t(count) );
+            if( encoding == Wire::BUFFER_INT32 ) {
+                b.m_type = ELEMENT_INT;
+                r.bytes( b.m_data.data(), b.m_data.size() );
+            }
+            else if( encoding == Wire::BUFFER_FLOAT32 ) {
+                b.m_type = ELEMENT_FLOAT;
+                r.bytes( b.m_data.data(), b.m_data.size() );
+            }
+            else if( encoding == Wire::BUFFER_FLOAT_Q16 ) {
+                b.m_type = ELEMENT_FLOAT;
+                const float min = r.get<float>();
+                const float max = r.get<float>();
+                const float scale = (max-min)/65535.f;
+                float* data = reinterpret_cast<float*>( b.m_data.data() );
+                for( uint32_t i=0; r.ok() && (i<count); i++ ) {
+                    data[i] = min + scale*r.get<uint16_t>();
+                }
+            }
+            else {
+                r.fail();
+            }
+        }
+            break;
+        case Wire::CHUNK_SHADER:
+        {
+            Shader& s = m_shaders[ r.get<uint64_t>() ];
+            for( int k=0; k<STAGE_N; k++ ) {
+                s.m_sources[k] = r.string();
+            }
+        }
+            break;
+        case Wire::CHUNK_DRAW_ORDER:
+        {
+            const uint32_t views = r.get<uint32_t>();
+            const uint32_t locals = r.get<uint32_t>();
+            const uint32_t uniforms = r.get<uint32_t>();
+            const uint32_t items = r.get<uint32_t>();
+            // Each item is at least 37 bytes, which bounds what we allocate.
+            if( !r.ok() || (r.left() < 37u*size_t(items)) ) {
+                r.fail();
+                break;
+            }
+            m_views.resize( views );
+            m_locals.resize( locals );
+            m_uniforms.clear();
+            m_uniforms.resize( uniforms );
+            m_items.resize( items );
+            for( uint32_t i=0; r.ok() && (i<items); i++ ) {
+                Item& item = m_items[i];
+                item.m_view = r.get<uint32_t>();
+                item.m_local = r.get<uint32_t>();
+                item.m_uniforms = r.get<uint32_t>();
+                item.m_shader = r.get<uint64_t>();
+                const uint32_t inputs = r.get<uint32_t>();
+                if( !r.ok() || (r.left() < 24u*size_t(inputs)) ) {
+                    r.fail();
+                    break;
+                }
+                item.m_inputs.resize( inputs );
+                for( uint32_t k=0; k<inputs; k++ ) {
+                    Input& input = item.m_inputs[k];
+                    input.m_symbol = r.string();
+                    input.m_buffer = r.get<uint64_t>();
+                    input.m_components = r.get<int32_t>();
+                    input.m_offset = r.get<int32_t>();
+                    input.m_stride = r.get<int32_t>();
+                }
+                item.m_indexed = r.get<uint8_t>() != 0;
+                item.m_mode = r.get<uint32_t>();
+                item.m_first = r.get<int32_t>();
+                item.m_count = r.get<int32_t>();
+                item.m_index_buffer = item.m_indexed ? r.get<uint64_t>() : 0u;
+                item.m_index_type = item.m_indexed ? r.get<uint32_t>() : 0u;
+                if( (item.m_view >= views) || (item.m_local >= locals) || (item.m_uniforms >= uniforms) ) {
+                    r.fail();
+                }
+            }
+            if( r.ok() ) {
+                evict();
+            }
+        }
+            break;
+        case Wire::CHUNK_VIEW:
+        {
+            const uint32_t index = r.get<uint32_t>();
+            if( index >= m_views.size() ) {
+                r.fail();
+                break;
+            }
+            r.bytes( &m_views[index], sizeof(View) );
+        }
+            break;
+        case Wire::CHUNK_LOCAL:
+        {
+            const uint32_t index = r.get<uint32_t>();
+            if( index >= m_locals.size() ) {
+                r.fail();
+                break;
+            }
+            r.bytes( &m_locals[index], sizeof(Local) );
+        }
+            break;
+        case Wire::CHUNK_UNIFORMS:
+        {
+            const uint32_t index = r.get<uint32_t>();
+            const uint32_t count = r.get<uint32_t>();
+            if( !r.ok() || (index >= m_uniforms.size()) || (r.left() < 8u*size_t(count)) ) {
+                r.fail();
+                break;
+            }
+            std::vector<Uniform>& set = m_uniforms[index];
+            set.resize( count );
+            for( uint32_t j=0; r.ok() && (j<count); j++ ) {
+                Uniform& u = set[j];
+                u.m_symbol = r.string();
+                u.m_semantic = static_cast<RuntimeSemantic>( r.get<uint32_t>() );
+                u.m_type = VALUE_TYPE_N;
+                u.m_data.clear();
+                if( u.m_semantic == RUNTIME_SEMANTIC_N ) {
+                    u.m_type = static_cast<ValueType>( r.get<uint32_t>() );
+                    const uint32_t words = r.get<uint32_t>();
+                    if( !r.ok() || (r.left() < 4u*size_t(words)) ) {
+                        r.fail();
+                        break;
+                    }
+                    u.m_data.resize( words );
+                    r.bytes( u.m_data.data(), 4u*size_t(words) );
+                }
+            }
+        }
+            break;
+        default:
+            // Unknown chunks are skipped, so that newer encoders can add
+            // chunks without breaking older clients.
+            SCENELOG_DEBUG( log, "Skipping unknown chunk " << int(type) );
+            break;
+        }
+        if( !r.ok() ) {
+            SCENELOG_ERROR( log, "Corrupt chunk of type " << int(type) );
+            return false;
+        }
+    }
+    if( !frame_reader.ok() ) {
+        SCENELOG_ERROR( log, "Frame is truncated." );
+        return false;
+    }
+    return true;
+}
+
+void
+WireDecoder::evict()
+{
+    std::unordered_set<uint64_t> referenced;
+    for( size_t i=0; i<m_items.size(); i++ ) {
+        const Item& item = m_items[i];
+        referenced.insert( item.m_shader );
+        for( size_t k=0; k<item.m_inputs.size(); k++ ) {
+            referenced.insert( item.m_inputs[k].m_buffer );
+        }
+        if( item.m_indexed ) {
+            referenced.insert( item.m_index_buffer );
+        }
+    }
+    for( auto it=m_buffers.begin(); it!=m_buffers.end(); ) {
+        it = referenced.count( it->first ) > 0 ? std::next( it ) : m_buffers.erase( it );
+    }
+    for( auto it=m_shaders.begin(); it!=m_shaders.end(); ) {
+        it = referenced.count( it->first ) > 0 ? std::next( it ) : m_shaders.erase( it );
+    }
+}
+
+const WireDecoder::Buffer*
+WireDecoder::buffer( uint64_t hash ) const
+{
+    auto it = m_buffers.find( hash );
+    return it != m_buffers.end() ? &it->second : NULL;
+}
+
+const WireDecoder::Shader*
+WireDecoder::shader( uint64_t hash ) const
+{
+    auto it = m_shaders.find( hash );
+    return it != m_shaders.end() ? &it->second : NULL;
+}
+
+    } // of namespace Runtime
+} // of namespace Scene
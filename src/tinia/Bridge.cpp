@@ -17,14 +17,19 @@
  */
 
 #include <cstring>
+#include <limits>
+#include <algorithm>
 #include <unordered_map>
-#include <boost/lexical_cast.hpp>
 #include <scene/Log.hpp>
 #include <scene/SourceBuffer.hpp>
 #include <scene/Image.hpp>
 #include <scene/Pass.hpp>
+#include <scene/Technique.hpp>
+#include <scene/Profile.hpp>
+#include <scene/Effect.hpp>
 #include <scene/Light.hpp>
 #include <scene/Utils.hpp>
+#include <scene/Profiler.hpp>
 #include <scene/tinia/Bridge.hpp>
 #include <tinia/renderlist/Buffer.hpp>
 #include <tinia/renderlist/SetInputs.hpp>
@@ -52,7 +57,7 @@ Bridge::Bridge( const DataBase&     database,
       m_transform_cache( database )
 {
     m_last_update.invalidate();
-
+    memset( &m_push_statistics, 0, sizeof(m_push_statistics) );
 }
 
 Bridge::~Bridge()
@@ -64,8 +69,9 @@ bool
 Bridge::build( const std::string& visual_scene )
 {
 //    Logger log = getLogger( package + ".build" );
-    if( m_renderlist.build( visual_scene) || !m_last_update.asRecentAs( m_database.valueChanged() ) ) {
-        push();
+    const bool rebuilt = m_renderlist.build( visual_scene );
+    if( rebuilt || !m_last_update.asRecentAs( m_database.valueChanged() ) ) {
+        push( rebuilt );
         m_last_update.touch();
         return true;
     }
@@ -86,159 +92,186 @@ Bridge::renderListDataBase() const
     return m_renderlist_db;
 }
 
+namespace {
+
+rl::PrimitiveType
+primitiveType( GLenum mode )
+{
+    switch( mode ) {
+    case GL_POINTS:         return rl::PRIMITIVE_POINTS;
+    case GL_LINES:          return rl::PRIMITIVE_LINES;
+    case GL_LINE_STRIP:     return rl::PRIMITIVE_LINE_STRIP;
+    case GL_LINE_LOOP:      return rl::PRIMITIVE_LINE_LOOP;
+    case GL_TRIANGLES:      return rl::PRIMITIVE_TRIANGLES;
+    case GL_TRIANGLE_STRIP: return rl::PRIMITIVE_TRIANGLE_STRIP;
+    case GL_TRIANGLE_FAN:   return rl::PRIMITIVE_TRIANGLE_FAN;
+    case GL_QUADS:          return rl::PRIMITIVE_QUADS;
+    case GL_QUAD_STRIP:     return rl::PRIMITIVE_QUAD_STRIP;
+    }
+    return rl::PRIMITIVE_POINTS;
+}
+
+// Marks the sent matrices as unknown, so that the next compare differs.
+template<typename Sync>
 void
-Bridge::push()
+invalidateSent( Sync& sync )
+{
+    std::fill( &sync.m_sent[0][0],
+               &sync.m_sent[0][0] + sizeof(sync.m_sent)/sizeof(float),
+               std::numeric_limits<float>::quiet_NaN() );
+}
+
+// Copies what was last sent if the sync is among the previous syncs,
+// otherwise marks it as unknown. Returns true if found.
+template<typename Sync>
+bool
+keepSent( Sync&                                                  sync,
+          const std::vector<Sync>&                               previous_syncs,
+          const unordered_map< Runtime::CacheKey<1>, size_t >&   previous )
 {
-    Logger log = getLogger( package + ".push" );
-
-    // Step 1, find items that needs updating
-    unordered_map< Runtime::CacheKey<1>, const SourceBuffer* > source_buffers;
-    unordered_map< Runtime::CacheKey<1>, const Image* > images;
-    unordered_map< Runtime::CacheKey<1>, const Pass* > shaders;
-    unordered_map< Runtime::CacheKey<1>, const Runtime::RenderAction* > actions;
-    if( !m_last_update.asRecentAs( m_database.structureChanged() ) ) {
+    auto it = previous.find( Runtime::CacheKey<1>( sync.m_sources[0] ) );
+    if( it == previous.end() ) {
+        invalidateSent( sync );
+        return false;
+    }
+    memcpy( sync.m_sent, previous_syncs[ it->second ].m_sent, sizeof(sync.m_sent) );
+    return true;
+}
+
+} // of anonymous namespace
+
+template<typename Sync>
+bool
+Bridge::matricesChanged( Sync& sync )
+{
+    bool changed = false;
+    const size_t n = sizeof(sync.m_sources)/sizeof(sync.m_sources[0]);
+    for( size_t i=0; i<n; i++ ) {
+        const float* m = sync.m_sources[i]->floatData();
+        if( memcmp( sync.m_sent[i], m, sizeof(sync.m_sent[i]) ) != 0 ) {
+            memcpy( sync.m_sent[i], m, sizeof(sync.m_sent[i]) );
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void
+Bridge::collect()
+{
+    // A patched render list keeps the coordinate systems of retained items.
+    if( !m_renderlist.patched() ) {
         m_transform_cache.purge();
     }
+    m_buffers.clear();
+    m_shaders.clear();
+    m_images.clear();
+    m_buffer_index.clear();
+    m_shader_index.clear();
+
+    // All the objects are distinct, so one set of keys covers all kinds.
+    unordered_map< Runtime::CacheKey<1>, bool > seen;
 
-#ifdef SCENE_RL_CHUNKS
     for( size_t i=0; i<m_renderlist.items(); i++ ) {
         const Runtime::RenderList::Item* item = &m_renderlist.item(i);
 
-        // tag vertex data for pulling
-        for( size_t k=0; k<item->m_action_set_input->m_set_inputs.m_items.size(); k++ ) {
-            const SourceBuffer* buf = item->m_action_set_input->m_set_inputs.m_items[k].m_source;
-            Runtime::CacheKey<1> key( buf );
-            auto it = source_buffers.find( key );
-            if( it == source_buffers.end() ) {
-                if( (m_renderlist_db.itemByName( buf->idString() ) == NULL ) || (!m_last_update.asRecentAs( buf->valueChanged() ) ) ) {
-                    source_buffers[ key ] = buf;
-                }
+        for( size_t k=0; k<item->m_set_inputs->m_items.size(); k++ ) {
+            const SourceBuffer* buf = item->m_set_inputs->m_items[k].m_source;
+            if( seen.insert( std::make_pair( Runtime::CacheKey<1>( buf ), true ) ).second ) {
+                m_buffer_index.insert( std::make_pair( buf->Identifiable::id(), m_buffers.size() ) );
+                m_buffers.push_back( buf );
             }
         }
-
-        // tag index data for pulling
         if( item->m_draw_indexed != NULL ) {
             const SourceBuffer* buf = item->m_draw_indexed->m_index_buffer;
-            Runtime::CacheKey<1> key( buf );
-            auto it = source_buffers.find( key );
-            if( it == source_buffers.end() ) {
-                if( (m_renderlist_db.itemByName( buf->idString() ) == NULL ) || (!m_last_update.asRecentAs( buf->valueChanged() ) ) ) {
-                    source_buffers[ key ] = buf;
-                }
+            if( seen.insert( std::make_pair( Runtime::CacheKey<1>( buf ), true ) ).second ) {
+                m_buffer_index.insert( std::make_pair( buf->Identifiable::id(), m_buffers.size() ) );
+                m_buffers.push_back( buf );
             }
         }
-
-        // tag shader for pulling
-        if(1) {
-            const Pass* pass = item->m_set_pass->m_pass;
-            Runtime::CacheKey<1> key( pass );
-            auto it = shaders.find( key );
-            if( it == shaders.end() ) {
-                if( (m_renderlist_db.itemByName( pass->idString() ) == NULL ) || (!m_last_update.asRecentAs( pass->valueChanged() ) ) ) {
-                    shaders[ key ] = pass;
-                }
-            }
+        const Pass* pass = item->m_set_pass->m_pass;
+        if( seen.insert( std::make_pair( Runtime::CacheKey<1>( pass ), true ) ).second ) {
+            // Passes report their changes to the library of their effect.
+            const Effect* effect = pass->technique()->profile()->effect();
+            m_shader_index.insert( std::make_pair( effect->Identifiable::id(), m_shaders.size() ) );
+            m_shaders.push_back( pass );
         }
-
-        // tag textures for pulling
         if( item->m_action_set_samplers != NULL ) {
-            for(size_t k=0; k<item->m_set_samplers->m_items.size(); k++ ) {
+            for( size_t k=0; k<item->m_set_samplers->m_items.size(); k++ ) {
                 const Image* image = item->m_set_samplers->m_items[k].m_image;
-                Runtime::CacheKey<1> key( image );
-                auto it = images.find( key );
-                if( it == images.end() ) {
-                    if( !m_last_update.asRecentAs( image->valueChanged() ) ) {
-                        images[ key ] = image;
-                    }
+                if( seen.insert( std::make_pair( Runtime::CacheKey<1>( image ), true ) ).second ) {
+                    m_images.push_back( image );
                 }
             }
         }
-
-        // tag render targets for pulling
         for( size_t k=0; k<item->m_set_render_targets->m_items.size(); k++ ) {
             const Image* image = item->m_set_render_targets->m_items[k].m_image;
-            Runtime::CacheKey<1> key( image );
-            auto it = images.find( key );
-            if( it == images.end() ) {
-                if( !m_last_update.asRecentAs( image->valueChanged() ) ) {
-                    images[ key ] = image;
-                }
+            if( seen.insert( std::make_pair( Runtime::CacheKey<1>( image ), true ) ).second ) {
+                m_images.push_back( image );
             }
         }
 
         // tag matrices that are needed
-        m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_MATRIX, NULL, item->m_set_view_coordsys, NULL );
-        m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_INVERSE_MATRIX, NULL, item->m_set_view_coordsys, NULL );
-        m_transform_cache.runtimeSemantic( RUNTIME_EYE_FROM_WORLD, NULL, item->m_set_view_coordsys, NULL );
-        m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_EYE, NULL, item->m_set_view_coordsys, NULL );
-        for( size_t k=0; k<SCENE_LIGHTS_MAX; k++ ) {
-            if( item->m_set_view_coordsys->m_lights[k] != NULL ) {
-                RuntimeSemantic lfw = (RuntimeSemantic)(RUNTIME_LIGHT0_EYE_FROM_WORLD + i);
-                m_transform_cache.runtimeSemantic( lfw, NULL, item->m_set_view_coordsys, NULL );
-                RuntimeSemantic wfl =  (RuntimeSemantic)(RUNTIME_WORLD_FROM_LIGHT0_EYE + i);
-                m_transform_cache.runtimeSemantic( wfl, NULL, item->m_set_view_coordsys, NULL );
+        const Runtime::SetViewCoordSys* view = item->m_set_view_coordsys;
+        if( seen.insert( std::make_pair( Runtime::CacheKey<1>( view ), true ) ).second ) {
+            m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_MATRIX, NULL, view, NULL );
+            m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_INVERSE_MATRIX, NULL, view, NULL );
+            m_transform_cache.runtimeSemantic( RUNTIME_EYE_FROM_WORLD, NULL, view, NULL );
+            m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_EYE, NULL, view, NULL );
+            for( size_t k=0; k<SCENE_LIGHTS_MAX; k++ ) {
+                if( view->m_lights[k] != NULL ) {
+                    m_transform_cache.runtimeSemantic( (RuntimeSemantic)(RUNTIME_LIGHT0_EYE_FROM_WORLD + k), NULL, view, NULL );
+                    m_transform_cache.runtimeSemantic( (RuntimeSemantic)(RUNTIME_WORLD_FROM_LIGHT0_EYE + k), NULL, view, NULL );
+                }
             }
         }
-        m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_OBJECT, NULL, NULL, item->m_set_local_coordsys );
-        m_transform_cache.runtimeSemantic( RUNTIME_OBJECT_FROM_WORLD, NULL, NULL, item->m_set_local_coordsys );
-    }
-    m_transform_cache.update( 1, 1 );
-
-    // -- push buffer objects
-    for( auto it=source_buffers.begin(); it!=source_buffers.end(); ++it ) {
-        const SourceBuffer* bd = it->second;
-        std::string id = bd->idString();
-        rl::Buffer* bs = m_renderlist_db.castedItemByName<rl::Buffer*>( id );
-        if( bs == NULL ) {
-            bs = m_renderlist_db.createBuffer( id );
-        }
-        switch( bd->elementType() ) {
-        case ELEMENT_INT:
-            bs->set( bd->intData(), bd->elementCount() );
-            SCENELOG_INFO( log, "buffer[" <<id<<"] (" << bd->id() << ") = int(..."<< bd->elementCount() << "...)" );
-            break;
-        case ELEMENT_FLOAT:
-            bs->set( bd->floatData(), bd->elementCount() );
-            SCENELOG_INFO( log, "buffer[" <<id<<"] (" << bd->id() << ") = float(..."<< bd->elementCount() << "...)" );
-            break;
+        const Runtime::SetLocalCoordSys* local = item->m_set_local_coordsys;
+        if( seen.insert( std::make_pair( Runtime::CacheKey<1>( local ), true ) ).second ) {
+            m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_OBJECT, NULL, NULL, local );
+            m_transform_cache.runtimeSemantic( RUNTIME_OBJECT_FROM_WORLD, NULL, NULL, local );
         }
     }
+}
 
-    // --- push images
-    for( auto it=images.begin(); it!=images.end(); ++it ) {
-        const Image* di = it->second;
-        std::string id = di->idString();
-        SCENELOG_DEBUG( log, "image[" << id << "] <- ignored" );
+void
+Bridge::rebuildDrawOrder()
+{
+    static const Logger log = getLogger( package + ".rebuildDrawOrder" );
+
+    // When patched, the actions of retained items and the transform cache
+    // are kept, so what was sent for them is still valid. Matrix syncs are
+    // identified by their first source.
+    std::vector<ViewSync> previous_views;
+    std::vector<LocalSync> previous_locals;
+    std::vector<LightSync> previous_lights;
+    std::vector<UniformSync> previous_uniforms;
+    if( m_renderlist.patched() ) {
+        previous_views.swap( m_view_syncs );
+        previous_locals.swap( m_local_syncs );
+        previous_lights.swap( m_light_syncs );
+        previous_uniforms.swap( m_uniform_syncs );
     }
-
-    // --- push shaders
-    for( auto it=shaders.begin(); it!=shaders.end(); ++it ) {
-        const Pass* ss = it->second;
-        rl::Shader* ls = m_renderlist_db.castedItemByName<rl::Shader*>( ss->idString() );
-        if( ls == NULL ) {
-            ls = m_renderlist_db.createShader( ss->idString() );
-        }
-        if( !ss->shaderSource( STAGE_VERTEX ).empty() ) {
-            ls->setVertexStage( ss->shaderSource( STAGE_VERTEX ) );
-            SCENELOG_INFO( log, "+- vertex shader" );
-        }
-        if( !ss->shaderSource( STAGE_TESSELLATION_CONTROL ).empty() ) {
-            ls->setTessCtrlStage( ss->shaderSource( STAGE_TESSELLATION_CONTROL ) );
-            SCENELOG_INFO( log, "+- tessellation control shader" );
-        }
-        if( !ss->shaderSource( STAGE_TESSELLATION_EVALUATION ).empty() ) {
-            ls->setTessEvalStage( ss->shaderSource( STAGE_TESSELLATION_EVALUATION ) );
-            SCENELOG_INFO( log, "+- tessellation evaluation shader" );
-        }
-        if( !ss->shaderSource( STAGE_GEOMETRY ).empty() ) {
-            ls->setGeometryStage( ss->shaderSource( STAGE_GEOMETRY ) );
-            SCENELOG_INFO( log, "+- geometry shader" );
-        }
-        if( !ss->shaderSource( STAGE_FRAGMENT ).empty() ) {
-            ls->setFragmentStage( ss->shaderSource( STAGE_FRAGMENT ) );
-            SCENELOG_INFO( log, "+- fragment shader" );
-        }
+    m_view_syncs.clear();
+    m_local_syncs.clear();
+    m_light_syncs.clear();
+    m_uniform_syncs.clear();
+    m_light_index.clear();
+    unordered_map< Runtime::CacheKey<1>, size_t > previous;
+    for( size_t i=0; i<previous_views.size(); i++ ) {
+        previous[ Runtime::CacheKey<1>( previous_views[i].m_sources[0] ) ] = i;
+    }
+    for( size_t i=0; i<previous_locals.size(); i++ ) {
+        previous[ Runtime::CacheKey<1>( previous_locals[i].m_sources[0] ) ] = i;
+    }
+    for( size_t i=0; i<previous_lights.size(); i++ ) {
+        previous[ Runtime::CacheKey<1>( previous_lights[i].m_sources[0] ) ] = i;
     }
+    for( size_t i=0; i<previous_uniforms.size(); i++ ) {
+        previous[ Runtime::CacheKey<1>( previous_uniforms[i].m_set_uniforms ) ] = i;
+    }
+
+    // Actions that occur more than once in the draw order are synced once.
+    unordered_map< Runtime::CacheKey<1>, bool > synced;
 
     Runtime::RenderList::Item dummy;
     memset( &dummy, 0, sizeof(Runtime::RenderList::Item) );
@@ -259,64 +292,66 @@ Bridge::push()
         }
 
         if( prev_item->m_set_view_coordsys != item->m_set_view_coordsys ) {
-            const std::string name = item->m_set_view_coordsys->idString();
+            const Runtime::SetViewCoordSys* view = item->m_set_view_coordsys;
+            const std::string name = view->idString();
             rl::SetViewCoordSys* a = m_renderlist_db.castedItemByName<rl::SetViewCoordSys*>( name );
             if( a == NULL ) {
                 a = m_renderlist_db.createAction<rl::SetViewCoordSys>( name );
             }
-            a->setProjection( m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_MATRIX,
-                                                                 NULL, item->m_set_view_coordsys, NULL )->floatData(),
-                              m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_INVERSE_MATRIX,
-                                                                 NULL, item->m_set_view_coordsys, NULL )->floatData() );
-            a->setOrientation( m_transform_cache.runtimeSemantic( RUNTIME_EYE_FROM_WORLD,
-                                                                  NULL, item->m_set_view_coordsys, NULL )->floatData(),
-                               m_transform_cache.runtimeSemantic( RUNTIME_EYE_FROM_WORLD,
-                                                                  NULL, item->m_set_view_coordsys, NULL )->floatData() );
+            const bool first = synced.insert( std::make_pair( Runtime::CacheKey<1>( view ), true ) ).second;
+            if( first ) {
+                ViewSync sync;
+                sync.m_action = a;
+                sync.m_sources[0] = m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_MATRIX, NULL, view, NULL );
+                sync.m_sources[1] = m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_INVERSE_MATRIX, NULL, view, NULL );
+                sync.m_sources[2] = m_transform_cache.runtimeSemantic( RUNTIME_EYE_FROM_WORLD, NULL, view, NULL );
+                sync.m_sources[3] = m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_EYE, NULL, view, NULL );
+                keepSent( sync, previous_views, previous );
+                m_view_syncs.push_back( sync );
+            }
             m_renderlist_db.drawOrderAdd( name );
 
             for(int k=0; k<SCENE_LIGHTS_MAX; k++) {
-                const Light* l = item->m_set_view_coordsys->m_lights[k];
+                const Light* l = view->m_lights[k];
                 if( l != NULL ) {
-                    const std::string name = item->m_set_view_coordsys->idString() + "_" + l->idString();
+                    const std::string name = view->idString() + "_" + l->idString();
                     rl::SetLight* a = m_renderlist_db.castedItemByName<rl::SetLight*>( name );
                     if( a == NULL ) {
                         a = m_renderlist_db.createAction<rl::SetLight>( name );
                     }
                     a->setIndex( k );
-                    switch( l->type() ) {
-                    case Light::LIGHT_NONE:         a->setType( rl::LIGHT_AMBIENT ); break;
-                    case Light::LIGHT_AMBIENT:      a->setType( rl::LIGHT_AMBIENT ); break;
-                    case Light::LIGHT_DIRECTIONAL:  a->setType( rl::LIGHT_DIRECTIONAL ); break;
-                    case Light::LIGHT_POINT:        a->setType( rl::LIGHT_POINT ); break;
-                    case Light::LIGHT_SPOT:         a->setType( rl::LIGHT_SPOT ); break;
+                    if( first ) {
+                        LightSync sync;
+                        sync.m_action = a;
+                        sync.m_light = l;
+                        sync.m_sources[0] = m_transform_cache.runtimeSemantic( (RuntimeSemantic)(RUNTIME_LIGHT0_EYE_FROM_WORLD + k),
+                                                                               NULL, view, NULL );
+                        sync.m_sources[1] = m_transform_cache.runtimeSemantic( (RuntimeSemantic)(RUNTIME_WORLD_FROM_LIGHT0_EYE + k),
+                                                                               NULL, view, NULL );
+                        sync.m_pending = !keepSent( sync, previous_lights, previous );
+                        m_light_index.insert( std::make_pair( l->Identifiable::id(), m_light_syncs.size() ) );
+                        m_light_syncs.push_back( sync );
                     }
-                    a->setColor( l->color()->floatData()[0],
-                                 l->color()->floatData()[1],
-                                 l->color()->floatData()[2] );
-                    a->setAttenuation( l->constantAttenuation()->floatData()[0],
-                                       l->linearAttenuation()->floatData()[0],
-                                       l->quadraticAttenuation()->floatData()[0] );
-                    a->setFalloff( l->falloffAngle()->floatData()[0],
-                                   l->falloffExponent()->floatData()[0] );
-                    a->setOrientation( m_transform_cache.runtimeSemantic( (RuntimeSemantic)(RUNTIME_LIGHT0_EYE_FROM_WORLD + k),
-                                                                          NULL, item->m_set_view_coordsys, NULL )->floatData(),
-                                       m_transform_cache.runtimeSemantic( (RuntimeSemantic)(RUNTIME_WORLD_FROM_LIGHT0_EYE + k),
-                                                                          NULL, item->m_set_view_coordsys, NULL )->floatData() );
                     m_renderlist_db.drawOrderAdd( name );
                 }
             }
         }
 
         if( prev_item->m_set_local_coordsys != item->m_set_local_coordsys ) {
-            const std::string name = item->m_set_local_coordsys->idString();
+            const Runtime::SetLocalCoordSys* local = item->m_set_local_coordsys;
+            const std::string name = local->idString();
             rl::SetLocalCoordSys* a = m_renderlist_db.castedItemByName<rl::SetLocalCoordSys*>( name );
             if( a == NULL ) {
                 a = m_renderlist_db.createAction<rl::SetLocalCoordSys>( name );
             }
-            a->setOrientation( m_transform_cache.runtimeSemantic( RUNTIME_OBJECT_FROM_WORLD,
-                                                                  NULL, NULL, item->m_set_local_coordsys )->floatData(),
-                               m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_OBJECT,
-                                                                  NULL, NULL, item->m_set_local_coordsys )->floatData() );
+            if( synced.insert( std::make_pair( Runtime::CacheKey<1>( local ), true ) ).second ) {
+                LocalSync sync;
+                sync.m_action = a;
+                sync.m_sources[0] = m_transform_cache.runtimeSemantic( RUNTIME_OBJECT_FROM_WORLD, NULL, NULL, local );
+                sync.m_sources[1] = m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_OBJECT, NULL, NULL, local );
+                keepSent( sync, previous_locals, previous );
+                m_local_syncs.push_back( sync );
+            }
             m_renderlist_db.drawOrderAdd( name );
         }
 
@@ -355,87 +390,29 @@ Bridge::push()
             if( su == NULL ) {
                 su = m_renderlist_db.createAction<rl::SetUniforms>( name );
             }
-            su->setShader( item->m_set_uniforms->m_pass->idString() );
-            su->clear();
-
-            for( size_t j=0; j<item->m_set_uniforms->m_items.size(); j++ ) {
-                const Runtime::SetUniforms::Item& m = item->m_set_uniforms->m_items[j];
-                const std::string& sym = item->m_set_uniforms->m_pass->uniformSymbol(j);
-                if( m.m_semantic != RUNTIME_SEMANTIC_N ) {
-                    rl::UniformSemantic semantic;
-                    switch( m.m_semantic ) {
-                    case RUNTIME_MODELVIEW_PROJECTION_MATRIX:
-                        semantic = rl::SEMANTIC_MODELVIEW_PROJECTION_MATRIX;
-                        break;
-                    case RUNTIME_NORMAL_MATRIX:
-                        semantic = rl::SEMANTIC_NORMAL_MATRIX;
-                        break;
-                    default:
-                        SCENELOG_ERROR( log, "Symbol '" << sym << "' has unsupported semantic " << m.m_semantic );
-                        continue;
-                    }
-                    su->setSemantic( sym, semantic );
-                }
-                else {
-                    switch( m.m_value->type() ) {
-                    case VALUE_TYPE_INT:      su->setInt1( sym, m.m_value->intData()[0] ); break;
-                    case VALUE_TYPE_FLOAT:    su->setFloat1v( sym, m.m_value->floatData() ); break;
-                    case VALUE_TYPE_FLOAT2:   su->setFloat2v( sym, m.m_value->floatData() ); break;
-                    case VALUE_TYPE_FLOAT3:   su->setFloat3v( sym, m.m_value->floatData() ); break;
-                    case VALUE_TYPE_FLOAT4:   su->setFloat4v( sym, m.m_value->floatData() ); break;
-                    case VALUE_TYPE_FLOAT3X3: su->setFloat3x3v( sym, m.m_value->floatData() ); break;
-                    case VALUE_TYPE_FLOAT4X4: su->setFloat4x4v( sym, m.m_value->floatData() ); break;
-                    case VALUE_TYPE_BOOL:
-                    case VALUE_TYPE_SAMPLER1D:
-                    case VALUE_TYPE_SAMPLER2D:
-                    case VALUE_TYPE_SAMPLER3D:
-                    case VALUE_TYPE_SAMPLERCUBE:
-                    case VALUE_TYPE_SAMPLERDEPTH: su->setInt1( sym, m.m_value->intData()[0] ); break;
-                    default:
-                        break;
-                    }
-                }
+            if( synced.insert( std::make_pair( Runtime::CacheKey<1>( item->m_set_uniforms ), true ) ).second ) {
+                UniformSync sync;
+                sync.m_action = su;
+                sync.m_set_uniforms = item->m_set_uniforms;
+                sync.m_pending = previous.find( Runtime::CacheKey<1>( item->m_set_uniforms ) ) == previous.end();
+                m_uniform_syncs.push_back( sync );
             }
             m_renderlist_db.drawOrderAdd( name );
         }
 
-        if( prev_item->m_set_samplers != item->m_set_samplers) {
-        }
-
-        if( prev_item->m_set_fb_ctrl != item->m_set_fb_ctrl ) {
-        }
-
-        if( prev_item->m_set_pixel_ops != item->m_set_pixel_ops ) {
-        }
-
-        if( prev_item->m_set_raster != item->m_set_raster ) {
-        }
-
         if( item->m_draw != NULL ) {
             const std::string name = item->m_draw->idString();
             rl::Draw* rl_action = m_renderlist_db.castedItemByName<rl::Draw*>( name );
             if( rl_action == NULL ) {
                 rl_action = m_renderlist_db.createAction<rl::Draw>( name );
             }
-            rl::PrimitiveType type = rl::PRIMITIVE_POINTS;
-            switch( item->m_draw->m_mode ) {
-            case GL_POINTS:         type = rl::PRIMITIVE_POINTS; break;
-            case GL_LINES:          type = rl::PRIMITIVE_LINES; break;
-            case GL_LINE_STRIP:     type = rl::PRIMITIVE_LINE_STRIP; break;
-            case GL_LINE_LOOP:      type = rl::PRIMITIVE_LINE_LOOP; break;
-            case GL_TRIANGLES:      type = rl::PRIMITIVE_TRIANGLES; break;
-            case GL_TRIANGLE_STRIP: type = rl::PRIMITIVE_TRIANGLE_STRIP; break;
-            case GL_TRIANGLE_FAN:   type = rl::PRIMITIVE_TRIANGLE_FAN; break;
-            case GL_QUADS:          type = rl::PRIMITIVE_QUADS; break;
-            case GL_QUAD_STRIP:     type = rl::PRIMITIVE_QUAD_STRIP; break;
-            }
-            rl_action->setNonIndexed( type,
+            rl_action->setNonIndexed( primitiveType( item->m_draw->m_mode ),
                                       item->m_draw->m_first,
                                       item->m_draw->m_count );
             m_renderlist_db.drawOrderAdd( name );
         }
 
-         if( item->m_draw_indexed != NULL ) {
+        if( item->m_draw_indexed != NULL ) {
             rl::Buffer* rl_buffer = m_renderlist_db.castedItemByName<rl::Buffer*>( item->m_draw_indexed->m_index_buffer->idString() );
             if( rl_buffer == NULL ) {
                 SCENELOG_ERROR( log, "renderlist buffer '" <<  item->m_draw_indexed->m_index_buffer->idString() << "' doesn't exist!" );
@@ -446,19 +423,6 @@ Bridge::push()
                 if( rl_action == NULL ) {
                     rl_action = m_renderlist_db.createAction<rl::Draw>( name );
                 }
-                rl::PrimitiveType type = rl::PRIMITIVE_POINTS;
-                switch( item->m_draw_indexed->m_mode ) {
-                case GL_POINTS:         type = rl::PRIMITIVE_POINTS; break;
-                case GL_LINES:          type = rl::PRIMITIVE_LINES; break;
-                case GL_LINE_STRIP:     type = rl::PRIMITIVE_LINE_STRIP; break;
-                case GL_LINE_LOOP:      type = rl::PRIMITIVE_LINE_LOOP; break;
-                case GL_TRIANGLES:      type = rl::PRIMITIVE_TRIANGLES; break;
-                case GL_TRIANGLE_STRIP: type = rl::PRIMITIVE_TRIANGLE_STRIP; break;
-                case GL_TRIANGLE_FAN:   type = rl::PRIMITIVE_TRIANGLE_FAN; break;
-                case GL_QUADS:          type = rl::PRIMITIVE_QUADS; break;
-                case GL_QUAD_STRIP:     type = rl::PRIMITIVE_QUAD_STRIP; break;
-                }
-
                 size_t first = 0;
                 switch( item->m_draw_indexed->m_type ) {
                 case GL_UNSIGNED_BYTE:
@@ -471,154 +435,168 @@ Bridge::push()
                     first = (size_t)item->m_draw_indexed->m_offset/sizeof(GLint);
                     break;
                 }
-                rl_action->setIndexed( type,
+                rl_action->setIndexed( primitiveType( item->m_draw_indexed->m_mode ),
                                        rl_buffer->id(),
                                        first,
                                        item->m_draw_indexed->m_count );
                 m_renderlist_db.drawOrderAdd( name );
             }
-         }
+        }
 
-         prev_item = item;
+        prev_item = item;
     }
+}
 
+void
+Bridge::pushLight( const LightSync& sync )
+{
+    const Light* l = sync.m_light;
+    rl::SetLight* a = sync.m_action;
+    switch( l->type() ) {
+    case Light::LIGHT_NONE:         a->setType( rl::LIGHT_AMBIENT ); break;
+    case Light::LIGHT_AMBIENT:      a->setType( rl::LIGHT_AMBIENT ); break;
+    case Light::LIGHT_DIRECTIONAL:  a->setType( rl::LIGHT_DIRECTIONAL ); break;
+    case Light::LIGHT_POINT:        a->setType( rl::LIGHT_POINT ); break;
+    case Light::LIGHT_SPOT:         a->setType( rl::LIGHT_SPOT ); break;
+    }
+    a->setColor( l->color()->floatData()[0],
+                 l->color()->floatData()[1],
+                 l->color()->floatData()[2] );
+    a->setAttenuation( l->constantAttenuation()->floatData()[0],
+                       l->linearAttenuation()->floatData()[0],
+                       l->quadraticAttenuation()->floatData()[0] );
+    a->setFalloff( l->falloffAngle()->floatData()[0],
+                   l->falloffExponent()->floatData()[0] );
+}
 
-#else
-    for( size_t i=0; i<m_renderlist.size(); i++ ) {
-        const Runtime::RenderAction* action = m_renderlist[i];
-
-        if( true || !m_last_update.asRecentAs( action->m_timestamp )  ) {
-            Runtime::CacheKey<1> key( action );
-            auto it = actions.find( key );
-            if( it == actions.end() ) {
-                actions[ key ] = action;
-                // Make sure that assets are updated as well
-                // Iterate over all set_buffers and make sure that the clients
-                // gets updated source buffers
-                if( action->m_type == Runtime::RenderAction::ACTION_SET_INPUTS ) {
-                    for( size_t j=0; j<action->m_set_inputs.m_items.size(); j++ ) {
-                        const SourceBuffer* buf = action->m_set_inputs.m_items[j].m_source;
-                        if( (m_renderlist_db.itemByName( boost::lexical_cast<std::string>(buf) ) == NULL ) ||
-                            (!m_last_update.asRecentAs( buf->valueChanged() ) ) )
-                        {
-                            Runtime::CacheKey<1> buf_key( buf );
-                            auto it = source_buffers.find( buf_key );
-                            if( it == source_buffers.end() ) {
-                                source_buffers[ buf_key ] = buf;
-                            }
-                        }
-                    }
-                }
-                // Make sure that client has updated buffer with index data
-                else if( action->m_type == Runtime::RenderAction::ACTION_DRAW_INDEXED ) {
-                    const SourceBuffer* buf = action->m_draw_indexed.m_index_buffer;
-                    if( (m_renderlist_db.itemByName( boost::lexical_cast<std::string>(buf) ) == NULL ) ||
-                        (!m_last_update.asRecentAs( buf->valueChanged() ) ) )
-                    {
-                        Runtime::CacheKey<1> buf_key( buf );
-                        auto it = source_buffers.find( buf_key );
-                        if( it == source_buffers.end() ) {
-                            source_buffers[ buf_key ] = buf;
-                        }
-                    }
-                }
+void
+Bridge::pushUniforms( const UniformSync& sync )
+{
+    static const Logger log = getLogger( package + ".pushUniforms" );
+
+    const Runtime::SetUniforms* set_uniforms = sync.m_set_uniforms;
+    rl::SetUniforms* su = sync.m_action;
+    su->setShader( set_uniforms->m_pass->idString() );
+    su->clear();
+
+    for( size_t j=0; j<set_uniforms->m_items.size(); j++ ) {
+        const Runtime::SetUniforms::Item& m = set_uniforms->m_items[j];
+        const std::string& sym = set_uniforms->m_pass->uniformSymbol(j);
+        if( m.m_semantic != RUNTIME_SEMANTIC_N ) {
+            rl::UniformSemantic semantic;
+            switch( m.m_semantic ) {
+            case RUNTIME_MODELVIEW_PROJECTION_MATRIX:
+                semantic = rl::SEMANTIC_MODELVIEW_PROJECTION_MATRIX;
+                break;
+            case RUNTIME_NORMAL_MATRIX:
+                semantic = rl::SEMANTIC_NORMAL_MATRIX;
+                break;
+            default:
+                SCENELOG_ERROR( log, "Symbol '" << sym << "' has unsupported semantic " << m.m_semantic );
+                continue;
+            }
+            su->setSemantic( sym, semantic );
+        }
+        else {
+            switch( m.m_value->type() ) {
+            case VALUE_TYPE_INT:      su->setInt1( sym, m.m_value->intData()[0] ); break;
+            case VALUE_TYPE_FLOAT:    su->setFloat1v( sym, m.m_value->floatData() ); break;
+            case VALUE_TYPE_FLOAT2:   su->setFloat2v( sym, m.m_value->floatData() ); break;
+            case VALUE_TYPE_FLOAT3:   su->setFloat3v( sym, m.m_value->floatData() ); break;
+            case VALUE_TYPE_FLOAT4:   su->setFloat4v( sym, m.m_value->floatData() ); break;
+            case VALUE_TYPE_FLOAT3X3: su->setFloat3x3v( sym, m.m_value->floatData() ); break;
+            case VALUE_TYPE_FLOAT4X4: su->setFloat4x4v( sym, m.m_value->floatData() ); break;
+            case VALUE_TYPE_BOOL:
+            case VALUE_TYPE_SAMPLER1D:
+            case VALUE_TYPE_SAMPLER2D:
+            case VALUE_TYPE_SAMPLER3D:
+            case VALUE_TYPE_SAMPLERCUBE:
+            case VALUE_TYPE_SAMPLERDEPTH: su->setInt1( sym, m.m_value->intData()[0] ); break;
+            default:
+                break;
+            }
+        }
+    }
+}
 
-                else if( action->m_type == Runtime::RenderAction::ACTION_SET_PASS ) {
-                    const Pass* pass = action->m_set_pass.m_pass;
-                    if( (m_renderlist_db.itemByName( boost::lexical_cast<std::string>(pass) ) == NULL ) ||
-                        (!m_last_update.asRecentAs( pass->valueChanged() ) ) )
-                    {
-                        Runtime::CacheKey<1> shader_key( pass );
-                        auto it = shaders.find( shader_key );
-                        if( it == shaders.end() ) {
-                            shaders[ shader_key ] = pass;
-                        }
-                    }
-                }
+namespace {
 
-                else if( action->m_type == Runtime::RenderAction::ACTION_SET_SAMPLERS ) {
-                    for( size_t j=0; j<action->m_set_samplers.m_items.size(); j++ ) {
-                        const Image* image = action->m_set_samplers.m_items[j].m_image;
-                        if( !m_last_update.asRecentAs( image->valueChanged() ) ) {
-                            Runtime::CacheKey<1> image_key( image );
-                            auto it = images.find( image_key );
-                            if( it == images.end() ) {
-                                images[ image_key ] = image;
-                            }
-                        }
-                    }
-                }
+// Flags the indices of the objects in changes.
+template<typename T>
+void
+flagChanged( std::vector<char>&                                         flags,
+             const std::vector<typename Library<T>::Change>&            changes,
+             const std::unordered_multimap<Identifiable::Id,size_t>&    index )
+{
+    for( size_t i=0; i<changes.size(); i++ ) {
+        auto range = index.equal_range( changes[i].m_identity );
+        for( auto it=range.first; it!=range.second; ++it ) {
+            flags[ it->second ] = 1;
+        }
+    }
+}
 
-                else if( action->m_type == Runtime::RenderAction::ACTION_SET_FRAMEBUFFER ) {
-                    for( size_t j=0; j<action->m_set_render_targets.m_items.size(); j++ ) {
-                        const Image* image = action->m_set_samplers.m_items[j].m_image;
-                        if( !m_last_update.asRecentAs( image->valueChanged() ) ) {
-                            Runtime::CacheKey<1> image_key( image );
-                            auto it = images.find( image_key );
-                            if( it == images.end() ) {
-                                images[ image_key ] = image;
-                            }
-                        }
-                    }
-                }
+} // of anonymous namespace
 
-                else if( action->m_type == Runtime::RenderAction::ACTION_SET_VIEW_COORDSYS ) {
-                    // Tag matrices that are needed so they will be calculated
-                    // when we do update
-                    m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_MATRIX,
-                                                       NULL,
-                                                       &action->m_set_view,
-                                                       NULL );
-                    m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_INVERSE_MATRIX,
-                                                       NULL,
-                                                       &action->m_set_view,
-                                                       NULL );
-                    m_transform_cache.runtimeSemantic( RUNTIME_EYE_FROM_WORLD,
-                                                       NULL,
-                                                       &action->m_set_view,
-                                                       NULL );
-                    m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_EYE,
-                                                       NULL,
-                                                       &action->m_set_view,
-                                                       NULL );
-                    for( int i=0; i<SCENE_LIGHTS_MAX; i++ ) {
-                        if( action->m_set_view.m_lights[i] != NULL ) {
-                            m_transform_cache.runtimeSemantic( (RuntimeSemantic)(RUNTIME_LIGHT0_EYE_FROM_WORLD + i),
-                                                               NULL,
-                                                               &action->m_set_view,
-                                                               NULL );
-                            m_transform_cache.runtimeSemantic( (RuntimeSemantic)(RUNTIME_WORLD_FROM_LIGHT0_EYE + i),
-                                                               NULL,
-                                                               &action->m_set_view,
-                                                               NULL );
-
-                        }
-                    }
-                }
+bool
+Bridge::journaledChanges( std::vector<char>& buffers,
+                          std::vector<char>& shaders,
+                          std::vector<char>& lights ) const
+{
+    std::vector<Library<SourceBuffer>::Change> buffer_changes;
+    std::vector<Library<Effect>::Change> effect_changes;
+    std::vector<Library<Light>::Change> light_changes;
+    if( !m_database.library<SourceBuffer>().changesSince( buffer_changes, m_last_update ) ||
+        !m_database.library<Effect>().changesSince( effect_changes, m_last_update ) ||
+        !m_database.library<Light>().changesSince( light_changes, m_last_update ) )
+    {
+        return false;
+    }
+    buffers.assign( m_buffers.size(), 0 );
+    shaders.assign( m_shaders.size(), 0 );
+    lights.assign( m_light_syncs.size(), 0 );
+    flagChanged<SourceBuffer>( buffers, buffer_changes, m_buffer_index );
+    flagChanged<Effect>( shaders, effect_changes, m_shader_index );
+    flagChanged<Light>( lights, light_changes, m_light_index );
+    return true;
+}
 
-                else if( action->m_type == Runtime::RenderAction::ACTION_SET_LOCAL_COORDSYS ) {
-                    // Tag matrices that are needed so they will be calculated
-                    // when we do update
-                    m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_OBJECT,
-                                                       NULL,
-                                                       NULL,
-                                                       &action->m_set_local );
-                    m_transform_cache.runtimeSemantic( RUNTIME_OBJECT_FROM_WORLD,
-                                                       NULL,
-                                                       NULL,
-                                                       &action->m_set_local );
-                }
-            }
-        }
+void
+Bridge::push( bool rebuilt )
+{
+    static const Logger log = getLogger( package + ".push" );
+    SCENE_PROFILE_SCOPE( "Bridge::push" );
+
+    m_push_statistics.m_draw_order = rebuilt;
+    m_push_statistics.m_buffers = 0;
+    m_push_statistics.m_shaders = 0;
+    m_push_statistics.m_coordsys = 0;
+    m_push_statistics.m_uniforms = 0;
+
+    // Step 1, find what the render list uses, only when it has changed.
+    if( rebuilt ) {
+        collect();
     }
     m_transform_cache.update( 1, 1 );
 
+    // Step 2, find what has changed since the last push. After a rebuild,
+    // everything is examined as there may be new objects to send.
+    std::vector<char> buffers_changed;
+    std::vector<char> shaders_changed;
+    std::vector<char> lights_changed;
+    const bool journaled = !rebuilt && journaledChanges( buffers_changed, shaders_changed, lights_changed );
 
-    // -- push buffer objects
-    for( auto it=source_buffers.begin(); it!=source_buffers.end(); ++it ) {
-        const SourceBuffer* bd = it->second;
-        std::string id = boost::lexical_cast<std::string>( bd );
+    // -- push buffer objects that the client doesn't have or that have changed
+    for( size_t i=0; i<m_buffers.size(); i++ ) {
+        if( journaled && !buffers_changed[i] ) {
+            continue;
+        }
+        const SourceBuffer* bd = m_buffers[i];
+        std::string id = bd->idString();
         rl::Buffer* bs = m_renderlist_db.castedItemByName<rl::Buffer*>( id );
+        if( (bs != NULL) && m_last_update.asRecentAs( bd->valueChanged() ) ) {
+            continue;
+        }
         if( bs == NULL ) {
             bs = m_renderlist_db.createBuffer( id );
         }
@@ -632,23 +610,29 @@ Bridge::push()
             SCENELOG_INFO( log, "buffer[" <<id<<"] (" << bd->id() << ") = float(..."<< bd->elementCount() << "...)" );
             break;
         }
+        m_push_statistics.m_buffers++;
     }
 
     // --- push images
-    for( auto it=images.begin(); it!=images.end(); ++it ) {
-        const Image* di = it->second;
-        std::string id = boost::lexical_cast<std::string>( di );
-        SCENELOG_DEBUG( log, "image[" << id << "] <- ignored" );
+    for( size_t i=0; i<m_images.size(); i++ ) {
+        const Image* di = m_images[i];
+        if( !m_last_update.asRecentAs( di->valueChanged() ) ) {
+            SCENELOG_DEBUG( log, "image[" << di->idString() << "] <- ignored" );
+        }
     }
 
     // --- push shaders
-    for( auto it=shaders.begin(); it!=shaders.end(); ++it ) {
-        const Pass* ss = it->second;
-        std::string id = boost::lexical_cast<std::string>( ss );
-        rl::Shader* ls = m_renderlist_db.castedItemByName<rl::Shader*>( id );
-        SCENELOG_INFO( log, "shader[" << id << "]" );
+    for( size_t i=0; i<m_shaders.size(); i++ ) {
+        if( journaled && !shaders_changed[i] ) {
+            continue;
+        }
+        const Pass* ss = m_shaders[i];
+        rl::Shader* ls = m_renderlist_db.castedItemByName<rl::Shader*>( ss->idString() );
+        if( (ls != NULL) && m_last_update.asRecentAs( ss->valueChanged() ) ) {
+            continue;
+        }
         if( ls == NULL ) {
-            ls = m_renderlist_db.createShader( id );
+            ls = m_renderlist_db.createShader( ss->idString() );
         }
         if( !ss->shaderSource( STAGE_VERTEX ).empty() ) {
             ls->setVertexStage( ss->shaderSource( STAGE_VERTEX ) );
@@ -670,316 +654,58 @@ Bridge::push()
             ls->setFragmentStage( ss->shaderSource( STAGE_FRAGMENT ) );
             SCENELOG_INFO( log, "+- fragment shader" );
         }
+        m_push_statistics.m_shaders++;
     }
 
-    // --- push actions
-    for( auto it=actions.begin(); it!=actions.end(); ++it ) {
-        const Runtime::RenderAction* sc_action = it->second;
-        std::string id = boost::lexical_cast<std::string>( sc_action->m_serial_no );
-
-        // --- SetViewCoordSys -------------------------------------------------
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_SET_VIEW_COORDSYS ) {
-            rl::SetViewCoordSys* la = m_renderlist_db.castedItemByName<rl::SetViewCoordSys*>( id );
-            if( la == NULL ) {
-                la = m_renderlist_db.createAction<rl::SetViewCoordSys>( id );
-            }
-            la->setProjection( m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_MATRIX,
-                                                                  NULL,
-                                                                  &sc_action->m_set_view,
-                                                                  NULL )->floatData(),
-                               m_transform_cache.runtimeSemantic( RUNTIME_PROJECTION_INVERSE_MATRIX,
-                                                                  NULL,
-                                                                  &sc_action->m_set_view,
-                                                                  NULL )->floatData() );
-            la->setOrientation( m_transform_cache.runtimeSemantic( RUNTIME_EYE_FROM_WORLD,
-                                                                   NULL,
-                                                                   &sc_action->m_set_view,
-                                                                   NULL )->floatData(),
-                                m_transform_cache.runtimeSemantic( RUNTIME_EYE_FROM_WORLD,
-                                                                   NULL,
-                                                                   &sc_action->m_set_view,
-                                                                   NULL )->floatData() );
-
-            SCENELOG_INFO( log, "setViewCoordSys[" << id << "]" );
-            for(int i=0; i<SCENE_LIGHTS_MAX; i++) {
-                if( sc_action->m_set_view.m_lights[i] != NULL ) {
-                    const Light* l = sc_action->m_set_view.m_lights[i];
-
-                    const std::string lid = id + '_' + boost::lexical_cast<std::string>( i );
-                    rl::SetLight* sl = m_renderlist_db.castedItemByName<rl::SetLight*>( lid );
-                    if( sl == NULL ) {
-                        sl = m_renderlist_db.createAction<rl::SetLight>( lid );
-                    }
-                    sl->setIndex( i );
-                    switch( l->type() ) {
-                    case Light::LIGHT_NONE:         sl->setType( rl::LIGHT_AMBIENT ); break;
-                    case Light::LIGHT_AMBIENT:      sl->setType( rl::LIGHT_AMBIENT ); break;
-                    case Light::LIGHT_DIRECTIONAL:  sl->setType( rl::LIGHT_DIRECTIONAL ); break;
-                    case Light::LIGHT_POINT:        sl->setType( rl::LIGHT_POINT ); break;
-                    case Light::LIGHT_SPOT:         sl->setType( rl::LIGHT_SPOT ); break;
-                    }
-                    sl->setColor( l->color()->floatData()[0],
-                                  l->color()->floatData()[1],
-                                  l->color()->floatData()[2] );
-                    sl->setAttenuation( l->constantAttenuation()->floatData()[0],
-                                        l->linearAttenuation()->floatData()[0],
-                                        l->quadraticAttenuation()->floatData()[0] );
-                    sl->setFalloff( l->falloffAngle()->floatData()[0],
-                                    l->falloffExponent()->floatData()[0] );
-                    sl->setOrientation( m_transform_cache.runtimeSemantic( (RuntimeSemantic)(RUNTIME_LIGHT0_EYE_FROM_WORLD + i),
-                                                                           NULL,
-                                                                           &sc_action->m_set_view,
-                                                                           NULL )->floatData(),
-                                        m_transform_cache.runtimeSemantic( (RuntimeSemantic)(RUNTIME_WORLD_FROM_LIGHT0_EYE + i),
-                                                                           NULL,
-                                                                           &sc_action->m_set_view,
-                                                                           NULL )->floatData() );
-                    SCENELOG_INFO( log, "SetLight[" << lid << "]" );
-                }
-            }
-        }
-        // --- SetLocalCoordSys ------------------------------------------------
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_SET_LOCAL_COORDSYS ) {
-            rl::SetLocalCoordSys* rl_action = m_renderlist_db.castedItemByName<rl::SetLocalCoordSys*>( id );
-            if( rl_action == NULL ) {
-                rl_action = m_renderlist_db.createAction<rl::SetLocalCoordSys>( id );
-            }
-            rl_action->setOrientation( m_transform_cache.runtimeSemantic( RUNTIME_OBJECT_FROM_WORLD,
-                                                                          NULL,
-                                                                          NULL,
-                                                                          &sc_action->m_set_local )->floatData(),
-                                       m_transform_cache.runtimeSemantic( RUNTIME_WORLD_FROM_OBJECT,
-                                                                          NULL,
-                                                                          NULL,
-                                                                          &sc_action->m_set_local )->floatData() );
-
-            SCENELOG_INFO( log, "setLocalCoordSys[" << id << "]" );
-        }
-        // --- SetShader -------------------------------------------------------
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_SET_PASS ) {
-            rl::SetShader* rl_action = m_renderlist_db.castedItemByName<rl::SetShader*>( id );
-            if( rl_action == NULL ) {
-                rl_action = m_renderlist_db.createAction<rl::SetShader>( id );
-            }
-
-            const std::string shader = boost::lexical_cast<std::string>( sc_action->m_set_pass.m_pass );
-            rl_action->setShader( shader );
-            SCENELOG_INFO( log, "setShader[" << id << "]" );
-            SCENELOG_INFO( log, "+- shader = " << shader );
-        }
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_SET_INPUTS ) {
-            SCENELOG_INFO( log, "setInputs[" << id << "]" );
-            rl::SetInputs* si = m_renderlist_db.castedItemByName<rl::SetInputs*>( id );
-            if( si == NULL ) {
-                si = m_renderlist_db.createAction<rl::SetInputs>( id );
-            }
-            const std::string sh_id = boost::lexical_cast<std::string>( sc_action->m_set_inputs.m_pass );
-            SCENELOG_INFO( log, "+- shader = " << sh_id );
-            si->setShader( sh_id );
-
-            si->clearInputs();
-            for( size_t j=0; j<sc_action->m_set_inputs.m_items.size(); j++ ) {
-                const Runtime::SetInputs::Item& m = sc_action->m_set_inputs.m_items[j];
-                const std::string buf_id = boost::lexical_cast<std::string>( sc_action->m_set_inputs.m_items[j].m_source );
-                si->setInput( sc_action->m_set_inputs.m_pass->attributeSymbol(j),
-                              buf_id,
-                              m.m_components,
-                              m.m_offset,
-                              m.m_stride );
-                SCENELOG_INFO( log, "+- input[" << sc_action->m_set_inputs.m_pass->attributeSymbol(j)
-                               << "] = " << buf_id << ":" <<
-                               m.m_components << ":" << m.m_offset << ":" << m.m_stride );
-            }
-
-        }
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_SET_FRAMEBUFFER ) {
-            SCENELOG_INFO( log, "setFramebuffer[" << id << "]" );
-        }
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_SET_UNIFORMS ) {
-            SCENELOG_INFO( log, "setUniforms[" << id << "]" );
-            rl::SetUniforms* su = m_renderlist_db.castedItemByName<rl::SetUniforms*>( id );
-            if( su == NULL ) {
-                su = m_renderlist_db.createAction<rl::SetUniforms>( id );
-            }
-            const std::string sh_id = boost::lexical_cast<std::string>( sc_action->m_set_uniforms.m_pass );
-            SCENELOG_INFO( log, "+- shader = " << sh_id );
-            su->setShader( sh_id );
-            su->clear();
-            for( size_t j=0; j<sc_action->m_set_uniforms.m_items.size(); j++ ) {
-                const Runtime::SetUniforms::Item& m = sc_action->m_set_uniforms.m_items[j];
-
-                const std::string& sym = sc_action->m_set_uniforms.m_pass->uniformSymbol(j);
-                if( m.m_semantic != RUNTIME_SEMANTIC_N ) {
-
-                    rl::UniformSemantic semantic;
-                    switch( m.m_semantic ) {
-                    case RUNTIME_MODELVIEW_PROJECTION_MATRIX:
-                        semantic = rl::SEMANTIC_MODELVIEW_PROJECTION_MATRIX;
-                        break;
-                    case RUNTIME_NORMAL_MATRIX:
-                        semantic = rl::SEMANTIC_NORMAL_MATRIX;
-                        break;
-                    default:
-                        SCENELOG_ERROR( log, "Symbol '" << sym << "' has unsupported semantic " << m.m_semantic );
-                        continue;
-                        //semantic = rl::SEMANTIC_MODELVIEW_PROJECTION_MATRIX;
-                    }
-                    su->setSemantic( sym, semantic );
-                    SCENELOG_INFO( log, "+- " << sym << " = semantic " << semantic );
-                }
-                else {
-                    switch( m.m_value->type() ) {
-                    case VALUE_TYPE_INT:
-                        su->setInt1( sym, m.m_value->intData()[0] );
-                        SCENELOG_INFO( log, "+- " << sym << " int" );
-                        break;
-                    case VALUE_TYPE_FLOAT:
-                        su->setFloat1v( sym, m.m_value->floatData() );
-                        SCENELOG_INFO( log, "+- " << sym << " float" );
-                        break;
-                    case VALUE_TYPE_FLOAT2:
-                        su->setFloat2v( sym, m.m_value->floatData() );
-                        SCENELOG_INFO( log, "+- " << sym << " float2" );
-                        break;
-                    case VALUE_TYPE_FLOAT3:
-                        su->setFloat3v( sym, m.m_value->floatData() );
-                        SCENELOG_INFO( log, "+- " << sym << " float3" );
-                        break;
-                    case VALUE_TYPE_FLOAT4:
-                        su->setFloat4v( sym, m.m_value->floatData() );
-                        SCENELOG_INFO( log, "+- " << sym << " float4" );
-                        break;
-                    case VALUE_TYPE_FLOAT3X3:
-                        su->setFloat3x3v( sym, m.m_value->floatData() );
-                        SCENELOG_INFO( log, "+- " << sym << " float3x3" );
-                        break;
-                    case VALUE_TYPE_FLOAT4X4:
-                        su->setFloat4x4v( sym, m.m_value->floatData() );
-                        SCENELOG_INFO( log, "+- " << sym << " float4x4" );
-                        break;
-                    case VALUE_TYPE_BOOL:
-                    case VALUE_TYPE_SAMPLER1D:
-                    case VALUE_TYPE_SAMPLER2D:
-                    case VALUE_TYPE_SAMPLER3D:
-                    case VALUE_TYPE_SAMPLERCUBE:
-                    case VALUE_TYPE_SAMPLERDEPTH:
-                        su->setInt1( sym, m.m_value->intData()[0] );
-                        SCENELOG_INFO( log, "+- " << sym << " int" );
-                        break;
-                    default:
-                        break;
-                    }
-
-                }
-
-
-
-
-                /*
-                SCENELOG_DEBUG( log, "  uniform " << i << ": symbol='" << m_set_uniforms.m_pass->uniformSymbol(i) <<
-                                    "', sem=" << m.m_semantic <<
-                                    ", value=" << m.m_value->debugString() );
-                */
-            }
+    // --- actions and draw order, only when the render list has changed
+    if( rebuilt ) {
+        rebuildDrawOrder();
+    }
 
+    // --- matrices that differ from what was last sent
+    for( size_t i=0; i<m_view_syncs.size(); i++ ) {
+        ViewSync& sync = m_view_syncs[i];
+        if( matricesChanged( sync ) ) {
+            sync.m_action->setProjection( sync.m_sent[0], sync.m_sent[1] );
+            sync.m_action->setOrientation( sync.m_sent[2], sync.m_sent[3] );
+            m_push_statistics.m_coordsys++;
         }
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_SET_SAMPLERS ) {
-            SCENELOG_INFO( log, "setSamplers[" << id << "]" );
-        }
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_SET_FB_CTRL ) {
-            SCENELOG_INFO( log, "setFBCtrl[" << id << "]" );
+    }
+    for( size_t i=0; i<m_light_syncs.size(); i++ ) {
+        LightSync& sync = m_light_syncs[i];
+        const bool changed = journaled ? lights_changed[i] : !m_last_update.asRecentAs( sync.m_light->valueChanged() );
+        if( sync.m_pending || changed ) {
+            pushLight( sync );
+            sync.m_pending = false;
         }
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_SET_PIXEL_OPS ) {
-            SCENELOG_INFO( log, "setPixelOps[" << id << "]" );
+        if( matricesChanged( sync ) ) {
+            sync.m_action->setOrientation( sync.m_sent[0], sync.m_sent[1] );
+            m_push_statistics.m_coordsys++;
         }
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_SET_RASTER ) {
-            SCENELOG_INFO( log, "setRaster[" << id << "]" );
+    }
+    for( size_t i=0; i<m_local_syncs.size(); i++ ) {
+        LocalSync& sync = m_local_syncs[i];
+        if( matricesChanged( sync ) ) {
+            sync.m_action->setOrientation( sync.m_sent[0], sync.m_sent[1] );
+            m_push_statistics.m_coordsys++;
         }
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_DRAW ) {
-            rl::Draw* rl_action = m_renderlist_db.castedItemByName<rl::Draw*>( id );
-            if( rl_action == NULL ) {
-                rl_action = m_renderlist_db.createAction<rl::Draw>( id );
-            }
-            rl::PrimitiveType type = rl::PRIMITIVE_POINTS;
-            switch( sc_action->m_draw.m_mode ) {
-            case GL_POINTS:         type = rl::PRIMITIVE_POINTS; break;
-            case GL_LINES:          type = rl::PRIMITIVE_LINES; break;
-            case GL_LINE_STRIP:     type = rl::PRIMITIVE_LINE_STRIP; break;
-            case GL_LINE_LOOP:      type = rl::PRIMITIVE_LINE_LOOP; break;
-            case GL_TRIANGLES:      type = rl::PRIMITIVE_TRIANGLES; break;
-            case GL_TRIANGLE_STRIP: type = rl::PRIMITIVE_TRIANGLE_STRIP; break;
-            case GL_TRIANGLE_FAN:   type = rl::PRIMITIVE_TRIANGLE_FAN; break;
-            case GL_QUADS:          type = rl::PRIMITIVE_QUADS; break;
-            case GL_QUAD_STRIP:     type = rl::PRIMITIVE_QUAD_STRIP; break;
-            }
-            size_t first = sc_action->m_draw.m_first;
-            size_t count = sc_action->m_draw.m_count;
+    }
 
-            rl_action->setNonIndexed( type, first, count );
-            SCENELOG_INFO( log, "draw[" << id <<
-                           "] type=" << type <<
-                           ", first=" << first <<
-                           ", count=" << count );
+    // --- uniform sets with values that have changed
+    for( size_t i=0; i<m_uniform_syncs.size(); i++ ) {
+        UniformSync& sync = m_uniform_syncs[i];
+        bool changed = sync.m_pending;
+        for( size_t j=0; !changed && (j<sync.m_set_uniforms->m_items.size()); j++ ) {
+            const Runtime::SetUniforms::Item& m = sync.m_set_uniforms->m_items[j];
+            changed = (m.m_semantic == RUNTIME_SEMANTIC_N) && !m_last_update.asRecentAs( m.m_value->valueChanged() );
         }
-        if( sc_action->m_type == Runtime::RenderAction::ACTION_DRAW_INDEXED ) {
-
-            const std::string buffer = boost::lexical_cast<std::string>( sc_action->m_draw_indexed.m_index_buffer );
-            rl::Buffer* rl_buffer = m_renderlist_db.castedItemByName<rl::Buffer*>( buffer );
-            if( rl_buffer == NULL ) {
-                SCENELOG_ERROR( log, "renderlist buffer '" << buffer << "' doesn't exist!" );
-            }
-            else {
-                rl::Draw* rl_action = m_renderlist_db.castedItemByName<rl::Draw*>( id );
-                if( rl_action == NULL ) {
-                    rl_action = m_renderlist_db.createAction<rl::Draw>( id );
-                }
-                rl::PrimitiveType type = rl::PRIMITIVE_POINTS;
-                switch( sc_action->m_draw_indexed.m_mode ) {
-                case GL_POINTS:         type = rl::PRIMITIVE_POINTS; break;
-                case GL_LINES:          type = rl::PRIMITIVE_LINES; break;
-                case GL_LINE_STRIP:     type = rl::PRIMITIVE_LINE_STRIP; break;
-                case GL_LINE_LOOP:      type = rl::PRIMITIVE_LINE_LOOP; break;
-                case GL_TRIANGLES:      type = rl::PRIMITIVE_TRIANGLES; break;
-                case GL_TRIANGLE_STRIP: type = rl::PRIMITIVE_TRIANGLE_STRIP; break;
-                case GL_TRIANGLE_FAN:   type = rl::PRIMITIVE_TRIANGLE_FAN; break;
-                case GL_QUADS:          type = rl::PRIMITIVE_QUADS; break;
-                case GL_QUAD_STRIP:     type = rl::PRIMITIVE_QUAD_STRIP; break;
-                }
-
-                size_t first = 0;
-                switch( sc_action->m_draw_indexed.m_type ) {
-                case GL_UNSIGNED_BYTE:
-                    first = (size_t)sc_action->m_draw_indexed.m_offset/sizeof(GLubyte);
-                    break;
-                case GL_UNSIGNED_SHORT:
-                    first = (size_t)sc_action->m_draw_indexed.m_offset/sizeof(GLshort);
-                    break;
-                case GL_UNSIGNED_INT:
-                    first = (size_t)sc_action->m_draw_indexed.m_offset/sizeof(GLint);
-                    break;
-                }
-                size_t count = sc_action->m_draw_indexed.m_count;
-                rl_action->setIndexed( type, rl_buffer->id(), first, count );
-                SCENELOG_INFO( log, "draw(indexed)[" << id <<
-                               "] type=" << type <<
-                               ", buffer=" << buffer <<
-                               ", first=" << first <<
-                               ", count=" << count );
-            }
-
+        if( changed ) {
+            pushUniforms( sync );
+            sync.m_pending = false;
+            m_push_statistics.m_uniforms++;
         }
-
     }
 
-
-    // --- update draw order
-    m_renderlist_db.drawOrderClear();
-    for( size_t i=0; i<m_renderlist.size(); i++ ) {
-        const Runtime::RenderAction* action = m_renderlist[i];
-        const std::string id = boost::lexical_cast<std::string>( action->m_serial_no );
-        m_renderlist_db.drawOrderAdd( id );
-    }
-#endif
     m_renderlist_db.process( true );
 }
 
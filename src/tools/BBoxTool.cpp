@@ -16,7 +16,9 @@
  * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <unordered_map>
 #include <scene/Log.hpp>
+#include <scene/DataBase.hpp>
 #include <scene/Geometry.hpp>
 #include <scene/SourceBuffer.hpp>
 #include <scene/tools/BBoxTool.hpp>
@@ -36,25 +38,25 @@ updateBoundingBox( Geometry* geometry )
 
 //    geometry->updateBoundingBox();
 
-    Logger log = getLogger( package + ".updateBoundingBox[" + geometry->id() + "]" );
+    static const Logger log = getLogger( package + ".updateBoundingBox" );
     DataBase& db = geometry->db();
 
     const Geometry::VertexInput& pos = geometry->vertexInput( VERTEX_POSITION );
     if( pos.m_enabled == false ) {
-        SCENELOG_TRACE( log, "Geometry has no position information, skipping" );
+        SCENELOG_TRACE( log, "'" << geometry->id() << "': Geometry has no position information, skipping" );
         return false;
     }
     if( pos.m_components == 0 ) {
-        SCENELOG_WARN( log, "Vertex position data has no components, skipping" );
+        SCENELOG_WARN( log, "'" << geometry->id() << "': Vertex position data has no components, skipping" );
         return false;
     }
     const SourceBuffer* pos_buf = db.library<SourceBuffer>().get( pos.m_source_buffer_id );
     if( pos_buf == NULL ) {
-        SCENELOG_WARN( log, "Unable to retrieve buffer with vertex position data " << pos.m_source_buffer_id );
+        SCENELOG_WARN( log, "'" << geometry->id() << "': Unable to retrieve buffer with vertex position data " << pos.m_source_buffer_id );
         return false;
     }
     if( pos_buf->elementType() != ELEMENT_FLOAT ) {
-        SCENELOG_WARN( log, "Only float vertex position data is currently handled, skipping" );
+        SCENELOG_WARN( log, "'" << geometry->id() << "': Only float vertex position data is currently handled, skipping" );
         return false;
     }
 
@@ -67,11 +69,11 @@ updateBoundingBox( Geometry* geometry )
         if( geometry->primitives(i)->isIndexed() ) {
             indices[i] = db.library<SourceBuffer>().get( geometry->primitives(i)->indexBufferId() );
             if( indices[i] == NULL ) {
-                SCENELOG_WARN( log, "Unable to retrieve index buffer" );
+                SCENELOG_WARN( log, "'" << geometry->id() << "': Unable to retrieve index buffer" );
                 return false;
             }
             if( indices[i]->elementType() != ELEMENT_INT ) {
-                SCENELOG_WARN( log, "Indices are not of type int" );
+                SCENELOG_WARN( log, "'" << geometry->id() << "': Indices are not of type int" );
                 return false;
             }
             changed = changed || !geometry->boundingBoxUpdated().asRecentAs( indices[i]->valueChanged() );
@@ -81,7 +83,7 @@ updateBoundingBox( Geometry* geometry )
         }
     }
     if( !changed ) {
-        SCENELOG_TRACE( log, "Nothing has changed that can affect the bounding box" );
+        SCENELOG_TRACE( log, "'" << geometry->id() << "': Nothing has changed that can affect the bounding box" );
         return true;
     }
 
@@ -119,7 +121,7 @@ updateBoundingBox( Geometry* geometry )
             // Determine (and check) number of vertices
             unsigned int N = p->vertexCount();
             if( indices[i]->elementCount() < index_stride*N ) {
-                SCENELOG_WARN( log, "vertexcount out of range." );
+                SCENELOG_WARN( log, "'" << geometry->id() << "': vertexcount out of range." );
                 N = indices[i]->elementCount()/index_stride;
             }
 
@@ -157,7 +159,7 @@ updateBoundingBox( Geometry* geometry )
                 }
             }
             if( illegal_indices > 0 ) {
-                SCENELOG_WARN( log, "Primitive set has " << illegal_indices << " illegal indices" );
+                SCENELOG_WARN( log, "'" << geometry->id() << "': Primitive set has " << illegal_indices << " illegal indices" );
             }
 
         }
@@ -165,7 +167,7 @@ updateBoundingBox( Geometry* geometry )
             // Primitive set is not indexed
             unsigned int N = p->vertexCount();
             if( max_v_ix < N ) {
-                SCENELOG_WARN( log, "vertexcount out of range." );
+                SCENELOG_WARN( log, "'" << geometry->id() << "': vertexcount out of range." );
                 N =  max_v_ix;
             }
             for( unsigned int i=0; i<N; i++ ) {
@@ -193,13 +195,13 @@ updateBoundingBox( Geometry* geometry )
     if( bb_empty == false ) {
         geometry->setBoundingBox( Value::createFloat4( bb_min[0], bb_min[1], bb_min[2], 1.f ),
                                   Value::createFloat4( bb_max[0], bb_max[1], bb_max[2], 1.f ) );
-        SCENELOG_TRACE( log, "bbox=["
+        SCENELOG_TRACE( log, "'" << geometry->id() << "': bbox=["
                         << bb_min[0] << ", " << bb_min[1] << ", " << bb_min[2] << "]x["
                         << bb_max[0] << ", " << bb_max[1] << ", " << bb_max[2] << "]" );
     }
     else {
         geometry->clearBoundingBox();
-        SCENELOG_TRACE( log, "bbox=[ empty ]" );
+        SCENELOG_TRACE( log, "'" << geometry->id() << "': bbox=[ empty ]" );
     }
     return true;
 }
@@ -213,6 +215,41 @@ updateBoundingBoxes( DataBase& database )
 
 }
 
+void
+updateBoundingBoxes( DataBase& database, SeqPos& updated )
+{
+    static const Logger log = getLogger( package + ".updateBoundingBoxes" );
+
+    std::vector<Library<Geometry>::Change> geometry_changes;
+    std::vector<Library<SourceBuffer>::Change> buffer_changes;
+    if( !database.library<Geometry>().changesSince( geometry_changes, updated ) ||
+        !database.library<SourceBuffer>().changesSince( buffer_changes, updated ) )
+    {
+        SCENELOG_DEBUG( log, "Change journal has overflowed, visiting all geometries." );
+        updateBoundingBoxes( database );
+    }
+    else if( !buffer_changes.empty() ) {
+        // Geometries refer to buffers by id, so we don't know which are
+        // affected. updateBoundingBox skips the ones that aren't.
+        updateBoundingBoxes( database );
+    }
+    else {
+        // The last change of an object tells if it still exists, removals
+        // have no pointer.
+        std::unordered_map<Identifiable::Id,Geometry*> last;
+        for( size_t i=0; i<geometry_changes.size(); i++ ) {
+            last[ geometry_changes[i].m_identity ] = geometry_changes[i].m_object;
+        }
+        for( auto it=last.begin(); it!=last.end(); ++it ) {
+            if( it->second != NULL ) {
+                updateBoundingBox( it->second );
+            }
+        }
+        SCENELOG_TRACE( log, "Visited " << last.size() << " changed geometries." );
+    }
+    updated.touch();
+}
+
 
 
 bool
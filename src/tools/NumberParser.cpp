@@ -0,0 +1,364 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cfloat>
+#include <vector>
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include <scene/tools/NumberParser.hpp>
+#include <scene/runtime/ThreadPool.hpp>
+
+namespace Scene {
+    namespace Tools {
+
+static inline bool
+isSpace( const char c )
+{
+    // Same set as isspace in the C locale.
+    return (c == ' ') || ( static_cast<unsigned char>( c - '\t' ) <= ('\r' - '\t') );
+}
+
+static inline bool
+isDigit( const char c )
+{
+    return static_cast<unsigned char>( c - '0' ) <= 9u;
+}
+
+static inline const char*
+skipSpace( const char* p, const char* end )
+{
+    // Numbers are usually separated by a single space or newline.
+    if( (p == end) || !isSpace( *p ) ) {
+        return p;
+    }
+    p++;
+#ifdef __SSE2__
+    // Long runs of indentation are skipped 16 bytes at a time.
+    const __m128i space = _mm_set1_epi8( ' ' );
+    const __m128i tab   = _mm_set1_epi8( '\t' );
+    const __m128i range = _mm_set1_epi8( '\r' - '\t' );
+    while( end - p >= 16 ) {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+        const __m128i t = _mm_sub_epi8( v, tab );
+        const __m128i ws = _mm_or_si128( _mm_cmpeq_epi8( v, space ),
+                                         _mm_cmpeq_epi8( _mm_min_epu8( t, range ), t ) );
+        const unsigned int mask = ~static_cast<unsigned int>( _mm_movemask_epi8( ws ) ) & 0xffffu;
+        if( mask != 0 ) {
+            return p + __builtin_ctz( mask );
+        }
+        p += 16;
+    }
+#endif
+    while( (p != end) && isSpace( *p ) ) {
+        p++;
+    }
+    return p;
+}
+
+// Copies the token at p into a zero-terminated buffer for the C library.
+static inline size_t
+copyToken( char (&buffer)[128], const char* p, const char* end )
+{
+    size_t n = 0;
+    while( (p+n != end) && (n+1 < sizeof(buffer)) && !isSpace( p[n] ) && (p[n] != '\0') ) {
+        buffer[n] = p[n];
+        n++;
+    }
+    buffer[n] = '\0';
+    return n;
+}
+
+static bool
+parseFloatFallback( float& result, const char*& p, const char* end )
+{
+    char buffer[128];
+    copyToken( buffer, p, end );
+    char* b = NULL;
+#ifdef _WIN32
+    result = static_cast<float>( strtod( buffer, &b ) );
+#else
+    result = strtof( buffer, &b );
+#endif
+    if( b == buffer ) {
+        return false;
+    }
+    p += b - buffer;
+    return true;
+}
+
+static bool
+parseIntFallback( int& result, const char*& p, const char* end )
+{
+    char buffer[128];
+    copyToken( buffer, p, end );
+    char* b = NULL;
+    result = static_cast<int>( strtol( buffer, &b, 0 ) );
+    if( b == buffer ) {
+        return false;
+    }
+    p += b - buffer;
+    return true;
+}
+
+bool
+parseFloat( float& result, const char*& p, const char* end )
+{
+    static const double pow10[23] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    p = skipSpace( p, end );
+    const char* q = p;
+    if( q == end ) {
+        return false;
+    }
+    bool negative = false;
+    if( (*q == '-') || (*q == '+') ) {
+        negative = *q == '-';
+        q++;
+    }
+
+    // Mantissa, at most 19 significant digits fit in 64 bits.
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    while( (q != end) && (*q == '0') ) {
+        q++;
+        any = true;
+    }
+    while( (q != end) && isDigit( *q ) ) {
+        if( digits == 19 ) {
+            return parseFloatFallback( result, p, end );
+        }
+        mantissa = 10u*mantissa + static_cast<unsigned int>( *q - '0' );
+        digits++;
+        any = true;
+        q++;
+    }
+    if( (q != end) && (*q == '.') ) {
+        q++;
+        if( digits == 0 ) {
+            while( (q != end) && (*q == '0') ) {
+                exponent--;
+                q++;
+                any = true;
+            }
+        }
+        while( (q != end) && isDigit( *q ) ) {
+            if( digits == 19 ) {
+                return parseFloatFallback( result, p, end );
+            }
+            mantissa = 10u*mantissa + static_cast<unsigned int>( *q - '0' );
+            digits++;
+            exponent--;
+            any = true;
+            q++;
+        }
+    }
+    if( !any ) {
+        return parseFloatFallback( result, p, end );   // inf, nan, garbage
+    }
+    if( (q != end) && ( (*q == 'e') || (*q == 'E') ) ) {
+        const char* r = q+1;
+        bool exp_negative = false;
+        if( (r != end) && ( (*r == '-') || (*r == '+') ) ) {
+            exp_negative = *r == '-';
+            r++;
+        }
+        if( (r != end) && isDigit( *r ) ) {
+            int e = 0;
+            while( (r != end) && isDigit( *r ) ) {
+                if( e < 10000 ) {
+                    e = 10*e + (*r - '0');
+                }
+                r++;
+            }
+            exponent += exp_negative ? -e : e;
+            q = r;
+        }
+    }
+    if( (q != end) && !isSpace( *q ) && (*q != '\0') ) {
+        return parseFloatFallback( result, p, end );   // e.g. hexadecimal
+    }
+
+    if( mantissa == 0 ) {
+        result = negative ? -0.f : 0.f;
+        p = q;
+        return true;
+    }
+    if( (mantissa >> 53) || (exponent < -22) || (exponent > 22) ) {
+        return parseFloatFallback( result, p, end );
+    }
+    // One correctly rounded double operation. Rounding that to float gives the
+    // correctly rounded float unless the double lies exactly on a midpoint
+    // between two floats, or the result is not a normal float.
+    const double m = static_cast<double>( mantissa );
+    const double v = exponent < 0 ? m / pow10[ -exponent ] : m * pow10[ exponent ];
+    uint64_t bits;
+    std::memcpy( &bits, &v, sizeof(bits) );
+    if( ( (bits & 0x1fffffffull) == 0x10000000ull ) || (v < FLT_MIN) || (v > FLT_MAX) ) {
+        return parseFloatFallback( result, p, end );
+    }
+    result = negative ? -static_cast<float>( v ) : static_cast<float>( v );
+    p = q;
+    return true;
+}
+
+bool
+parseInt( int& result, const char*& p, const char* end )
+{
+    p = skipSpace( p, end );
+    const char* q = p;
+    if( q == end ) {
+        return false;
+    }
+    bool negative = false;
+    if( (*q == '-') || (*q == '+') ) {
+        negative = *q == '-';
+        q++;
+    }
+    if( (q == end) || !isDigit( *q ) ) {
+        return parseIntFallback( result, p, end );
+    }
+    if( (*q == '0') && (q+1 != end) && ( isDigit( q[1] ) || (q[1] == 'x') || (q[1] == 'X') ) ) {
+        return parseIntFallback( result, p, end );   // octal or hexadecimal
+    }
+    uint64_t value = 0;
+    int digits = 0;
+    while( (q != end) && isDigit( *q ) ) {
+        value = 10u*value + static_cast<unsigned int>( *q - '0' );
+        digits++;
+        q++;
+    }
+    if( (digits > 9) || ( (q != end) && !isSpace( *q ) && (*q != '\0') ) ) {
+        return parseIntFallback( result, p, end );
+    }
+    result = negative ? -static_cast<int>( value ) : static_cast<int>( value );
+    p = q;
+    return true;
+}
+
+static size_t
+parseFloatsSerial( float* dst, const size_t count, const char* p, const char* end )
+{
+    for( size_t i=0; i<count; i++ ) {
+        if( !parseFloat( dst[i], p, end ) ) {
+            return i;
+        }
+    }
+    return count;
+}
+
+size_t
+countTokens( const char* p, const char* end )
+{
+    size_t n = 0;
+    bool space = true;
+    for( ; p != end; p++ ) {
+        const bool s = isSpace( *p );
+        n += (space && !s) ? 1 : 0;
+        space = s;
+    }
+    return n;
+}
+
+size_t
+parseFloats( float* dst, const size_t count, const char* begin, const char* end )
+{
+#ifdef SCENE_USE_THREADS
+    // Split huge arrays at whitespace, count the numbers in each part to find
+    // where it should be written, and parse the parts concurrently.
+    const size_t min_part = 1u<<20;
+    const size_t threads = std::min( Runtime::ThreadPool::hardwareThreads(),
+                                     static_cast<size_t>( end - begin ) / min_part );
+    if( threads > 1 ) {
+        std::vector<const char*> split( threads+1 );
+        split[0] = begin;
+        split[threads] = end;
+        for( size_t t=1; t<threads; t++ ) {
+            const char* s = std::max( split[t-1], begin + (t*(end-begin))/threads );
+            while( (s != end) && !isSpace( *s ) ) {
+                s++;
+            }
+            split[t] = s;
+        }
+        std::vector<size_t> tokens( threads );
+        std::vector<size_t> parsed( threads );
+        Runtime::parallelFor( threads, threads, [&]( size_t t ) {
+            tokens[t] = countTokens( split[t], split[t+1] );
+        } );
+
+        std::vector<size_t> first( threads+1, 0 );
+        for( size_t t=0; t<threads; t++ ) {
+            first[t+1] = first[t] + tokens[t];
+        }
+        auto parsePart = [&]( size_t t ) {
+            const size_t b = std::min( first[t], count );
+            const size_t e = std::min( first[t+1], count );
+            parsed[t] = parseFloatsSerial( dst + b, e - b, split[t], split[t+1] );
+        };
+        Runtime::parallelFor( threads, threads, parsePart );
+
+        size_t total = 0;
+        for( size_t t=0; t<threads; t++ ) {
+            const size_t expected = std::min( first[t+1], count ) - std::min( first[t], count );
+            if( parsed[t] != expected ) {
+                // Malformed input, let the serial parser determine where.
+                return parseFloatsSerial( dst, count, begin, end );
+            }
+            total += parsed[t];
+        }
+        return total;
+    }
+#endif
+    return parseFloatsSerial( dst, count, begin, end );
+}
+
+size_t
+parseInts( int* dst, const size_t count, const char* begin, const char* end,
+           const size_t offset, const size_t stride )
+{
+    const char* p = begin;
+    int ignored;
+    for( size_t i=0; i<offset; i++ ) {
+        if( !parseInt( ignored, p, end ) ) {
+            return 0;
+        }
+    }
+    for( size_t i=0; i<count; i++ ) {
+        if( !parseInt( dst[i], p, end ) ) {
+            return i;
+        }
+        for( size_t k=1; k<stride; k++ ) {
+            if( !parseInt( ignored, p, end ) ) {
+                return i;
+            }
+        }
+    }
+    return count;
+}
+
+    } // of namespace Tools
+} // of namespace Scene
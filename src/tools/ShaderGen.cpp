@@ -39,7 +39,7 @@ ShaderGenColor( Pass*         dst_pas,
                 const ShadingModelComponentType comp, const std::string comp_str,
                 const float R, const float G, const float B, const float A )
 {
-    Logger log = getLogger( package + ".Color" );
+    static const Logger log = getLogger( package + ".Color" );
 
     if( comp == SHADING_COMP_DIFFUSE && sm->isComponentImageReference( comp ) ) {
         std::string ref = sm->componentImageReference( comp );
@@ -90,7 +90,7 @@ generateShaderFromCommon( Effect*             effect,
                           const int   profile_mask,
                           const GenerateMode  generate_mode )
 {
-    Logger log = getLogger( package + ".generate" );
+    static const Logger log = getLogger( package + ".generate" );
 
     // sanity checks
     if( effect == NULL ) {
@@ -0,0 +1,130 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+
+namespace Scene {
+    namespace Bench {
+
+/** State of a running benchmark.
+ *
+ * The benchmark body repeats its work while keepRunning() returns true, and
+ * optionally reports how many items or bytes were processed per iteration.
+ * Per-iteration setup that shouldn't be measured, e.g. recreating the input
+ * of an operation that modifies it, goes between pauseTiming() and
+ * resumeTiming().
+ */
+class State
+{
+public:
+    State( double min_seconds );
+
+    /** Returns true as long as more iterations should be run. */
+    bool
+    keepRunning();
+
+    /** Stop the clocks until resumeTiming() is called. */
+    void
+    pauseTiming();
+
+    void
+    resumeTiming();
+
+    /** Number of items processed per iteration, used to report items/s. */
+    void
+    setItemsPerIteration( double items ) { m_items = items; }
+
+    /** Number of bytes processed per iteration, used to report MB/s. */
+    void
+    setBytesPerIteration( double bytes ) { m_bytes = bytes; }
+
+    size_t
+    iterations() const { return m_iterations; }
+
+    /** Measured wall-clock time. */
+    double
+    seconds() const { return m_seconds; }
+
+    /** Measured process CPU time, includes the time of worker threads. */
+    double
+    cpuSeconds() const { return m_cpu_seconds; }
+
+    double
+    itemsPerIteration() const { return m_items; }
+
+    double
+    bytesPerIteration() const { return m_bytes; }
+
+protected:
+    typedef std::chrono::steady_clock   Clock;
+    Clock::time_point                   m_start;
+    std::clock_t                        m_cpu_start;
+    bool                                m_paused;
+    double                              m_min_seconds;
+    double                              m_seconds;
+    double                              m_cpu_seconds;
+    size_t                              m_iterations;
+    double                              m_items;
+    double                              m_bytes;
+};
+
+typedef void (*BenchFunc)( State& state );
+
+/** Add a benchmark to the global list, used by SCENE_BENCH. */
+class Registrar
+{
+public:
+    Registrar( const std::string& name, BenchFunc func );
+};
+
+struct Entry
+{
+    std::string m_name;
+    BenchFunc   m_func;
+};
+
+/** All registered benchmarks, in registration order. */
+std::vector<Entry>&
+benchmarks();
+
+/** Prevent the optimizer from discarding a computed value. */
+template<typename T>
+inline void
+doNotOptimize( const T& value )
+{
+#ifdef __GNUC__
+    asm volatile( "" : : "g"(&value) : "memory" );
+#else
+    volatile const T* sink = &value;
+    (void)sink;
+#endif
+}
+
+    } // of namespace Bench
+} // of namespace Scene
+
+#define SCENE_BENCH(name)                                                   \
+    static void bench_##name( Scene::Bench::State& state );                 \
+    static Scene::Bench::Registrar bench_registrar_##name( #name,           \
+                                                           bench_##name );  \
+    static void bench_##name( Scene::Bench::State& state )
@@ -0,0 +1,177 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <scene/runtime/CacheLUT.hpp>
+#include "Bench.hpp"
+
+namespace {
+    using Scene::Runtime::CacheKey;
+    using Scene::Runtime::CacheLUT;
+
+// The shift/xor hash CacheKey used before the open-addressing table, kept to
+// compare against the previous std::unordered_map backend.
+template<size_t N>
+struct LegacyHash
+{
+    size_t
+    operator()( const CacheKey<N>& key ) const
+    {
+        size_t hash = reinterpret_cast<size_t>( key[0] );
+        for( size_t i=1; i<N; i++) {
+            hash ^= (hash <<13) ^ reinterpret_cast<size_t>( key[i] );
+        }
+        return hash;
+    }
+};
+
+// Mimics the keys of TransformCache: tuples of pointers into objects that are
+// allocated roughly in sequence, with a few distinct leading pointers.
+template<size_t N>
+const std::vector< CacheKey<N> >&
+keys()
+{
+    static std::vector< CacheKey<N> > keys;
+    if( keys.empty() ) {
+        static std::vector<char> objects( 20000*192 );
+        const size_t count = 20000;
+        keys.resize( count );
+        for( size_t i=0; i<count; i++ ) {
+            for( size_t k=0; k<N; k++ ) {
+                keys[i][k] = &objects[ 192*( (i + k*7919) % count ) ];
+            }
+            keys[i][0] = &objects[ 192*( i % 16 ) ];
+            if( N > 1 ) {
+                keys[i][N-1] = &objects[ 192*i ];
+            }
+        }
+    }
+    return keys;
+}
+
+// A fixed pseudo-random permutation of the keys, used for lookups.
+const std::vector<size_t>&
+lookupOrder( size_t count )
+{
+    static std::vector<size_t> order;
+    if( order.size() != count ) {
+        order.resize( count );
+        for( size_t i=0; i<count; i++ ) {
+            order[i] = i;
+        }
+        size_t state = 12345;
+        for( size_t i=count-1; i>0; i-- ) {
+            state = state*6364136223846793005ull + 1442695040888963407ull;
+            std::swap( order[i], order[ (state>>33) % (i+1) ] );
+        }
+    }
+    return order;
+}
+
+// Rebuild mirrors TransformCache after a purge: look up, insert if missing.
+template<typename Map, size_t N>
+void
+rebuildMap( Scene::Bench::State& state )
+{
+    const std::vector< CacheKey<N> >& k = keys<N>();
+    Map map;
+    while( state.keepRunning() ) {
+        map.clear();
+        for( size_t i=0; i<k.size(); i++ ) {
+            if( map.find( k[i] ) == map.end() ) {
+                map[ k[i] ] = i;
+            }
+        }
+        Scene::Bench::doNotOptimize( map );
+    }
+    state.setItemsPerIteration( k.size() );
+}
+
+template<size_t N>
+void
+rebuildLUT( Scene::Bench::State& state )
+{
+    const std::vector< CacheKey<N> >& k = keys<N>();
+    CacheLUT<N> lut;
+    while( state.keepRunning() ) {
+        lut.clear();
+        for( size_t i=0; i<k.size(); i++ ) {
+            if( lut.find( k[i] ) == CacheLUT<N>::none() ) {
+                lut.insert( k[i], i );
+            }
+        }
+        Scene::Bench::doNotOptimize( lut );
+    }
+    state.setItemsPerIteration( k.size() );
+}
+
+template<typename Map, size_t N>
+void
+findMap( Scene::Bench::State& state )
+{
+    const std::vector< CacheKey<N> >& k = keys<N>();
+    const std::vector<size_t>& order = lookupOrder( k.size() );
+    Map map;
+    for( size_t i=0; i<k.size(); i++ ) {
+        map[ k[i] ] = i;
+    }
+    while( state.keepRunning() ) {
+        size_t sum = 0;
+        for( size_t i=0; i<k.size(); i++ ) {
+            sum += map.find( k[ order[i] ] )->second;
+        }
+        Scene::Bench::doNotOptimize( sum );
+    }
+    state.setItemsPerIteration( k.size() );
+}
+
+template<size_t N>
+void
+findLUT( Scene::Bench::State& state )
+{
+    const std::vector< CacheKey<N> >& k = keys<N>();
+    const std::vector<size_t>& order = lookupOrder( k.size() );
+    CacheLUT<N> lut;
+    for( size_t i=0; i<k.size(); i++ ) {
+        lut.insert( k[i], i );
+    }
+    while( state.keepRunning() ) {
+        size_t sum = 0;
+        for( size_t i=0; i<k.size(); i++ ) {
+            sum += lut.find( k[ order[i] ] );
+        }
+        Scene::Bench::doNotOptimize( sum );
+    }
+    state.setItemsPerIteration( k.size() );
+}
+
+typedef std::unordered_map< CacheKey<2>, size_t, LegacyHash<2> >                          LegacyMap2;
+typedef std::unordered_map< CacheKey<SCENE_PATH_MAX>, size_t, LegacyHash<SCENE_PATH_MAX> > LegacyMapPath;
+
+} // of anonymous namespace
+
+SCENE_BENCH( CacheLUT2_Rebuild_UnorderedMap )      { rebuildMap<LegacyMap2, 2>( state ); }
+SCENE_BENCH( CacheLUT2_Rebuild_OpenAddressing )    { rebuildLUT<2>( state ); }
+SCENE_BENCH( CacheLUT2_Find_UnorderedMap )         { findMap<LegacyMap2, 2>( state ); }
+SCENE_BENCH( CacheLUT2_Find_OpenAddressing )       { findLUT<2>( state ); }
+SCENE_BENCH( CacheLUTPath_Rebuild_UnorderedMap )   { rebuildMap<LegacyMapPath, SCENE_PATH_MAX>( state ); }
+SCENE_BENCH( CacheLUTPath_Rebuild_OpenAddressing ) { rebuildLUT<SCENE_PATH_MAX>( state ); }
+SCENE_BENCH( CacheLUTPath_Find_UnorderedMap )      { findMap<LegacyMapPath, SCENE_PATH_MAX>( state ); }
+SCENE_BENCH( CacheLUTPath_Find_OpenAddressing )    { findLUT<SCENE_PATH_MAX>( state ); }
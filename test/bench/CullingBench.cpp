@@ -0,0 +1,200 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <vector>
+#include <scene/DataBase.hpp>
+#include <scene/Geometry.hpp>
+#include <scene/Value.hpp>
+#include <scene/runtime/BoundingVolumeHierarchy.hpp>
+#include <scene/runtime/OcclusionCuller.hpp>
+#include <scene/runtime/TransformCompute.hpp>
+#include "Bench.hpp"
+#include "SceneGenerator.hpp"
+
+namespace {
+
+// A 100x100 grid of unit boxes, viewed by a panning orthographic camera
+// that sees about 1% of them.
+class CullingScene
+{
+public:
+    static const size_t m_grid = 100;
+
+    Scene::Value                m_clip;
+    Scene::Value                m_bbox_min;
+    Scene::Value                m_bbox_max;
+    std::vector<Scene::Value>   m_transforms;
+
+    CullingScene()
+        : m_bbox_min( Scene::Value::createFloat4( 0.f, 0.f, 0.f, 1.f ) ),
+          m_bbox_max( Scene::Value::createFloat4( 1.f, 1.f, 1.f, 1.f ) ),
+          m_frame( 0 )
+    {
+        m_transforms.reserve( m_grid*m_grid );
+        for( size_t i=0; i<m_grid*m_grid; i++ ) {
+            m_transforms.push_back( translation( 2.f*(i%m_grid), 2.f*(i/m_grid) ) );
+        }
+        pan();
+    }
+
+    static Scene::Value
+    translation( float x, float y )
+    {
+        return Scene::Value::createFloat4x4( 1.f, 0.f, 0.f, x,
+                                             0.f, 1.f, 0.f, y,
+                                             0.f, 0.f, 1.f, 0.f,
+                                             0.f, 0.f, 0.f, 1.f );
+    }
+
+    /** Move the camera, invalidating the culling results. */
+    void
+    pan()
+    {
+        const float x = 50.f + float( m_frame++ % 16 );
+        m_clip = Scene::Value::createFloat4x4( 0.1f, 0.f,  0.f,  -0.1f*x,
+                                               0.f,  0.1f, 0.f,  -0.1f*x,
+                                               0.f,  0.f,  -0.1f, 0.f,
+                                               0.f,  0.f,  0.f,  1.f );
+    }
+
+    /** Move one in a hundred items. */
+    void
+    move()
+    {
+        for( size_t i=m_frame%100; i<m_transforms.size(); i+=100 ) {
+            m_transforms[i] = translation( 2.f*(i%m_grid) + 0.01f*(m_frame%8), 2.f*(i/m_grid) );
+        }
+    }
+
+protected:
+    size_t  m_frame;
+};
+
+void
+cullHierarchy( Scene::Bench::State& state, bool move )
+{
+    CullingScene scene;
+    Scene::Runtime::BoundingVolumeHierarchy bvh;
+    for( size_t i=0; i<scene.m_transforms.size(); i++ ) {
+        bvh.add( &scene.m_clip, &scene.m_transforms[i], &scene.m_bbox_min, &scene.m_bbox_max );
+    }
+    bvh.update();
+    while( state.keepRunning() ) {
+        scene.pan();
+        if( move ) {
+            scene.move();
+        }
+        bvh.update();
+        Scene::Bench::doNotOptimize( bvh.visibleItems() );
+    }
+    state.setItemsPerIteration( scene.m_transforms.size() );
+}
+
+void
+cullOcclusion( Scene::Bench::State& state, size_t threads )
+{
+    // Four large walls in front of a 100x100 grid of small tiles, viewed by
+    // a perspective camera, most of the tiles are hidden by the walls.
+    Scene::DataBase db;
+    Scene::Geometry* mesh = Scene::Bench::syntheticMesh( db, "mesh", 16 );
+    mesh->flatten();
+    mesh->setBoundingBox( Scene::Value::createFloat4( 0.f, 0.f, 0.f, 1.f ),
+                          Scene::Value::createFloat4( 16.f, 16.f, 0.1f, 1.f ) );
+    const Scene::Value* bbox_min = NULL;
+    const Scene::Value* bbox_max = NULL;
+    mesh->boundingBox( bbox_min, bbox_max );
+
+    std::vector<Scene::Value> transforms;
+    transforms.reserve( 4 + 100*100 );
+    for( size_t i=0; i<4; i++ ) {
+        const float s = 10.f/16.f;
+        transforms.push_back( Scene::Value::createFloat4x4( s,   0.f, 0.f, 10.f*(i%2) - 10.f,
+                                                            0.f, s,   0.f, 10.f*(i/2) - 10.f,
+                                                            0.f, 0.f, s,   -10.f,
+                                                            0.f, 0.f, 0.f, 1.f ) );
+    }
+    for( size_t i=0; i<100*100; i++ ) {
+        const float s = 0.2f/16.f;
+        transforms.push_back( Scene::Value::createFloat4x4( s,   0.f, 0.f, 0.5f*(i%100) - 25.f,
+                                                            0.f, s,   0.f, 0.5f*(i/100) - 25.f,
+                                                            0.f, 0.f, s,   -30.f,
+                                                            0.f, 0.f, 0.f, 1.f ) );
+    }
+
+    Scene::Value clip;
+    Scene::Runtime::BoundingVolumeHierarchy bvh;
+    Scene::Runtime::OcclusionCuller culler( db );
+    culler.setThreads( threads );
+    for( size_t i=0; i<transforms.size(); i++ ) {
+        bvh.add( &clip, &transforms[i], bbox_min, bbox_max );
+        culler.add( &clip, &transforms[i], mesh, mesh->primitives( 0 ) );
+    }
+
+    const float f = 1.f/std::tan( 0.5f );
+    size_t frame = 0;
+    while( state.keepRunning() ) {
+        const float x = 0.1f*float( frame++ % 16 );
+        clip = Scene::Value::createFloat4x4( 0.5f*f, 0.f, 0.f,             -0.5f*f*x,
+                                             0.f,    f,   0.f,             0.f,
+                                             0.f,    0.f, -100.1f/99.9f,   -20.f/99.9f,
+                                             0.f,    0.f, -1.f,            0.f );
+        bvh.update();
+        culler.update( &bvh );
+        Scene::Bench::doNotOptimize( culler.visibleItems() );
+    }
+    state.setItemsPerIteration( transforms.size() );
+}
+
+} // of anonymous namespace
+
+// What TransformCache does per frame with one checkBoundingBox per item.
+SCENE_BENCH( Culling_PerItem )
+{
+    CullingScene scene;
+    std::vector<Scene::Value> results( scene.m_transforms.size(), Scene::Value::createBool( GL_TRUE ) );
+    while( state.keepRunning() ) {
+        scene.pan();
+        for( size_t i=0; i<scene.m_transforms.size(); i++ ) {
+            const Scene::Value* sources[4] = { &scene.m_bbox_min, &scene.m_bbox_max, &scene.m_clip, &scene.m_transforms[i] };
+            Scene::Runtime::TransformCompute::boundingBoxTest( &results[i], 4, sources );
+        }
+        Scene::Bench::doNotOptimize( results[0] );
+    }
+    state.setItemsPerIteration( scene.m_transforms.size() );
+}
+
+SCENE_BENCH( Culling_Hierarchy )
+{
+    cullHierarchy( state, false );
+}
+
+SCENE_BENCH( Culling_Hierarchy_Moving )
+{
+    cullHierarchy( state, true );
+}
+
+SCENE_BENCH( Culling_Occlusion )
+{
+    cullOcclusion( state, 1 );
+}
+
+SCENE_BENCH( Culling_Occlusion_Threaded )
+{
+    cullOcclusion( state, 4 );
+}
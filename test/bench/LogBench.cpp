@@ -0,0 +1,74 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <scene/Log.hpp>
+#include "Bench.hpp"
+
+// A hot function with a disabled debug statement, with the logger looked up
+// per call as most of the code base did, and once per site.
+
+static const std::string package = "Scene.Bench.Log";
+
+#ifdef __GNUC__
+#define SCENE_BENCH_NOINLINE __attribute__((noinline))
+#else
+#define SCENE_BENCH_NOINLINE
+#endif
+
+static SCENE_BENCH_NOINLINE int
+perCallLookup( int value )
+{
+    Scene::Logger log = Scene::getLogger( package + ".perCallLookup" );
+    SCENELOG_TRACE( log, "value=" << value );
+    return value + 1;
+}
+
+static SCENE_BENCH_NOINLINE int
+cachedLookup( int value )
+{
+    static const Scene::Logger log = Scene::getLogger( package + ".cachedLookup" );
+    SCENELOG_TRACE( log, "value=" << value );
+    return value + 1;
+}
+
+SCENE_BENCH( Log_Disabled_PerCallLogger )
+{
+    const int N = 10000;
+    while( state.keepRunning() ) {
+        int sum = 0;
+        for( int i=0; i<N; i++ ) {
+            sum = perCallLookup( sum );
+        }
+        Scene::Bench::doNotOptimize( sum );
+    }
+    state.setItemsPerIteration( N );
+}
+
+SCENE_BENCH( Log_Disabled_CachedLogger )
+{
+    const int N = 10000;
+    while( state.keepRunning() ) {
+        int sum = 0;
+        for( int i=0; i<N; i++ ) {
+            sum = cachedLookup( sum );
+        }
+        Scene::Bench::doNotOptimize( sum );
+    }
+    state.setItemsPerIteration( N );
+}
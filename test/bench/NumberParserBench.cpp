@@ -0,0 +1,134 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <scene/tools/NumberParser.hpp>
+#include "Bench.hpp"
+
+namespace {
+
+// About 8MB of vertex data, formatted as a typical exporter does.
+const std::string&
+floatText()
+{
+    static std::string text;
+    if( text.empty() ) {
+        char buffer[64];
+        unsigned int state = 1;
+        for( size_t i=0; i<1000000; i++ ) {
+            state = 1664525u*state + 1013904223u;
+            snprintf( buffer, sizeof(buffer), (i%3)==2 ? "%.6f\n" : "%.6f ",
+                      (static_cast<float>( state>>8 ) / (1<<24) - 0.5f)*200.f );
+            text += buffer;
+        }
+    }
+    return text;
+}
+
+// About 4MB of triangle indices.
+const std::string&
+intText()
+{
+    static std::string text;
+    if( text.empty() ) {
+        char buffer[32];
+        unsigned int state = 1;
+        for( size_t i=0; i<600000; i++ ) {
+            state = 1664525u*state + 1013904223u;
+            snprintf( buffer, sizeof(buffer), "%u ", state % 100000u );
+            text += buffer;
+        }
+    }
+    return text;
+}
+
+size_t
+countNumbers( const std::string& text )
+{
+    size_t n = 0;
+    bool space = true;
+    for( size_t i=0; i<text.size(); i++ ) {
+        bool s = isspace( text[i] ) != 0;
+        n += (space && !s) ? 1 : 0;
+        space = s;
+    }
+    return n;
+}
+
+} // of anonymous namespace
+
+SCENE_BENCH( ParseFloats_strtof )
+{
+    const std::string& text = floatText();
+    std::vector<float> result( countNumbers( text ) );
+    while( state.keepRunning() ) {
+        const char* a = text.c_str();
+        for( size_t i=0; i<result.size(); i++ ) {
+            char* b = NULL;
+            result[i] = strtof( a, &b );
+            a = b;
+        }
+        Scene::Bench::doNotOptimize( result );
+    }
+    state.setBytesPerIteration( text.size() );
+    state.setItemsPerIteration( result.size() );
+}
+
+SCENE_BENCH( ParseFloats_NumberParser )
+{
+    const std::string& text = floatText();
+    std::vector<float> result( countNumbers( text ) );
+    while( state.keepRunning() ) {
+        Scene::Tools::parseFloats( result.data(), result.size(), text.c_str(), text.c_str() + text.size() );
+        Scene::Bench::doNotOptimize( result );
+    }
+    state.setBytesPerIteration( text.size() );
+    state.setItemsPerIteration( result.size() );
+}
+
+SCENE_BENCH( ParseInts_strtol )
+{
+    const std::string& text = intText();
+    std::vector<int> result( countNumbers( text ) );
+    while( state.keepRunning() ) {
+        const char* a = text.c_str();
+        for( size_t i=0; i<result.size(); i++ ) {
+            char* b = NULL;
+            result[i] = strtol( a, &b, 0 );
+            a = b;
+        }
+        Scene::Bench::doNotOptimize( result );
+    }
+    state.setBytesPerIteration( text.size() );
+    state.setItemsPerIteration( result.size() );
+}
+
+SCENE_BENCH( ParseInts_NumberParser )
+{
+    const std::string& text = intText();
+    std::vector<int> result( countNumbers( text ) );
+    while( state.keepRunning() ) {
+        Scene::Tools::parseInts( result.data(), result.size(), text.c_str(), text.c_str() + text.size() );
+        Scene::Bench::doNotOptimize( result );
+    }
+    state.setBytesPerIteration( text.size() );
+    state.setItemsPerIteration( result.size() );
+}
@@ -0,0 +1,137 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <scene/DataBase.hpp>
+#include <scene/Pass.hpp>
+#include <scene/Primitives.hpp>
+#include <scene/runtime/Resolver.hpp>
+#include <scene/runtime/RenderList.hpp>
+#include "Bench.hpp"
+#include "SceneGenerator.hpp"
+
+namespace {
+    using Scene::Runtime::CacheKey;
+    using Scene::Bench::syntheticDataBase;
+
+class BenchRenderList : public Scene::Runtime::RenderList
+{
+public:
+    BenchRenderList( Scene::Runtime::Resolver& resolver )
+        : RenderList( resolver )
+    {}
+
+    using RenderList::rebuild;
+};
+
+// The (pass, primitives) pairs the resolver looks up per render item.
+void
+itemPairs( std::vector<const Scene::Pass*>&        passes,
+           std::vector<const Scene::Primitives*>&  primitives )
+{
+    Scene::Runtime::Resolver resolver( syntheticDataBase(), Scene::PROFILE_GLSL );
+    BenchRenderList list( resolver );
+    list.rebuild();
+    for( size_t i=0; i<list.items(); i++ ) {
+        passes.push_back( list.item(i).m_set_pass->m_pass );
+        primitives.push_back( list.item(i).m_set_inputs->m_primitives );
+    }
+}
+
+} // of anonymous namespace
+
+SCENE_BENCH( RenderList_Rebuild )
+{
+    Scene::Runtime::Resolver resolver( syntheticDataBase(), Scene::PROFILE_GLSL );
+    BenchRenderList list( resolver );
+    list.rebuild();     // populate the resolver caches
+    while( state.keepRunning() ) {
+        list.rebuild();
+        Scene::Bench::doNotOptimize( list );
+    }
+    state.setItemsPerIteration( list.items() );
+}
+
+// Traversal on the calling thread only.
+SCENE_BENCH( RenderList_Rebuild_Serial )
+{
+    Scene::Runtime::Resolver resolver( syntheticDataBase(), Scene::PROFILE_GLSL );
+    BenchRenderList list( resolver );
+    list.setThreads( 1 );
+    list.rebuild();
+    while( state.keepRunning() ) {
+        list.rebuild();
+        Scene::Bench::doNotOptimize( list );
+    }
+    state.setItemsPerIteration( list.items() );
+}
+
+// Same through the public interface, on a scene 6 levels deep.
+SCENE_BENCH( RenderList_Build_Deep )
+{
+    Scene::Runtime::Resolver resolver( syntheticDataBase( true ), Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList list( resolver );
+    list.build( "scene" );
+    while( state.keepRunning() ) {
+        list.clear();
+        list.build( "scene" );
+        Scene::Bench::doNotOptimize( list );
+    }
+    state.setItemsPerIteration( list.items() );
+}
+
+// The string keys the resolver used before, versus pointer keys.
+SCENE_BENCH( Resolver_Lookup_StringKey )
+{
+    std::vector<const Scene::Pass*> passes;
+    std::vector<const Scene::Primitives*> primitives;
+    itemPairs( passes, primitives );
+    std::unordered_map<std::string,size_t> map;
+    for( size_t i=0; i<passes.size(); i++ ) {
+        map[ passes[i]->key() + "@" + primitives[i]->key() ] = i;
+    }
+    while( state.keepRunning() ) {
+        size_t sum = 0;
+        for( size_t i=0; i<passes.size(); i++ ) {
+            sum += map.find( passes[i]->key() + "@" + primitives[i]->key() )->second;
+        }
+        Scene::Bench::doNotOptimize( sum );
+    }
+    state.setItemsPerIteration( passes.size() );
+}
+
+SCENE_BENCH( Resolver_Lookup_CacheKey )
+{
+    std::vector<const Scene::Pass*> passes;
+    std::vector<const Scene::Primitives*> primitives;
+    itemPairs( passes, primitives );
+    std::unordered_map<CacheKey<2>,size_t> map;
+    for( size_t i=0; i<passes.size(); i++ ) {
+        map[ CacheKey<2>( passes[i], primitives[i] ) ] = i;
+    }
+    while( state.keepRunning() ) {
+        size_t sum = 0;
+        for( size_t i=0; i<passes.size(); i++ ) {
+            sum += map.find( CacheKey<2>( passes[i], primitives[i] ) )->second;
+        }
+        Scene::Bench::doNotOptimize( sum );
+    }
+    state.setItemsPerIteration( passes.size() );
+}
@@ -0,0 +1,218 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <libxml/tree.h>
+#include <scene/DataBase.hpp>
+#include <scene/Geometry.hpp>
+#include <scene/Node.hpp>
+#include <scene/collada/Importer.hpp>
+#include <scene/collada/Exporter.hpp>
+#include <scene/runtime/TransformCache.hpp>
+#include <scene/tools/BBoxTool.hpp>
+#include "Bench.hpp"
+#include "SceneGenerator.hpp"
+
+namespace {
+    using Scene::Bench::SceneParameters;
+    using Scene::Bench::syntheticCollada;
+    using Scene::Bench::syntheticDataBase;
+
+// Geometries large enough for per-vertex work to dominate.
+SceneParameters
+meshParameters( bool normals )
+{
+    SceneParameters p;
+    p.m_nodes = 16;
+    p.m_geometries = 16;
+    p.m_materials = 4;
+    p.m_triangles = 2000;
+    p.m_normals = normals;
+    return p;
+}
+
+void
+flattenAll( Scene::DataBase& db )
+{
+    Scene::Library<Scene::Geometry>& geometries = db.library<Scene::Geometry>();
+    for( size_t i=0; i<geometries.size(); i++ ) {
+        Scene::Geometry* g = geometries.get( i );
+        if( g->hasSharedInputs() ) {
+            g->flatten();
+        }
+    }
+}
+
+// A 1000x1000 grid, i.e. two million triangles and six million index tuples.
+void
+flattenMesh( Scene::Bench::State& state, size_t sets )
+{
+    const size_t grid = 1000;
+    while( state.keepRunning() ) {
+        state.pauseTiming();
+        Scene::DataBase* db = new Scene::DataBase;
+        Scene::Geometry* g = Scene::Bench::syntheticMesh( *db, "mesh", grid, sets );
+        state.resumeTiming();
+
+        g->flatten();
+
+        state.pauseTiming();
+        delete db;
+        state.resumeTiming();
+    }
+    state.setItemsPerIteration( 2*grid*grid );
+}
+
+void
+populate( Scene::Runtime::TransformCache&         cache,
+          const std::vector<const Scene::Node*>&  roots,
+          const std::vector<const Scene::Node*>&  leaves )
+{
+    cache.purge();
+    for( size_t i=0; i<leaves.size(); i++ ) {
+        const Scene::Node* path[ SCENE_PATH_MAX ] = { roots[i], leaves[i], NULL };
+        cache.pathTransformMatrix( path );
+        cache.pathTransformInverseMatrix( path );
+    }
+}
+
+// Purge and update mirrors a render list rebuild, update alone a frame.
+void
+transformCacheUpdate( Scene::Bench::State& state, bool threaded, bool purge )
+{
+    const Scene::DataBase& db = syntheticDataBase( true );
+    std::vector<const Scene::Node*> roots;
+    std::vector<const Scene::Node*> leaves;
+    Scene::Bench::geometryNodes( roots, leaves, db );
+
+    Scene::Runtime::TransformCache cache( db, threaded );
+    if( !threaded ) {
+        cache.setWorkerThreads( 0 );
+    }
+    populate( cache, roots, leaves );
+    cache.update( 640, 480 );
+    while( state.keepRunning() ) {
+        if( purge ) {
+            populate( cache, roots, leaves );
+        }
+        cache.update( 640, 480 );
+    }
+    state.setItemsPerIteration( 2*leaves.size() );
+}
+
+} // of anonymous namespace
+
+SCENE_BENCH( Collada_Import )
+{
+    const std::string doc = syntheticCollada( SceneParameters() );
+    while( state.keepRunning() ) {
+        Scene::DataBase db;
+        Scene::Collada::Importer importer( db );
+        importer.parseMemory( doc.c_str() );
+        Scene::Bench::doNotOptimize( db );
+    }
+    state.setBytesPerIteration( doc.size() );
+}
+
+SCENE_BENCH( Collada_Export )
+{
+    const Scene::DataBase& db = syntheticDataBase();
+    size_t bytes = 0;
+    while( state.keepRunning() ) {
+        Scene::Collada::Exporter exporter( db );
+        xmlDocPtr doc = xmlNewDoc( BAD_CAST "1.0" );
+        xmlDocSetRootElement( doc, exporter.create() );
+        xmlChar* buffer = NULL;
+        int size = 0;
+        xmlDocDumpMemory( doc, &buffer, &size );
+        bytes = size;
+        xmlFree( buffer );
+        xmlFreeDoc( doc );
+    }
+    state.setBytesPerIteration( bytes );
+}
+
+SCENE_BENCH( Geometry_Flatten )
+{
+    const SceneParameters p = meshParameters( true );
+    const std::string doc = syntheticCollada( p );
+    while( state.keepRunning() ) {
+        state.pauseTiming();
+        Scene::DataBase* db = new Scene::DataBase;
+        Scene::Collada::Importer importer( *db );
+        importer.parseMemory( doc.c_str() );
+        state.resumeTiming();
+
+        flattenAll( *db );
+
+        state.pauseTiming();
+        delete db;
+        state.resumeTiming();
+    }
+    state.setItemsPerIteration( p.m_geometries * p.m_triangles );
+}
+
+SCENE_BENCH( Geometry_Flatten_Mesh )
+{
+    flattenMesh( state, 1 );
+}
+
+SCENE_BENCH( Geometry_Flatten_Mesh_Sets )
+{
+    flattenMesh( state, 16 );
+}
+
+SCENE_BENCH( Tools_UpdateBoundingBoxes )
+{
+    const SceneParameters p = meshParameters( false );
+    const std::string doc = syntheticCollada( p );
+    while( state.keepRunning() ) {
+        state.pauseTiming();
+        Scene::DataBase* db = new Scene::DataBase;
+        Scene::Collada::Importer importer( *db );
+        importer.parseMemory( doc.c_str() );
+        state.resumeTiming();
+
+        Scene::Tools::updateBoundingBoxes( *db );
+
+        state.pauseTiming();
+        delete db;
+        state.resumeTiming();
+    }
+    state.setItemsPerIteration( p.m_geometries * 3 * p.m_triangles );
+}
+
+SCENE_BENCH( TransformCache_PurgeUpdate_Serial )
+{
+    transformCacheUpdate( state, false, true );
+}
+
+SCENE_BENCH( TransformCache_PurgeUpdate_Threaded )
+{
+    transformCacheUpdate( state, true, true );
+}
+
+SCENE_BENCH( TransformCache_Update_Serial )
+{
+    transformCacheUpdate( state, false, false );
+}
+
+SCENE_BENCH( TransformCache_Update_Threaded )
+{
+    transformCacheUpdate( state, true, false );
+}
@@ -0,0 +1,329 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <algorithm>
+#include <scene/DataBase.hpp>
+#include <scene/Node.hpp>
+#include <scene/Geometry.hpp>
+#include <scene/Primitives.hpp>
+#include <scene/SourceBuffer.hpp>
+#include <scene/VisualScene.hpp>
+#include <scene/collada/Importer.hpp>
+#include "SceneGenerator.hpp"
+
+namespace Scene {
+    namespace Bench {
+
+namespace {
+
+void
+appendGeometry( std::string& doc, size_t g, const SceneParameters& p )
+{
+    // A zig-zag strip of p.m_triangles triangles. With normals, the triangles
+    // index the strip vertices and one normal per triangle, otherwise the
+    // corners are listed per triangle and drawn without indices.
+    const size_t vertices = p.m_normals ? p.m_triangles + 2 : 3*p.m_triangles;
+    char buffer[512];
+    snprintf( buffer, sizeof(buffer),
+              "    <geometry id=\"geo%u\"><mesh>\n"
+              "      <source id=\"pos%u\"><float_array id=\"pos%u_array\" count=\"%u\">",
+              unsigned(g), unsigned(g), unsigned(g), unsigned( 3*vertices ) );
+    doc += buffer;
+    for( size_t v=0; v<vertices; v++ ) {
+        const size_t s = p.m_normals ? v : (v/3) + (v%3);
+        snprintf( buffer, sizeof(buffer), "%s%u %u 0", v==0 ? "" : " ", unsigned( s/2 ), unsigned( s%2 ) );
+        doc += buffer;
+    }
+    snprintf( buffer, sizeof(buffer),
+              "</float_array>\n"
+              "        <technique_common><accessor source=\"#pos%u_array\" count=\"%u\" stride=\"3\">\n"
+              "          <param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/><param name=\"Z\" type=\"float\"/>\n"
+              "        </accessor></technique_common></source>\n",
+              unsigned(g), unsigned( vertices ) );
+    doc += buffer;
+    if( p.m_normals ) {
+        snprintf( buffer, sizeof(buffer),
+                  "      <source id=\"nrm%u\"><float_array id=\"nrm%u_array\" count=\"%u\">",
+                  unsigned(g), unsigned(g), unsigned( 3*p.m_triangles ) );
+        doc += buffer;
+        for( size_t t=0; t<p.m_triangles; t++ ) {
+            doc += (t==0) ? "" : " ";
+            doc += (t%2 == 0) ? "0 0 1" : "0 0 -1";
+        }
+        snprintf( buffer, sizeof(buffer),
+                  "</float_array>\n"
+                  "        <technique_common><accessor source=\"#nrm%u_array\" count=\"%u\" stride=\"3\">\n"
+                  "          <param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/><param name=\"Z\" type=\"float\"/>\n"
+                  "        </accessor></technique_common></source>\n",
+                  unsigned(g), unsigned( p.m_triangles ) );
+        doc += buffer;
+    }
+    snprintf( buffer, sizeof(buffer),
+              "      <vertices id=\"geo%u_vertices\"><input semantic=\"POSITION\" source=\"#pos%u\"/></vertices>\n",
+              unsigned(g), unsigned(g) );
+    doc += buffer;
+    if( !p.m_normals ) {
+        snprintf( buffer, sizeof(buffer),
+                  "      <triangles count=\"%u\" material=\"default\"/>\n"
+                  "    </mesh></geometry>\n",
+                  unsigned( p.m_triangles ) );
+        doc += buffer;
+        return;
+    }
+    snprintf( buffer, sizeof(buffer),
+              "      <triangles count=\"%u\" material=\"default\">\n"
+              "        <input semantic=\"VERTEX\" source=\"#geo%u_vertices\" offset=\"0\"/>\n"
+              "        <input semantic=\"NORMAL\" source=\"#nrm%u\" offset=\"1\"/>\n"
+              "        <p>",
+              unsigned( p.m_triangles ), unsigned(g), unsigned(g) );
+    doc += buffer;
+    for( size_t t=0; t<p.m_triangles; t++ ) {
+        for( size_t k=0; k<3; k++ ) {
+            snprintf( buffer, sizeof(buffer), "%s%u %u", (t+k)==0 ? "" : " ", unsigned( t+k ), unsigned( t ) );
+            doc += buffer;
+        }
+    }
+    doc += "</p>\n"
+           "      </triangles>\n"
+           "    </mesh></geometry>\n";
+}
+
+// Emits the children of a node at a given level, depth first, until all
+// nodes are emitted.
+void
+appendNodes( std::string& doc, size_t& emitted, size_t level, size_t fanout, const SceneParameters& p )
+{
+    char buffer[512];
+    const std::string indent( 2*level + 6, ' ' );
+    for( size_t c=0; (c<fanout) && (emitted < p.m_nodes); c++ ) {
+        const size_t n = emitted++;
+        snprintf( buffer, sizeof(buffer),
+                  "<node><translate>%u %u 0</translate>"
+                  "<instance_geometry url=\"#geo%u\"><bind_material><technique_common>"
+                  "<instance_material symbol=\"default\" target=\"#mat%u\"/>"
+                  "</technique_common></bind_material></instance_geometry>",
+                  unsigned( c ), unsigned( level ),
+                  unsigned( n % p.m_geometries ), unsigned( (n/p.m_geometries) % p.m_materials ) );
+        doc += indent;
+        doc += buffer;
+        if( level < p.m_depth ) {
+            doc += "\n";
+            appendNodes( doc, emitted, level+1, fanout, p );
+            doc += indent;
+        }
+        doc += "</node>\n";
+    }
+}
+
+void
+collectGeometryNodes( std::vector<const Node*>&  roots,
+                      std::vector<const Node*>&  leaves,
+                      const Node*                root,
+                      const Node*                node )
+{
+    if( node->geometryInstances() > 0 ) {
+        roots.push_back( root );
+        leaves.push_back( node );
+    }
+    for( size_t i=0; i<node->children(); i++ ) {
+        collectGeometryNodes( roots, leaves, root, node->child( i ) );
+    }
+}
+
+} // of anonymous namespace
+
+SceneParameters::SceneParameters()
+    : m_nodes( 10000 ),
+      m_depth( 1 ),
+      m_materials( 64 ),
+      m_geometries( 64 ),
+      m_triangles( 1 ),
+      m_normals( false )
+{
+}
+
+std::string
+syntheticCollada( const SceneParameters& p )
+{
+    std::string doc =
+            "<?xml version=\"1.0\"?>\n"
+            "<COLLADA>\n"
+            "  <library_geometries>\n";
+    for( size_t g=0; g<p.m_geometries; g++ ) {
+        appendGeometry( doc, g, p );
+    }
+    doc +=
+            "  </library_geometries>\n"
+            "  <library_effects>\n"
+            "    <effect id=\"effect\">\n"
+            "      <newparam sid=\"mvp\"><semantic>MODELVIEW_PROJECTION_MATRIX</semantic><float4x4>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</float4x4></newparam>\n"
+            "      <newparam sid=\"color\"><float3>1 1 1</float3></newparam>\n"
+            "      <profile_GLSL><technique sid=\"default\"><pass>\n"
+            "        <states><depth_test_enable value=\"TRUE\"/></states>\n"
+            "        <program>\n"
+            "          <shader stage=\"VERTEX\"><sources><inline>uniform mat4 MVP; attribute vec3 position; void main() { gl_Position = MVP*vec4(position,1.0); }</inline></sources></shader>\n"
+            "          <shader stage=\"FRAGMENT\"><sources><inline>uniform vec3 color; void main() { gl_FragColor = vec4(color,1.0); }</inline></sources></shader>\n"
+            "          <bind_attribute symbol=\"position\"><semantic>POSITION</semantic></bind_attribute>\n"
+            "          <bind_uniform symbol=\"MVP\"><param ref=\"mvp\"/></bind_uniform>\n"
+            "          <bind_uniform symbol=\"color\"><param ref=\"color\"/></bind_uniform>\n"
+            "        </program>\n"
+            "      </pass></technique></profile_GLSL>\n"
+            "    </effect>\n"
+            "  </library_effects>\n"
+            "  <library_materials>\n";
+    char buffer[512];
+    for( size_t m=0; m<p.m_materials; m++ ) {
+        snprintf( buffer, sizeof(buffer),
+                  "    <material id=\"mat%u\"><instance_effect url=\"#effect\">"
+                  "<setparam ref=\"color\"><float3>%f 0.5 0.5</float3></setparam>"
+                  "</instance_effect></material>\n",
+                  unsigned(m), static_cast<double>( m ) / p.m_materials );
+        doc += buffer;
+    }
+    doc +=
+            "  </library_materials>\n"
+            "  <library_visual_scenes>\n"
+            "    <visual_scene id=\"scene\">\n"
+            "      <node id=\"root\">\n";
+
+    // Smallest fan-out that fits all nodes within the depth.
+    const size_t depth = std::max( size_t(1), p.m_depth );
+    size_t fanout = 1;
+    while( fanout < p.m_nodes ) {
+        size_t capacity = 0;
+        size_t level_size = 1;
+        for( size_t l=0; (l<depth) && (capacity < p.m_nodes); l++ ) {
+            level_size *= fanout;
+            capacity += level_size;
+        }
+        if( capacity >= p.m_nodes ) {
+            break;
+        }
+        fanout++;
+    }
+    size_t emitted = 0;
+    appendNodes( doc, emitted, 1, fanout, p );
+
+    doc +=
+            "      </node>\n"
+            "      <evaluate_scene><render/></evaluate_scene>\n"
+            "    </visual_scene>\n"
+            "  </library_visual_scenes>\n"
+            "</COLLADA>\n";
+    return doc;
+}
+
+bool
+syntheticImport( DataBase& database, const SceneParameters& parameters )
+{
+    Collada::Importer importer( database );
+    return importer.parseMemory( syntheticCollada( parameters ).c_str() );
+}
+
+DataBase&
+syntheticDataBase( bool deep )
+{
+    static DataBase flat_db;
+    static DataBase deep_db;
+    DataBase& db = deep ? deep_db : flat_db;
+    if( db.library<VisualScene>().size() == 0 ) {
+        SceneParameters parameters;
+        if( deep ) {
+            parameters.m_depth = 6;
+        }
+        syntheticImport( db, parameters );
+    }
+    return db;
+}
+
+void
+geometryNodes( std::vector<const Node*>&  roots,
+               std::vector<const Node*>&  leaves,
+               const DataBase&            database )
+{
+    const Library<Node>& nodes = database.library<Node>();
+    for( size_t i=0; i<nodes.size(); i++ ) {
+        const Node* node = nodes.get( i );
+        if( node->parent() == NULL ) {
+            collectGeometryNodes( roots, leaves, node, node );
+        }
+    }
+}
+
+Geometry*
+syntheticMesh( DataBase&           database,
+               const std::string&  id,
+               size_t              grid,
+               size_t              sets )
+{
+    const size_t n = grid + 1;
+    Library<SourceBuffer>& buffers = database.library<SourceBuffer>();
+
+    float* positions = buffers.add( id + "_positions" )->floatContents( 3*n*n );
+    float* texcoords = buffers.add( id + "_texcoords" )->floatContents( 2*n*n );
+    for( size_t y=0; y<n; y++ ) {
+        for( size_t x=0; x<n; x++ ) {
+            const size_t v = y*n + x;
+            positions[ 3*v + 0 ] = float( x );
+            positions[ 3*v + 1 ] = float( y );
+            positions[ 3*v + 2 ] = 0.01f*float( (x*y) % 7 );
+            texcoords[ 2*v + 0 ] = float( x )/grid;
+            texcoords[ 2*v + 1 ] = float( y )/grid;
+        }
+    }
+    float* normals = buffers.add( id + "_normals" )->floatContents( 3*n*n );
+    for( size_t v=0; v<n*n; v++ ) {
+        normals[ 3*v + 0 ] = 0.f;
+        normals[ 3*v + 1 ] = 0.1f*float( v % 3 );
+        normals[ 3*v + 2 ] = 1.f;
+    }
+
+    Geometry* geometry = database.library<Geometry>().add( id );
+    geometry->setVertexSource( VERTEX_POSITION, id + "_positions", 3, int( n*n ), 3, 0 );
+
+    std::vector<int> indices;
+    indices.reserve( 3*3*2*grid*grid );
+    for( size_t s=0; s<sets; s++ ) {
+        const size_t offset = indices.size();
+        const size_t row_begin = (s*grid)/sets;
+        const size_t row_end = ((s+1)*grid)/sets;
+        for( size_t y=row_begin; y<row_end; y++ ) {
+            for( size_t x=0; x<grid; x++ ) {
+                const int v[4] = { int( y*n + x ), int( y*n + x + 1 ), int( (y+1)*n + x + 1 ), int( (y+1)*n + x ) };
+                const int corners[6] = { 0, 1, 2, 0, 2, 3 };
+                for( size_t c=0; c<6; c++ ) {
+                    indices.push_back( v[ corners[c] ] );
+                    indices.push_back( v[ corners[c] ] );
+                    indices.push_back( v[ corners[c] ] );
+                }
+            }
+        }
+        Primitives* primitives = geometry->addPrimitiveSet();
+        primitives->setMaterialSymbol( "default" );
+        primitives->setSharedVertexSource( 0, VERTEX_POSITION, "", 0, 0, 0, 0 );
+        primitives->setSharedVertexSource( 1, VERTEX_NORMAL, id + "_normals", 3, unsigned( n*n ), 3, 0 );
+        primitives->setSharedVertexSource( 2, VERTEX_TEXCOORD, id + "_texcoords", 2, unsigned( n*n ), 2, 0 );
+        primitives->set( PRIMITIVE_TRIANGLES, unsigned( 2*(row_end-row_begin)*grid ), 3, id + "_indices", unsigned( offset ) );
+    }
+    buffers.add( id + "_indices" )->contents( indices );
+    return geometry;
+}
+
+    } // of namespace Bench
+} // of namespace Scene
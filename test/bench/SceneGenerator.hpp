@@ -0,0 +1,89 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Scene {
+    class DataBase;
+    class Geometry;
+    class Node;
+    namespace Bench {
+
+/** Shape of a synthetic scene. */
+struct SceneParameters
+{
+    SceneParameters();
+
+    size_t  m_nodes;        ///< Number of nodes below the root, each instancing a geometry.
+    size_t  m_depth;        ///< Number of levels below the root node.
+    size_t  m_materials;    ///< Number of materials, all sharing one GLSL effect.
+    size_t  m_geometries;   ///< Number of distinct geometries shared by the nodes.
+    size_t  m_triangles;    ///< Number of triangles per geometry.
+    bool    m_normals;      ///< Add normals with their own index, i.e. shared inputs.
+};
+
+/** Create a COLLADA document with a scene of the given shape.
+ *
+ * Nodes are laid out as a tree of equal fan-out with every node translated
+ * relative to its parent, and geometries and materials are assigned to nodes
+ * round-robin. With m_normals, the geometries have multi-index primitives
+ * that must be flattened before rendering.
+ */
+std::string
+syntheticCollada( const SceneParameters& parameters );
+
+/** Import a synthetic scene into a database, returns false on failure. */
+bool
+syntheticImport( DataBase& database, const SceneParameters& parameters );
+
+/** A database with a synthetic scene, created on first use and shared.
+ *
+ * The default is a flat scene of 10000 nodes, the deep variant spreads 10000
+ * nodes over 6 levels.
+ */
+DataBase&
+syntheticDataBase( bool deep = false );
+
+/** All nodes that instance geometry, with the root of their hierarchy.
+ *
+ * The pairs are paths as used by TransformCache::pathTransformMatrix.
+ */
+void
+geometryNodes( std::vector<const Node*>&  roots,
+               std::vector<const Node*>&  leaves,
+               const DataBase&            database );
+
+/** Add a multi-index grid mesh to a database, bypassing COLLADA parsing.
+ *
+ * The mesh has grid x grid quads split into two triangles each. Positions,
+ * normals and texture coordinates are per grid vertex and have an index
+ * each, i.e. the index tuples are (position, normal, texcoord) and every
+ * tuple is used by up to six triangles. The rows are split evenly over the
+ * given number of primitive sets.
+ */
+Geometry*
+syntheticMesh( DataBase&           database,
+               const std::string&  id,
+               size_t              grid,
+               size_t              sets = 1 );
+
+    } // of namespace Bench
+} // of namespace Scene
@@ -0,0 +1,223 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <thread>
+#include <scene/Log.hpp>
+#include "Bench.hpp"
+
+namespace Scene {
+    namespace Bench {
+
+State::State( double min_seconds )
+    : m_start( Clock::now() ),
+      m_cpu_start( std::clock() ),
+      m_paused( true ),
+      m_min_seconds( min_seconds ),
+      m_seconds( 0.0 ),
+      m_cpu_seconds( 0.0 ),
+      m_iterations( 0 ),
+      m_items( 0.0 ),
+      m_bytes( 0.0 )
+{
+}
+
+bool
+State::keepRunning()
+{
+    pauseTiming();
+    if( (m_iterations > 0) && (m_seconds >= m_min_seconds) ) {
+        return false;
+    }
+    m_iterations++;
+    resumeTiming();
+    return true;
+}
+
+void
+State::pauseTiming()
+{
+    if( !m_paused ) {
+        m_seconds += std::chrono::duration<double>( Clock::now() - m_start ).count();
+        m_cpu_seconds += static_cast<double>( std::clock() - m_cpu_start ) / CLOCKS_PER_SEC;
+        m_paused = true;
+    }
+}
+
+void
+State::resumeTiming()
+{
+    if( m_paused ) {
+        m_paused = false;
+        m_cpu_start = std::clock();
+        m_start = Clock::now();
+    }
+}
+
+Registrar::Registrar( const std::string& name, BenchFunc func )
+{
+    Entry e;
+    e.m_name = name;
+    e.m_func = func;
+    benchmarks().push_back( e );
+}
+
+std::vector<Entry>&
+benchmarks()
+{
+    static std::vector<Entry> entries;
+    return entries;
+}
+
+    } // of namespace Bench
+} // of namespace Scene
+
+namespace {
+
+struct Result
+{
+    std::string m_name;
+    size_t      m_iterations;
+    double      m_real_ns;
+    double      m_cpu_ns;
+    double      m_items_per_second;
+    double      m_bytes_per_second;
+};
+
+// Writes results in the JSON layout of Google Benchmark, so that its
+// tools (e.g. compare.py) can be used to diff two runs.
+bool
+writeJSON( const std::string& path, const std::string& executable, const std::vector<Result>& results )
+{
+    std::ofstream out( path.c_str() );
+    if( !out ) {
+        return false;
+    }
+    char date[64];
+    const std::time_t now = std::time( NULL );
+    std::strftime( date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime( &now ) );
+
+    out << "{\n"
+        << "  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"executable\": \"" << executable << "\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef DEBUG
+        << "    \"library_build_type\": \"debug\"\n"
+#else
+        << "    \"library_build_type\": \"release\"\n"
+#endif
+        << "  },\n"
+        << "  \"benchmarks\": [";
+    out << std::setprecision( 12 );
+    for( size_t i=0; i<results.size(); i++ ) {
+        const Result& r = results[i];
+        out << (i==0 ? "\n" : ",\n")
+            << "    {\n"
+            << "      \"name\": \"" << r.m_name << "\",\n"
+            << "      \"run_name\": \"" << r.m_name << "\",\n"
+            << "      \"run_type\": \"iteration\",\n"
+            << "      \"iterations\": " << r.m_iterations << ",\n"
+            << "      \"real_time\": " << r.m_real_ns << ",\n"
+            << "      \"cpu_time\": " << r.m_cpu_ns << ",\n"
+            << "      \"time_unit\": \"ns\"";
+        if( r.m_items_per_second > 0.0 ) {
+            out << ",\n      \"items_per_second\": " << r.m_items_per_second;
+        }
+        if( r.m_bytes_per_second > 0.0 ) {
+            out << ",\n      \"bytes_per_second\": " << r.m_bytes_per_second;
+        }
+        out << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+    return out.good();
+}
+
+} // of anonymous namespace
+
+/** Runs all benchmarks whose name contains the (optional) filter argument.
+ *
+ * Usage: scene_bench [--min-time seconds] [--json file] [filter]
+ *
+ * With --json, the results are also written to file in the JSON format of
+ * Google Benchmark.
+ */
+int main(int argc, char **argv)
+{
+    using namespace Scene::Bench;
+    Scene::initLogger( &argc, argv );
+
+    double min_seconds = 0.5;
+    std::string filter;
+    std::string json;
+    for( int i=1; i<argc; i++ ) {
+        if( (std::strcmp( argv[i], "--min-time" ) == 0) && (i+1 < argc) ) {
+            min_seconds = std::atof( argv[++i] );
+        }
+        else if( (std::strcmp( argv[i], "--json" ) == 0) && (i+1 < argc) ) {
+            json = argv[++i];
+        }
+        else {
+            filter = argv[i];
+        }
+    }
+
+    std::cout << std::left << std::setw( 40 ) << "benchmark"
+              << std::right << std::setw( 12 ) << "iterations"
+              << std::setw( 14 ) << "ns/iter"
+              << std::setw( 14 ) << "Mitems/s"
+              << std::setw( 12 ) << "MB/s"
+              << std::endl;
+    std::vector<Result> results;
+    const std::vector<Entry>& entries = benchmarks();
+    for( size_t i=0; i<entries.size(); i++ ) {
+        if( !filter.empty() && (entries[i].m_name.find( filter ) == std::string::npos ) ) {
+            continue;
+        }
+        State state( min_seconds );
+        entries[i].m_func( state );
+
+        const double n = static_cast<double>( std::max( size_t(1), state.iterations() ) );
+        Result r;
+        r.m_name = entries[i].m_name;
+        r.m_iterations = state.iterations();
+        r.m_real_ns = 1e9*state.seconds()/n;
+        r.m_cpu_ns = 1e9*state.cpuSeconds()/n;
+        r.m_items_per_second = state.itemsPerIteration()*n/state.seconds();
+        r.m_bytes_per_second = state.bytesPerIteration()*n/state.seconds();
+        results.push_back( r );
+
+        std::cout << std::left << std::setw( 40 ) << r.m_name
+                  << std::right << std::setw( 12 ) << r.m_iterations
+                  << std::setw( 14 ) << std::fixed << std::setprecision( 1 ) << r.m_real_ns
+                  << std::setw( 14 ) << std::setprecision( 2 ) << (r.m_items_per_second*1e-6)
+                  << std::setw( 12 ) << std::setprecision( 1 ) << (r.m_bytes_per_second/(1024.0*1024.0))
+                  << std::endl;
+    }
+    if( !json.empty() && !writeJSON( json, argv[0], results ) ) {
+        std::cerr << "Failed to write '" << json << "'." << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
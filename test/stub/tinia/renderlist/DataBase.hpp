@@ -0,0 +1,262 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ *
+ * This file is part of Scene.
+ *
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/** Minimal stand-in for the Tinia render list database.
+ *
+ * Only the part of the interface used by Scene::Tinia::Bridge is provided,
+ * so that the bridge can be built and tested without Tinia. Every item
+ * records when it was last changed, which lets tests check what a push has
+ * sent.
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tinia {
+    namespace renderlist {
+
+enum PrimitiveType {
+    PRIMITIVE_POINTS,
+    PRIMITIVE_LINES,
+    PRIMITIVE_LINE_STRIP,
+    PRIMITIVE_LINE_LOOP,
+    PRIMITIVE_TRIANGLES,
+    PRIMITIVE_TRIANGLE_STRIP,
+    PRIMITIVE_TRIANGLE_FAN,
+    PRIMITIVE_QUADS,
+    PRIMITIVE_QUAD_STRIP
+};
+
+enum LightType {
+    LIGHT_AMBIENT,
+    LIGHT_DIRECTIONAL,
+    LIGHT_POINT,
+    LIGHT_SPOT
+};
+
+enum UniformSemantic {
+    SEMANTIC_MODELVIEW_PROJECTION_MATRIX,
+    SEMANTIC_NORMAL_MATRIX
+};
+
+typedef size_t Id;
+
+class Item
+{
+public:
+    Item() : m_id( 0 ), m_clock( NULL ), m_changed( 0 ) {}
+
+    virtual
+    ~Item() {}
+
+    Id
+    id() const { return m_id; }
+
+    const std::string&
+    name() const { return m_name; }
+
+    /** Database revision of the last change. */
+    size_t
+    changed() const { return m_changed; }
+
+protected:
+    friend class DataBase;
+    Id          m_id;
+    std::string m_name;
+    size_t*     m_clock;
+    size_t      m_changed;
+
+    void
+    touch() { m_changed = ++(*m_clock); }
+};
+
+class Buffer : public Item
+{
+public:
+    void
+    set( const float* data, size_t count ) { m_count = count; (void)data; touch(); }
+
+    void
+    set( const int* data, size_t count ) { m_count = count; (void)data; touch(); }
+
+protected:
+    size_t  m_count;
+};
+
+class Shader : public Item
+{
+public:
+    void setVertexStage( const std::string& source ) { m_vertex = source; touch(); }
+    void setTessCtrlStage( const std::string& ) { touch(); }
+    void setTessEvalStage( const std::string& ) { touch(); }
+    void setGeometryStage( const std::string& ) { touch(); }
+    void setFragmentStage( const std::string& source ) { m_fragment = source; touch(); }
+
+protected:
+    std::string m_vertex;
+    std::string m_fragment;
+};
+
+class Action : public Item
+{
+};
+
+class SetFramebuffer : public Action
+{
+};
+
+class SetViewCoordSys : public Action
+{
+public:
+    void setProjection( const float*, const float* ) { touch(); }
+    void setOrientation( const float*, const float* ) { touch(); }
+};
+
+class SetLocalCoordSys : public Action
+{
+public:
+    void setOrientation( const float*, const float* ) { touch(); }
+};
+
+class SetLight : public Action
+{
+public:
+    void setIndex( int ) { touch(); }
+    void setType( LightType ) { touch(); }
+    void setColor( float, float, float ) { touch(); }
+    void setAttenuation( float, float, float ) { touch(); }
+    void setFalloff( float, float ) { touch(); }
+    void setOrientation( const float*, const float* ) { touch(); }
+};
+
+class SetShader : public Action
+{
+public:
+    void setShader( const std::string& ) { touch(); }
+};
+
+class SetInputs : public Action
+{
+public:
+    void setShader( const std::string& ) { touch(); }
+    void clearInputs() { touch(); }
+    void setInput( const std::string&, const std::string&, int, int, int ) { touch(); }
+};
+
+class SetUniforms : public Action
+{
+public:
+    void setShader( const std::string& ) { touch(); }
+    void clear() { touch(); }
+    void setSemantic( const std::string&, UniformSemantic ) { touch(); }
+    void setInt1( const std::string&, int ) { touch(); }
+    void setFloat1v( const std::string&, const float* ) { touch(); }
+    void setFloat2v( const std::string&, const float* ) { touch(); }
+    void setFloat3v( const std::string&, const float* ) { touch(); }
+    void setFloat4v( const std::string&, const float* ) { touch(); }
+    void setFloat3x3v( const std::string&, const float* ) { touch(); }
+    void setFloat4x4v( const std::string&, const float* ) { touch(); }
+};
+
+class Draw : public Action
+{
+public:
+    void setNonIndexed( PrimitiveType, size_t, size_t ) { touch(); }
+    void setIndexed( PrimitiveType, Id, size_t, size_t ) { touch(); }
+};
+
+class DataBase
+{
+public:
+    DataBase() : m_clock( 0 ), m_draw_order_changed( 0 ), m_next_id( 1 ) {}
+
+    template<typename T>
+    T
+    castedItemByName( const std::string& name )
+    {
+        auto it = m_items.find( name );
+        return it == m_items.end() ? NULL : dynamic_cast<T>( it->second.get() );
+    }
+
+    template<typename T>
+    T*
+    createAction( const std::string& name ) { return create<T>( name ); }
+
+    Buffer*
+    createBuffer( const std::string& name ) { return create<Buffer>( name ); }
+
+    Shader*
+    createShader( const std::string& name ) { return create<Shader>( name ); }
+
+    void
+    drawOrderClear() { m_draw_order.clear(); m_draw_order_changed = ++m_clock; }
+
+    void
+    drawOrderAdd( const std::string& name ) { m_draw_order.push_back( name ); m_draw_order_changed = ++m_clock; }
+
+    void
+    process( bool ) {}
+
+    /** Current revision, increased by every change. */
+    size_t
+    revision() const { return m_clock; }
+
+    /** Revision of the last change of the draw order. */
+    size_t
+    drawOrderChanged() const { return m_draw_order_changed; }
+
+    /** Items changed after a revision. */
+    std::vector<const Item*>
+    changedSince( size_t revision ) const
+    {
+        std::vector<const Item*> items;
+        for( auto it=m_items.begin(); it!=m_items.end(); ++it ) {
+            if( revision < it->second->changed() ) {
+                items.push_back( it->second.get() );
+            }
+        }
+        return items;
+    }
+
+protected:
+    size_t                                          m_clock;
+    size_t                                          m_draw_order_changed;
+    Id                                              m_next_id;
+    std::map<std::string,std::unique_ptr<Item> >    m_items;
+    std::vector<std::string>                        m_draw_order;
+
+    template<typename T>
+    T*
+    create( const std::string& name )
+    {
+        T* item = new T;
+        item->m_id = m_next_id++;
+        item->m_name = name;
+        item->m_clock = &m_clock;
+        item->touch();
+        m_items[ name ].reset( item );
+        return item;
+    }
+};
+
+    } // of namespace renderlist
+} // of namespace tinia
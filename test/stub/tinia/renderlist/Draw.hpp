@@ -0,0 +1,3 @@
+#pragma once
+// Stub: see DataBase.hpp.
+#include "DataBase.hpp"
@@ -0,0 +1,162 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <scene/Value.hpp>
+#include <scene/runtime/BoundingVolumeHierarchy.hpp>
+
+namespace {
+
+Scene::Value
+translation( float x, float y, float z )
+{
+    return Scene::Value::createFloat4x4( 1.f, 0.f, 0.f, x,
+                                         0.f, 1.f, 0.f, y,
+                                         0.f, 0.f, 1.f, z,
+                                         0.f, 0.f, 0.f, 1.f );
+}
+
+// Column-major orthographic projection of [l,r]x[b,t]x[-n,n].
+Scene::Value
+orthographic( float l, float r, float b, float t, float n )
+{
+    return Scene::Value::createFloat4x4( 2.f/(r-l), 0.f,       0.f,    -(r+l)/(r-l),
+                                         0.f,       2.f/(t-b), 0.f,    -(t+b)/(t-b),
+                                         0.f,       0.f,       -1.f/n, 0.f,
+                                         0.f,       0.f,       0.f,    1.f );
+}
+
+// The per-item test of TransformCompute::boundingBoxTest.
+bool
+referenceVisible( const Scene::Value& clip, const Scene::Value& world,
+                  const Scene::Value& bbmin, const Scene::Value& bbmax )
+{
+    const float* C = clip.floatData();
+    const float* W = world.floatData();
+    float M[16];
+    for( unsigned int j=0; j<4; j++ ) {
+        for( unsigned int i=0; i<4; i++ ) {
+            M[4*j+i] = C[i]*W[4*j] + C[4+i]*W[4*j+1] + C[8+i]*W[4*j+2] + C[12+i]*W[4*j+3];
+        }
+    }
+    unsigned int mask_a = 0u;
+    unsigned int mask_b = 0u;
+    for( unsigned int c=0; c<8; c++ ) {
+        const float p[3] = { ((c&1) ? bbmax : bbmin).floatData()[0],
+                             ((c&2) ? bbmax : bbmin).floatData()[1],
+                             ((c&4) ? bbmax : bbmin).floatData()[2] };
+        float h[4];
+        for( unsigned int i=0; i<4; i++ ) {
+            h[i] = M[i]*p[0] + M[4+i]*p[1] + M[8+i]*p[2] + M[12+i];
+        }
+        mask_a = mask_a | (h[0]<h[3]?0x1:0x0) | (h[1]<h[3]?0x2:0x0) | (h[2]<h[3]?0x4:0x0);
+        mask_b = mask_b | (h[0]>-h[3]?0x1:0x0) | (h[1]>-h[3]?0x2:0x0) | (h[2]>-h[3]?0x4:0x0);
+    }
+    return (mask_a & mask_b) == 7u;
+}
+
+class BoundingVolumeHierarchyTest : public ::testing::Test
+{
+protected:
+    static const size_t m_grid = 40;
+
+    Scene::Value                m_clip;
+    Scene::Value                m_bbox_min;
+    Scene::Value                m_bbox_max;
+    std::vector<Scene::Value>   m_transforms;
+    Scene::Runtime::BoundingVolumeHierarchy m_bvh;
+
+    void
+    SetUp()
+    {
+        m_clip = orthographic( 10.5f, 30.5f, 5.5f, 25.5f, 10.f );
+        m_bbox_min = Scene::Value::createFloat4( 0.f, 0.f, 0.f, 1.f );
+        m_bbox_max = Scene::Value::createFloat4( 1.f, 1.f, 1.f, 1.f );
+        m_transforms.reserve( m_grid*m_grid );
+        for( size_t i=0; i<m_grid*m_grid; i++ ) {
+            m_transforms.push_back( translation( 2.f*(i%m_grid), 2.f*(i/m_grid), 0.f ) );
+            m_bvh.add( &m_clip, &m_transforms.back(), &m_bbox_min, &m_bbox_max );
+        }
+    }
+
+    size_t
+    mismatches()
+    {
+        size_t n = 0;
+        for( size_t i=0; i<m_transforms.size(); i++ ) {
+            if( m_bvh.visible( i ) != referenceVisible( m_clip, m_transforms[i], m_bbox_min, m_bbox_max ) ) {
+                n++;
+            }
+        }
+        return n;
+    }
+};
+
+} // of anonymous namespace
+
+TEST_F( BoundingVolumeHierarchyTest, MatchesPerItemTest )
+{
+    m_bvh.update();
+    EXPECT_EQ( m_grid*m_grid, m_bvh.lastRefitCount() );
+    EXPECT_EQ( 0u, mismatches() );
+    EXPECT_EQ( 11u*10u, m_bvh.visibleItems() );
+    // Subtrees are accepted or rejected without testing every item.
+    EXPECT_LT( m_bvh.lastTestCount(), m_grid*m_grid );
+
+    // Nothing has changed, nothing is done.
+    m_bvh.update();
+    EXPECT_EQ( 0u, m_bvh.lastRefitCount() );
+    EXPECT_EQ( 0u, m_bvh.lastTestCount() );
+
+    m_clip = orthographic( -3.5f, 12.5f, 40.5f, 90.5f, 10.f );
+    m_bvh.update();
+    EXPECT_EQ( 0u, m_bvh.lastRefitCount() );
+    EXPECT_EQ( 0u, mismatches() );
+}
+
+TEST_F( BoundingVolumeHierarchyTest, RefitsMovedItems )
+{
+    m_bvh.update();
+    // Move a few items from the far corner into the frustum and vice versa.
+    for( size_t i=0; i<10; i++ ) {
+        m_transforms[ m_grid*m_grid - 1 - i ] = translation( 12.f + 2.f*i, 20.f, 0.f );
+        m_transforms[ m_grid*(6+i) + 8 ] = translation( -50.f, 0.f, 0.f );
+    }
+    m_bvh.update();
+    EXPECT_EQ( 20u, m_bvh.lastRefitCount() );
+    EXPECT_EQ( 0u, mismatches() );
+
+    // Moving most items rebuilds the hierarchy.
+    for( size_t i=0; i<m_transforms.size(); i++ ) {
+        m_transforms[i] = translation( 2.f*(i/m_grid), 2.f*(i%m_grid), 1.f );
+    }
+    m_bvh.update();
+    EXPECT_EQ( m_transforms.size(), m_bvh.lastRefitCount() );
+    EXPECT_EQ( 0u, mismatches() );
+}
+
+TEST_F( BoundingVolumeHierarchyTest, UnboundedItemsAreVisible )
+{
+    const size_t index = m_bvh.add( &m_clip, &m_transforms[0], NULL, NULL );
+    m_bvh.update();
+    EXPECT_TRUE( m_bvh.visible( index ) );
+    EXPECT_EQ( 11u*10u + 1u, m_bvh.visibleItems() );
+}
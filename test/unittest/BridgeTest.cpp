@@ -0,0 +1,159 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ *
+ * This file is part of Scene.
+ *
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <scene/DataBase.hpp>
+#include <scene/Light.hpp>
+#include <scene/Node.hpp>
+#include <scene/collada/Importer.hpp>
+#include <scene/tinia/Bridge.hpp>
+
+namespace {
+
+// A triangle seen by a perspective camera, optionally lit by a point light.
+std::string
+cameraCollada( bool light )
+{
+    return
+    "<?xml version=\"1.0\"?>\n"
+    "<COLLADA>\n"
+    "  <library_lights>\n"
+    "    <light id=\"light\"><technique_common><point><color>1 1 1</color></point></technique_common></light>\n"
+    "  </library_lights>\n"
+    "  <library_cameras>\n"
+    "    <camera id=\"camera\"><optics><technique_common><perspective>"
+    "<yfov>45</yfov><aspect_ratio>1</aspect_ratio><znear>0.1</znear><zfar>100</zfar>"
+    "</perspective></technique_common></optics></camera>\n"
+    "  </library_cameras>\n"
+    "  <library_geometries>\n"
+    "    <geometry id=\"geo\"><mesh>\n"
+    "      <source id=\"pos\"><float_array id=\"pos_array\" count=\"9\">0 0 0 1 0 0 0 1 0</float_array>\n"
+    "        <technique_common><accessor source=\"#pos_array\" count=\"3\" stride=\"3\">\n"
+    "          <param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/><param name=\"Z\" type=\"float\"/>\n"
+    "        </accessor></technique_common></source>\n"
+    "      <vertices id=\"geo_vertices\"><input semantic=\"POSITION\" source=\"#pos\"/></vertices>\n"
+    "      <triangles count=\"1\" material=\"default\"/>\n"
+    "    </mesh></geometry>\n"
+    "  </library_geometries>\n"
+    "  <library_effects>\n"
+    "    <effect id=\"effect\">\n"
+    "      <newparam sid=\"mvp\"><semantic>MODELVIEW_PROJECTION_MATRIX</semantic>"
+    "<float4x4>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</float4x4></newparam>\n"
+    "      <profile_GLSL><technique sid=\"default\"><pass>\n"
+    "        <program>\n"
+    "          <shader stage=\"VERTEX\"><sources><inline>attribute vec3 position; uniform mat4 MVP; void main() { gl_Position = MVP*vec4(position,1.0); }</inline></sources></shader>\n"
+    "          <shader stage=\"FRAGMENT\"><sources><inline>void main() { gl_FragColor = vec4(1.0); }</inline></sources></shader>\n"
+    "          <bind_attribute symbol=\"position\"><semantic>POSITION</semantic></bind_attribute>\n"
+    "          <bind_uniform symbol=\"MVP\"><param ref=\"mvp\"/></bind_uniform>\n"
+    "        </program>\n"
+    "      </pass></technique></profile_GLSL>\n"
+    "    </effect>\n"
+    "  </library_effects>\n"
+    "  <library_materials>\n"
+    "    <material id=\"mat\"><instance_effect url=\"#effect\"/></material>\n"
+    "  </library_materials>\n"
+    "  <library_visual_scenes>\n"
+    "    <visual_scene id=\"scene\">\n"
+    "      <node id=\"camera_node\"><translate>0 0 5</translate><instance_camera url=\"#camera\"/></node>\n"
+    "      <node id=\"light_node\"><translate>0 5 0</translate><instance_light url=\"#light\"/></node>\n"
+    "      <node id=\"triangle\"><instance_geometry url=\"#geo\"><bind_material><technique_common>"
+    "<instance_material symbol=\"default\" target=\"#mat\"/>"
+    "</technique_common></bind_material></instance_geometry></node>\n"
+    "      <evaluate_scene><render camera_node=\"#camera_node\">" +
+    std::string( light ? "<extra><technique profile=\"Scene\"><light_node index=\"0\" ref=\"#light_node\"/></technique></extra>" : "" ) +
+    "</render></evaluate_scene>\n"
+    "    </visual_scene>\n"
+    "  </library_visual_scenes>\n"
+    "</COLLADA>\n";
+}
+
+} // of anonymous namespace
+
+TEST( Bridge, CameraOnlyPushSendsMatrices )
+{
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parseMemory( cameraCollada( false ).c_str() ) );
+
+    Scene::Tinia::Bridge bridge( db, Scene::PROFILE_GLSL );
+    ASSERT_TRUE( bridge.build( "scene" ) );
+    const Scene::Tinia::Bridge::PushStatistics& stats = bridge.pushStatistics();
+    EXPECT_TRUE( stats.m_draw_order );
+    EXPECT_LT( 0u, stats.m_buffers );
+    EXPECT_LT( 0u, stats.m_shaders );
+
+    const tinia::renderlist::DataBase& rldb = bridge.renderListDataBase();
+    const size_t draw_order = rldb.drawOrderChanged();
+    const size_t revision = rldb.revision();
+
+    // Move the camera.
+    Scene::Node* camera = db.library<Scene::Node>().get( "camera_node" );
+    ASSERT_TRUE( camera != NULL );
+    camera->transformSetTranslate( 0, 0.f, 1.f, 5.f );
+    ASSERT_TRUE( bridge.build( "scene" ) );
+
+    EXPECT_FALSE( stats.m_draw_order );
+    EXPECT_EQ( 0u, stats.m_buffers );
+    EXPECT_EQ( 0u, stats.m_shaders );
+    EXPECT_EQ( 0u, stats.m_uniforms );
+    EXPECT_LT( 0u, stats.m_coordsys );
+
+    // Only coordinate systems were sent.
+    EXPECT_EQ( draw_order, rldb.drawOrderChanged() );
+    const std::vector<const tinia::renderlist::Item*> changed = rldb.changedSince( revision );
+    EXPECT_FALSE( changed.empty() );
+    for( size_t i=0; i<changed.size(); i++ ) {
+        EXPECT_TRUE( (dynamic_cast<const tinia::renderlist::SetViewCoordSys*>( changed[i] ) != NULL ) ||
+                     (dynamic_cast<const tinia::renderlist::SetLocalCoordSys*>( changed[i] ) != NULL ) )
+                << changed[i]->name();
+    }
+}
+
+TEST( Bridge, ChangedLightIsResent )
+{
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parseMemory( cameraCollada( true ).c_str() ) );
+
+    Scene::Tinia::Bridge bridge( db, Scene::PROFILE_GLSL );
+    ASSERT_TRUE( bridge.build( "scene" ) );
+    const Scene::Tinia::Bridge::PushStatistics& stats = bridge.pushStatistics();
+    const tinia::renderlist::DataBase& rldb = bridge.renderListDataBase();
+    const size_t revision = rldb.revision();
+
+    // A changed light is found from the journal and sent again, without
+    // rebuilding or sending anything else.
+    Scene::Light* light = db.library<Scene::Light>().get( "light" );
+    ASSERT_TRUE( light != NULL );
+    light->setColor( 1.f, 0.f, 0.f );
+    ASSERT_TRUE( bridge.build( "scene" ) );
+    EXPECT_FALSE( stats.m_draw_order );
+    EXPECT_EQ( 0u, stats.m_buffers );
+    EXPECT_EQ( 0u, stats.m_shaders );
+    EXPECT_EQ( 0u, stats.m_coordsys );
+
+    const std::vector<const tinia::renderlist::Item*> changed = rldb.changedSince( revision );
+    ASSERT_EQ( 1u, changed.size() );
+    EXPECT_TRUE( dynamic_cast<const tinia::renderlist::SetLight*>( changed[0] ) != NULL );
+
+    // Nothing has changed.
+    EXPECT_FALSE( bridge.build( "scene" ) );
+}
@@ -0,0 +1,51 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <gtest/gtest.h>
+#include <scene/runtime/CacheLUT.hpp>
+
+TEST( CacheLUT, InsertFindClear )
+{
+    typedef Scene::Runtime::CacheLUT<2> LUT;
+
+    std::vector<int> objects( 1000 );
+    LUT lut;
+    EXPECT_EQ( LUT::none(), lut.find( LUT::Key( &objects[0], &objects[1] ) ) );
+
+    for( size_t i=0; i<objects.size(); i++ ) {
+        lut.insert( LUT::Key( &objects[i%3], &objects[i] ), i );
+    }
+    EXPECT_EQ( objects.size(), lut.size() );
+    for( size_t i=0; i<objects.size(); i++ ) {
+        EXPECT_EQ( i, lut.find( LUT::Key( &objects[i%3], &objects[i] ) ) );
+    }
+    EXPECT_EQ( LUT::none(), lut.find( LUT::Key( &objects[1], &objects[0] ) ) );
+    EXPECT_EQ( LUT::none(), lut.find( LUT::Key( NULL, NULL ) ) );
+
+    // Insert of existing key replaces value.
+    lut.insert( LUT::Key( &objects[0], &objects[0] ), 42 );
+    EXPECT_EQ( objects.size(), lut.size() );
+    EXPECT_EQ( 42u, lut.find( LUT::Key( &objects[0], &objects[0] ) ) );
+
+    lut.clear();
+    EXPECT_EQ( 0u, lut.size() );
+    EXPECT_EQ( LUT::none(), lut.find( LUT::Key( &objects[0], &objects[0] ) ) );
+    lut.insert( LUT::Key( &objects[5], &objects[7] ), 3 );
+    EXPECT_EQ( 3u, lut.find( LUT::Key( &objects[5], &objects[7] ) ) );
+}
@@ -0,0 +1,172 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <array>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <scene/DataBase.hpp>
+#include <scene/Geometry.hpp>
+#include <scene/Primitives.hpp>
+#include <scene/SourceBuffer.hpp>
+#include <scene/collada/Importer.hpp>
+
+namespace {
+
+typedef std::array<int,3> Tuple;
+
+// A grid of grid x grid quads with (position, normal, texcoord) index
+// tuples. Every fifth column of quads has one normal per triangle, the rest
+// share normals with their neighbours. The rows are split over two sets.
+Scene::Geometry*
+buildMesh( Scene::DataBase& db, std::vector< std::vector<Tuple> >& sets, size_t grid )
+{
+    const size_t n = grid + 1;
+    Scene::Library<Scene::SourceBuffer>& buffers = db.library<Scene::SourceBuffer>();
+
+    float* positions = buffers.add( "positions" )->floatContents( 3*n*n );
+    float* texcoords = buffers.add( "texcoords" )->floatContents( 2*n*n );
+    float* normals = buffers.add( "normals" )->floatContents( 3*(n*n + 2*grid*grid) );
+    for( size_t v=0; v<n*n; v++ ) {
+        positions[ 3*v + 0 ] = float( v % n );
+        positions[ 3*v + 1 ] = float( v / n );
+        positions[ 3*v + 2 ] = 0.5f*float( v % 3 );
+        texcoords[ 2*v + 0 ] = float( v );
+        texcoords[ 2*v + 1 ] = -float( v );
+    }
+    for( size_t i=0; i<n*n + 2*grid*grid; i++ ) {
+        normals[ 3*i + 0 ] = float( i );
+        normals[ 3*i + 1 ] = 1.f;
+        normals[ 3*i + 2 ] = -float( i );
+    }
+
+    Scene::Geometry* geometry = db.library<Scene::Geometry>().add( "mesh" );
+    geometry->setVertexSource( Scene::VERTEX_POSITION, "positions", 3, int( n*n ), 3, 0 );
+
+    std::vector<int> indices;
+    const size_t rows[3] = { 0, grid/3, grid };
+    sets.resize( 2 );
+    for( size_t s=0; s<2; s++ ) {
+        const size_t offset = indices.size();
+        for( size_t y=rows[s]; y<rows[s+1]; y++ ) {
+            for( size_t x=0; x<grid; x++ ) {
+                const int v[4] = { int( y*n + x ), int( y*n + x + 1 ), int( (y+1)*n + x + 1 ), int( (y+1)*n + x ) };
+                const int corners[6] = { 0, 1, 2, 0, 2, 3 };
+                for( size_t c=0; c<6; c++ ) {
+                    const int p = v[ corners[c] ];
+                    const int t = int( n*n + 2*(y*grid + x) + c/3 );
+                    const Tuple tuple = { { p, (x % 5) == 0 ? t : p, p } };
+                    sets[s].push_back( tuple );
+                    indices.insert( indices.end(), tuple.begin(), tuple.end() );
+                }
+            }
+        }
+        Scene::Primitives* primitives = geometry->addPrimitiveSet();
+        primitives->setMaterialSymbol( "default" );
+        primitives->setSharedVertexSource( 0, Scene::VERTEX_POSITION, "", 0, 0, 0, 0 );
+        primitives->setSharedVertexSource( 1, Scene::VERTEX_NORMAL, "normals", 3, unsigned( n*n + 2*grid*grid ), 3, 0 );
+        primitives->setSharedVertexSource( 2, Scene::VERTEX_TEXCOORD, "texcoords", 2, unsigned( n*n ), 2, 0 );
+        primitives->set( Scene::PRIMITIVE_TRIANGLES, unsigned( 2*(rows[s+1]-rows[s])*grid ), 3, "indices", unsigned( offset ) );
+    }
+    buffers.add( "indices" )->contents( indices );
+    return geometry;
+}
+
+} // of anonymous namespace
+
+// Large enough to be split into several chunks. The flattened vertices must
+// be numbered in order of first appearance, as they have always been.
+TEST( GeometryFlatten, MatchesReference )
+{
+    Scene::DataBase db;
+    std::vector< std::vector<Tuple> > sets;
+    Scene::Geometry* geometry = buildMesh( db, sets, 300 );
+    ASSERT_TRUE( geometry->hasSharedInputs() );
+
+    std::map<Tuple,int> reference;
+    std::vector<int> reference_indices;
+    for( size_t s=0; s<sets.size(); s++ ) {
+        for( size_t i=0; i<sets[s].size(); i++ ) {
+            auto it = reference.insert( std::make_pair( sets[s][i], int( reference.size() ) ) ).first;
+            reference_indices.push_back( it->second );
+        }
+    }
+
+    ASSERT_TRUE( geometry->flatten() );
+    EXPECT_FALSE( geometry->hasSharedInputs() );
+
+    const Scene::SourceBuffer* indices = db.library<Scene::SourceBuffer>().get( "mesh_flat_indices" );
+    ASSERT_TRUE( indices != NULL );
+    ASSERT_EQ( reference_indices.size(), indices->elementCount() );
+    EXPECT_TRUE( std::equal( reference_indices.begin(), reference_indices.end(), indices->intData() ) );
+
+    size_t offset = 0;
+    for( size_t s=0; s<sets.size(); s++ ) {
+        const Scene::Primitives* primitives = geometry->primitives( s );
+        EXPECT_EQ( "mesh_flat_indices", primitives->indexBufferId() );
+        EXPECT_EQ( offset, primitives->indexOffset() );
+        EXPECT_EQ( sets[s].size(), primitives->vertexCount() );
+        offset += sets[s].size();
+    }
+
+    const char* sources[3] = { "positions", "normals", "texcoords" };
+    const Scene::VertexSemantic semantics[3] = { Scene::VERTEX_POSITION, Scene::VERTEX_NORMAL, Scene::VERTEX_TEXCOORD };
+    for( size_t k=0; k<3; k++ ) {
+        const Scene::Geometry::VertexInput& input = geometry->vertexInput( semantics[k] );
+        ASSERT_TRUE( input.m_enabled );
+        ASSERT_EQ( reference.size(), input.m_count );
+        const float* flat = db.library<Scene::SourceBuffer>().get( input.m_source_buffer_id )->floatData();
+        const float* orig = db.library<Scene::SourceBuffer>().get( sources[k] )->floatData();
+        size_t mismatches = 0;
+        for( auto it=reference.begin(); it!=reference.end(); ++it ) {
+            for( unsigned int j=0; j<input.m_components; j++ ) {
+                if( flat[ input.m_offset + input.m_stride*it->second + j ] != orig[ input.m_components*it->first[k] + j ] ) {
+                    mismatches++;
+                }
+            }
+        }
+        EXPECT_EQ( 0u, mismatches ) << sources[k];
+    }
+}
+
+TEST( GeometryFlatten, SharedInputsExample )
+{
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parse( "data/example5_shared_inputs.xml" ) );
+
+    auto& geometries = db.library<Scene::Geometry>();
+    for( size_t i=0; i<geometries.size(); i++ ) {
+        Scene::Geometry* geometry = geometries.get( i );
+        if( !geometry->hasSharedInputs() ) {
+            continue;
+        }
+        ASSERT_TRUE( geometry->flatten() );
+        EXPECT_FALSE( geometry->hasSharedInputs() );
+        for( size_t s=0; s<geometry->primitiveSets(); s++ ) {
+            const Scene::Primitives* primitives = geometry->primitives( s );
+            const Scene::SourceBuffer* indices = db.library<Scene::SourceBuffer>().get( primitives->indexBufferId() );
+            ASSERT_TRUE( indices != NULL );
+            const int* data = indices->intData() + primitives->indexOffset();
+            for( unsigned int k=0; k<primitives->vertexCount(); k++ ) {
+                EXPECT_LT( unsigned( data[k] ), geometry->vertexInput( Scene::VERTEX_POSITION ).m_count );
+            }
+        }
+    }
+}
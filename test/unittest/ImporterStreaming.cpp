@@ -0,0 +1,135 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <cstring>
+#include <gtest/gtest.h>
+
+#include <scene/DataBase.hpp>
+#include <scene/Geometry.hpp>
+#include <scene/Image.hpp>
+#include <scene/Camera.hpp>
+#include <scene/Light.hpp>
+#include <scene/Effect.hpp>
+#include <scene/Material.hpp>
+#include <scene/Node.hpp>
+#include <scene/SourceBuffer.hpp>
+#include <scene/VisualScene.hpp>
+#include <scene/collada/Importer.hpp>
+
+template<class T>
+static void
+compareLibrarySizes( const Scene::DataBase& a, const Scene::DataBase& b )
+{
+    EXPECT_EQ( a.library<T>().size(), b.library<T>().size() );
+}
+
+template<class T>
+static void
+compareLibraryOrder( const Scene::DataBase& a, const Scene::DataBase& b )
+{
+    ASSERT_EQ( a.library<T>().size(), b.library<T>().size() );
+    for( size_t i=0; i<a.library<T>().size(); i++ ) {
+        EXPECT_EQ( a.library<T>().get( i )->id(), b.library<T>().get( i )->id() );
+    }
+}
+
+static void
+compareDataBases( const Scene::DataBase& a_db, const Scene::DataBase& b_db )
+{
+    compareLibrarySizes<Scene::Geometry>( a_db, b_db );
+    compareLibrarySizes<Scene::Image>( a_db, b_db );
+    compareLibrarySizes<Scene::Camera>( a_db, b_db );
+    compareLibrarySizes<Scene::Light>( a_db, b_db );
+    compareLibrarySizes<Scene::Effect>( a_db, b_db );
+    compareLibrarySizes<Scene::Material>( a_db, b_db );
+    compareLibrarySizes<Scene::Node>( a_db, b_db );
+    compareLibrarySizes<Scene::VisualScene>( a_db, b_db );
+    compareLibrarySizes<Scene::SourceBuffer>( a_db, b_db );
+
+    const Scene::Library<Scene::SourceBuffer>& a_buffers = a_db.library<Scene::SourceBuffer>();
+    const Scene::Library<Scene::SourceBuffer>& b_buffers = b_db.library<Scene::SourceBuffer>();
+    for( size_t i=0; i<a_buffers.size(); i++ ) {
+        const Scene::SourceBuffer* a = a_buffers.get( i );
+        const Scene::SourceBuffer* b = b_buffers.get( a->id() );
+        ASSERT_TRUE( b != NULL ) << a->id();
+        ASSERT_EQ( a->elementType(), b->elementType() );
+        ASSERT_EQ( a->elementCount(), b->elementCount() );
+        const size_t bytes = a->elementCount() * ( a->elementType() == Scene::ELEMENT_FLOAT ? sizeof(float) : sizeof(int) );
+        EXPECT_EQ( 0, std::memcmp( a->voidData(), b->voidData(), bytes ) ) << a->id();
+    }
+}
+
+class ImporterStreaming : public ::testing::TestWithParam<const char*>
+{
+};
+
+TEST_P( ImporterStreaming, MatchesDOMImport )
+{
+    Scene::DataBase dom_db;
+    Scene::Collada::Importer dom_importer( dom_db );
+    ASSERT_TRUE( dom_importer.parse( GetParam() ) );
+
+    Scene::DataBase stream_db;
+    Scene::Collada::Importer stream_importer( stream_db );
+    stream_importer.setStreaming( true );
+    ASSERT_TRUE( stream_importer.parse( GetParam() ) );
+
+    compareDataBases( dom_db, stream_db );
+}
+
+class ImporterParallel : public ::testing::TestWithParam<const char*>
+{
+};
+
+TEST_P( ImporterParallel, MatchesSerialImport )
+{
+    Scene::DataBase serial_db;
+    Scene::Collada::Importer serial_importer( serial_db );
+    ASSERT_TRUE( serial_importer.parse( GetParam() ) );
+
+    Scene::DataBase parallel_db;
+    Scene::Collada::Importer parallel_importer( parallel_db );
+    parallel_importer.setParallel( true );
+    ASSERT_TRUE( parallel_importer.parse( GetParam() ) );
+
+    compareDataBases( serial_db, parallel_db );
+    compareLibraryOrder<Scene::Geometry>( serial_db, parallel_db );
+    compareLibraryOrder<Scene::Image>( serial_db, parallel_db );
+    compareLibraryOrder<Scene::SourceBuffer>( serial_db, parallel_db );
+}
+
+INSTANTIATE_TEST_CASE_P( Examples,
+                         ImporterStreaming,
+                         ::testing::Values( "data/example1_wirecube.xml",
+                                            "data/example2_shaded_cube.xml",
+                                            "data/example3_textured_shaded_cube.xml",
+                                            "data/example4_profile_common.xml",
+                                            "data/example5_shared_inputs.xml",
+                                            "data/rubberducky.xml",
+                                            "data/unit_lib_lights.xml" ) );
+
+INSTANTIATE_TEST_CASE_P( Examples,
+                         ImporterParallel,
+                         ::testing::Values( "data/example1_wirecube.xml",
+                                            "data/example2_shaded_cube.xml",
+                                            "data/example3_textured_shaded_cube.xml",
+                                            "data/example4_profile_common.xml",
+                                            "data/example5_shared_inputs.xml",
+                                            "data/rubberducky.xml",
+                                            "data/unit_lib_lights.xml" ) );
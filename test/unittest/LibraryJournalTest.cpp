@@ -0,0 +1,160 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ *
+ * This file is part of Scene.
+ *
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <scene/DataBase.hpp>
+#include <scene/Light.hpp>
+#include <scene/Value.hpp>
+#include <scene/Geometry.hpp>
+#include <scene/Primitives.hpp>
+#include <scene/SourceBuffer.hpp>
+#include <scene/tools/BBoxTool.hpp>
+
+typedef Scene::Library<Scene::Light>::Change LightChange;
+
+TEST( LibraryJournal, ChangesSince )
+{
+    Scene::DataBase database;
+    Scene::Library<Scene::Light>& lights = database.library<Scene::Light>();
+
+    Scene::Light* a = lights.add( "a" );
+    Scene::Light* b = lights.add( "b" );
+
+    Scene::SeqPos seen;
+    seen.touch();
+
+    // Nothing has changed since.
+    std::vector<LightChange> changes;
+    EXPECT_TRUE( lights.changesSince( changes, seen ) );
+    EXPECT_TRUE( changes.empty() );
+
+    // A change is journaled once, in order. Lights report a change when
+    // destroyed, which is not journaled. Removals only carry the identity.
+    const Scene::Identifiable::Id b_identity = b->Identifiable::id();
+    b->setColor( 0.f, 1.f, 0.f );
+    a->setType( Scene::Light::LIGHT_POINT );
+    lights.remove( b );
+    ASSERT_TRUE( lights.changesSince( changes, seen ) );
+    ASSERT_EQ( 3u, changes.size() );
+    EXPECT_EQ( Scene::CHANGE_VALUE, changes[0].m_kind );
+    EXPECT_EQ( b, changes[0].m_object );
+    EXPECT_EQ( b_identity, changes[0].m_identity );
+    EXPECT_EQ( Scene::CHANGE_STRUCTURE, changes[1].m_kind );
+    EXPECT_EQ( a, changes[1].m_object );
+    EXPECT_EQ( a->Identifiable::id(), changes[1].m_identity );
+    EXPECT_EQ( Scene::CHANGE_REMOVED, changes[2].m_kind );
+    EXPECT_TRUE( changes[2].m_object == NULL );
+    EXPECT_EQ( b_identity, changes[2].m_identity );
+
+    // Only changes after the timestamp are returned.
+    seen = changes[1].m_pos;
+    changes.clear();
+    ASSERT_TRUE( lights.changesSince( changes, seen ) );
+    ASSERT_EQ( 1u, changes.size() );
+    EXPECT_EQ( Scene::CHANGE_REMOVED, changes[0].m_kind );
+
+    // Adding is journaled after what the constructor reports, and a new
+    // object is never confused with a removed one, even if it reuses the
+    // memory.
+    seen.touch();
+    changes.clear();
+    Scene::Light* c = lights.add( "c" );
+    c->setColor( 1.f, 0.f, 0.f );
+    ASSERT_TRUE( lights.changesSince( changes, seen ) );
+    ASSERT_LE( 2u, changes.size() );
+    const LightChange& added = changes[ changes.size()-2 ];
+    EXPECT_EQ( Scene::CHANGE_ADDED, added.m_kind );
+    EXPECT_EQ( c, added.m_object );
+    EXPECT_EQ( c->Identifiable::id(), added.m_identity );
+    EXPECT_NE( b_identity, added.m_identity );
+    EXPECT_EQ( Scene::CHANGE_VALUE, changes.back().m_kind );
+}
+
+TEST( LibraryJournal, Overflow )
+{
+    Scene::DataBase database;
+    database.setJournalCapacity( 4 );
+    Scene::Library<Scene::Light>& lights = database.library<Scene::Light>();
+    Scene::Light* light = lights.add( "light" );
+
+    Scene::SeqPos seen;
+    seen.touch();
+    for( int i=0; i<3; i++ ) {
+        light->setColor( float(i), 0.f, 0.f );
+    }
+    std::vector<LightChange> changes;
+    ASSERT_TRUE( lights.changesSince( changes, seen ) );
+    EXPECT_EQ( 3u, changes.size() );
+
+    // Older changes are dropped, so a consumer that is too far behind must
+    // examine every object.
+    for( int i=0; i<3; i++ ) {
+        light->setColor( 0.f, float(i), 0.f );
+    }
+    changes.clear();
+    EXPECT_FALSE( lights.changesSince( changes, seen ) );
+
+    // But a consumer that is recent enough still gets its changes.
+    Scene::SeqPos recent;
+    recent.touch();
+    light->setColor( 0.f, 0.f, 1.f );
+    ASSERT_TRUE( lights.changesSince( changes, recent ) );
+    EXPECT_EQ( 1u, changes.size() );
+
+    // Clearing a library drops the journal.
+    recent.touch();
+    lights.clear();
+    changes.clear();
+    EXPECT_FALSE( lights.changesSince( changes, recent ) );
+}
+
+TEST( LibraryJournal, UpdateBoundingBoxes )
+{
+    Scene::DataBase database;
+    std::vector<float> positions = { 0.f, 0.f, 0.f,  1.f, 0.f, 0.f,  0.f, 2.f, 0.f };
+    database.library<Scene::SourceBuffer>().add( "positions" )->contents( positions );
+
+    Scene::Geometry* geometry = database.library<Scene::Geometry>().add( "triangle" );
+    geometry->setVertexSource( Scene::VERTEX_POSITION, "positions", 3, 3 );
+    geometry->addPrimitiveSet()->set( Scene::PRIMITIVE_TRIANGLES, 1, 3 );
+
+    Scene::SeqPos updated;
+    Scene::Tools::updateBoundingBoxes( database, updated );
+    const Scene::Value* bbmin;
+    const Scene::Value* bbmax;
+    ASSERT_TRUE( geometry->boundingBox( bbmin, bbmax ) );
+    EXPECT_FLOAT_EQ( 2.f, bbmax->floatData()[1] );
+
+    // A geometry added afterwards is picked up from the journal.
+    Scene::Geometry* other = database.library<Scene::Geometry>().add( "other" );
+    other->setVertexSource( Scene::VERTEX_POSITION, "positions", 3, 2 );
+    other->addPrimitiveSet()->set( Scene::PRIMITIVE_LINES, 1, 2 );
+    Scene::Tools::updateBoundingBoxes( database, updated );
+    ASSERT_TRUE( other->boundingBox( bbmin, bbmax ) );
+    EXPECT_FLOAT_EQ( 1.f, bbmax->floatData()[0] );
+    EXPECT_FLOAT_EQ( 0.f, bbmax->floatData()[1] );
+
+    // Changed buffer contents update the geometries that use them.
+    positions[7] = 4.f;
+    database.library<Scene::SourceBuffer>().get( "positions" )->contents( positions );
+    Scene::Tools::updateBoundingBoxes( database, updated );
+    ASSERT_TRUE( geometry->boundingBox( bbmin, bbmax ) );
+    EXPECT_FLOAT_EQ( 4.f, bbmax->floatData()[1] );
+}
@@ -0,0 +1,105 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <scene/tools/NumberParser.hpp>
+
+static void
+expectSameAsStrtof( const std::string& text )
+{
+    std::vector<float> expected;
+    const char* a = text.c_str();
+    while( 1 ) {
+        char* b = NULL;
+        float v = strtof( a, &b );
+        if( a == b ) {
+            break;
+        }
+        expected.push_back( v );
+        a = b;
+    }
+    std::vector<float> result( expected.size() + 1 );
+    const size_t n = Scene::Tools::parseFloats( result.data(), result.size(),
+                                                text.c_str(), text.c_str() + text.size() );
+    ASSERT_EQ( expected.size(), n ) << text;
+    for( size_t i=0; i<n; i++ ) {
+        EXPECT_EQ( 0, std::memcmp( &expected[i], &result[i], sizeof(float) ) )
+                << "element " << i << ": " << expected[i] << " != " << result[i];
+    }
+}
+
+TEST( NumberParser, FloatsMatchStrtof )
+{
+    expectSameAsStrtof( "0 -0 1 -1 +2.5 .5 5. 1e3 1E-3 -1.25e+2 007 0.000001 123456789" );
+    expectSameAsStrtof( "3.4028235e38 1.17549435e-38 1e-40 1e39 inf -INF nan" );
+    expectSameAsStrtof( "0.1 0.2 0.3 16777217 33554431 1234567890123456789012 0x1p3" );
+    expectSameAsStrtof( "\t\n  1.5\r\n\t                                        2.5   " );
+    expectSameAsStrtof( "1e 2" );
+
+    // Random numbers in the formats written by common exporters.
+    std::string text;
+    unsigned int state = 42;
+    char buffer[64];
+    for( unsigned int i=0; i<20000; i++ ) {
+        state = 1664525u*state + 1013904223u;
+        const float v = (static_cast<float>( state>>8 ) / (1<<24) - 0.5f) * std::pow( 10.f, static_cast<float>( (state & 0xf) ) - 8.f );
+        switch( i % 3 ) {
+        case 0: snprintf( buffer, sizeof(buffer), "%g ", v ); break;
+        case 1: snprintf( buffer, sizeof(buffer), "%.9g\n", v ); break;
+        default: snprintf( buffer, sizeof(buffer), "%f ", v ); break;
+        }
+        text += buffer;
+    }
+    expectSameAsStrtof( text );
+}
+
+TEST( NumberParser, Ints )
+{
+    const std::string text = " 1 -2 +3 0 010 0x1f 2147483647 -2147483648 12345678901 ";
+    std::vector<int> result( 9 );
+    ASSERT_EQ( 9u, Scene::Tools::parseInts( result.data(), 9, text.c_str(), text.c_str() + text.size() ) );
+    const char* a = text.c_str();
+    for( size_t i=0; i<9; i++ ) {
+        char* b = NULL;
+        EXPECT_EQ( static_cast<int>( strtol( a, &b, 0 ) ), result[i] ) << i;
+        a = b;
+    }
+
+    // Offset and stride.
+    const std::string tuples = "0 1 2 3 4 5 6 7 8";
+    std::vector<int> strided( 3 );
+    ASSERT_EQ( 3u, Scene::Tools::parseInts( strided.data(), 3, tuples.c_str(), tuples.c_str() + tuples.size(), 0, 3 ) );
+    EXPECT_EQ( 0, strided[0] );
+    EXPECT_EQ( 3, strided[1] );
+    EXPECT_EQ( 6, strided[2] );
+    ASSERT_EQ( 2u, Scene::Tools::parseInts( strided.data(), 2, tuples.c_str(), tuples.c_str() + tuples.size(), 1, 3 ) );
+    EXPECT_EQ( 1, strided[0] );
+    EXPECT_EQ( 4, strided[1] );
+    // The stride of the last int must also be present.
+    EXPECT_EQ( 2u, Scene::Tools::parseInts( strided.data(), 3, tuples.c_str(), tuples.c_str() + tuples.size(), 1, 3 ) );
+
+    // Premature end and garbage.
+    EXPECT_EQ( 2u, Scene::Tools::parseInts( result.data(), 3, "1 2", "1 2" + 3 ) );
+    EXPECT_EQ( 1u, Scene::Tools::parseInts( result.data(), 3, "1 x 2", "1 x 2" + 5 ) );
+}
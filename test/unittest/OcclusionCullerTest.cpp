@@ -0,0 +1,181 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <scene/DataBase.hpp>
+#include <scene/Geometry.hpp>
+#include <scene/Primitives.hpp>
+#include <scene/SourceBuffer.hpp>
+#include <scene/Value.hpp>
+#include <scene/runtime/BoundingVolumeHierarchy.hpp>
+#include <scene/runtime/OcclusionCuller.hpp>
+
+namespace {
+
+Scene::Value
+placement( float s, float x, float y, float z )
+{
+    return Scene::Value::createFloat4x4( s,   0.f, 0.f, x,
+                                         0.f, s,   0.f, y,
+                                         0.f, 0.f, s,   z,
+                                         0.f, 0.f, 0.f, 1.f );
+}
+
+Scene::Value
+perspective( float fovy, float aspect, float near, float far )
+{
+    const float f = 1.f/std::tan( 0.5f*fovy );
+    return Scene::Value::createFloat4x4( f/aspect, 0.f, 0.f,                     0.f,
+                                         0.f,      f,   0.f,                     0.f,
+                                         0.f,      0.f, (far+near)/(near-far),   2.f*far*near/(near-far),
+                                         0.f,      0.f, -1.f,                    0.f );
+}
+
+// Indexed triangles over a set of positions, with a bounding box.
+Scene::Geometry*
+addGeometry( Scene::DataBase& db, const std::string& id,
+             const std::vector<float>& positions, const std::vector<int>& indices )
+{
+    Scene::Library<Scene::SourceBuffer>& buffers = db.library<Scene::SourceBuffer>();
+    buffers.add( id + "_positions" )->contents( positions );
+    buffers.add( id + "_indices" )->contents( indices );
+
+    Scene::Geometry* geometry = db.library<Scene::Geometry>().add( id );
+    geometry->setVertexSource( Scene::VERTEX_POSITION, id + "_positions", 3, int( positions.size()/3 ), 3, 0 );
+    Scene::Primitives* primitives = geometry->addPrimitiveSet();
+    primitives->set( Scene::PRIMITIVE_TRIANGLES, unsigned( indices.size()/3 ), 3, id + "_indices", 0 );
+
+    float bbmin[3] = { 1e30f, 1e30f, 1e30f };
+    float bbmax[3] = { -1e30f, -1e30f, -1e30f };
+    for( size_t i=0; i<positions.size(); i++ ) {
+        bbmin[i%3] = std::min( bbmin[i%3], positions[i] );
+        bbmax[i%3] = std::max( bbmax[i%3], positions[i] );
+    }
+    geometry->setBoundingBox( Scene::Value::createFloat4( bbmin[0], bbmin[1], bbmin[2], 1.f ),
+                              Scene::Value::createFloat4( bbmax[0], bbmax[1], bbmax[2], 1.f ) );
+    return geometry;
+}
+
+class OcclusionCullerTest : public ::testing::Test
+{
+protected:
+    Scene::DataBase             m_db;
+    Scene::Value                m_clip;
+    std::vector<Scene::Value>   m_transforms;
+    Scene::Geometry*            m_wall;
+    Scene::Geometry*            m_box;
+
+    void
+    SetUp()
+    {
+        m_clip = perspective( 1.f, 2.f, 0.1f, 100.f );
+
+        // A unit square in the xy-plane and a unit cube, both centered.
+        const float wall_positions[] = { -1.f, -1.f, 0.f,   1.f, -1.f, 0.f,   1.f, 1.f, 0.f,   -1.f, 1.f, 0.f };
+        const int wall_indices[] = { 0, 1, 2,   0, 2, 3 };
+        m_wall = addGeometry( m_db, "wall",
+                              std::vector<float>( wall_positions, wall_positions + 12 ),
+                              std::vector<int>( wall_indices, wall_indices + 6 ) );
+        std::vector<float> box_positions;
+        for( unsigned int c=0; c<8; c++ ) {
+            box_positions.push_back( (c&1) ? 0.5f : -0.5f );
+            box_positions.push_back( (c&2) ? 0.5f : -0.5f );
+            box_positions.push_back( (c&4) ? 0.5f : -0.5f );
+        }
+        const int box_indices[] = { 0, 2, 1,  1, 2, 3,  4, 5, 6,  5, 7, 6,
+                                    0, 1, 4,  1, 5, 4,  2, 6, 3,  3, 6, 7,
+                                    0, 4, 2,  2, 4, 6,  1, 3, 5,  3, 7, 5 };
+        m_box = addGeometry( m_db, "box", box_positions, std::vector<int>( box_indices, box_indices + 36 ) );
+        m_transforms.reserve( 4096 );
+    }
+
+    size_t
+    add( Scene::Runtime::BoundingVolumeHierarchy& bvh,
+         Scene::Runtime::OcclusionCuller& culler,
+         const Scene::Geometry* geometry, const Scene::Value& transform )
+    {
+        m_transforms.push_back( transform );
+        const Scene::Value* bbmin = NULL;
+        const Scene::Value* bbmax = NULL;
+        geometry->boundingBox( bbmin, bbmax );
+        bvh.add( &m_clip, &m_transforms.back(), bbmin, bbmax );
+        return culler.add( &m_clip, &m_transforms.back(), geometry, geometry->primitives( 0 ) );
+    }
+};
+
+} // of anonymous namespace
+
+TEST_F( OcclusionCullerTest, CullsItemsBehindOccluder )
+{
+    Scene::Runtime::BoundingVolumeHierarchy bvh;
+    Scene::Runtime::OcclusionCuller culler( m_db );
+    const size_t wall = add( bvh, culler, m_wall, placement( 3.f, 0.f, 0.f, -5.f ) );
+    const size_t behind = add( bvh, culler, m_box, placement( 1.f, 0.f, 0.f, -10.f ) );
+    const size_t beside = add( bvh, culler, m_box, placement( 1.f, 8.f, 0.f, -10.f ) );
+    const size_t front = add( bvh, culler, m_box, placement( 1.f, 0.f, 0.f, -3.f ) );
+    const size_t eye = add( bvh, culler, m_box, placement( 1.f, 0.f, 0.f, 0.f ) );
+    const size_t back = add( bvh, culler, m_box, placement( 1.f, 0.f, 0.f, 20.f ) );
+
+    bvh.update();
+    culler.update( &bvh );
+    EXPECT_TRUE( culler.visible( wall ) );
+    EXPECT_FALSE( culler.visible( behind ) );
+    EXPECT_TRUE( culler.visible( beside ) );
+    EXPECT_TRUE( culler.visible( front ) );
+    EXPECT_TRUE( culler.visible( eye ) );       // crosses the near plane.
+    EXPECT_FALSE( culler.visible( back ) );     // culled by the frustum.
+    EXPECT_EQ( 4u, culler.visibleItems() );
+    EXPECT_EQ( 1u, culler.culledItems() );
+    EXPECT_GE( culler.lastOccluders(), 1u );
+
+    // Without occluders, nothing is culled by occlusion.
+    culler.setMaxOccluders( 0 );
+    culler.update( &bvh );
+    EXPECT_TRUE( culler.visible( behind ) );
+    EXPECT_EQ( 0u, culler.culledItems() );
+}
+
+TEST_F( OcclusionCullerTest, ThreadedMatchesSerial )
+{
+    Scene::Runtime::BoundingVolumeHierarchy bvh;
+    Scene::Runtime::OcclusionCuller culler( m_db );
+    add( bvh, culler, m_wall, placement( 4.f, 0.f, 0.f, -8.f ) );
+    for( size_t i=0; i<2000; i++ ) {
+        add( bvh, culler, m_box, placement( 0.2f, 0.4f*(i%50) - 10.f, 0.4f*(i/50) - 8.f, -20.f ) );
+    }
+    bvh.update();
+
+    culler.setThreads( 1 );
+    culler.update( &bvh );
+    std::vector<bool> serial;
+    for( size_t i=0; i<culler.items(); i++ ) {
+        serial.push_back( culler.visible( i ) );
+    }
+    EXPECT_LT( 0u, culler.culledItems() );
+
+    culler.setThreads( 4 );
+    culler.update( &bvh );
+    size_t mismatches = 0;
+    for( size_t i=0; i<culler.items(); i++ ) {
+        mismatches += serial[i] != culler.visible( i ) ? 1 : 0;
+    }
+    EXPECT_EQ( 0u, mismatches );
+}
@@ -0,0 +1,81 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <thread>
+#include <gtest/gtest.h>
+#include <scene/Profiler.hpp>
+
+TEST( Profiler, RecordsScopesAndCounters )
+{
+    Scene::Profiler& profiler = Scene::Profiler::instance();
+    profiler.clear();
+    profiler.setEnabled( true );
+
+    Scene::Profiler::Counter* hits = profiler.counter( "ProfilerTest.hits" );
+    for( int i=0; i<3; i++ ) {
+        Scene::ProfileScope scope( "ProfilerTest.scope" );
+        hits->add( 2 );
+    }
+    std::thread worker( [&]() {
+        Scene::ProfileScope scope( "ProfilerTest.worker" );
+        hits->add( 1 );
+    } );
+    worker.join();
+
+    profiler.setEnabled( false );
+    {
+        Scene::ProfileScope scope( "ProfilerTest.disabled" );
+    }
+
+    EXPECT_EQ( 7, profiler.counterValue( "ProfilerTest.hits" ) );
+    EXPECT_EQ( 0, profiler.counterValue( "ProfilerTest.nonexistent" ) );
+
+    std::map<std::string,Scene::Profiler::Timing> timings = profiler.timings();
+    ASSERT_EQ( 1u, timings.count( "ProfilerTest.scope" ) );
+    EXPECT_EQ( 3u, timings[ "ProfilerTest.scope" ].m_calls );
+    EXPECT_LE( timings[ "ProfilerTest.scope" ].m_max, timings[ "ProfilerTest.scope" ].m_total );
+    EXPECT_EQ( 1u, timings.count( "ProfilerTest.worker" ) );
+    EXPECT_EQ( 0u, timings.count( "ProfilerTest.disabled" ) );
+
+    std::ostringstream trace;
+    profiler.writeChromeTrace( trace );
+    EXPECT_NE( std::string::npos, trace.str().find( "\"traceEvents\"" ) );
+    EXPECT_NE( std::string::npos, trace.str().find( "ProfilerTest.worker" ) );
+    EXPECT_NE( std::string::npos, trace.str().find( "ProfilerTest.hits" ) );
+
+    profiler.clear();
+    EXPECT_TRUE( profiler.events().empty() );
+    EXPECT_EQ( 0, hits->value() );
+}
+
+TEST( Profiler, DropsEventsBeyondLimit )
+{
+    Scene::Profiler& profiler = Scene::Profiler::instance();
+    profiler.clear();
+    profiler.setEventLimit( 2 );
+    profiler.setEnabled( true );
+    for( int i=0; i<5; i++ ) {
+        Scene::ProfileScope scope( "ProfilerTest.limited" );
+    }
+    profiler.setEnabled( false );
+    EXPECT_EQ( 2u, profiler.events().size() );
+    EXPECT_EQ( 3u, profiler.droppedEvents() );
+    profiler.setEventLimit( 1u<<20 );
+    profiler.clear();
+}
@@ -0,0 +1,376 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <scene/DataBase.hpp>
+#include <scene/InstanceGeometry.hpp>
+#include <scene/Material.hpp>
+#include <scene/VisualScene.hpp>
+#include <scene/collada/Importer.hpp>
+#include <scene/runtime/Resolver.hpp>
+#include <scene/runtime/RenderList.hpp>
+
+namespace {
+
+std::string
+instanceGeometry()
+{
+    return "<instance_geometry url=\"#geo\"><bind_material><technique_common>"
+           "<instance_material symbol=\"default\" target=\"#mat\"/>"
+           "</technique_common></bind_material></instance_geometry>";
+}
+
+// A group of 8 subgroups of 5 leaves each, where subgroup 2 also instances a
+// shared node, 3 and 5 are in layer 'hidden' and 6 is in layer 'other'. The
+// scene is rendered twice, the second time only layer 'hidden'.
+std::string
+hierarchyCollada()
+{
+    std::string nodes;
+    for( int g=0; g<8; g++ ) {
+        const std::string id = "g" + std::to_string( g );
+        std::string layer;
+        if( (g == 3) || (g == 5) ) {
+            layer = " layer=\"hidden\"";
+        }
+        else if( g == 6 ) {
+            layer = " layer=\"other\"";
+        }
+        nodes += "<node id=\"" + id + "\"" + layer + "><translate>" + std::to_string( g ) + " 0 0</translate>";
+        if( g == 2 ) {
+            nodes += "<instance_node url=\"#shared\"/>";
+        }
+        for( int l=0; l<5; l++ ) {
+            nodes += "<node id=\"" + id + "_" + std::to_string( l ) + "\"><translate>0 " + std::to_string( l ) + " 0</translate>" +
+                     instanceGeometry() + "</node>";
+        }
+        nodes += "</node>\n";
+    }
+    return
+        "<?xml version=\"1.0\"?>\n"
+        "<COLLADA>\n"
+        "  <library_geometries>\n"
+        "    <geometry id=\"geo\"><mesh>\n"
+        "      <source id=\"pos\"><float_array id=\"pos_array\" count=\"9\">0 0 0 1 0 0 0 1 0</float_array>\n"
+        "        <technique_common><accessor source=\"#pos_array\" count=\"3\" stride=\"3\">\n"
+        "          <param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/><param name=\"Z\" type=\"float\"/>\n"
+        "        </accessor></technique_common></source>\n"
+        "      <vertices id=\"geo_vertices\"><input semantic=\"POSITION\" source=\"#pos\"/></vertices>\n"
+        "      <triangles count=\"1\" material=\"default\"/>\n"
+        "    </mesh></geometry>\n"
+        "  </library_geometries>\n"
+        "  <library_effects>\n"
+        "    <effect id=\"effect\">\n"
+        "      <profile_GLSL><technique sid=\"default\"><pass>\n"
+        "        <program>\n"
+        "          <shader stage=\"VERTEX\"><sources><inline>attribute vec3 position; void main() { gl_Position = vec4(position,1.0); }</inline></sources></shader>\n"
+        "          <shader stage=\"FRAGMENT\"><sources><inline>void main() { gl_FragColor = vec4(1.0); }</inline></sources></shader>\n"
+        "          <bind_attribute symbol=\"position\"><semantic>POSITION</semantic></bind_attribute>\n"
+        "        </program>\n"
+        "      </pass></technique></profile_GLSL>\n"
+        "    </effect>\n"
+        "  </library_effects>\n"
+        "  <library_materials>\n"
+        "    <material id=\"mat\"><instance_effect url=\"#effect\"/></material>\n"
+        "  </library_materials>\n"
+        "  <library_nodes>\n"
+        "    <node id=\"shared\">" + instanceGeometry() + "</node>\n"
+        "  </library_nodes>\n"
+        "  <library_visual_scenes>\n"
+        "    <visual_scene id=\"scene\">\n"
+        "      <node id=\"group\">\n" + nodes + "      </node>\n"
+        "      <evaluate_scene><render/><render><layer>hidden</layer></render></evaluate_scene>\n"
+        "    </visual_scene>\n"
+        "  </library_visual_scenes>\n"
+        "</COLLADA>\n";
+}
+
+typedef Scene::Runtime::RenderList::Item Item;
+
+std::vector<Item>
+items( const Scene::Runtime::RenderList& list )
+{
+    std::vector<Item> result;
+    for( size_t i=0; i<list.items(); i++ ) {
+        result.push_back( list.item( i ) );
+    }
+    return result;
+}
+
+Scene::Node*
+addLeaf( Scene::DataBase& db, const std::string& id, const std::string& parent )
+{
+    Scene::Node* leaf = db.library<Scene::Node>().add( id );
+    leaf->setParent( db.library<Scene::Node>().get( parent ) );
+    Scene::InstanceGeometry* instance = new Scene::InstanceGeometry( "geo" );
+    instance->addMaterialBinding( "default", "mat" );
+    leaf->add( instance );
+    return leaf;
+}
+
+// Check that a patched list is the same as a list built from scratch, and
+// that the items it kept are the same as before.
+void
+expectSameAsRebuilt( const Scene::DataBase& db,
+                     const Scene::Runtime::RenderList& list,
+                     const std::vector<Item>& before )
+{
+    Scene::Runtime::Resolver fresh_resolver( db, Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList fresh( fresh_resolver );
+    ASSERT_TRUE( fresh.build( "scene" ) );
+    ASSERT_EQ( fresh.items(), list.items() );
+    ASSERT_EQ( fresh.size(), list.size() );
+    for( size_t i=0; i<fresh.size(); i++ ) {
+        ASSERT_EQ( fresh[i]->m_type, list[i]->m_type );
+    }
+    for( size_t i=0; i<fresh.items(); i++ ) {
+        const Item& a = fresh.item( i );
+        const Item& b = list.item( i );
+        for( size_t k=0; k<SCENE_PATH_MAX; k++ ) {
+            ASSERT_EQ( a.m_set_local_coordsys->m_node_path[k], b.m_set_local_coordsys->m_node_path[k] );
+        }
+        ASSERT_EQ( a.m_set_pass->m_pass, b.m_set_pass->m_pass );
+        ASSERT_EQ( a.m_set_inputs->m_primitives, b.m_set_inputs->m_primitives );
+
+        const size_t p = list.previousIndex( i );
+        if( p != Scene::Runtime::RenderList::npos ) {
+            ASSERT_LT( p, before.size() );
+            EXPECT_EQ( before[p].m_set_local_coordsys, b.m_set_local_coordsys );
+            EXPECT_EQ( before[p].m_set_view_coordsys, b.m_set_view_coordsys );
+            EXPECT_EQ( before[p].m_draw, b.m_draw );
+        }
+    }
+}
+
+} // of anonymous namespace
+
+TEST( RenderList, ThreadedRebuildMatchesSerial )
+{
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parseMemory( hierarchyCollada().c_str() ) );
+
+    Scene::Runtime::Resolver serial_resolver( db, Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList serial( serial_resolver );
+    serial.setThreads( 1 );
+    ASSERT_TRUE( serial.build( "scene" ) );
+
+    Scene::Runtime::Resolver threaded_resolver( db, Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList threaded( threaded_resolver );
+    threaded.setThreads( 4 );
+    ASSERT_TRUE( threaded.build( "scene" ) );
+
+    // 41 leaves and shared in the first render, all but subgroup 6 in the second.
+    EXPECT_EQ( 41u + 36u, serial.items() );
+    ASSERT_EQ( serial.items(), threaded.items() );
+    ASSERT_EQ( serial.size(), threaded.size() );
+    for( size_t i=0; i<serial.size(); i++ ) {
+        ASSERT_EQ( serial[i]->m_type, threaded[i]->m_type );
+    }
+    for( size_t i=0; i<serial.items(); i++ ) {
+        const Scene::Runtime::RenderList::Item& a = serial.item( i );
+        const Scene::Runtime::RenderList::Item& b = threaded.item( i );
+        for( size_t k=0; k<SCENE_PATH_MAX; k++ ) {
+            EXPECT_EQ( a.m_set_local_coordsys->m_node_path[k], b.m_set_local_coordsys->m_node_path[k] );
+        }
+        EXPECT_EQ( a.m_set_pass->m_pass, b.m_set_pass->m_pass );
+        EXPECT_EQ( a.m_set_inputs->m_primitives, b.m_set_inputs->m_primitives );
+    }
+
+    // Paths are the root and the node, with the instancer and the instancee
+    // in between for the shared node.
+    size_t instanced = 0;
+    for( size_t i=0; i<serial.items(); i++ ) {
+        const Scene::Node* const* path = serial.item( i ).m_set_local_coordsys->m_node_path;
+        EXPECT_TRUE( path[1] != NULL );
+        if( (path[2] != NULL) && (path[3] != NULL) && (path[4] == NULL) ) {
+            instanced++;
+        }
+    }
+    EXPECT_EQ( 2u, instanced );
+}
+
+TEST( RenderList, PatchMatchesRebuild )
+{
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parseMemory( hierarchyCollada().c_str() ) );
+
+    Scene::Runtime::Resolver resolver( db, Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList list( resolver );
+    list.setThreads( 1 );
+    ASSERT_TRUE( list.build( "scene" ) );
+    EXPECT_FALSE( list.patched() );
+    EXPECT_FALSE( list.build( "scene" ) );
+
+    std::vector<Scene::Runtime::RenderList::Item> before;
+    for( size_t i=0; i<list.items(); i++ ) {
+        before.push_back( list.item( i ) );
+    }
+
+    // Add a leaf to subgroup 1, which is in both renders.
+    Scene::Node* leaf = addLeaf( db, "g1_5", "g1" );
+
+    ASSERT_TRUE( list.build( "scene" ) );
+    EXPECT_TRUE( list.patched() );
+    ASSERT_EQ( before.size() + 2u, list.items() );
+
+    // Only subgroup 1 is traversed again, in both renders.
+    EXPECT_EQ( 2u*6u, list.traversedItems() );
+
+    // All items but the new one are retained, with the same actions.
+    size_t added = 0;
+    std::vector<bool> matched( before.size(), false );
+    for( size_t i=0; i<list.items(); i++ ) {
+        const size_t p = list.previousIndex( i );
+        if( p == Scene::Runtime::RenderList::npos ) {
+            added++;
+            const Scene::Node* const* path = list.item( i ).m_set_local_coordsys->m_node_path;
+            EXPECT_TRUE( std::find( path, path + SCENE_PATH_MAX, leaf ) != path + SCENE_PATH_MAX );
+            continue;
+        }
+        ASSERT_LT( p, before.size() );
+        EXPECT_FALSE( matched[p] );
+        matched[p] = true;
+        EXPECT_EQ( before[p].m_set_local_coordsys, list.item( i ).m_set_local_coordsys );
+        EXPECT_EQ( before[p].m_set_view_coordsys, list.item( i ).m_set_view_coordsys );
+        EXPECT_EQ( before[p].m_draw, list.item( i ).m_draw );
+    }
+    EXPECT_EQ( 2u, added );
+
+    // The patched list is the same as a list built from scratch.
+    Scene::Runtime::Resolver fresh_resolver( db, Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList fresh( fresh_resolver );
+    ASSERT_TRUE( fresh.build( "scene" ) );
+    ASSERT_EQ( fresh.items(), list.items() );
+    ASSERT_EQ( fresh.size(), list.size() );
+    for( size_t i=0; i<fresh.size(); i++ ) {
+        ASSERT_EQ( fresh[i]->m_type, list[i]->m_type );
+    }
+    for( size_t i=0; i<fresh.items(); i++ ) {
+        for( size_t k=0; k<SCENE_PATH_MAX; k++ ) {
+            EXPECT_EQ( fresh.item( i ).m_set_local_coordsys->m_node_path[k],
+                       list.item( i ).m_set_local_coordsys->m_node_path[k] );
+        }
+    }
+
+    // Deleting objects forces a rebuild.
+    db.library<Scene::Node>().remove( leaf );
+    ASSERT_TRUE( list.build( "scene" ) );
+    EXPECT_FALSE( list.patched() );
+    EXPECT_EQ( before.size(), list.items() );
+}
+
+TEST( RenderList, StaleActionsAreRecycled )
+{
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parseMemory( hierarchyCollada().c_str() ) );
+
+    Scene::Runtime::Resolver resolver( db, Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList list( resolver );
+    list.setThreads( 1 );
+    ASSERT_TRUE( list.build( "scene" ) );
+
+    // Structural changes of the material invalidate its uniforms, the stale
+    // actions must be reused instead of piling up in the arena.
+    Scene::Material* material = db.library<Scene::Material>().get( "mat" );
+    ASSERT_TRUE( material != NULL );
+    material->setEffectId( material->effectId() );
+    ASSERT_TRUE( list.build( "scene" ) );
+    const size_t in_use = resolver.arena().bytesInUse();
+    const size_t reserved = resolver.arena().bytesReserved();
+    for( int i=0; i<100; i++ ) {
+        material->setEffectId( material->effectId() );
+        ASSERT_TRUE( list.build( "scene" ) );
+        EXPECT_EQ( in_use, resolver.arena().bytesInUse() );
+    }
+    EXPECT_EQ( reserved, resolver.arena().bytesReserved() );
+}
+
+TEST( RenderList, PatchFromJournal )
+{
+    for( size_t threads=1; threads<=4; threads+=3 ) {
+        Scene::DataBase db;
+        Scene::Collada::Importer importer( db );
+        ASSERT_TRUE( importer.parseMemory( hierarchyCollada().c_str() ) );
+        Scene::Library<Scene::Node>& nodes = db.library<Scene::Node>();
+
+        Scene::Runtime::Resolver resolver( db, Scene::PROFILE_GLSL );
+        Scene::Runtime::RenderList list( resolver );
+        list.setThreads( threads );
+        ASSERT_TRUE( list.build( "scene" ) );
+        EXPECT_EQ( list.items(), list.traversedItems() );
+
+        // Move a leaf to another subgroup, both are traversed again.
+        std::vector<Item> before = items( list );
+        nodes.get( "g0_0" )->setParent( nodes.get( "g4" ) );
+        ASSERT_TRUE( list.build( "scene" ) );
+        EXPECT_TRUE( list.patched() );
+        EXPECT_EQ( 2u*(4u+6u), list.traversedItems() );
+        expectSameAsRebuilt( db, list, before );
+
+        // A subgroup that is added to the layer of the second render.
+        before = items( list );
+        nodes.get( "g6" )->addToLayer( "hidden" );
+        ASSERT_TRUE( list.build( "scene" ) );
+        EXPECT_TRUE( list.patched() );
+        EXPECT_EQ( 2u*5u, list.traversedItems() );
+        expectSameAsRebuilt( db, list, before );
+
+        // A new child of the root is traversed, the rest is kept.
+        const std::string root_id = db.library<Scene::VisualScene>().get( "scene" )->nodesId();
+        before = items( list );
+        nodes.add( "extra" )->setParent( nodes.get( root_id ) );
+        addLeaf( db, "extra_0", "extra" );
+        ASSERT_TRUE( list.build( "scene" ) );
+        EXPECT_TRUE( list.patched() );
+        EXPECT_EQ( 2u, list.traversedItems() );
+        expectSameAsRebuilt( db, list, before );
+
+        // And so is a child of the root that is moved into a subgroup.
+        before = items( list );
+        nodes.get( "extra" )->setParent( nodes.get( "g7" ) );
+        ASSERT_TRUE( list.build( "scene" ) );
+        EXPECT_TRUE( list.patched() );
+        EXPECT_EQ( 2u*6u, list.traversedItems() );
+        expectSameAsRebuilt( db, list, before );
+
+        // A node that is instanced can't be patched from the journal, and
+        // everything is traversed.
+        before = items( list );
+        addLeaf( db, "shared_0", "shared" );
+        ASSERT_TRUE( list.build( "scene" ) );
+        EXPECT_TRUE( list.patched() );
+        EXPECT_EQ( list.items(), list.traversedItems() );
+        expectSameAsRebuilt( db, list, before );
+
+        // And neither can changes to objects the items refer to.
+        before = items( list );
+        Scene::Material* material = db.library<Scene::Material>().get( "mat" );
+        material->setEffectId( material->effectId() );
+        ASSERT_TRUE( list.build( "scene" ) );
+        EXPECT_TRUE( list.patched() );
+        EXPECT_EQ( list.items(), list.traversedItems() );
+        expectSameAsRebuilt( db, list, before );
+    }
+}
@@ -0,0 +1,154 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+
+#include <scene/DataBase.hpp>
+#include <scene/Geometry.hpp>
+#include <scene/Image.hpp>
+#include <scene/Effect.hpp>
+#include <scene/Material.hpp>
+#include <scene/Node.hpp>
+#include <scene/SourceBuffer.hpp>
+#include <scene/VisualScene.hpp>
+#include <scene/tools/BBoxTool.hpp>
+#include <scene/collada/Importer.hpp>
+#include <scene/collada/Snapshot.hpp>
+
+class Snapshot : public ::testing::TestWithParam<const char*>
+{
+};
+
+TEST_P( Snapshot, RoundTrip )
+{
+    const std::string path = "scene_unit_snapshot.bin";
+
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parse( GetParam() ) );
+    for( size_t i=0; i<db.library<Scene::Geometry>().size(); i++ ) {
+        db.library<Scene::Geometry>().get( i )->flatten();
+    }
+    Scene::Tools::updateBoundingBoxes( db );
+    ASSERT_TRUE( Scene::Collada::writeSnapshot( db, path ) );
+
+    Scene::DataBase snap_db;
+    ASSERT_TRUE( Scene::Collada::readSnapshot( snap_db, path ) );
+    std::remove( path.c_str() );    // the mapping stays valid
+
+    EXPECT_EQ( db.library<Scene::Effect>().size(), snap_db.library<Scene::Effect>().size() );
+    EXPECT_EQ( db.library<Scene::Material>().size(), snap_db.library<Scene::Material>().size() );
+    EXPECT_EQ( db.library<Scene::Node>().size(), snap_db.library<Scene::Node>().size() );
+    EXPECT_EQ( db.library<Scene::VisualScene>().size(), snap_db.library<Scene::VisualScene>().size() );
+
+    const Scene::Library<Scene::SourceBuffer>& buffers = db.library<Scene::SourceBuffer>();
+    ASSERT_EQ( buffers.size(), snap_db.library<Scene::SourceBuffer>().size() );
+    for( size_t i=0; i<buffers.size(); i++ ) {
+        const Scene::SourceBuffer* a = buffers.get( i );
+        const Scene::SourceBuffer* b = snap_db.library<Scene::SourceBuffer>().get( i );
+        ASSERT_EQ( a->id(), b->id() );
+        ASSERT_EQ( a->elementType(), b->elementType() );
+        ASSERT_EQ( a->elementCount(), b->elementCount() );
+        EXPECT_EQ( 0, std::memcmp( a->voidData(), b->voidData(), 4*a->elementCount() ) ) << a->id();
+    }
+
+    const Scene::Library<Scene::Image>& images = db.library<Scene::Image>();
+    ASSERT_EQ( images.size(), snap_db.library<Scene::Image>().size() );
+    for( size_t i=0; i<images.size(); i++ ) {
+        const Scene::Image* a = images.get( i );
+        const Scene::Image* b = snap_db.library<Scene::Image>().get( i );
+        ASSERT_EQ( a->id(), b->id() );
+        ASSERT_EQ( a->width(), b->width() );
+        ASSERT_EQ( a->height(), b->height() );
+        ASSERT_EQ( a->dataSize(), b->dataSize() );
+        EXPECT_EQ( 0, std::memcmp( a->get( 0, 0 ), b->get( 0, 0 ), a->dataSize() ) ) << a->id();
+    }
+
+    const Scene::Library<Scene::Geometry>& geometries = db.library<Scene::Geometry>();
+    ASSERT_EQ( geometries.size(), snap_db.library<Scene::Geometry>().size() );
+    for( size_t i=0; i<geometries.size(); i++ ) {
+        const Scene::Geometry* a = geometries.get( i );
+        const Scene::Geometry* b = snap_db.library<Scene::Geometry>().get( i );
+        ASSERT_EQ( a->id(), b->id() );
+        for( int s=0; s<Scene::VERTEX_SEMANTIC_N; s++ ) {
+            const Scene::Geometry::VertexInput& ai = a->vertexInput( (Scene::VertexSemantic)s );
+            const Scene::Geometry::VertexInput& bi = b->vertexInput( (Scene::VertexSemantic)s );
+            ASSERT_EQ( ai.m_enabled, bi.m_enabled );
+            if( ai.m_enabled ) {
+                EXPECT_EQ( ai.m_source_buffer_id, bi.m_source_buffer_id );
+                EXPECT_EQ( ai.m_components, bi.m_components );
+                EXPECT_EQ( ai.m_count, bi.m_count );
+                EXPECT_EQ( ai.m_offset, bi.m_offset );
+                EXPECT_EQ( ai.m_stride, bi.m_stride );
+            }
+        }
+        const Scene::Value *amin, *amax, *bmin, *bmax;
+        ASSERT_EQ( a->boundingBox( amin, amax ), b->boundingBox( bmin, bmax ) );
+        if( a->boundingBox( amin, amax ) ) {
+            EXPECT_EQ( 0, std::memcmp( amin->floatData(), bmin->floatData(), 4*sizeof(float) ) );
+            EXPECT_EQ( 0, std::memcmp( amax->floatData(), bmax->floatData(), 4*sizeof(float) ) );
+        }
+        ASSERT_EQ( a->primitiveSets(), b->primitiveSets() );
+        for( size_t j=0; j<a->primitiveSets(); j++ ) {
+            const Scene::Primitives* ap = a->primitives( j );
+            const Scene::Primitives* bp = b->primitives( j );
+            EXPECT_EQ( ap->primitiveType(), bp->primitiveType() );
+            EXPECT_EQ( ap->vertexCount(), bp->vertexCount() );
+            EXPECT_EQ( ap->materialSymbol(), bp->materialSymbol() );
+            EXPECT_EQ( ap->indexBufferId(), bp->indexBufferId() );
+            EXPECT_EQ( ap->indexOffset(), bp->indexOffset() );
+            EXPECT_EQ( ap->hasSharedInputs(), bp->hasSharedInputs() );
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P( Examples,
+                         Snapshot,
+                         ::testing::Values( "data/example1_wirecube.xml",
+                                            "data/example2_shaded_cube.xml",
+                                            "data/example3_textured_shaded_cube.xml",
+                                            "data/example4_profile_common.xml",
+                                            "data/example5_shared_inputs.xml",
+                                            "data/rubberducky.xml" ) );
+
+TEST( Snapshot, RejectsTruncatedFile )
+{
+    const std::string path = "scene_unit_snapshot_truncated.bin";
+
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parse( "data/example1_wirecube.xml" ) );
+    ASSERT_TRUE( Scene::Collada::writeSnapshot( db, path ) );
+
+    std::string contents;
+    {
+        std::ifstream in( path.c_str(), std::ios::binary );
+        contents.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+    }
+    {
+        std::ofstream out( path.c_str(), std::ios::binary | std::ios::trunc );
+        out.write( contents.data(), contents.size()/2 );
+    }
+    Scene::DataBase snap_db;
+    EXPECT_FALSE( Scene::Collada::readSnapshot( snap_db, path ) );
+    std::remove( path.c_str() );
+}
@@ -0,0 +1,97 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <scene/runtime/StreamRing.hpp>
+
+namespace {
+
+/** Backend that records calls instead of talking to GL. */
+class RecordingBackend : public Scene::Runtime::StreamRingBackend
+{
+public:
+    unsigned char*
+    map( size_t bytes )
+    {
+        m_calls.push_back( "map " + std::to_string( bytes ) );
+        m_memory.assign( bytes, 0 );
+        return m_memory.data();
+    }
+
+    void
+    flush( size_t offset, size_t bytes )
+    { m_calls.push_back( "flush " + std::to_string( offset ) + " " + std::to_string( bytes ) ); }
+
+    void
+    fence( size_t region )
+    { m_calls.push_back( "fence " + std::to_string( region ) ); }
+
+    void
+    wait( size_t region )
+    { m_calls.push_back( "wait " + std::to_string( region ) ); }
+
+    std::vector<std::string>    m_calls;
+    std::vector<unsigned char>  m_memory;
+};
+
+} // of anonymous namespace
+
+TEST( StreamRing, CyclesRegionsWithFences )
+{
+    using Scene::Runtime::StreamRing;
+    RecordingBackend backend;
+    StreamRing ring( backend, 3 );
+
+    // First frame maps three regions, rounded up to 256 bytes each.
+    ASSERT_TRUE( ring.begin( 200 ) );
+    EXPECT_EQ( 256u, ring.regionSize() );
+    EXPECT_EQ( 0u, ring.allocate( 64, 64 ) );
+    EXPECT_EQ( 128u, ring.allocate( 16, 128 ) );
+    EXPECT_EQ( StreamRing::none(), ring.allocate( 256 ) );
+    ring.pointer( 128 )[0] = 42;
+    ring.commit();
+    ring.end();
+    EXPECT_EQ( 42, backend.m_memory[128] );
+
+    // Next frames write the next regions, waiting for their fences only.
+    for( size_t frame=1; frame<4; frame++ ) {
+        ASSERT_TRUE( ring.begin( 64 ) );
+        EXPECT_EQ( 256u*(frame%3), ring.allocate( 64 ) );
+        ring.commit();
+        ring.end();
+    }
+
+    // Growing waits for all regions and remaps.
+    ASSERT_TRUE( ring.begin( 300 ) );
+    EXPECT_EQ( 512u, ring.regionSize() );
+    EXPECT_EQ( 0u, ring.region() );
+
+    const char* expected[] = {
+        "wait 0", "wait 1", "wait 2", "map 768", "flush 0 144", "fence 0",
+        "wait 1", "flush 256 64", "fence 1",
+        "wait 2", "flush 512 64", "fence 2",
+        "wait 0", "flush 0 64", "fence 0",
+        "wait 0", "wait 1", "wait 2", "map 1536"
+    };
+    ASSERT_EQ( sizeof(expected)/sizeof(expected[0]), backend.m_calls.size() );
+    for( size_t i=0; i<backend.m_calls.size(); i++ ) {
+        EXPECT_EQ( std::string( expected[i] ), backend.m_calls[i] );
+    }
+}
@@ -0,0 +1,53 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <scene/runtime/ThreadPool.hpp>
+
+using Scene::Runtime::ThreadPool;
+
+TEST( ThreadPool, VisitsEveryIndexOnce )
+{
+    ThreadPool pool;
+    for( size_t round=0; round<8; round++ ) {
+        std::vector<int> visits( 1000, 0 );
+        pool.parallelFor( visits.size(), 4, [&]( size_t i ) { visits[i]++; } );
+        for( size_t i=0; i<visits.size(); i++ ) {
+            ASSERT_EQ( 1, visits[i] );
+        }
+    }
+#ifdef SCENE_USE_THREADS
+    // Workers are kept between jobs.
+    EXPECT_EQ( 3u, pool.workers() );
+#else
+    EXPECT_EQ( 0u, pool.workers() );
+#endif
+}
+
+TEST( ThreadPool, NestedJobsRunSerially )
+{
+    ThreadPool pool;
+    std::atomic<size_t> sum( 0 );
+    pool.parallelFor( 16, 4, [&]( size_t i ) {
+        pool.parallelFor( 16, 4, [&]( size_t j ) { sum += i*16 + j; } );
+    } );
+    EXPECT_EQ( 256u*255u/2u, sum.load() );
+}
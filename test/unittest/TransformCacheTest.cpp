@@ -0,0 +1,251 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <scene/DataBase.hpp>
+#include <scene/Node.hpp>
+#include <scene/Value.hpp>
+#include <scene/runtime/TransformCache.hpp>
+#include <scene/runtime/TransformCompute.hpp>
+
+TEST( TransformCache, IncrementalUpdate )
+{
+    Scene::DataBase database;
+    Scene::Library<Scene::Node>& nodes = database.library<Scene::Node>();
+
+    Scene::Node* root = nodes.add( "root" );
+    root->transformSetTranslate( root->transformAdd(), 1.f, 0.f, 0.f );
+    Scene::Node* child = nodes.add( "child" );
+    child->setParent( root );
+    child->transformSetTranslate( child->transformAdd(), 0.f, 2.f, 0.f );
+    Scene::Node* other = nodes.add( "other" );
+    other->transformSetTranslate( other->transformAdd(), 0.f, 0.f, 3.f );
+
+    const Scene::Node* child_path[ SCENE_PATH_MAX ] = { root, child, NULL };
+    const Scene::Node* other_path[ SCENE_PATH_MAX ] = { other, other, NULL };
+
+    Scene::Runtime::TransformCache cache( database );
+    cache.setIncrementalUpdate( true );
+    const Scene::Value* M_child = cache.pathTransformMatrix( child_path );
+    const Scene::Value* M_child_inv = cache.pathTransformInverseMatrix( child_path );
+    const Scene::Value* M_other = cache.pathTransformMatrix( other_path );
+
+    // First update after entries are added is a full update.
+    cache.update( 640, 480 );
+    const size_t full = cache.lastUpdateCount();
+    EXPECT_FLOAT_EQ( M_child->floatData()[12], 1.f );
+    EXPECT_FLOAT_EQ( M_child->floatData()[13], 2.f );
+    EXPECT_FLOAT_EQ( M_child_inv->floatData()[12], -1.f );
+    EXPECT_FLOAT_EQ( M_other->floatData()[14], 3.f );
+
+    // Nothing changed, nothing to do.
+    cache.update( 640, 480 );
+    EXPECT_EQ( cache.lastUpdateCount(), 0u );
+
+    // Only entries downstream of root are recomputed.
+    root->transformSetTranslate( 0, 5.f, 0.f, 0.f );
+    cache.update( 640, 480 );
+    EXPECT_GT( cache.lastUpdateCount(), 0u );
+    EXPECT_LT( cache.lastUpdateCount(), full );
+    EXPECT_FLOAT_EQ( M_child->floatData()[12], 5.f );
+    EXPECT_FLOAT_EQ( M_child->floatData()[13], 2.f );
+    EXPECT_FLOAT_EQ( M_child_inv->floatData()[12], -5.f );
+    EXPECT_FLOAT_EQ( M_other->floatData()[14], 3.f );
+
+    // Adding an entry rebuilds the graph, but only computes the new entry.
+    const Scene::Value* M_both = cache.matrixComposition( M_child, M_other );
+    cache.update( 640, 480 );
+    EXPECT_EQ( cache.lastUpdateCount(), 1u );
+    EXPECT_FLOAT_EQ( M_both->floatData()[12], 5.f );
+    EXPECT_FLOAT_EQ( M_both->floatData()[13], 2.f );
+    EXPECT_FLOAT_EQ( M_both->floatData()[14], 3.f );
+
+    // Changes made before an entry is added are not lost by the rebuild.
+    other->transformSetTranslate( 0, 0.f, 0.f, 4.f );
+    const Scene::Value* M_other_inv = cache.pathTransformInverseMatrix( other_path );
+    cache.update( 640, 480 );
+    EXPECT_LT( cache.lastUpdateCount(), full );
+    EXPECT_FLOAT_EQ( M_other->floatData()[14], 4.f );
+    EXPECT_FLOAT_EQ( M_other_inv->floatData()[14], -4.f );
+    EXPECT_FLOAT_EQ( M_both->floatData()[14], 4.f );
+    EXPECT_FLOAT_EQ( M_child->floatData()[12], 5.f );
+
+    // After a purge, everything is computed.
+    cache.purge();
+    M_child = cache.pathTransformMatrix( child_path );
+    cache.update( 640, 480 );
+    EXPECT_GT( cache.lastUpdateCount(), 0u );
+    EXPECT_FLOAT_EQ( M_child->floatData()[12], 5.f );
+}
+
+TEST( TransformCache, ThreadedUpdate )
+{
+    Scene::DataBase database;
+    Scene::Library<Scene::Node>& nodes = database.library<Scene::Node>();
+
+    // Enough entries that the update is handed to the thread pool.
+    std::vector<const Scene::Node*> roots;
+    std::vector<const Scene::Node*> children;
+    for( unsigned int r=0; r<16; r++ ) {
+        Scene::Node* root = nodes.add( "root" + std::to_string( r ) );
+        root->transformSetTranslate( root->transformAdd(), float(r), 0.f, 0.f );
+        for( unsigned int c=0; c<40; c++ ) {
+            Scene::Node* child = nodes.add( "child" + std::to_string( r ) + "_" + std::to_string( c ) );
+            child->setParent( root );
+            child->transformSetTranslate( child->transformAdd(), 0.f, float(c), 0.f );
+            roots.push_back( root );
+            children.push_back( child );
+        }
+    }
+
+    Scene::Runtime::TransformCache cache( database, true );
+    cache.setWorkerThreads( 3 );
+    EXPECT_EQ( 3u, cache.workerThreads() );
+    std::vector<const Scene::Value*> M;
+    std::vector<const Scene::Value*> M_inv;
+    for( size_t i=0; i<children.size(); i++ ) {
+        const Scene::Node* path[ SCENE_PATH_MAX ] = { roots[i], children[i], NULL };
+        M.push_back( cache.pathTransformMatrix( path ) );
+        M_inv.push_back( cache.pathTransformInverseMatrix( path ) );
+    }
+
+    for( unsigned int frame=0; frame<3; frame++ ) {
+        Scene::Node* root = nodes.get( "root0" );
+        root->transformSetTranslate( 0, 100.f*frame, 0.f, 0.f );
+        cache.update( 640, 480 );
+        for( size_t i=0; i<children.size(); i++ ) {
+            const float x = (i < 40) ? 100.f*frame : float(i/40);
+            const float y = float(i%40);
+            ASSERT_FLOAT_EQ( x, M[i]->floatData()[12] );
+            ASSERT_FLOAT_EQ( y, M[i]->floatData()[13] );
+            ASSERT_FLOAT_EQ( -x, M_inv[i]->floatData()[12] );
+            ASSERT_FLOAT_EQ( -y, M_inv[i]->floatData()[13] );
+        }
+    }
+    cache.setWorkerThreads( 0 );
+    EXPECT_EQ( 0u, cache.workerThreads() );
+}
+
+TEST( TransformCompute, MatrixKernels )
+{
+    typedef Scene::Runtime::TransformCompute TC;
+
+    float a[16], b[16];
+    for( unsigned int i=0; i<16; i++ ) {
+        a[i] = 0.5f*i - 3.f;
+        b[i] = 1.f/(i+1.f) + ((i%5)==0 ? 1.f : 0.f);
+    }
+
+    const TC::Kernel initial = TC::kernel();
+    ASSERT_TRUE( TC::setKernel( TC::KERNEL_SCALAR ) );
+    float reference[16];
+    TC::multiply4x4( reference, a, b );
+    EXPECT_FLOAT_EQ( reference[4*1+2], a[2]*b[4] + a[6]*b[5] + a[10]*b[6] + a[14]*b[7] );
+
+    for( int k=0; k<TC::KERNEL_N; k++ ) {
+        const TC::Kernel kernel = static_cast<TC::Kernel>( k );
+        if( !TC::setKernel( kernel ) ) {
+            continue;
+        }
+        float result[16];
+        TC::multiply4x4( result, a, b );
+        for( unsigned int i=0; i<16; i++ ) {
+            EXPECT_NEAR( reference[i], result[i], 1e-4f ) << TC::kernelName( kernel );
+        }
+        // Destination aliasing the left operand.
+        float alias[16];
+        std::copy_n( a, 16, alias );
+        TC::multiply4x4( alias, alias, b );
+        for( unsigned int i=0; i<16; i++ ) {
+            EXPECT_NEAR( reference[i], alias[i], 1e-4f ) << TC::kernelName( kernel );
+        }
+    }
+    TC::setKernel( initial );
+}
+
+namespace {
+
+struct BatchItem
+{
+    Scene::Value*           m_value;
+    size_t                  m_N;
+    const Scene::Value*     m_source_values[4];
+};
+
+} // of anonymous namespace
+
+TEST( TransformCompute, BatchedMatrixKernels )
+{
+    typedef Scene::Runtime::TransformCompute TC;
+
+    std::vector<Scene::Value> sources;
+    for( unsigned int m=0; m<7; m++ ) {
+        float a[16];
+        for( unsigned int i=0; i<16; i++ ) {
+            a[i] = 0.25f*((7*m+3*i)%11) - 1.f + ((i%5)==0 ? 1.f : 0.f);
+        }
+        sources.push_back( Scene::Value::createFloat4x4( a ) );
+        sources.back().valueChanged().touch();
+    }
+
+    // Sequences of varying length, enough for more than one group of lanes.
+    const size_t count = 19;
+    std::vector<BatchItem> items( count );
+    for( size_t n=0; n<count; n++ ) {
+        items[n].m_N = n % 5;
+        for( size_t k=0; k<items[n].m_N; k++ ) {
+            items[n].m_source_values[k] = &sources[ (n+2*k) % sources.size() ];
+        }
+    }
+
+    const TC::Kernel initial = TC::kernel();
+    for( int k=0; k<TC::KERNEL_N; k++ ) {
+        const TC::Kernel kernel = static_cast<TC::Kernel>( k );
+        if( !TC::setKernel( kernel ) ) {
+            continue;
+        }
+        std::vector<Scene::Value> single( count, Scene::Value::createFloat4x4() );
+        std::vector<Scene::Value> batched( count, Scene::Value::createFloat4x4() );
+        for( size_t n=0; n<count; n++ ) {
+            single[n].valueChanged().invalidate();
+            batched[n].valueChanged().invalidate();
+            TC::multiplyMatrices( &single[n], static_cast<unsigned int>( items[n].m_N ), items[n].m_source_values );
+            items[n].m_value = &batched[n];
+        }
+        TC::multiplyMatricesBatch( items.data(), items.size() );
+        for( size_t n=0; n<count; n++ ) {
+            const float* s = single[n].floatData();
+            const float* b = batched[n].floatData();
+            for( unsigned int i=0; i<16; i++ ) {
+                EXPECT_EQ( s[i], b[i] ) << TC::kernelName( kernel ) << " item " << n;
+            }
+        }
+
+        // Nothing has changed, so nothing is recomputed.
+        batched[1] = Scene::Value::createFloat4x4();
+        batched[1].valueChanged() = single[1].valueChanged();
+        TC::multiplyMatricesBatch( items.data(), items.size() );
+        EXPECT_EQ( 1.f, batched[1].floatData()[0] );
+        EXPECT_EQ( 0.f, batched[1].floatData()[1] );
+    }
+    TC::setKernel( initial );
+}
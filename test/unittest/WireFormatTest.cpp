@@ -0,0 +1,311 @@
+/* Copyright STIFTELSEN SINTEF 2014
+ * 
+ * This file is part of Scene.
+ * 
+ * Scene is free software: you can redistribute it and/or modifyit under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ * 
+ * Scene is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE.  See the GNU Affero General Public License for more
+ * details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License
+ * along with the Scene.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <gtest/gtest.h>
+
+#include <scene/DataBase.hpp>
+#include <scene/Node.hpp>
+#include <scene/Pass.hpp>
+#include <scene/SourceBuffer.hpp>
+#include <scene/collada/Importer.hpp>
+#include <scene/runtime/Resolver.hpp>
+#include <scene/runtime/RenderList.hpp>
+#include <scene/runtime/WireFormat.hpp>
+
+namespace {
+
+// Two nodes instancing two geometries with identical contents.
+const char* wire_collada =
+        "<?xml version=\"1.0\"?>\n"
+        "<COLLADA>\n"
+        "  <library_geometries>\n"
+        "    <geometry id=\"geo0\"><mesh>\n"
+        "      <source id=\"pos0\"><float_array id=\"pos0_array\" count=\"9\">0 0 0 1 0 0 0 1 0.25</float_array>\n"
+        "        <technique_common><accessor source=\"#pos0_array\" count=\"3\" stride=\"3\">\n"
+        "          <param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/><param name=\"Z\" type=\"float\"/>\n"
+        "        </accessor></technique_common></source>\n"
+        "      <vertices id=\"geo0_vertices\"><input semantic=\"POSITION\" source=\"#pos0\"/></vertices>\n"
+        "      <triangles count=\"1\" material=\"default\"/>\n"
+        "    </mesh></geometry>\n"
+        "    <geometry id=\"geo1\"><mesh>\n"
+        "      <source id=\"pos1\"><float_array id=\"pos1_array\" count=\"9\">0 0 0 1 0 0 0 1 0.25</float_array>\n"
+        "        <technique_common><accessor source=\"#pos1_array\" count=\"3\" stride=\"3\">\n"
+        "          <param name=\"X\" type=\"float\"/><param name=\"Y\" type=\"float\"/><param name=\"Z\" type=\"float\"/>\n"
+        "        </accessor></technique_common></source>\n"
+        "      <vertices id=\"geo1_vertices\"><input semantic=\"POSITION\" source=\"#pos1\"/></vertices>\n"
+        "      <triangles count=\"1\" material=\"default\"/>\n"
+        "    </mesh></geometry>\n"
+        "  </library_geometries>\n"
+        "  <library_effects>\n"
+        "    <effect id=\"effect\">\n"
+        "      <newparam sid=\"mvp\"><semantic>MODELVIEW_PROJECTION_MATRIX</semantic><float4x4>1 0 0 0 0 1 0 0 0 0 1 0 0 0 0 1</float4x4></newparam>\n"
+        "      <newparam sid=\"color\"><float3>1 0.5 0.25</float3></newparam>\n"
+        "      <profile_GLSL><technique sid=\"default\"><pass>\n"
+        "        <program>\n"
+        "          <shader stage=\"VERTEX\"><sources><inline>uniform mat4 MVP; attribute vec3 position; void main() { gl_Position = MVP*vec4(position,1.0); }</inline></sources></shader>\n"
+        "          <shader stage=\"FRAGMENT\"><sources><inline>uniform vec3 color; void main() { gl_FragColor = vec4(color,1.0); }</inline></sources></shader>\n"
+        "          <bind_attribute symbol=\"position\"><semantic>POSITION</semantic></bind_attribute>\n"
+        "          <bind_uniform symbol=\"MVP\"><param ref=\"mvp\"/></bind_uniform>\n"
+        "          <bind_uniform symbol=\"color\"><param ref=\"color\"/></bind_uniform>\n"
+        "        </program>\n"
+        "      </pass></technique></profile_GLSL>\n"
+        "    </effect>\n"
+        "  </library_effects>\n"
+        "  <library_materials>\n"
+        "    <material id=\"mat\"><instance_effect url=\"#effect\"/></material>\n"
+        "  </library_materials>\n"
+        "  <library_visual_scenes>\n"
+        "    <visual_scene id=\"scene\">\n"
+        "      <node id=\"a\"><translate>1 0 0</translate><instance_geometry url=\"#geo0\"><bind_material><technique_common>"
+        "<instance_material symbol=\"default\" target=\"#mat\"/></technique_common></bind_material></instance_geometry></node>\n"
+        "      <node id=\"b\"><translate>0 2 0</translate><instance_geometry url=\"#geo1\"><bind_material><technique_common>"
+        "<instance_material symbol=\"default\" target=\"#mat\"/></technique_common></bind_material></instance_geometry></node>\n"
+        "      <evaluate_scene><render/></evaluate_scene>\n"
+        "    </visual_scene>\n"
+        "  </library_visual_scenes>\n"
+        "</COLLADA>\n";
+
+bool
+decode( Scene::Runtime::WireDecoder& decoder, const std::vector<unsigned char>& frame )
+{
+    return decoder.decode( frame.data(), frame.size() );
+}
+
+} // of anonymous namespace
+
+TEST( WireFormat, RoundTrip )
+{
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parseMemory( wire_collada ) );
+    Scene::Runtime::Resolver resolver( db, Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList list( resolver );
+    ASSERT_TRUE( list.build( "scene" ) );
+    ASSERT_EQ( 2u, list.items() );
+
+    Scene::Runtime::WireEncoder encoder( db );
+    Scene::Runtime::WireDecoder decoder;
+    std::vector<unsigned char> frame;
+
+    // First frame is complete, the identical buffers are sent once.
+    encoder.encode( frame, list, true );
+    EXPECT_EQ( 1u, encoder.lastBuffers() );
+    EXPECT_EQ( 3u, encoder.lastCoordSys() );
+    ASSERT_TRUE( decode( decoder, frame ) );
+    EXPECT_EQ( 1u, decoder.buffers() );
+    ASSERT_EQ( list.items(), decoder.items() );
+    for( size_t i=0; i<list.items(); i++ ) {
+        const Scene::Runtime::RenderList::Item& item = list.item(i);
+        const Scene::Runtime::WireDecoder::Item& wire = decoder.item(i);
+
+        const Scene::Runtime::WireDecoder::Shader* shader = decoder.shader( wire.m_shader );
+        ASSERT_TRUE( shader != NULL );
+        EXPECT_EQ( item.m_set_pass->m_pass->shaderSource( Scene::STAGE_VERTEX ), shader->m_sources[ Scene::STAGE_VERTEX ] );
+        EXPECT_EQ( item.m_set_pass->m_pass->shaderSource( Scene::STAGE_FRAGMENT ), shader->m_sources[ Scene::STAGE_FRAGMENT ] );
+
+        ASSERT_EQ( item.m_set_inputs->m_items.size(), wire.m_inputs.size() );
+        for( size_t k=0; k<wire.m_inputs.size(); k++ ) {
+            const Scene::SourceBuffer* source = item.m_set_inputs->m_items[k].m_source;
+            const Scene::Runtime::WireDecoder::Buffer* buffer = decoder.buffer( wire.m_inputs[k].m_buffer );
+            ASSERT_TRUE( buffer != NULL );
+            ASSERT_EQ( source->elementCount(), buffer->m_count );
+            EXPECT_EQ( 0, std::memcmp( source->floatData(), buffer->floatData(), 4*buffer->m_count ) );
+            EXPECT_EQ( item.m_set_inputs->m_items[k].m_components, wire.m_inputs[k].m_components );
+        }
+        ASSERT_TRUE( item.m_draw != NULL );
+        EXPECT_FALSE( wire.m_indexed );
+        EXPECT_EQ( item.m_draw->m_count, wire.m_count );
+
+        const std::vector<Scene::Runtime::WireDecoder::Uniform>& uniforms = decoder.uniforms( wire.m_uniforms );
+        ASSERT_EQ( 2u, uniforms.size() );
+        for( size_t j=0; j<uniforms.size(); j++ ) {
+            if( uniforms[j].m_semantic == Scene::RUNTIME_SEMANTIC_N ) {
+                ASSERT_EQ( 3u, uniforms[j].m_data.size() );
+                float color[3];
+                std::memcpy( color, uniforms[j].m_data.data(), sizeof(color) );
+                EXPECT_FLOAT_EQ( 0.5f, color[1] );
+            }
+        }
+    }
+    const Scene::Runtime::WireDecoder::Local& a = decoder.local( decoder.item(0).m_local );
+    const Scene::Runtime::WireDecoder::Local& b = decoder.local( decoder.item(1).m_local );
+    EXPECT_FLOAT_EQ( 1.f, a.m_world_from_object[12] + b.m_world_from_object[12] );
+    EXPECT_FLOAT_EQ( 2.f, a.m_world_from_object[13] + b.m_world_from_object[13] );
+
+    // Nothing has changed, nothing is sent.
+    encoder.encode( frame, list, false );
+    EXPECT_EQ( 0u, encoder.lastRawSize() );
+    ASSERT_TRUE( decode( decoder, frame ) );
+
+    // Only the moved node's matrices are sent.
+    db.library<Scene::Node>().get( "a" )->transformSetTranslate( 0, 5.f, 0.f, 0.f );
+    encoder.encode( frame, list, false );
+    EXPECT_EQ( 0u, encoder.lastBuffers() );
+    EXPECT_EQ( 1u, encoder.lastCoordSys() );
+    ASSERT_TRUE( decode( decoder, frame ) );
+    EXPECT_FLOAT_EQ( 5.f, a.m_world_from_object[12] + b.m_world_from_object[12] );
+    EXPECT_FLOAT_EQ( -5.f, a.m_object_from_world[12] + b.m_object_from_world[12] );
+
+    // After a reset, everything is sent again.
+    encoder.reset();
+    encoder.encode( frame, list, false );
+    EXPECT_EQ( 1u, encoder.lastBuffers() );
+    EXPECT_EQ( 3u, encoder.lastCoordSys() );
+    Scene::Runtime::WireDecoder fresh;
+    ASSERT_TRUE( decode( fresh, frame ) );
+    EXPECT_EQ( decoder.items(), fresh.items() );
+}
+
+TEST( WireFormat, UnreferencedBuffersAreDropped )
+{
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parseMemory( wire_collada ) );
+    Scene::Runtime::Resolver resolver( db, Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList list( resolver );
+    ASSERT_TRUE( list.build( "scene" ) );
+
+    Scene::Runtime::WireEncoder encoder( db );
+    Scene::Runtime::WireDecoder decoder;
+    std::vector<unsigned char> frame;
+    encoder.encode( frame, list, true );
+    ASSERT_TRUE( decode( decoder, frame ) );
+    ASSERT_EQ( 1u, decoder.buffers() );
+
+    const std::vector<float> original = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.25f };
+    std::vector<float> moved( original );
+    moved[8] = 0.5f;
+    Scene::SourceBuffer* pos0 = db.library<Scene::SourceBuffer>().get( "pos0_array" );
+    Scene::SourceBuffer* pos1 = db.library<Scene::SourceBuffer>().get( "pos1_array" );
+    ASSERT_TRUE( pos0 != NULL );
+    ASSERT_TRUE( pos1 != NULL );
+
+    // Both contents are referenced.
+    pos0->contents( moved );
+    encoder.encode( frame, list, true );
+    EXPECT_EQ( 1u, encoder.lastBuffers() );
+    ASSERT_TRUE( decode( decoder, frame ) );
+    EXPECT_EQ( 2u, decoder.buffers() );
+
+    // The original contents are no longer referenced and are dropped.
+    pos1->contents( moved );
+    encoder.encode( frame, list, true );
+    EXPECT_EQ( 0u, encoder.lastBuffers() );
+    ASSERT_TRUE( decode( decoder, frame ) );
+    EXPECT_EQ( 1u, decoder.buffers() );
+
+    // So they are sent again when they are needed.
+    pos0->contents( original );
+    encoder.encode( frame, list, true );
+    EXPECT_EQ( 1u, encoder.lastBuffers() );
+    ASSERT_TRUE( decode( decoder, frame ) );
+    EXPECT_EQ( 2u, decoder.buffers() );
+    for( size_t i=0; i<decoder.items(); i++ ) {
+        EXPECT_TRUE( decoder.buffer( decoder.item(i).m_inputs[0].m_buffer ) != NULL );
+        EXPECT_TRUE( decoder.shader( decoder.item(i).m_shader ) != NULL );
+    }
+}
+
+TEST( WireFormat, QuantizedBuffers )
+{
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parseMemory( wire_collada ) );
+    Scene::Runtime::Resolver resolver( db, Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList list( resolver );
+    ASSERT_TRUE( list.build( "scene" ) );
+
+    Scene::Runtime::WireEncoder encoder( db, true, false );
+    Scene::Runtime::WireDecoder decoder;
+    std::vector<unsigned char> frame;
+    encoder.encode( frame, list, true );
+    ASSERT_TRUE( decode( decoder, frame ) );
+
+    const Scene::SourceBuffer* source = list.item(0).m_set_inputs->m_items[0].m_source;
+    const Scene::Runtime::WireDecoder::Buffer* buffer = decoder.buffer( decoder.item(0).m_inputs[0].m_buffer );
+    ASSERT_TRUE( buffer != NULL );
+    ASSERT_EQ( source->elementCount(), buffer->m_count );
+    for( size_t i=0; i<buffer->m_count; i++ ) {
+        EXPECT_NEAR( source->floatData()[i], buffer->floatData()[i], 1.f/65535.f );
+    }
+}
+
+TEST( WireFormat, Compression )
+{
+    std::vector<unsigned char> data;
+    for( size_t i=0; i<5000; i++ ) {
+        data.push_back( static_cast<unsigned char>( (i*i) >> 7 ) );
+    }
+    data.insert( data.end(), 1000, 42u );
+    data.insert( data.end(), data.begin(), data.begin() + 3000 );
+
+    std::vector<unsigned char> packed;
+    Scene::Runtime::Wire::compress( packed, data.data(), data.size() );
+    EXPECT_LT( packed.size(), data.size() );
+
+    std::vector<unsigned char> unpacked( data.size() );
+    ASSERT_TRUE( Scene::Runtime::Wire::decompress( unpacked.data(), unpacked.size(), packed.data(), packed.size() ) );
+    EXPECT_TRUE( unpacked == data );
+
+    EXPECT_FALSE( Scene::Runtime::Wire::decompress( unpacked.data(), unpacked.size(), packed.data(), packed.size()/2 ) );
+    EXPECT_FALSE( Scene::Runtime::Wire::decompress( unpacked.data(), unpacked.size() - 1, packed.data(), packed.size() ) );
+}
+
+TEST( WireFormat, RejectsCorruptFrame )
+{
+    Scene::DataBase db;
+    Scene::Collada::Importer importer( db );
+    ASSERT_TRUE( importer.parseMemory( wire_collada ) );
+    Scene::Runtime::Resolver resolver( db, Scene::PROFILE_GLSL );
+    Scene::Runtime::RenderList list( resolver );
+    ASSERT_TRUE( list.build( "scene" ) );
+
+    Scene::Runtime::WireEncoder encoder( db, false, false );
+    std::vector<unsigned char> frame;
+    encoder.encode( frame, list, true );
+
+    Scene::Runtime::WireDecoder decoder;
+    EXPECT_FALSE( decoder.decode( frame.data(), frame.size() - 1 ) );
+    EXPECT_FALSE( decoder.decode( frame.data(), 8 ) );
+
+    // A truncated chunk inside an otherwise consistent frame.
+    std::vector<unsigned char> broken( frame );
+    uint32_t raw_size = 0;
+    std::memcpy( &raw_size, &broken[8], sizeof(raw_size) );
+    raw_size -= 5;
+    std::memcpy( &broken[8], &raw_size, sizeof(raw_size) );
+    std::memcpy( &broken[12], &raw_size, sizeof(raw_size) );
+    broken.resize( broken.size() - 5 );
+    EXPECT_FALSE( decoder.decode( broken.data(), broken.size() ) );
+
+    // A compressed payload claiming more than it can expand to.
+    std::vector<unsigned char> bloated( frame.begin(), frame.begin() + 16 + 4 );
+    const uint16_t flags = 1u;
+    const uint32_t bloated_raw_size = 0xffffffffu;
+    const uint32_t bloated_payload_size = 4u;
+    std::memcpy( &bloated[6], &flags, sizeof(flags) );
+    std::memcpy( &bloated[8], &bloated_raw_size, sizeof(bloated_raw_size) );
+    std::memcpy( &bloated[12], &bloated_payload_size, sizeof(bloated_payload_size) );
+    EXPECT_FALSE( decoder.decode( bloated.data(), bloated.size() ) );
+
+    EXPECT_TRUE( decoder.decode( frame.data(), frame.size() ) );
+}